@@ -0,0 +1,137 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gua/skelanim/utils/Bone.hpp>
+#include <gua/skelanim/utils/Skeleton.hpp>
+#include <gua/skelanim/utils/SkeletalAnimation.hpp>
+#include <gua/skelanim/utils/SkeletalTransformation.hpp>
+#include <gua/skelanim/utils/CompiledAnimation.hpp>
+
+#include <assimp/anim.h>
+
+// samples and blends two clips for many characters, once through the
+// name-keyed SkeletalPose path and once through compiled clips
+
+const unsigned NUM_CHARACTERS = 100;
+const unsigned NUM_FRAMES = 600; // ten seconds at 60 Hz
+const unsigned NUM_BONES = 60;
+const unsigned NUM_KEYS = 120;
+
+// chain of bones with a few branches, similar to a humanoid
+gua::Skeleton make_skeleton()
+{
+    std::vector<gua::Bone> bones;
+    for(unsigned i = 0; i < NUM_BONES; ++i)
+    {
+        bones.emplace_back("bone_" + std::to_string(i), scm::math::make_translation(0.f, 0.1f, 0.f));
+    }
+    for(unsigned i = 1; i < NUM_BONES; ++i)
+    {
+        bones[i % 4 == 0 ? i / 4 : i - 1].children.push_back(i);
+    }
+
+    gua::Skeleton skeleton;
+    skeleton.set_bones(bones);
+    return skeleton;
+}
+
+gua::SkeletalAnimation make_animation(std::string const& name, float speed)
+{
+    aiAnimation anim;
+    anim.mDuration = NUM_KEYS;
+    anim.mTicksPerSecond = 30;
+    anim.mNumChannels = NUM_BONES;
+    anim.mChannels = new aiNodeAnim*[NUM_BONES];
+
+    for(unsigned b = 0; b < NUM_BONES; ++b)
+    {
+        auto channel = new aiNodeAnim();
+        channel->mNodeName = aiString("bone_" + std::to_string(b));
+        channel->mNumScalingKeys = channel->mNumRotationKeys = channel->mNumPositionKeys = NUM_KEYS;
+        channel->mScalingKeys = new aiVectorKey[NUM_KEYS];
+        channel->mRotationKeys = new aiQuatKey[NUM_KEYS];
+        channel->mPositionKeys = new aiVectorKey[NUM_KEYS];
+
+        for(unsigned k = 0; k < NUM_KEYS; ++k)
+        {
+            float angle = std::sin(speed * k * 0.1f + b) * 0.5f;
+            channel->mScalingKeys[k] = aiVectorKey(k, aiVector3D(1.f));
+            channel->mRotationKeys[k] = aiQuatKey(k, aiQuaternion(aiVector3D(0.f, 0.f, 1.f), angle));
+            channel->mPositionKeys[k] = aiVectorKey(k, aiVector3D(0.f, 0.1f, 0.f));
+        }
+        anim.mChannels[b] = channel;
+    }
+
+    return gua::SkeletalAnimation(anim, name);
+}
+
+template <typename F>
+double run(F const& sample_character)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for(unsigned frame = 0; frame < NUM_FRAMES; ++frame)
+    {
+        for(unsigned c = 0; c < NUM_CHARACTERS; ++c)
+        {
+            // spread the characters over the clips
+            float time = std::fmod((frame / 60.f + c * 0.37f) / 4.f, 1.f);
+            sample_character(c, time, std::fmod(time * 1.3f, 1.f), 0.5f + 0.5f * std::sin(c + frame * 0.01f));
+        }
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count() / NUM_FRAMES;
+}
+
+int main(int argc, char** argv)
+{
+    auto skeleton = make_skeleton();
+    auto walk = make_animation("walk", 1.f);
+    auto run_anim = make_animation("run", 2.f);
+
+    gua::CompiledAnimation compiled_walk(walk, skeleton);
+    gua::CompiledAnimation compiled_run(run_anim, skeleton);
+
+    std::vector<std::vector<scm::math::mat4f>> transforms(NUM_CHARACTERS);
+
+    double legacy = run([&](unsigned c, float time1, float time2, float blend) {
+        transforms[c] = gua::SkeletalTransformation::blend_anims(skeleton, 0, blend, time1, time2, walk, run_anim);
+    });
+
+    double compiled = run([&](unsigned c, float time1, float time2, float blend) {
+        gua::SkeletalTransformation::blend_anims(skeleton, 0, blend, time1, time2, compiled_walk, compiled_run, transforms[c]);
+    });
+
+    std::cout << NUM_CHARACTERS << " characters, " << NUM_BONES << " bones, " << NUM_KEYS << " keys per track" << std::endl;
+    std::cout << "SkeletalPose:      " << legacy << " ms per frame (" << legacy / 16.667 * 100.0 << "% of a 60 Hz frame)" << std::endl;
+    std::cout << "CompiledAnimation: " << compiled << " ms per frame (" << compiled / 16.667 * 100.0 << "% of a 60 Hz frame)" << std::endl;
+    std::cout << "speedup:           " << legacy / compiled << "x" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+// Measures how fast LineStripImporter reads large line files. A synthetic OBJ
+// file of streamlines (one object with 'v' statements and one 'l' statement
+// per streamline) is written to the working directory, parsed from text,
+// written to the binary cache and read back from it. Throughput and the peak
+// resident memory after each stage are reported. The file is read from the
+// page cache unless it is dropped between runs.
+
+#include <gua/platform.hpp>
+#include <gua/utils/BinaryCacheFile.hpp>
+#include <gua/utils/LineStrip.hpp>
+#include <gua/utils/LineStripImporter.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#if GUA_PLATFORM == GUA_PLATFORM_LINUX
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+using clock_type = std::chrono::high_resolution_clock;
+
+std::string const FILE_NAME = "line_strip_import_benchmark.obj";
+std::string const CACHE_FILE_NAME = FILE_NAME + ".gua_lines";
+
+// peak resident set size of the process in MB, 0 if unknown
+double peak_memory()
+{
+#if GUA_PLATFORM == GUA_PLATFORM_LINUX
+    rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+        return usage.ru_maxrss / 1024.0;
+    }
+#endif
+    return 0.0;
+}
+
+std::size_t write_streamlines(unsigned num_lines, unsigned vertices_per_line)
+{
+    std::ofstream file(FILE_NAME, std::ios::binary);
+    file << "o streamlines\n";
+
+    char buffer[128];
+    for(unsigned line = 0; line != num_lines; ++line)
+    {
+        for(unsigned vertex = 0; vertex != vertices_per_line; ++vertex)
+        {
+            float const t = vertex * 0.01f;
+            std::snprintf(buffer, sizeof(buffer), "v %f %f %f\n", std::cos(t + line) * (1.0f + t), std::sin(t + line) * (1.0f + t), line * 0.001f + t);
+            file << buffer;
+        }
+
+        file << "l";
+        for(unsigned vertex = 0; vertex != vertices_per_line; ++vertex)
+        {
+            file << ' ' << line * vertices_per_line + vertex + 1;
+        }
+        file << '\n';
+    }
+
+    return std::size_t(file.tellp());
+}
+
+void report(std::string const& stage, double seconds, std::size_t num_bytes, std::size_t num_vertices)
+{
+    std::cout << stage << ": " << seconds * 1000.0 << " ms, " << num_bytes / (1024.0 * 1024.0) / seconds << " MB/s, " << num_vertices / seconds / 1e6 << " M vertices/s, peak memory "
+              << peak_memory() << " MB" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    unsigned const num_lines = argc > 1 ? unsigned(std::atoi(argv[1])) : 10000;
+    unsigned const vertices_per_line = argc > 2 ? unsigned(std::atoi(argv[2])) : 200;
+
+    std::size_t const file_size = write_streamlines(num_lines, vertices_per_line);
+    std::size_t const num_vertices = std::size_t(num_lines) * vertices_per_line;
+
+    std::cout << num_lines << " lines of " << vertices_per_line << " vertices, " << file_size / (1024.0 * 1024.0) << " MB of text, peak memory " << peak_memory() << " MB" << std::endl;
+
+    uint64_t const source_key = gua::BinaryCacheFile::hash_file(FILE_NAME);
+
+    {
+        auto const start = clock_type::now();
+        gua::LineStripImporter importer;
+        importer.read_file(FILE_NAME);
+        double const seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+
+        std::size_t num_segments = 0;
+        for(int i = 0; i < importer.num_parsed_line_strips(); ++i)
+        {
+            num_segments += importer.parsed_line_object_at(i).second.line_indices.size() / 2;
+        }
+        report("parse text", seconds, file_size, num_vertices);
+        std::cout << "  " << importer.num_parsed_line_strips() << " objects, " << num_segments << " segments" << std::endl;
+
+        auto const save_start = clock_type::now();
+        importer.save_cache(CACHE_FILE_NAME, source_key);
+        report("write cache", std::chrono::duration<double>(clock_type::now() - save_start).count(), file_size, num_vertices);
+    }
+
+    {
+        auto const start = clock_type::now();
+        gua::LineStripImporter importer;
+        bool const loaded = importer.load_cache(CACHE_FILE_NAME, source_key);
+        double const seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+        report(loaded ? "read cache" : "read cache FAILED", seconds, file_size, num_vertices);
+
+        auto const expand_start = clock_type::now();
+        gua::LineStrip line_strip(importer.parsed_line_object_at(0).second);
+        report("expand line list", std::chrono::duration<double>(clock_type::now() - expand_start).count(), file_size, line_strip.positions.size());
+    }
+
+    std::remove(FILE_NAME.c_str());
+    std::remove(CACHE_FILE_NAME.c_str());
+
+    return 0;
+}
@@ -0,0 +1,218 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+// Measures batched picking and cut culling of gua::LodBvhQuery. Synthetic
+// binary bvhs over small random boxes are placed on a grid, random rays from a
+// camera in front of the grid are picked against all of them and the cut of
+// each model (all nodes a few levels above the leaves) is classified against
+// the camera frustum. Both are run on one thread and on all hardware threads
+// and the results are compared. *.bvh files given on the command line are
+// picked in addition to the synthetic models.
+
+#include <gua/renderer/Frustum.hpp>
+#include <gua/renderer/LodBvhQuery.hpp>
+#include <gua/utils/KDTreeUtils.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+using clock_type = std::chrono::high_resolution_clock;
+
+unsigned const FAN_FACTOR = 2;
+unsigned const DEPTH = 12;
+unsigned const CUT_DEPTH = DEPTH - 3;
+
+unsigned first_node_of_level(unsigned level)
+{
+    unsigned first_node = 0;
+    unsigned level_size = 1;
+    for(unsigned l = 0; l < level; ++l)
+    {
+        first_node += level_size;
+        level_size *= FAN_FACTOR;
+    }
+    return first_node;
+}
+
+// complete tree over small random boxes in the unit cube, leaves are in morton order like in a spatially sorted bvh
+std::vector<scm::gl::boxf> make_bvh(std::mt19937& random)
+{
+    unsigned const cells_per_axis = 1u << (DEPTH / 3);
+    std::uniform_real_distribution<float> offset(0.0f, 1.0f / cells_per_axis - 0.02f);
+    std::vector<scm::gl::boxf> boxes(first_node_of_level(DEPTH + 1));
+
+    for(unsigned node = unsigned(boxes.size()); node-- > 0;)
+    {
+        unsigned const first_child = node * FAN_FACTOR + 1;
+
+        if(first_child >= boxes.size())
+        {
+            unsigned const leaf = node - first_node_of_level(DEPTH);
+            unsigned cell[3] = {0, 0, 0};
+            for(unsigned bit = 0; bit < DEPTH; ++bit)
+            {
+                cell[bit % 3] |= ((leaf >> bit) & 1u) << (bit / 3);
+            }
+
+            scm::math::vec3f min;
+            for(int axis = 0; axis < 3; ++axis)
+            {
+                min[axis] = float(cell[axis]) / cells_per_axis + offset(random);
+            }
+            boxes[node] = scm::gl::boxf(min, min + scm::math::vec3f(0.02f, 0.02f, 0.02f));
+            continue;
+        }
+
+        scm::math::vec3f min(boxes[first_child].min_vertex());
+        scm::math::vec3f max(boxes[first_child].max_vertex());
+        for(unsigned c = 1; c < FAN_FACTOR; ++c)
+        {
+            for(int axis = 0; axis < 3; ++axis)
+            {
+                min[axis] = std::min(min[axis], boxes[first_child + c].min_vertex()[axis]);
+                max[axis] = std::max(max[axis], boxes[first_child + c].max_vertex()[axis]);
+            }
+        }
+        boxes[node] = scm::gl::boxf(min, max);
+    }
+
+    return boxes;
+}
+
+template <typename F>
+double measure(F const& f)
+{
+    auto const start = clock_type::now();
+    f();
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    unsigned const grid_size = 10;
+    std::size_t const num_rays = 100000;
+
+    std::mt19937 random(42);
+
+    gua::LodBvhQuery serial_query(1);
+    gua::LodBvhQuery parallel_query;
+
+    std::vector<std::vector<scm::gl::boxf>> bvhs;
+    std::vector<gua::math::mat4> world_transforms;
+
+    for(unsigned x = 0; x < grid_size; ++x)
+    {
+        for(unsigned y = 0; y < grid_size; ++y)
+        {
+            bvhs.push_back(make_bvh(random));
+            world_transforms.push_back(scm::math::make_translation(1.5 * x - 0.75 * grid_size, 1.5 * y - 0.75 * grid_size, 0.0));
+
+            std::string const name("synthetic_" + std::to_string(bvhs.size()));
+            serial_query.add_model(name, FAN_FACTOR, bvhs.back(), world_transforms.back());
+            parallel_query.add_model(name, FAN_FACTOR, bvhs.back(), world_transforms.back());
+        }
+    }
+
+    for(int arg = 1; arg < argc; ++arg)
+    {
+        serial_query.load_model(argv[arg]);
+        parallel_query.load_model(argv[arg]);
+    }
+
+    std::cout << parallel_query.num_models() << " models, " << bvhs.size() * bvhs.front().size() << " synthetic bvh nodes, " << parallel_query.get_num_threads() << " threads" << std::endl;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // picking
+    ///////////////////////////////////////////////////////////////////////////
+    gua::math::vec3 const eye(0.0, 0.0, 20.0);
+    std::uniform_real_distribution<double> target(-0.75 * grid_size, 0.75 * grid_size);
+
+    std::vector<gua::Ray> rays;
+    rays.reserve(num_rays);
+    for(std::size_t r = 0; r < num_rays; ++r)
+    {
+        rays.push_back(gua::Ray(eye, gua::math::vec3(target(random), target(random), 0.5) - eye, 2.0));
+    }
+
+    std::vector<gua::LodBvhQuery::Hit> serial_hits;
+    std::vector<gua::LodBvhQuery::Hit> parallel_hits;
+
+    double const serial_pick = measure([&]() { serial_hits = serial_query.pick(rays); });
+    double const parallel_pick = measure([&]() { parallel_hits = parallel_query.pick(rays); });
+
+    std::size_t num_hits = 0;
+    std::size_t num_mismatches = 0;
+    for(std::size_t r = 0; r < num_rays; ++r)
+    {
+        num_hits += serial_hits[r].model >= 0 ? 1 : 0;
+        num_mismatches += serial_hits[r].model != parallel_hits[r].model || serial_hits[r].node != parallel_hits[r].node ? 1 : 0;
+    }
+
+    std::cout << "pick " << num_rays << " rays: 1 thread " << serial_pick * 1000.0 << " ms, all threads " << parallel_pick * 1000.0 << " ms, " << num_rays / parallel_pick / 1e6 << " M rays/s, "
+              << num_hits << " hits, " << num_mismatches << " mismatches" << std::endl;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // cut culling
+    ///////////////////////////////////////////////////////////////////////////
+    auto const frustum = gua::Frustum::perspective(scm::math::make_translation(eye), scm::math::make_translation(eye + gua::math::vec3(0.0, 0.0, -1.0)) * scm::math::make_scale(0.8, 0.45, 1.0), 0.1, 100.0);
+    gua::math::mat4 const view_projection(frustum.get_projection() * frustum.get_view());
+
+    std::vector<lamure::ren::cut::node_slot_aggregate> cut;
+    for(unsigned node = first_node_of_level(CUT_DEPTH); node < first_node_of_level(CUT_DEPTH + 1); ++node)
+    {
+        cut.push_back(lamure::ren::cut::node_slot_aggregate(node, node));
+    }
+
+    std::vector<gua::LodBvhQuery::CutCullingJob> jobs(bvhs.size());
+    for(std::size_t model = 0; model < bvhs.size(); ++model)
+    {
+        jobs[model].frustum = scm::gl::frustum(gua::math::mat4f(view_projection * world_transforms[model]));
+        jobs[model].bounding_boxes = &bvhs[model];
+        jobs[model].cut = &cut;
+    }
+
+    auto parallel_jobs(jobs);
+
+    double const serial_cull = measure([&]() { gua::LodBvhQuery::classify_cuts(jobs, 1); });
+    double const parallel_cull = measure([&]() { gua::LodBvhQuery::classify_cuts(parallel_jobs); });
+
+    std::size_t num_visible = 0;
+    num_mismatches = 0;
+    for(std::size_t model = 0; model < jobs.size(); ++model)
+    {
+        num_visible += jobs[model].visible_nodes.size();
+        num_mismatches += jobs[model].visible_nodes != parallel_jobs[model].visible_nodes ? 1 : 0;
+    }
+
+    std::cout << "cull " << jobs.size() * cut.size() << " cut nodes: 1 thread " << serial_cull * 1000.0 << " ms, all threads " << parallel_cull * 1000.0 << " ms, " << num_visible << " visible, "
+              << num_mismatches << " mismatches" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,168 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+// Measures how physics scales with threads. First, a number of independent
+// worlds, each with piles of boxes and its own fixed timestep, is stepped by
+// a PhysicsWorldGroup with a varying number of threads; reported are the
+// simulated fixed timesteps per second compared to real time. Second, one
+// large world with many separate piles is stepped as fast as possible with
+// a varying number of constraint solver threads. All piles are rebuilt for
+// each run, so every run starts with the same amount of work.
+
+#include <gua/physics.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+const unsigned BOXES_PER_PILE = 40;
+const double RUN_SECONDS = 3.0;
+const unsigned SINGLE_WORLD_STEPS = 300;
+
+// a floor with piles of boxes which fall onto each other
+std::shared_ptr<gua::physics::Physics> make_world(unsigned num_piles, float fixed_timestep)
+{
+    auto world(std::make_shared<gua::physics::Physics>(gua::physics::physics_default_gravity, fixed_timestep));
+    world->simulation_rate_reduction(false);
+
+    auto floor_body = std::make_shared<gua::physics::RigidBodyNode>("floor_body", 0.f, 0.5f, 0.7f);
+    auto floor_shape = std::make_shared<gua::physics::CollisionShapeNode>("floor_shape");
+    floor_shape->data.set_shape("floor");
+    floor_body->add_child(floor_shape);
+    world->add_rigid_body(floor_body);
+
+    unsigned const piles_per_row(unsigned(std::ceil(std::sqrt(double(num_piles)))));
+    for(unsigned p = 0; p < num_piles; ++p)
+    {
+        // piles are far enough apart to form separate simulation islands
+        double const x(4.0 * (p % piles_per_row) - 2.0 * piles_per_row);
+        double const z(4.0 * (p / piles_per_row) - 2.0 * piles_per_row);
+
+        for(unsigned b = 0; b < BOXES_PER_PILE; ++b)
+        {
+            double const offset(0.1 * ((b * 7) % 5) - 0.2);
+            auto body = std::make_shared<gua::physics::RigidBodyNode>("box_body", 1.f, 0.5f, 0.1f, scm::math::make_translation(x + offset, 0.5 + 0.6 * b, z - offset));
+            auto shape = std::make_shared<gua::physics::CollisionShapeNode>("box_shape");
+            shape->data.set_shape("box");
+            body->add_child(shape);
+            world->add_rigid_body(body);
+        }
+    }
+
+    // applies the collision shapes
+    world->synchronize();
+
+    return world;
+}
+
+void benchmark_world_group(unsigned num_worlds, unsigned piles_per_world, std::vector<unsigned> const& thread_counts)
+{
+    std::cout << num_worlds << " worlds with " << piles_per_world * BOXES_PER_PILE << " boxes each" << std::endl;
+
+    for(unsigned num_threads : thread_counts)
+    {
+        // different fixed timesteps of 1/60 s to 1/120 s
+        std::vector<std::shared_ptr<gua::physics::Physics>> worlds;
+        double real_time_steps(0.0);
+        for(unsigned w = 0; w < num_worlds; ++w)
+        {
+            float const fixed_timestep(1.f / (60.f + 60.f * w / std::max(1u, num_worlds - 1)));
+            worlds.push_back(make_world(piles_per_world, fixed_timestep));
+            real_time_steps += RUN_SECONDS / fixed_timestep;
+        }
+
+        gua::physics::PhysicsWorldGroup group;
+        for(auto const& world : worlds)
+        {
+            group.add_world(world);
+        }
+
+        group.start(num_threads);
+        std::this_thread::sleep_for(std::chrono::duration<double>(RUN_SECONDS));
+        group.stop();
+
+        std::uint64_t steps(0);
+        for(auto const& world : worlds)
+        {
+            steps += world->get_num_steps();
+        }
+
+        std::cout << "  " << num_threads << " threads: " << steps / RUN_SECONDS << " steps/s, " << 100.0 * steps / real_time_steps << " % of real time" << std::endl;
+    }
+}
+
+void benchmark_solver_threads(unsigned num_piles, std::vector<unsigned> const& thread_counts)
+{
+    std::cout << "one world with " << num_piles * BOXES_PER_PILE << " boxes in " << num_piles << " piles" << std::endl;
+
+    if(!gua::physics::IslandParallelDynamicsWorld::parallel_solving_supported())
+    {
+        std::cout << "  parallel solving is not supported by this Bullet build" << std::endl;
+        return;
+    }
+
+    for(unsigned num_threads : thread_counts)
+    {
+        auto world(make_world(num_piles, 1.f / 60.f));
+        world->set_solver_threads(num_threads);
+
+        // steps on this thread without waiting for real time to pass
+        auto const start(std::chrono::steady_clock::now());
+        {
+            std::lock_guard<std::mutex> lock(world->lock());
+            for(unsigned s = 0; s < SINGLE_WORLD_STEPS; ++s)
+            {
+                world->get_bullet_dynamics_world()->stepSimulation(1.f / 60.f, 1, 1.f / 60.f);
+            }
+        }
+        std::chrono::duration<double> const elapsed(std::chrono::steady_clock::now() - start);
+
+        std::cout << "  " << num_threads << " solver threads: " << SINGLE_WORLD_STEPS / elapsed.count() << " steps/s" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned const num_worlds(argc > 1 ? unsigned(std::atoi(argv[1])) : 8);
+    unsigned const piles_per_world(argc > 2 ? unsigned(std::atoi(argv[2])) : 16);
+
+    gua::physics::CollisionShapeDatabase::add_shape("box", new gua::physics::BoxShape(0.25f));
+    gua::physics::CollisionShapeDatabase::add_shape("floor", new gua::physics::BoxShape(gua::math::vec3(100, 0.1, 100)));
+
+    std::vector<unsigned> thread_counts;
+    for(unsigned t = 1; t < std::thread::hardware_concurrency(); t *= 2)
+    {
+        thread_counts.push_back(t);
+    }
+    thread_counts.push_back(std::max(1u, std::thread::hardware_concurrency()));
+
+    benchmark_world_group(num_worlds, piles_per_world, thread_counts);
+    benchmark_solver_threads(num_worlds * piles_per_world, thread_counts);
+
+    return 0;
+}
@@ -0,0 +1,176 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+// Headless stress test for the exchange of rigid body state between the
+// simulation thread and the render thread. Thousands of spheres move with a
+// constant velocity in zero gravity while a render loop at 60 Hz and 144 Hz
+// calls Physics::synchronize() and posts impulses every frame. Reported are
+// the time the render thread spends in synchronize() and in posting impulses
+// (which would block while the simulation steps if they had to lock it) and
+// the jitter of the rendered speed, with and without interpolation of the
+// transforms. The rendered speed should be constant, any deviation is
+// visible as stutter.
+
+#include <gua/physics.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+const double SPEED = 2.0;
+const double RUN_SECONDS = 3.0;
+const unsigned IMPULSES_PER_FRAME = 64;
+
+struct Result
+{
+    double sync_mean_us = 0.0;
+    double sync_max_us = 0.0;
+    double post_mean_us = 0.0;
+    double speed_jitter = 0.0;
+};
+
+Result run(gua::physics::Physics& physics, std::vector<std::shared_ptr<gua::physics::RigidBodyNode>> const& bodies, double frame_rate, bool interpolation)
+{
+    typedef std::chrono::steady_clock clock;
+
+    physics.set_interpolation(interpolation);
+    physics.start_simulation();
+
+    // let the simulation thread pick up the bodies
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    auto const frame_time(std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / frame_rate)));
+    unsigned const num_frames(unsigned(RUN_SECONDS * frame_rate));
+
+    std::vector<double> sync_us, post_us, speeds;
+    sync_us.reserve(num_frames);
+    post_us.reserve(num_frames);
+    speeds.reserve(num_frames);
+
+    auto next_frame(clock::now());
+    auto last_frame(next_frame);
+    double last_x(0.0);
+
+    for(unsigned frame = 0; frame < num_frames; ++frame)
+    {
+        next_frame += frame_time;
+        std::this_thread::sleep_until(next_frame);
+
+        auto const sync_start(clock::now());
+        physics.synchronize();
+        auto const sync_end(clock::now());
+
+        // zero impulses exercise the command path without changing the motion
+        for(unsigned i = 0; i < IMPULSES_PER_FRAME; ++i)
+        {
+            bodies[(frame * IMPULSES_PER_FRAME + i) % bodies.size()]->apply_central_impulse(gua::math::vec3(0.0, 0.0, 0.0));
+        }
+        auto const post_end(clock::now());
+
+        double const x(gua::math::get_translation(bodies.front()->get_transform()).x);
+        if(frame > 0)
+        {
+            speeds.push_back((x - last_x) / std::chrono::duration<double>(sync_end - last_frame).count());
+        }
+        last_x = x;
+        last_frame = sync_end;
+
+        sync_us.push_back(std::chrono::duration<double, std::micro>(sync_end - sync_start).count());
+        post_us.push_back(std::chrono::duration<double, std::micro>(post_end - sync_end).count());
+    }
+
+    physics.stop_simulation();
+
+    Result result;
+    for(double t : sync_us)
+    {
+        result.sync_mean_us += t / sync_us.size();
+        result.sync_max_us = std::max(result.sync_max_us, t);
+    }
+    for(double t : post_us)
+    {
+        result.post_mean_us += t / post_us.size();
+    }
+
+    // standard deviation of the rendered speed relative to the simulated one
+    double variance(0.0);
+    for(double s : speeds)
+    {
+        variance += (s - SPEED) * (s - SPEED) / speeds.size();
+    }
+    result.speed_jitter = std::sqrt(variance) / SPEED;
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned const num_bodies(argc > 1 ? unsigned(std::atoi(argv[1])) : 4000);
+
+    gua::physics::CollisionShapeDatabase::add_shape("sphere", new gua::physics::SphereShape(0.25));
+
+    gua::physics::Physics physics(0.f, 1.f / 60.f);
+
+    // a grid of spheres which never touch each other
+    std::vector<std::shared_ptr<gua::physics::RigidBodyNode>> bodies;
+    unsigned const grid_size(unsigned(std::ceil(std::cbrt(double(num_bodies)))));
+    for(unsigned i = 0; i < num_bodies; ++i)
+    {
+        auto body = std::make_shared<gua::physics::RigidBodyNode>(
+            "sphere_body", 1.f, 0.f, 0.f, scm::math::make_translation(double(i % grid_size), double(i / grid_size % grid_size), double(i / (grid_size * grid_size))));
+        auto shape = std::make_shared<gua::physics::CollisionShapeNode>("sphere_shape");
+        shape->data.set_shape("sphere");
+        body->add_child(shape);
+        body->set_damping(0.f, 0.f);
+
+        physics.add_rigid_body(body);
+        body->set_linear_velocity(gua::math::vec3(SPEED, 0.0, 0.0));
+        bodies.push_back(body);
+    }
+
+    // applies the collision shapes
+    physics.synchronize();
+
+    std::cout << num_bodies << " bodies, simulation at 60 Hz" << std::endl;
+
+    for(double frame_rate : {60.0, 144.0})
+    {
+        for(bool interpolation : {false, true})
+        {
+            auto result(run(physics, bodies, frame_rate, interpolation));
+
+            std::cout << frame_rate << " Hz, interpolation " << (interpolation ? "on " : "off") << ": synchronize " << result.sync_mean_us << " us (max " << result.sync_max_us
+                      << " us), posting " << IMPULSES_PER_FRAME << " impulses " << result.post_mean_us << " us, speed jitter " << 100.0 * result.speed_jitter << " %" << std::endl;
+        }
+    }
+
+    for(auto const& body : bodies)
+    {
+        physics.remove_rigid_body(body);
+    }
+
+    return 0;
+}
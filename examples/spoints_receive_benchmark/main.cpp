@@ -0,0 +1,162 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+// Measures the spoints receive pipeline without a reconstruction server:
+// synthetic, uncompressed SGTP frames are published on a local endpoint and
+// received by a NetKinectArray. Reports the latency from send to decoded
+// frame and the sustained throughput of the receive and decode stages.
+
+#include <gua/spoints/spoints_geometry/NetKinectArray.hpp>
+#include <gua/spoints/sgtp/SGTP.h>
+
+#include <zmq.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using clock_type = std::chrono::high_resolution_clock;
+
+zmq::message_t create_frame_message(uint32_t num_triangles, uint32_t texture_size)
+{
+    SGTP::header_data_t header;
+    header.is_calibration_data = false;
+    header.is_data_compressed = false;
+    header.is_fully_encoded_vertex_data = true;
+    header.num_textured_triangles = num_triangles;
+    header.texture_payload_size = texture_size;
+    header.tex_bounding_box[0].max.u = 255;
+    header.tex_bounding_box[0].max.v = 255;
+
+    std::size_t const geometry_size = std::size_t(num_triangles) * 3 * 5 * sizeof(float);
+    zmq::message_t message(SGTP::HEADER_BYTE_SIZE + geometry_size + texture_size);
+
+    char* data = (char*)message.data();
+    memcpy(data, (char const*)&header, SGTP::HEADER_BYTE_SIZE);
+    memset(data + SGTP::HEADER_BYTE_SIZE, 0, geometry_size + texture_size);
+
+    return message;
+}
+
+void send_frame(zmq::socket_t& socket, uint32_t num_triangles, uint32_t texture_size)
+{
+    zmq::message_t message(create_frame_message(num_triangles, texture_size));
+    socket.send(message);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string endpoint("ipc:///tmp/spoints_benchmark");
+    uint32_t num_triangles = 200000;
+    uint32_t const texture_size = 256 * 256 * 3;
+    unsigned num_latency_samples = 200;
+    double throughput_seconds = 5.0;
+
+    if(argc > 1)
+    {
+        endpoint = argv[1];
+    }
+    if(argc > 2)
+    {
+        num_triangles = std::stoul(argv[2]);
+    }
+
+    zmq::context_t ctx(1);
+    zmq::socket_t socket(ctx, ZMQ_PUB);
+    socket.bind(endpoint.c_str());
+
+    spoints::NetKinectArray receiver(endpoint, "");
+
+    // wait until the subscription is established
+    uint64_t sequence = 0;
+    while(!receiver.wait_for_frame(sequence, std::chrono::milliseconds(100)))
+    {
+        send_frame(socket, num_triangles, texture_size);
+    }
+
+    std::size_t const frame_size = SGTP::HEADER_BYTE_SIZE + std::size_t(num_triangles) * 3 * 5 * sizeof(float) + texture_size;
+    std::cout << "Frame size: " << frame_size / (1024.0 * 1024.0) << " MB" << std::endl;
+
+    // latency: one frame in flight at a time
+    std::vector<double> latencies_ms;
+
+    for(unsigned i = 0; i < num_latency_samples; ++i)
+    {
+        auto start = clock_type::now();
+        send_frame(socket, num_triangles, texture_size);
+
+        if(receiver.wait_for_frame(sequence, std::chrono::milliseconds(1000)))
+        {
+            latencies_ms.push_back(std::chrono::duration<double, std::milli>(clock_type::now() - start).count());
+        }
+    }
+
+    if(!latencies_ms.empty())
+    {
+        std::sort(latencies_ms.begin(), latencies_ms.end());
+        double average = std::accumulate(latencies_ms.begin(), latencies_ms.end(), 0.0) / latencies_ms.size();
+
+        std::cout << "Latency (" << latencies_ms.size() << " of " << num_latency_samples << " frames): min " << latencies_ms.front() << " ms, avg " << average << " ms, p99 "
+                  << latencies_ms[std::min(latencies_ms.size() - 1, latencies_ms.size() * 99 / 100)] << " ms, max " << latencies_ms.back() << " ms" << std::endl;
+    }
+
+    // throughput: the sender publishes as fast as it can, the receiver keeps the latest frame
+    std::atomic<bool> sending(true);
+    std::thread sender([&]() {
+        zmq::message_t prototype(create_frame_message(num_triangles, texture_size));
+        while(sending)
+        {
+            zmq::message_t message;
+            message.copy(&prototype);
+            socket.send(message);
+        }
+    });
+
+    uint64_t const first_sequence = sequence;
+    std::size_t const first_dropped = receiver.get_num_dropped_messages();
+    auto start = clock_type::now();
+
+    while(std::chrono::duration<double>(clock_type::now() - start).count() < throughput_seconds)
+    {
+        receiver.wait_for_frame(sequence, std::chrono::milliseconds(100));
+    }
+
+    double const elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+    sending = false;
+    sender.join();
+
+    double const frames_per_second = (sequence - first_sequence) / elapsed;
+
+    std::cout << "Throughput: " << frames_per_second << " frames/s, " << frames_per_second * frame_size / (1024.0 * 1024.0) << " MB/s, "
+              << receiver.get_num_dropped_messages() - first_dropped << " messages replaced before decoding" << std::endl;
+
+    return 0;
+}
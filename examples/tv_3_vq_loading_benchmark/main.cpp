@@ -0,0 +1,161 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+
+// Measures how fast several vector quantized time-varying volumes load at the
+// same time. Synthetic sequences (index volumes plus one codebook per time
+// step) are written to the working directory, then 1, 2, 4 ... resources are
+// created concurrently and the time until their codebook windows are resident
+// is reported. The streamers of all resources share one pool with a loader
+// thread per core, so the aggregate throughput should grow with the number of
+// datasets until the disk or the pool is saturated. Files are read from the
+// page cache unless it is dropped between runs.
+
+#include <gua/renderer/TV_3ResourceVQCompressed.hpp>
+#include <gua/utils/TimeStepStreamer.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using clock_type = std::chrono::high_resolution_clock;
+
+// 128^3 voxels in 4^3 blocks with 16 bit indices, 2^14 codewords (1 MB per codebook)
+std::string const VOLUME_TOKENS = "w128_h128_d128_b8_bs4_i16_a14";
+std::size_t const INDEX_VOLUME_BYTES = 32 * 32 * 32 * 2;
+std::size_t const CODEBOOK_BYTES = 16384 * 64;
+
+void write_file(std::string const& file_name, std::size_t num_bytes, unsigned seed)
+{
+    std::vector<char> data(num_bytes);
+    for(std::size_t i = 0; i != num_bytes; ++i)
+    {
+        data[i] = char((i * 2654435761u + seed) >> 7);
+    }
+    std::ofstream(file_name, std::ios::binary).write(data.data(), data.size());
+}
+
+// returns the .v_rsc file listing all time steps of the sequence
+std::string write_sequence(unsigned sequence, unsigned num_time_steps, std::vector<std::string>& written_files)
+{
+    std::string const prefix = "vq_benchmark_seq" + std::to_string(sequence);
+    std::string const resource_file_name = prefix + "_MCM.v_rsc";
+
+    std::ofstream resource_file(resource_file_name);
+    for(unsigned step = 0; step != num_time_steps; ++step)
+    {
+        std::string const volume_file_name = prefix + "_step" + std::to_string(step) + "_" + VOLUME_TOKENS + ".raw";
+        write_file(volume_file_name, INDEX_VOLUME_BYTES, sequence * num_time_steps + step);
+        write_file(volume_file_name + ".cb", CODEBOOK_BYTES, ~(sequence * num_time_steps + step));
+        resource_file << volume_file_name << "\n";
+
+        written_files.push_back(volume_file_name);
+        written_files.push_back(volume_file_name + ".cb");
+    }
+
+    written_files.push_back(resource_file_name);
+    return resource_file_name;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    unsigned const max_num_sequences = argc > 1 ? unsigned(std::atoi(argv[1])) : 8;
+    unsigned const num_time_steps = argc > 2 ? unsigned(std::atoi(argv[2])) : 64;
+    std::size_t const budget_in_bytes = std::size_t(argc > 3 ? std::atoi(argv[3]) : 48) * 1024 * 1024;
+
+    std::vector<std::string> written_files;
+    std::vector<std::string> resource_files;
+    for(unsigned sequence = 0; sequence != max_num_sequences; ++sequence)
+    {
+        resource_files.push_back(write_sequence(sequence, num_time_steps, written_files));
+    }
+
+    std::cout << "sequences of " << num_time_steps << " steps, " << budget_in_bytes / (1024 * 1024) << " MB budget per resource, " << std::thread::hardware_concurrency() << " cores"
+              << std::endl;
+
+    double single_throughput = 0.0;
+
+    for(unsigned num_sequences = 1; num_sequences <= max_num_sequences; num_sequences *= 2)
+    {
+        std::vector<std::shared_ptr<gua::TV_3ResourceVQCompressed>> resources(num_sequences);
+
+        auto const start = clock_type::now();
+
+        // resources are created and filled concurrently, like several nodes loaded by different threads
+        std::vector<std::thread> loaders;
+        for(unsigned sequence = 0; sequence != num_sequences; ++sequence)
+        {
+            loaders.emplace_back([&, sequence]() {
+                resources[sequence] = std::make_shared<gua::TV_3ResourceVQCompressed>(resource_files[sequence], false, true, budget_in_bytes);
+
+                // play the whole sequence back, waiting for each window to become resident
+                auto const& codebooks = resources[sequence]->get_codebook_streamer();
+                std::size_t const window_size = std::max(std::size_t(1), codebooks->get_window_size());
+                for(std::size_t cursor = 0; cursor < num_time_steps; cursor += window_size)
+                {
+                    codebooks->set_playback(float(cursor), 0.0f);
+                    resources[sequence]->get_time_step_streamer()->set_playback(float(cursor), 0.0f);
+                    codebooks->wait_for_prefetch();
+                    resources[sequence]->get_time_step_streamer()->wait_for_prefetch();
+                }
+            });
+        }
+        for(auto& loader : loaders)
+        {
+            loader.join();
+        }
+
+        double const seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+
+        std::size_t num_loaded = 0;
+        for(auto const& resource : resources)
+        {
+            num_loaded += resource->get_codebook_streamer()->get_statistics().prefetched;
+        }
+
+        double const throughput = num_loaded * CODEBOOK_BYTES / (1024.0 * 1024.0) / seconds;
+        if(num_sequences == 1)
+        {
+            single_throughput = throughput;
+        }
+
+        std::cout << num_sequences << " sequences: " << num_loaded << " codebooks in " << seconds * 1000.0 << " ms, " << throughput << " MB/s, scaling "
+                  << (single_throughput > 0.0 ? throughput / single_throughput : 0.0) << " (ideal " << num_sequences << ")" << std::endl;
+    }
+
+    for(auto const& file_name : written_files)
+    {
+        std::remove(file_name.c_str());
+    }
+
+    return 0;
+}
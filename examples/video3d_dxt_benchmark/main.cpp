@@ -0,0 +1,168 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+// Measures the DXT compression of synthetic color streams at Kinect
+// resolutions for one to four sensors. Every sensor has its own
+// DXTCompressor, as in a capture server. Frames consist of a static
+// background and a moving foreground rectangle so that background masking
+// has something to skip.
+
+#include <gua/video3d/video3d_geometry/DXTCompressor.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using clock_type = std::chrono::high_resolution_clock;
+
+struct Resolution
+{
+    unsigned width;
+    unsigned height;
+    char const* name;
+};
+
+void create_frame(std::vector<unsigned char>& rgb, unsigned width, unsigned height, unsigned frame)
+{
+    rgb.resize(std::size_t(width) * height * 3);
+
+    unsigned const size = height / 4;
+    unsigned const x0 = (frame * 16) % (width - size);
+    unsigned const y0 = height / 2 - size / 2;
+
+    for(unsigned y = 0; y < height; ++y)
+    {
+        for(unsigned x = 0; x < width; ++x)
+        {
+            unsigned char* pixel = &rgb[(std::size_t(y) * width + x) * 3];
+            if(x >= x0 && x < x0 + size && y >= y0 && y < y0 + size)
+            {
+                pixel[0] = 220;
+                pixel[1] = (unsigned char)(x - x0);
+                pixel[2] = (unsigned char)(y - y0);
+            }
+            else
+            {
+                pixel[0] = (unsigned char)(x * 255 / width);
+                pixel[1] = (unsigned char)(y * 255 / height);
+                pixel[2] = 96;
+            }
+        }
+    }
+}
+
+double run(Resolution const& resolution, unsigned num_sensors, unsigned num_threads, bool masking, unsigned num_frames, unsigned& skipped_blocks)
+{
+    std::vector<std::unique_ptr<mvt::DXTCompressor>> compressors;
+    for(unsigned s = 0; s < num_sensors; ++s)
+    {
+        compressors.emplace_back(new mvt::DXTCompressor());
+        compressors.back()->init(resolution.width, resolution.height, FORMAT_DXT1, num_threads);
+        compressors.back()->setBackgroundMasking(masking);
+    }
+
+    // a few distinct frames, generating them is not part of the measurement
+    std::vector<std::vector<unsigned char>> frames(8);
+    for(unsigned f = 0; f < frames.size(); ++f)
+    {
+        create_frame(frames[f], resolution.width, resolution.height, f);
+    }
+
+    std::vector<unsigned char> background;
+    create_frame(background, resolution.width, resolution.height, 0);
+    for(auto& compressor : compressors)
+    {
+        compressor->compress(background.data(), true);
+    }
+
+    skipped_blocks = 0;
+    auto start = clock_type::now();
+    for(unsigned f = 0; f < num_frames; ++f)
+    {
+        for(auto& compressor : compressors)
+        {
+            compressor->compress(frames[f % frames.size()].data());
+            skipped_blocks += compressor->getNumSkippedBlocks();
+        }
+    }
+    double const elapsed = std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+
+    skipped_blocks /= num_frames * num_sensors;
+    return elapsed / num_frames;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    unsigned num_frames = 100;
+    unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    if(argc > 1)
+    {
+        num_frames = std::max(1ul, std::stoul(argv[1]));
+    }
+    if(argc > 2)
+    {
+        max_threads = std::max(1ul, std::stoul(argv[2]));
+    }
+
+    std::vector<Resolution> const resolutions{{1280, 1080, "color 1280x1080"}, {1920, 1080, "color 1920x1080"}, {512, 424, "depth 512x424"}};
+
+    for(auto const& resolution : resolutions)
+    {
+        std::cout << resolution.name << std::endl;
+
+        for(unsigned num_sensors = 1; num_sensors <= 4; ++num_sensors)
+        {
+            for(unsigned num_threads : {1u, max_threads})
+            {
+                for(bool masking : {false, true})
+                {
+                    unsigned skipped_blocks = 0;
+                    double const ms = run(resolution, num_sensors, num_threads, masking, num_frames, skipped_blocks);
+                    double const megapixels = num_sensors * double(resolution.width) * resolution.height / (1000.0 * 1000.0);
+
+                    std::cout << "  sensors " << num_sensors << ", threads " << num_threads << (masking ? ", masked  " : ", unmasked") << ": " << ms << " ms/frame, "
+                              << megapixels * 1000.0 / ms << " MPixel/s";
+                    if(masking)
+                    {
+                        std::cout << ", " << skipped_blocks << " of " << resolution.width * resolution.height / 16 << " blocks skipped";
+                    }
+                    std::cout << std::endl;
+                }
+
+                if(max_threads == 1)
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
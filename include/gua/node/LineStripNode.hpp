@@ -104,6 +104,9 @@ class GUA_DLL LineStripNode : public GeometryNode
 
     void clear_vertices();
 
+    // keeps the vertices in a ring, trimming the front of long trails doesn't move or re-upload the other vertices
+    void set_ring_buffer_mode(bool enable);
+
     void forward_queued_vertices();
 
     void compile_buffer_string(std::string& buffer_string);
@@ -121,6 +124,8 @@ class GUA_DLL LineStripNode : public GeometryNode
 
     void update_cache() override;
 
+    std::size_t get_geometry_revision() const override;
+
     std::shared_ptr<LineStripResource> const& get_geometry() const;
 
     bool get_trigger_update() const { return trigger_update_; }
@@ -398,6 +398,16 @@ class GUA_DLL Node
      */
     virtual void update_cache();
 
+    /**
+     * Changes whenever the geometry drawn by the Node changes while its
+     * transformation stays the same, e.g. for animated, streamed or edited
+     * vertices. Cached renderings of the Node (like shadow atlas tiles) are
+     * redrawn when it changes.
+     *
+     * \return size_t    The geometry revision, 0 for static geometry.
+     */
+    virtual std::size_t get_geometry_revision() const { return 0; }
+
     /**
      * Adds user-defined data to a Node.
      *
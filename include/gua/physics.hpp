@@ -24,6 +24,7 @@
 
 // main include
 #include <gua/physics/Physics.hpp>
+#include <gua/physics/PhysicsWorldGroup.hpp>
 
 // scenegraph nodes
 #include <gua/physics/CollisionShapeNode.hpp>
@@ -31,6 +32,7 @@
 
 // collision shapes
 #include <gua/physics/BoxShape.hpp>
+#include <gua/physics/CollisionMeshCache.hpp>
 #include <gua/physics/ConvexHullShape.hpp>
 #include <gua/physics/CylinderShape.hpp>
 #include <gua/physics/PlaneShape.hpp>
@@ -0,0 +1,166 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef GUA_COLLISION_MESH_CACHE_HPP
+#define GUA_COLLISION_MESH_CACHE_HPP
+
+// guacamole headers
+#include <gua/platform.hpp>
+#include <gua/utils/Singleton.hpp>
+
+// external headers
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class btBvhTriangleMeshShape;
+class btTriangleIndexVertexArray;
+
+namespace gua
+{
+namespace physics
+{
+/**
+ * A store for collision data derived from triangle meshes.
+ *
+ * Building a BVH or a convex decomposition is expensive, so both are built
+ * once per geometry and parameter set and shared by all shapes which use
+ * them. An entry lives as long as a shape holds it.
+ *
+ * If a cache directory is set, built data is also written there and read
+ * back instead of being rebuilt in later runs. Files are named after a hash
+ * of the welded mesh and the parameters, changed geometry never picks up an
+ * outdated file.
+ */
+class GUA_DLL CollisionMeshCache : public Singleton<CollisionMeshCache>
+{
+  public:
+    static const uint32_t CACHE_VERSION = 1;
+
+    // a triangle mesh without duplicate vertices
+    struct Mesh
+    {
+        std::vector<double> positions;
+        std::vector<int> indices;
+    };
+
+    struct HACDParameters
+    {
+        unsigned min_clusters = 2;
+        unsigned max_ch_vertices = 100;
+        double concavity = 80.0;
+        bool add_extra_dist_points = false;
+        bool add_neighbours_dist_points = false;
+        bool add_faces_points = false;
+    };
+
+    /**
+     * A Bullet BVH triangle mesh shape and the vertex data it refers to.
+     *
+     * The shape is never modified after construction and may be used by
+     * several collision objects at once. Scaling has to be applied with a
+     * btScaledBvhTriangleMeshShape wrapped around it.
+     */
+    class GUA_DLL StaticMesh
+    {
+      public:
+        ~StaticMesh();
+
+        btBvhTriangleMeshShape* shape() const { return shape_; }
+
+      private:
+        friend class CollisionMeshCache;
+
+        StaticMesh() = default;
+        StaticMesh(StaticMesh const&) = delete;
+        StaticMesh& operator=(StaticMesh const&) = delete;
+
+        void create_mesh_interface();
+
+        std::vector<float> positions_;
+        std::vector<int> indices_;
+        btTriangleIndexVertexArray* mesh_interface_ = nullptr;
+
+        // a BVH deserialized in place, the shape does not own it
+        void* bvh_buffer_ = nullptr;
+
+        btBvhTriangleMeshShape* shape_ = nullptr;
+    };
+
+    // the points of the convex hulls a mesh has been decomposed into
+    struct ConvexDecomposition
+    {
+        std::vector<double> points;
+        std::vector<unsigned> hull_sizes;
+    };
+
+    /**
+     * Sets the directory for cache files. The directory has to exist, an
+     * empty string disables reading and writing cache files.
+     */
+    void set_directory(std::string const& directory);
+    std::string get_directory() const;
+
+    /**
+     * Returns the BVH mesh stored for a name. If there is none, collect is
+     * called to fill the mesh it is built from.
+     */
+    std::shared_ptr<StaticMesh const> get_static_mesh(std::string const& name, std::function<void(Mesh&)> const& collect);
+
+    /**
+     * Returns the convex decomposition stored for a name and parameters. If
+     * there is none, collect is called to fill the mesh which is decomposed.
+     */
+    std::shared_ptr<ConvexDecomposition const> get_convex_decomposition(std::string const& name, HACDParameters const& parameters, std::function<void(Mesh&)> const& collect);
+
+    static std::shared_ptr<StaticMesh> build_static_mesh(Mesh const& mesh);
+    static bool save_static_mesh(std::string const& file_name, uint64_t key, StaticMesh const& static_mesh);
+    static std::shared_ptr<StaticMesh> load_static_mesh(std::string const& file_name, uint64_t key);
+
+    static std::shared_ptr<ConvexDecomposition> decompose(Mesh const& mesh, HACDParameters const& parameters);
+    static bool save_convex_decomposition(std::string const& file_name, uint64_t key, ConvexDecomposition const& decomposition);
+    static std::shared_ptr<ConvexDecomposition> load_convex_decomposition(std::string const& file_name, uint64_t key);
+
+    static uint64_t hash(Mesh const& mesh);
+    static uint64_t hash(Mesh const& mesh, HACDParameters const& parameters);
+
+    friend class Singleton<CollisionMeshCache>;
+
+  private:
+    CollisionMeshCache() {}
+    ~CollisionMeshCache() {}
+
+    std::string cache_file_name(uint64_t key, std::string const& extension) const;
+
+    mutable std::mutex mutex_;
+    std::string directory_;
+    std::unordered_map<std::string, std::weak_ptr<StaticMesh const>> static_meshes_;
+    std::unordered_map<std::string, std::weak_ptr<ConvexDecomposition const>> convex_decompositions_;
+};
+
+} // namespace physics
+} // namespace gua
+
+#endif // GUA_COLLISION_MESH_CACHE_HPP
@@ -24,7 +24,6 @@
 
 // external headers
 #include <LinearMath/btMotionState.h>
-#include <utility>
 
 namespace gua
 {
@@ -75,44 +74,25 @@ class GuaMotionState : public btMotionState
     virtual void setWorldTransform(const btTransform& centerOfMassWorldTrans);
 
     /**
-     * Gets the latest world transform that becomes available after
-     *        calling flip_reader().
-     *        This method is called by RigidBodyNode::get_transform().
+     * Gets the latest world transform published by the simulation. This
+     *        method is called by RigidBodyNode::get_transform().
      *
      * \param [out] centerOfMassWorldTrans Output where transform should be
      *                                     stored.
-     * \sa    flip_reader()
+     * \sa    set_latest_transform()
      */
     virtual void latest_transform(btTransform& centerOfMassWorldTrans) const;
 
     /**
-     * Copies the transform from the writer's buffer to the intermediate
-     *        buffer. This method is used in Physics::simulate().
+     * Sets the transform returned by latest_transform().
+     *        Physics::synchronize() calls this method for all rigid bodies
+     *        with the transforms of the latest simulation step.
      */
-    inline void flip_writer()
-    {
-        *transforms_[1] = *transforms_[0];
-        dirty = true;
-    }
-
-    /**
-     * Copies the transform from the intermediate buffer to the reader's
-     *        buffer. Physics::synchronize() calls this method for all
-     *        rigid bodies to retrieve the latest available transforms.
-     * \sa    latest_transform()
-     */
-    inline void flip_reader()
-    {
-        if(dirty)
-        {
-            std::swap(transforms_[1], transforms_[2]);
-            dirty = false;
-        }
-    }
+    inline void set_latest_transform(const btTransform& centerOfMassWorldTrans) { *transforms_[1] = centerOfMassWorldTrans; }
 
   private:
-    btTransform* transforms_[3];
-    bool dirty;
+    // the transform of the simulation and the one of the scene graph
+    btTransform* transforms_[2];
 };
 
 } // namespace physics
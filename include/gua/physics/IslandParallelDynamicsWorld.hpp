@@ -0,0 +1,127 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef GUA_ISLAND_PARALLEL_DYNAMICS_WORLD_HPP
+#define GUA_ISLAND_PARALLEL_DYNAMICS_WORLD_HPP
+
+// external headers
+#include <btBulletDynamicsCommon.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gua
+{
+namespace physics
+{
+/**
+ * A btDiscreteDynamicsWorld which solves independent simulation islands
+ *        on several threads.
+ *
+ * Islands are groups of bodies connected by contacts or constraints. They
+ * are independent of each other, so each thread solves a batch of islands
+ * with its own btSequentialImpulseConstraintSolver. Islands touching
+ * kinematic bodies share these bodies and are solved on the simulation
+ * thread. Collision detection and integration are not parallelized.
+ *
+ * This class is used internally by Physics, see Physics::set_solver_threads().
+ */
+class IslandParallelDynamicsWorld : public btDiscreteDynamicsWorld
+{
+  public:
+    IslandParallelDynamicsWorld(btDispatcher* dispatcher, btBroadphaseInterface* broadphase, btConstraintSolver* solver, btCollisionConfiguration* collision_configuration);
+
+    ~IslandParallelDynamicsWorld();
+
+    /**
+     * Sets the number of threads the islands are solved on, including
+     *        the one stepping the world. With one thread, the constraint
+     *        solver of the world solves all islands.
+     *
+     * Must not be called during a simulation step. Without a thread safe
+     * profiler in Bullet (version 2.87 or later, or built with
+     * BT_NO_PROFILE), this is always one.
+     *
+     * \param num_threads Number of threads.
+     */
+    void set_num_threads(unsigned num_threads);
+    unsigned get_num_threads() const { return unsigned(workers_.size()) + 1; }
+
+    /**
+     * True if Bullet allows solving islands on several threads.
+     */
+    static bool parallel_solving_supported();
+
+    IslandParallelDynamicsWorld(IslandParallelDynamicsWorld const&) = delete;
+    IslandParallelDynamicsWorld& operator=(IslandParallelDynamicsWorld const&) = delete;
+
+  protected:
+    virtual void solveConstraints(btContactSolverInfo& solver_info);
+
+  private:
+    struct Island
+    {
+        std::vector<btCollisionObject*> bodies;
+        btPersistentManifold** manifolds;
+        int num_manifolds;
+        btTypedConstraint** constraints;
+        int num_constraints;
+        bool kinematic;
+    };
+
+    // the islands solved by one thread in one step
+    struct Batch
+    {
+        std::vector<btCollisionObject*> bodies;
+        std::vector<btPersistentManifold*> manifolds;
+        std::vector<btTypedConstraint*> constraints;
+        std::size_t cost;
+    };
+
+    class IslandCollector;
+
+    void distribute_islands();
+    void solve_batch(unsigned index);
+    void work(unsigned index);
+    void stop_workers();
+
+    std::vector<Island> islands_;
+    std::vector<btTypedConstraint*> sorted_constraints_;
+    std::vector<Batch> batches_;
+    std::vector<std::unique_ptr<btSequentialImpulseConstraintSolver>> solvers_;
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable batches_ready_;
+    std::condition_variable batches_done_;
+    btContactSolverInfo const* solver_info_;
+    unsigned generation_;
+    unsigned pending_;
+    bool running_;
+};
+
+} // namespace physics
+} // namespace gua
+
+#endif // GUA_ISLAND_PARALLEL_DYNAMICS_WORLD_HPP
@@ -26,18 +26,22 @@
 #include <gua/platform.hpp>
 #include <gua/scenegraph/SceneGraph.hpp>
 #include <gua/physics/CollisionShapeNodeVisitor.hpp>
+#include <gua/physics/IslandParallelDynamicsWorld.hpp>
 #include <gua/physics/RigidBodyNode.hpp>
+#include <gua/utils/MPSCQueue.hpp>
 #include <gua/utils/SpinLock.hpp>
+#include <gua/utils/TripleBuffer.hpp>
 
 #include <btBulletDynamicsCommon.h>
 
 // external headers
 #include <vector>
-#include <queue>
 #include <atomic>
+#include <functional>
 #include <thread>
 #include <mutex>
 #include <chrono>
+#include <cstdint>
 
 // forward declarations of Bullet's classes
 class btDynamicsWorld;
@@ -59,6 +63,7 @@ const int physics_default_max_sim_time = int(1.e6 / 200); // microseconds
 
 // class RigidBodyNode;
 class Constraint;
+class PhysicsWorldGroup;
 
 /**
  * Physics class represents a physical simulation manager.
@@ -66,9 +71,22 @@ class Constraint;
  * This class adds realistic physical simulation to guacamole. It holds all
  * rigid bodies and constraints as well as provides scene graph traversal
  * capability and methods to tune simulation parameters.
+ *
+ * The simulation thread publishes the transforms of all rigid bodies once
+ * per step as a snapshot, which synchronize() picks up without locking.
+ * Adding and removing rigid bodies as well as applying forces and impulses
+ * is queued and carried out by the simulation thread right before its next
+ * step, so none of these calls waits for a running step.
+ *
+ * Each instance is an independent world. Several worlds can be simulated in
+ * parallel, each on its own simulation thread or together on the threads of
+ * a PhysicsWorldGroup.
  */
 class GUA_DLL Physics
 {
+    friend class RigidBodyNode;
+    friend class PhysicsWorldGroup;
+
   public:
     Physics();
     /**
@@ -118,12 +136,13 @@ class GUA_DLL Physics
     /**
      * Checks if the simulation is running.
      *
-     * \return True, if the simulation is running. Please note that the
-     *         function returns true even if the simulation thread is being
-     *         initialized. Identically, it returns false when the
-     *         simulation is about to stop but not yet stopped.
+     * \return True, if the simulation is running or the world belongs to a
+     *         PhysicsWorldGroup. Please note that the function returns true
+     *         even if the simulation thread is being initialized.
+     *         Identically, it returns false when the simulation is about to
+     *         stop but not yet stopped.
      */
-    bool is_running() const { return !is_stopped_.load(); }
+    bool is_running() const { return !is_stopped_.load() || group_.load(); }
 
     void set_gravity(math::vec3 const& gravity);
     math::vec3 get_gravity() const;
@@ -167,6 +186,39 @@ class GUA_DLL Physics
      */
     void simulation_rate_reduction(bool enabled, int max_sim_time = physics_default_max_sim_time);
 
+    /**
+     * Sets the number of threads the constraint solver uses.
+     *
+     * Independent simulation islands, i.e. groups of bodies which touch or
+     * are connected by constraints, are solved in parallel. This only pays
+     * off for worlds with many islands. Requires Bullet 2.87 or later, or a
+     * Bullet build with BT_NO_PROFILE; otherwise the solver stays on the
+     * simulation thread.
+     *
+     * \param num_threads Number of threads, including the simulation thread.
+     */
+    void set_solver_threads(unsigned num_threads);
+    unsigned get_solver_threads() const { return dw_->get_num_threads(); }
+
+    /**
+     * Gets the number of fixed timesteps simulated so far.
+     */
+    std::uint64_t get_num_steps() const { return num_steps_.load(); }
+
+    /**
+     * Enables and disables interpolation of rigid body transforms.
+     *
+     * If enabled, synchronize() blends the transforms of the last two
+     * simulation steps according to the time passed since the latest one.
+     * Bodies then move smoothly at any frame rate, but lag one simulation
+     * step behind. Otherwise the transforms of the latest step are applied.
+     *
+     * \param enabled True if interpolation should be enabled.
+     */
+    void set_interpolation(bool enabled) { interpolation_ = enabled; }
+
+    bool get_interpolation() const { return interpolation_; }
+
     /**
      * Applies new transforms to scene graph nodes and prepares
      *        collision shapes.
@@ -178,7 +230,8 @@ class GUA_DLL Physics
      *
      * \param auto_start  Automatically starts the simulation if it is not
      *                    running.
-     * \sa    RigidBodyNode, CollisionShapeNode, add_rigid_body()
+     * \sa    RigidBodyNode, CollisionShapeNode, add_rigid_body(),
+     *        set_interpolation()
      */
     void synchronize(bool auto_start = false);
 
@@ -204,6 +257,9 @@ class GUA_DLL Physics
     /**
      * Removes a rigid body from the simulation.
      *
+     * The body is taken out of the dynamics world before the next simulation
+     * step and must not be modified until then.
+     *
      * \param body Scene graph's rigid body node to be removed.
      */
     void remove_rigid_body(std::shared_ptr<RigidBodyNode> const& body);
@@ -277,11 +333,55 @@ class GUA_DLL Physics
     Physics& operator=(Physics&&) = delete;
 
   private:
+    // transforms of all simulated bodies after a simulation step, indexed by
+    // the snapshot slots of the bodies
+    struct TransformSnapshot
+    {
+        std::chrono::steady_clock::time_point previous_time;
+        std::chrono::steady_clock::time_point time;
+
+        // id of the body in each slot, 0 for unused slots
+        std::vector<unsigned> body_ids;
+
+        // transforms of the step before and of the latest step
+        btAlignedObjectArray<btTransform> previous_transforms;
+        btAlignedObjectArray<btTransform> transforms;
+    };
+
     // the simulation thread entry point.
     void simulate();
 
-    // pop front element from call-once queue
-    bool pop_call_once(std::function<void()>& value);
+    // steps the world by the time passed since the previous step, returns
+    // the time the step started
+    std::chrono::steady_clock::time_point simulate_step();
+
+    // when the step after one started at step_start should start
+    std::chrono::steady_clock::time_point next_step_due(std::chrono::steady_clock::time_point step_start) const;
+
+    // steps the world for a worker of its PhysicsWorldGroup unless it is
+    // paused, returns when the world is due again
+    std::chrono::steady_clock::time_point simulate_group_step();
+
+    // called by PhysicsWorldGroup when the world is added or removed
+    void set_group(PhysicsWorldGroup* group);
+
+    // queues command for the next step of the world, taken by the simulation
+    // thread or a worker of the group (even while the group is stopped); it
+    // runs right away only if the world has neither
+    void post_command(std::function<void()> command);
+
+    // executes all queued commands, simulation_mutex_ has to be locked
+    void process_commands();
+
+    // assigns a snapshot slot to a new body, returns false if it is already
+    // added; bodies_mutex_ has to be locked
+    bool register_rigid_body(std::shared_ptr<RigidBodyNode> const& body);
+
+    // bookkeeping of the simulation thread when a body enters or leaves the world
+    void add_simulated_body(std::shared_ptr<RigidBodyNode> const& body);
+    void remove_simulated_body(RigidBodyNode& body);
+
+    void publish_snapshot(std::chrono::steady_clock::time_point previous_time, std::chrono::steady_clock::time_point time);
 
     // ensures exclusive access to the physics structures.
     mutable std::mutex simulation_mutex_;
@@ -290,13 +390,16 @@ class GUA_DLL Physics
     // the same time.
     mutable std::mutex start_stop_mutex_;
 
-    // ensures exclusive access to buffers in motion state updates.
-    mutable SpinLock motion_state_update_mutex_;
-
     SpinLock pause_mutex_;
 
     std::thread* thread_ = nullptr;
     std::atomic<bool> is_stopped_;
+    std::atomic<bool> is_paused_;
+
+    // the group stepping this world instead of thread_
+    std::atomic<PhysicsWorldGroup*> group_;
+    std::chrono::steady_clock::time_point last_step_time_;
+    std::atomic<std::uint64_t> num_steps_;
 
     float fixed_timestep_;
     bool reduce_sim_rate_;
@@ -305,19 +408,38 @@ class GUA_DLL Physics
 
     CollisionShapeNodeVisitor shape_visitor_;
 
+    bool interpolation_;
+
     // queue for call-once functions
-    std::queue<std::function<void()>> call_once_queue_;
-    std::mutex call_once_queue_mutex_;
+    MPSCQueue<std::function<void()>> call_once_queue_;
+
+    // adds, removals and impulses for the simulation thread
+    MPSCQueue<std::function<void()>> commands_;
+
+    TripleBuffer<TransformSnapshot> snapshots_;
 
     // Bullet's objects
     btBroadphaseInterface* broadphase_ = nullptr;
     btDefaultCollisionConfiguration* collision_configuration_ = nullptr;
     btCollisionDispatcher* dispatcher_ = nullptr;
     btSequentialImpulseConstraintSolver* solver_ = nullptr;
-    btDynamicsWorld* dw_ = nullptr;
-    std::vector<std::shared_ptr<RigidBodyNode>> rigid_bodies_;
+    IslandParallelDynamicsWorld* dw_ = nullptr;
     std::vector<Constraint*> constraints_;
 
+    // guards the added bodies and their snapshot slots, which any thread may
+    // change through add_rigid_body() and remove_rigid_body()
+    std::mutex bodies_mutex_;
+    std::vector<std::shared_ptr<RigidBodyNode>> rigid_bodies_;
+    std::vector<unsigned> free_snapshot_slots_;
+    unsigned num_snapshot_slots_ = 0;
+    unsigned last_snapshot_id_ = 0;
+
+    // bodies in the dynamics world and their latest transforms, only used
+    // by the simulation thread
+    std::vector<std::shared_ptr<RigidBodyNode>> simulated_bodies_;
+    std::vector<unsigned> simulated_body_ids_;
+    btAlignedObjectArray<btTransform> simulated_transforms_;
+
     /// \todo Change this to std::atomic<float> after upgrade to GCC 4.7
     float physics_fps_;
 };
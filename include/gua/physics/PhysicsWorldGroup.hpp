@@ -0,0 +1,124 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef GUA_PHYSICS_WORLD_GROUP_HPP
+#define GUA_PHYSICS_WORLD_GROUP_HPP
+
+// guacamole headers
+#include <gua/platform.hpp>
+
+// external headers
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gua
+{
+namespace physics
+{
+class Physics;
+
+/**
+ * Steps several independent physics worlds in parallel.
+ *
+ * Each world is a Physics instance with its own rigid bodies, constraints
+ * and fixed timestep. Instead of a simulation thread per world, the worlds
+ * of a group share a number of worker threads which always step the world
+ * that is due next. A world is due as soon as its previous step has
+ * finished or, if simulation rate reduction is enabled, when the maximum
+ * simulation time has passed (see Physics::simulation_rate_reduction()).
+ *
+ * While a world belongs to a group, Physics::start_simulation() has no
+ * effect and Physics::is_running() returns true. Rigid bodies are added and
+ * removed and transforms are synchronized just as with a simulation thread.
+ */
+class GUA_DLL PhysicsWorldGroup
+{
+  public:
+    PhysicsWorldGroup();
+
+    /**
+     * Destructor.
+     *
+     * Stops the worker threads and removes all worlds.
+     */
+    ~PhysicsWorldGroup();
+
+    /**
+     * Adds a world to the group. If the group is running, the world is
+     *        stepped right away.
+     *
+     * \param world The world to add.
+     * \return      False if the world is running on its own simulation
+     *              thread or in another group.
+     */
+    bool add_world(std::shared_ptr<Physics> const& world);
+
+    /**
+     * Removes a world from the group. Waits for a running step of the
+     *        world to finish.
+     *
+     * \param world The world to remove.
+     */
+    void remove_world(std::shared_ptr<Physics> const& world);
+
+    /**
+     * Starts stepping the worlds.
+     *
+     * \param num_threads Number of worker threads, the number of cores if 0.
+     */
+    void start(unsigned num_threads = 0);
+
+    /**
+     * Stops stepping the worlds. Waits for running steps to finish.
+     */
+    void stop();
+
+    bool is_running() const;
+    unsigned get_num_threads() const;
+
+    PhysicsWorldGroup(PhysicsWorldGroup const&) = delete;
+    PhysicsWorldGroup& operator=(PhysicsWorldGroup const&) = delete;
+
+  private:
+    struct World
+    {
+        std::shared_ptr<Physics> physics;
+        std::chrono::steady_clock::time_point due;
+        bool stepping;
+    };
+
+    void work();
+
+    std::vector<World> worlds_;
+    std::vector<std::thread> workers_;
+    mutable std::mutex mutex_;
+    std::condition_variable world_available_;
+    bool running_;
+};
+
+} // namespace physics
+} // namespace gua
+
+#endif // GUA_PHYSICS_WORLD_GROUP_HPP
@@ -27,6 +27,7 @@
 #include <gua/node/TransformNode.hpp>
 
 // external headers
+#include <functional>
 #include <memory>
 #include <vector>
 #include <btBulletDynamicsCommon.h>
@@ -43,7 +44,9 @@ class CollisionShape;
  * This class represents a physically simulated rigid body
  *        in the scene graph.
  *
- *
+ * Forces, torques and impulses applied to a body which takes part in a
+ * simulation are queued and take effect right before the next simulation
+ * step, the calling thread never waits for a running step.
  */
 class GUA_DLL RigidBodyNode : public node::TransformNode
 {
@@ -355,6 +358,10 @@ class GUA_DLL RigidBodyNode : public node::TransformNode
     // collision shape.
     void sync_shapes(bool do_not_lock = false);
 
+    // runs action on the simulation thread before the next step, or right away
+    // if the body is not simulated
+    void post_to_simulation(std::function<void(btRigidBody&)> const& action);
+
     std::shared_ptr<node::Node> copy() const override;
 
     // Indicates if the body includes shapes that support static objects only.
@@ -374,6 +381,14 @@ class GUA_DLL RigidBodyNode : public node::TransformNode
     btCompoundShape* bullet_compound_shape_ = nullptr;
     btEmptyShape* bullet_empty_shape_ = nullptr;
 
+    // the slot of the body in the transform snapshots of Physics and the id
+    // which marks that a slot belongs to this body
+    unsigned snapshot_slot_ = 0;
+    unsigned snapshot_id_ = 0;
+
+    // position in the list of bodies the simulation thread steps
+    std::size_t simulated_index_ = 0;
+
     // stores last transform acquired by get_transform(). Useful for checking
     // whether bounding boxes needs to be updated.
     mutable btTransform last_body_transform_;
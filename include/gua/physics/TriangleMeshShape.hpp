@@ -25,21 +25,18 @@
 // guacamole headers
 #include <gua/platform.hpp>
 #include <gua/math/math.hpp>
+#include <gua/physics/CollisionMeshCache.hpp>
 #include <gua/physics/CollisionShape.hpp>
 #include <gua/renderer/TriMeshLoader.hpp>
 #include <gua/renderer/TriMeshRessource.hpp>
+#include <gua/utils/VertexWelder.hpp>
 
 // external headers
 #include <memory>
 #include <string>
 #include <vector>
 #include <btBulletDynamicsCommon.h>
-
-namespace HACD
-{
-template <typename T>
-class Vec3;
-}
+#include <BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h>
 
 namespace gua
 {
@@ -53,6 +50,9 @@ namespace physics
  * The class uses bullet's native BVH triangle mesh for static environments.
  * For dynamic rigid bodies this class uses Hierarchical Approximate Convex
  * Decomposition (HACD).
+ *
+ * BVHs and decompositions are taken from the CollisionMeshCache, shapes
+ * built from the same geometries share them.
  */
 class GUA_DLL TriangleMeshShape : public CollisionShape
 {
@@ -63,7 +63,7 @@ class GUA_DLL TriangleMeshShape : public CollisionShape
      * Creates an empty triangle mesh shape.
      */
     TriangleMeshShape()
-        : CollisionShape(false, false, false), concave_tri_mesh_(nullptr), concave_shape_(nullptr), scaling_(math::vec3(1.f, 1.f, 1.f)), hacd_min_clusters(2), hacd_max_ch_vertices(100),
+        : CollisionShape(false, false, false), concave_shape_(nullptr), scaling_(math::vec3(1.f, 1.f, 1.f)), hacd_min_clusters(2), hacd_max_ch_vertices(100),
           hacd_concavity(80), hacd_add_extra_dist_points(false), hacd_add_neighbours_dist_points(false), hacd_add_faces_points(false)
     {
     }
@@ -143,28 +143,21 @@ class GUA_DLL TriangleMeshShape : public CollisionShape
 
   private:
     /**
-     * Takes an index for a vertex array if the given vertex exists.
-     *        Otherwise adds the vertex and returns its index.
+     * Appends the triangles of a mesh, vertices with the same position are
+     *        merged.
      *
-     * This function is necessary because HACD requires a clean duplicate-free
-     * vertex array.
+     * HACD requires a clean duplicate-free vertex array.
      *
-     * \param points The vertex array.
-     * \param v      The vertex to search.
+     * \param mesh    The mesh.
+     * \param welder  The vertices added so far.
+     * \param indices The vertex indices of the triangles added so far.
      */
-    static long get_point_or_add(std::vector<HACD::Vec3<double>>& points, const math::vec3& v);
+    static void add_triangles(TriMeshRessource const& mesh, VertexWelder& welder, std::vector<int>& indices);
 
-    /**
-     * Performs HACD on the mesh. The function can optionally save
-     *        the result to VRML file for debugging purposes.
-     *
-     * \param mesh      The mesh.
-     * \param file_name File name of WRL-file to save a decomposed mesh.
-     */
-    void decompose_to_convex(std::shared_ptr<TriMeshRessource> const& mesh, std::string const& file_name = "");
+    CollisionMeshCache::HACDParameters hacd_parameters() const;
 
-    btTriangleMesh* concave_tri_mesh_;
-    btBvhTriangleMeshShape* concave_shape_;
+    std::shared_ptr<CollisionMeshCache::StaticMesh const> static_mesh_;
+    btScaledBvhTriangleMeshShape* concave_shape_;
     btAlignedObjectArray<btConvexHullShape*> convex_shapes_;
     math::vec3 scaling_;
 
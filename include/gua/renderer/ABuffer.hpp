@@ -39,6 +39,7 @@ class GUA_DLL ABuffer
         scm::gl::buffer_ptr frag_list;
         scm::gl::buffer_ptr frag_data;
         size_t frag_count = 0;
+        GpuMemoryAllocations memory_allocations;
     };
 
     void allocate(RenderContext& ctx, size_t buffer_size);
@@ -30,6 +30,7 @@
 #include <gua/scenegraph/PickResult.hpp>
 
 // external headers
+#include <atomic>
 #include <string>
 #include <vector>
 #include <scm/gl_util/primitives/box.h>
@@ -70,8 +71,16 @@ class GUA_DLL GeometryResource
 
     inline std::size_t uuid() const { return uuid_; }
 
+    /**
+     * Counts the changes of the geometry after loading, see
+     * node::Node::get_geometry_revision().
+     */
+    virtual std::size_t get_revision() const { return revision_.load(); }
+    void increment_revision() const { ++revision_; }
+
   protected:
     math::BoundingBox<math::vec3> bounding_box_;
+    mutable std::atomic<std::size_t> revision_{0};
 
     std::size_t uuid_ = boost::hash<boost::uuids::uuid>()(boost::uuids::random_generator()());
 };
@@ -0,0 +1,207 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef GUA_GPU_MEMORY_REGISTRY_HPP
+#define GUA_GPU_MEMORY_REGISTRY_HPP
+
+#include <gua/platform.hpp>
+
+// external headers
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gua
+{
+/**
+ * Book-keeping of the GPU memory consumed by the resources of one context.
+ *
+ * Resources report their allocations with track() and release them with
+ * untrack(), usually through a GpuMemoryAllocations member which untracks
+ * them when the resource is destroyed. Allocations which can be recreated on demand (e.g. vertex
+ * buffers of meshes) may pass an evictor; it is called when the allocation
+ * has not been touch()ed for a number of frames or when the context exceeds
+ * its budget. The evictor only has to drop the GPU objects, the owner is
+ * expected to upload them again on next use.
+ *
+ * The registry does not talk to the GPU itself, all sizes are reported by
+ * the resources. Allocations are identified by the address of the object
+ * owning them, see id_of().
+ *
+ * The PLOD plugin reports the configured render budget of its out-of-core
+ * cache rather than its actual use; the caches of the LOD plugin are not
+ * tracked.
+ */
+class GUA_DLL GpuMemoryRegistry
+{
+  public:
+    enum class Category
+    {
+        MESH = 0,
+        LINE_STRIP,
+        TEXTURE,
+        RENDER_TARGET,
+        SHADOW_MAP,
+        ABUFFER,
+        UNIFORM_BUFFER,
+        PLUGIN,
+        OTHER,
+        COUNT
+    };
+
+    using Evictor = std::function<void()>;
+
+    struct Usage
+    {
+        std::size_t bytes = 0;
+        std::size_t high_water_mark = 0;
+        std::size_t allocations = 0;
+        std::size_t evictions = 0;
+    };
+
+    GpuMemoryRegistry() = default;
+
+    // the id of the allocations of an object
+    static std::size_t id_of(void const* owner) { return reinterpret_cast<std::size_t>(owner); }
+
+    /**
+     * Registers an allocation of the given size. Tracking an id twice
+     * replaces the previous entry (e.g. when a buffer is reallocated).
+     */
+    void track(std::size_t id, Category category, std::size_t bytes, std::string const& label = "", Evictor const& evictor = Evictor());
+
+    void untrack(std::size_t id);
+
+    /**
+     * Marks the allocation as used in the current frame.
+     */
+    void touch(std::size_t id);
+
+    bool is_tracked(std::size_t id) const;
+
+    /**
+     * Sets the current frame. Should be called once per frame.
+     */
+    void begin_frame(unsigned frame);
+
+    /**
+     * Evicts all evictable allocations which have not been used within the
+     * last max_idle_frames frames. Returns the number of freed bytes.
+     */
+    std::size_t evict_unused(unsigned max_idle_frames);
+
+    /**
+     * Evicts least recently used allocations until the total size is below
+     * the budget. Allocations used in the current frame are never evicted.
+     * Returns the number of freed bytes.
+     */
+    std::size_t enforce_budget();
+
+    /**
+     * Per-frame maintenance: begin_frame() followed by evict_unused() (if
+     * an idle limit is set) and enforce_budget() (if a budget is set).
+     */
+    std::size_t collect(unsigned frame);
+
+    // 0 means unlimited
+    void set_budget(std::size_t bytes);
+    std::size_t get_budget() const;
+
+    // 0 disables eviction of idle allocations
+    void set_max_idle_frames(unsigned frames);
+    unsigned get_max_idle_frames() const;
+
+    std::size_t get_total_bytes() const;
+    std::size_t get_high_water_mark() const;
+    Usage get_usage(Category category) const;
+
+    /**
+     * Returns the current state as JSON. If include_allocations is true,
+     * all individual allocations are listed as well.
+     */
+    std::string to_json(bool include_allocations = false) const;
+
+    static std::string const& category_name(Category category);
+
+  private:
+    struct Entry
+    {
+        Category category = Category::OTHER;
+        std::size_t bytes = 0;
+        std::string label;
+        Evictor evictor;
+        unsigned last_used = 0;
+    };
+
+    void remove(std::unordered_map<std::size_t, Entry>::iterator const& it, bool evicted);
+    std::size_t evict_if(std::function<bool(Entry const&)> const& predicate, std::size_t bytes_to_free);
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::size_t, Entry> entries_;
+    std::array<Usage, static_cast<std::size_t>(Category::COUNT)> usage_;
+    std::size_t total_bytes_ = 0;
+    std::size_t high_water_mark_ = 0;
+    std::size_t budget_ = 0;
+    unsigned max_idle_frames_ = 0;
+    unsigned frame_ = 0;
+};
+
+/**
+ * The allocations an object has tracked in the registries of the contexts
+ * it was uploaded to.
+ *
+ * Owners keep one as a member and track through it; all allocations are
+ * untracked when it is destroyed, so freed resources are not counted any
+ * longer. Registries which are destroyed first are skipped. Copies start
+ * without allocations, since a copy has an id of its own.
+ */
+class GUA_DLL GpuMemoryAllocations
+{
+  public:
+    GpuMemoryAllocations() = default;
+    GpuMemoryAllocations(GpuMemoryAllocations const&) {}
+    GpuMemoryAllocations& operator=(GpuMemoryAllocations const&) { return *this; }
+    ~GpuMemoryAllocations() { untrack_all(); }
+
+    void track(std::shared_ptr<GpuMemoryRegistry> const& registry,
+               std::size_t id,
+               GpuMemoryRegistry::Category category,
+               std::size_t bytes,
+               std::string const& label = "",
+               GpuMemoryRegistry::Evictor const& evictor = GpuMemoryRegistry::Evictor());
+
+    void untrack(std::shared_ptr<GpuMemoryRegistry> const& registry, std::size_t id);
+    void untrack_all();
+
+  private:
+    std::mutex mutex_;
+    std::vector<std::pair<std::weak_ptr<GpuMemoryRegistry>, std::size_t>> allocations_;
+};
+
+} // namespace gua
+
+#endif // GUA_GPU_MEMORY_REGISTRY_HPP
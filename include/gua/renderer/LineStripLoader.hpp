@@ -63,7 +63,9 @@ class GUA_DLL LineStripLoader
         MAKE_PICKABLE = 1 << 2,
         NORMALIZE_POSITION = 1 << 3,
         NORMALIZE_SCALE = 1 << 4,
-        NO_SHARED_MATERIALS = 1 << 5
+        NO_SHARED_MATERIALS = 1 << 5,
+        // neither read nor write the binary cache of parsed files (<file>.gua_lines)
+        NO_BINARY_CACHE = 1 << 6
     };
 
   public:
@@ -31,6 +31,7 @@
 // external headers
 #include <scm/gl_core.h>
 
+#include <map>
 #include <mutex>
 #include <thread>
 
@@ -83,7 +84,8 @@ class LineStripResource : public GeometryResource
 
     // void resolve_vertex_updates(RenderContext& ctx);
 
-    void make_clean_flags_dirty();
+    // hands the vertex ranges changed since the last call to every context the strip was uploaded to
+    void make_clean_flags_dirty() const;
 
     void compute_bounding_box();
 
@@ -101,6 +103,8 @@ class LineStripResource : public GeometryResource
 
     void clear_vertices();
 
+    void set_ring_buffer_mode(bool enable);
+
     void forward_queued_vertices(std::vector<scm::math::vec3f> const& queued_positions,
                                  std::vector<scm::math::vec4f> const& queued_colors,
                                  std::vector<float> const& queued_thicknesses,
@@ -115,7 +119,8 @@ class LineStripResource : public GeometryResource
     LineStrip line_strip_;
 
     mutable std::mutex line_strip_update_mutex_;
-    mutable std::map<unsigned, bool> clean_flags_per_context_;
+    // vertex buffer ranges still to be uploaded, per context id
+    mutable std::map<unsigned, std::vector<LineStripRing::Range>> dirty_ranges_per_context_;
 
     // std::vector<line_strip_update_job*> line_strip_update_queue_;
 };
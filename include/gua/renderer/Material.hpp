@@ -24,6 +24,12 @@
 
 #include <gua/renderer/ViewDependentUniform.hpp>
 
+#include <boost/functional/hash.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/uuid_generators.hpp>
+
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -69,12 +75,15 @@ class GUA_DLL Material
             tmp.set(view_id, UniformValue(val));
             uniforms_[name] = tmp;
         }
+        view_dependent_ = true;
+        ++uniform_generation_;
         return *this;
     }
 
     Material& reset_uniform(std::string const& name, int view_id)
     {
         uniforms_[name].reset(view_id);
+        ++uniform_generation_;
         return *this;
     }
 
@@ -106,8 +115,25 @@ class GUA_DLL Material
     bool get_enable_virtual_texturing() const { return enable_virtual_texturing_; }
 #endif
 
+    /**
+     * Binds the packed uniform block of this material. The block is only
+     * rewritten and uploaded if the material changed since it was last used
+     * with the given context.
+     */
     void apply_uniforms(RenderContext const& ctx, ShaderProgram* shader, int view) const;
 
+    /**
+     * Writes all uniforms of this material in the std140 layout of the given
+     * shader to target. Returns false if a texture could not be resolved yet.
+     */
+    bool write_uniform_block(RenderContext const& ctx, MaterialShader const& shader, int view, char* target) const;
+
+    // incremented whenever a uniform of this material is changed
+    unsigned get_uniform_generation() const { return uniform_generation_; }
+
+    inline std::size_t uuid() const { return uuid_; }
+    std::weak_ptr<void> lifetime_token() const { return lifetime_token_; }
+
     std::ostream& serialize_uniforms_to_stream(std::ostream& os) const;
     void set_uniforms_from_serialized_string(std::string const& value);
 
@@ -167,6 +193,7 @@ class GUA_DLL Material
     Material& set_uniform(std::string const& name, ViewDependentUniform const& value)
     {
         uniforms_[name] = value;
+        ++uniform_generation_;
         return *this;
     }
 
@@ -182,6 +209,11 @@ class GUA_DLL Material
     bool enable_virtual_texturing_;
 #endif
 
+    bool view_dependent_ = false;
+    std::atomic<unsigned> uniform_generation_{0};
+    std::size_t uuid_ = boost::hash<boost::uuids::uuid>()(boost::uuids::random_generator()());
+    std::shared_ptr<void> lifetime_token_ = std::make_shared<int>(0);
+
     mutable std::mutex mutex_;
 };
 
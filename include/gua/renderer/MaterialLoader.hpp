@@ -28,14 +28,18 @@
 #include <gua/utils/fbxfwd.hpp>
 
 // external headers
+#include <set>
 #include <string>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace Assimp
 {
 class Importer;
 }
 struct aiMaterial;
+struct aiScene;
 
 namespace gua
 {
@@ -47,10 +51,35 @@ class GeometryNode;
  *
  * This class can load mesh data from files and display them in multiple
  * contexts. A MaterialLoader object is made of several Mesh objects.
+ *
+ * If constructed with share_materials, all materials loaded through one
+ * MaterialLoader with identical parameters are the same Material instance
+ * and use the shader of their PBSMaterialFactory capabilities. Otherwise each
+ * call creates a new Material with a shader named after the imported material.
+ * Sharing is opt-in, since changing a shared Material affects every geometry
+ * using it. TriMeshLoader never shares imported materials.
  */
 class GUA_DLL MaterialLoader
 {
   public:
+    /**
+     * Number of imported, unique materials and unique shaders of this loader.
+     */
+    struct Report
+    {
+        unsigned imported_materials = 0;
+        unsigned unique_materials = 0;
+        unsigned unique_shaders = 0;
+    };
+
+    MaterialLoader(bool share_materials = false);
+
+    /**
+     * Loads all materials of a scene, indexed like aiScene::mMaterials. The
+     * material parameters and texture paths are resolved in parallel.
+     */
+    std::vector<std::shared_ptr<Material>> load_materials(aiScene const* scene, std::string const& assets_directory, bool optimize_material = true, bool nrp = false) const;
+
     std::shared_ptr<Material> load_material(aiMaterial const* material, std::string const& assets_directory, bool optimize_material = true, bool nrp = false) const;
 #ifdef GUACAMOLE_FBX
     std::shared_ptr<Material> load_material(FbxSurfaceMaterial const& material, std::string const& assets_directory, bool optimize_material = true, bool nrp = false) const;
@@ -59,8 +88,30 @@ class GUA_DLL MaterialLoader
 #endif
     std::shared_ptr<Material> load_material(std::string const& file_name, std::string const& assets_directory, bool optimize_material = true, bool nrp = false) const;
 
+    Report const& get_report() const { return report_; }
+
     static std::string get_file_name(std::string const& path);
     inline static bool file_exists(std::string const& path);
+
+  private:
+    struct MaterialParameters
+    {
+        unsigned capabilities = 0;
+        std::string material_name;
+        std::vector<std::pair<std::string, UniformValue>> uniforms;
+        std::vector<std::string> textures;
+        std::vector<std::string> warnings;
+        std::string key;
+    };
+
+    static MaterialParameters extract_parameters(aiMaterial const* material, std::string const& assets, bool optimize_material, bool nrp);
+    std::shared_ptr<Material> create_material(MaterialParameters const& parameters) const;
+    std::shared_ptr<Material> register_material(std::string const& key, std::shared_ptr<Material> const& material) const;
+
+    bool share_materials_;
+    mutable std::unordered_map<std::string, std::shared_ptr<Material>> material_cache_;
+    mutable std::set<std::string> shader_names_;
+    mutable Report report_;
 };
 
 } // namespace gua
@@ -29,11 +29,15 @@
 #include <gua/utils/string_utils.hpp>
 
 #include <typeindex>
+#include <vector>
 #include <sstream>
 #include <iostream>
 
 #define MATERIAL_SHADER_PROGRAMS 0
 
+// uniform buffer binding point of the per-draw material block
+#define GUA_MATERIAL_BLOCK_BINDING 5
+
 namespace gua
 {
 class ShaderProgram;
@@ -41,6 +45,15 @@ class ShaderProgram;
 class GUA_DLL MaterialShader
 {
   public:
+    /**
+     * Location of a single material uniform inside the std140 material block.
+     */
+    struct UniformBlockEntry
+    {
+        std::string name;
+        unsigned offset;
+    };
+
     MaterialShader(std::string const& name, std::shared_ptr<MaterialShaderDescription> const& desc);
 
     std::shared_ptr<MaterialShaderDescription> const& get_description() const;
@@ -52,12 +65,26 @@ class GUA_DLL MaterialShader
     std::list<std::shared_ptr<MaterialShaderMethod>> const& get_vertex_methods() const;
     std::list<std::shared_ptr<MaterialShaderMethod>> const& get_fragment_methods() const;
 
+    /**
+     * The std140 layout of the material block generated from all uniforms of
+     * the MaterialShaderDescription. Entries are stored in declaration order.
+     */
+    std::vector<UniformBlockEntry> const& get_uniform_block_layout() const;
+
+    /**
+     * Size of one material block in bytes (padded to 16 bytes). Zero if the
+     * shader has no uniforms.
+     */
+    unsigned get_uniform_block_size() const;
+
     SubstitutionMap generate_substitution_map() const;
 
   private:
     std::shared_ptr<MaterialShaderDescription> desc_;
 
     std::map<std::string, ViewDependentUniform> default_uniforms_;
+    std::vector<UniformBlockEntry> uniform_block_layout_;
+    unsigned uniform_block_size_;
     std::string name_;
 };
 
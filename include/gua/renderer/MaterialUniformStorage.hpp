@@ -0,0 +1,97 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef GUA_MATERIAL_UNIFORM_STORAGE_HPP
+#define GUA_MATERIAL_UNIFORM_STORAGE_HPP
+
+#include <gua/platform.hpp>
+#include <gua/renderer/RenderContext.hpp>
+
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace gua
+{
+class Material;
+class MaterialShader;
+
+/**
+ * Per-context storage of packed material uniform blocks.
+ *
+ * All materials drawn with a context share one large uniform buffer. Each
+ * material (and view, if the material has view-dependent uniforms) owns a
+ * slot in this buffer which is only rewritten and uploaded when the material
+ * changed since its last use. Binding a material for a draw call is a single
+ * ranged uniform buffer binding.
+ */
+class GUA_DLL MaterialUniformStorage
+{
+  public:
+    // slot granularity; the maximum GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    static const unsigned SLOT_UNIT_SIZE = 256;
+    static const unsigned INITIAL_UNIT_COUNT = 256;
+    // frames until an unresolved texture handle is looked up again, doubled
+    // after every failed attempt up to the maximum
+    static const unsigned MAX_RESOLVE_INTERVAL = 64;
+
+    MaterialUniformStorage() = default;
+
+    /**
+     * Makes sure the block of the given material is up to date and binds it
+     * to GUA_MATERIAL_BLOCK_BINDING. Returns the index of the material's slot.
+     */
+    unsigned bind(RenderContext const& ctx, Material const& material, MaterialShader const& shader, int view);
+
+    std::size_t get_slot_count() const { return slots_.size(); }
+    std::size_t get_buffer_size() const { return cpu_block_.size(); }
+
+  private:
+    struct Slot
+    {
+        std::weak_ptr<void> owner;
+        unsigned first_unit = 0;
+        unsigned unit_count = 0;
+        unsigned generation = 0;
+        bool up_to_date = false;
+        // textures which could not be resolved are retried in this frame
+        unsigned resolve_frame = 0;
+        unsigned resolve_interval = 0;
+    };
+
+    unsigned allocate(RenderContext const& ctx, unsigned unit_count);
+    void release(Slot const& slot);
+    void collect_expired_slots();
+    void grow(RenderContext const& ctx, unsigned min_unit_count);
+    void upload(RenderContext const& ctx, Slot const& slot);
+
+    std::map<std::pair<std::size_t, int>, Slot> slots_;
+    std::unordered_map<unsigned, std::vector<unsigned>> free_units_;
+    std::vector<char> cpu_block_;
+    unsigned used_units_ = 0;
+    scm::gl::buffer_ptr buffer_;
+    GpuMemoryAllocations memory_allocations_;
+};
+
+} // namespace gua
+
+#endif // GUA_MATERIAL_UNIFORM_STORAGE_HPP
@@ -142,6 +142,10 @@ class GUA_DLL Pipeline
 
     void generate_shadow_map_spotlight(node::LightNode& light, LightTable::LightBlock& light_block, unsigned viewport_size, bool redraw);
 
+    bool generate_shadow_map_atlas(node::LightNode& light, LightTable::LightBlock& light_block);
+
+    void restore_camera_view(std::shared_ptr<SerializedScene> const& scene, math::vec2ui const& resolution);
+
     PipelineViewState current_viewstate_;
 
     RenderContext& context_;
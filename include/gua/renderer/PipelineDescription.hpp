@@ -84,6 +84,11 @@ class GUA_DLL PipelineDescription
 
     int get_max_lights_count() const { return max_lights_count_; }
 
+    // side length of the shadow atlas used for spot lights; 0 gives each light its own shadow map
+    void set_shadow_atlas_size(unsigned value) { shadow_atlas_size_ = value; }
+
+    unsigned get_shadow_atlas_size() const { return shadow_atlas_size_; }
+
     void set_user_data(void* data) { user_data_ = data; }
 
     void* get_user_data() const { return user_data_; }
@@ -115,6 +120,7 @@ class GUA_DLL PipelineDescription
     size_t abuffer_size_ = 800; // in MiB
     float blending_termination_threshold_ = 0.99f;
     int max_lights_count_ = 128;
+    unsigned shadow_atlas_size_ = 0;
 };
 
 } // namespace gua
@@ -24,6 +24,7 @@
 
 #include <gua/platform.hpp>
 #include <gua/renderer/enums.hpp>
+#include <gua/renderer/GpuMemoryRegistry.hpp>
 #include <gua/utils/InstanceCollection.hpp>
 
 #ifdef GUACAMOLE_ENABLE_VIRTUAL_TEXTURING
@@ -44,6 +45,7 @@ namespace gua
 {
 class Pipeline;
 class WindowBase;
+class MaterialUniformStorage;
 
 namespace node
 {
@@ -136,7 +138,7 @@ struct GUA_DLL RenderContext
       public:
         LineStrip() = default;
         LineStrip(scm::gl::vertex_array_ptr const& a, scm::gl::buffer_ptr const& v, scm::gl::buffer_ptr const& i)
-            : vertex_array(a), vertices(v), vertex_topology(scm::gl::PRIMITIVE_LINE_STRIP_ADJACENCY), vertex_reservoir_size(0), num_occupied_vertex_slots(0), current_buffer_size_in_vertices(0)
+            : vertex_array(a), vertices(v), vertex_topology(scm::gl::PRIMITIVE_LINE_STRIP_ADJACENCY), vertex_reservoir_size(0), num_occupied_vertex_slots(0), current_buffer_size_in_vertices(0), first_buffer_slot(0)
         {
         }
         scm::gl::vertex_array_ptr vertex_array;
@@ -145,6 +147,7 @@ struct GUA_DLL RenderContext
         int vertex_reservoir_size;
         int num_occupied_vertex_slots;
         int current_buffer_size_in_vertices;
+        int first_buffer_slot;
     };
 
     mutable std::unordered_map<std::size_t, LineStrip> line_strips;
@@ -175,6 +178,17 @@ struct GUA_DLL RenderContext
     std::unordered_map<std::size_t, std::shared_ptr<Pipeline>> render_pipelines;
 
     mutable std::unordered_map<std::size_t, std::shared_ptr<PluginRessource>> plugin_ressources;
+
+    /**
+     * Packed uniform blocks of all materials drawn with this context
+     */
+    mutable std::shared_ptr<MaterialUniformStorage> material_uniforms;
+
+    /**
+     * Accounting of the GPU memory allocated by the resources of this
+     * context. Budget and eviction policy can be configured through it.
+     */
+    std::shared_ptr<GpuMemoryRegistry> memory;
 };
 
 } // namespace gua
@@ -27,12 +27,31 @@
 #include <gua/renderer/Pipeline.hpp>
 #include <gua/renderer/PipelinePass.hpp>
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace gua
 {
 class Pipeline;
 
+/**
+ * Grabs the color (and optionally depth) buffer of the GBuffer.
+ *
+ * The buffers are downloaded asynchronously through a ring of pixel pack
+ * buffers and written to disk by a pool of worker threads, so grabbing does
+ * not stall the frame. The images of frame N become available a few frames
+ * later; set_record() grabs every frame.
+ *
+ * The output prefix and the grab, record and depth flags are runtime state
+ * which the copies of this description in the pipelines share, so changing
+ * them does not rebuild the pass. Each pipeline grabs one frame per
+ * set_grab_next(true) call.
+ */
 class GUA_DLL ScreenGrabPassDescription : public PipelinePassDescription
 {
   public:
@@ -43,159 +62,108 @@ class GUA_DLL ScreenGrabPassDescription : public PipelinePassDescription
     void set_output_prefix(const std::string& output_prefix);
     void set_grab_next(bool grab_next);
 
+    // grab every frame until disabled again
+    void set_record(bool record);
+    bool get_record() const;
+
+    // additionally write the depth buffer as raw 32 bit floats (.depth)
+    void set_export_depth(bool export_depth);
+    bool get_export_depth() const;
+
+    // number of frames a download may be in flight before grabs are dropped
+    void set_readback_latency(unsigned frames);
+    unsigned get_readback_latency() const { return readback_latency_; }
+
   protected:
     PipelinePass make_pass(RenderContext const&, SubstitutionMap&) override;
 
   private:
-    std::string output_prefix_;
-    bool grab_next_;
-};
+    struct GrabState;
 
-#ifdef GUACAMOLE_ENABLE_TURBOJPEG
-
-#include <stdio.h>
-#include <jpeglib.h>
-#include <setjmp.h>
-
-#define F2B(f) ((f) >= 1.0 ? (unsigned char)255 : (unsigned char)((f)*256.0))
+    std::shared_ptr<GrabState> state_;
+    unsigned readback_latency_;
+};
 
+/**
+ * Writes grabbed frames on a pool of worker threads.
+ *
+ * Frames are queued up to a fixed capacity. When the queue is full, the
+ * OverflowPolicy decides whether the new frame is dropped, the oldest queued
+ * frame is dropped, or the caller blocks until a worker is done.
+ */
 class GUA_DLL ScreenGrabJPEGSaver
 {
   public:
+    enum class OverflowPolicy
+    {
+        DROP_NEWEST,
+        DROP_OLDEST,
+        BLOCK
+    };
+
     static ScreenGrabJPEGSaver* get_instance()
     {
         static ScreenGrabJPEGSaver saver;
         return &saver;
     }
 
-    ~ScreenGrabJPEGSaver()
-    {
-        should_save_.store(false);
-        should_quit_.store(true);
-        save_cv_.notify_one();
-        worker_.join();
-    }
+    ~ScreenGrabJPEGSaver();
 
-    void save(std::string& output_prefix, scm::math::vec2ui& dims, std::vector<float>& rgb_32f)
-    {
-        output_prefix_ = output_prefix;
-        dims_ = dims;
-        rgb_32f_.swap(rgb_32f);
+    // takes a bottom-up RGB 32F image, as stored in an RGB_32F color buffer
+    void save(std::string& output_prefix, scm::math::vec2ui& dims, std::vector<float>& rgb_32f);
 
-        size_t length = dims_.x * dims_.y * 3;
+    // takes a tightly packed top-down RGB 8 image; the file is written as JPEG
+    void save_jpeg(std::string const& filename, scm::math::vec2ui const& dims, std::vector<unsigned char>&& rgb_8);
 
-        if(rgb_8_.size() != length)
-        {
-            rgb_8_.resize(length);
-        }
+    // writes the given bytes unmodified
+    void save_raw(std::string const& filename, std::vector<unsigned char>&& data);
 
-        should_save_.store(true);
-        save_cv_.notify_one();
-    }
+    // returns a recycled buffer of the given size to avoid per-frame allocations
+    std::vector<unsigned char> acquire_buffer(std::size_t size);
 
-  private:
-    ScreenGrabJPEGSaver() : save_lock_(), should_quit_(false), should_save_(false), save_cv_(), output_prefix_(""), dims_(), rgb_32f_(), rgb_8_()
-    {
-        worker_ = std::thread([&]() -> void {
-            while(!should_quit_.load())
-            {
-                std::unique_lock<std::mutex> lk(save_lock_, std::defer_lock);
-                if(should_save_.load())
-                {
-                    save_();
-                }
-                should_save_.store(false);
-
-                while(!save_cv_.wait_for(lk, std::chrono::milliseconds(16), [&]() -> bool { return should_save_.load(); }))
-                {
-                    if(should_quit_.load())
-                    {
-                        break;
-                    }
-                }
-            }
-        });
-    }
-
-    bool write_JPEG_file(const char* filename, int quality)
-    {
-        struct jpeg_compress_struct cinfo;
-        struct jpeg_error_mgr jerr;
-        FILE* outfile;           /* target file */
-        JSAMPROW row_pointer[1]; /* pointer to JSAMPLE row[s] */
-        int row_stride;          /* physical row width in image buffer */
-        cinfo.err = jpeg_std_error(&jerr);
-        jpeg_create_compress(&cinfo);
-        if((outfile = fopen(filename, "wb")) == NULL)
-        {
-            fprintf(stderr, "can't open %s\n", filename);
-            return false;
-        }
-        jpeg_stdio_dest(&cinfo, outfile);
-
-        cinfo.image_width = dims_.x; /* image width and height, in pixels */
-        cinfo.image_height = dims_.y;
-        cinfo.input_components = 3;     /* # of color components per pixel */
-        cinfo.in_color_space = JCS_RGB; /* colorspace of input image */
+    void set_queue_capacity(unsigned capacity);
+    void set_overflow_policy(OverflowPolicy policy);
 
-        jpeg_set_defaults(&cinfo);
+    std::size_t get_saved_count() const { return saved_count_; }
+    std::size_t get_dropped_count() const { return dropped_count_; }
 
-        jpeg_set_quality(&cinfo, quality, TRUE /* limit to baseline-JPEG values */);
+    // converts an RGB 32F image to RGB 8 and flips it vertically
+    static void convert_rgb32f_to_rgb8(float const* src, unsigned char* dst, scm::math::vec2ui const& dims);
 
-        jpeg_start_compress(&cinfo, TRUE);
+    // flips a tightly packed image vertically
+    static void flip_rows(unsigned char const* src, unsigned char* dst, scm::math::vec2ui const& dims, unsigned bytes_per_pixel);
 
-        row_stride = dims_.x * 3; /* JSAMPLEs per row in image_buffer */
-
-        while(cinfo.next_scanline < cinfo.image_height)
-        {
-            row_pointer[0] = &rgb_8_[cinfo.next_scanline * row_stride];
-            (void)jpeg_write_scanlines(&cinfo, row_pointer, 1);
-        }
+  private:
+    struct Job
+    {
+        std::string filename;
+        scm::math::vec2ui dims;
+        std::vector<unsigned char> data;
+        bool raw;
+    };
 
-        jpeg_finish_compress(&cinfo);
-        fclose(outfile);
+    ScreenGrabJPEGSaver();
 
-        jpeg_destroy_compress(&cinfo);
+    void enqueue(Job&& job);
+    void work();
+    void release_buffer(std::vector<unsigned char>&& buffer);
 
-        return true;
-    }
+    static bool write_JPEG_file(Job const& job, int quality);
 
-    void save_()
-    {
-        unsigned i;
-        unsigned length = dims_.x * dims_.y;
-
-        for(i = 0; i < length; i++)
-        {
-            unsigned offset = i * 3;
-            unsigned flipped_offset = ((dims_.y - i / dims_.x) * dims_.x + i % dims_.x) * 3;
-
-            rgb_8_[offset] = F2B(rgb_32f_[flipped_offset]);
-            rgb_8_[offset + 1] = F2B(rgb_32f_[flipped_offset + 1]);
-            rgb_8_[offset + 2] = F2B(rgb_32f_[flipped_offset + 2]);
-        }
-
-        long millis = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-        std::string timestamp{std::to_string(millis)};
-
-        if(!write_JPEG_file((output_prefix_ + timestamp + ".jpg").c_str(), 100))
-        {
-            std::cerr << "Could not write JPEG" << std::endl;
-        }
-    }
+    std::mutex mutex_;
+    std::condition_variable job_cv_;
+    std::condition_variable space_cv_;
+    std::deque<Job> jobs_;
+    std::vector<std::vector<unsigned char>> free_buffers_;
+    std::vector<std::thread> workers_;
 
-    std::mutex save_lock_;
-    std::atomic_bool should_quit_;
-    std::atomic_bool should_save_;
-    std::condition_variable save_cv_;
-    std::thread worker_;
+    bool should_quit_;
+    unsigned capacity_;
+    OverflowPolicy policy_;
 
-    std::string output_prefix_;
-    scm::math::vec2ui dims_;
-    std::vector<float> rgb_32f_;
-    std::vector<unsigned char> rgb_8_;
+    std::atomic<std::size_t> saved_count_;
+    std::atomic<std::size_t> dropped_count_;
 };
-#endif //GUACAMOLE_ENABLE_TURBOJPEG
 
 } // namespace gua
 
@@ -0,0 +1,123 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef GUA_SHADOW_ATLAS_HPP
+#define GUA_SHADOW_ATLAS_HPP
+
+// guacamole headers
+#include <gua/renderer/RenderTarget.hpp>
+#include <gua/renderer/RenderContext.hpp>
+
+// external headers
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace gua
+{
+/**
+ * One large depth texture holding the shadow maps of many lights.
+ *
+ * Tiles are square with power-of-two sizes and are packed with a quadtree
+ * (buddy) allocator. Each tile remembers a hash of the content it was
+ * rendered with, so lights whose shadow casters did not change keep their
+ * tile from previous frames and don't have to be redrawn.
+ */
+class GUA_DLL ShadowAtlas : public RenderTarget
+{
+  public:
+    // texels left empty around each tile, covers the PCF sample offsets
+    static const unsigned TILE_BORDER = 4;
+
+    // tiles of lights which have not been drawn for this many frames are freed
+    static const unsigned MAX_IDLE_FRAMES = 120;
+
+    struct Tile
+    {
+        unsigned x = 0;
+        unsigned y = 0;
+        unsigned size = 0;
+    };
+
+    ShadowAtlas(RenderContext const& ctx, unsigned size, unsigned min_tile_size = 64);
+
+    /**
+     * Returns a tile of the given size for the given key (e.g. a light). If
+     * the key's tile of the last frames has the same or twice the size and
+     * the same content hash, it is returned with needs_redraw set to false. The same holds if the
+     * tile has been acquired in this frame already. Tiles unused in the
+     * current frame are evicted if the atlas is full. Returns false if no
+     * tile could be found.
+     */
+    bool acquire(std::size_t key, unsigned size, std::size_t content_hash, unsigned frame, Tile& tile, bool& needs_redraw);
+
+    /**
+     * Frees the tiles which have not been acquired for max_idle_frames.
+     */
+    void release_unused(unsigned frame, unsigned max_idle_frames);
+
+    void clear_tile(RenderContext const& ctx, Tile const& tile, float depth = 1.f) const;
+
+    /**
+     * Selects the tile the next draw calls render into.
+     */
+    void set_tile(Tile const& tile);
+
+    /**
+     * Maps normalized device coordinates of a full shadow map to the inner
+     * area of the given tile.
+     */
+    math::mat4f get_tile_transform(Tile const& tile) const;
+
+    unsigned get_min_tile_size() const { return min_tile_size_; }
+
+    void clear(RenderContext const& context, float depth = 1.f, unsigned stencil = 0) override;
+    void bind(RenderContext const& context, bool write_depth) override;
+    void set_viewport(RenderContext const& context) override;
+    void remove_buffers(RenderContext const& ctx) override;
+
+    scm::gl::texture_2d_ptr const& get_depth_buffer() const override;
+
+  private:
+    struct CachedTile
+    {
+        Tile tile;
+        std::size_t content_hash = 0;
+        unsigned last_used = 0;
+    };
+
+    bool allocate(unsigned size, Tile& tile);
+    void free(Tile const& tile);
+    unsigned level_of(unsigned size) const;
+
+    unsigned min_tile_size_;
+    std::vector<std::set<std::pair<unsigned, unsigned>>> free_tiles_;
+    std::unordered_map<std::size_t, CachedTile> tiles_;
+    Tile current_tile_;
+
+    scm::gl::frame_buffer_ptr fbo_;
+    scm::gl::texture_2d_ptr depth_buffer_;
+    scm::gl::sampler_state_ptr sampler_state_;
+};
+
+} // namespace gua
+
+#endif // GUA_SHADOW_ATLAS_HPP
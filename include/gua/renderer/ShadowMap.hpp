@@ -25,6 +25,7 @@
 // guacamole headers
 #include <gua/renderer/RenderTarget.hpp>
 #include <gua/renderer/RenderContext.hpp>
+#include <gua/renderer/ShadowAtlas.hpp>
 #include <gua/utils/Mask.hpp>
 
 namespace gua
@@ -74,6 +75,7 @@ struct SharedShadowMapResource
 {
     std::set<std::shared_ptr<ShadowMap>> unused_shadow_maps;
     std::unordered_map<node::LightNode*, std::vector<CachedShadowMap>> used_shadow_maps;
+    std::shared_ptr<ShadowAtlas> atlas;
 };
 
 } // namespace gua
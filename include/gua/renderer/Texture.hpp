@@ -117,6 +117,9 @@ class GUA_DLL Texture
     std::size_t uuid() { return uuid_; }
 
   protected:
+    // estimated GPU memory of a texture, used for memory accounting
+    static std::size_t estimate_memory_size(math::vec3ui const& size, scm::gl::data_format format, unsigned mip_levels);
+
     unsigned mipmap_layers_;
     scm::gl::data_format color_format_;
     scm::gl::data_format internal_format_;
@@ -124,6 +127,8 @@ class GUA_DLL Texture
     std::string file_name_;
 
     mutable std::mutex upload_mutex_;
+    // the uploads to all contexts, untracked with the texture
+    mutable GpuMemoryAllocations memory_allocations_;
 
     std::size_t uuid_ = boost::hash<boost::uuids::uuid>()(boost::uuids::random_generator()());
 };
@@ -0,0 +1,89 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef GUA_TEXTURE_READBACK_HPP
+#define GUA_TEXTURE_READBACK_HPP
+
+#include <gua/platform.hpp>
+#include <gua/math/math.hpp>
+#include <gua/renderer/RenderContext.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace gua
+{
+/**
+ * Asynchronous download of texture contents.
+ *
+ * Keeps a ring of pixel pack buffers. Each request copies the texture into
+ * the next free buffer and inserts a fence; the data is handed out by poll()
+ * once the GPU has passed the fence, usually a few frames later. The render
+ * thread never waits for the transfer unless explicitly asked to.
+ */
+class GUA_DLL TextureReadback
+{
+  public:
+    using Consumer = std::function<void(math::vec2ui const& dims, void const* data, std::size_t size, std::uint64_t tag)>;
+
+    TextureReadback(unsigned ring_size = 3);
+
+    /**
+     * Starts downloading mip level 0 of the given texture with the given GL
+     * pixel format and type. Returns false (and does nothing) if all buffers
+     * of the ring are still in flight.
+     */
+    bool request(RenderContext const& ctx, scm::gl::texture_2d_ptr const& texture, unsigned gl_format, unsigned gl_type, unsigned bytes_per_pixel, std::uint64_t tag = 0);
+
+    /**
+     * Hands all finished downloads to the consumer in request order. The
+     * data pointer is only valid during the call. If wait is true, all
+     * pending downloads are finished first. Downloads which fail are
+     * dropped without calling the consumer, so anything belonging to a
+     * request has to travel in its tag.
+     */
+    void poll(RenderContext const& ctx, Consumer const& consumer, bool wait = false);
+
+    void remove_buffers(RenderContext const& ctx);
+
+    unsigned get_pending_count() const { return pending_count_; }
+    unsigned get_ring_size() const { return static_cast<unsigned>(ring_.size()); }
+
+  private:
+    struct Slot
+    {
+        unsigned buffer = 0;
+        std::size_t capacity = 0;
+        std::size_t size = 0;
+        void* fence = nullptr;
+        math::vec2ui dims;
+        std::uint64_t tag = 0;
+    };
+
+    std::vector<Slot> ring_;
+    unsigned next_ = 0;
+    unsigned pending_count_ = 0;
+};
+
+} // namespace gua
+
+#endif // GUA_TEXTURE_READBACK_HPP
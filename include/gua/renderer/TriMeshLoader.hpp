@@ -25,6 +25,7 @@
 // guacamole headers
 #include <gua/renderer/TriMeshRessource.hpp>
 #include <gua/renderer/Material.hpp>
+#include <gua/renderer/MaterialLoader.hpp>
 #include <gua/utils/Mesh.hpp>
 
 // external headers
@@ -115,13 +116,19 @@ class GUA_DLL TriMeshLoader
     bool is_supported(std::string const& file_name) const;
 
   private: // methods
-    static std::shared_ptr<node::Node>
-    get_tree(std::shared_ptr<Assimp::Importer> const& importer, aiScene const* ai_scene, aiNode* ai_root, std::string const& file_name, unsigned flags, unsigned& mesh_count, bool enforce_hierarchy);
+    static std::shared_ptr<node::Node> get_tree(std::shared_ptr<Assimp::Importer> const& importer,
+                                                aiScene const* ai_scene,
+                                                aiNode* ai_root,
+                                                std::string const& file_name,
+                                                unsigned flags,
+                                                unsigned& mesh_count,
+                                                bool enforce_hierarchy,
+                                                std::vector<std::shared_ptr<Material>> const& materials);
 
     static void apply_fallback_material(std::shared_ptr<node::Node> const& root, std::shared_ptr<Material> const& fallback_material, bool no_shared_materials);
 
 #ifdef GUACAMOLE_FBX
-    static std::shared_ptr<node::Node> get_tree(FbxNode& node, std::string const& file_name, unsigned flags, unsigned& mesh_count);
+    static std::shared_ptr<node::Node> get_tree(FbxNode& node, std::string const& file_name, unsigned flags, unsigned& mesh_count, MaterialLoader const& material_loader);
 
     static FbxScene* load_fbx_file(FbxManager* manager, std::string const& file_path);
 #endif
@@ -25,6 +25,7 @@
 // guacamole headers
 #include <gua/platform.hpp>
 #include <gua/renderer/GeometryResource.hpp>
+#include <gua/renderer/GpuMemoryRegistry.hpp>
 #include <gua/utils/Mesh.hpp>
 #include <gua/utils/KDTree.hpp>
 
@@ -89,6 +90,9 @@ class GUA_DLL TriMeshRessource : public GeometryResource
 
     KDTree kd_tree_;
     Mesh mesh_;
+
+    // the uploads to all contexts, untracked with the mesh
+    mutable GpuMemoryAllocations memory_allocations_;
 };
 
 } // namespace gua
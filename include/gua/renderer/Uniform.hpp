@@ -106,6 +106,14 @@ class GUA_DLL UniformValue
 
     std::string get_glsl_type() const { return boost::apply_visitor(GetGlslType(), data); }
 
+    // size and base alignment of this value inside a std140 uniform block
+    unsigned get_std140_size() const;
+    unsigned get_std140_alignment() const;
+
+    // writes the value with std140 padding; returns false if a referenced
+    // texture could not be resolved yet and the value has to be written again
+    bool write_std140(RenderContext const& ctx, char* target) const;
+
     // unsigned get_byte_size() const {
     //   return boost::apply_visitor(GetByteSize(), data);
     // }
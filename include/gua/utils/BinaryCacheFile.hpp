@@ -0,0 +1,113 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef GUA_BINARY_CACHE_FILE_HPP
+#define GUA_BINARY_CACHE_FILE_HPP
+
+#include <gua/platform.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace gua
+{
+/**
+ * A versioned binary file of named arrays, used to cache data which is
+ * expensive to derive from a source file.
+ *
+ * Elements have to be trivially copyable and are stored with their object
+ * representation, so a cache read back is bit-exact but only valid on
+ * machines with the same endianness and type layout. load() only accepts
+ * files written for the same format version and source key, usually
+ * hash_file() of the source. save() writes to a temporary file first, a
+ * cache which is being written concurrently is never read half-finished.
+ */
+class GUA_DLL BinaryCacheFile
+{
+  public:
+    static const uint64_t HASH_SEED = 14695981039346656037ull;
+
+    BinaryCacheFile(uint32_t format_version, uint64_t source_key);
+
+    template <typename T>
+    void set(std::string const& name, std::vector<T> const& values)
+    {
+        Array& array = arrays_[name];
+        array.element_size = sizeof(T);
+        array.bytes.resize(values.size() * sizeof(T));
+        if(!values.empty())
+        {
+            std::memcpy(array.bytes.data(), values.data(), array.bytes.size());
+        }
+    }
+
+    /**
+     * Copies the named array into values. Fails if there is no such array
+     * or if it has been stored with another element size.
+     */
+    template <typename T>
+    bool get(std::string const& name, std::vector<T>& values) const
+    {
+        auto array(arrays_.find(name));
+        if(array == arrays_.end() || array->second.element_size != sizeof(T))
+        {
+            return false;
+        }
+
+        values.resize(array->second.bytes.size() / sizeof(T));
+        if(!values.empty())
+        {
+            std::memcpy(values.data(), array->second.bytes.data(), values.size() * sizeof(T));
+        }
+        return true;
+    }
+
+    bool has(std::string const& name) const { return arrays_.count(name) > 0; }
+
+    bool save(std::string const& file_name) const;
+
+    // replaces all arrays with the ones of the file, fails if it is missing, broken or outdated
+    bool load(std::string const& file_name);
+
+    // FNV-1a over 64 bit words; chained over chunks of whole words it hashes their concatenation
+    static uint64_t hash_data(void const* data, std::size_t num_bytes, uint64_t hash = HASH_SEED);
+
+    // hash_data() of the content of a file, 0 if it cannot be read
+    static uint64_t hash_file(std::string const& file_name);
+
+  private:
+    struct Array
+    {
+        uint32_t element_size = 0;
+        std::vector<char> bytes;
+    };
+
+    uint32_t format_version_;
+    uint64_t source_key_;
+    std::map<std::string, Array> arrays_;
+};
+
+} // namespace gua
+
+#endif // GUA_BINARY_CACHE_FILE_HPP
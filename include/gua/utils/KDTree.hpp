@@ -39,7 +39,7 @@ namespace gua
 /**
  * This class contains a simple KDTree implementation.
  */
-class KDTree
+class GUA_DLL KDTree
 {
   public:
     KDTree();
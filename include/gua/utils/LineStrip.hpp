@@ -27,11 +27,13 @@
 #include <gua/platform.hpp>
 
 #include <gua/utils/LineStripImporter.hpp>
+#include <gua/utils/LineStripRing.hpp>
 
 // external headers
 #include <scm/gl_core.h>
 #include <scm/core/math/quat.h>
 
+#include <map>
 #include <mutex>
 #include <vector>
 
@@ -88,6 +90,7 @@ struct GUA_DLL LineStrip
         scm::math::vec3f nor;
     };
 
+    // recomputes the normals of vertices which were added or lost a neighbour since the last call
     void compute_consistent_normals() const;
 
     void compile_buffer_string(std::string& buffer_string);
@@ -103,6 +106,29 @@ struct GUA_DLL LineStrip
                                  std::vector<float> const& queued_thicknesses,
                                  std::vector<scm::math::vec3f> const& queued_normals);
 
+    /**
+     * @brief keeps the vertices in a mirrored ring
+     *
+     * Trimming a line at the front never moves the remaining vertices and
+     * never forces a complete upload, at the cost of a twice as large
+     * vertex buffer. Meant for trails of (almost) constant length.
+     */
+    void set_ring_buffer_mode(bool enable);
+    bool get_ring_buffer_mode() const { return ring_.mirrored(); }
+
+    // slot of the index-th vertex in the attribute vectors
+    unsigned vertex_slot(unsigned index) const { return ring_.slot(index); }
+
+    // size of the vertex buffer and its slot holding the copy of the first vertex, see LineStripRing
+    unsigned image_size() const { return ring_.image_size(); }
+    unsigned image_first() const { return ring_.image_first(); }
+
+    // vertex buffer ranges changed since the last call
+    std::vector<LineStripRing::Range> take_dirty_ranges() const { return ring_.take_dirty_ranges(); }
+
+    // bounds of all vertices, false if there are none
+    bool compute_bounds(scm::math::vec3f& min, scm::math::vec3f& max) const;
+
     /**
      * @brief writes vertex info to given buffer
      *
@@ -110,6 +136,9 @@ struct GUA_DLL LineStrip
      */
     void copy_to_buffer(Vertex* vertex_buffer) const;
 
+    // writes the vertex buffer slots [image_begin, image_end) to the given buffer
+    void copy_to_buffer(Vertex* vertex_buffer, unsigned image_begin, unsigned image_end) const;
+
     /**
      * @brief returns vertex layout for mesh vertex
      * @return schism vertex format
@@ -128,6 +157,18 @@ struct GUA_DLL LineStrip
 
   protected:
     void enlarge_reservoirs();
+    void resize_reservoirs(unsigned capacity, bool mirrored);
+    void compute_normal(unsigned index) const;
+
+    // touched when normals are recomputed
+    mutable LineStripRing ring_;
+
+    // per slot, keeps the orientation of the normals stable while vertices come and go
+    mutable std::vector<scm::math::vec3f> plane_normals_;
+
+    // index of the first vertex whose normal is outdated, the first one is tracked separately
+    mutable unsigned normals_dirty_from_;
+    mutable bool first_normal_dirty_;
 };
 
 } // namespace gua
@@ -30,6 +30,9 @@
 #include <scm/gl_core.h>
 #include <scm/core/math/quat.h>
 
+#include <cstdint>
+#include <string>
+#include <tuple>
 #include <vector>
 
 namespace gua
@@ -53,6 +56,9 @@ struct LineObject
     std::vector<float> vertex_thickness_database;
     std::vector<scm::math::vec3f> vertex_normal_database;
 
+    // pairs of vertex indices, one per segment of the 'l' statements; empty if the vertices form one strip in order
+    std::vector<unsigned> line_indices;
+
     // not used in the first version of the importer
     std::vector<IndexTriplet> vertex_attribute_ids;
 };
@@ -61,21 +67,37 @@ using NamedLineObject = std::pair<std::string, LineObject>;
 
 /**
  * @brief holds vertex information of one line strip
+ *
+ * *.lob files (and *.obj files containing lines) are parsed in place from a
+ * memory mapped file. Vertex indices of 'l' statements are one-based and
+ * count the vertices of the current object, negative ones count backwards
+ * from the last vertex. The segments share their vertices and are only
+ * expanded to a line list when the LineStrip is created.
  */
 class GUA_DLL LineStripImporter
 {
     friend class LineStrip;
 
   public:
+    // increase whenever the layout of the cached line objects changes
+    static const uint32_t CACHE_VERSION = 1;
+
     void create_empty_line(std::string const& empty_line_name);
 
     bool parsing_successful() const;
 
     void read_file(std::string const& file_name);
 
+    // parses the content of a *.lob file
+    void read_buffer(char const* data, std::size_t size);
+
+    // binary cache of all parsed line objects, the source key should be the hash of the parsed file
+    bool save_cache(std::string const& cache_file_name, uint64_t source_key) const;
+    bool load_cache(std::string const& cache_file_name, uint64_t source_key);
+
     int num_parsed_line_strips() const;
 
-    NamedLineObject parsed_line_object_at(int line_object_index) const;
+    NamedLineObject const& parsed_line_object_at(int line_object_index) const;
 
   private:
     bool parsing_successful_ = false;
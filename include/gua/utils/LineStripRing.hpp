@@ -0,0 +1,137 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef GUA_LINE_STRIP_RING_HPP
+#define GUA_LINE_STRIP_RING_HPP
+
+#include <gua/platform.hpp>
+
+#include <vector>
+
+namespace gua
+{
+/**
+ * Slot bookkeeping of a line strip whose vertices are stored in a ring.
+ *
+ * Vertices are appended at the back and trimmed at either end without moving
+ * the others. The caller keeps the vertex attributes in arrays of capacity()
+ * slots and asks for the slot of each vertex.
+ *
+ * The vertex buffer ("image") drawn as line strip with adjacency holds the
+ * vertices in order, framed by copies of the first and last vertex. A
+ * mirrored ring has an image of 2 * capacity + 2 slots, the vertex in ring
+ * slot r is stored in image slots r + 1 and r + 1 + capacity. Every window
+ * of the ring is contiguous there. An unmirrored ring has an image of
+ * capacity + 2 slots and is full as soon as its window reaches the end of
+ * the slots; the caller then compacts it with reset().
+ *
+ * All image slots whose content changes are recorded as dirty ranges, so
+ * only those have to be uploaded. Bounds are kept per block of slots and
+ * only blocks which lost or gained vertices are recomputed.
+ */
+class GUA_DLL LineStripRing
+{
+  public:
+    // image slots [begin, end)
+    struct Range
+    {
+        unsigned begin;
+        unsigned end;
+    };
+
+    static const unsigned BOUNDS_BLOCK_SIZE = 64;
+
+    // ranges beyond this number are merged into one, uploading a few clean slots is cheaper than many small uploads
+    static const unsigned MAX_DIRTY_RANGES = 16;
+
+    explicit LineStripRing(unsigned capacity = 0, bool mirrored = false);
+
+    /**
+     * Changes the capacity. The ring holds the given number of vertices in
+     * the slots [0, size) afterwards, every image slot is dirty.
+     */
+    void reset(unsigned capacity, unsigned size, bool mirrored);
+
+    unsigned capacity() const { return capacity_; }
+    unsigned size() const { return size_; }
+    bool mirrored() const { return mirrored_; }
+
+    // true if push_back() has no slot left without a reset()
+    bool full() const;
+
+    // ring slot of the index-th vertex
+    unsigned slot(unsigned index) const { return first_ + index < capacity_ ? first_ + index : first_ + index - capacity_; }
+
+    unsigned image_size() const { return mirrored_ ? 2 * capacity_ + 2 : capacity_ + 2; }
+
+    // image slot of the copy of the first vertex, the strip is drawn from here with size() + 2 vertices
+    unsigned image_first() const { return first_; }
+
+    // ring slot of the vertex which belongs into an image slot
+    unsigned image_source(unsigned image_slot) const;
+
+    // returns the slot for a new last vertex, which has to be written by the caller
+    unsigned push_back();
+    void pop_front();
+    void pop_back();
+
+    // marks the vertex in a ring slot as changed
+    void touch(unsigned ring_slot);
+
+    // image ranges changed since the last call, sorted and merged
+    std::vector<Range> take_dirty_ranges();
+
+    // sorts and merges overlapping or adjacent ranges, at most MAX_DIRTY_RANGES remain
+    static void merge_ranges(std::vector<Range>& ranges);
+
+    /**
+     * Bounds of all vertices, positions are the x, y, z coordinates of all
+     * slots. Returns false if the ring is empty.
+     */
+    bool bounds(float const* positions, float* min, float* max) const;
+
+  private:
+    struct BlockBounds
+    {
+        bool valid = false;
+        bool empty = true;
+        float min[3];
+        float max[3];
+    };
+
+    bool occupied(unsigned ring_slot) const;
+    void add_dirty(unsigned begin, unsigned end);
+    void add_dirty_slot(unsigned ring_slot);
+    void add_dirty_caps();
+    void invalidate_block(unsigned ring_slot) { block_bounds_[ring_slot / BOUNDS_BLOCK_SIZE].valid = false; }
+
+    unsigned capacity_;
+    unsigned first_;
+    unsigned size_;
+    bool mirrored_;
+
+    std::vector<Range> dirty_ranges_;
+    mutable std::vector<BlockBounds> block_bounds_;
+};
+
+} // namespace gua
+
+#endif // GUA_LINE_STRIP_RING_HPP
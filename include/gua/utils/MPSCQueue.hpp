@@ -0,0 +1,97 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef GUA_MPSC_QUEUE_HPP
+#define GUA_MPSC_QUEUE_HPP
+
+// external headers
+#include <atomic>
+#include <utility>
+
+namespace gua
+{
+/**
+ * Unbounded lock-free queue for many producer threads and one consumer.
+ *
+ * push() is wait-free: a single atomic exchange. Values pushed by one thread
+ * are popped in the order they were pushed. pop() must not be called
+ * concurrently from several threads. While a push is half done, pop() may
+ * report an empty queue even if values pushed later by other threads are
+ * already complete; they are returned by a later pop().
+ */
+template <typename T>
+class MPSCQueue
+{
+  public:
+    MPSCQueue() : head_(new Node()), tail_(head_.load(std::memory_order_relaxed)) {}
+
+    ~MPSCQueue()
+    {
+        T value;
+        while(pop(value))
+        {
+        }
+        delete tail_;
+    }
+
+    void push(T value)
+    {
+        Node* node(new Node());
+        node->value = std::move(value);
+
+        Node* previous(head_.exchange(node, std::memory_order_acq_rel));
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    // takes the oldest value, returns false if the queue is empty
+    bool pop(T& value)
+    {
+        Node* next(tail_->next.load(std::memory_order_acquire));
+        if(!next)
+            return false;
+
+        // next becomes the new sentinel, its value is moved out
+        value = std::move(next->value);
+        delete tail_;
+        tail_ = next;
+        return true;
+    }
+
+    MPSCQueue(MPSCQueue const&) = delete;
+    MPSCQueue& operator=(MPSCQueue const&) = delete;
+
+  private:
+    struct Node
+    {
+        std::atomic<Node*> next{nullptr};
+        T value;
+    };
+
+    // the last pushed node, producers append behind it
+    std::atomic<Node*> head_;
+
+    // the sentinel in front of the oldest value, only touched by the consumer
+    Node* tail_;
+};
+
+} // namespace gua
+
+#endif // GUA_MPSC_QUEUE_HPP
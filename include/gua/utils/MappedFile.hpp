@@ -0,0 +1,71 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef GUA_MAPPED_FILE_HPP
+#define GUA_MAPPED_FILE_HPP
+
+#include <gua/platform.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace gua
+{
+/**
+ * Read-only view of the content of a file.
+ *
+ * The file is memory mapped where possible, so large files are paged in by
+ * the operating system instead of being copied into the heap. Elsewhere, or
+ * if mapping fails, the content is read into a buffer. The data is not
+ * null-terminated.
+ */
+class GUA_DLL MappedFile
+{
+  public:
+    MappedFile() = default;
+    explicit MappedFile(std::string const& file_name);
+    ~MappedFile();
+
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    // unmaps the previous file, fails if the file cannot be read
+    bool open(std::string const& file_name);
+    void close();
+
+    bool is_open() const { return is_open_; }
+
+    char const* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+  private:
+    bool is_open_ = false;
+    char const* data_ = nullptr;
+    std::size_t size_ = 0;
+
+    void* mapping_ = nullptr;
+    std::vector<char> buffer_;
+};
+
+} // namespace gua
+
+#endif // GUA_MAPPED_FILE_HPP
@@ -0,0 +1,92 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#ifndef GUA_MESSAGE_PLAYER_HPP
+#define GUA_MESSAGE_PLAYER_HPP
+
+#include <gua/platform.hpp>
+#include <gua/utils/MessageRecording.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace gua
+{
+/**
+ * Hands out the messages of a MessageRecording at the pace they were
+ * recorded, optionally accelerated.
+ *
+ * With a speed of zero or less, messages are returned as fast as they are
+ * requested, which makes replays deterministic for profiling and tests.
+ * When looping, the first message follows the last one after the mean
+ * recorded interval. Recordings without duration are played only once.
+ */
+class GUA_DLL MessagePlayer
+{
+  public:
+    MessagePlayer(std::shared_ptr<MessageRecording const> const& recording, float speed = 1.f, bool loop = true);
+
+    /**
+     * Blocks until the next message is due. Returns false at the end of a
+     * non-looping recording and after stop().
+     */
+    bool next(MessageRecording::Message& message);
+
+    // continues with the first message recorded at or after the given time in microseconds
+    void seek(uint64_t timestamp);
+
+    void set_speed(float speed);
+    float get_speed() const;
+
+    // wakes and ends a pending next()
+    void stop();
+
+    std::shared_ptr<MessageRecording const> const& get_recording() const { return recording_; }
+
+    /**
+     * Parses endpoints of the form "file://<path>[?speed=<factor>]". Returns
+     * false for all other endpoints.
+     */
+    static bool parse_endpoint(std::string const& endpoint, std::string& filename, float& speed);
+
+  private:
+    std::shared_ptr<MessageRecording const> recording_;
+    bool loop_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable stopped_condition_;
+    bool stopped_ = false;
+    float speed_;
+
+    std::size_t position_ = 0;
+    // the time at which the message at position_ became the reference for pacing
+    bool needs_sync_ = true;
+    std::chrono::steady_clock::time_point sync_time_;
+    uint64_t sync_timestamp_ = 0;
+};
+
+} // namespace gua
+
+#endif // GUA_MESSAGE_PLAYER_HPP
@@ -0,0 +1,102 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#ifndef GUA_MESSAGE_RECORDER_HPP
+#define GUA_MESSAGE_RECORDER_HPP
+
+#include <gua/platform.hpp>
+#include <gua/utils/MessageRecording.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gua
+{
+/**
+ * Writes network messages with their time of arrival to a file which can be
+ * read with MessageRecording and replayed with MessagePlayer.
+ *
+ * write() is thread-safe and only copies the message, the file is written
+ * by a thread owned by the recorder. open() and close() are expected to be
+ * called from a single thread. The index is appended by close(), which is
+ * called by the destructor as well and waits for queued messages.
+ */
+class GUA_DLL MessageRecorder
+{
+  public:
+    MessageRecorder() = default;
+    ~MessageRecorder();
+
+    MessageRecorder(MessageRecorder const&) = delete;
+    MessageRecorder& operator=(MessageRecorder const&) = delete;
+
+    bool open(std::string const& filename);
+    bool is_open() const;
+
+    /**
+     * Appends a message. Without timestamp, the time since the first message
+     * is used.
+     */
+    void write(void const* data, std::size_t size);
+    void write(void const* data, std::size_t size, uint64_t timestamp);
+
+    void close();
+
+    std::size_t get_num_messages() const;
+
+  private:
+    struct PendingMessage
+    {
+        uint64_t timestamp = 0;
+        std::vector<char> data;
+    };
+
+    void enqueue(void const* data, std::size_t size, uint64_t timestamp, std::unique_lock<std::mutex>& lock);
+    void write_loop();
+    void write_to_file(PendingMessage const& message);
+
+    mutable std::mutex mutex_;
+    std::condition_variable message_available_;
+    std::deque<PendingMessage> queue_;
+    // storage of written messages, reused by enqueue()
+    std::vector<std::vector<char>> spare_buffers_;
+    bool open_ = false;
+    std::size_t num_messages_ = 0;
+    bool started_ = false;
+    std::chrono::steady_clock::time_point start_;
+
+    // only accessed by the writer thread while it runs
+    std::thread writer_;
+    std::ofstream file_;
+    std::vector<MessageRecording::IndexEntry> index_;
+    uint64_t offset_ = 0;
+};
+
+} // namespace gua
+
+#endif // GUA_MESSAGE_RECORDER_HPP
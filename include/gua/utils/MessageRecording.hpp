@@ -0,0 +1,118 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#ifndef GUA_MESSAGE_RECORDING_HPP
+#define GUA_MESSAGE_RECORDING_HPP
+
+#include <gua/platform.hpp>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gua
+{
+/**
+ * Read-only access to a file of recorded network messages.
+ *
+ * The file is memory-mapped, messages are returned as pointers into the
+ * mapping and stay valid as long as the MessageRecording exists. Files
+ * without index (e.g. of a crashed recorder) are indexed by scanning them.
+ *
+ * Layout: a FileHeader, then one RecordHeader followed by the payload per
+ * message (padded to 8 bytes), then one IndexEntry per message and a
+ * FileFooter.
+ */
+class GUA_DLL MessageRecording
+{
+  public:
+    static const uint32_t VERSION = 1;
+
+    struct FileHeader
+    {
+        char magic[8] = {'G', 'U', 'A', 'R', 'E', 'C', '\0', '\0'};
+        uint32_t version = VERSION;
+        uint32_t reserved = 0;
+    };
+
+    struct RecordHeader
+    {
+        uint64_t timestamp = 0; // microseconds since the first message
+        uint64_t size = 0;
+    };
+
+    struct IndexEntry
+    {
+        uint64_t timestamp = 0;
+        uint64_t offset = 0; // of the payload
+        uint64_t size = 0;
+    };
+
+    struct FileFooter
+    {
+        uint64_t index_offset = 0;
+        uint64_t num_messages = 0;
+        char magic[8] = {'G', 'U', 'A', 'I', 'D', 'X', '\0', '\0'};
+    };
+
+    struct Message
+    {
+        uint64_t timestamp = 0;
+        uint8_t const* data = nullptr;
+        std::size_t size = 0;
+    };
+
+    explicit MessageRecording(std::string const& filename);
+
+    bool is_valid() const { return valid_; }
+
+    std::size_t get_num_messages() const { return index_.size(); }
+
+    Message get_message(std::size_t index) const;
+
+    /**
+     * Returns the index of the first message recorded at or after the given
+     * time in microseconds, or get_num_messages() if there is none.
+     */
+    std::size_t find_message(uint64_t timestamp) const;
+
+    // microseconds between the first and the last message
+    uint64_t get_duration() const;
+
+    static std::size_t padded_size(std::size_t size) { return (size + 7) & ~std::size_t(7); }
+
+  private:
+    bool read_index(uint8_t const* begin, std::size_t size);
+    bool scan_records(uint8_t const* begin, std::size_t size);
+
+    boost::interprocess::file_mapping file_;
+    boost::interprocess::mapped_region region_;
+    std::vector<IndexEntry> index_;
+    bool valid_ = false;
+};
+
+} // namespace gua
+
+#endif // GUA_MESSAGE_RECORDING_HPP
@@ -0,0 +1,188 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#ifndef GUA_TIME_STEP_STREAMER_HPP
+#define GUA_TIME_STEP_STREAMER_HPP
+
+#include <gua/platform.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gua
+{
+class TimeStepStreamer;
+
+/**
+ * Threads loading time steps for any number of TimeStepStreamers.
+ *
+ * Streamers sharing a pool take turns, so the number of loader threads
+ * stays the same no matter how many sequences are streamed at once.
+ */
+class GUA_DLL TimeStepLoaderPool
+{
+  public:
+    explicit TimeStepLoaderPool(unsigned num_threads);
+    ~TimeStepLoaderPool();
+
+    TimeStepLoaderPool(TimeStepLoaderPool const&) = delete;
+    TimeStepLoaderPool& operator=(TimeStepLoaderPool const&) = delete;
+
+    unsigned get_num_threads() const { return unsigned(threads_.size()); }
+
+  private:
+    friend class TimeStepStreamer;
+
+    void attach(TimeStepStreamer* streamer);
+    // waits for the streamer's loads which are in progress
+    void detach(TimeStepStreamer* streamer);
+    // wakes the threads, the window of a streamer changed
+    void notify();
+    void work();
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::condition_variable load_finished_;
+    // attached streamers and the number of their steps being loaded
+    std::map<TimeStepStreamer*, unsigned> streamers_;
+    TimeStepStreamer* last_served_ = nullptr;
+    bool running_ = true;
+
+    std::vector<std::thread> threads_;
+};
+
+/**
+ * Streams the time steps of a sequence (one raw file per step) from disk.
+ *
+ * Files are memory-mapped when a step is loaded. Only a window of steps
+ * around the playback cursor, as many as fit into the memory budget, is
+ * kept in memory. The threads of a TimeStepLoaderPool fill the window ahead
+ * of the playback direction and evict the steps which fell out of it.
+ * Prefetching is not paced by the playback speed: the threads are woken
+ * whenever set_playback() moves the window across a step boundary and load
+ * the missing steps as fast as the disk allows. The budget covers the
+ * cached steps only; steps returned by get_step() stay alive as long as
+ * they are referenced.
+ */
+class GUA_DLL TimeStepStreamer
+{
+  public:
+    using Step = std::shared_ptr<std::vector<uint8_t> const>;
+
+    struct Statistics
+    {
+        // requested steps which were in memory already
+        std::size_t hits = 0;
+        // requested steps which had to be loaded or waited for
+        std::size_t misses = 0;
+        // steps loaded by the pool
+        std::size_t prefetched = 0;
+        std::size_t evicted = 0;
+        std::size_t resident_bytes = 0;
+        std::size_t peak_resident_bytes = 0;
+    };
+
+    /**
+     * Files shorter than step_size are padded with zeros, a warning is
+     * logged for files shorter than file_size (step_size if zero). The
+     * window holds at least one step, even if the budget is smaller.
+     * Without loader pool, the streamer uses a thread of its own.
+     */
+    TimeStepStreamer(std::vector<std::string> const& files,
+                     std::size_t step_size,
+                     std::size_t memory_budget,
+                     std::shared_ptr<TimeStepLoaderPool> const& loaders = nullptr,
+                     std::size_t file_size = 0);
+    ~TimeStepStreamer();
+
+    std::size_t get_num_steps() const { return files_.size(); }
+    std::size_t get_step_size() const { return step_size_; }
+    std::size_t get_window_size() const { return window_size_; }
+
+    /**
+     * Moves the window. Negative speeds play backwards, a speed of zero
+     * keeps the window centered around the cursor. Only the sign of the
+     * speed is used, the window follows the cursor passed here. Cursors
+     * outside the sequence wrap around.
+     */
+    void set_playback(float cursor, float steps_per_second);
+
+    /**
+     * Returns the given step, loading it first if it's not in memory.
+     */
+    Step get_step(std::size_t step);
+
+    /**
+     * Returns the given step if it is in memory and nullptr otherwise.
+     */
+    Step try_get_step(std::size_t step);
+
+    /**
+     * Blocks until the pool has filled the current window.
+     */
+    void wait_for_prefetch();
+
+    Statistics get_statistics() const;
+
+  private:
+    friend class TimeStepLoaderPool;
+
+    // reserves the next step the pool should load, returns false if there is none
+    bool begin_prefetch(std::size_t& step);
+    void end_prefetch(std::size_t step, Step const& data);
+
+    // steps of the window, most important first; the mutex has to be locked
+    std::vector<std::size_t> window() const;
+    // drops the least important step other than keep; the mutex has to be locked
+    bool evict_one(std::size_t keep, bool outside_window_only);
+    Step load(std::size_t step) const;
+    void insert(std::size_t step, Step const& data);
+
+    std::vector<std::string> files_;
+    std::size_t step_size_;
+    std::size_t file_size_;
+    std::size_t window_size_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable loaded_;
+    std::map<std::size_t, Step> resident_;
+    std::set<std::size_t> loading_;
+    float cursor_ = 0.f;
+    float speed_ = 0.f;
+    std::size_t last_missed_step_ = std::size_t(-1);
+    bool idle_ = false;
+    bool running_ = true;
+    Statistics statistics_;
+
+    std::shared_ptr<TimeStepLoaderPool> loaders_;
+};
+
+} // namespace gua
+
+#endif // GUA_TIME_STEP_STREAMER_HPP
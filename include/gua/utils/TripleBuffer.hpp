@@ -0,0 +1,85 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef GUA_TRIPLE_BUFFER_HPP
+#define GUA_TRIPLE_BUFFER_HPP
+
+// external headers
+#include <atomic>
+
+namespace gua
+{
+/**
+ * Lock-free exchange of the latest version of a value between one writer
+ * and one reader thread.
+ *
+ * The writer fills write_buffer() and publishes it as a whole, the reader
+ * picks up the latest published buffer with acquire(). Neither side ever
+ * waits, the writer may publish many times in between two reads and only the
+ * latest version is seen. Buffers are reused, so the writer has to overwrite
+ * everything it publishes.
+ */
+template <typename T>
+class TripleBuffer
+{
+  public:
+    TripleBuffer() : latest_(1), write_(0), read_(2) {}
+
+    // only to be used by the writer thread
+    T& write_buffer() { return buffers_[write_]; }
+
+    // makes the write buffer the latest one and continues writing into a buffer the reader does not hold
+    void publish() { write_ = latest_.exchange(write_ | NEW_DATA, std::memory_order_acq_rel) & INDEX_MASK; }
+
+    /**
+     * Makes the latest published buffer the read buffer. Returns false if
+     * nothing has been published since the last call.
+     */
+    bool acquire()
+    {
+        if(!(latest_.load(std::memory_order_relaxed) & NEW_DATA))
+            return false;
+
+        read_ = latest_.exchange(read_, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    // only to be used by the reader thread
+    T const& read_buffer() const { return buffers_[read_]; }
+
+    TripleBuffer(TripleBuffer const&) = delete;
+    TripleBuffer& operator=(TripleBuffer const&) = delete;
+
+  private:
+    static const unsigned INDEX_MASK = 3;
+    static const unsigned NEW_DATA = 4;
+
+    T buffers_[3];
+
+    // index of the latest published buffer, or'ed with NEW_DATA until the reader takes it
+    std::atomic<unsigned> latest_;
+    unsigned write_;
+    unsigned read_;
+};
+
+} // namespace gua
+
+#endif // GUA_TRIPLE_BUFFER_HPP
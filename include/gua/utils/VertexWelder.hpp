@@ -0,0 +1,66 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef GUA_VERTEX_WELDER_HPP
+#define GUA_VERTEX_WELDER_HPP
+
+#include <gua/platform.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace gua
+{
+/**
+ * Merges vertices with identical positions into one.
+ *
+ * Positions are compared with ==, so 0 and -0 are welded and NaNs never are.
+ * Lookups go through an open addressing hash table of vertex indices, adding
+ * n vertices takes expected O(n) time.
+ */
+class GUA_DLL VertexWelder
+{
+  public:
+    explicit VertexWelder(std::size_t expected_vertices = 0);
+
+    // index of the vertex at the given position, it is appended if there is none yet
+    unsigned add(double x, double y, double z);
+
+    std::size_t size() const { return positions_.size() / 3; }
+
+    // x, y, z of all vertices in the order they were first added
+    std::vector<double> const& positions() const { return positions_; }
+
+    void clear();
+
+  private:
+    static const unsigned EMPTY_SLOT = ~0u;
+
+    std::size_t slot_of(double const* position) const;
+    void rehash(std::size_t num_slots);
+
+    std::vector<double> positions_;
+    std::vector<unsigned> slots_;
+};
+
+} // namespace gua
+
+#endif // GUA_VERTEX_WELDER_HPP
@@ -0,0 +1,140 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef GUA_VOLUME_BRICK_GRID_HPP
+#define GUA_VOLUME_BRICK_GRID_HPP
+
+#include <gua/platform.hpp>
+#include <gua/utils/BinaryCacheFile.hpp>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gua
+{
+/**
+ * Coarse grid over a volume used to skip empty space during ray marching.
+ *
+ * The volume is split into cubic bricks and the value range of every brick
+ * is recorded. Each brick also covers the voxels bordering it, so trilinear
+ * samples taken anywhere inside an empty brick are guaranteed to be empty.
+ * For a transfer function, the ranges yield which bricks are occupied and,
+ * for the empty ones, the distance to the closest occupied brick. Values
+ * are normalized to [0, 1] like the samples of the volume texture.
+ */
+class GUA_DLL VolumeBrickGrid
+{
+  public:
+    enum class VoxelType
+    {
+        UINT8,
+        UINT16,
+        FLOAT32
+    };
+
+    struct ValueRange
+    {
+        float min = 0.f;
+        float max = 0.f;
+    };
+
+    using Dimensions = std::array<unsigned, 3>;
+
+    static const unsigned DEFAULT_BRICK_SIZE = 16;
+
+    // distances are clamped to this value, it also marks grids without any occupied brick
+    static const uint8_t MAX_DISTANCE = 255;
+
+    /**
+     * Computes the value ranges of all bricks of the given volume, stored
+     * x-major without any padding.
+     */
+    void build(void const* voxels, Dimensions const& volume_dimensions, VoxelType type, unsigned brick_size = DEFAULT_BRICK_SIZE);
+
+    /**
+     * Grows the ranges to cover another volume of the same dimensions, e.g.
+     * further time steps of a sequence.
+     */
+    void extend(void const* voxels, VoxelType type);
+
+    bool empty() const { return ranges_.empty(); }
+
+    Dimensions const& get_volume_dimensions() const { return volume_dimensions_; }
+    Dimensions const& get_grid_dimensions() const { return grid_dimensions_; }
+    unsigned get_brick_size() const { return brick_size_; }
+
+    std::vector<ValueRange> const& get_value_ranges() const { return ranges_; }
+    ValueRange const& get_value_range(unsigned x, unsigned y, unsigned z) const;
+
+    /**
+     * One byte per brick, 1 if the brick holds any value within the visible
+     * range [min_visible, max_visible].
+     */
+    std::vector<uint8_t> compute_occupancy(float min_visible, float max_visible) const;
+
+    /**
+     * One byte per brick, 1 if the transfer function assigns a non-zero
+     * opacity to any value of the brick. The lookup table samples the
+     * opacity at equidistant values from 0 to 1; it is expected to be
+     * filtered linearly, so the entries enclosing a range are included.
+     */
+    std::vector<uint8_t> compute_occupancy(std::vector<float> const& opacity_lookup_table) const;
+
+    /**
+     * Chebyshev distance, in bricks, from every brick to the closest
+     * occupied one: 0 for occupied bricks, n for empty bricks whose
+     * neighbourhood of n - 1 bricks in every direction is empty as well.
+     * Both the occupancy and the distances are encoded in the result.
+     */
+    std::vector<uint8_t> compute_distances(std::vector<uint8_t> const& occupancy) const;
+
+    /**
+     * Stores the ranges on disk. The key identifies the data the grid has
+     * been built from, usually hash_file() of the volume.
+     */
+    bool save(std::string const& file_name, uint64_t key) const;
+
+    /**
+     * Reads ranges stored with save(). Fails if there is no such file or if
+     * it has been written for another key or brick size.
+     */
+    bool load(std::string const& file_name, uint64_t key, unsigned brick_size = DEFAULT_BRICK_SIZE);
+
+    static const uint64_t HASH_SEED = BinaryCacheFile::HASH_SEED;
+
+    // see BinaryCacheFile
+    static uint64_t hash_data(void const* data, std::size_t num_bytes, uint64_t hash = HASH_SEED) { return BinaryCacheFile::hash_data(data, num_bytes, hash); }
+    static uint64_t hash_file(std::string const& file_name) { return BinaryCacheFile::hash_file(file_name); }
+
+  private:
+    std::size_t brick_index(unsigned x, unsigned y, unsigned z) const { return (std::size_t(z) * grid_dimensions_[1] + y) * grid_dimensions_[0] + x; }
+
+    Dimensions volume_dimensions_ = {{0, 0, 0}};
+    Dimensions grid_dimensions_ = {{0, 0, 0}};
+    unsigned brick_size_ = DEFAULT_BRICK_SIZE;
+    std::vector<ValueRange> ranges_;
+};
+
+} // namespace gua
+
+#endif // GUA_VOLUME_BRICK_GRID_HPP
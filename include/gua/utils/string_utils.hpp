@@ -58,6 +58,17 @@ GUA_DLL std::string demangle_type_name(const char* name);
 
 GUA_DLL std::string sanitize(std::string const& str);
 
+/**
+ * Parses a decimal floating point number (as written by printf) at the
+ * start of [begin, end) without any allocation. The result is rounded
+ * exactly like std::strtof in the "C" locale. Returns the end of the
+ * number, or begin if there is none.
+ */
+GUA_DLL char const* parse_float(char const* begin, char const* end, float& value);
+
+// like parse_float(), for decimal integers with an optional sign; values out of range are clamped
+GUA_DLL char const* parse_int(char const* begin, char const* end, int& value);
+
 } // namespace string_utils
 } // namespace gua
 
@@ -0,0 +1,165 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef GUA_LOD_BVH_QUERY_HPP
+#define GUA_LOD_BVH_QUERY_HPP
+
+// guacamole headers
+#include <gua/renderer/Lod.hpp>
+#include <gua/math/math.hpp>
+
+// external headers
+#include <lamure/types.h>
+#include <lamure/ren/cut.h>
+#include <scm/gl_core/primitives/box.h>
+#include <scm/gl_core/primitives/frustum.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace lamure
+{
+namespace ren
+{
+class bvh;
+} // namespace ren
+} // namespace lamure
+
+namespace gua
+{
+struct Ray;
+
+/**
+ * CPU copies of the bvhs of lod models for batched queries.
+ *
+ * The bounding boxes are copied when a model is added, so many rays can be
+ * picked against all models at once without touching lamure's databases.
+ * The rays are distributed over the threads of a pool which is shared by
+ * all queries and started with the first one.
+ *
+ * classify_cuts() culls the cuts of many models in parallel, one model per
+ * worker at a time. It is used by the lod renderers and doesn't need a
+ * LodBvhQuery instance.
+ */
+class GUA_LOD_DLL LodBvhQuery
+{
+  public:
+    struct Hit
+    {
+        // index of the model, -1 if no model was hit
+        int model = -1;
+        lamure::node_t node = 0;
+        // ray parameter, the hit is at origin + distance * direction
+        float distance = 0.0f;
+        math::vec3 position;
+    };
+
+    struct CutCullingJob
+    {
+        // frustum and clipping planes in model coordinates
+        scm::gl::frustum frustum;
+        std::vector<math::vec4> clipping_planes;
+
+        std::vector<scm::gl::boxf> const* bounding_boxes = nullptr;
+        std::vector<lamure::ren::cut::node_slot_aggregate> const* cut = nullptr;
+
+        // nodes of the cut inside or intersecting the frustum and in front of all clipping planes
+        std::vector<lamure::node_t> visible_nodes;
+    };
+
+    // a model placed in the scene, models may be placed several times
+    struct Instance
+    {
+        unsigned model = 0;
+        math::mat4 world_transform = math::mat4::identity();
+    };
+
+    // num_threads = 0 uses one thread per hardware core, more than that are not used
+    explicit LodBvhQuery(unsigned num_threads = 0);
+
+    /**
+     * Copies the bounding boxes of a bvh.
+     *
+     * \param name             Reported for hits, e.g. the file name of the model.
+     * \param world_transform  Transformation from model to world coordinates.
+     *
+     * \return                 The index of the model.
+     */
+    unsigned add_model(std::string const& name, lamure::ren::bvh const& bvh, math::mat4 const& world_transform = math::mat4::identity());
+
+    // nodes are stored like in lamure's bvhs, the children of node n are n * fan_factor + 1 ... n * fan_factor + fan_factor
+    unsigned add_model(std::string const& name, unsigned fan_factor, std::vector<scm::gl::boxf> const& bounding_boxes, math::mat4 const& world_transform = math::mat4::identity());
+
+    // reads the bvh of a *.bvh file, returns -1 if it can't be read
+    int load_model(std::string const& bvh_file_name, math::mat4 const& world_transform = math::mat4::identity());
+
+    // returns -1 if there is no model with this name
+    int find_model(std::string const& name) const;
+
+    void set_world_transform(unsigned model, math::mat4 const& world_transform);
+
+    unsigned num_models() const { return unsigned(models_.size()); }
+    std::string const& get_model_name(unsigned model) const { return models_[model].name; }
+    unsigned get_num_threads() const { return num_threads_; }
+
+    /**
+     * Finds the closest leaf bounding box of all models along every ray.
+     *
+     * Rays are given in world coordinates and are tested between their
+     * origin and origin + t_max_ * direction_. Bounding boxes are scaled
+     * around their centers by aabb_scale.
+     */
+    std::vector<Hit> pick(std::vector<Ray> const& rays, float aabb_scale = 1.0f) const;
+
+    // picks against the given instances only, their world transforms replace the ones of the models
+    std::vector<Hit> pick(std::vector<Ray> const& rays, std::vector<Instance> const& instances, float aabb_scale = 1.0f) const;
+
+    static void classify_cuts(std::vector<CutCullingJob>& jobs, unsigned num_threads = 0);
+
+    // true if the box is at least partially in front of all planes
+    static bool intersects(scm::gl::boxf const& box, std::vector<math::vec4> const& planes);
+
+  private:
+    struct Model
+    {
+        std::string name;
+        unsigned fan_factor;
+        unsigned num_nodes;
+        // min x, y, z and max x, y, z of each node
+        std::vector<float> boxes;
+        math::mat4 world_to_model;
+    };
+
+    // model index and world to model transform of each instance
+    using Placements = std::vector<std::pair<unsigned, math::mat4>>;
+
+    std::vector<Hit> pick(std::vector<Ray> const& rays, Placements const& placements, float aabb_scale) const;
+    // stack holds nodes and their entry distance
+    void pick(Ray const& ray, Placements const& placements, float aabb_scale, std::vector<std::pair<lamure::node_t, float>>& stack, Hit& hit) const;
+
+    unsigned num_threads_;
+    std::vector<Model> models_;
+};
+
+} // namespace gua
+
+#endif // GUA_LOD_BVH_QUERY_HPP
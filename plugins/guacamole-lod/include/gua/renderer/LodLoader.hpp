@@ -27,12 +27,16 @@
 #include <gua/scenegraph/PickResult.hpp>
 // external headers
 #include <set>
+#include <string>
+#include <utility>
+#include <vector>
 #include <unordered_set>
 #include <memory>
 
 namespace gua
 {
 class Material;
+struct Ray;
 
 namespace node
 {
@@ -79,6 +83,17 @@ class GUA_LOD_DLL LodLoader
     std::pair<std::string, math::vec3>
     pick_lod_bvh(math::vec3 const& ray_origin, math::vec3 const& ray_forward, float max_distance, std::set<std::string> const& model_filenames, float aabb_scale) const;
 
+    /**
+     * Picks many rays at once against the bvhs of the given PLodNodes and
+     * MLodNodes, the rays are distributed over all hardware threads.
+     *
+     * Each ray is tested from origin_ to origin_ + t_max_ * direction_. For
+     * every ray, the geometry description of the hit model and the world
+     * position of the hit are returned, the description is empty for misses.
+     * The bvhs are copied once per model and reused by later calls.
+     */
+    std::vector<std::pair<std::string, math::vec3>> pick_lod_bvh(std::vector<Ray> const& rays, std::vector<std::shared_ptr<node::Node>> const& lod_nodes, float aabb_scale) const;
+
     std::set<PickResult> pick_lod_interpolate(math::vec3 const& bundle_origin,
                                               math::vec3 const& bundle_forward,
                                               math::vec3 const& bundle_up,
@@ -72,8 +72,6 @@ class GUA_LOD_DLL MLodRenderer
 
     lamure::context_t _lamure_register_context(gua::RenderContext const& ctx);
 
-    bool _intersects(scm::gl::boxf const& bbox, std::vector<math::vec4> const& global_planes) const;
-
     std::vector<math::vec3> _get_frustum_corners_vs(gua::Frustum const& frustum) const;
 
   private: // member variables
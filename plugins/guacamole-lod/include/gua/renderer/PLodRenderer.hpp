@@ -59,7 +59,7 @@ class GUA_LOD_DLL PLodRenderer
   private: // shader related auxiliary methods
     void perform_frustum_culling_for_scene(std::vector<node::Node*>& models,
                                            std::unordered_map<node::PLodNode*, std::unordered_set<lamure::node_t>>& culling_results_per_model,
-                                           std::unordered_map<node::PLodNode*, lamure::ren::cut*> cut_map,
+                                           std::unordered_map<node::PLodNode*, lamure::ren::cut*> const& cut_map,
                                            lamure::ren::camera const& cut_update_cam,
                                            gua::Pipeline& pipe) const;
 
@@ -71,8 +71,6 @@ class GUA_LOD_DLL PLodRenderer
     lamure::context_t _register_context_in_cut_update(gua::RenderContext const& ctx);
 
   private: // misc auxiliary methods
-    bool _intersects(scm::gl::boxf const& bbox, std::vector<math::vec4> const& global_planes) const;
-
     std::vector<math::vec3> _get_frustum_corners_vs(gua::Frustum const& frustum) const;
 
   private: // member variables
@@ -0,0 +1,462 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+// class header
+#include <gua/renderer/LodBvhQuery.hpp>
+
+// guacamole headers
+#include <gua/utils/KDTreeUtils.hpp>
+#include <gua/utils/Logger.hpp>
+
+// external headers
+#include <lamure/ren/bvh.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace gua
+{
+namespace
+{
+// rays picked by a worker before it takes the next chunk
+std::size_t const RAYS_PER_CHUNK = 64;
+
+// below this number of cut nodes, waking workers costs more than classifying on the calling thread
+std::size_t const MIN_CUT_NODES_PER_THREAD = 2048;
+
+unsigned resolve_num_threads(unsigned num_threads) { return num_threads > 0 ? num_threads : std::max(1u, std::thread::hardware_concurrency()); }
+
+// threads helping the callers of parallel_for(), started once per process
+class WorkerPool
+{
+  public:
+    struct Batch
+    {
+        std::function<void(std::size_t)> const* work = nullptr;
+        std::size_t count = 0;
+        std::atomic<std::size_t> next_index{0};
+        // workers running the batch, guarded by the pool's mutex
+        unsigned num_helpers = 0;
+    };
+
+    static WorkerPool& instance()
+    {
+        static WorkerPool pool;
+        return pool;
+    }
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        ticket_available_.notify_all();
+
+        for(auto& thread : threads_)
+        {
+            thread.join();
+        }
+    }
+
+    // the calling thread works on the batch as well, so it completes even if all workers are busy
+    void run(Batch& batch, unsigned num_threads)
+    {
+        std::size_t const num_workers = std::min<std::size_t>({std::size_t(num_threads), batch.count, threads_.size() + 1});
+        std::size_t const num_helpers = num_workers > 0 ? num_workers - 1 : 0;
+
+        if(num_helpers > 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                tickets_.insert(tickets_.end(), num_helpers, &batch);
+            }
+            ticket_available_.notify_all();
+        }
+
+        process(batch);
+
+        if(num_helpers > 0)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            tickets_.erase(std::remove(tickets_.begin(), tickets_.end(), &batch), tickets_.end());
+            helper_done_.wait(lock, [&batch]() { return batch.num_helpers == 0; });
+        }
+    }
+
+  private:
+    WorkerPool()
+    {
+        // the calling thread is the last worker
+        for(unsigned t = 1; t < resolve_num_threads(0); ++t)
+        {
+            threads_.emplace_back([this]() { work(); });
+        }
+    }
+
+    static void process(Batch& batch)
+    {
+        for(std::size_t index = batch.next_index++; index < batch.count; index = batch.next_index++)
+        {
+            (*batch.work)(index);
+        }
+    }
+
+    void work()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        while(true)
+        {
+            ticket_available_.wait(lock, [this]() { return !running_ || !tickets_.empty(); });
+
+            if(!running_)
+            {
+                return;
+            }
+
+            Batch* batch = tickets_.front();
+            tickets_.pop_front();
+            ++batch->num_helpers;
+
+            lock.unlock();
+            process(*batch);
+            lock.lock();
+
+            --batch->num_helpers;
+            helper_done_.notify_all();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable ticket_available_;
+    std::condition_variable helper_done_;
+    // one entry per worker a batch asked for
+    std::deque<Batch*> tickets_;
+    bool running_ = true;
+    std::vector<std::thread> threads_;
+};
+
+// calls work(index) for every index in [0, count) on at most num_threads threads, the calling thread is one of them
+void parallel_for(std::size_t count, unsigned num_threads, std::function<void(std::size_t)> const& work)
+{
+    WorkerPool::Batch batch;
+    batch.work = &work;
+    batch.count = count;
+
+    WorkerPool::instance().run(batch, num_threads);
+}
+
+// entry and exit parameter of a ray and a box scaled around its center, false if they don't meet in [t_min, t_max]
+bool intersect_box(float const* box, float const* origin, float const* inverse_direction, float aabb_scale, float t_min, float t_max, float& t_entry)
+{
+    for(int axis = 0; axis < 3; ++axis)
+    {
+        float const center = 0.5f * (box[axis] + box[axis + 3]);
+        float const half_extent = 0.5f * aabb_scale * (box[axis + 3] - box[axis]);
+
+        float const t_0 = (center - half_extent - origin[axis]) * inverse_direction[axis];
+        float const t_1 = (center + half_extent - origin[axis]) * inverse_direction[axis];
+
+        // NaN for rays parallel to and on a slab boundary, std::min / std::max keep the other value then
+        t_min = std::max(t_min, std::min(t_0, t_1));
+        t_max = std::min(t_max, std::max(t_0, t_1));
+
+        if(t_min > t_max)
+        {
+            return false;
+        }
+    }
+
+    t_entry = t_min;
+    return true;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+LodBvhQuery::LodBvhQuery(unsigned num_threads) : num_threads_(resolve_num_threads(num_threads)), models_() {}
+
+////////////////////////////////////////////////////////////////////////////////
+
+unsigned LodBvhQuery::add_model(std::string const& name, lamure::ren::bvh const& bvh, math::mat4 const& world_transform)
+{
+    return add_model(name, bvh.get_fan_factor(), bvh.get_bounding_boxes(), world_transform);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+unsigned LodBvhQuery::add_model(std::string const& name, unsigned fan_factor, std::vector<scm::gl::boxf> const& bounding_boxes, math::mat4 const& world_transform)
+{
+    Model model;
+    model.name = name;
+    model.fan_factor = std::max(1u, fan_factor);
+    model.num_nodes = unsigned(bounding_boxes.size());
+    model.boxes.resize(6 * bounding_boxes.size());
+
+    for(std::size_t node = 0; node < bounding_boxes.size(); ++node)
+    {
+        for(int axis = 0; axis < 3; ++axis)
+        {
+            model.boxes[6 * node + axis] = bounding_boxes[node].min_vertex()[axis];
+            model.boxes[6 * node + 3 + axis] = bounding_boxes[node].max_vertex()[axis];
+        }
+    }
+
+    model.world_to_model = scm::math::inverse(world_transform);
+
+    models_.push_back(std::move(model));
+    return unsigned(models_.size() - 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int LodBvhQuery::load_model(std::string const& bvh_file_name, math::mat4 const& world_transform)
+{
+    try
+    {
+        lamure::ren::bvh bvh(bvh_file_name);
+        return int(add_model(bvh_file_name, bvh, world_transform));
+    }
+    catch(std::exception const& e)
+    {
+        Logger::LOG_WARNING << "LodBvhQuery::load_model(): Unable to read " << bvh_file_name << ": " << e.what() << std::endl;
+    }
+    return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int LodBvhQuery::find_model(std::string const& name) const
+{
+    for(std::size_t model = 0; model < models_.size(); ++model)
+    {
+        if(models_[model].name == name)
+        {
+            return int(model);
+        }
+    }
+    return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void LodBvhQuery::set_world_transform(unsigned model, math::mat4 const& world_transform) { models_[model].world_to_model = scm::math::inverse(world_transform); }
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<LodBvhQuery::Hit> LodBvhQuery::pick(std::vector<Ray> const& rays, float aabb_scale) const
+{
+    Placements placements;
+    placements.reserve(models_.size());
+
+    for(std::size_t m = 0; m < models_.size(); ++m)
+    {
+        placements.push_back(std::make_pair(unsigned(m), models_[m].world_to_model));
+    }
+
+    return pick(rays, placements, aabb_scale);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<LodBvhQuery::Hit> LodBvhQuery::pick(std::vector<Ray> const& rays, std::vector<Instance> const& instances, float aabb_scale) const
+{
+    Placements placements;
+    placements.reserve(instances.size());
+
+    for(auto const& instance : instances)
+    {
+        if(instance.model < models_.size())
+        {
+            placements.push_back(std::make_pair(instance.model, scm::math::inverse(instance.world_transform)));
+        }
+    }
+
+    return pick(rays, placements, aabb_scale);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<LodBvhQuery::Hit> LodBvhQuery::pick(std::vector<Ray> const& rays, Placements const& placements, float aabb_scale) const
+{
+    std::vector<Hit> hits(rays.size());
+    std::size_t const num_chunks = (rays.size() + RAYS_PER_CHUNK - 1) / RAYS_PER_CHUNK;
+
+    parallel_for(num_chunks, num_threads_, [&](std::size_t chunk) {
+        std::vector<std::pair<lamure::node_t, float>> stack;
+
+        std::size_t const end = std::min(rays.size(), (chunk + 1) * RAYS_PER_CHUNK);
+        for(std::size_t ray = chunk * RAYS_PER_CHUNK; ray < end; ++ray)
+        {
+            pick(rays[ray], placements, aabb_scale, stack, hits[ray]);
+        }
+    });
+
+    return hits;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void LodBvhQuery::pick(Ray const& ray, Placements const& placements, float aabb_scale, std::vector<std::pair<lamure::node_t, float>>& stack, Hit& hit) const
+{
+    float closest = float(ray.t_max_);
+
+    for(auto const& placement : placements)
+    {
+        unsigned const m = placement.first;
+        Model const& model = models_[m];
+        if(model.num_nodes == 0)
+        {
+            continue;
+        }
+
+        // the ray parameter is the same in model coordinates, the direction isn't normalized
+        math::vec4 const model_origin(placement.second * math::vec4(ray.origin_, 1.0));
+        math::vec4 const model_direction(placement.second * math::vec4(ray.direction_, 0.0));
+
+        float origin[3];
+        float inverse_direction[3];
+        for(int axis = 0; axis < 3; ++axis)
+        {
+            origin[axis] = float(model_origin[axis]);
+            inverse_direction[axis] = 1.0f / float(model_direction[axis]);
+        }
+
+        float t_root = 0.0f;
+        if(!intersect_box(&model.boxes[0], origin, inverse_direction, aabb_scale, 0.0f, closest, t_root))
+        {
+            continue;
+        }
+
+        stack.assign(1, std::make_pair(lamure::node_t(0), t_root));
+
+        while(!stack.empty())
+        {
+            auto const entry = stack.back();
+            stack.pop_back();
+
+            // a closer leaf may have been found since the node was pushed
+            if(entry.second > closest)
+            {
+                continue;
+            }
+
+            lamure::node_t const first_child = entry.first * model.fan_factor + 1;
+            if(first_child >= model.num_nodes)
+            {
+                closest = entry.second;
+                hit.model = int(m);
+                hit.node = entry.first;
+                continue;
+            }
+
+            std::size_t const first_pushed = stack.size();
+            for(unsigned c = 0; c < model.fan_factor && first_child + c < model.num_nodes; ++c)
+            {
+                float t_entry = 0.0f;
+                if(intersect_box(&model.boxes[6 * (first_child + c)], origin, inverse_direction, aabb_scale, 0.0f, closest, t_entry))
+                {
+                    stack.push_back(std::make_pair(lamure::node_t(first_child + c), t_entry));
+                }
+            }
+
+            // the closest child is popped first
+            std::sort(stack.begin() + first_pushed, stack.end(), [](std::pair<lamure::node_t, float> const& a, std::pair<lamure::node_t, float> const& b) { return a.second > b.second; });
+        }
+    }
+
+    if(hit.model >= 0)
+    {
+        hit.distance = closest;
+        hit.position = ray.origin_ + math::vec3::value_type(closest) * ray.direction_;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void LodBvhQuery::classify_cuts(std::vector<CutCullingJob>& jobs, unsigned num_threads)
+{
+    std::size_t num_cut_nodes = 0;
+    for(auto const& job : jobs)
+    {
+        num_cut_nodes += job.cut->size();
+    }
+
+    num_threads = unsigned(std::min<std::size_t>(resolve_num_threads(num_threads), std::max<std::size_t>(1, num_cut_nodes / MIN_CUT_NODES_PER_THREAD)));
+
+    parallel_for(jobs.size(), num_threads, [&](std::size_t j) {
+        CutCullingJob& job = jobs[j];
+        std::vector<scm::gl::boxf> const& bounding_boxes = *job.bounding_boxes;
+
+        job.visible_nodes.clear();
+        for(auto const& n : *job.cut)
+        {
+            if(job.frustum.classify(bounding_boxes[n.node_id_]) != 1)
+            {
+                if(job.clipping_planes.empty() || intersects(bounding_boxes[n.node_id_], job.clipping_planes))
+                {
+                    job.visible_nodes.push_back(n.node_id_);
+                }
+            }
+        }
+    });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool LodBvhQuery::intersects(scm::gl::boxf const& bbox, std::vector<math::vec4> const& planes)
+{
+    auto outside = [](math::vec4 const& plane, scm::math::vec3f const& point) { return (plane[0] * point[0] + plane[1] * point[1] + plane[2] * point[2] + plane[3]) < 0; };
+
+    for(auto const& plane : planes)
+    {
+        auto bbox_max(bbox.max_vertex());
+        auto p(bbox.min_vertex());
+        if(plane[0] >= 0)
+            p[0] = bbox_max[0];
+        if(plane[1] >= 0)
+            p[1] = bbox_max[1];
+        if(plane[2] >= 0)
+            p[2] = bbox_max[2];
+
+        // is the positive vertex outside?
+        if(outside(plane, p))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace gua
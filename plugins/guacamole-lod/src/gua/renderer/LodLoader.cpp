@@ -31,15 +31,27 @@
 #include <gua/databases/GeometryDatabase.hpp>
 #include <gua/databases/MaterialShaderDatabase.hpp>
 #include <gua/renderer/LodResource.hpp>
+#include <gua/renderer/LodBvhQuery.hpp>
+#include <gua/utils/KDTreeUtils.hpp>
 
 // external headers
+#include <lamure/ren/controller.h>
 #include <lamure/ren/dataset.h>
 #include <lamure/ren/model_database.h>
 #include <lamure/ren/policy.h>
 #include <lamure/ren/ray.h>
 
+#include <mutex>
+
 namespace gua
 {
+namespace
+{
+// bvhs copied by pick_lod_bvh(), lamure's model database is shared by all loaders as well
+std::mutex bvh_query_mutex;
+LodBvhQuery bvh_query;
+} // namespace
+
 /////////////////////////////////////////////////////////////////////////////
 LodLoader::LodLoader() : _supported_file_extensions()
 {
@@ -278,6 +290,70 @@ LodLoader::pick_lod_bvh(math::vec3 const& ray_origin, math::vec3 const& ray_forw
 
 ///////////////////////////////////////////////////////////////////////////////
 
+std::vector<std::pair<std::string, math::vec3>> LodLoader::pick_lod_bvh(std::vector<Ray> const& rays, std::vector<std::shared_ptr<node::Node>> const& lod_nodes, float aabb_scale) const
+{
+    lamure::ren::controller* controller = lamure::ren::controller::get_instance();
+    lamure::ren::model_database* database = lamure::ren::model_database::get_instance();
+
+    std::lock_guard<std::mutex> lock(bvh_query_mutex);
+
+    std::vector<LodBvhQuery::Instance> instances;
+
+    for(auto const& lod_node : lod_nodes)
+    {
+        std::string geometry_description;
+
+        if(auto plod_node = std::dynamic_pointer_cast<node::PLodNode>(lod_node))
+        {
+            geometry_description = plod_node->get_geometry_description();
+        }
+        else if(auto mlod_node = std::dynamic_pointer_cast<node::MLodNode>(lod_node))
+        {
+            geometry_description = mlod_node->get_geometry_description();
+        }
+        else
+        {
+            continue;
+        }
+
+        int model = bvh_query.find_model(geometry_description);
+
+        if(model < 0)
+        {
+            lamure::model_t model_id = controller->deduce_model_id(geometry_description);
+            auto* dataset = database->get_model(model_id);
+
+            if(!dataset || !dataset->get_bvh())
+            {
+                Logger::LOG_WARNING << "LodLoader::pick_lod_bvh(): No bvh loaded for " << geometry_description << std::endl;
+                continue;
+            }
+
+            model = int(bvh_query.add_model(geometry_description, *dataset->get_bvh()));
+        }
+
+        LodBvhQuery::Instance instance;
+        instance.model = unsigned(model);
+        instance.world_transform = lod_node->get_world_transform();
+        instances.push_back(instance);
+    }
+
+    std::vector<std::pair<std::string, math::vec3>> results(rays.size(), std::make_pair(std::string(""), math::vec3::zero()));
+
+    auto const hits(bvh_query.pick(rays, instances, aabb_scale));
+    for(std::size_t ray = 0; ray < hits.size(); ++ray)
+    {
+        if(hits[ray].model >= 0)
+        {
+            results[ray] = std::make_pair(bvh_query.get_model_name(hits[ray].model), hits[ray].position);
+        }
+    }
+
+    return results;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 std::set<PickResult> LodLoader::pick_lod_interpolate(math::vec3 const& bundle_origin,
                                                      math::vec3 const& bundle_forward,
                                                      math::vec3 const& bundle_up,
@@ -29,6 +29,7 @@
 #include <gua/renderer/GBuffer.hpp>
 #include <gua/renderer/ABuffer.hpp>
 #include <gua/renderer/ResourceFactory.hpp>
+#include <gua/renderer/LodBvhQuery.hpp>
 
 #include <gua/node/MLodNode.hpp>
 #include <gua/renderer/View.hpp>
@@ -238,6 +239,10 @@ void MLodRenderer::render(gua::Pipeline& pipe, PipelinePassDescription const& de
     target.bind(ctx, write_depth);
     target.set_viewport(ctx);
 
+    // the cuts are classified after all models were visited, lamure's databases are only accessed from this thread
+    std::vector<LodBvhQuery::CutCullingJob> culling_jobs;
+    std::vector<lamure::model_t> culling_job_model_ids;
+
     // loop through all models and perform frustum culling
     for(auto const& object : sorted_objects->second)
     {
@@ -268,12 +273,15 @@ void MLodRenderer::render(gua::Pipeline& pipe, PipelinePassDescription const& de
         lamure::ren::bvh * bvh = database->get_model(model_id)->get_bvh();
         bvh->set_min_lod_depth(mlod_node->get_min_lod_depth());
 
-        scm::gl::frustum const& culling_frustum = cut_update_cam.get_frustum_by_model(math::mat4f(scm_model_matrix));
-        //auto culling_frustum = scm::gl::frustum(scm::math::mat4f(scm_model_view_projection_matrix));
+        culling_jobs.push_back(LodBvhQuery::CutCullingJob());
+        culling_job_model_ids.push_back(model_id);
 
-        std::vector<scm::gl::boxf> const& model_bounding_boxes = bvh->get_bounding_boxes();
+        LodBvhQuery::CutCullingJob& job = culling_jobs.back();
+        job.frustum = cut_update_cam.get_frustum_by_model(math::mat4f(scm_model_matrix));
+        //auto culling_frustum = scm::gl::frustum(scm::math::mat4f(scm_model_view_projection_matrix));
 
-        std::unordered_set<lamure::node_t>& nodes_in_frustum = nodes_in_frustum_per_model[model_id];
+        job.bounding_boxes = &bvh->get_bounding_boxes();
+        job.cut = &node_list;
 
         auto global_clipping_planes = scene.clipping_planes;
         unsigned num_global_clipping_planes = global_clipping_planes.size();
@@ -298,16 +306,16 @@ void MLodRenderer::render(gua::Pipeline& pipe, PipelinePassDescription const& de
             global_clipping_planes[plane_idx] = scm::math::vec4d(xyz_comp, -d);
         }
 
-        for(auto const& n : node_list)
-        {
-            if(culling_frustum.classify(model_bounding_boxes[n.node_id_]) != 1)
-            {
-                if(num_global_clipping_planes == 0 || _intersects(model_bounding_boxes[n.node_id_], global_clipping_planes))
-                {
-                    nodes_in_frustum.insert(n.node_id_);
-                }
-            }
-        }
+        job.clipping_planes = global_clipping_planes;
+    }
+
+    // perform frustum culling of all models in parallel
+    LodBvhQuery::classify_cuts(culling_jobs);
+
+    for(std::size_t job_idx = 0; job_idx < culling_jobs.size(); ++job_idx)
+    {
+        auto const& visible_nodes = culling_jobs[job_idx].visible_nodes;
+        nodes_in_frustum_per_model[culling_job_model_ids[job_idx]].insert(visible_nodes.begin(), visible_nodes.end());
     }
 
 #ifdef GUACAMOLE_ENABLE_PIPELINE_PASS_TIME_QUERIES
@@ -446,32 +454,6 @@ void MLodRenderer::render(gua::Pipeline& pipe, PipelinePassDescription const& de
     }
 }
 
-/////////////////////////////////////////////////////////////////////////////////////////////
-bool MLodRenderer::_intersects(scm::gl::boxf const& bbox, std::vector<math::vec4> const& global_planes) const
-{
-    auto outside = [](math::vec4 const& plane, scm::math::vec3f const& point) { return (plane[0] * point[0] + plane[1] * point[1] + plane[2] * point[2] + plane[3]) < 0; };
-
-    for(auto const& plane : global_planes)
-    {
-        auto bbox_max(bbox.max_vertex());
-        auto p(bbox.min_vertex());
-        if(plane[0] >= 0)
-            p[0] = bbox_max[0];
-        if(plane[1] >= 0)
-            p[1] = bbox_max[1];
-        if(plane[2] >= 0)
-            p[2] = bbox_max[2];
-
-        // is the positive vertex outside?
-        if(outside(plane, p))
-        {
-            return false;
-        }
-    }
-
-    return true;
-}
-
 /////////////////////////////////////////////////////////////////////////////////////////////
 std::vector<math::vec3> MLodRenderer::_get_frustum_corners_vs(gua::Frustum const& frustum) const
 {
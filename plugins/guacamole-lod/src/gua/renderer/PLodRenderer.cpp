@@ -38,6 +38,7 @@
 #include <gua/renderer/ResourceFactory.hpp>
 
 #include <gua/node/PLodNode.hpp>
+#include <gua/renderer/LodBvhQuery.hpp>
 #include <gua/platform.hpp>
 #include <gua/guacamole.hpp>
 #include <gua/renderer/View.hpp>
@@ -63,31 +64,6 @@
 
 namespace gua
 {
-bool PLodRenderer::_intersects(scm::gl::boxf const& bbox, std::vector<math::vec4> const& global_planes) const
-{
-    auto outside = [](math::vec4 const& plane, scm::math::vec3f const& point) { return (plane[0] * point[0] + plane[1] * point[1] + plane[2] * point[2] + plane[3]) < 0; };
-
-    for(auto const& plane : global_planes)
-    {
-        auto bbox_max(bbox.max_vertex());
-        auto p(bbox.min_vertex());
-        if(plane[0] >= 0)
-            p[0] = bbox_max[0];
-        if(plane[1] >= 0)
-            p[1] = bbox_max[1];
-        if(plane[2] >= 0)
-            p[2] = bbox_max[2];
-
-        // is the positive vertex outside?
-        if(outside(plane, p))
-        {
-            return false;
-        }
-    }
-
-    return true;
-}
-
 std::vector<math::vec3> PLodRenderer::_get_frustum_corners_vs(gua::Frustum const& frustum) const
 {
     std::vector<math::vec4> tmp(8);
@@ -190,7 +166,7 @@ lamure::context_t PLodRenderer::_register_context_in_cut_update(gua::RenderConte
 /////////////////////////////////////////////////////////////////////////////////////////////
 void PLodRenderer::perform_frustum_culling_for_scene(std::vector<node::Node*>& models,
                                                      std::unordered_map<node::PLodNode*, std::unordered_set<lamure::node_t>>& culling_results_per_model,
-                                                     std::unordered_map<node::PLodNode*, lamure::ren::cut*> cut_map,
+                                                     std::unordered_map<node::PLodNode*, lamure::ren::cut*> const& cut_map,
                                                      lamure::ren::camera const& cut_update_cam,
                                                      gua::Pipeline& pipe) const
 {
@@ -200,22 +176,23 @@ void PLodRenderer::perform_frustum_culling_for_scene(std::vector<node::Node*>& m
 
     auto& scene = *pipe.current_viewstate().scene;
 
-    // loop through all models and perform frustum culling
-    for(auto const& object : models)
+    // collect the inputs of all models, lamure's databases are only accessed from this thread
+    std::vector<LodBvhQuery::CutCullingJob> culling_jobs(models.size());
+
+    for(std::size_t model_idx = 0; model_idx < models.size(); ++model_idx)
     {
-        auto plod_node(reinterpret_cast<node::PLodNode*>(object));
+        auto plod_node(reinterpret_cast<node::PLodNode*>(models[model_idx]));
 
         lamure::model_t model_id = controller->deduce_model_id(plod_node->get_geometry_description());
 
         auto const& scm_model_matrix = plod_node->get_cached_world_transform();
 
-        // perform frustum culling
         lamure::ren::bvh const* bvh = database->get_model(model_id)->get_bvh();
-        scm::gl::frustum const& culling_frustum = cut_update_cam.get_frustum_by_model(math::mat4f(scm_model_matrix));
-
-        std::vector<scm::gl::boxf> const& model_bounding_boxes = bvh->get_bounding_boxes();
 
-        std::unordered_set<lamure::node_t>& nodes_in_frustum = culling_results_per_model[plod_node];
+        LodBvhQuery::CutCullingJob& job = culling_jobs[model_idx];
+        job.frustum = cut_update_cam.get_frustum_by_model(math::mat4f(scm_model_matrix));
+        job.bounding_boxes = &bvh->get_bounding_boxes();
+        job.cut = &cut_map.at(plod_node)->complete_set();
 
         auto global_clipping_planes = scene.clipping_planes;
         unsigned num_global_clipping_planes = global_clipping_planes.size();
@@ -240,18 +217,16 @@ void PLodRenderer::perform_frustum_culling_for_scene(std::vector<node::Node*>& m
             global_clipping_planes[plane_idx] = scm::math::vec4d(xyz_comp, -d);
         }
 
-        auto const& node_list = cut_map.at(plod_node)->complete_set();
+        job.clipping_planes = global_clipping_planes;
+    }
 
-        for(auto const& n : node_list)
-        {
-            if(culling_frustum.classify(model_bounding_boxes[n.node_id_]) != 1)
-            {
-                if(num_global_clipping_planes == 0 || _intersects(model_bounding_boxes[n.node_id_], global_clipping_planes))
-                {
-                    nodes_in_frustum.insert(n.node_id_);
-                }
-            }
-        }
+    // perform frustum culling of all models in parallel
+    LodBvhQuery::classify_cuts(culling_jobs);
+
+    for(std::size_t model_idx = 0; model_idx < models.size(); ++model_idx)
+    {
+        auto const& visible_nodes = culling_jobs[model_idx].visible_nodes;
+        culling_results_per_model[reinterpret_cast<node::PLodNode*>(models[model_idx])].insert(visible_nodes.begin(), visible_nodes.end());
     }
 }
 
@@ -86,6 +86,9 @@ class GUA_NURBS_DLL NURBSResource : public GeometryResource
                   // scm::gl::fill_mode in_fill_mode = scm::gl::FILL_WIREFRAME
     );
 
+    // from data serialized already, e.g. read from a cache
+    NURBSResource(std::shared_ptr<NURBSData> const& data, scm::gl::fill_mode in_fill_mode = scm::gl::FILL_SOLID);
+
   public: // methods
     /*virtual*/ void predraw(RenderContext const& context) const;
 
@@ -27,6 +27,10 @@
 
 #include <scm/gl_core.h>
 #include <gua/math/BoundingBox.hpp>
+#include <gua/math/math.hpp>
+
+#include <string>
+#include <vector>
 
 namespace gua
 {
@@ -52,17 +56,44 @@ struct NURBSData
         float curvature;
     };
 
+    // increase whenever the serialized arrays or per_patch_data change
+    static const uint32_t CACHE_VERSION = 1;
+
   public:
     // Constructor and Destructor
     NURBSData(std::shared_ptr<gpucast::beziersurfaceobject> const& o, unsigned pre_subdivision_u, unsigned pre_subdivision_v, unsigned trim_texture);
 
+    // empty, to be filled by load()
+    NURBSData();
+
+    /**
+     * Writes all serialized arrays to a binary cache. The source key has to
+     * identify the data and the settings it has been derived from.
+     */
+    bool save(std::string const& file_name, uint64_t source_key) const;
+
+    // reads arrays written by save() for the same source key, the object stays empty
+    bool load(std::string const& file_name, uint64_t source_key);
+
+    // nullptr if the data has been loaded from a cache
     std::shared_ptr<gpucast::beziersurfaceobject> object;
 
+    math::BoundingBox<math::vec3> bbox;
+
     // adaptive_tesselation data
     std::vector<scm::math::vec4f> tess_patch_data;      // Domain Points
     std::vector<unsigned> tess_index_data;              // Index Data
     std::vector<scm::math::vec4f> tess_parametric_data; // Control Points of all the surfaces
     std::vector<per_patch_data> tess_attribute_data;
+    std::vector<scm::math::vec4f> tess_obb_data;
+
+    // contour kd trimming data
+    std::vector<scm::math::vec4f> trim_partition;
+    std::vector<scm::math::vec4f> trim_contourlist;
+    std::vector<scm::math::vec4f> trim_curvelist;
+    std::vector<float> trim_curvedata;
+    std::vector<scm::math::vec3f> trim_pointdata;
+    std::vector<unsigned char> trim_preclassification;
 };
 
 } // namespace gua
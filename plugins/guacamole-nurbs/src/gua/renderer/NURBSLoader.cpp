@@ -28,13 +28,77 @@
 #include <gua/node/NURBSNode.hpp>
 #include <gua/databases/GeometryDatabase.hpp>
 #include <gua/renderer/NURBSResource.hpp>
+#include <gua/renderer/detail/NURBSData.hpp>
+#include <gua/utils/BinaryCacheFile.hpp>
 
 #include <gpucast/core/import/igs.hpp>
 #include <gpucast/core/surface_converter.hpp>
 #include <gpucast/core/nurbssurfaceobject.hpp>
 
+// external headers
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
 namespace gua
 {
+namespace
+{
+// converts all objects of an IGES file to bezier surfaces with one converter per worker thread
+template <typename NURBSObjects>
+std::shared_ptr<gpucast::beziersurfaceobject> convert_to_bezier(NURBSObjects const& nurbsobjects)
+{
+    std::vector<std::shared_ptr<gpucast::beziersurfaceobject>> converted(nurbsobjects.size());
+    std::vector<std::exception_ptr> errors(nurbsobjects.size());
+    std::atomic<std::size_t> next_object(0);
+
+    auto convert = [&]() {
+        gpucast::surface_converter surface_converter;
+        for(std::size_t i = next_object++; i < nurbsobjects.size(); i = next_object++)
+        {
+            try
+            {
+                auto object = std::make_shared<gpucast::beziersurfaceobject>();
+                surface_converter.convert(nurbsobjects[i], object);
+                converted[i] = object;
+            }
+            catch(...)
+            {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+
+    std::size_t const num_threads = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), nurbsobjects.size());
+
+    std::vector<std::thread> workers;
+    for(std::size_t t = 1; t < num_threads; ++t)
+    {
+        workers.emplace_back(convert);
+    }
+    convert();
+
+    for(auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    // merge in file order, so surface and trim ids don't depend on scheduling
+    auto bezier_object = std::make_shared<gpucast::beziersurfaceobject>();
+    for(std::size_t i = 0; i != converted.size(); ++i)
+    {
+        if(errors[i])
+        {
+            std::rethrow_exception(errors[i]);
+        }
+        bezier_object->merge(*converted[i]);
+    }
+
+    return bezier_object;
+}
+} // namespace
+
 ////////////////////////////////////////////////////////////////////////////////
 NURBSLoader::NURBSLoader() : _supported_file_extensions()
 {
@@ -78,26 +142,12 @@ std::shared_ptr<node::NURBSNode> NURBSLoader::load_geometry(std::string const& f
         }
         else
         {
-            // import model
-            gpucast::igs_loader igsloader;
-            gpucast::surface_converter surface_converter;
-
-            auto bezier_object = std::make_shared<gpucast::beziersurfaceobject>();
-            auto nurbsobjects = igsloader.load(filename);
-
-            for(auto nurbsobject : nurbsobjects)
-            {
-                auto object = std::make_shared<gpucast::beziersurfaceobject>();
-                surface_converter.convert(nurbsobject, object);
-                bezier_object->merge(*object);
-            }
-
             // check and set rendering mode and create render resources
             auto fill_mode = flags & WIREFRAME ? scm::gl::FILL_WIREFRAME : scm::gl::FILL_SOLID;
-            auto pre_subdivision_u = flags & PRE_SUBDIVISION ? 1 : 0;
-            auto pre_subdivision_v = flags & PRE_SUBDIVISION ? 1 : 0;
+            unsigned pre_subdivision_u = flags & PRE_SUBDIVISION ? 1 : 0;
+            unsigned pre_subdivision_v = flags & PRE_SUBDIVISION ? 1 : 0;
 
-            auto trim_resolution = 0;
+            unsigned trim_resolution = 0;
 
             if(flags & TRIM_TEXTURE_8)
                 trim_resolution = 8;
@@ -106,8 +156,35 @@ std::shared_ptr<node::NURBSNode> NURBSLoader::load_geometry(std::string const& f
             if(flags & TRIM_TEXTURE_32)
                 trim_resolution = 32;
 
-            auto ressource = std::make_shared<NURBSResource>(bezier_object, pre_subdivision_u, pre_subdivision_v, trim_resolution, fill_mode);
-            Logger::LOG_WARNING << "NURBS Object loaded with " << bezier_object->surfaces() << " surfaces.\n";
+            // the serialized data is cached next to the model, keyed by the file contents and the settings it depends on
+            uint64_t const file_hash = BinaryCacheFile::hash_file(filename);
+            unsigned const settings[] = {pre_subdivision_u, pre_subdivision_v, trim_resolution};
+            uint64_t const cache_key = file_hash == 0 ? 0 : BinaryCacheFile::hash_data(settings, sizeof(settings), file_hash);
+            std::string const cache_file = filename + ".gua_nurbs";
+
+            std::shared_ptr<NURBSResource> ressource;
+
+            auto cached_data = std::make_shared<NURBSData>();
+            if(cache_key != 0 && cached_data->load(cache_file, cache_key))
+            {
+                ressource = std::make_shared<NURBSResource>(cached_data, fill_mode);
+                Logger::LOG_DEBUG << "NURBS Object loaded from cache " << cache_file << " with " << cached_data->tess_attribute_data.size() << " patches.\n";
+            }
+            else
+            {
+                // import model
+                gpucast::igs_loader igsloader;
+                auto bezier_object = convert_to_bezier(igsloader.load(filename));
+
+                auto data = std::make_shared<NURBSData>(bezier_object, pre_subdivision_u, pre_subdivision_v, trim_resolution);
+                if(cache_key != 0 && !data->save(cache_file, cache_key))
+                {
+                    Logger::LOG_DEBUG << "Unable to write NURBS cache " << cache_file << std::endl;
+                }
+
+                ressource = std::make_shared<NURBSResource>(data, fill_mode);
+                Logger::LOG_WARNING << "NURBS Object loaded with " << bezier_object->surfaces() << " surfaces.\n";
+            }
 
             // add resource to database
             GeometryDescription desc("NURBS", filename, 0, flags);
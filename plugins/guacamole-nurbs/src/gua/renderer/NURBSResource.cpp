@@ -45,12 +45,13 @@ namespace gua
 ////////////////////////////////////////////////////////////////////////////////
 NURBSResource::NURBSResource(
     std::shared_ptr<gpucast::beziersurfaceobject> const& object, unsigned pre_subdivision_u, unsigned pre_subdivision_v, unsigned trim_resolution, scm::gl::fill_mode in_fill_mode)
-    : _data(std::make_shared<NURBSData>(object, pre_subdivision_u, pre_subdivision_v, trim_resolution)), _fill_mode(in_fill_mode)
+    : NURBSResource(std::make_shared<NURBSData>(object, pre_subdivision_u, pre_subdivision_v, trim_resolution), in_fill_mode)
 {
-    bounding_box_ =
-        math::BoundingBox<math::vec3>(math::vec3(object->bbox().min[0], object->bbox().min[1], object->bbox().min[2]), math::vec3(object->bbox().max[0], object->bbox().max[1], object->bbox().max[2]));
 }
 
+////////////////////////////////////////////////////////////////////////////////
+NURBSResource::NURBSResource(std::shared_ptr<NURBSData> const& data, scm::gl::fill_mode in_fill_mode) : _data(data), _fill_mode(in_fill_mode) { bounding_box_ = _data->bbox; }
+
 ////////////////////////////////////////////////////////////////////////////////
 void NURBSResource::predraw(RenderContext const& context) const
 {
@@ -244,33 +245,25 @@ void NURBSResource::initialize_texture_buffers(RenderContext const& context) con
     resource->_surface_tesselation_data.parametric_texture_buffer =
         in_device->create_texture_buffer(scm::gl::FORMAT_RGBA_32F, scm::gl::USAGE_STATIC_DRAW, size_in_bytes(_data->tess_parametric_data), &_data->tess_parametric_data[0]);
 
-    resource->_surface_tesselation_data.obb_texture_buffer = in_device->create_texture_buffer(
-        scm::gl::FORMAT_RGBA_32F, scm::gl::USAGE_STATIC_DRAW, size_in_bytes(_data->object->serialized_tesselation_obbs()), &_data->object->serialized_tesselation_obbs()[0]);
+    resource->_surface_tesselation_data.obb_texture_buffer =
+        in_device->create_texture_buffer(scm::gl::FORMAT_RGBA_32F, scm::gl::USAGE_STATIC_DRAW, size_in_bytes(_data->tess_obb_data), &_data->tess_obb_data[0]);
 
     resource->_surface_tesselation_data.attribute_texture_buffer =
         in_device->create_texture_buffer(scm::gl::FORMAT_RGBA_32F, scm::gl::USAGE_STATIC_DRAW, size_in_bytes(_data->tess_attribute_data), &_data->tess_attribute_data[0]);
 
     // trimming data
-    auto const& trimdata = _data->object->serialized_trimdata_as_contour_kd();
     resource->_contour_trimming_data.partition_texture_buffer =
-        in_device->create_texture_buffer(scm::gl::FORMAT_RGBA_32F, scm::gl::USAGE_STATIC_DRAW, size_in_bytes(trimdata->partition), &trimdata->partition[0]);
-    ;
+        in_device->create_texture_buffer(scm::gl::FORMAT_RGBA_32F, scm::gl::USAGE_STATIC_DRAW, size_in_bytes(_data->trim_partition), &_data->trim_partition[0]);
     resource->_contour_trimming_data.contourlist_texture_buffer =
-        in_device->create_texture_buffer(scm::gl::FORMAT_RGBA_32F, scm::gl::USAGE_STATIC_DRAW, size_in_bytes(trimdata->contourlist), &trimdata->contourlist[0]);
-    ;
+        in_device->create_texture_buffer(scm::gl::FORMAT_RGBA_32F, scm::gl::USAGE_STATIC_DRAW, size_in_bytes(_data->trim_contourlist), &_data->trim_contourlist[0]);
     resource->_contour_trimming_data.curvelist_texture_buffer =
-        in_device->create_texture_buffer(scm::gl::FORMAT_RGBA_32F, scm::gl::USAGE_STATIC_DRAW, size_in_bytes(trimdata->curvelist), &trimdata->curvelist[0]);
-    ;
+        in_device->create_texture_buffer(scm::gl::FORMAT_RGBA_32F, scm::gl::USAGE_STATIC_DRAW, size_in_bytes(_data->trim_curvelist), &_data->trim_curvelist[0]);
     resource->_contour_trimming_data.curvedata_texture_buffer =
-        in_device->create_texture_buffer(scm::gl::FORMAT_R_32F, scm::gl::USAGE_STATIC_DRAW, size_in_bytes(trimdata->curvedata), &trimdata->curvedata[0]);
-    ;
+        in_device->create_texture_buffer(scm::gl::FORMAT_R_32F, scm::gl::USAGE_STATIC_DRAW, size_in_bytes(_data->trim_curvedata), &_data->trim_curvedata[0]);
     resource->_contour_trimming_data.pointdata_texture_buffer =
-        in_device->create_texture_buffer(scm::gl::FORMAT_RGB_32F, scm::gl::USAGE_STATIC_DRAW, size_in_bytes(trimdata->pointdata), &trimdata->pointdata[0]);
-    ;
-
+        in_device->create_texture_buffer(scm::gl::FORMAT_RGB_32F, scm::gl::USAGE_STATIC_DRAW, size_in_bytes(_data->trim_pointdata), &_data->trim_pointdata[0]);
     resource->_contour_trimming_data.preclassification_buffer =
-        in_device->create_texture_buffer(scm::gl::FORMAT_R_8UI, scm::gl::USAGE_STATIC_DRAW, size_in_bytes(trimdata->preclassification), &trimdata->preclassification[0]);
-    ;
+        in_device->create_texture_buffer(scm::gl::FORMAT_R_8UI, scm::gl::USAGE_STATIC_DRAW, size_in_bytes(_data->trim_preclassification), &_data->trim_preclassification[0]);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -280,6 +273,20 @@ void NURBSResource::validate_texture_buffers() const
         _data->tess_parametric_data.resize(1);
     if(_data->tess_attribute_data.empty())
         _data->tess_attribute_data.resize(1);
+    if(_data->tess_obb_data.empty())
+        _data->tess_obb_data.resize(1);
+    if(_data->trim_partition.empty())
+        _data->trim_partition.resize(1);
+    if(_data->trim_contourlist.empty())
+        _data->trim_contourlist.resize(1);
+    if(_data->trim_curvelist.empty())
+        _data->trim_curvelist.resize(1);
+    if(_data->trim_curvedata.empty())
+        _data->trim_curvedata.resize(1);
+    if(_data->trim_pointdata.empty())
+        _data->trim_pointdata.resize(1);
+    if(_data->trim_preclassification.empty())
+        _data->trim_preclassification.resize(1);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -21,15 +21,38 @@
 #include <gua/renderer/detail/NURBSData.hpp>
 
 // guacamole headers
+#include <gua/utils/BinaryCacheFile.hpp>
 #include <gpucast/core/trimdomain_serializer_contour_map_kd.hpp>
 
 // external headers
 #include <algorithm>
+#include <cstring>
 #include <iterator>
 #include <limits>
 
 namespace gua
 {
+namespace
+{
+// copies an array serialized by gpucast, T has the layout of the texture buffer format it is uploaded with
+template <typename T, typename Container>
+std::vector<T> copy_serialized(Container const& container)
+{
+    std::vector<T> copy(container.size() * sizeof(typename Container::value_type) / sizeof(T));
+    if(!copy.empty())
+    {
+        std::memcpy(copy.data(), &container[0], copy.size() * sizeof(T));
+    }
+    return copy;
+}
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+NURBSData::NURBSData() : object(), bbox(), tess_patch_data(), tess_index_data(), tess_parametric_data(), tess_attribute_data() {}
+
+////////////////////////////////////////////////////////////////////////////////
+
 NURBSData::NURBSData(std::shared_ptr<gpucast::beziersurfaceobject> const& o, unsigned pre_subdivision_u, unsigned pre_subdivision_v, unsigned trim_texture)
     : object(o), tess_patch_data(), tess_index_data(), tess_parametric_data(), tess_attribute_data()
 {
@@ -122,6 +145,62 @@ NURBSData::NURBSData(std::shared_ptr<gpucast::beziersurfaceobject> const& o, uns
         };
         std::transform((*it)->points().begin(), (*it)->points().end(), tess_parametric_data.begin() + current_size, serialize_homogenous_points);
     }
+
+    // keep everything which is uploaded, so the data can be cached without the object
+    bbox = math::BoundingBox<math::vec3>(math::vec3(object->bbox().min[0], object->bbox().min[1], object->bbox().min[2]), math::vec3(object->bbox().max[0], object->bbox().max[1], object->bbox().max[2]));
+    tess_obb_data = copy_serialized<scm::math::vec4f>(object->serialized_tesselation_obbs());
+
+    auto const& trimdata = object->serialized_trimdata_as_contour_kd();
+    trim_partition = copy_serialized<scm::math::vec4f>(trimdata->partition);
+    trim_contourlist = copy_serialized<scm::math::vec4f>(trimdata->contourlist);
+    trim_curvelist = copy_serialized<scm::math::vec4f>(trimdata->curvelist);
+    trim_curvedata = copy_serialized<float>(trimdata->curvedata);
+    trim_pointdata = copy_serialized<scm::math::vec3f>(trimdata->pointdata);
+    trim_preclassification = copy_serialized<unsigned char>(trimdata->preclassification);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool NURBSData::save(std::string const& file_name, uint64_t source_key) const
+{
+    BinaryCacheFile cache(CACHE_VERSION, source_key);
+
+    cache.set("bbox", std::vector<math::vec3>{bbox.min, bbox.max});
+    cache.set("tess_patch_data", tess_patch_data);
+    cache.set("tess_index_data", tess_index_data);
+    cache.set("tess_parametric_data", tess_parametric_data);
+    cache.set("tess_attribute_data", tess_attribute_data);
+    cache.set("tess_obb_data", tess_obb_data);
+    cache.set("trim_partition", trim_partition);
+    cache.set("trim_contourlist", trim_contourlist);
+    cache.set("trim_curvelist", trim_curvelist);
+    cache.set("trim_curvedata", trim_curvedata);
+    cache.set("trim_pointdata", trim_pointdata);
+    cache.set("trim_preclassification", trim_preclassification);
+
+    return cache.save(file_name);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool NURBSData::load(std::string const& file_name, uint64_t source_key)
+{
+    BinaryCacheFile cache(CACHE_VERSION, source_key);
+    std::vector<math::vec3> bbox_corners;
+
+    bool const loaded = cache.load(file_name) && cache.get("bbox", bbox_corners) && bbox_corners.size() == 2 && cache.get("tess_patch_data", tess_patch_data) &&
+                        cache.get("tess_index_data", tess_index_data) && cache.get("tess_parametric_data", tess_parametric_data) &&
+                        cache.get("tess_attribute_data", tess_attribute_data) && cache.get("tess_obb_data", tess_obb_data) && cache.get("trim_partition", trim_partition) &&
+                        cache.get("trim_contourlist", trim_contourlist) && cache.get("trim_curvelist", trim_curvelist) && cache.get("trim_curvedata", trim_curvedata) &&
+                        cache.get("trim_pointdata", trim_pointdata) && cache.get("trim_preclassification", trim_preclassification);
+
+    if(loaded)
+    {
+        object = nullptr;
+        bbox = math::BoundingBox<math::vec3>(bbox_corners[0], bbox_corners[1]);
+    }
+
+    return loaded;
 }
 
 } // namespace gua
@@ -146,6 +146,9 @@ class PLODRenderer
 
     SubstitutionMap global_substitution_map_;
     ResourceFactory factory_;
+
+    // render targets and cache budget, untracked with the renderer
+    GpuMemoryAllocations memory_allocations_;
 };
 
 } // namespace gua
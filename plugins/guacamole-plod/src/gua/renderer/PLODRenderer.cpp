@@ -235,6 +235,9 @@ void PLODRenderer::_create_gpu_resources(gua::RenderContext const& ctx, scm::mat
 
     accumulation_pass_weight_and_depth_result_ = ctx.render_device->create_texture_2d(render_target_dims, scm::gl::FORMAT_RG_32F, 1, 1, 1);
 
+    // linear depth, three RGB_16F and one RG_32F target
+    memory_allocations_.track(ctx.memory, GpuMemoryRegistry::id_of(this), GpuMemoryRegistry::Category::PLUGIN, std::size_t(render_target_dims.x) * render_target_dims.y * (4 + 3 * 6 + 8), "PLOD render targets");
+
     log_to_lin_gua_depth_conversion_pass_fbo_ = ctx.render_device->create_frame_buffer();
     /*log_to_lin_gua_depth_conversion_pass_fbo_->attach_color_buffer(0,
                                                                    depth_pass_linear_depth_result_);*/
@@ -282,6 +285,11 @@ pbr::context_t PLODRenderer::_register_context_in_cut_update(gua::RenderContext
     if(previous_frame_count_ != ctx.framecount)
     {
         controller->ResetSystem();
+
+        // the cache is allocated by pbr, only its budget is known; the
+        // other renderers of the context track it again in their next frame
+        pbr::ren::Policy* policy = pbr::ren::Policy::GetInstance();
+        memory_allocations_.track(ctx.memory, GpuMemoryRegistry::id_of(policy), GpuMemoryRegistry::Category::PLUGIN, std::size_t(policy->render_budget_in_mb()) * 1024 * 1024, "PLOD render budget");
     }
     return controller->DeduceContextId(ctx.id);
 }
@@ -26,12 +26,19 @@
 #include <gua/node/GeometryNode.hpp>
 #include <gua/skelanim/utils/SkeletalAnimation.hpp>
 #include <gua/skelanim/utils/Skeleton.hpp>
+#include <gua/skelanim/utils/SkeletalAnimationUpdater.hpp>
+#include <gua/skelanim/utils/BlendTree.hpp>
 #include <gua/platform.hpp>
 
+// external headers
+#include <map>
+#include <memory>
+
 namespace gua
 {
 class SkinnedMeshResource;
 class SkeletalAnimation;
+class CompiledAnimation;
 struct Bone;
 
 namespace node
@@ -108,13 +115,25 @@ class GUA_SKELANIM_DLL SkeletalAnimationNode : public GeometryNode
      */
     void update_bounding_box() const override;
 
-    std::vector<math::BoundingBox<math::vec3>> get_bone_boxes();
+    /**
+     * @brief world space boxes of the bones
+     * @details the returned storage is reused, it is valid until the
+     * next call
+     */
+    std::vector<math::BoundingBox<math::vec3>> const& get_bone_boxes();
 
     void update_cache() override;
 
+    std::size_t get_geometry_revision() const override;
+
     std::vector<std::shared_ptr<SkinnedMeshResource>> const& get_geometries() const;
 
     // animation related methods
+
+    /**
+     * @brief adds the clips of the given file to this node
+     * @details clips are loaded once and shared via the SkeletalAnimationDatabase
+     */
     void add_animations(std::string const& file_name, std::string const& animation_name);
 
     std::string const& get_animation_1() const;
@@ -135,18 +154,55 @@ class GUA_SKELANIM_DLL SkeletalAnimationNode : public GeometryNode
 
     bool has_anims() const;
 
+    /**
+     * @brief returns the clip compiled for this node's skeleton
+     * @details used to build blend trees
+     * @return compiled clip or nullptr if no clip with the name was added
+     */
+    std::shared_ptr<CompiledAnimation const> get_compiled_animation(std::string const& animation_name) const;
+
+    /**
+     * @brief evaluates the given tree instead of the two animations
+     * @details the tree is copied, set it again after changing times or
+     * weights. The copy reuses the storage of earlier trees which are no
+     * longer in use. Its clips have to be compiled for this node's skeleton, so
+     * the tree has to be rebuilt after set_bones()
+     */
+    void set_blend_tree(BlendTree const& tree);
+    /**
+     * @brief returns to playing animation 1 and 2
+     */
+    void clear_blend_tree();
+
+    bool has_blend_tree() const;
+    /**
+     * @brief returns the current tree
+     * @details only valid if has_blend_tree() is true
+     */
+    BlendTree const& get_blend_tree() const;
+
     /**
      * @brief returns current bone transformations
-     * @details does not trigger an update of the transforms
+     * @details does not trigger an update of the transforms, waits for the
+     * palette submitted by the last update_cache() if it is not finished yet
      * @return current bone transforms
      */
     std::vector<scm::math::mat4f> const& get_bone_transforms() const;
 
     /**
      * @brief recalculates the bone transformations with the current parameters
+     * @details evaluates on the calling thread, update_cache() evaluates
+     * changed animations on the SkeletalAnimationUpdater instead
      */
     void update_bone_transforms();
 
+    /**
+     * @brief returns the palette submitted by the last update_cache()
+     * @details waits until it is finished
+     * @return palette or nullptr if none has been submitted
+     */
+    std::shared_ptr<SkeletalAnimationUpdater::Palette const> get_palette() const;
+
     /**
      * Accepts a visitor and calls concrete visit method.
      *
@@ -159,6 +215,30 @@ class GUA_SKELANIM_DLL SkeletalAnimationNode : public GeometryNode
   protected:
     std::shared_ptr<Node> copy() const override;
 
+  private:
+    // clips are immutable and owned by the SkeletalAnimationDatabase, copies
+    // of this node only share the map
+    struct Clip
+    {
+        std::shared_ptr<SkeletalAnimation const> animation;
+        // animation resolved against skeleton_
+        std::shared_ptr<CompiledAnimation const> compiled;
+    };
+
+    using AnimationMap = std::map<std::string, Clip>;
+
+    Clip const* find_animation(std::string const& animation_name) const;
+
+    // has to be called whenever the skeleton changes
+    void compile_animations();
+
+    // queues evaluation of the current playback state
+    void submit_palette();
+
+    void set_animation_dirty();
+
+    static void evaluate(Skeleton const& skeleton, BlendTree const* tree, Clip const* anim_1, Clip const* anim_2, float blend_factor, float time_1, float time_2, std::vector<scm::math::mat4f>& transforms);
+
   private: // attributes e.g. special attributes for drawing
     std::vector<std::shared_ptr<SkinnedMeshResource>> geometries_;
     std::vector<std::string> geometry_descriptions_;
@@ -170,10 +250,22 @@ class GUA_SKELANIM_DLL SkeletalAnimationNode : public GeometryNode
 
     // attributes related to animation
     Skeleton skeleton_;
-    std::map<std::string, SkeletalAnimation> animations_;
+    std::shared_ptr<AnimationMap const> animations_;
 
     bool new_bones_;
     bool has_anims_;
+    bool animation_dirty_;
+
+    // skeleton as seen by pending palette jobs
+    std::shared_ptr<Skeleton const> skeleton_snapshot_;
+    SkeletalAnimationUpdater::Handle palette_;
+    // last finished palette, used for the bounding box
+    mutable std::shared_ptr<SkeletalAnimationUpdater::Palette const> bounds_palette_;
+    // double buffer for submit_palette(), a palette is only refilled once
+    // frame copies and the renderer have let go of it
+    std::shared_ptr<SkeletalAnimationUpdater::Palette> palette_buffers_[2];
+    unsigned back_palette_ = 0;
+    std::vector<math::BoundingBox<math::vec3>> bone_boxes_;
 
     const static std::string none_loaded;
 
@@ -183,7 +275,16 @@ class GUA_SKELANIM_DLL SkeletalAnimationNode : public GeometryNode
     float anim_time_1_;
     float anim_time_2_;
 
+    // replaces the two animations above when set, shared with pending jobs
+    // and frame copies; the spare is the previous tree, reused by
+    // set_blend_tree() once nothing refers to it anymore
+    std::shared_ptr<BlendTree> blend_tree_;
+    std::shared_ptr<BlendTree> spare_blend_tree_;
+
     std::vector<scm::math::mat4f> bone_transforms_;
+
+    // incremented with every new pose, see get_geometry_revision()
+    std::size_t pose_revision_ = 0;
 };
 
 } // namespace node
@@ -26,7 +26,7 @@
 #include <gua/skelanim/platform.hpp>
 #include <gua/skelanim/utils/SkinnedMesh.hpp>
 #include <gua/renderer/GeometryResource.hpp>
-// #include <gua/utils/KDTree.hpp>
+#include <gua/utils/KDTree.hpp>
 
 // external headers
 #include <scm/gl_core.h>
@@ -62,7 +62,7 @@ class GUA_SKELANIM_DLL SkinnedMeshResource : public GeometryResource
      * Initializes the mesh from a given skinned mesh.
      *
      * @param mesh mesh to store in this resource.
-     * @param build_kd_tree whether to build the kd tree (not supported).
+     * @param build_kd_tree whether to build the per-bone kd trees for picking.
      */
     SkinnedMeshResource(SkinnedMesh const& mesh, bool build_kd_tree);
 
@@ -75,7 +75,26 @@ class GUA_SKELANIM_DLL SkinnedMeshResource : public GeometryResource
      */
     void draw(RenderContext& context) /*const*/;
 
-    void ray_test(Ray const& ray, int options, node::Node* owner, std::set<PickResult>& hits);
+    /**
+     * @brief intersects the mesh in bind pose
+     */
+    void ray_test(Ray const& ray, int options, node::Node* owner, std::set<PickResult>& hits) override;
+
+    /**
+     * @brief intersects the animated mesh
+     * @details each triangle is assumed to move rigidly with the bone of
+     * its largest weight. Instead of skinning the mesh, the ray is moved
+     * into the bind pose space of every bone whose animated box it hits
+     * and tested against that bone's kd tree.
+     *
+     * @param ray ray in object space
+     * @param options picking options
+     * @param owner node to report in the results
+     * @param hits set to add results to
+     * @param bone_transforms current bone transforms, missing bones
+     * are treated as in bind pose
+     */
+    void ray_test(Ray const& ray, int options, node::Node* owner, std::set<PickResult>& hits, std::vector<scm::math::mat4f> const& bone_transforms);
 
     unsigned int num_vertices() const;
     unsigned int num_faces() const;
@@ -91,7 +110,17 @@ class GUA_SKELANIM_DLL SkinnedMeshResource : public GeometryResource
      * @param bone_transforms transform to apply
      * @return bounding boxes
      */
-    std::vector<math::BoundingBox<math::vec3>> get_bone_boxes(std::vector<scm::math::mat4f> const& bone_transforms);
+    std::vector<math::BoundingBox<math::vec3>> get_bone_boxes(std::vector<scm::math::mat4f> const& bone_transforms) const;
+
+    /**
+     * @brief expands the given boxes by the transformed bone boxes
+     * @details grows boxes if there are less boxes than bones, does not
+     * allocate otherwise
+     *
+     * @param bone_transforms transform to apply
+     * @param boxes bounding boxes to expand, indexed by bone
+     */
+    void expand_bone_boxes(std::vector<scm::math::mat4f> const& bone_transforms, std::vector<math::BoundingBox<math::vec3>>& boxes) const;
 
     friend class SkeletalAnimationRenderer;
     friend class LightingPass;
@@ -99,12 +128,24 @@ class GUA_SKELANIM_DLL SkinnedMeshResource : public GeometryResource
     void upload_to(RenderContext& ctx, SharedSkinningResource& resource);
 
   private:
+    /**
+     * @brief triangles following one bone
+     * @details positions are in bind pose
+     */
+    struct BonePart
+    {
+        unsigned bone;
+        Mesh mesh;
+        KDTree kd_tree;
+        math::BoundingBox<math::vec3> bounds;
+    };
+
     void init_bone_boxes();
+    void init_bone_parts();
 
     SkinnedMesh mesh_;
     std::vector<math::BoundingBox<math::vec3>> bone_boxes_;
-    // public:
-    //  KDTree kd_tree_;
+    std::vector<BonePart> bone_parts_;
 };
 
 } // namespace gua
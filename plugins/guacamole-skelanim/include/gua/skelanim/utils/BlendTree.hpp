@@ -0,0 +1,139 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#ifndef GUA_BLEND_TREE_HPP
+#define GUA_BLEND_TREE_HPP
+
+#include <gua/skelanim/platform.hpp>
+
+// external headers
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gua
+{
+class Skeleton;
+class CompiledAnimation;
+struct PoseBuffer;
+
+/**
+ * @brief layered animation blending
+ * @details each layer holds one or more weighted motions, e.g. the walk
+ * and run cycles of a locomotion blend space. Their weighted average is
+ * the layer pose. Layers are applied in order on top of each other,
+ * either replacing the pose below or adding to it, optionally restricted
+ * to some bones by a per-bone weight mask.
+ *
+ * Evaluation works on PoseBuffers and does not allocate once the buffers
+ * of the evaluating thread have grown to the skeleton size.
+ */
+class GUA_SKELANIM_DLL BlendTree
+{
+  public:
+    enum class Mode
+    {
+        // blends the layer over the pose of the layers below
+        OVERRIDE,
+        // adds the layer's difference to its first frame to the pose below
+        ADDITIVE
+    };
+
+    BlendTree();
+
+    /**
+     * @brief appends a layer
+     * @return index of the new layer
+     */
+    unsigned add_layer(Mode mode = Mode::OVERRIDE, float weight = 1.0f);
+
+    void set_layer_weight(unsigned layer, float weight);
+    float get_layer_weight(unsigned layer) const;
+
+    /**
+     * @brief restricts the layer to some bones
+     * @details an empty mask affects all bones
+     *
+     * @param mask weight per bone index, see make_mask()
+     */
+    void set_layer_mask(unsigned layer, std::vector<float> const& mask);
+
+    /**
+     * @brief adds an animation to the layer
+     * @return index of the motion within the layer
+     */
+    unsigned add_motion(unsigned layer, std::shared_ptr<CompiledAnimation const> const& animation, float weight = 1.0f);
+
+    void set_motion_time(unsigned layer, unsigned motion, float time_normalized);
+    void set_motion_weight(unsigned layer, unsigned motion, float weight);
+
+    std::size_t num_layers() const;
+    std::size_t num_motions(unsigned layer) const;
+
+    /**
+     * @brief evaluates all layers
+     * @details bones not animated by any layer keep their idle
+     * transformation. Unless the first layer is an unmasked override
+     * with full weight, it is blended with or added to the rest pose.
+     *
+     * @param rest_pose idle pose of the skeleton, see Skeleton::get_rest_pose()
+     * @param pose buffer to write pose to
+     */
+    void evaluate(PoseBuffer const& rest_pose, PoseBuffer& pose) const;
+
+    /**
+     * @brief creates a mask for the given bone and its descendants
+     *
+     * @param skeleton skeleton the mask is used with
+     * @param bone_name first bone of the masked subtree
+     * @param weight weight of the masked bones, all others get zero
+     * @return weight per bone index
+     */
+    static std::vector<float> make_mask(Skeleton const& skeleton, std::string const& bone_name, float weight = 1.0f);
+
+  private:
+    struct Motion
+    {
+        std::shared_ptr<CompiledAnimation const> animation;
+        // first frame of additive motions
+        std::shared_ptr<PoseBuffer const> reference;
+        float time;
+        float weight;
+    };
+
+    struct Layer
+    {
+        Mode mode;
+        float weight;
+        // shared, so copying a tree does not copy the masks
+        std::shared_ptr<std::vector<float> const> mask;
+        std::vector<Motion> motions;
+    };
+
+    bool sample_layer(Layer const& layer, PoseBuffer& pose, PoseBuffer& scratch) const;
+
+    std::vector<Layer> layers_;
+};
+
+} // namespace gua
+
+#endif // GUA_BLEND_TREE_HPP
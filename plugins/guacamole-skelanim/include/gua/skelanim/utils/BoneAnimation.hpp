@@ -76,6 +76,10 @@ class BoneAnimation
 
     std::string const& get_name() const;
 
+    std::vector<Keyframe<scm::math::vec3f>> const& get_scaling_keys() const;
+    std::vector<Keyframe<scm::math::quatf>> const& get_rotation_keys() const;
+    std::vector<Keyframe<scm::math::vec3f>> const& get_translation_keys() const;
+
   private:
     scm::math::vec3f interpolate(scm::math::vec3f val1, scm::math::vec3f val2, float factor) const;
     scm::math::quatf interpolate(scm::math::quatf val1, scm::math::quatf val2, float factor) const;
@@ -83,13 +87,14 @@ class BoneAnimation
     /**
      * @brief finds keyframe closest to given time
      * @details finds last keyframe before given time
+     * with a binary search
      *
      * @param animationTime normalized time
      * @param keys vector of keyframes to search in
      * @return index of keyframe
      */
     template <class T>
-    int find_key(float animationTime, std::vector<Keyframe<T>> keys) const;
+    int find_key(float animationTime, std::vector<Keyframe<T>> const& keys) const;
 
     /**
      * @brief returns transformation at given time
@@ -102,7 +107,7 @@ class BoneAnimation
      * @return interpolated transformation
      */
     template <class T>
-    T calculate_value(float time, std::vector<Keyframe<T>> keys) const;
+    T calculate_value(float time, std::vector<Keyframe<T>> const& keys) const;
 
     std::string name;
     std::vector<Keyframe<scm::math::vec3f>> scalingKeys;
@@ -0,0 +1,105 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#ifndef GUA_COMPILED_ANIMATION_HPP
+#define GUA_COMPILED_ANIMATION_HPP
+
+#include <gua/skelanim/platform.hpp>
+
+// external headers
+#include <array>
+#include <string>
+#include <vector>
+
+namespace gua
+{
+class Skeleton;
+class SkeletalAnimation;
+struct PoseBuffer;
+
+/**
+ * @brief animation prepared for sampling with one skeleton
+ * @details bone channels are resolved to bone indices once and
+ * the keyframes of all bones are stored as flat component arrays.
+ * Sampling writes into a PoseBuffer instead of a name-keyed SkeletalPose.
+ */
+class GUA_SKELANIM_DLL CompiledAnimation
+{
+  public:
+    /**
+     * @brief remembers the keys found by the last sample
+     * @details when sampling with increasing times the next key
+     * is found without searching
+     */
+    struct Cursor
+    {
+        std::vector<unsigned> keys;
+    };
+
+    CompiledAnimation(SkeletalAnimation const& anim, Skeleton const& skeleton);
+
+    /**
+     * @brief calculates pose at given time
+     * @details bones without animation channel are marked as not animated
+     *
+     * @param time_normalized time in [0, 1]
+     * @param pose buffer to write pose to, resized to the number of bones
+     * @param cursor optional search hint, updated with the keys found
+     */
+    void sample(float time_normalized, PoseBuffer& pose, Cursor* cursor = nullptr) const;
+
+    std::size_t num_bones() const;
+
+    double get_duration() const;
+
+    std::string const& get_name() const;
+
+  private:
+    // keyframes of one kind (scaling, rotation or translation) for all tracks
+    struct Channel
+    {
+        unsigned first_component = 0;
+        unsigned num_components = 0;
+
+        // target bone of each track
+        std::vector<unsigned> bones;
+        // index of the first key of each track, plus end of the last one
+        std::vector<unsigned> track_offsets;
+
+        std::vector<float> times;
+        std::array<std::vector<float>, 4> values;
+    };
+
+    void sample(Channel const& channel, float frame, PoseBuffer& pose, unsigned* cursor) const;
+
+    std::string name_;
+    double duration_;
+    float num_frames_;
+    std::size_t num_bones_;
+
+    // scaling, rotation and translation
+    std::array<Channel, 3> channels_;
+};
+
+} // namespace gua
+
+#endif // GUA_COMPILED_ANIMATION_HPP
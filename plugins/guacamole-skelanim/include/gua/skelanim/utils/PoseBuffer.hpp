@@ -0,0 +1,123 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#ifndef GUA_POSE_BUFFER_HPP
+#define GUA_POSE_BUFFER_HPP
+
+#include <gua/skelanim/platform.hpp>
+
+// external headers
+#include <scm/gl_core.h>
+#include <array>
+#include <vector>
+
+namespace gua
+{
+/**
+ * @brief holds transformations for all bones of a skeleton
+ * @details flat counterpart of SkeletalPose, addressed by bone index
+ * instead of bone name. Each component is stored in its own array, so
+ * blending runs as straight loops over all bones.
+ */
+struct GUA_SKELANIM_DLL PoseBuffer
+{
+    // quaternions are stored as x, y, z, w
+    enum Component
+    {
+        SCALING_X,
+        SCALING_Y,
+        SCALING_Z,
+        ROTATION_X,
+        ROTATION_Y,
+        ROTATION_Z,
+        ROTATION_W,
+        TRANSLATION_X,
+        TRANSLATION_Y,
+        TRANSLATION_Z,
+        COMPONENT_COUNT
+    };
+
+    PoseBuffer();
+    explicit PoseBuffer(std::size_t num_bones);
+
+    /**
+     * @brief resizes the buffer and resets all bones
+     * @details afterwards no bone is animated
+     *
+     * @param num_bones number of bones
+     */
+    void reset(std::size_t num_bones);
+
+    std::size_t size() const;
+
+    /**
+     * @brief sets a bone from a local transform
+     * @details decomposes the matrix into scaling, rotation and
+     * translation and marks the bone as animated
+     */
+    void set(std::size_t bone, scm::math::mat4f const& transform);
+
+    /**
+     * @brief blends with another pose
+     * @details bones only animated in the second pose are taken
+     * from there, rotations are interpolated along the shortest arc
+     *
+     * @param pose2 pose to blend with
+     * @param blend_factor weight of the second pose
+     * @param bone_weights optional per-bone factors for blend_factor,
+     * bones with a weight of zero are left untouched
+     */
+    void blend(PoseBuffer const& pose2, float blend_factor, std::vector<float> const* bone_weights = nullptr);
+
+    /**
+     * @brief turns this pose into a difference to the reference pose
+     * @details the result can be applied to other poses with add()
+     *
+     * @param reference pose to subtract, e.g. the first frame of a clip
+     */
+    void make_additive(PoseBuffer const& reference);
+
+    /**
+     * @brief applies an additive pose on top of this one
+     * @details only bones animated in both poses are changed
+     *
+     * @param additive difference pose created with make_additive()
+     * @param weight strength of the difference
+     * @param bone_weights optional per-bone factors for weight
+     */
+    void add(PoseBuffer const& additive, float weight, std::vector<float> const* bone_weights = nullptr);
+
+    /**
+     * @brief returns local transform of the given bone
+     * @details only valid for animated bones
+     */
+    scm::math::mat4f to_matrix(std::size_t bone) const;
+
+    std::array<std::vector<float>, COMPONENT_COUNT> values;
+
+    // non-zero for bones which have a transformation in this pose
+    std::vector<unsigned char> animated;
+};
+
+} // namespace gua
+
+#endif // GUA_POSE_BUFFER_HPP
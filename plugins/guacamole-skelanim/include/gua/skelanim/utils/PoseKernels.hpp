@@ -0,0 +1,64 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#ifndef GUA_POSE_KERNELS_HPP
+#define GUA_POSE_KERNELS_HPP
+
+#include <gua/skelanim/platform.hpp>
+
+// external headers
+#include <cstddef>
+
+namespace gua
+{
+/**
+ * @brief interpolation loops shared by CompiledAnimation and PoseBuffer
+ * @details the functions work on component arrays (one array per vector
+ * or quaternion component) and use SSE for four elements at a time when
+ * the CPU supports it. The *_scalar versions are the fallback and are
+ * exposed for testing.
+ */
+namespace pose_kernels
+{
+/**
+ * @brief a[i] += (b[i] - a[i]) * weights[i]
+ */
+GUA_SKELANIM_DLL void lerp(float* a, float const* b, float const* weights, std::size_t count);
+GUA_SKELANIM_DLL void lerp_scalar(float* a, float const* b, float const* weights, std::size_t count);
+
+/**
+ * @brief normalized lerp of quaternions along the shortest arc
+ * @details a and b point to the x, y, z and w arrays, the result is
+ * written to a. This replaces slerp: the result lies on the same arc, but
+ * the angle is not linear in the weight. The rotation differs from slerp by
+ * less than 0.3 degrees for rotations up to 60 degrees apart, about 1
+ * degree at 90 and about 8 degrees at 180 degrees apart. Neighbouring
+ * keyframes are well within the first range; blends between very
+ * different poses may move slightly faster in the middle.
+ */
+GUA_SKELANIM_DLL void nlerp(float* const a[4], float const* const b[4], float const* weights, std::size_t count);
+GUA_SKELANIM_DLL void nlerp_scalar(float* const a[4], float const* const b[4], float const* weights, std::size_t count);
+
+} // namespace pose_kernels
+} // namespace gua
+
+#endif // GUA_POSE_KERNELS_HPP
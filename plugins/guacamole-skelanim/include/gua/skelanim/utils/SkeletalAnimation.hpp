@@ -69,6 +69,14 @@ class GUA_SKELANIM_DLL SkeletalAnimation
 
     std::string const& get_name() const;
 
+    /**
+     * @brief returns anim length
+     * @return length in frames, keyframe times are given in frames
+     */
+    unsigned get_num_frames() const;
+
+    std::vector<BoneAnimation> const& get_bone_animations() const;
+
   private:
     std::string name;
     unsigned numFrames;
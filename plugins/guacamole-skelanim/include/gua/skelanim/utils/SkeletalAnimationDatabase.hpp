@@ -0,0 +1,92 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#ifndef GUA_SKELETAL_ANIMATION_DATABASE_HPP
+#define GUA_SKELETAL_ANIMATION_DATABASE_HPP
+
+// guacamole headers
+#include <gua/utils/Singleton.hpp>
+#include <gua/databases/Database.hpp>
+#include <gua/skelanim/utils/SkeletalAnimation.hpp>
+#include <gua/skelanim/utils/CompiledAnimation.hpp>
+#include <gua/skelanim/platform.hpp>
+
+// external headers
+#include <map>
+#include <mutex>
+
+namespace gua
+{
+/**
+ * A data base for animation clips.
+ *
+ * Clips are immutable once loaded and are shared by all
+ * SkeletalAnimationNodes and by all per-frame copies of these nodes.
+ *
+ * \ingroup gua_databases
+ */
+class GUA_SKELANIM_DLL SkeletalAnimationDatabase : public Database<SkeletalAnimation const>, public Singleton<SkeletalAnimationDatabase>
+{
+  public:
+    friend class Singleton<SkeletalAnimationDatabase>;
+
+    /**
+     * @brief returns the clips of the given file
+     * @details loads the file on first use only, subsequent calls
+     * with the same file and name return the cached clips
+     *
+     * @param file_name file containing the animations
+     * @param animation_name name of the clip, numbered if the file
+     * contains more than one
+     */
+    std::vector<mapped_type> load(std::string const& file_name, std::string const& animation_name);
+
+    /**
+     * @brief returns the clip prepared for sampling with the given skeleton
+     * @details compiled clips are shared between all skeletons with the
+     * same bone names and are kept as long as they are in use
+     */
+    std::shared_ptr<CompiledAnimation const> compile(mapped_type const& clip, Skeleton const& skeleton);
+
+    static std::string make_key(std::string const& file_name, std::string const& clip_name);
+
+  private:
+    // this class is a Singleton --- private c'tor and d'tor
+    SkeletalAnimationDatabase() {}
+    ~SkeletalAnimationDatabase() {}
+
+    std::mutex load_mutex_;
+    std::map<std::string, std::vector<std::string>> loaded_files_;
+
+    struct CompiledEntry
+    {
+        std::weak_ptr<SkeletalAnimation const> source;
+        std::weak_ptr<CompiledAnimation const> compiled;
+    };
+
+    std::mutex compile_mutex_;
+    std::map<std::pair<SkeletalAnimation const*, std::size_t>, CompiledEntry> compiled_;
+};
+
+} // namespace gua
+
+#endif // GUA_SKELETAL_ANIMATION_DATABASE_HPP
@@ -0,0 +1,108 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#ifndef GUA_SKELETAL_ANIMATION_UPDATER_HPP
+#define GUA_SKELETAL_ANIMATION_UPDATER_HPP
+
+// guacamole headers
+#include <gua/utils/Singleton.hpp>
+#include <gua/math/BoundingBox.hpp>
+#include <gua/math/math.hpp>
+#include <gua/skelanim/platform.hpp>
+
+// external headers
+#include <scm/gl_core.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gua
+{
+/**
+ * @brief evaluates skeletal animations on worker threads
+ * @details SkeletalAnimationNodes submit their playback state when the
+ * scene graph is updated on the application side. Results are published
+ * as immutable bone palettes, which frame copies of the nodes and the
+ * renderer access by handle. This way each animation is evaluated once
+ * per frame, independent of the number of passes and views.
+ */
+class GUA_SKELANIM_DLL SkeletalAnimationUpdater : public Singleton<SkeletalAnimationUpdater>
+{
+  public:
+    friend class Singleton<SkeletalAnimationUpdater>;
+
+    struct Palette
+    {
+        std::vector<scm::math::mat4f> bone_transforms;
+        // per-bone boxes in object space, empty for bones without vertices
+        std::vector<math::BoundingBox<math::vec3>> bone_boxes;
+    };
+
+    using Job = std::function<void(Palette&)>;
+    using Handle = std::shared_future<std::shared_ptr<Palette const>>;
+
+    /**
+     * @brief queues evaluation of a palette
+     * @details the job runs on one of the worker threads and has to
+     * capture everything it needs by value. The palette is filled in
+     * place, so callers can hand in a palette they own exclusively to
+     * reuse its storage.
+     *
+     * @param palette is filled by the job, must not be read or written
+     * elsewhere until the handle is ready
+     * @param job fills the palette
+     * @return handle to the finished palette
+     */
+    Handle submit(std::shared_ptr<Palette> const& palette, Job const& job);
+
+    /**
+     * @brief sets the number of worker threads
+     * @details defaults to one less than the number of cores, waits for
+     * queued jobs to finish
+     */
+    void set_num_threads(unsigned num_threads);
+    unsigned get_num_threads() const;
+
+  private:
+    // this class is a Singleton --- private c'tor and d'tor
+    SkeletalAnimationUpdater();
+    ~SkeletalAnimationUpdater();
+
+    void start(unsigned num_threads);
+    void stop();
+    void work();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::packaged_task<std::shared_ptr<Palette const>()>> jobs_;
+    mutable std::mutex mutex_;
+    std::condition_variable job_available_;
+    bool running_;
+};
+
+} // namespace gua
+
+#endif // GUA_SKELETAL_ANIMATION_UPDATER_HPP
@@ -33,6 +33,8 @@ namespace gua
 {
 class Skeleton;
 class SkeletalAnimation;
+class CompiledAnimation;
+class BlendTree;
 
 namespace SkeletalTransformation
 {
@@ -92,6 +94,51 @@ GUA_SKELANIM_DLL std::vector<scm::math::mat4f> partial_blend(Skeleton const& ske
                                                              SkeletalAnimation const& anim_1,
                                                              SkeletalAnimation const& anim_2,
                                                              std::string const& split_node_name);
+
+/**
+ * @brief creates transformations from compiled anim at given time
+ * @details samples into a flat pose, reuses the memory of transforms
+ *
+ * @param skeleton the bone hierarchy the anim was compiled for
+ * @param anim_start_node node from which to start calculating transforms
+ * @param time_normalized time for which to calculate transforms
+ * @param anim anim from which to calculate pose
+ * @param transforms vector to write transforms to
+ */
+GUA_SKELANIM_DLL void from_anim(Skeleton const& skeleton, unsigned anim_start_node, float time_normalized, CompiledAnimation const& anim, std::vector<scm::math::mat4f>& transforms);
+
+/**
+ * @brief calculates two poses of compiled anims and blends them
+ * @details like blend_anims, without building name-keyed poses
+ *
+ * @param skeleton the bone hierarchy the anims were compiled for
+ * @param anim_start_node node from which to start calculating transforms
+ * @param blend_factor factor to blend anims with
+ * @param time_normalized1 time for which to calculate transforms from anim_1
+ * @param time_normalized2 time for which to calculate transforms from anim_2
+ * @param anim_1 first anim
+ * @param anim_2 second anim
+ * @param transforms vector to write transforms to
+ */
+GUA_SKELANIM_DLL void blend_anims(Skeleton const& skeleton,
+                                  unsigned anim_start_node,
+                                  float blend_factor,
+                                  float time_normalized1,
+                                  float time_normalized2,
+                                  CompiledAnimation const& anim_1,
+                                  CompiledAnimation const& anim_2,
+                                  std::vector<scm::math::mat4f>& transforms);
+
+/**
+ * @brief creates transformations from blend tree
+ * @details evaluates all layers into a flat pose, reuses the memory of transforms
+ *
+ * @param skeleton the bone hierarchy the tree's anims were compiled for
+ * @param anim_start_node node from which to start calculating transforms
+ * @param tree blend tree to evaluate
+ * @param transforms vector to write transforms to
+ */
+GUA_SKELANIM_DLL void from_blend_tree(Skeleton const& skeleton, unsigned anim_start_node, BlendTree const& tree, std::vector<scm::math::mat4f>& transforms);
 } // namespace SkeletalTransformation
 } // namespace gua
 
@@ -27,6 +27,7 @@
 #include <gua/utils/fbxfwd.hpp>
 #include <gua/skelanim/platform.hpp>
 #include <gua/skelanim/utils/Bone.hpp>
+#include <gua/skelanim/utils/PoseBuffer.hpp>
 
 // external headers
 #include <scm/gl_core.h>
@@ -39,6 +40,7 @@ struct aiNode;
 namespace gua
 {
 class SkeletalPose;
+struct PoseBuffer;
 
 /**
  * @brief represents one node in skeletal hierarchy
@@ -72,6 +74,17 @@ class GUA_SKELANIM_DLL Skeleton
      */
     std::vector<scm::math::mat4f> accumulate_matrices(unsigned index_bone, SkeletalPose const& pose) const;
 
+    /**
+     * @brief calculates tranform matrices from flat pose
+     * @details writes transform matrices for all bones of skeleton,
+     * bones not animated in the pose use their idle matrix
+     *
+     * @param index_bone index of bone to start from
+     * @param pose pose indexed like the bones of this skeleton
+     * @param transforms vector to write matrices to, resized if necessary
+     */
+    void accumulate_matrices(unsigned index_bone, PoseBuffer const& pose, std::vector<scm::math::mat4f>& transforms) const;
+
     /**
      * @brief finds bone in hierarchy
      * @details
@@ -87,6 +100,12 @@ class GUA_SKELANIM_DLL Skeleton
     std::vector<Bone> const& get_bones() const;
     void set_bones(std::vector<Bone> const&);
 
+    /**
+     * @brief returns the idle matrices of all bones as pose
+     * @details all bones are animated, used as base for blending
+     */
+    PoseBuffer const& get_rest_pose() const;
+
     /**
      * @brief calculates tranform matrices from skeletalpose
      * @details writes transform matrices at index in vector
@@ -111,9 +130,13 @@ class GUA_SKELANIM_DLL Skeleton
     void set_offsets(std::map<std::string, scm::math::mat4f> const& offsets);
 
     void store_mapping();
+    void store_rest_pose();
+
+    void accumulate_pose(unsigned index_bone, PoseBuffer const& pose, std::vector<scm::math::mat4f>& transforms, scm::math::mat4f const& parentTransform) const;
 
     std::vector<Bone> m_bones;
     std::map<std::string, int> m_mapping;
+    PoseBuffer m_rest_pose;
 };
 
 } // namespace gua
@@ -27,12 +27,20 @@
 #include <gua/skelanim/utils/SkeletalAnimation.hpp>
 #include <gua/skelanim/utils/BoneAnimation.hpp>
 #include <gua/skelanim/utils/SkeletalTransformation.hpp>
+#include <gua/skelanim/utils/SkeletalAnimationDatabase.hpp>
+#include <gua/skelanim/utils/CompiledAnimation.hpp>
 #include <gua/skelanim/renderer/SkeletalAnimationLoader.hpp>
 #include <gua/skelanim/renderer/SkinnedMeshResource.hpp>
 // #include <gua/node/RayNode.hpp>
 #include <gua/math/BoundingBoxAlgo.hpp>
 #include <gua/databases/GeometryDatabase.hpp>
 
+// external headers
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+
 namespace gua
 {
 namespace node
@@ -41,7 +49,7 @@ namespace node
 SkeletalAnimationNode::SkeletalAnimationNode(
     std::string const& name, std::vector<std::string> const& geometry_descriptions, std::vector<std::shared_ptr<Material>> const& materials, Skeleton const& skeleton, math::mat4 const& transform)
     : GeometryNode(name, transform), geometries_(), geometry_descriptions_(geometry_descriptions), geometry_changed_(true), materials_(materials), render_to_gbuffer_(true),
-      render_to_stencil_buffer_(false), skeleton_(skeleton), new_bones_{true}, has_anims_{false}, blend_factor_{1.0},
+      render_to_stencil_buffer_(false), skeleton_(skeleton), new_bones_{true}, has_anims_{false}, animation_dirty_{true}, blend_factor_{1.0},
       anim_1_(SkeletalAnimationNode::none_loaded), // { } not allowed on msvc because of implicit conversion to initializer list
       anim_2_(SkeletalAnimationNode::none_loaded)
 {
@@ -69,7 +77,10 @@ void SkeletalAnimationNode::set_skeleton_description(std::string const& descript
 {
     gua::SkeletalAnimationLoader loader;
     skeleton_ = loader.load_skeleton(description);
+    skeleton_snapshot_ = nullptr;
     new_bones_ = true;
+    compile_animations();
+    set_animation_dirty();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -116,57 +127,196 @@ void SkeletalAnimationNode::set_material(std::shared_ptr<Material> material, uns
 ////////////////////////////////////////////////////////////////////////////////
 void SkeletalAnimationNode::add_animations(std::string const& file_name, std::string const& name)
 {
-    std::vector<SkeletalAnimation> anims{SkeletalAnimationLoader{}.load_animation(file_name, name)};
+    auto anims(SkeletalAnimationDatabase::instance()->load(file_name, name));
+
+    // the map is shared with copies of this node, so it is replaced rather than modified
+    auto animations(animations_ ? std::make_shared<AnimationMap>(*animations_) : std::make_shared<AnimationMap>());
+
+    for(auto const& anim : anims)
+    {
+        animations->insert(std::make_pair(anim->get_name(), Clip{anim, SkeletalAnimationDatabase::instance()->compile(anim, skeleton_)}));
+    }
+
+    animations_ = animations;
+    has_anims_ = animations_->size() > 0;
+    set_animation_dirty();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SkeletalAnimationNode::Clip const* SkeletalAnimationNode::find_animation(std::string const& animation_name) const
+{
+    if(!animations_)
+    {
+        return nullptr;
+    }
+
+    auto anim(animations_->find(animation_name));
+    return anim != animations_->end() ? &anim->second : nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SkeletalAnimationNode::compile_animations()
+{
+    if(!animations_)
+    {
+        return;
+    }
 
-    for(unsigned i = 0; i < anims.size(); ++i)
+    auto animations(std::make_shared<AnimationMap>(*animations_));
+    for(auto& anim : *animations)
     {
-        animations_.insert(std::make_pair(anims[i].get_name(), anims[i]));
+        anim.second.compiled = SkeletalAnimationDatabase::instance()->compile(anim.second.animation, skeleton_);
     }
 
-    has_anims_ = animations_.size() > 0;
+    animations_ = animations;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 void SkeletalAnimationNode::update_bone_transforms()
 {
-    if(!has_anims_ && !new_bones_)
+    if(!has_anims_ && !new_bones_ && !blend_tree_)
         return;
-    // no animation and new bones -> generate transforms once
-    if(!has_anims_)
+
+    new_bones_ = false;
+    evaluate(skeleton_, blend_tree_.get(), find_animation(anim_1_), find_animation(anim_2_), blend_factor_, anim_time_1_, anim_time_2_, bone_transforms_);
+
+    // the synchronous result replaces any pending palette
+    palette_ = SkeletalAnimationUpdater::Handle();
+    ++pose_revision_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SkeletalAnimationNode::evaluate(Skeleton const& skeleton,
+                                     BlendTree const* tree,
+                                     Clip const* anim_1,
+                                     Clip const* anim_2,
+                                     float blend_factor,
+                                     float time_1,
+                                     float time_2,
+                                     std::vector<scm::math::mat4f>& transforms)
+{
+    if(tree)
     {
-        new_bones_ = false;
-        bone_transforms_ = SkeletalTransformation::from_hierarchy(skeleton_, 0);
+        SkeletalTransformation::from_blend_tree(skeleton, 0, *tree, transforms);
+        return;
     }
+
     // use first anim
-    else if(blend_factor_ <= 0.0)
+    if(blend_factor <= 0.0)
     {
-        if(anim_1_ != SkeletalAnimationNode::none_loaded)
-        {
-            bone_transforms_ = SkeletalTransformation::from_anim(skeleton_, 0, anim_time_1_, animations_.at(anim_1_));
-        }
-        else
-        {
-            bone_transforms_ = SkeletalTransformation::from_hierarchy(skeleton_, 0);
-        }
+        anim_2 = nullptr;
     }
     // use second anim
-    else if(blend_factor_ >= 1.0)
+    else if(blend_factor >= 1.0)
     {
-        if(anim_2_ != SkeletalAnimationNode::none_loaded)
-        {
-            SkeletalTransformation::from_anim(skeleton_, 0, anim_time_2_, animations_.at(anim_2_));
-        }
-        else
+        anim_1 = nullptr;
+    }
+
+    if(anim_1 && anim_2)
+    {
+        SkeletalTransformation::blend_anims(skeleton, 0, blend_factor, time_1, time_2, *anim_1->compiled, *anim_2->compiled, transforms);
+    }
+    else if(anim_1)
+    {
+        SkeletalTransformation::from_anim(skeleton, 0, time_1, *anim_1->compiled, transforms);
+    }
+    else if(anim_2)
+    {
+        SkeletalTransformation::from_anim(skeleton, 0, time_2, *anim_2->compiled, transforms);
+    }
+    // no animation -> bind pose
+    else
+    {
+        transforms = SkeletalTransformation::from_hierarchy(skeleton, 0);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SkeletalAnimationNode::submit_palette()
+{
+    if(!skeleton_snapshot_)
+    {
+        skeleton_snapshot_ = std::make_shared<Skeleton const>(skeleton_);
+    }
+
+    // everything is captured by value, the node may change or die while the job
+    // runs; animations keeps the clips referenced by anim_1 and anim_2 alive
+    auto skeleton(skeleton_snapshot_);
+    auto animations(animations_);
+    std::shared_ptr<BlendTree const> tree(blend_tree_);
+    auto geometries(geometries_);
+    auto anim_1(find_animation(anim_1_));
+    auto anim_2(find_animation(anim_2_));
+    float blend_factor(blend_factor_);
+    float time_1(anim_time_1_);
+    float time_2(anim_time_2_);
+
+    auto& buffer(palette_buffers_[back_palette_]);
+    back_palette_ = 1 - back_palette_;
+
+    // frame copies still read the palette of an earlier frame, fall back to
+    // a fresh one instead of waiting for them
+    if(!buffer || buffer.use_count() != 1)
+    {
+        buffer = std::make_shared<SkeletalAnimationUpdater::Palette>();
+    }
+    else
+    {
+        // pairs with the release in the last owner's decrement, so the
+        // previous job's writes are visible before the buffer is refilled
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+
+    ++pose_revision_;
+    palette_ = SkeletalAnimationUpdater::instance()->submit(buffer, [skeleton, animations, tree, geometries, anim_1, anim_2, blend_factor, time_1, time_2](SkeletalAnimationUpdater::Palette& palette) {
+        evaluate(*skeleton, tree.get(), anim_1, anim_2, blend_factor, time_1, time_2, palette.bone_transforms);
+
+        // the geometries expand the boxes, keep the capacity of a reused palette
+        palette.bone_boxes.clear();
+
+        for(auto const& geometry : geometries)
         {
-            bone_transforms_ = SkeletalTransformation::from_hierarchy(skeleton_, 0);
+            if(!geometry)
+            {
+                continue;
+            }
+
+            geometry->expand_bone_boxes(palette.bone_transforms, palette.bone_boxes);
         }
+    });
+
+    animation_dirty_ = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::shared_ptr<SkeletalAnimationUpdater::Palette const> SkeletalAnimationNode::get_palette() const
+{
+    if(!palette_.valid())
+    {
+        return nullptr;
     }
-    // use both anims
-    else
+
+    try
+    {
+        return palette_.get();
+    }
+    catch(std::exception& e)
     {
-        bone_transforms_ = SkeletalTransformation::blend_anims(skeleton_, 0, blend_factor_, anim_time_1_, anim_time_2_, animations_.at(anim_1_), animations_.at(anim_2_));
+        Logger::LOG_ERROR << "SkeletalAnimationNode::get_palette(): Evaluation failed: " << e.what() << std::endl;
+        return nullptr;
     }
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void SkeletalAnimationNode::set_animation_dirty()
+{
+    animation_dirty_ = true;
+
+    // makes sure update_cache() reaches this node
+    child_dirty_ = true;
+    set_parent_dirty();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 bool SkeletalAnimationNode::get_render_to_gbuffer() const { return render_to_gbuffer_; }
 
@@ -183,7 +333,10 @@ void SkeletalAnimationNode::set_render_to_stencil_buffer(bool enable) { render_t
 void SkeletalAnimationNode::set_bones(std::vector<Bone> const& bones)
 {
     skeleton_.set_bones(bones);
+    skeleton_snapshot_ = nullptr;
     new_bones_ = true;
+    compile_animations();
+    set_animation_dirty();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -192,140 +345,77 @@ std::vector<gua::Bone> const& SkeletalAnimationNode::get_bones() const { return
 ////////////////////////////////////////////////////////////////////////////////
 void SkeletalAnimationNode::ray_test_impl(Ray const& ray, int options, Mask const& mask, std::set<PickResult>& hits)
 {
-    // TODO
+    // first of all, check bbox
+    auto box_hits(::gua::intersect(ray, bounding_box_));
 
-    /*// first of all, check bbox
-      auto box_hits(::gua::intersect(ray, bounding_box_));
+    // ray did not intersect bbox -- therefore it wont intersect
+    if(box_hits.first == Ray::END && box_hits.second == Ray::END)
+    {
+        return;
+    }
 
-      // ray did not intersect bbox -- therefore it wont intersect
-      if (box_hits.first == Ray::END && box_hits.second == Ray::END) {
+    // return if only first object shall be returned and the current first hit
+    // is in front of the bbox entry point
+    if(options & PickResult::PICK_ONLY_FIRST_OBJECT && hits.size() > 0 && hits.begin()->distance < box_hits.first)
+    {
         return;
-      }
+    }
 
+    // bbox is intersected, but check geometry only if mask tells us to check
+    if(mask.check(get_tags()))
+    {
+        math::mat4 world_transform(get_world_transform());
+        math::mat4 ori_transform(scm::math::inverse(world_transform));
 
-      // return if only first object shall be returned and the current first hit
-      // is in front of the bbox entry point and the ray does not start inside
-      // the bbox
-      if (options & PickResult::PICK_ONLY_FIRST_OBJECT
-        && hits.size() > 0 && hits.begin()->distance < box_hits.first
-        && box_hits.first != Ray::END) {
+        math::vec4 ori(ori_transform * math::vec4(ray.origin_[0], ray.origin_[1], ray.origin_[2], 1.0));
+        math::vec4 dir(ori_transform * math::vec4(ray.direction_[0], ray.direction_[1], ray.direction_[2], 0.0));
 
-        return;
-      }
-
-      // bbox is intersected, but check geometry only if mask tells us to check
-      if (get_geometry_description() != "" && mask.check(get_tags())) {
-
-        auto
-  geometry(GeometryDatabase::instance()->lookup(get_geometry_description()));
-
-        if (geometry) {
-
-          bool check_kd_tree(true);
-
-          math::mat4 world_transform(get_world_transform());
-
-          // check for bounding box intersection of contained geometry if node
-          // has children (in this case, the bbox might be larger
-          // than the actual geometry)
-          if (has_children()) {
-            auto geometry_bbox(geometry->get_bounding_box());
-
-  #if 0
-            auto inner_bbox = gua::math::transform(geometry_bbox,
-  world_transform);
-  #else
-            math::BoundingBox<math::vec3> inner_bbox;
-            inner_bbox.expandBy(world_transform * geometry_bbox.min);
-            inner_bbox.expandBy(world_transform * geometry_bbox.max);
-            inner_bbox.expandBy(world_transform *
-              math::vec3(geometry_bbox.min.x,
-              geometry_bbox.min.y,
-              geometry_bbox.max.z));
-            inner_bbox.expandBy(world_transform *
-              math::vec3(geometry_bbox.min.x,
-              geometry_bbox.max.y,
-              geometry_bbox.min.z));
-            inner_bbox.expandBy(world_transform *
-              math::vec3(geometry_bbox.min.x,
-              geometry_bbox.max.y,
-              geometry_bbox.max.z));
-            inner_bbox.expandBy(world_transform *
-              math::vec3(geometry_bbox.max.x,
-              geometry_bbox.min.y,
-              geometry_bbox.max.z));
-            inner_bbox.expandBy(world_transform *
-              math::vec3(geometry_bbox.max.x,
-              geometry_bbox.max.y,
-              geometry_bbox.min.z));
-            inner_bbox.expandBy(world_transform *
-              math::vec3(geometry_bbox.max.x,
-              geometry_bbox.min.y,
-              geometry_bbox.min.z));
-  #endif
-
-            auto inner_hits(::gua::intersect(ray, inner_bbox));
-            if (inner_hits.first == RayNode::END &&
-              inner_hits.second == RayNode::END)
-              check_kd_tree = false;
-          }
-
-          if (check_kd_tree) {
-            Ray world_ray(ray);
-
-            math::mat4 ori_transform(scm::math::inverse(world_transform));
-
-            math::vec4 ori(world_ray.origin_[0],
-              world_ray.origin_[1],
-              world_ray.origin_[2],
-              1.0);
-            math::vec4 dir(world_ray.direction_[0],
-              world_ray.direction_[1],
-              world_ray.direction_[2],
-              0.0);
-
-            ori = ori_transform * ori;
-            dir = ori_transform * dir;
-
-            Ray object_ray(ori, dir, world_ray.t_max_);
-            geometry->ray_test(object_ray, options, this, hits);
-
-            float const inf(std::numeric_limits<float>::max());
-
-            if (options & PickResult::GET_WORLD_POSITIONS) {
-
-              for (auto& hit : hits) {
-                if (hit.world_position == math::vec3(inf, inf, inf)) {
-                  auto transformed(world_transform * math::vec4(hit.position.x,
-  hit.position.y, hit.position.z, 0.0));
-                  hit.world_position = scm::math::vec3(transformed.x,
-  transformed.y, transformed.z);
+        Ray object_ray(ori, dir, ray.t_max_);
+
+        // the bones are moved instead of the mesh, see SkinnedMeshResource::ray_test
+        auto const& bone_transforms(get_bone_transforms());
+
+        for(auto const& geometry : geometries_)
+        {
+            if(geometry)
+            {
+                geometry->ray_test(object_ray, options, this, hits, bone_transforms);
+            }
+        }
+
+        float const inf(std::numeric_limits<float>::max());
+
+        if(options & PickResult::GET_WORLD_POSITIONS)
+        {
+            for(auto& hit : hits)
+            {
+                if(hit.world_position == math::vec3(inf, inf, inf))
+                {
+                    auto transformed(world_transform * math::vec4(hit.position.x, hit.position.y, hit.position.z, 1.0));
+                    hit.world_position = scm::math::vec3(transformed.x, transformed.y, transformed.z);
                 }
-              }
             }
+        }
 
-            if (options & PickResult::GET_WORLD_NORMALS) {
-
-              math::mat4
-  normal_matrix(scm::math::inverse(scm::math::transpose(world_transform)));
-              for (auto& hit : hits) {
-                if (hit.world_normal == math::vec3(inf, inf, inf)) {
-                  auto transformed(normal_matrix * math::vec4(hit.normal.x,
-  hit.normal.y, hit.normal.z, 0.0));
-                  hit.world_normal =
-  scm::math::normalize(scm::math::vec3(transformed.x, transformed.y,
-  transformed.z));
+        if(options & PickResult::GET_WORLD_NORMALS)
+        {
+            math::mat4 normal_matrix(scm::math::inverse(scm::math::transpose(world_transform)));
+            for(auto& hit : hits)
+            {
+                if(hit.world_normal == math::vec3(inf, inf, inf))
+                {
+                    auto transformed(normal_matrix * math::vec4(hit.normal.x, hit.normal.y, hit.normal.z, 0.0));
+                    hit.world_normal = scm::math::normalize(scm::math::vec3(transformed.x, transformed.y, transformed.z));
                 }
-              }
             }
-          }
         }
-      }
+    }
 
-      for (auto child : get_children()) {
+    for(auto child : get_children())
+    {
         // test for intersection with each child
         child->ray_test_impl(ray, options, mask, hits);
-      }*/
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -367,11 +457,22 @@ void SkeletalAnimationNode::update_cache()
         }
 
         geometry_changed_ = false;
+        animation_dirty_ = true;
+    }
+
+    // the palette becomes available for this frame's copy, the bounding box
+    // below is computed from the last finished one
+    if(animation_dirty_)
+    {
+        submit_palette();
     }
 
     GeometryNode::update_cache();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+std::size_t SkeletalAnimationNode::get_geometry_revision() const { return pose_revision_; }
+
 ////////////////////////////////////////////////////////////////////////////////
 std::vector<std::shared_ptr<SkinnedMeshResource>> const& SkeletalAnimationNode::get_geometries() const { return geometries_; }
 
@@ -379,24 +480,26 @@ std::vector<std::shared_ptr<SkinnedMeshResource>> const& SkeletalAnimationNode::
 /* virtual */ void SkeletalAnimationNode::accept(NodeVisitor& visitor) { visitor.visit(this); }
 
 ////////////////////////////////////////////////////////////////////////////////
-std::vector<math::BoundingBox<math::vec3>> SkeletalAnimationNode::get_bone_boxes()
+std::vector<math::BoundingBox<math::vec3>> const& SkeletalAnimationNode::get_bone_boxes()
 {
-    auto tmp_boxes = std::vector<math::BoundingBox<math::vec3>>(100, math::BoundingBox<math::vec3>());
+    auto palette(get_palette());
+    if(!palette)
+    {
+        bone_boxes_.clear();
+        return bone_boxes_;
+    }
+
+    bone_boxes_.assign(palette->bone_boxes.size(), math::BoundingBox<math::vec3>());
 
-    for(unsigned i(0); i < geometries_.size(); ++i)
+    for(unsigned b(0); b < palette->bone_boxes.size(); ++b)
     {
-        auto bone_boxes = geometries_[i]->get_bone_boxes(bone_transforms_);
-        for(unsigned b(0); b < bone_boxes.size(); ++b)
+        if(!palette->bone_boxes[b].isEmpty())
         {
-            if(!bone_boxes[b].isEmpty())
-            {
-                bone_boxes[b] = transform(bone_boxes[b], world_transform_);
-                tmp_boxes[b].expandBy(bone_boxes[b]);
-            }
+            bone_boxes_[b] = transform(palette->bone_boxes[b], world_transform_);
         }
     }
 
-    return tmp_boxes;
+    return bone_boxes_;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -406,15 +509,20 @@ void SkeletalAnimationNode::update_bounding_box() const
     {
         auto geometry_bbox = math::BoundingBox<math::vec3>();
 
-        for(unsigned i(0); i < geometries_.size(); ++i)
+        // waiting for the palette submitted this frame would serialize the
+        // updates, so the bounds lag behind by one frame while it is running
+        if(palette_.valid() && palette_.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            bounds_palette_ = get_palette();
+        }
+
+        if(bounds_palette_)
         {
-            auto bone_boxes = geometries_[i]->get_bone_boxes(bone_transforms_);
-            for(unsigned b(0); b < bone_boxes.size(); ++b)
+            for(auto const& bone_box : bounds_palette_->bone_boxes)
             {
-                if(!bone_boxes[b].isEmpty())
+                if(!bone_box.isEmpty())
                 {
-                    bone_boxes[b] = transform(bone_boxes[b], world_transform_);
-                    geometry_bbox.expandBy(bone_boxes[b]);
+                    geometry_bbox.expandBy(transform(bone_box, world_transform_));
                 }
             }
         }
@@ -467,7 +575,17 @@ std::shared_ptr<Node> SkeletalAnimationNode::copy() const
     result->blend_factor_ = blend_factor_;
     result->anim_time_1_ = anim_time_1_;
     result->anim_time_2_ = anim_time_2_;
+    result->blend_tree_ = blend_tree_;
+    result->spare_blend_tree_ = nullptr;
     result->bone_transforms_ = bone_transforms_;
+    result->animation_dirty_ = animation_dirty_;
+    result->skeleton_snapshot_ = skeleton_snapshot_;
+    result->palette_ = palette_;
+    result->bounds_palette_ = bounds_palette_;
+    // the buffers stay with this node, holding them would defeat their reuse
+    result->palette_buffers_[0] = nullptr;
+    result->palette_buffers_[1] = nullptr;
+    result->pose_revision_ = pose_revision_;
 
     return result;
 }
@@ -475,7 +593,7 @@ std::shared_ptr<Node> SkeletalAnimationNode::copy() const
 ////////////////////////////////////////////////////////////////////////////////
 std::string const& SkeletalAnimationNode::get_animation_1() const
 {
-    if(has_anims_ && animations_.find(anim_1_) != animations_.end())
+    if(has_anims_ && find_animation(anim_1_))
     {
         return anim_1_;
     }
@@ -490,6 +608,7 @@ void SkeletalAnimationNode::set_animation_1(std::string const& animation_name)
     // if (animation_name == none_loaded || animations_.find(animation_name) != animations_.end()) {
     // }
     anim_1_ = animation_name;
+    set_animation_dirty();
     //  else {
     //   gua::Logger::LOG_ERROR << "No matching animation with name: '"
     //                            << animation_name << "' found!" << std::endl;
@@ -497,7 +616,7 @@ void SkeletalAnimationNode::set_animation_1(std::string const& animation_name)
 }
 std::string const& SkeletalAnimationNode::get_animation_2() const
 {
-    if(has_anims_ && animations_.find(anim_2_) != animations_.end())
+    if(has_anims_ && find_animation(anim_2_))
     {
         return anim_2_;
     }
@@ -512,6 +631,7 @@ void SkeletalAnimationNode::set_animation_2(std::string const& animation_name)
     // if (animation_name == none_loaded || animations_.find(animation_name) != animations_.end()) {
     // }
     anim_2_ = animation_name;
+    set_animation_dirty();
     //  else {
     //   gua::Logger::LOG_ERROR << "No matching animation with name: '"
     //                            << animation_name << "' found!" << std::endl;
@@ -520,9 +640,9 @@ void SkeletalAnimationNode::set_animation_2(std::string const& animation_name)
 
 float SkeletalAnimationNode::get_duration(std::string const& animation_name) const
 {
-    if(animations_.find(animation_name) != animations_.end())
+    if(auto anim = find_animation(animation_name))
     {
-        return animations_.at(animation_name).get_duration();
+        return anim->animation->get_duration();
     }
     else
     {
@@ -533,19 +653,87 @@ float SkeletalAnimationNode::get_duration(std::string const& animation_name) con
 
 float SkeletalAnimationNode::get_blend_factor() const { return blend_factor_; }
 
-void SkeletalAnimationNode::set_blend_factor(float f) { blend_factor_ = f; }
+void SkeletalAnimationNode::set_blend_factor(float f)
+{
+    blend_factor_ = f;
+    set_animation_dirty();
+}
 
-void SkeletalAnimationNode::set_time_1(float time) { anim_time_1_ = time; }
+void SkeletalAnimationNode::set_time_1(float time)
+{
+    anim_time_1_ = time;
+    set_animation_dirty();
+}
 
 float SkeletalAnimationNode::get_time_1() const { return anim_time_1_; }
 
-void SkeletalAnimationNode::set_time_2(float time) { anim_time_2_ = time; }
+void SkeletalAnimationNode::set_time_2(float time)
+{
+    anim_time_2_ = time;
+    set_animation_dirty();
+}
 
 float SkeletalAnimationNode::get_time_2() const { return anim_time_2_; }
 
 bool SkeletalAnimationNode::has_anims() const { return has_anims_; }
 
-std::vector<scm::math::mat4f> const& SkeletalAnimationNode::get_bone_transforms() const { return bone_transforms_; }
+std::shared_ptr<CompiledAnimation const> SkeletalAnimationNode::get_compiled_animation(std::string const& animation_name) const
+{
+    if(auto anim = find_animation(animation_name))
+    {
+        return anim->compiled;
+    }
+    else
+    {
+        gua::Logger::LOG_ERROR << "No matching animation with name: '" << animation_name << "' found!" << std::endl;
+        return nullptr;
+    }
+}
+
+void SkeletalAnimationNode::set_blend_tree(BlendTree const& tree)
+{
+    // pending jobs and frame copies may still read the current tree
+    if(blend_tree_.use_count() != 1)
+    {
+        std::swap(blend_tree_, spare_blend_tree_);
+    }
+
+    if(blend_tree_.use_count() == 1)
+    {
+        *blend_tree_ = tree;
+    }
+    else
+    {
+        blend_tree_ = std::make_shared<BlendTree>(tree);
+    }
+
+    set_animation_dirty();
+}
+
+void SkeletalAnimationNode::clear_blend_tree()
+{
+    spare_blend_tree_ = std::move(blend_tree_);
+    blend_tree_ = nullptr;
+    set_animation_dirty();
+}
+
+bool SkeletalAnimationNode::has_blend_tree() const { return blend_tree_ != nullptr; }
+
+BlendTree const& SkeletalAnimationNode::get_blend_tree() const { return *blend_tree_; }
+
+std::vector<scm::math::mat4f> const& SkeletalAnimationNode::get_bone_transforms() const
+{
+    if(palette_.valid())
+    {
+        auto palette(get_palette());
+        if(palette)
+        {
+            return palette->bone_transforms;
+        }
+    }
+
+    return bone_transforms_;
+}
 
 const std::string SkeletalAnimationNode::none_loaded = std::string("none");
 ;
@@ -195,7 +195,9 @@ void SkeletalAnimationRenderer::render(Pipeline& pipe, PipelinePassDescription c
                     }
 
                     ctx.render_context->apply_program();
-                    if(ctx.framecount > last_frame_)
+                    // animations are evaluated once per frame on the application side,
+                    // nodes which never went through update_cache() are evaluated here
+                    if(ctx.framecount > last_frame_ && !skel_anim_node->get_palette())
                     {
                         skel_anim_node->update_bone_transforms();
                     }
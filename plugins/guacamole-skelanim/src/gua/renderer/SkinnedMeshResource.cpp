@@ -30,6 +30,9 @@
 
 // external headers
 #include <scm/gl_core/buffer_objects/scoped_buffer_map.h>
+#include <algorithm>
+#include <limits>
+#include <map>
 
 namespace gua
 {
@@ -49,16 +52,13 @@ SkinnedMeshResource::SkinnedMeshResource(SkinnedMesh const& mesh, bool build_kd_
         bounding_box_.expandBy(math::vec3{mesh_.positions[v]});
     }
 
-    bone_boxes_ = std::vector<math::BoundingBox<math::vec3>>(100, math::BoundingBox<math::vec3>());
-
     // init non transformated/animated bone boxes
     init_bone_boxes();
 
-    // TODO
-    /*if (build_kd_tree) {
-      kd_tree_.generate(mesh_);
+    if(build_kd_tree)
+    {
+        init_bone_parts();
     }
-  //}*/
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -147,6 +147,14 @@ void SkinnedMeshResource::upload_to(RenderContext& ctx, SharedSkinningResource&
 
 void SkinnedMeshResource::init_bone_boxes()
 {
+    unsigned num_bones(0);
+    for(auto const& id : mesh_.bone_ids)
+    {
+        num_bones = std::max(num_bones, id + 1);
+    }
+
+    bone_boxes_ = std::vector<math::BoundingBox<math::vec3>>(num_bones, math::BoundingBox<math::vec3>());
+
     // use every single vertex to be manipulated by a certain bone per bone box
     unsigned bone_offset = 0;
     for(unsigned v(0); v < mesh_.num_vertices; ++v)
@@ -163,18 +171,105 @@ void SkinnedMeshResource::init_bone_boxes()
 
 ////////////////////////////////////////////////////////////////////////////////
 
-std::vector<math::BoundingBox<math::vec3>> SkinnedMeshResource::get_bone_boxes(std::vector<scm::math::mat4f> const& bone_transforms)
+void SkinnedMeshResource::init_bone_parts()
 {
-    auto tmp_boxes = std::vector<math::BoundingBox<math::vec3>>(100, math::BoundingBox<math::vec3>());
+    // assign every triangle to the bone with the largest summed weight of its
+    // vertices
+    std::vector<unsigned> vertex_offsets(mesh_.num_vertices, 0);
+    for(unsigned v(1); v < mesh_.num_vertices; ++v)
+    {
+        vertex_offsets[v] = vertex_offsets[v - 1] + mesh_.bone_counts[v - 1];
+    }
 
-    for(unsigned b(0); b < bone_boxes_.size(); ++b)
+    std::map<unsigned, std::vector<unsigned>> bone_triangles;
+    std::map<unsigned, float> triangle_weights;
+
+    for(unsigned t(0); t < mesh_.num_triangles; ++t)
     {
-        if(!bone_boxes_[b].isEmpty() && b < bone_transforms.size())
+        triangle_weights.clear();
+        for(unsigned i(0); i < 3; ++i)
+        {
+            unsigned v(mesh_.indices[t * 3 + i]);
+            for(unsigned b(0); b < mesh_.bone_counts[v]; ++b)
+            {
+                triangle_weights[mesh_.bone_ids[vertex_offsets[v] + b]] += mesh_.bone_weights[vertex_offsets[v] + b];
+            }
+        }
+
+        if(triangle_weights.empty())
         {
-            tmp_boxes[b] = transform(bone_boxes_[b], scm::math::mat4d(bone_transforms[b]));
+            continue;
+        }
+
+        auto dominant(std::max_element(triangle_weights.begin(), triangle_weights.end(), [](std::pair<const unsigned, float> const& a, std::pair<const unsigned, float> const& b) {
+            return a.second < b.second;
+        }));
+        bone_triangles[dominant->first].push_back(t);
+    }
+
+    bool const has_normals(mesh_.normals.size() == mesh_.num_vertices);
+    bool const has_tex_coords(mesh_.texCoords.size() == mesh_.num_vertices);
+
+    // one compact sub mesh per bone, the kd trees are built in bind pose
+    bone_parts_.resize(bone_triangles.size());
+    unsigned part_index(0);
+    std::vector<int> vertex_map(mesh_.num_vertices, -1);
+
+    for(auto const& triangles : bone_triangles)
+    {
+        auto& part(bone_parts_[part_index++]);
+        part.bone = triangles.first;
+
+        std::fill(vertex_map.begin(), vertex_map.end(), -1);
+
+        for(auto t : triangles.second)
+        {
+            for(unsigned i(0); i < 3; ++i)
+            {
+                unsigned v(mesh_.indices[t * 3 + i]);
+                if(vertex_map[v] < 0)
+                {
+                    vertex_map[v] = int(part.mesh.positions.size());
+                    part.mesh.positions.push_back(mesh_.positions[v]);
+                    part.mesh.normals.push_back(has_normals ? mesh_.normals[v] : scm::math::vec3f(0.0f, 1.0f, 0.0f));
+                    part.mesh.texCoords.push_back(has_tex_coords ? mesh_.texCoords[v] : scm::math::vec2f(0.0f, 0.0f));
+                    part.bounds.expandBy(math::vec3{mesh_.positions[v]});
+                }
+                part.mesh.indices.push_back(unsigned(vertex_map[v]));
+            }
+        }
+
+        part.mesh.num_vertices = unsigned(part.mesh.positions.size());
+        part.mesh.num_triangles = unsigned(triangles.second.size());
+        part.kd_tree.generate(part.mesh);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<math::BoundingBox<math::vec3>> SkinnedMeshResource::get_bone_boxes(std::vector<scm::math::mat4f> const& bone_transforms) const
+{
+    std::vector<math::BoundingBox<math::vec3>> boxes(bone_boxes_.size(), math::BoundingBox<math::vec3>());
+    expand_bone_boxes(bone_transforms, boxes);
+    return boxes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void SkinnedMeshResource::expand_bone_boxes(std::vector<scm::math::mat4f> const& bone_transforms, std::vector<math::BoundingBox<math::vec3>>& boxes) const
+{
+    if(boxes.size() < bone_boxes_.size())
+    {
+        boxes.resize(bone_boxes_.size());
+    }
+
+    for(unsigned b(0); b < bone_boxes_.size() && b < bone_transforms.size(); ++b)
+    {
+        if(!bone_boxes_[b].isEmpty())
+        {
+            boxes[b].expandBy(transform(bone_boxes_[b], scm::math::mat4d(bone_transforms[b])));
         }
     }
-    return tmp_boxes;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -193,11 +288,88 @@ void SkinnedMeshResource::draw(RenderContext& ctx) /*const*/
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void SkinnedMeshResource::ray_test(Ray const& ray, int options, node::Node* owner, std::set<PickResult>& hits)
+void SkinnedMeshResource::ray_test(Ray const& ray, int options, node::Node* owner, std::set<PickResult>& hits) { ray_test(ray, options, owner, hits, std::vector<scm::math::mat4f>()); }
+
+////////////////////////////////////////////////////////////////////////////////
+
+void SkinnedMeshResource::ray_test(Ray const& ray, int options, node::Node* owner, std::set<PickResult>& hits, std::vector<scm::math::mat4f> const& bone_transforms)
 {
-    // TODO raycasting
-    Logger::LOG_ERROR << "get_vertex() dynamic ray testing not supported " << std::endl;
-    // kd_tree_.ray_test(ray, mesh_, options, owner, hits);
+    if(bone_parts_.empty())
+    {
+        return;
+    }
+
+    float const inf(std::numeric_limits<float>::max());
+
+    // results of all bones, in object space; every bone reports its closest
+    // face or all faces, the options are applied to hits afterwards
+    std::set<PickResult> bone_hits;
+    int const bone_options(options & ~PickResult::PICK_ONLY_FIRST_OBJECT);
+
+    for(auto const& part : bone_parts_)
+    {
+        math::mat4 bone_transform(part.bone < bone_transforms.size() ? scm::math::mat4d(bone_transforms[part.bone]) : math::mat4::identity());
+
+        auto box_hits(::gua::intersect(ray, transform(part.bounds, bone_transform)));
+        if(box_hits.first == Ray::END && box_hits.second == Ray::END)
+        {
+            continue;
+        }
+
+        // an affine transform keeps the ray parameter, so distances stay comparable
+        math::mat4 inverse_transform(scm::math::inverse(bone_transform));
+        math::vec4 ori(inverse_transform * math::vec4(ray.origin_.x, ray.origin_.y, ray.origin_.z, 1.0));
+        math::vec4 dir(inverse_transform * math::vec4(ray.direction_.x, ray.direction_.y, ray.direction_.z, 0.0));
+
+        std::set<PickResult> part_hits;
+        part.kd_tree.ray_test(Ray(math::vec3(ori.x, ori.y, ori.z), math::vec3(dir.x, dir.y, dir.z), ray.t_max_), part.mesh, bone_options, owner, part_hits);
+
+        math::mat4 normal_matrix(scm::math::transpose(inverse_transform));
+        for(auto const& hit : part_hits)
+        {
+            if(hit.position.x != inf)
+            {
+                auto transformed(bone_transform * math::vec4(hit.position.x, hit.position.y, hit.position.z, 1.0));
+                hit.position = math::vec3(transformed.x, transformed.y, transformed.z);
+            }
+            if(hit.normal.x != inf)
+            {
+                auto transformed(normal_matrix * math::vec4(hit.normal.x, hit.normal.y, hit.normal.z, 0.0));
+                hit.normal = scm::math::normalize(math::vec3(transformed.x, transformed.y, transformed.z));
+            }
+            bone_hits.insert(hit);
+        }
+    }
+
+    if(bone_hits.empty())
+    {
+        return;
+    }
+
+    // same semantics as KDTree::ray_test
+    if(options & PickResult::PICK_ONLY_FIRST_FACE && options & PickResult::PICK_ONLY_FIRST_OBJECT)
+    {
+        if(hits.empty() || bone_hits.begin()->distance < hits.begin()->distance)
+        {
+            hits.clear();
+            hits.insert(*bone_hits.begin());
+        }
+    }
+    else if(options & PickResult::PICK_ONLY_FIRST_FACE)
+    {
+        hits.insert(*bone_hits.begin());
+    }
+    else if(options & PickResult::PICK_ONLY_FIRST_OBJECT)
+    {
+        if(hits.empty() || bone_hits.begin()->distance < hits.begin()->distance)
+        {
+            hits = bone_hits;
+        }
+    }
+    else
+    {
+        hits.insert(bone_hits.begin(), bone_hits.end());
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,158 @@
+// class header
+#include <gua/skelanim/utils/BlendTree.hpp>
+
+// guacamole headers
+#include <gua/utils/Logger.hpp>
+#include <gua/skelanim/utils/CompiledAnimation.hpp>
+#include <gua/skelanim/utils/PoseBuffer.hpp>
+#include <gua/skelanim/utils/Skeleton.hpp>
+
+namespace gua
+{
+namespace
+{
+void mark_subtree(Skeleton const& skeleton, unsigned bone, float weight, std::vector<float>& mask)
+{
+    mask[bone] = weight;
+    for(auto const& child : skeleton.get(bone).children)
+    {
+        mark_subtree(skeleton, child, weight, mask);
+    }
+}
+} // namespace
+
+BlendTree::BlendTree() : layers_() {}
+
+unsigned BlendTree::add_layer(Mode mode, float weight)
+{
+    layers_.push_back(Layer{mode, weight, nullptr, {}});
+    return unsigned(layers_.size() - 1);
+}
+
+void BlendTree::set_layer_weight(unsigned layer, float weight) { layers_.at(layer).weight = weight; }
+
+float BlendTree::get_layer_weight(unsigned layer) const { return layers_.at(layer).weight; }
+
+void BlendTree::set_layer_mask(unsigned layer, std::vector<float> const& mask)
+{
+    layers_.at(layer).mask = mask.empty() ? nullptr : std::make_shared<std::vector<float> const>(mask);
+}
+
+unsigned BlendTree::add_motion(unsigned layer, std::shared_ptr<CompiledAnimation const> const& animation, float weight)
+{
+    auto& target(layers_.at(layer));
+
+    std::shared_ptr<PoseBuffer const> reference;
+    if(target.mode == Mode::ADDITIVE && animation)
+    {
+        auto first_frame(std::make_shared<PoseBuffer>());
+        animation->sample(0.0f, *first_frame);
+        reference = first_frame;
+    }
+
+    target.motions.push_back(Motion{animation, reference, 0.0f, weight});
+    return unsigned(target.motions.size() - 1);
+}
+
+void BlendTree::set_motion_time(unsigned layer, unsigned motion, float time_normalized) { layers_.at(layer).motions.at(motion).time = time_normalized; }
+
+void BlendTree::set_motion_weight(unsigned layer, unsigned motion, float weight) { layers_.at(layer).motions.at(motion).weight = weight; }
+
+std::size_t BlendTree::num_layers() const { return layers_.size(); }
+
+std::size_t BlendTree::num_motions(unsigned layer) const { return layers_.at(layer).motions.size(); }
+
+void BlendTree::evaluate(PoseBuffer const& rest_pose, PoseBuffer& pose) const
+{
+    static thread_local PoseBuffer layer_pose;
+    static thread_local PoseBuffer scratch;
+
+    bool has_base(false);
+
+    for(auto const& layer : layers_)
+    {
+        if(layer.weight <= 0.0f || !sample_layer(layer, layer_pose, scratch))
+        {
+            continue;
+        }
+
+        if(!has_base)
+        {
+            has_base = true;
+
+            // a full override needs no base, copying reuses the memory of pose
+            if(layer.mode == Mode::OVERRIDE && layer.weight >= 1.0f && !layer.mask)
+            {
+                pose = layer_pose;
+                continue;
+            }
+
+            // otherwise the first layer is blended with or added to the rest pose
+            pose = rest_pose;
+        }
+
+        if(layer.mode == Mode::ADDITIVE)
+        {
+            pose.add(layer_pose, layer.weight, layer.mask.get());
+        }
+        else
+        {
+            pose.blend(layer_pose, layer.weight, layer.mask.get());
+        }
+    }
+
+    if(!has_base)
+    {
+        pose.reset(pose.size());
+    }
+}
+
+bool BlendTree::sample_layer(Layer const& layer, PoseBuffer& pose, PoseBuffer& scratch) const
+{
+    // incremental weighted average of all motions
+    float accumulated_weight(0.0f);
+
+    for(auto const& motion : layer.motions)
+    {
+        if(motion.weight <= 0.0f || !motion.animation)
+        {
+            continue;
+        }
+
+        PoseBuffer& target(accumulated_weight > 0.0f ? scratch : pose);
+        motion.animation->sample(motion.time, target);
+
+        if(motion.reference)
+        {
+            target.make_additive(*motion.reference);
+        }
+
+        accumulated_weight += motion.weight;
+
+        if(&target == &scratch)
+        {
+            pose.blend(scratch, motion.weight / accumulated_weight);
+        }
+    }
+
+    return accumulated_weight > 0.0f;
+}
+
+std::vector<float> BlendTree::make_mask(Skeleton const& skeleton, std::string const& bone_name, float weight)
+{
+    std::vector<float> mask(skeleton.num_bones(), 0.0f);
+
+    int bone = skeleton.find(bone_name);
+    if(bone >= 0)
+    {
+        mark_subtree(skeleton, unsigned(bone), weight, mask);
+    }
+    else
+    {
+        Logger::LOG_ERROR << "Bone '" << bone_name << "' not found" << std::endl;
+    }
+
+    return mask;
+}
+
+} // namespace gua
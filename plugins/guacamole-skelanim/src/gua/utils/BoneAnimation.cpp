@@ -11,6 +11,7 @@
 #include <fbxsdk.h>
 #endif
 #include <assimp/scene.h> // for ainodeanim
+#include <algorithm>
 
 namespace gua
 {
@@ -63,12 +64,18 @@ BonePose BoneAnimation::calculate_pose(float time) const { return BonePose{calcu
 
 std::string const& BoneAnimation::get_name() const { return name; }
 
+std::vector<Keyframe<scm::math::vec3f>> const& BoneAnimation::get_scaling_keys() const { return scalingKeys; }
+
+std::vector<Keyframe<scm::math::quatf>> const& BoneAnimation::get_rotation_keys() const { return rotationKeys; }
+
+std::vector<Keyframe<scm::math::vec3f>> const& BoneAnimation::get_translation_keys() const { return translationKeys; }
+
 scm::math::vec3f BoneAnimation::interpolate(scm::math::vec3f val1, scm::math::vec3f val2, float factor) const { return val1 * (1 - factor) + val2 * factor; }
 
 scm::math::quatf BoneAnimation::interpolate(scm::math::quatf val1, scm::math::quatf val2, float factor) const { return normalize(slerp(val1, val2, factor)); }
 
 template <class T>
-int BoneAnimation::find_key(float animationTime, std::vector<Keyframe<T>> keys) const
+int BoneAnimation::find_key(float animationTime, std::vector<Keyframe<T>> const& keys) const
 {
     if(keys.size() < 1)
     {
@@ -76,19 +83,14 @@ int BoneAnimation::find_key(float animationTime, std::vector<Keyframe<T>> keys)
         assert(false);
     }
 
-    for(int i = -1; i < int(keys.size() - 1); ++i)
-    {
-        if(animationTime < (float)keys[i + 1].time)
-        {
-            return i;
-        }
-    }
+    // first key after the given time, the one before it is the result
+    auto next = std::upper_bound(keys.begin(), keys.end(), animationTime, [](float time, Keyframe<T> const& key) { return time < (float)key.time; });
 
-    return keys.size() - 1;
+    return int(next - keys.begin()) - 1;
 }
 
 template <class T>
-T BoneAnimation::calculate_value(float time, std::vector<Keyframe<T>> keys) const
+T BoneAnimation::calculate_value(float time, std::vector<Keyframe<T>> const& keys) const
 {
     if(keys.size() == 1)
     {
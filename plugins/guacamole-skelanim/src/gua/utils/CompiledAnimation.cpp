@@ -0,0 +1,253 @@
+// class header
+#include <gua/skelanim/utils/CompiledAnimation.hpp>
+
+// guacamole headers
+#include <gua/skelanim/utils/PoseBuffer.hpp>
+#include <gua/skelanim/utils/PoseKernels.hpp>
+#include <gua/skelanim/utils/SkeletalAnimation.hpp>
+#include <gua/skelanim/utils/BoneAnimation.hpp>
+#include <gua/skelanim/utils/Skeleton.hpp>
+
+// external headers
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+namespace gua
+{
+namespace
+{
+void append_value(scm::math::vec3f const& value, std::array<std::vector<float>, 4>& values)
+{
+    values[0].push_back(value.x);
+    values[1].push_back(value.y);
+    values[2].push_back(value.z);
+}
+
+void append_value(scm::math::quatf const& value, std::array<std::vector<float>, 4>& values)
+{
+    values[0].push_back(value.x);
+    values[1].push_back(value.y);
+    values[2].push_back(value.z);
+    values[3].push_back(value.w);
+}
+
+// channels without keys get a single key with the default value
+template <class T>
+void append(std::vector<Keyframe<T>> const& keys, T const& fallback, std::vector<float>& times, std::array<std::vector<float>, 4>& values)
+{
+    if(keys.empty())
+    {
+        times.push_back(0.0f);
+        append_value(fallback, values);
+    }
+
+    for(auto const& key : keys)
+    {
+        times.push_back(float(key.time));
+        append_value(key.value, values);
+    }
+}
+
+// per-thread scratch space, one entry per track
+struct SampleScratch
+{
+    std::vector<unsigned> lower;
+    std::vector<unsigned> upper;
+    std::vector<float> factors;
+    std::array<std::vector<float>, 4> a;
+    std::array<std::vector<float>, 4> b;
+
+    void resize(std::size_t tracks)
+    {
+        lower.resize(tracks);
+        upper.resize(tracks);
+        factors.resize(tracks);
+        for(unsigned c = 0; c < 4; ++c)
+        {
+            a[c].resize(tracks);
+            b[c].resize(tracks);
+        }
+    }
+};
+
+} // namespace
+
+CompiledAnimation::CompiledAnimation(SkeletalAnimation const& anim, Skeleton const& skeleton)
+    : name_(anim.get_name()), duration_(anim.get_duration()), num_frames_(float(anim.get_num_frames())), num_bones_(skeleton.num_bones()), channels_()
+{
+    // resolve bone names once, later bones with the same name win like in Skeleton
+    std::map<std::string, unsigned> bone_indices;
+    for(std::size_t i = 0; i < skeleton.num_bones(); ++i)
+    {
+        bone_indices[skeleton.get(i).name] = unsigned(i);
+    }
+
+    channels_[0].first_component = PoseBuffer::SCALING_X;
+    channels_[0].num_components = 3;
+    channels_[1].first_component = PoseBuffer::ROTATION_X;
+    channels_[1].num_components = 4;
+    channels_[2].first_component = PoseBuffer::TRANSLATION_X;
+    channels_[2].num_components = 3;
+
+    for(auto& channel : channels_)
+    {
+        channel.track_offsets.push_back(0);
+    }
+
+    for(BoneAnimation const& bone_anim : anim.get_bone_animations())
+    {
+        auto bone = bone_indices.find(bone_anim.get_name());
+        if(bone == bone_indices.end())
+        {
+            continue;
+        }
+
+        append(bone_anim.get_scaling_keys(), scm::math::vec3f(1.0f), channels_[0].times, channels_[0].values);
+        append(bone_anim.get_rotation_keys(), scm::math::quatf::identity(), channels_[1].times, channels_[1].values);
+        append(bone_anim.get_translation_keys(), scm::math::vec3f(0.0f), channels_[2].times, channels_[2].values);
+
+        for(auto& channel : channels_)
+        {
+            channel.bones.push_back(bone->second);
+            channel.track_offsets.push_back(unsigned(channel.times.size()));
+        }
+    }
+}
+
+void CompiledAnimation::sample(float time_normalized, PoseBuffer& pose, Cursor* cursor) const
+{
+    if(pose.size() != num_bones_)
+    {
+        pose.reset(num_bones_);
+    }
+    else
+    {
+        std::fill(pose.animated.begin(), pose.animated.end(), 0);
+    }
+
+    std::size_t num_tracks(0);
+    for(auto const& channel : channels_)
+    {
+        num_tracks += channel.bones.size();
+    }
+
+    if(cursor && cursor->keys.size() != num_tracks)
+    {
+        cursor->keys.assign(num_tracks, 0);
+    }
+
+    // keyframe times are stored in frames
+    float const frame = time_normalized * num_frames_;
+
+    unsigned* keys = cursor ? cursor->keys.data() : nullptr;
+    for(auto const& channel : channels_)
+    {
+        sample(channel, frame, pose, keys);
+        if(keys)
+        {
+            keys += channel.bones.size();
+        }
+    }
+}
+
+void CompiledAnimation::sample(Channel const& channel, float frame, PoseBuffer& pose, unsigned* cursor) const
+{
+    std::size_t const tracks(channel.bones.size());
+    if(tracks == 0)
+    {
+        return;
+    }
+
+    static thread_local SampleScratch scratch;
+    scratch.resize(tracks);
+
+    float const* times = channel.times.data();
+
+    // find the last key at or before the given frame for each track
+    for(std::size_t t = 0; t < tracks; ++t)
+    {
+        unsigned const begin = channel.track_offsets[t];
+        unsigned const end = channel.track_offsets[t + 1];
+
+        auto matches = [&](unsigned key) { return key < end && times[key] <= frame && (key + 1 == end || frame < times[key + 1]); };
+
+        unsigned key = cursor ? begin + cursor[t] : end;
+        if(!matches(key))
+        {
+            if(matches(key + 1))
+            {
+                ++key;
+            }
+            else
+            {
+                key = unsigned(std::upper_bound(times + begin, times + end, frame) - times);
+                key = key > begin ? key - 1 : begin;
+            }
+        }
+
+        if(cursor)
+        {
+            cursor[t] = key - begin;
+        }
+
+        unsigned const next = std::min(key + 1, end - 1);
+        scratch.lower[t] = key;
+        scratch.upper[t] = next;
+        scratch.factors[t] = (next == key || frame <= times[key]) ? 0.0f : (frame - times[key]) / (times[next] - times[key]);
+    }
+
+    // gather both keys of all tracks into contiguous arrays
+    for(unsigned c = 0; c < channel.num_components; ++c)
+    {
+        float const* values = channel.values[c].data();
+        float* a = scratch.a[c].data();
+        float* b = scratch.b[c].data();
+        for(std::size_t t = 0; t < tracks; ++t)
+        {
+            a[t] = values[scratch.lower[t]];
+            b[t] = values[scratch.upper[t]];
+        }
+    }
+
+    float const* factors = scratch.factors.data();
+
+    if(channel.num_components == 4)
+    {
+        // normalized lerp instead of slerp, see pose_kernels::nlerp for the error
+        float* const a[4] = {scratch.a[0].data(), scratch.a[1].data(), scratch.a[2].data(), scratch.a[3].data()};
+        float const* const b[4] = {scratch.b[0].data(), scratch.b[1].data(), scratch.b[2].data(), scratch.b[3].data()};
+        pose_kernels::nlerp(a, b, factors, tracks);
+    }
+    else
+    {
+        for(unsigned c = 0; c < channel.num_components; ++c)
+        {
+            pose_kernels::lerp(scratch.a[c].data(), scratch.b[c].data(), factors, tracks);
+        }
+    }
+
+    // scatter into the bone-indexed pose
+    for(unsigned c = 0; c < channel.num_components; ++c)
+    {
+        float const* a = scratch.a[c].data();
+        float* target = pose.values[channel.first_component + c].data();
+        for(std::size_t t = 0; t < tracks; ++t)
+        {
+            target[channel.bones[t]] = a[t];
+        }
+    }
+
+    for(std::size_t t = 0; t < tracks; ++t)
+    {
+        pose.animated[channel.bones[t]] = 1;
+    }
+}
+
+std::size_t CompiledAnimation::num_bones() const { return num_bones_; }
+
+double CompiledAnimation::get_duration() const { return duration_; }
+
+std::string const& CompiledAnimation::get_name() const { return name_; }
+
+} // namespace gua
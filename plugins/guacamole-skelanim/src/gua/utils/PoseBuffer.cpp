@@ -0,0 +1,198 @@
+// class header
+#include <gua/skelanim/utils/PoseBuffer.hpp>
+
+// guacamole headers
+#include <gua/skelanim/utils/BonePose.hpp>
+#include <gua/skelanim/utils/PoseKernels.hpp>
+
+// external headers
+#include <algorithm>
+#include <cmath>
+
+namespace gua
+{
+PoseBuffer::PoseBuffer() : values(), animated() {}
+
+PoseBuffer::PoseBuffer(std::size_t num_bones) : PoseBuffer() { reset(num_bones); }
+
+void PoseBuffer::reset(std::size_t num_bones)
+{
+    for(auto& component : values)
+    {
+        component.assign(num_bones, 0.0f);
+    }
+    animated.assign(num_bones, 0);
+}
+
+std::size_t PoseBuffer::size() const { return animated.size(); }
+
+void PoseBuffer::set(std::size_t bone, scm::math::mat4f const& transform)
+{
+    scm::math::vec3f const scaling{scm::math::length(scm::math::vec3f{transform[0], transform[1], transform[2]}),
+                                   scm::math::length(scm::math::vec3f{transform[4], transform[5], transform[6]}),
+                                   scm::math::length(scm::math::vec3f{transform[8], transform[9], transform[10]})};
+
+    scm::math::mat4f rotation{transform};
+    for(unsigned column = 0; column < 3; ++column)
+    {
+        for(unsigned row = 0; row < 3; ++row)
+        {
+            rotation[column * 4 + row] /= scaling[column] > 0.0f ? scaling[column] : 1.0f;
+        }
+    }
+    auto const q = scm::math::quatf::from_matrix(rotation);
+
+    values[SCALING_X][bone] = scaling.x;
+    values[SCALING_Y][bone] = scaling.y;
+    values[SCALING_Z][bone] = scaling.z;
+    values[ROTATION_X][bone] = q.x;
+    values[ROTATION_Y][bone] = q.y;
+    values[ROTATION_Z][bone] = q.z;
+    values[ROTATION_W][bone] = q.w;
+    values[TRANSLATION_X][bone] = transform[12];
+    values[TRANSLATION_Y][bone] = transform[13];
+    values[TRANSLATION_Z][bone] = transform[14];
+    animated[bone] = 1;
+}
+
+void PoseBuffer::blend(PoseBuffer const& pose2, float blend_factor, std::vector<float> const* bone_weights)
+{
+    std::size_t const count(std::min(size(), pose2.size()));
+
+    // per-bone weight of the second pose, bones missing in this pose are taken
+    // from the second one unless they are masked out
+    static thread_local std::vector<float> weights;
+    weights.resize(count);
+    for(std::size_t b = 0; b < count; ++b)
+    {
+        float const mask = bone_weights && b < bone_weights->size() ? (*bone_weights)[b] : 1.0f;
+        weights[b] = pose2.animated[b] ? (animated[b] ? blend_factor * mask : (mask > 0.0f ? 1.0f : 0.0f)) : 0.0f;
+    }
+
+    for(unsigned c : {SCALING_X, SCALING_Y, SCALING_Z, TRANSLATION_X, TRANSLATION_Y, TRANSLATION_Z})
+    {
+        pose_kernels::lerp(values[c].data(), pose2.values[c].data(), weights.data(), count);
+    }
+
+    // normalized lerp instead of slerp, see pose_kernels::nlerp for the error
+    float* const a[4] = {values[ROTATION_X].data(), values[ROTATION_Y].data(), values[ROTATION_Z].data(), values[ROTATION_W].data()};
+    float const* const b[4] = {pose2.values[ROTATION_X].data(), pose2.values[ROTATION_Y].data(), pose2.values[ROTATION_Z].data(), pose2.values[ROTATION_W].data()};
+    pose_kernels::nlerp(a, b, weights.data(), count);
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        animated[i] |= (weights[i] > 0.0f);
+    }
+}
+
+void PoseBuffer::make_additive(PoseBuffer const& reference)
+{
+    std::size_t const count(std::min(size(), reference.size()));
+
+    float* tx = values[TRANSLATION_X].data();
+    float* ty = values[TRANSLATION_Y].data();
+    float* tz = values[TRANSLATION_Z].data();
+    float* sx = values[SCALING_X].data();
+    float* sy = values[SCALING_Y].data();
+    float* sz = values[SCALING_Z].data();
+    float* qx = values[ROTATION_X].data();
+    float* qy = values[ROTATION_Y].data();
+    float* qz = values[ROTATION_Z].data();
+    float* qw = values[ROTATION_W].data();
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        if(!animated[i] || !reference.animated[i])
+        {
+            continue;
+        }
+
+        tx[i] -= reference.values[TRANSLATION_X][i];
+        ty[i] -= reference.values[TRANSLATION_Y][i];
+        tz[i] -= reference.values[TRANSLATION_Z][i];
+
+        sx[i] = reference.values[SCALING_X][i] != 0.0f ? sx[i] / reference.values[SCALING_X][i] : 1.0f;
+        sy[i] = reference.values[SCALING_Y][i] != 0.0f ? sy[i] / reference.values[SCALING_Y][i] : 1.0f;
+        sz[i] = reference.values[SCALING_Z][i] != 0.0f ? sz[i] / reference.values[SCALING_Z][i] : 1.0f;
+
+        // rotation * conjugate(reference rotation)
+        float const rx = -reference.values[ROTATION_X][i];
+        float const ry = -reference.values[ROTATION_Y][i];
+        float const rz = -reference.values[ROTATION_Z][i];
+        float const rw = reference.values[ROTATION_W][i];
+
+        float const x = qw[i] * rx + qx[i] * rw + qy[i] * rz - qz[i] * ry;
+        float const y = qw[i] * ry - qx[i] * rz + qy[i] * rw + qz[i] * rx;
+        float const z = qw[i] * rz + qx[i] * ry - qy[i] * rx + qz[i] * rw;
+        float const w = qw[i] * rw - qx[i] * rx - qy[i] * ry - qz[i] * rz;
+
+        qx[i] = x;
+        qy[i] = y;
+        qz[i] = z;
+        qw[i] = w;
+    }
+}
+
+void PoseBuffer::add(PoseBuffer const& additive, float weight, std::vector<float> const* bone_weights)
+{
+    std::size_t const count(std::min(size(), additive.size()));
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        float const mask = bone_weights && i < bone_weights->size() ? (*bone_weights)[i] : 1.0f;
+        float const f = animated[i] && additive.animated[i] ? weight * mask : 0.0f;
+
+        if(f == 0.0f)
+        {
+            continue;
+        }
+
+        values[TRANSLATION_X][i] += additive.values[TRANSLATION_X][i] * f;
+        values[TRANSLATION_Y][i] += additive.values[TRANSLATION_Y][i] * f;
+        values[TRANSLATION_Z][i] += additive.values[TRANSLATION_Z][i] * f;
+
+        values[SCALING_X][i] *= 1.0f + (additive.values[SCALING_X][i] - 1.0f) * f;
+        values[SCALING_Y][i] *= 1.0f + (additive.values[SCALING_Y][i] - 1.0f) * f;
+        values[SCALING_Z][i] *= 1.0f + (additive.values[SCALING_Z][i] - 1.0f) * f;
+
+        // scale the delta rotation by normalized lerp from identity
+        float dx = additive.values[ROTATION_X][i];
+        float dy = additive.values[ROTATION_Y][i];
+        float dz = additive.values[ROTATION_Z][i];
+        float dw = additive.values[ROTATION_W][i];
+        float const sign = dw < 0.0f ? -f : f;
+        dx *= sign;
+        dy *= sign;
+        dz *= sign;
+        dw = dw * sign + (1.0f - f);
+
+        // delta * rotation
+        float const qx = values[ROTATION_X][i];
+        float const qy = values[ROTATION_Y][i];
+        float const qz = values[ROTATION_Z][i];
+        float const qw = values[ROTATION_W][i];
+
+        float const x = dw * qx + dx * qw + dy * qz - dz * qy;
+        float const y = dw * qy - dx * qz + dy * qw + dz * qx;
+        float const z = dw * qz + dx * qy - dy * qx + dz * qw;
+        float const w = dw * qw - dx * qx - dy * qy - dz * qz;
+
+        float const length_sq = x * x + y * y + z * z + w * w;
+        float const scale = length_sq > 0.0f ? 1.0f / std::sqrt(length_sq) : 0.0f;
+
+        values[ROTATION_X][i] = x * scale;
+        values[ROTATION_Y][i] = y * scale;
+        values[ROTATION_Z][i] = z * scale;
+        values[ROTATION_W][i] = w * scale;
+    }
+}
+
+scm::math::mat4f PoseBuffer::to_matrix(std::size_t bone) const
+{
+    return BonePose{scm::math::vec3f{values[SCALING_X][bone], values[SCALING_Y][bone], values[SCALING_Z][bone]},
+                    scm::math::quatf{values[ROTATION_W][bone], values[ROTATION_X][bone], values[ROTATION_Y][bone], values[ROTATION_Z][bone]},
+                    scm::math::vec3f{values[TRANSLATION_X][bone], values[TRANSLATION_Y][bone], values[TRANSLATION_Z][bone]}}
+        .to_matrix();
+}
+
+} // namespace gua
@@ -0,0 +1,169 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+
+// class header
+#include <gua/skelanim/utils/PoseKernels.hpp>
+
+// external headers
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <emmintrin.h>
+#define GUA_POSE_KERNELS_SSE2 1
+#endif
+
+namespace gua
+{
+namespace pose_kernels
+{
+namespace
+{
+#if defined(GUA_POSE_KERNELS_SSE2)
+__attribute__((target("sse2"))) void lerp_sse2(float* a, float const* b, float const* weights, std::size_t count)
+{
+    std::size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128 const va = _mm_loadu_ps(a + i);
+        __m128 const vb = _mm_loadu_ps(b + i);
+        _mm_storeu_ps(a + i, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), _mm_loadu_ps(weights + i))));
+    }
+
+    lerp_scalar(a + i, b + i, weights + i, count - i);
+}
+
+// four quaternions per iteration, the components are already in separate arrays
+__attribute__((target("sse2"))) void nlerp_sse2(float* const a[4], float const* const b[4], float const* weights, std::size_t count)
+{
+    __m128 const zero = _mm_setzero_ps();
+    __m128 const one = _mm_set1_ps(1.0f);
+    __m128 const sign_bit = _mm_set1_ps(-0.0f);
+
+    std::size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128 const ax = _mm_loadu_ps(a[0] + i);
+        __m128 const ay = _mm_loadu_ps(a[1] + i);
+        __m128 const az = _mm_loadu_ps(a[2] + i);
+        __m128 const aw = _mm_loadu_ps(a[3] + i);
+        __m128 const bx = _mm_loadu_ps(b[0] + i);
+        __m128 const by = _mm_loadu_ps(b[1] + i);
+        __m128 const bz = _mm_loadu_ps(b[2] + i);
+        __m128 const bw = _mm_loadu_ps(b[3] + i);
+        __m128 const weight = _mm_loadu_ps(weights + i);
+
+        __m128 const dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_add_ps(_mm_mul_ps(az, bz), _mm_mul_ps(aw, bw)));
+        __m128 const w2 = _mm_xor_ps(weight, _mm_and_ps(_mm_cmplt_ps(dot, zero), sign_bit));
+        __m128 const w1 = _mm_sub_ps(one, weight);
+
+        __m128 const x = _mm_add_ps(_mm_mul_ps(ax, w1), _mm_mul_ps(bx, w2));
+        __m128 const y = _mm_add_ps(_mm_mul_ps(ay, w1), _mm_mul_ps(by, w2));
+        __m128 const z = _mm_add_ps(_mm_mul_ps(az, w1), _mm_mul_ps(bz, w2));
+        __m128 const w = _mm_add_ps(_mm_mul_ps(aw, w1), _mm_mul_ps(bw, w2));
+
+        // full precision sqrt and division, the result matches the scalar path
+        __m128 const length_sq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(w, w)));
+        __m128 const scale = _mm_and_ps(_mm_cmpgt_ps(length_sq, zero), _mm_div_ps(one, _mm_sqrt_ps(length_sq)));
+
+        _mm_storeu_ps(a[0] + i, _mm_mul_ps(x, scale));
+        _mm_storeu_ps(a[1] + i, _mm_mul_ps(y, scale));
+        _mm_storeu_ps(a[2] + i, _mm_mul_ps(z, scale));
+        _mm_storeu_ps(a[3] + i, _mm_mul_ps(w, scale));
+    }
+
+    float* const a_rest[4] = {a[0] + i, a[1] + i, a[2] + i, a[3] + i};
+    float const* const b_rest[4] = {b[0] + i, b[1] + i, b[2] + i, b[3] + i};
+    nlerp_scalar(a_rest, b_rest, weights + i, count - i);
+}
+#endif
+
+typedef void (*LerpFunction)(float*, float const*, float const*, std::size_t);
+typedef void (*NlerpFunction)(float* const*, float const* const*, float const*, std::size_t);
+
+LerpFunction select_lerp_function()
+{
+#if defined(GUA_POSE_KERNELS_SSE2)
+    if(__builtin_cpu_supports("sse2"))
+    {
+        return &lerp_sse2;
+    }
+#endif
+    return &lerp_scalar;
+}
+
+NlerpFunction select_nlerp_function()
+{
+#if defined(GUA_POSE_KERNELS_SSE2)
+    if(__builtin_cpu_supports("sse2"))
+    {
+        return &nlerp_sse2;
+    }
+#endif
+    return &nlerp_scalar;
+}
+} // namespace
+
+void lerp(float* a, float const* b, float const* weights, std::size_t count)
+{
+    static const LerpFunction function = select_lerp_function();
+    function(a, b, weights, count);
+}
+
+void lerp_scalar(float* a, float const* b, float const* weights, std::size_t count)
+{
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        a[i] += (b[i] - a[i]) * weights[i];
+    }
+}
+
+void nlerp(float* const a[4], float const* const b[4], float const* weights, std::size_t count)
+{
+    static const NlerpFunction function = select_nlerp_function();
+    function(a, b, weights, count);
+}
+
+void nlerp_scalar(float* const a[4], float const* const b[4], float const* weights, std::size_t count)
+{
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        float const dot = a[0][i] * b[0][i] + a[1][i] * b[1][i] + a[2][i] * b[2][i] + a[3][i] * b[3][i];
+        float const w2 = dot < 0.0f ? -weights[i] : weights[i];
+        float const w1 = 1.0f - weights[i];
+
+        float const x = a[0][i] * w1 + b[0][i] * w2;
+        float const y = a[1][i] * w1 + b[1][i] * w2;
+        float const z = a[2][i] * w1 + b[2][i] * w2;
+        float const w = a[3][i] * w1 + b[3][i] * w2;
+
+        float const length_sq = x * x + y * y + z * z + w * w;
+        float const scale = length_sq > 0.0f ? 1.0f / std::sqrt(length_sq) : 0.0f;
+
+        a[0][i] = x * scale;
+        a[1][i] = y * scale;
+        a[2][i] = z * scale;
+        a[3][i] = w * scale;
+    }
+}
+
+} // namespace pose_kernels
+} // namespace gua
@@ -66,4 +66,8 @@ double SkeletalAnimation::get_duration() const { return duration; }
 
 std::string const& SkeletalAnimation::get_name() const { return name; }
 
+unsigned SkeletalAnimation::get_num_frames() const { return numFrames; }
+
+std::vector<BoneAnimation> const& SkeletalAnimation::get_bone_animations() const { return boneAnims; }
+
 } // namespace gua
\ No newline at end of file
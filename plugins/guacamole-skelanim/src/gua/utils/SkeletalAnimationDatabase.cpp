@@ -0,0 +1,112 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+
+// class header
+#include <gua/skelanim/utils/SkeletalAnimationDatabase.hpp>
+
+// guacamole headers
+#include <gua/skelanim/renderer/SkeletalAnimationLoader.hpp>
+#include <gua/skelanim/utils/Skeleton.hpp>
+
+// external headers
+#include <boost/functional/hash.hpp>
+
+namespace gua
+{
+////////////////////////////////////////////////////////////////////////////////
+std::vector<SkeletalAnimationDatabase::mapped_type> SkeletalAnimationDatabase::load(std::string const& file_name, std::string const& animation_name)
+{
+    // serializes loading, so concurrent requests for one file load it once
+    std::lock_guard<std::mutex> lock(load_mutex_);
+
+    std::string const file_key(make_key(file_name, animation_name));
+    auto loaded(loaded_files_.find(file_key));
+
+    if(loaded == loaded_files_.end())
+    {
+        std::vector<std::string> clip_keys;
+
+        for(auto& anim : SkeletalAnimationLoader{}.load_animation(file_name, animation_name))
+        {
+            std::string clip_key(make_key(file_name, anim.get_name()));
+            add(clip_key, std::make_shared<SkeletalAnimation const>(std::move(anim)));
+            clip_keys.push_back(clip_key);
+        }
+
+        loaded = loaded_files_.insert(std::make_pair(file_key, clip_keys)).first;
+    }
+
+    std::vector<mapped_type> clips;
+    for(auto const& clip_key : loaded->second)
+    {
+        auto clip(lookup(clip_key));
+        if(clip)
+        {
+            clips.push_back(clip);
+        }
+    }
+
+    return clips;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::shared_ptr<CompiledAnimation const> SkeletalAnimationDatabase::compile(mapped_type const& clip, Skeleton const& skeleton)
+{
+    // compiled clips only depend on the bone names and their order
+    std::size_t bones_hash(skeleton.num_bones());
+    for(auto const& bone : skeleton.get_bones())
+    {
+        boost::hash_combine(bones_hash, bone.name);
+    }
+
+    auto const key(std::make_pair(clip.get(), bones_hash));
+
+    std::lock_guard<std::mutex> lock(compile_mutex_);
+
+    auto entry(compiled_.find(key));
+    if(entry != compiled_.end())
+    {
+        auto compiled(entry->second.compiled.lock());
+
+        // the address may have been reused by another clip
+        if(compiled && entry->second.source.lock() == clip)
+        {
+            return compiled;
+        }
+    }
+
+    // drop entries of clips nobody uses anymore
+    for(auto it(compiled_.begin()); it != compiled_.end();)
+    {
+        it = it->second.compiled.expired() ? compiled_.erase(it) : std::next(it);
+    }
+
+    auto compiled(std::make_shared<CompiledAnimation const>(*clip, skeleton));
+    compiled_[key] = CompiledEntry{clip, compiled};
+
+    return compiled;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string SkeletalAnimationDatabase::make_key(std::string const& file_name, std::string const& clip_name) { return file_name + "|" + clip_name; }
+
+} // namespace gua
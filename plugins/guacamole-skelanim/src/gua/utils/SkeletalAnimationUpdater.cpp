@@ -0,0 +1,126 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+
+// class header
+#include <gua/skelanim/utils/SkeletalAnimationUpdater.hpp>
+
+// external headers
+#include <algorithm>
+
+namespace gua
+{
+////////////////////////////////////////////////////////////////////////////////
+SkeletalAnimationUpdater::SkeletalAnimationUpdater() : workers_(), jobs_(), mutex_(), job_available_(), running_(false)
+{
+    // the application thread is busy with its own frame
+    start(std::max(2u, std::thread::hardware_concurrency()) - 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SkeletalAnimationUpdater::~SkeletalAnimationUpdater() { stop(); }
+
+////////////////////////////////////////////////////////////////////////////////
+SkeletalAnimationUpdater::Handle SkeletalAnimationUpdater::submit(std::shared_ptr<Palette> const& palette, Job const& job)
+{
+    std::packaged_task<std::shared_ptr<Palette const>()> task([palette, job]() {
+        job(*palette);
+        return std::shared_ptr<Palette const>(palette);
+    });
+
+    Handle handle(task.get_future().share());
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(std::move(task));
+    }
+    job_available_.notify_one();
+
+    return handle;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SkeletalAnimationUpdater::set_num_threads(unsigned num_threads)
+{
+    stop();
+    start(std::max(1u, num_threads));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned SkeletalAnimationUpdater::get_num_threads() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return unsigned(workers_.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SkeletalAnimationUpdater::start(unsigned num_threads)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = true;
+    for(unsigned i(0); i < num_threads; ++i)
+    {
+        workers_.emplace_back(&SkeletalAnimationUpdater::work, this);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SkeletalAnimationUpdater::stop()
+{
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+        workers.swap(workers_);
+    }
+    job_available_.notify_all();
+
+    // workers finish all queued jobs before they return
+    for(auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SkeletalAnimationUpdater::work()
+{
+    while(true)
+    {
+        std::packaged_task<std::shared_ptr<Palette const>()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            job_available_.wait(lock, [this]() { return !running_ || !jobs_.empty(); });
+
+            if(jobs_.empty())
+            {
+                return;
+            }
+
+            task = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        task();
+    }
+}
+
+} // namespace gua
@@ -7,6 +7,9 @@
 #include <gua/skelanim/utils/BonePose.hpp>
 #include <gua/skelanim/utils/SkeletalAnimation.hpp>
 #include <gua/skelanim/utils/Skeleton.hpp>
+#include <gua/skelanim/utils/CompiledAnimation.hpp>
+#include <gua/skelanim/utils/PoseBuffer.hpp>
+#include <gua/skelanim/utils/BlendTree.hpp>
 
 namespace gua
 {
@@ -49,5 +52,43 @@ std::vector<scm::math::mat4f> from_anim(Skeleton const& skeleton, unsigned start
 
 std::vector<scm::math::mat4f> from_hierarchy(Skeleton const& skeleton, unsigned start_node) { return skeleton.accumulate_matrices(start_node, SkeletalPose{}); }
 
+void from_anim(Skeleton const& skeleton, unsigned start_node, float time_normalized, CompiledAnimation const& anim, std::vector<scm::math::mat4f>& transforms)
+{
+    static thread_local PoseBuffer pose;
+
+    anim.sample(time_normalized, pose);
+
+    skeleton.accumulate_matrices(start_node, pose, transforms);
+}
+
+void blend_anims(Skeleton const& skeleton,
+                 unsigned start_node,
+                 float blend_factor,
+                 float time_normalized1,
+                 float time_normalized2,
+                 CompiledAnimation const& anim_1,
+                 CompiledAnimation const& anim_2,
+                 std::vector<scm::math::mat4f>& transforms)
+{
+    static thread_local PoseBuffer pose1;
+    static thread_local PoseBuffer pose2;
+
+    anim_1.sample(time_normalized1, pose1);
+    anim_2.sample(time_normalized2, pose2);
+
+    pose1.blend(pose2, blend_factor);
+
+    skeleton.accumulate_matrices(start_node, pose1, transforms);
+}
+
+void from_blend_tree(Skeleton const& skeleton, unsigned start_node, BlendTree const& tree, std::vector<scm::math::mat4f>& transforms)
+{
+    static thread_local PoseBuffer pose;
+
+    tree.evaluate(skeleton.get_rest_pose(), pose);
+
+    skeleton.accumulate_matrices(start_node, pose, transforms);
+}
+
 } // namespace SkeletalTransformation
 } // namespace gua
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <gua/utils/Logger.hpp>
 #include <gua/skelanim/utils/SkeletalPose.hpp>
 #include <gua/skelanim/utils/BonePose.hpp>
+#include <gua/skelanim/utils/PoseBuffer.hpp>
 #include <gua/skelanim/utils/Bone.hpp>
 
 // external headers
@@ -51,6 +52,7 @@ Skeleton::Skeleton(aiScene const& scene)
     set_offsets(bone_offsets);
 
     store_mapping();
+    store_rest_pose();
 }
 
 #ifdef GUACAMOLE_FBX
@@ -152,13 +154,20 @@ Skeleton::Skeleton(FbxScene& scene)
         }
     }
     store_mapping();
+    store_rest_pose();
 }
 
 #endif
 
 std::vector<Bone> const& Skeleton::get_bones() const { return m_bones; }
 
-void Skeleton::set_bones(std::vector<Bone> const& bones) { m_bones = bones; }
+void Skeleton::set_bones(std::vector<Bone> const& bones)
+{
+    m_bones = bones;
+    m_mapping.clear();
+    store_mapping();
+    store_rest_pose();
+}
 
 int Skeleton::find(std::string const& name) const
 {
@@ -175,6 +184,8 @@ int Skeleton::find(std::string const& name) const
 
 gua::Bone const& Skeleton::get(std::size_t index) const { return m_bones[index]; }
 
+PoseBuffer const& Skeleton::get_rest_pose() const { return m_rest_pose; }
+
 std::map<std::string, int> const& Skeleton::get_mapping() const { return m_mapping; }
 
 void Skeleton::store_mapping()
@@ -189,6 +200,15 @@ void Skeleton::store_mapping()
     }
 }
 
+void Skeleton::store_rest_pose()
+{
+    m_rest_pose.reset(m_bones.size());
+    for(std::size_t i = 0; i < m_bones.size(); ++i)
+    {
+        m_rest_pose.set(i, m_bones[i].idle_matrix);
+    }
+}
+
 void Skeleton::set_offsets(std::map<std::string, scm::math::mat4f> const& offsets)
 {
     for(auto& bone : m_bones)
@@ -227,6 +247,26 @@ void Skeleton::accumulate_matrices(unsigned index_bone, std::vector<scm::math::m
     }
 }
 
+void Skeleton::accumulate_matrices(unsigned index_bone, PoseBuffer const& pose, std::vector<scm::math::mat4f>& transforms) const
+{
+    transforms.resize(num_bones(), scm::math::mat4f::identity());
+    accumulate_pose(index_bone, pose, transforms, scm::math::mat4f::identity());
+}
+
+void Skeleton::accumulate_pose(unsigned index_bone, PoseBuffer const& pose, std::vector<scm::math::mat4f>& transforms, scm::math::mat4f const& parentTransform) const
+{
+    auto const& bone = m_bones[index_bone];
+
+    scm::math::mat4f finalTransformation = parentTransform * (index_bone < pose.size() && pose.animated[index_bone] ? pose.to_matrix(index_bone) : bone.idle_matrix);
+
+    transforms[index_bone] = finalTransformation * bone.offset_matrix;
+
+    for(auto const& index_child : bone.children)
+    {
+        accumulate_pose(index_child, pose, transforms, finalTransformation);
+    }
+}
+
 std::size_t Skeleton::num_bones() const { return m_bones.size(); }
 
 } // namespace gua
\ No newline at end of file
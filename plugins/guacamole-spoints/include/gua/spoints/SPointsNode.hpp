@@ -57,6 +57,8 @@ class GUA_SPOINTS_DLL SPointsNode : public GeometryNode
 
     void update_cache() override;
 
+    std::size_t get_geometry_revision() const override;
+
     inline float get_screen_space_point_size() const { return screen_space_point_size_; }
     inline void set_screen_space_point_size(float point_size) { screen_space_point_size_ = point_size; }
 
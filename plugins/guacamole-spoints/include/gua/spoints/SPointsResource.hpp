@@ -103,6 +103,14 @@ class GUA_SPOINTS_DLL SPointsResource : public GeometryResource
         return spoints::SPointsStats();
     }
 
+    /**
+     * Records the received stream to a file, which can be replayed by using
+     * "file://<filename>" as server endpoint. Fails while no stream has been
+     * opened yet, i.e. before the resource has been drawn once.
+     */
+    bool start_recording(std::string const& filename);
+    void stop_recording();
+
     void push_matrix_package(spoints::camera_matrix_package const& cam_mat_package);
 
     void update_buffers(RenderContext const& ctx, Pipeline& pipe);
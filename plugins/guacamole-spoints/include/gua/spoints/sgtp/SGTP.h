@@ -2,7 +2,7 @@
 #define SGTP_PROTOCOL_HEADER
 // compatability header of the streaming geometry transmission protocol
 
-#include "./versions/v0.x.x/streaming_geometry_transmission_protocol_v_0_2_3.h"
+#include "./versions/v0.x.x/streaming_geometry_transmission_protocol_v_0_2_4.h"
 
 namespace SGTP {
 
@@ -16,6 +16,7 @@ namespace SGTP {
   using header_data_t = _header_data_t;
   using vertex_data_t = _vertex_data_t;
   using texture_bounding_box_t = _texture_bounding_box_t;
+  using geometry_chunk_t = _geometry_chunk_t;
 
   /* helper function declarations */
   /* ============================ */
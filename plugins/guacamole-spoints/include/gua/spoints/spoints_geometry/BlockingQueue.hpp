@@ -0,0 +1,134 @@
+#ifndef SPOINTS_BLOCKINGQUEUE_HPP
+#define SPOINTS_BLOCKINGQUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+namespace spoints
+{
+/**
+ * Queue handing items from one pipeline stage to the next.
+ *
+ * pop() blocks until an item is available, so consumers sleep instead of
+ * polling. A bounded queue either blocks the producer when it is full or,
+ * with drop_oldest, replaces the oldest item (like ZMQ_CONFLATE). After
+ * close() pushing fails and pop() returns false once the queue is empty.
+ */
+template <typename T>
+class BlockingQueue
+{
+  public:
+    explicit BlockingQueue(std::size_t capacity = 0, bool drop_oldest = false) : capacity_(capacity), drop_oldest_(drop_oldest) {}
+
+    BlockingQueue(BlockingQueue const&) = delete;
+    BlockingQueue& operator=(BlockingQueue const&) = delete;
+
+    bool push(T item)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+
+            if(capacity_ > 0 && !drop_oldest_)
+            {
+                not_full_.wait(lock, [this]() { return closed_ || items_.size() < capacity_; });
+            }
+
+            if(closed_)
+            {
+                return false;
+            }
+
+            if(capacity_ > 0 && items_.size() >= capacity_)
+            {
+                items_.pop_front();
+                ++num_dropped_;
+            }
+
+            items_.push_back(std::move(item));
+        }
+        not_empty_.notify_one();
+        return true;
+    }
+
+    bool pop(T& item)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait(lock, [this]() { return closed_ || !items_.empty(); });
+
+            if(items_.empty())
+            {
+                return false;
+            }
+
+            item = std::move(items_.front());
+            items_.pop_front();
+        }
+        not_full_.notify_one();
+        return true;
+    }
+
+    bool try_pop(T& item)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if(items_.empty())
+            {
+                return false;
+            }
+
+            item = std::move(items_.front());
+            items_.pop_front();
+        }
+        not_full_.notify_one();
+        return true;
+    }
+
+    // blocks until all items have been popped, returns false if the queue has been closed
+    bool wait_until_empty()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this]() { return closed_ || items_.empty(); });
+        return !closed_;
+    }
+
+    // wakes all waiting threads, remaining items can still be popped
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+
+    // number of items replaced by newer ones
+    std::size_t num_dropped() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return num_dropped_;
+    }
+
+  private:
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<T> items_;
+    std::size_t const capacity_;
+    bool const drop_oldest_;
+    bool closed_ = false;
+    std::size_t num_dropped_ = 0;
+};
+
+} // namespace spoints
+
+#endif // #ifndef SPOINTS_BLOCKINGQUEUE_HPP
@@ -0,0 +1,102 @@
+#ifndef SPOINTS_BUFFERPOOL_HPP
+#define SPOINTS_BUFFERPOOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace spoints
+{
+/**
+ * Fixed set of reusable buffers.
+ *
+ * acquire() hands out a buffer as shared_ptr; when the last owner drops
+ * it, the buffer goes back to the pool instead of being freed, so large
+ * vectors inside keep their capacity. If all buffers are in use, acquire()
+ * blocks until one is returned. The pool may be destroyed before its
+ * buffers, these are deleted then.
+ */
+template <typename T>
+class BufferPool
+{
+  public:
+    explicit BufferPool(std::size_t capacity) : state_(std::make_shared<State>())
+    {
+        state_->capacity = capacity;
+    }
+
+    ~BufferPool() { close(); }
+
+    BufferPool(BufferPool const&) = delete;
+    BufferPool& operator=(BufferPool const&) = delete;
+
+    // returns nullptr after close()
+    std::shared_ptr<T> acquire()
+    {
+        std::unique_ptr<T> buffer;
+        {
+            std::unique_lock<std::mutex> lock(state_->mutex);
+            state_->available.wait(lock, [this]() { return state_->closed || !state_->free.empty() || state_->allocated < state_->capacity; });
+
+            if(state_->closed)
+            {
+                return nullptr;
+            }
+
+            if(!state_->free.empty())
+            {
+                buffer = std::move(state_->free.back());
+                state_->free.pop_back();
+            }
+            else
+            {
+                buffer.reset(new T());
+                ++state_->allocated;
+            }
+        }
+
+        std::weak_ptr<State> weak_state(state_);
+        return std::shared_ptr<T>(buffer.release(), [weak_state](T* released) {
+            std::unique_ptr<T> owned(released);
+            if(auto state = weak_state.lock())
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if(!state->closed)
+                {
+                    state->free.push_back(std::move(owned));
+                    state->available.notify_one();
+                }
+            }
+        });
+    }
+
+    // wakes threads waiting in acquire(), buffers are freed from now on
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            state_->closed = true;
+            state_->free.clear();
+        }
+        state_->available.notify_all();
+    }
+
+  private:
+    struct State
+    {
+        std::mutex mutex;
+        std::condition_variable available;
+        std::vector<std::unique_ptr<T>> free;
+        std::size_t allocated = 0;
+        std::size_t capacity = 0;
+        bool closed = false;
+    };
+
+    std::shared_ptr<State> state_;
+};
+
+} // namespace spoints
+
+#endif // #ifndef SPOINTS_BUFFERPOOL_HPP
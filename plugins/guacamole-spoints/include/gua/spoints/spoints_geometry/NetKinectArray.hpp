@@ -6,8 +6,19 @@
 
 #include <gua/math/BoundingBox.hpp>
 #include <gua/math/math.hpp>
+#include <gua/utils/MessagePlayer.hpp>
+#include <gua/utils/MessageRecorder.hpp>
 
+#include <gua/spoints/spoints_geometry/BlockingQueue.hpp>
+#include <gua/spoints/spoints_geometry/BufferPool.hpp>
+#include <gua/spoints/spoints_geometry/WorkerPool.hpp>
+
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <unordered_map>
@@ -18,6 +29,11 @@
 #include <turbojpeg.h>
 #endif //GUACAMOLE_ENABLE_TURBOJPEG
 
+namespace zmq
+{
+class message_t;
+}
+
 namespace spoints
 {
 struct key_package
@@ -130,6 +146,35 @@ struct SPointsModelDescriptor {
     bool is_fully_encoded_vertex_data = false;
 };
 
+// one decoded model message, ready for upload
+struct SPointsFrame {
+    // increases with every decoded message, starts at 1
+    uint64_t sequence = 0;
+
+    SPointsModelDescriptor model_descriptor;
+
+    std::array<uint32_t, 16> num_best_triangles_for_sensor_layer;
+    std::array<uint32_t, 4 * 16> texture_space_bounding_boxes;
+
+    scm::math::vec3 tight_geometry_bb_min;
+    scm::math::vec3 tight_geometry_bb_max;
+
+    float lod_scaling = 1.0f;
+
+    // payload, points into the vectors below or into message
+    uint8_t const* geometry_data = nullptr;
+    std::size_t geometry_size = 0;
+    uint8_t const* texture_data = nullptr;
+    std::size_t texture_size = 0;
+
+    // decoded payload of compressed messages
+    std::vector<uint8_t> geometry;
+    std::vector<uint8_t> texture;
+
+    // uncompressed messages are used in place
+    std::shared_ptr<zmq::message_t const> message;
+};
+
 class NetKinectArray
 {
   public:
@@ -138,6 +183,8 @@ class NetKinectArray
     static size_t constexpr INITIAL_COMPRESSED_VBO_SIZE = 20000000*3/5;
     static uint16_t constexpr MAX_LAYER_IDX = 16;
     static uint64_t constexpr MAX_NUM_SUPPORTED_CONTEXTS = 12;
+    // the latest frame, one being decoded and one being uploaded
+    static std::size_t constexpr NUM_POOLED_FRAMES = 3;
 
 
     NetKinectArray(const std::string& server_endpoint, const std::string& feedback_endpoint = "");
@@ -151,8 +198,6 @@ class NetKinectArray
 
     bool is_vertex_data_fully_encoded() { return m_model_descriptor_.is_fully_encoded_vertex_data; }
 
-    inline unsigned char* getBuffer() { return m_buffer_.data(); }
-
     //unsigned get_remote_server_screen_width() const { return remote_server_screen_width_to_return_; }
     //unsigned get_remote_server_screen_height() const { return remote_server_screen_height_to_return_; }
 
@@ -179,21 +224,47 @@ class NetKinectArray
 
     bool has_calibration(gua::RenderContext const& ctx) { return m_received_calibration_[ctx.id].load(); }
 
+    /**
+     * Blocks until a model message newer than in_out_sequence has been
+     * decoded or the timeout expired. On success in_out_sequence is set to
+     * the sequence number of the new frame.
+     */
+    bool wait_for_frame(uint64_t& in_out_sequence, std::chrono::milliseconds const& timeout);
+
+    // number of received messages which were replaced by newer ones before decoding
+    std::size_t get_num_dropped_messages() const { return m_received_messages_.num_dropped(); }
+
+    /**
+     * Writes all received messages to the given file until stop_recording()
+     * is called. The file can be replayed by passing "file://<filename>" as
+     * server endpoint, optionally followed by "?speed=<factor>". A speed of
+     * zero replays as fast as the messages are decoded, without dropping any.
+     */
+    bool start_recording(std::string const& filename);
+    void stop_recording();
+
+    bool is_replaying() const { return nullptr != m_player_; }
+
   // helper functions
   private:
 #ifdef GUACAMOLE_ENABLE_TURBOJPEG
-    void _decompress_geometry_buffer();
-    void _decompress_images();
+    // both add decode jobs which write to disjoint parts of the frame and may run concurrently
+    bool _add_geometry_decompression_tasks(uint8_t const* compressed, std::size_t compressed_size, bool is_chunked, SPointsFrame& frame, std::vector<std::function<bool()>>& tasks);
+    bool _add_image_decompression_tasks(
+        uint8_t const* compressed, std::size_t compressed_size, uint32_t const* jpeg_bytes_per_sensor, SPointsFrame& frame, std::vector<std::function<bool()>>& tasks);
 #endif //GUACAMOLE_ENABLE_TURBOJPEG
-    void _unpack_back_message();
+    // decode stage: turns received messages into frames
+    void _unpack_loop();
+    void _unpack_calibration_message(zmq::message_t const& message);
+    bool _unpack_model_message(std::shared_ptr<zmq::message_t const> const& message, SPointsFrame& frame);
+    // receive stage, either from the network or from a recording
     void _readloop();
+    void _replayloop();
 
     void _try_swap_calibration_data_cpu();
 
     bool _try_swap_calibration_data_gpu(gua::RenderContext const& ctx);
 
-    void _try_swap_model_data_cpu();
-
     // receiving geometry
 
 
@@ -205,36 +276,37 @@ class NetKinectArray
 
     std::mutex m_mutex_;
 
-    std::mutex m_unpack_mutex_;
-
-    bool m_has_new_message_to_unpack = false;
-    std::vector<uint8_t> m_back_zmq_unpack_buffer_ = std::vector<uint8_t>(MAX_ZMQ_MESSAGE_SIZE);
-    std::vector<uint8_t> m_front_zmq_unpack_buffer_ = std::vector<uint8_t>(MAX_ZMQ_MESSAGE_SIZE);
-
-    std::size_t m_back_unpack_zmq_message_size_ = 0;
-    std::size_t m_front_unpack_zmq_message_size_ = 0;
-
     std::atomic<bool> m_running_;
     std::string const m_server_endpoint_;
     std::string const m_feedback_endpoint_;
-    std::vector<uint8_t> m_buffer_ = std::vector<uint8_t>(INITIAL_VBO_SIZE);
-    std::vector<uint8_t> m_buffer_back_ = std::vector<uint8_t>(INITIAL_VBO_SIZE);
-    std::vector<uint8_t> m_buffer_back_compressed_ = std::vector<uint8_t>(INITIAL_VBO_SIZE);
 
-    std::vector<uint8_t> m_texture_buffer_ = std::vector<uint8_t>(11059200, 0);
-    std::vector<uint8_t> m_texture_buffer_back_ = std::vector<uint8_t>(11059200, 0);
-    std::vector<uint8_t> m_texture_buffer_back_compressed_ = std::vector<uint8_t>(11059200, 0);
+    // received messages are moved from the receive to the decode stage, only
+    // the latest one is kept
+    BlockingQueue<std::unique_ptr<zmq::message_t>> m_received_messages_{1, true};
+
+    // set if the server endpoint is a recording
+    std::shared_ptr<gua::MessagePlayer> m_player_;
+    // accessed with std::atomic_load/store, written by the receive stage
+    std::shared_ptr<gua::MessageRecorder> m_recorder_;
 
-    std::vector<uint8_t*> m_tj_compressed_image_buffer_per_layer_ =  std::vector<uint8_t*>(MAX_LAYER_IDX, nullptr);
-    std::array<uint8_t, 1024 * 1024 * 100> m_decompressed_image_buffer_;
+    // decoded frames, returned to the pool when no stage uses them anymore
+    BufferPool<SPointsFrame> m_frame_pool_{NUM_POOLED_FRAMES};
+
+#ifdef GUACAMOLE_ENABLE_TURBOJPEG
+    // decodes geometry chunks and sensor layers together with the decode stage
+    WorkerPool m_decode_workers_{std::max(1u, std::thread::hardware_concurrency()) - 1};
+#endif //GUACAMOLE_ENABLE_TURBOJPEG
+
+    // latest decoded frame, guarded by m_mutex_
+    std::shared_ptr<SPointsFrame const> m_latest_frame_;
+    uint64_t m_num_decoded_frames_ = 0;
+    std::condition_variable m_frame_decoded_;
 
     std::vector<uint8_t> m_calibration_;
     std::vector<uint8_t> m_calibration_back_;
 
     std::atomic<bool> m_need_calibration_cpu_swap_{false};
 
-    std::vector<std::size_t> m_byte_offset_to_jpeg_windows_ = std::vector<std::size_t>(MAX_LAYER_IDX, 0);
-
 
     std::vector<std::atomic<bool>> m_need_calibration_gpu_swap_ = std::vector<std::atomic<bool>>(MAX_NUM_SUPPORTED_CONTEXTS);
     std::vector<std::atomic<bool>> m_received_calibration_ = std::vector<std::atomic<bool>>(MAX_NUM_SUPPORTED_CONTEXTS);
@@ -250,45 +322,21 @@ class NetKinectArray
     SPointsCalibrationDescriptor m_calibration_descriptor_;
     SPointsCalibrationDescriptor m_calibration_descriptor_back_;
 
+    // descriptor of m_latest_frame_
     SPointsModelDescriptor m_model_descriptor_;
-    SPointsModelDescriptor m_model_descriptor_back_;
-
-    std::array<uint32_t, 16> m_num_best_triangles_for_sensor_layer_;
-    std::array<uint32_t, 16> m_num_best_triangles_for_sensor_layer_back_;
 
     std::unordered_map<std::size_t, std::array<uint32_t, 16>> m_current_num_best_triangles_for_sensor_layer_per_context_;
 
-    scm::math::vec3 m_tight_geometry_bb_min_back_;
-    scm::math::vec3 m_tight_geometry_bb_min_;
-    scm::math::vec3 m_tight_geometry_bb_max_back_;
-    scm::math::vec3 m_tight_geometry_bb_max_;
-
     std::unordered_map<std::size_t, scm::math::vec3> m_current_tight_geometry_bb_min_per_context_;
     std::unordered_map<std::size_t, scm::math::vec3> m_current_tight_geometry_bb_max_per_context_;
 
-    std::array<uint32_t, 4 * MAX_LAYER_IDX> m_texture_space_bounding_boxes_;
-    std::array<uint32_t, 4 * MAX_LAYER_IDX> m_texture_space_bounding_boxes_back_;
-
-
-
-    float m_lod_scaling_ = 1.0f;
-    float m_lod_scaling_back_ = 1.0f;
-
     mutable std::unordered_map<std::size_t, float> m_current_lod_scaling_per_context_;
 
-    std::atomic<bool> m_need_model_cpu_swap_{false};
-    mutable std::unordered_map<std::size_t, std::atomic<bool>> m_need_model_gpu_swap_;
+    // sequence of the frame last uploaded to each context
+    mutable std::vector<uint64_t> uploaded_frame_sequence_per_context_ = std::vector<uint64_t>(MAX_NUM_SUPPORTED_CONTEXTS, 0);
+
     std::thread m_recv_thread_;
-    std::thread m_decompress_geometry_thread_;
-    std::thread m_decompress_images_thread_;
     std::thread m_unpack_thread_;
-
-    volatile std::atomic<bool> m_submitted_compressed_geometry_buffer_{false};
-    volatile std::atomic<bool> m_geometry_decompressor_finished_{false};
-
-    volatile std::atomic<bool> m_submitted_compressed_images_{false};
-    volatile std::atomic<bool> m_image_decompressor_finished_{false};
-    volatile std::atomic<bool> m_image_decompression_without_errors_{true};
     // sending matrices
     std::mutex m_feedback_mutex_;
     // bool       m_feedback_running_;
@@ -365,6 +413,9 @@ class NetKinectArray
     mutable std::vector<bool> is_swapping_gpu_model_data_per_context_ = std::vector<bool>(MAX_NUM_SUPPORTED_CONTEXTS, false);
 
     mutable std::vector<std::size_t> encountered_frame_counts_per_context_ = std::vector<std::size_t>(MAX_NUM_SUPPORTED_CONTEXTS, 0);
+
+    // the buffers and textures of all contexts, untracked with the array
+    mutable GpuMemoryAllocations memory_allocations_;
     //mutable std::unordered_map<std::size_t, std::size_t> num_vertex_colored_points_to_draw_per_context_;
     //mutable std::unordered_map<std::size_t, std::size_t> num_vertex_colored_tris_to_draw_per_context_;
     //mutable std::unordered_map<std::size_t, std::size_t> num_textured_tris_to_draw_per_context_;
@@ -0,0 +1,126 @@
+#ifndef SPOINTS_WORKERPOOL_HPP
+#define SPOINTS_WORKERPOOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace spoints
+{
+/**
+ * Fixed set of threads running batches of independent tasks.
+ *
+ * run() shares the tasks of a batch between the workers and the calling
+ * thread and returns once all of them are done, so no threads are started
+ * per batch. Batches are meant to be run from a single thread.
+ */
+class WorkerPool
+{
+  public:
+    using Task = std::function<bool()>;
+
+    explicit WorkerPool(std::size_t num_workers)
+    {
+        for(std::size_t i = 0; i < num_workers; ++i)
+        {
+            workers_.emplace_back([this]() { work(); });
+        }
+    }
+
+    WorkerPool(WorkerPool const&) = delete;
+    WorkerPool& operator=(WorkerPool const&) = delete;
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        task_available_.notify_all();
+
+        for(auto& worker : workers_)
+        {
+            worker.join();
+        }
+    }
+
+    // returns false if any of the tasks failed
+    bool run(std::vector<Task> const& tasks)
+    {
+        if(tasks.empty())
+        {
+            return true;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        batch_ = &tasks;
+        next_task_ = 0;
+        num_pending_ = tasks.size();
+        success_ = true;
+
+        lock.unlock();
+        task_available_.notify_all();
+        lock.lock();
+
+        // the calling thread would only wait otherwise
+        while(next_task_ < tasks.size())
+        {
+            execute(lock, tasks[next_task_++]);
+        }
+
+        batch_done_.wait(lock, [this]() { return 0 == num_pending_; });
+        batch_ = nullptr;
+
+        return success_;
+    }
+
+  private:
+    void work()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        while(true)
+        {
+            task_available_.wait(lock, [this]() { return !running_ || (batch_ && next_task_ < batch_->size()); });
+
+            if(!running_)
+            {
+                return;
+            }
+
+            execute(lock, (*batch_)[next_task_++]);
+        }
+    }
+
+    // runs the task without holding the lock
+    void execute(std::unique_lock<std::mutex>& lock, Task const& task)
+    {
+        lock.unlock();
+        bool const success = task();
+        lock.lock();
+
+        success_ = success && success_;
+
+        if(0 == --num_pending_)
+        {
+            batch_done_.notify_one();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable task_available_;
+    std::condition_variable batch_done_;
+    std::vector<Task> const* batch_ = nullptr;
+    std::size_t next_task_ = 0;
+    std::size_t num_pending_ = 0;
+    bool success_ = true;
+    bool running_ = true;
+    std::vector<std::thread> workers_;
+};
+
+} // namespace spoints
+
+#endif // #ifndef SPOINTS_WORKERPOOL_HPP
@@ -104,6 +104,10 @@ std::shared_ptr<Node> SPointsNode::copy() const { return std::make_shared<SPoint
 
 /////////////////////////////////////////////////////////////////////////////
 
+std::size_t SPointsNode::get_geometry_revision() const { return spoints_ ? spoints_->get_revision() : 0; }
+
+/////////////////////////////////////////////////////////////////////////////
+
 /* virtual */ void SPointsNode::update_cache()
 {
     if(spoints_changed_)
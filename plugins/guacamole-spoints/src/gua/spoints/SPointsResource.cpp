@@ -116,6 +116,34 @@ std::string SPointsResource::get_socket_string() const
     return "";
 }
 
+bool SPointsResource::start_recording(std::string const& filename)
+{
+    std::lock_guard<std::mutex> lock(m_push_matrix_package_mutex_);
+
+    if(spointsdata_)
+    {
+        if(spointsdata_->nka_)
+        {
+            return spointsdata_->nka_->start_recording(filename);
+        }
+    }
+
+    return false;
+}
+
+void SPointsResource::stop_recording()
+{
+    std::lock_guard<std::mutex> lock(m_push_matrix_package_mutex_);
+
+    if(spointsdata_)
+    {
+        if(spointsdata_->nka_)
+        {
+            spointsdata_->nka_->stop_recording();
+        }
+    }
+}
+
 void SPointsResource::push_matrix_package(spoints::camera_matrix_package const& cam_mat_package)
 {
     // std::cout << "SpointsResource PushMatrixPackage: " << cam_mat_package.k_package.is_camera << "\n";
@@ -144,7 +172,10 @@ void SPointsResource::update_buffers(RenderContext const& ctx, Pipeline& pipe)
     }
 
     // synchronize vertex data
-    spointsdata_->nka_->update(ctx, bounding_box_, inv_xyz_vol_res_, uv_vol_res_);
+    if(spointsdata_->nka_->update(ctx, bounding_box_, inv_xyz_vol_res_, uv_vol_res_))
+    {
+        increment_revision();
+    }
 }
 
 
@@ -6,6 +6,7 @@
 
 #include <boost/assign/list_of.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <mutex>
 #include <zmq.hpp>
@@ -22,43 +23,133 @@ gua::math::vec2ui get_handle(scm::gl::texture_image_ptr const& tex)
     return gua::math::vec2ui(handle & 0x00000000ffffffff, handle & 0xffffffff00000000);
 }
 
+#ifdef GUACAMOLE_ENABLE_TURBOJPEG
+// returns the byte size of the chunk table or 0 if the payload is no valid chunked payload
+std::size_t read_geometry_chunk_table(uint8_t const* payload, std::size_t payload_size, std::vector<SGTP::geometry_chunk_t>& chunks)
+{
+    chunks.clear();
+
+    uint32_t num_chunks = 0;
+
+    if(payload_size < sizeof(num_chunks))
+    {
+        return 0;
+    }
+
+    memcpy((char*)&num_chunks, (char const*)payload, sizeof(num_chunks));
+
+    std::size_t const table_size = sizeof(num_chunks) + std::size_t(num_chunks) * sizeof(SGTP::geometry_chunk_t);
+
+    if(0 == num_chunks || table_size > payload_size)
+    {
+        return 0;
+    }
+
+    chunks.resize(num_chunks);
+    memcpy((char*)chunks.data(), (char const*)payload + sizeof(num_chunks), num_chunks * sizeof(SGTP::geometry_chunk_t));
+
+    std::size_t total_size = table_size;
+
+    for(auto const& chunk : chunks)
+    {
+        total_size += chunk.compressed_size;
+    }
+
+    if(total_size != payload_size)
+    {
+        chunks.clear();
+        return 0;
+    }
+
+    return table_size;
+}
+
+struct LZ4Chunk
+{
+    char const* source;
+    int source_size;
+    char* destination;
+    int destination_size;
+};
+
+bool decompress_chunks(std::vector<LZ4Chunk> const& chunks)
+{
+    for(auto const& chunk : chunks)
+    {
+        if(LZ4_decompress_safe(chunk.source, chunk.destination, chunk.source_size, chunk.destination_size) != chunk.destination_size)
+        {
+            gua::Logger::LOG_WARNING << "Failed to decompress spoints geometry chunk, skipping frame." << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+#endif // GUACAMOLE_ENABLE_TURBOJPEG
+
+// zmq deallocation function of messages referring to a recording
+void release_recording(void* /*data*/, void* recording) { delete static_cast<std::shared_ptr<gua::MessageRecording const>*>(recording); }
+
 } // namespace
 
 namespace spoints
 {
 NetKinectArray::NetKinectArray(const std::string& server_endpoint, const std::string& feedback_endpoint)
-    : m_mutex_(), m_unpack_mutex_(), m_running_(true),
+    : m_mutex_(), m_running_(true),
       // m_feedback_running_(true),
-      m_server_endpoint_(server_endpoint), m_feedback_endpoint_(feedback_endpoint), m_buffer_(/*(m_colorsize_byte + m_depthsize_byte) * m_calib_files.size()*/),
-      m_buffer_back_(/*(m_colorsize_byte + m_depthsize_byte) * m_calib_files.size()*/),
+      m_server_endpoint_(server_endpoint), m_feedback_endpoint_(feedback_endpoint),
       // m_feedback_need_swap_{false},
       m_recv_thread_(),
       m_unpack_thread_()
 {
-    m_recv_thread_ = std::thread([this]() { _readloop(); });
+    std::string recording_filename;
+    float replay_speed = 1.f;
 
-    m_unpack_thread_ = std::thread([this]() { _unpack_back_message(); });
+    if(gua::MessagePlayer::parse_endpoint(m_server_endpoint_, recording_filename, replay_speed))
+    {
+        auto recording(std::make_shared<gua::MessageRecording const>(recording_filename));
 
-#ifdef GUACAMOLE_ENABLE_TURBOJPEG
-    //m_decompress_geometry_thread_ = std::thread([this]() { _decompress_geometry_buffer(); });
-    //m_decompress_images_thread_ = std::thread([this]() { _decompress_images(); });
-#endif
+        if(recording->is_valid())
+        {
+            m_player_ = std::make_shared<gua::MessagePlayer>(recording, replay_speed);
+            m_recv_thread_ = std::thread([this]() { _replayloop(); });
+        }
+    }
+    else
+    {
+        m_recv_thread_ = std::thread([this]() { _readloop(); });
+    }
+
+    m_unpack_thread_ = std::thread([this]() { _unpack_loop(); });
 }
 
 NetKinectArray::~NetKinectArray()
 {
-#ifdef GUACAMOLE_ENABLE_TURBOJPEG
+    m_running_ = false;
+    if(m_player_)
+    {
+        m_player_->stop();
+    }
+    // wakes a replay waiting for the decode stage
+    m_received_messages_.close();
+    if(m_recv_thread_.joinable())
+    {
+        m_recv_thread_.join();
+    }
 
-    for(uint32_t layer_idx = 0; layer_idx < MAX_LAYER_IDX; ++layer_idx) {
+    // wakes the decode stage if it waits for a free frame
+    m_frame_pool_.close();
+    m_unpack_thread_.join();
 
-        if(nullptr != m_tj_compressed_image_buffer_per_layer_[layer_idx]) 
+#ifdef GUACAMOLE_ENABLE_TURBOJPEG
+    for(auto& decompressor : m_jpeg_decompressor_per_layer)
+    {
+        if(0 != decompressor)
         {
-            tjFree(m_tj_compressed_image_buffer_per_layer_[layer_idx]);
+            tjDestroy(decompressor);
         }
     }
 #endif //GUACAMOLE_ENABLE_TURBOJPEG
-    m_running_ = false;
-    m_recv_thread_.join();
 }
 
 void NetKinectArray::draw_textured_triangle_soup(gua::RenderContext const& ctx, std::shared_ptr<gua::ShaderProgram>& shader_program)
@@ -207,6 +298,25 @@ void NetKinectArray::draw_textured_triangle_soup(gua::RenderContext const& ctx,
 
 std::string NetKinectArray::get_socket_string() const { return m_feedback_endpoint_; };
 
+bool NetKinectArray::start_recording(std::string const& filename)
+{
+    auto recorder(std::make_shared<gua::MessageRecorder>());
+
+    if(!recorder->open(filename))
+    {
+        return false;
+    }
+
+    std::atomic_store(&m_recorder_, recorder);
+    return true;
+}
+
+void NetKinectArray::stop_recording()
+{
+    // the file is closed when the receive stage drops its reference
+    std::atomic_store(&m_recorder_, std::shared_ptr<gua::MessageRecorder>());
+}
+
 void NetKinectArray::push_matrix_package(spoints::camera_matrix_package const& cam_mat_package)
 {
     submitted_camera_matrix_package_ = cam_mat_package;
@@ -342,43 +452,17 @@ bool NetKinectArray::_try_swap_calibration_data_gpu(gua::RenderContext const& ct
         return true;
 }
 
-void NetKinectArray::_try_swap_model_data_cpu() {
+bool NetKinectArray::wait_for_frame(uint64_t& in_out_sequence, std::chrono::milliseconds const& timeout)
+{
+    std::unique_lock<std::mutex> lock(m_mutex_);
 
-        std::lock_guard<std::mutex> lock(m_mutex_);
-    if(m_need_model_cpu_swap_.load())
+    if(!m_frame_decoded_.wait_for(lock, timeout, [&]() { return m_num_decoded_frames_ > in_out_sequence; }))
     {
-
-
-        if(num_clients_gpu_swapping_.load()) {
-            return;
-        }
-
-        ++num_clients_cpu_swapping_;
-
-        //std::lock_guard<std::mutex> lock(m_mutex_);
-        // start of synchro point
-        m_buffer_.swap(m_buffer_back_);
-        m_texture_buffer_.swap(m_texture_buffer_back_);
-        // std::swap(m_voxel_size_, m_voxel_size_back_);
-
-        std::swap(m_model_descriptor_back_, m_model_descriptor_);
-
-
-        std::swap(m_num_best_triangles_for_sensor_layer_, m_num_best_triangles_for_sensor_layer_back_);
-
-        std::swap(m_lod_scaling_back_, m_lod_scaling_);
-
-        std::swap(m_texture_space_bounding_boxes_back_, m_texture_space_bounding_boxes_);
-
-        std::swap(m_tight_geometry_bb_min_, m_tight_geometry_bb_min_back_);
-        std::swap(m_tight_geometry_bb_max_, m_tight_geometry_bb_max_back_);
-
-        //std::swap(m_is_fully_encoded_vertex_data_back_, m_is_fully_encoded_vertex_data_);
-
-        // end of synchro point
-        --num_clients_cpu_swapping_;
-        m_need_model_cpu_swap_.store(false);
+        return false;
     }
+
+    in_out_sequence = m_num_decoded_frames_;
+    return true;
 }
 
 bool NetKinectArray::update(gua::RenderContext const& ctx, gua::math::BoundingBox<gua::math::vec3>& in_out_bb, scm::math::vec3ui const& inv_xyz_vol_res, scm::math::vec3ui const& uv_vol_res)
@@ -510,6 +594,10 @@ bool NetKinectArray::update(gua::RenderContext const& ctx, gua::math::BoundingBo
 
             }
             are_textures_created_per_context_[ctx.id] = true;
+
+            // storage buffer, BGR_8 texture atlas and per sensor RGBA_32F and RG_32F calibration volumes
+            std::size_t calibration_bytes(std::size_t(inv_xyz_vol_res[0]) * inv_xyz_vol_res[1] * inv_xyz_vol_res[2] * 16 + std::size_t(uv_vol_res[0]) * uv_vol_res[1] * uv_vol_res[2] * 8);
+            memory_allocations_.track(ctx.memory, GpuMemoryRegistry::id_of(this), GpuMemoryRegistry::Category::PLUGIN, INITIAL_VBO_SIZE + std::size_t(1280 * 2) * (720 * 2) * 3 + 4 * calibration_bytes, "SPoints");
         }
 
         //std::cout << "SOME TEXTURE UPDATE WENT WRONG" << std::endl;
@@ -546,67 +634,51 @@ bool NetKinectArray::update(gua::RenderContext const& ctx, gua::math::BoundingBo
             return false;
         }
 
-        _try_swap_model_data_cpu();
-
-        bool current_thread_need_model_gpu_swap = false;
+        // the frame stays alive while it is uploaded, even if a newer one is decoded meanwhile
+        std::shared_ptr<SPointsFrame const> frame;
 
         {
-            //std::lock_guard<std::mutex> lock(m_mutex_);
-            current_thread_need_model_gpu_swap = m_need_model_gpu_swap_[ctx.id].load();
+            std::lock_guard<std::mutex> lock(m_mutex_);
+            frame = m_latest_frame_;
         }
 
-        if(current_thread_need_model_gpu_swap)
+        if(frame && frame->sequence != uploaded_frame_sequence_per_context_[ctx.id])
         {
-
-
-            if(num_clients_cpu_swapping_.load()) {
-                return false;
-            }
-
-            ++num_clients_gpu_swapping_;
+            auto const& model_descriptor = frame->model_descriptor;
             size_t total_num_bytes_to_copy = 0;
 
-            if(false == m_model_descriptor_.is_fully_encoded_vertex_data)
+            if(false == model_descriptor.is_fully_encoded_vertex_data)
             {
-                total_num_bytes_to_copy = m_model_descriptor_.received_textured_tris * 3 * 3 * sizeof(uint16_t);
+                total_num_bytes_to_copy = model_descriptor.received_textured_tris * 3 * 3 * sizeof(uint16_t);
             }
             else
             {
-                total_num_bytes_to_copy =  m_model_descriptor_.received_textured_tris * 3 * 5 * sizeof(float);
+                total_num_bytes_to_copy =  model_descriptor.received_textured_tris * 3 * 5 * sizeof(float);
             }
 
+            total_num_bytes_to_copy = std::min(total_num_bytes_to_copy, std::min(frame->geometry_size, std::size_t(INITIAL_VBO_SIZE)));
+
             if(0 != total_num_bytes_to_copy)
             {
-
-
-                num_textured_tris_to_draw_per_context_[ctx.id] = m_model_descriptor_.received_textured_tris;
-                m_current_num_best_triangles_for_sensor_layer_per_context_[ctx.id] = m_num_best_triangles_for_sensor_layer_;
-
-
-                //std::lock_guard<std::mutex> lock(m_mutex_);
-                //auto& current_is_vbo_created = is_vbo_created_per_context_[ctx.id];
-
-
+                num_textured_tris_to_draw_per_context_[ctx.id] = model_descriptor.received_textured_tris;
+                m_current_num_best_triangles_for_sensor_layer_per_context_[ctx.id] = frame->num_best_triangles_for_sensor_layer;
 
                 ctx.render_context->bind_storage_buffer(net_data_vbo_per_context_[ctx.id], 3, 0, INITIAL_VBO_SIZE);
 
                 ctx.render_context->apply_storage_buffer_bindings();
-                    are_calib_volumes_bound_per_context_[ctx.id] = true;
-                
+                are_calib_volumes_bound_per_context_[ctx.id] = true;
 
                 is_swapping_gpu_model_data_per_context_[ctx.id] = true;
                 float* mapped_net_data_vbo_ = (float*)ctx.render_context->map_buffer(net_data_vbo_per_context_[ctx.id], scm::gl::access_mode::ACCESS_WRITE_ONLY);
-                memcpy((char*)mapped_net_data_vbo_, (char*)&m_buffer_[0], total_num_bytes_to_copy);
+                memcpy((char*)mapped_net_data_vbo_, (char const*)frame->geometry_data, total_num_bytes_to_copy);
                 ctx.render_context->unmap_buffer(net_data_vbo_per_context_[ctx.id]);
 
-                //ctx.render_context->unmap_buffer(net_data_vbo_per_context_[ctx.id]);
-                
-                
-                m_current_lod_scaling_per_context_[ctx.id] = m_lod_scaling_;
+                m_current_lod_scaling_per_context_[ctx.id] = frame->lod_scaling;
 
-                m_current_tight_geometry_bb_min_per_context_[ctx.id] = m_tight_geometry_bb_min_;
-                m_current_tight_geometry_bb_max_per_context_[ctx.id] = m_tight_geometry_bb_max_;
+                m_current_tight_geometry_bb_min_per_context_[ctx.id] = frame->tight_geometry_bb_min;
+                m_current_tight_geometry_bb_max_per_context_[ctx.id] = frame->tight_geometry_bb_max;
 
+                auto const& texture_space_bounding_boxes = frame->texture_space_bounding_boxes;
                 uint32_t byte_offset_per_texture_data_for_layers[MAX_LAYER_IDX];
 
                 for(uint32_t layer_to_update_idx = 0; layer_to_update_idx < MAX_LAYER_IDX; ++layer_to_update_idx)
@@ -620,70 +692,46 @@ bool NetKinectArray::update(gua::RenderContext const& ctx, gua::math::BoundingBo
                     {
                         byte_offset_per_texture_data_for_layers[layer_to_update_idx] = byte_offset_per_texture_data_for_layers[layer_to_update_idx - 1];
 
-                        if(m_num_best_triangles_for_sensor_layer_[layer_to_update_idx])
+                        if(frame->num_best_triangles_for_sensor_layer[layer_to_update_idx])
                         {
                             uint32_t layer_offset = 4 * (layer_to_update_idx - 1);
-                            uint32_t prev_bb_pixel_coverage = (1 + m_texture_space_bounding_boxes_[layer_offset + 2] - m_texture_space_bounding_boxes_[layer_offset + 0]) *
-                                                              (1 + m_texture_space_bounding_boxes_[layer_offset + 3] - m_texture_space_bounding_boxes_[layer_offset + 1]);
+                            uint32_t prev_bb_pixel_coverage = (1 + texture_space_bounding_boxes[layer_offset + 2] - texture_space_bounding_boxes[layer_offset + 0]) *
+                                                              (1 + texture_space_bounding_boxes[layer_offset + 3] - texture_space_bounding_boxes[layer_offset + 1]);
 
                             byte_offset_per_texture_data_for_layers[layer_to_update_idx] += prev_bb_pixel_coverage * 3;
                         }
                     }
 
-                    {
-                    uint32_t test_layer_offset = 4 * (layer_to_update_idx);
-
-
+                    uint32_t current_layer_offset = 4 * (layer_to_update_idx);
 
+                    uint32_t const region_width = texture_space_bounding_boxes[current_layer_offset + 2] + 1 - texture_space_bounding_boxes[current_layer_offset + 0];
+                    uint32_t const region_height = texture_space_bounding_boxes[current_layer_offset + 3] + 1 - texture_space_bounding_boxes[current_layer_offset + 1];
 
+                    bool const is_region_valid = texture_space_bounding_boxes[current_layer_offset + 0] <= 2560 && texture_space_bounding_boxes[current_layer_offset + 1] <= 1440 &&
+                                                 region_width <= 2560 && region_height <= 1440;
 
-                    if( !(m_texture_space_bounding_boxes_[test_layer_offset + 0] > 2560 || m_texture_space_bounding_boxes_[test_layer_offset + 0] < 0 || 
-                        m_texture_space_bounding_boxes_[test_layer_offset + 1] > 1440 || m_texture_space_bounding_boxes_[test_layer_offset + 1] < 0 ||
-                       (m_texture_space_bounding_boxes_[test_layer_offset + 2] + 1 - m_texture_space_bounding_boxes_[test_layer_offset + 0]) > 2560 ||
-                       (m_texture_space_bounding_boxes_[test_layer_offset + 3] + 1 - m_texture_space_bounding_boxes_[test_layer_offset + 1]) > 1440 || 
-                       (m_texture_space_bounding_boxes_[test_layer_offset + 2] + 1 - m_texture_space_bounding_boxes_[test_layer_offset + 0]) < 0    ||
-                       (m_texture_space_bounding_boxes_[test_layer_offset + 3] + 1 - m_texture_space_bounding_boxes_[test_layer_offset + 1]) < 0      ) )
+                    if(is_region_valid && frame->num_best_triangles_for_sensor_layer[layer_to_update_idx] > 0)
                     {
+                        auto current_region_to_update =
+                            scm::gl::texture_region(scm::math::vec3ui(texture_space_bounding_boxes[current_layer_offset + 0], texture_space_bounding_boxes[current_layer_offset + 1], 0),
+                                                    scm::math::vec3ui(region_width, region_height, 1));
 
-                    
+                        size_t current_read_offset = byte_offset_per_texture_data_for_layers[layer_to_update_idx];
 
-                        if(m_num_best_triangles_for_sensor_layer_[layer_to_update_idx] > 0)
+                        if(current_read_offset + std::size_t(region_width) * region_height * 3 <= frame->texture_size)
                         {
-                            uint32_t current_layer_offset = 4 * (layer_to_update_idx);
-
-                            auto current_region_to_update =
-                                scm::gl::texture_region(scm::math::vec3ui(m_texture_space_bounding_boxes_[current_layer_offset + 0], m_texture_space_bounding_boxes_[current_layer_offset + 1], 0),
-                                                        scm::math::vec3ui((m_texture_space_bounding_boxes_[current_layer_offset + 2] + 1 - m_texture_space_bounding_boxes_[current_layer_offset + 0]),
-                                                                          (m_texture_space_bounding_boxes_[current_layer_offset + 3] + 1 - m_texture_space_bounding_boxes_[current_layer_offset + 1]),
-                                                                          1));
-
-                            size_t current_read_offset = byte_offset_per_texture_data_for_layers[layer_to_update_idx];
-
-                            
                             ctx.render_context->update_sub_texture(
-                                texture_atlas_per_context_[ctx.id], current_region_to_update, 0, scm::gl::FORMAT_BGR_8, (void*)&m_texture_buffer_[current_read_offset]);
-                            
-                        }
-
-                        } else {
-                            /*
-                                                std::cout << "TexSpace BB: (" << m_texture_space_bounding_boxes_[test_layer_offset + 0] << " " <<m_texture_space_bounding_boxes_[test_layer_offset + 1] << ")," <<
-                                                  "("   << (m_texture_space_bounding_boxes_[test_layer_offset + 2] + 1 - m_texture_space_bounding_boxes_[test_layer_offset + 0]) << " "
-                                                        << (m_texture_space_bounding_boxes_[test_layer_offset + 3] + 1 - m_texture_space_bounding_boxes_[test_layer_offset + 1]) << ")" << std::endl; 
-                            */
+                                texture_atlas_per_context_[ctx.id], current_region_to_update, 0, scm::gl::FORMAT_BGR_8, (void*)(frame->texture_data + current_read_offset));
                         }
-
                     }
                 }
-
             }
             else
             {
                 num_textured_tris_to_draw_per_context_[ctx.id] = 0;
             }
 
-            --num_clients_gpu_swapping_;
-            m_need_model_gpu_swap_[ctx.id].store(false);
+            uploaded_frame_sequence_per_context_[ctx.id] = frame->sequence;
             return true;
         }
     }
@@ -695,336 +743,397 @@ bool NetKinectArray::update(gua::RenderContext const& ctx, gua::math::BoundingBo
     }*/
 
 
-void NetKinectArray::_unpack_back_message() {
-        while(true) {
-
-            {
-                std::lock_guard<std::mutex> unpack_lock(m_unpack_mutex_);
-
+void NetKinectArray::_unpack_loop()
+{
+    std::unique_ptr<zmq::message_t> message;
 
-                if(m_has_new_message_to_unpack) {
-                    m_front_unpack_zmq_message_size_ = m_back_unpack_zmq_message_size_;
-                    memcpy( (char*) m_front_zmq_unpack_buffer_.data(), m_back_zmq_unpack_buffer_.data(), m_front_unpack_zmq_message_size_);
-                    m_has_new_message_to_unpack = false;
-                } else {
-                    continue;
-                }
-            }
+    // sleeps until a message arrives, returns false on shutdown
+    while(m_received_messages_.pop(message))
+    {
+        if(message->size() < SGTP::HEADER_BYTE_SIZE)
+        {
+            gua::Logger::LOG_WARNING << "Received spoints message without header, skipping it." << std::endl;
+            continue;
+        }
 
+        bool is_calibration_data = false;
+        memcpy((char*)&is_calibration_data, (char const*)message->data(), sizeof(bool));
 
-            while(m_need_model_cpu_swap_ || num_clients_gpu_swapping_.load() || num_clients_cpu_swapping_.load())
-            {
-               ;
-            }
+        if(is_calibration_data)
+        {
+            _unpack_calibration_message(*message);
+            continue;
+        }
 
+        // blocks while all frames are in use by the render threads
+        auto frame(m_frame_pool_.acquire());
 
+        if(!frame)
+        {
+            break;
+        }
 
-            //continue;
+        if(!_unpack_model_message(std::shared_ptr<zmq::message_t const>(std::move(message)), *frame))
+        {
+            continue;
+        }
 
-            SGTP::header_data_t message_header;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex_);
+            frame->sequence = ++m_num_decoded_frames_;
+            m_model_descriptor_ = frame->model_descriptor;
+            // the previous frame goes back to the pool once no context uploads it anymore
+            m_latest_frame_ = frame;
+        }
 
-            std::size_t const HEADER_SIZE = SGTP::HEADER_BYTE_SIZE;
+        m_frame_decoded_.notify_all();
+    }
+}
 
-            memcpy((char*)&message_header, (unsigned char*)m_front_zmq_unpack_buffer_.data(), SGTP::HEADER_BYTE_SIZE);
+void NetKinectArray::_unpack_calibration_message(zmq::message_t const& message)
+{
+    SGTP::header_data_t message_header;
 
-            if(message_header.is_calibration_data)
-            {
-                for(int dim_idx = 0; dim_idx < 3; ++dim_idx)
-                {
-                    m_calibration_descriptor_back_.inv_xyz_calibration_res[dim_idx] = message_header.inv_xyz_volume_res[dim_idx];
-                    m_calibration_descriptor_back_.uv_calibration_res[dim_idx] = message_header.uv_volume_res[dim_idx];
-                }
+    std::size_t const HEADER_SIZE = SGTP::HEADER_BYTE_SIZE;
 
-                m_calibration_descriptor_back_.num_sensors = message_header.num_sensors;
+    memcpy((char*)&message_header, (char const*)message.data(), HEADER_SIZE);
 
-                m_calibration_back_.resize(message_header.total_payload);
+    if(message.size() < HEADER_SIZE + message_header.total_payload)
+    {
+        gua::Logger::LOG_WARNING << "Received incomplete spoints calibration, skipping it." << std::endl;
+        return;
+    }
 
-                memcpy((char*)&m_calibration_back_[0], ((char*)m_front_zmq_unpack_buffer_.data()) + HEADER_SIZE, message_header.total_payload);
+    SPointsCalibrationDescriptor calibration_descriptor;
 
-                // memcpy inv_model_to_world_mat
+    for(int dim_idx = 0; dim_idx < 3; ++dim_idx)
+    {
+        calibration_descriptor.inv_xyz_calibration_res[dim_idx] = message_header.inv_xyz_volume_res[dim_idx];
+        calibration_descriptor.uv_calibration_res[dim_idx] = message_header.uv_volume_res[dim_idx];
+    }
 
-                memcpy((char*)&m_calibration_descriptor_back_.inverse_vol_to_world_mat[0], 
-                       (char*)message_header.inv_vol_to_world_mat, 16 * sizeof(float));
+    calibration_descriptor.num_sensors = message_header.num_sensors;
 
-                { // swap
-                    //std::lock_guard<std::mutex> lock(m_mutex_);
-                    m_need_calibration_cpu_swap_.store(true);
+    // memcpy inv_model_to_world_mat
+    memcpy((char*)&calibration_descriptor.inverse_vol_to_world_mat[0], (char*)message_header.inv_vol_to_world_mat, 16 * sizeof(float));
 
-                    for(auto& entry : m_need_calibration_gpu_swap_)
-                    {
-                        entry.store(true);
-                    }
-                    // mutable std::unordered_map<std::size_t,
-                }
-            }
-            else
-            {
-                message_header.fill_texture_byte_offsets_to_bounding_boxes();
+    uint8_t const* payload = ((uint8_t const*)message.data()) + HEADER_SIZE;
+    std::vector<uint8_t> calibration(payload, payload + message_header.total_payload);
 
-                for(uint32_t dim_idx = 0; dim_idx < 3; ++dim_idx)
-                {
-                    m_tight_geometry_bb_min_back_[dim_idx] = message_header.global_bb_min[dim_idx];
-                    m_tight_geometry_bb_max_back_[dim_idx] = message_header.global_bb_max[dim_idx];
-                }
+    { // swap
+        std::lock_guard<std::mutex> lock(m_mutex_);
 
-                m_model_descriptor_back_.is_fully_encoded_vertex_data = message_header.is_fully_encoded_vertex_data;
-                m_model_descriptor_back_.received_textured_tris = message_header.num_textured_triangles;
-                m_model_descriptor_back_.texture_payload_size_in_byte = message_header.texture_payload_size;
+        m_calibration_back_.swap(calibration);
+        m_calibration_descriptor_back_ = calibration_descriptor;
 
-                m_model_descriptor_back_.received_kinect_timestamp = message_header.timestamp;
-                m_model_descriptor_back_.received_reconstruction_time = message_header.geometry_creation_time_in_ms;
+        m_need_calibration_cpu_swap_.store(true);
 
-                m_model_descriptor_back_.total_message_payload_in_byte = m_front_unpack_zmq_message_size_;
+        for(auto& entry : m_need_calibration_gpu_swap_)
+        {
+            entry.store(true);
+        }
+    }
+}
 
-                auto passed_microseconds_to_request = message_header.passed_microseconds_since_request;
+bool NetKinectArray::_unpack_model_message(std::shared_ptr<zmq::message_t const> const& message, SPointsFrame& frame)
+{
+    SGTP::header_data_t message_header;
 
-                auto timestamp_during_reception = std::chrono::system_clock::now();
-                auto reference_timestamp = ::gua::SPointsFeedbackCollector::instance()->get_reference_timestamp();
+    std::size_t const HEADER_SIZE = SGTP::HEADER_BYTE_SIZE;
 
-                auto start_to_reply_diff = timestamp_during_reception - reference_timestamp;
+    memcpy((char*)&message_header, (char const*)message->data(), HEADER_SIZE);
 
-                int64_t passed_microseconds_to_reply = std::chrono::duration<double>(start_to_reply_diff).count() * 1000000;
+    message_header.fill_texture_byte_offsets_to_bounding_boxes();
 
-                int64_t total_latency_in_microseconds = passed_microseconds_to_reply - passed_microseconds_to_request;
+    auto& model_descriptor = frame.model_descriptor;
 
-                m_model_descriptor_back_.request_reply_latency_ms = total_latency_in_microseconds / 1000.0f;
+    for(uint32_t dim_idx = 0; dim_idx < 3; ++dim_idx)
+    {
+        frame.tight_geometry_bb_min[dim_idx] = message_header.global_bb_min[dim_idx];
+        frame.tight_geometry_bb_max[dim_idx] = message_header.global_bb_max[dim_idx];
+    }
 
-                m_lod_scaling_back_ = message_header.lod_scaling;
+    model_descriptor.is_fully_encoded_vertex_data = message_header.is_fully_encoded_vertex_data;
+    model_descriptor.received_textured_tris = message_header.num_textured_triangles;
+    model_descriptor.texture_payload_size_in_byte = message_header.texture_payload_size;
 
+    model_descriptor.received_kinect_timestamp = message_header.timestamp;
+    model_descriptor.received_reconstruction_time = message_header.geometry_creation_time_in_ms;
 
+    model_descriptor.total_message_payload_in_byte = message->size();
 
-                if(!m_model_descriptor_back_.is_fully_encoded_vertex_data)
-                {
-                    m_model_descriptor_back_.received_textured_tris = 0;
+    auto passed_microseconds_to_request = message_header.passed_microseconds_since_request;
 
-                    for(int layer_idx = 0; layer_idx < MAX_LAYER_IDX; ++layer_idx)
-                    {
-                        m_num_best_triangles_for_sensor_layer_back_[layer_idx] = message_header.num_best_triangles_per_sensor[layer_idx];
+    auto timestamp_during_reception = std::chrono::system_clock::now();
+    auto reference_timestamp = ::gua::SPointsFeedbackCollector::instance()->get_reference_timestamp();
 
-                        m_model_descriptor_back_.received_textured_tris += message_header.num_best_triangles_per_sensor[layer_idx];
+    auto start_to_reply_diff = timestamp_during_reception - reference_timestamp;
 
-                        //memcpy(&m_texture_space_bounding_boxes_back_[4 * layer_idx + 0], &message_header.tex_bounding_box[layer_idx], sizeof(message_header.tex_bounding_box[0]));
-                        m_texture_space_bounding_boxes_back_[4 * layer_idx + 0] = message_header.tex_bounding_box[layer_idx].min.u;
-                        m_texture_space_bounding_boxes_back_[4 * layer_idx + 1] = message_header.tex_bounding_box[layer_idx].min.v;
-                        m_texture_space_bounding_boxes_back_[4 * layer_idx + 2] = message_header.tex_bounding_box[layer_idx].max.u;
-                        m_texture_space_bounding_boxes_back_[4 * layer_idx + 3] = message_header.tex_bounding_box[layer_idx].max.v;
-                        //= message_header.texture_bounding_boxes[4*layer_idx + bb_component_idx];
-                    }
-                }
-                else
-                {
-                    m_num_best_triangles_for_sensor_layer_back_[0] = m_model_descriptor_back_.received_textured_tris;
+    int64_t passed_microseconds_to_reply = std::chrono::duration<double>(start_to_reply_diff).count() * 1000000;
 
-                    m_texture_space_bounding_boxes_back_[0] = message_header.tex_bounding_box[0].min.u;
-                    m_texture_space_bounding_boxes_back_[1] = message_header.tex_bounding_box[0].min.v;
-                    m_texture_space_bounding_boxes_back_[2] = message_header.tex_bounding_box[0].max.u;
-                    m_texture_space_bounding_boxes_back_[3] = message_header.tex_bounding_box[0].max.v;
-                }
+    int64_t total_latency_in_microseconds = passed_microseconds_to_reply - passed_microseconds_to_request;
 
-                size_t total_num_received_primitives = m_model_descriptor_back_.received_textured_tris;
+    model_descriptor.request_reply_latency_ms = total_latency_in_microseconds / 1000.0f;
 
-                if(total_num_received_primitives > 50000000)
-                {
-                    return;
-                }
+    frame.lod_scaling = message_header.lod_scaling;
 
-                std::size_t size_of_vertex = 0;
+    if(!model_descriptor.is_fully_encoded_vertex_data)
+    {
+        model_descriptor.received_textured_tris = 0;
 
-                if(false == m_model_descriptor_back_.is_fully_encoded_vertex_data)
-                {
-                    size_of_vertex = 3 * sizeof(uint16_t);
-                }
-                else
-                {
-                    size_of_vertex = 5 * sizeof(float);
-                }
+        for(int layer_idx = 0; layer_idx < MAX_LAYER_IDX; ++layer_idx)
+        {
+            frame.num_best_triangles_for_sensor_layer[layer_idx] = message_header.num_best_triangles_per_sensor[layer_idx];
 
-                size_t textured_tris_byte_size = total_num_received_primitives * 3 * size_of_vertex;
+            model_descriptor.received_textured_tris += message_header.num_best_triangles_per_sensor[layer_idx];
 
-                size_t total_uncompressed_geometry_payload_byte_size = textured_tris_byte_size;
+            frame.texture_space_bounding_boxes[4 * layer_idx + 0] = message_header.tex_bounding_box[layer_idx].min.u;
+            frame.texture_space_bounding_boxes[4 * layer_idx + 1] = message_header.tex_bounding_box[layer_idx].min.v;
+            frame.texture_space_bounding_boxes[4 * layer_idx + 2] = message_header.tex_bounding_box[layer_idx].max.u;
+            frame.texture_space_bounding_boxes[4 * layer_idx + 3] = message_header.tex_bounding_box[layer_idx].max.v;
+        }
+    }
+    else
+    {
+        frame.num_best_triangles_for_sensor_layer.fill(0);
+        frame.num_best_triangles_for_sensor_layer[0] = model_descriptor.received_textured_tris;
 
-                if(m_buffer_back_.size() < total_uncompressed_geometry_payload_byte_size*4) { 
-                    m_buffer_back_.resize(total_uncompressed_geometry_payload_byte_size*4);
-                }
+        frame.texture_space_bounding_boxes[0] = message_header.tex_bounding_box[0].min.u;
+        frame.texture_space_bounding_boxes[1] = message_header.tex_bounding_box[0].min.v;
+        frame.texture_space_bounding_boxes[2] = message_header.tex_bounding_box[0].max.u;
+        frame.texture_space_bounding_boxes[3] = message_header.tex_bounding_box[0].max.v;
+    }
 
-                size_t const total_encoded_geometry_byte_size = m_front_unpack_zmq_message_size_ - (m_model_descriptor_back_.texture_payload_size_in_byte + HEADER_SIZE);
+    size_t total_num_received_primitives = model_descriptor.received_textured_tris;
 
-                if(message_header.is_data_compressed)
-                {
-                    if(m_buffer_back_compressed_.size() < total_encoded_geometry_byte_size) {
-                        m_buffer_back_compressed_.resize(total_encoded_geometry_byte_size);
-                    }
-                    memcpy((unsigned char*)&m_buffer_back_compressed_[0], ((unsigned char*)m_front_zmq_unpack_buffer_.data()) + HEADER_SIZE, total_encoded_geometry_byte_size);
-                }
-                else
-                {
-                    memcpy((unsigned char*)&m_buffer_back_[0], ((unsigned char*)m_front_zmq_unpack_buffer_.data()) + HEADER_SIZE, total_encoded_geometry_byte_size);
-                }
+    if(total_num_received_primitives > 50000000)
+    {
+        return false;
+    }
 
-    #ifdef GUACAMOLE_ENABLE_TURBOJPEG
-                if(message_header.is_data_compressed)
-                {
-                    memcpy((unsigned char*)&m_texture_buffer_back_compressed_[0], ((unsigned char*)m_front_zmq_unpack_buffer_.data()) + HEADER_SIZE + total_encoded_geometry_byte_size, m_model_descriptor_back_.texture_payload_size_in_byte);
-                } else 
-    #endif
-                {
-                    memcpy((unsigned char*)&m_texture_buffer_back_[0], ((unsigned char*)m_front_zmq_unpack_buffer_.data()) + HEADER_SIZE + total_encoded_geometry_byte_size, m_model_descriptor_back_.texture_payload_size_in_byte);
-                }
+    if(message->size() < HEADER_SIZE + model_descriptor.texture_payload_size_in_byte)
+    {
+        gua::Logger::LOG_WARNING << "Received incomplete spoints message, skipping it." << std::endl;
+        return false;
+    }
 
-                for(uint32_t sensor_layer_idx = 0; sensor_layer_idx < 4; ++sensor_layer_idx)
-                {
-                    m_byte_offset_to_jpeg_windows_[sensor_layer_idx] = message_header.jpeg_bytes_per_sensor[sensor_layer_idx];
-                }
+    std::size_t size_of_vertex = 0;
 
-                if(message_header.is_data_compressed)
-                {
-    #ifdef GUACAMOLE_ENABLE_TURBOJPEG
+    if(false == model_descriptor.is_fully_encoded_vertex_data)
+    {
+        size_of_vertex = 3 * sizeof(uint16_t);
+    }
+    else
+    {
+        size_of_vertex = 5 * sizeof(float);
+    }
 
-                auto start_decompression = std::chrono::system_clock::now();
-                    //m_submitted_compressed_geometry_buffer_.store(true);
+    size_t const textured_tris_byte_size = total_num_received_primitives * 3 * size_of_vertex;
 
-                    //m_submitted_compressed_images_.store(true);
+    size_t const total_encoded_geometry_byte_size = message->size() - (model_descriptor.texture_payload_size_in_byte + HEADER_SIZE);
 
-                    _decompress_geometry_buffer();
+    uint8_t const* geometry_payload = ((uint8_t const*)message->data()) + HEADER_SIZE;
+    uint8_t const* texture_payload = geometry_payload + total_encoded_geometry_byte_size;
 
-                    _decompress_images();
+    if(message_header.is_data_compressed)
+    {
+#ifdef GUACAMOLE_ENABLE_TURBOJPEG
+        // the message is decoded straight into the frame's buffers
+        frame.message.reset();
 
-                auto end_decompression = std::chrono::system_clock::now();
+        if(frame.geometry.size() < textured_tris_byte_size)
+        {
+            frame.geometry.resize(textured_tris_byte_size);
+        }
 
-                std::chrono::duration<double> elapsed_seconds = end_decompression-start_decompression;
-        
-    #else
-                    gua::Logger::LOG_WARNING << "TurboJPEG not available. Compile with option ENABLE_TURBOJPEG" << std::endl;
-    #endif // GUACAMOLE_ENABLE_TURBOJPEG
-                }
+        std::vector<std::function<bool()>> tasks;
 
-                { // swap
-                    //std::lock_guard<std::mutex> lock(m_mutex_);
-                    m_need_model_cpu_swap_.store(true);
+        if(!_add_geometry_decompression_tasks(geometry_payload, total_encoded_geometry_byte_size, message_header.is_geometry_chunked, frame, tasks) ||
+           !_add_image_decompression_tasks(texture_payload, model_descriptor.texture_payload_size_in_byte, message_header.jpeg_bytes_per_sensor, frame, tasks))
+        {
+            return false;
+        }
 
-                    for(auto& entry : m_need_model_gpu_swap_)
-                    {
-                        entry.second.store(true);
-                    }
-                    // mutable std::unordered_map<std::size_t,
-                }
-            }
+        // geometry chunks and sensor layers are decoded at the same time
+        return m_decode_workers_.run(tasks);
+#else
+        gua::Logger::LOG_WARNING << "TurboJPEG not available. Compile with option ENABLE_TURBOJPEG" << std::endl;
+        return false;
+#endif // GUACAMOLE_ENABLE_TURBOJPEG
+    }
 
-        }
-    
+    // uncompressed payload is uploaded straight from the message
+    frame.message = message;
+    frame.geometry_data = geometry_payload;
+    frame.geometry_size = total_encoded_geometry_byte_size;
+    frame.texture_data = texture_payload;
+    frame.texture_size = model_descriptor.texture_payload_size_in_byte;
 
+    return true;
 }
 
 #ifdef GUACAMOLE_ENABLE_TURBOJPEG
 
-void NetKinectArray::_decompress_geometry_buffer() {
+bool NetKinectArray::_add_geometry_decompression_tasks(
+    uint8_t const* compressed, std::size_t compressed_size, bool is_chunked, SPointsFrame& frame, std::vector<std::function<bool()>>& tasks)
+{
+    std::vector<SGTP::geometry_chunk_t> chunks;
+    std::size_t chunk_table_size = 0;
 
-    //while(true) {
-        //while(!m_submitted_compressed_geometry_buffer_.load()) {
-        //    ;
-        //}
-        //m_submitted_compressed_geometry_buffer_.store(false);
+    if(is_chunked)
+    {
+        // the flag lives in former padding of the header, so older senders may set it by accident
+        chunk_table_size = read_geometry_chunk_table(compressed, compressed_size, chunks);
+    }
 
-        int num_decompressed_bytes = LZ4_decompress_safe((const char*)&m_buffer_back_compressed_[0], (char*)&m_buffer_back_[0], m_buffer_back_compressed_.size(), m_buffer_back_.size());
+    frame.geometry_data = frame.geometry.data();
 
-     //   m_geometry_decompressor_finished_.store(true);
-    //}
-}
+    if(chunks.empty())
+    {
+        // a single LZ4 block as sent before v0.2.4
+        tasks.push_back([compressed, compressed_size, &frame]() {
+            int num_decompressed_bytes = LZ4_decompress_safe((const char*)compressed, (char*)frame.geometry.data(), compressed_size, frame.geometry.size());
 
-void NetKinectArray::_decompress_images()
-{
+            if(num_decompressed_bytes < 0)
+            {
+                gua::Logger::LOG_WARNING << "Failed to decompress spoints geometry, skipping frame." << std::endl;
+                return false;
+            }
 
-    //while(true) {
-    //    while(!m_submitted_compressed_images_.load()) {
-    //        ;
-    //    }
-        m_submitted_compressed_images_.store(false);
-        
+            frame.geometry_size = num_decompressed_bytes;
+            return true;
+        });
 
+        return true;
+    }
 
-            for(uint32_t sensor_layer_idx = 0; sensor_layer_idx < 4; ++sensor_layer_idx) {
-                if(nullptr == m_tj_compressed_image_buffer_per_layer_[sensor_layer_idx])
-                {
-                    m_tj_compressed_image_buffer_per_layer_[sensor_layer_idx] = tjAlloc(1024 * 1024 * 50);
-                }
-            }
+    std::size_t total_decompressed_size = 0;
 
+    for(auto const& chunk : chunks)
+    {
+        total_decompressed_size += chunk.decompressed_size;
+    }
 
-            std::size_t byte_offset_to_current_image = 0;
+    if(frame.geometry.size() < total_decompressed_size)
+    {
+        frame.geometry.resize(total_decompressed_size);
+    }
 
-            std::size_t total_image_byte_size = 0;
+    frame.geometry_data = frame.geometry.data();
+    frame.geometry_size = total_decompressed_size;
 
-            std::size_t decompressed_image_offset = 0;
+    // contiguous runs of chunks, at most one task per core
+    std::size_t const num_tasks = std::min<std::size_t>(chunks.size(), std::max(1u, std::thread::hardware_concurrency()));
 
-            for(uint32_t sensor_layer_idx = 0; sensor_layer_idx < 4; ++sensor_layer_idx)
-            {
-                total_image_byte_size += m_byte_offset_to_jpeg_windows_[sensor_layer_idx];// byte_offset_to_jpeg_windows[sensor_layer_idx];
-            }
+    char const* source = (char const*)compressed + chunk_table_size;
+    char* destination = (char*)frame.geometry.data();
+
+    for(std::size_t task_idx = 0; task_idx < num_tasks; ++task_idx)
+    {
+        std::vector<LZ4Chunk> task_chunks;
 
-            for(uint32_t sensor_layer_idx = 0; sensor_layer_idx < 4; ++sensor_layer_idx)
+        for(std::size_t chunk_idx = chunks.size() * task_idx / num_tasks; chunk_idx < chunks.size() * (task_idx + 1) / num_tasks; ++chunk_idx)
+        {
+            LZ4Chunk chunk;
+            chunk.source = source;
+            chunk.source_size = chunks[chunk_idx].compressed_size;
+            chunk.destination = destination;
+            chunk.destination_size = chunks[chunk_idx].decompressed_size;
+            task_chunks.push_back(chunk);
+
+            source += chunk.source_size;
+            destination += chunk.destination_size;
+        }
+
+        tasks.push_back(std::bind(&decompress_chunks, std::move(task_chunks)));
+    }
+
+    return true;
+}
+
+bool NetKinectArray::_add_image_decompression_tasks(
+    uint8_t const* compressed, std::size_t compressed_size, uint32_t const* jpeg_bytes_per_sensor, SPointsFrame& frame, std::vector<std::function<bool()>>& tasks)
+{
+    // large enough for the full texture atlas
+    std::size_t const MAX_TEXTURE_BYTE_SIZE = 11059200;
+
+    if(frame.texture.size() < MAX_TEXTURE_BYTE_SIZE)
+    {
+        frame.texture.resize(MAX_TEXTURE_BYTE_SIZE);
+    }
+
+    for(uint32_t sensor_layer_idx = 0; sensor_layer_idx < 4; ++sensor_layer_idx)
+    {
+        if(0 == m_jpeg_decompressor_per_layer[sensor_layer_idx])
+        {
+            m_jpeg_decompressor_per_layer[sensor_layer_idx] = tjInitDecompress();
+            if(m_jpeg_decompressor_per_layer[sensor_layer_idx] == NULL)
             {
-                //if(m_jpeg_decompressor_per_layer.end() == m_jpeg_decompressor_per_layer.find(sensor_layer_idx))
-                if(0 == m_jpeg_decompressor_per_layer[sensor_layer_idx])
-                {
-                    m_jpeg_decompressor_per_layer[sensor_layer_idx] = tjInitDecompress();
-                    if(m_jpeg_decompressor_per_layer[sensor_layer_idx] == NULL)
-                    {
-                        std::cout << "ERROR INITIALIZING DECOMPRESSOR\n";
-                    }
-                }
+                gua::Logger::LOG_ERROR << "Failed to initialize JPEG decompressor." << std::endl;
+                return false;
             }
+        }
+    }
 
-            bool skip_decompression = false;
-            for(uint32_t sensor_layer_idx = 0; sensor_layer_idx < 4; ++sensor_layer_idx) 
-            {
-                long unsigned int jpeg_size = m_byte_offset_to_jpeg_windows_[sensor_layer_idx];
+    std::size_t byte_offset_to_current_image = 0;
+    std::size_t decompressed_image_offset = 0;
 
-                //memcpy((char*)&m_tj_compressed_image_buffer_per_layer_[sensor_layer_idx][0], (char*)&m_texture_buffer_back_compressed_[byte_offset_to_current_image], jpeg_size);
+    // reading the JPEG headers is cheap and yields the atlas offsets, the layers
+    // are then decoded concurrently, each with its own decompressor
+    for(uint32_t sensor_layer_idx = 0; sensor_layer_idx < 4; ++sensor_layer_idx)
+    {
+        long unsigned int jpeg_size = jpeg_bytes_per_sensor[sensor_layer_idx];
 
-                int header_width, header_height, header_subsamp;
+        if(0 == jpeg_size)
+        {
+            continue;
+        }
 
-                auto& current_decompressor_handle = m_jpeg_decompressor_per_layer[sensor_layer_idx];
+        if(byte_offset_to_current_image + jpeg_size > compressed_size)
+        {
+            gua::Logger::LOG_WARNING << "JPEG data exceeds spoints message, skipping frame." << std::endl;
+            return false;
+        }
 
-                int error_handle = tjDecompressHeader2(current_decompressor_handle, (unsigned char*)&m_texture_buffer_back_compressed_[byte_offset_to_current_image], jpeg_size, &header_width, &header_height, &header_subsamp);
+        int header_width, header_height, header_subsamp;
 
-                if(-1 == error_handle)
-                {
-                    std::cout << "ERROR DECOMPRESSING JPEG\n";
-                    std::cout << "Error was: " << tjGetErrorStr() << "\n";
+        auto current_decompressor_handle = m_jpeg_decompressor_per_layer[sensor_layer_idx];
+        unsigned char* current_image = (unsigned char*)&compressed[byte_offset_to_current_image];
 
-                    std::cout << "JPEG SIZE IN BYTE:" << jpeg_size << "\n";
-                    std::cout << "Skipping frame again 6.\n";
-                    m_image_decompression_without_errors_.store(false);
+        int error_handle = tjDecompressHeader2(current_decompressor_handle, current_image, jpeg_size, &header_width, &header_height, &header_subsamp);
 
-                    skip_decompression = true;
-                }
+        if(-1 == error_handle)
+        {
+            gua::Logger::LOG_WARNING << "Failed to decompress JPEG of " << jpeg_size << " bytes: " << tjGetErrorStr() << ", skipping frame." << std::endl;
+            return false;
+        }
 
-                if(!skip_decompression) {
-                    tjDecompress2(current_decompressor_handle,
-                                  (unsigned char*)&m_texture_buffer_back_compressed_[byte_offset_to_current_image],
-                                  jpeg_size,
-                                  &m_texture_buffer_back_[decompressed_image_offset],
-                                  header_width,
-                                  0,
-                                  header_height,
-                                  TJPF_BGR,
-                                  TJFLAG_FASTDCT);
-
-                    uint32_t copied_image_byte = header_height * header_width * 3;
-
-                    byte_offset_to_current_image += jpeg_size;
-                    decompressed_image_offset += copied_image_byte;
-                }
-            }
+        std::size_t const image_byte_size = std::size_t(header_height) * header_width * 3;
 
-            if(!skip_decompression) {
-                m_image_decompression_without_errors_.store(true);
+        if(decompressed_image_offset + image_byte_size > frame.texture.size())
+        {
+            gua::Logger::LOG_WARNING << "Decompressed JPEG exceeds texture atlas, skipping frame." << std::endl;
+            return false;
+        }
+
+        unsigned char* current_destination = &frame.texture[decompressed_image_offset];
+
+        tasks.push_back([current_decompressor_handle, current_image, jpeg_size, current_destination, header_width, header_height]() {
+            if(-1 == tjDecompress2(current_decompressor_handle, current_image, jpeg_size, current_destination, header_width, 0, header_height, TJPF_BGR, TJFLAG_FASTDCT))
+            {
+                gua::Logger::LOG_WARNING << "Failed to decompress JPEG of " << jpeg_size << " bytes, skipping frame." << std::endl;
+                return false;
             }
+            return true;
+        });
 
-            //memcpy((char*)m_texture_buffer_back_.data(), (char*)m_decompressed_image_buffer_.data(), decompressed_image_offset);
-        m_image_decompressor_finished_.store(true);
-    //}
+        byte_offset_to_current_image += jpeg_size;
+        decompressed_image_offset += image_byte_size;
+    }
 
+    frame.texture_data = frame.texture.data();
+    frame.texture_size = decompressed_image_offset;
+    return true;
 }
 #endif //GUACAMOLE_ENABLE_TURBOJPEG
 
@@ -1039,38 +1148,53 @@ void NetKinectArray::_readloop()
     int conflate_messages = 1;
     socket.setsockopt(ZMQ_CONFLATE, &conflate_messages, sizeof(conflate_messages));
 
-    std::string endpoint("tcp://" + m_server_endpoint_);
-    socket.connect(endpoint.c_str());
-
-    const unsigned message_size = sizeof(size_t); //(m_colorsize_byte + m_depthsize_byte) * m_calib_files.size();
+    // wake up regularly to notice shutdown
+    int receive_timeout_ms = 100;
+    socket.setsockopt(ZMQ_RCVTIMEO, &receive_timeout_ms, sizeof(receive_timeout_ms));
 
-    // size_t header_byte_size = 100;
-    // std::vector<uint8_t> header_data(header_byte_size, 0);
-
-
-    zmq::message_t zmqm;
+    // plain host:port means tcp, other transports (e.g. ipc://) are passed on
+    std::string endpoint(m_server_endpoint_.find("://") == std::string::npos ? "tcp://" + m_server_endpoint_ : m_server_endpoint_);
+    socket.connect(endpoint.c_str());
 
-    auto pre_loop_time_stamp = std::chrono::system_clock::now();
-    auto current_timestamp = std::chrono::system_clock::now();
     while(m_running_)
     {
+        std::unique_ptr<zmq::message_t> message(new zmq::message_t());
 
-        socket.recv(&zmqm); // blocking
+        if(!socket.recv(message.get())) // blocking until timeout
         {
-            std::lock_guard<std::mutex> unpack_lock(m_unpack_mutex_);
+            continue;
+        }
 
-            m_has_new_message_to_unpack = true;
-            memcpy( (char*) m_back_zmq_unpack_buffer_.data(), zmqm.data(), zmqm.size());
-            m_back_unpack_zmq_message_size_ = zmqm.size();
+        auto recorder(std::atomic_load(&m_recorder_));
+        if(recorder)
+        {
+            recorder->write(message->data(), message->size());
         }
 
-        pre_loop_time_stamp = current_timestamp;
-        current_timestamp = std::chrono::system_clock::now();
+        // ownership of the message is handed to the decode stage, nothing is copied
+        m_received_messages_.push(std::move(message));
+    }
+}
+
+void NetKinectArray::_replayloop()
+{
+    bool const is_paced = m_player_->get_speed() > 0.f;
 
-        std::chrono::duration<double> elapsed_receive_seconds = current_timestamp-pre_loop_time_stamp;
+    gua::MessageRecording::Message recorded;
 
-        //std::cout << "elapsed milliseconds since last receive: " << elapsed_receive_seconds.count() * 1000.0f << "ms" << std::endl;
+    while(m_running_ && m_player_->next(recorded))
+    {
+        // the message refers to the mapped recording, which is kept alive until zmq releases it
+        std::unique_ptr<zmq::message_t> message(new zmq::message_t(
+            const_cast<uint8_t*>(recorded.data), recorded.size, &release_recording, new std::shared_ptr<gua::MessageRecording const>(m_player_->get_recording())));
+
+        // an unpaced replay must not lose messages to the conflating queue
+        if(!is_paced && !m_received_messages_.wait_until_empty())
+        {
+            break;
+        }
 
+        m_received_messages_.push(std::move(message));
     }
 }
 
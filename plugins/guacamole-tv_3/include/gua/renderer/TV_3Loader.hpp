@@ -58,7 +58,9 @@ class GUA_TV_3_DLL TV_3Loader
         MAKE_PICKABLE = 1 << 0,
         NORMALIZE_POSITION = 1 << 1,
         NORMALIZE_SCALE = 1 << 2,
-        USE_SURFACE_MODE = 1 << 3
+        USE_SURFACE_MODE = 1 << 3,
+        // stream time steps from disk even if the sequence fits into the cpu budget
+        STREAM_TIME_STEPS = 1 << 4
     };
 
     TV_3Loader();
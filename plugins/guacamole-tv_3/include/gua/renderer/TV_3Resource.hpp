@@ -28,6 +28,8 @@
 #include <gua/renderer/GeometryResource.hpp>
 #include <gua/renderer/ShaderProgram.hpp>
 #include <gua/utils/KDTree.hpp>
+#include <gua/utils/TimeStepStreamer.hpp>
+#include <gua/utils/VolumeBrickGrid.hpp>
 
 // external headers
 #include <scm/core/math.h>
@@ -45,6 +47,8 @@
 #include <scm/core/utilities/platform_warning_disable.h>
 
 #include <chrono>
+#include <mutex>
+#include <unordered_map>
 //#include <pbr/types.h>
 //#include <pbr/ren/model_database.h>
 //#include <pbr/ren/cut_database.h>
@@ -97,7 +101,17 @@ class TV_3Resource : public GeometryResource
   public: // c'tor /d'tor
     static void tokenize_volume_name(std::string const& string_to_split, std::map<std::string, uint64_t>& tokens);
 
-    TV_3Resource(std::string const& resource_file_string, bool is_pickable, CompressionMode compression_mode = CompressionMode::UNCOMPRESSED);
+    /**
+     * Sequences which don't fit into cpu_budget_in_bytes, or all sequences if
+     * stream_time_steps is set, are streamed from disk: only a window of time
+     * steps around the time cursor is kept in memory and a single 3D texture
+     * per context is updated when the cursor moves to another step.
+     */
+    TV_3Resource(std::string const& resource_file_string,
+                 bool is_pickable,
+                 CompressionMode compression_mode = CompressionMode::UNCOMPRESSED,
+                 bool stream_time_steps = false,
+                 std::size_t cpu_budget_in_bytes = std::size_t(1024) * 1024 * 1024);
 
     ~TV_3Resource();
 
@@ -138,7 +152,19 @@ class TV_3Resource : public GeometryResource
 
     void ray_test(Ray const& ray, int options, node::Node* owner, std::set<PickResult>& hits);
 
+    bool is_streaming() const { return streamer_ != nullptr; }
+    // nullptr unless the time steps are streamed
+    std::shared_ptr<TimeStepStreamer> const& get_time_step_streamer() const { return streamer_; }
+
   protected:
+    // loader threads shared by the streamers of all resources
+    static std::shared_ptr<TimeStepLoaderPool> shared_loaders();
+
+    void get_volume_format(scm::math::vec3ui& volume_dimensions, scm::gl::data_format& format) const;
+    void upload_streamed_to(RenderContext const& context) const;
+    // builds or loads the brick grid over all time steps held in memory
+    void load_brick_grid() const;
+
     // std::shared_ptr<*/scm::gl::box_volume_geometry> volume_proxy_;
     bool is_pickable_;
     math::mat4 local_transform_;
@@ -154,11 +180,31 @@ class TV_3Resource : public GeometryResource
 
     mutable std::chrono::high_resolution_clock::time_point last_time_point_ = std::chrono::high_resolution_clock::now();
 
-    static std::mutex cpu_volume_loading_mutex_;
-    static std::map<std::size_t, bool> are_cpu_time_steps_loaded_;
-    static std::map<std::size_t, std::map<std::string, uint64_t>> volume_descriptor_tokens_;
-    static std::map<std::size_t, std::vector<std::ifstream>> per_resource_file_streams_;
-    static std::map<std::size_t, std::vector<std::vector<uint8_t>>> per_resource_cpu_cache_;
+    // owned by each resource, loading one dataset never blocks another one
+    mutable std::map<std::string, uint64_t> volume_descriptor_tokens_;
+    std::vector<std::string> time_step_files_;
+    mutable std::once_flag cpu_time_steps_loaded_;
+    mutable std::vector<std::vector<uint8_t>> cpu_cache_;
+
+    std::shared_ptr<TimeStepStreamer> streamer_;
+    // time step currently held by the streamed texture of each context
+    mutable std::mutex streamed_time_steps_mutex_;
+    mutable std::unordered_map<unsigned, int32_t> streamed_time_steps_;
+
+    // empty space skipping for uncompressed sequences held in memory, the bricks cover all time steps
+    mutable VolumeBrickGrid brick_grid_;
+    mutable std::vector<uint8_t> skip_grid_;
+    struct SkipTexture
+    {
+        scm::gl::texture_3d_ptr texture;
+        // integer textures are incomplete with linear filtering
+        scm::gl::sampler_state_ptr sampler;
+    };
+    mutable std::mutex skip_textures_mutex_;
+    mutable std::unordered_map<unsigned, SkipTexture> skip_textures_;
+
+    // the uploads to all contexts, untracked with the resource
+    mutable GpuMemoryAllocations memory_allocations_;
 };
 
 } // namespace gua
@@ -63,7 +63,11 @@ class TV_3Node;
 class TV_3ResourceVQCompressed : public TV_3Resource
 {
   public: // c'tor /d'tor
-    TV_3ResourceVQCompressed(std::string const& resource_file_string, bool is_pickable);
+    /**
+     * The index volumes are streamed within half of cpu_budget_in_bytes, the
+     * codebooks use the rest.
+     */
+    TV_3ResourceVQCompressed(std::string const& resource_file_string, bool is_pickable, bool stream_time_steps = false, std::size_t cpu_budget_in_bytes = std::size_t(1024) * 1024 * 1024);
 
     ~TV_3ResourceVQCompressed();
 
@@ -96,12 +100,16 @@ class TV_3ResourceVQCompressed : public TV_3Resource
                       std::set<PickResult>& hits);
     */
 
+    // streams the codebooks, one per time step in multi codebook mode
+    std::shared_ptr<TimeStepStreamer> const& get_codebook_streamer() const { return codebook_streamer_; }
+
   protected:
     mutable int32_t num_codebooks_ = 0;
-    static std::mutex cpu_codebook_loading_mutex_;
-    static std::map<std::size_t, bool> are_cpu_codebooks_loaded_;
-    static std::map<std::size_t, std::vector<std::ifstream>> per_resource_codebook_file_streams_;
-    static std::map<std::size_t, std::vector<std::vector<uint8_t>>> per_resource_codebook_cpu_cache_;
+    scm::math::vec2ui codebook_dimensions_;
+    std::shared_ptr<TimeStepStreamer> codebook_streamer_;
+    // codebook currently held by the codebook texture of each context
+    mutable std::mutex streamed_codebooks_mutex_;
+    mutable std::unordered_map<unsigned, int32_t> streamed_codebooks_;
 };
 
 } // namespace gua
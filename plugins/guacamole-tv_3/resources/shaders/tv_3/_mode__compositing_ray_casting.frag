@@ -18,6 +18,15 @@ vec3 raycast_compositing(out vec4 out_composited_color) {
 
   while(is_inside_vol(current_pos) ) {
 
+    // samples below the opacity threshold contribute nothing, jump over bricks which only hold those
+    if(empty_space_skipping != 0) {
+      int empty_steps = get_empty_steps(current_pos, ray_increment);
+      if(empty_steps > 0) {
+        current_pos += float(empty_steps) * ray_increment;
+        continue;
+      }
+    }
+
     // get sample
     float s   = get_mode_independent_sample(current_pos);
 
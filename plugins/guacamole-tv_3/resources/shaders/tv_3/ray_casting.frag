@@ -48,6 +48,11 @@ uniform ivec3 volume_dimensions = ivec3(0, 0, 0);
 
 uniform float iso_value = 0.5;
 
+// empty space skipping, one texel per brick holding the distance to the next visible brick
+layout(binding=4) uniform usampler3D skip_texture;
+uniform int empty_space_skipping = 0;
+uniform vec3 brick_grid_scale = vec3(1.0);
+
 
 vec3 ms_shading_pos = vec3(0.0, 0.0, 0.0);
 
@@ -83,6 +88,24 @@ bool is_inside_vol(vec3 pos) {
       && all(lessThanEqual(pos, vec3(1.0) ) );
 }
 
+// number of ray increments which stay within empty bricks, 0 if the brick at the position is visible
+int get_empty_steps(vec3 pos, vec3 increment) {
+  vec3 brick_pos = pos * brick_grid_scale;
+  uint distance  = texelFetch(skip_texture, ivec3(brick_pos), 0).r;
+
+  if (distance == 0u) {
+    return 0;
+  }
+
+  // all bricks closer than distance are empty, find where the ray leaves them
+  vec3 brick_increment = increment * brick_grid_scale;
+  vec3 brick           = floor(brick_pos);
+  vec3 exit_plane      = mix(brick - vec3(float(distance) - 1.0), brick + vec3(float(distance)), greaterThan(brick_increment, vec3(0.0)));
+  vec3 exit_steps      = mix(vec3(1e20), (exit_plane - brick_pos) / brick_increment, greaterThan(abs(brick_increment), vec3(1e-7)));
+
+  return int(floor(min(min(exit_steps.x, exit_steps.y), exit_steps.z)));
+}
+
 vec2 intersect_ray_with_unit_box(in vec3 origin, in vec3 direction ) {
   vec2 t_min_max = vec2(0.0, 0.0);
 
@@ -31,6 +31,9 @@
 #include <gua/databases/MaterialShaderDatabase.hpp>
 #include <gua/renderer/TV_3ResourceVQCompressed.hpp>
 
+// external headers
+#include <algorithm>
+
 namespace gua
 {
 /////////////////////////////////////////////////////////////////////////////
@@ -121,14 +124,17 @@ std::shared_ptr<node::Node> TV_3Loader::load_geometry(std::string const& file_na
             // cached_node = load(file_name, flags);
             GeometryDescription desc("TV_3", file_name, 0, flags);
 
+            std::size_t const cpu_budget_in_bytes = std::size_t(std::max(1, cpu_budget)) * 1024 * 1024;
+
             std::shared_ptr<TV_3Resource> resource = nullptr;
             if(file_name.find("SW_VQ") != std::string::npos)
             {
-                resource = std::make_shared<TV_3ResourceVQCompressed>(file_name, flags & TV_3Loader::MAKE_PICKABLE);
+                resource = std::make_shared<TV_3ResourceVQCompressed>(file_name, flags & TV_3Loader::MAKE_PICKABLE, flags & TV_3Loader::STREAM_TIME_STEPS, cpu_budget_in_bytes);
             }
             else
             {
-                resource = std::make_shared<TV_3Resource>(file_name, flags & TV_3Loader::MAKE_PICKABLE);
+                resource = std::make_shared<TV_3Resource>(
+                    file_name, flags & TV_3Loader::MAKE_PICKABLE, TV_3Resource::CompressionMode::UNCOMPRESSED, flags & TV_3Loader::STREAM_TIME_STEPS, cpu_budget_in_bytes);
             }
 
             GeometryDatabase::instance()->add(desc.unique_key(), resource);
@@ -183,7 +189,7 @@ std::shared_ptr<node::Node> TV_3Loader::load_geometry(std::string const& file_na
 std::shared_ptr<node::Node> TV_3Loader::create_geometry_from_file(
     std::string const& node_name, std::string const& file_name, std::shared_ptr<Material> const& fallback_material, unsigned flags, int const cpu_budget, int const gpu_budget)
 {
-    auto cached_node(load_geometry(file_name, flags));
+    auto cached_node(load_geometry(file_name, flags, cpu_budget, gpu_budget));
 
     if(cached_node)
     {
@@ -202,7 +208,7 @@ std::shared_ptr<node::Node> TV_3Loader::create_geometry_from_file(
 
 std::shared_ptr<node::Node> TV_3Loader::create_geometry_from_file(std::string const& node_name, std::string const& file_name, unsigned flags, int const cpu_budget, int const gpu_budget)
 {
-    auto cached_node(load_geometry(file_name, flags));
+    auto cached_node(load_geometry(file_name, flags, cpu_budget, gpu_budget));
 
     if(cached_node)
     {
@@ -52,14 +52,15 @@
 #include <algorithm>
 #include <regex>
 #include <fstream>
+#include <thread>
 
 namespace gua
 {
-std::mutex TV_3Resource::cpu_volume_loading_mutex_;
-std::map<std::size_t, bool> TV_3Resource::are_cpu_time_steps_loaded_;
-std::map<std::size_t, std::map<std::string, uint64_t>> TV_3Resource::volume_descriptor_tokens_;
-std::map<std::size_t, std::vector<std::ifstream>> TV_3Resource::per_resource_file_streams_;
-std::map<std::size_t, std::vector<std::vector<uint8_t>>> TV_3Resource::per_resource_cpu_cache_;
+namespace
+{
+// the compositing ray caster treats all samples below this value as transparent
+float const COMPOSITING_OPACITY_THRESHOLD = 0.5f;
+} // namespace
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -124,7 +125,7 @@ void TV_3Resource::tokenize_volume_name(std::string const& string_to_split, std:
 
 ////////////////////////////////////////////////////////////////////////////////
 
-TV_3Resource::TV_3Resource(std::string const& resource_file_string, bool is_pickable, CompressionMode compression_mode)
+TV_3Resource::TV_3Resource(std::string const& resource_file_string, bool is_pickable, CompressionMode compression_mode, bool stream_time_steps, std::size_t cpu_budget_in_bytes)
     : resource_file_name_(resource_file_string), is_pickable_(is_pickable), compression_mode_(compression_mode),
       local_transform_(gua::math::mat4(1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0))
 {
@@ -133,41 +134,37 @@ TV_3Resource::TV_3Resource(std::string const& resource_file_string, bool is_pick
     bounding_box_.min = scm::math::vec3(0.0f, 0.0f, 0.0f);
     bounding_box_.max = scm::math::vec3(1.0f, 1.0f, 1.0f);
 
-    cpu_volume_loading_mutex_.lock();
-
-    if(!are_cpu_time_steps_loaded_[uuid_])
+    if(resource_file_name_.find(".v_rsc") != std::string::npos)
     {
-        std::vector<std::string> volumes_to_load;
-        if(resource_file_name_.find(".v_rsc") != std::string::npos)
+        std::string line_buffer;
+        std::ifstream volume_resource_file(resource_file_name_, std::ios::in);
+        while(std::getline(volume_resource_file, line_buffer))
         {
-            std::string line_buffer;
-            std::ifstream volume_resource_file(resource_file_name_, std::ios::in);
-            while(std::getline(volume_resource_file, line_buffer))
+            if(line_buffer.find(".raw") != std::string::npos)
             {
-                if(line_buffer.find(".raw") != std::string::npos)
-                {
-                    volumes_to_load.push_back(line_buffer);
-                }
+                time_step_files_.push_back(line_buffer);
             }
         }
-        else
-        {
-            volumes_to_load.push_back(resource_file_name_);
-        }
+    }
+    else
+    {
+        time_step_files_.push_back(resource_file_name_);
+    }
 
-        uint8_t num_parsed_volumes = 0;
-        for(auto const& vol_path : volumes_to_load)
-        {
-            if(0 == num_parsed_volumes++)
-            {
-                tokenize_volume_name(vol_path, volume_descriptor_tokens_[uuid_]);
-            }
+    if(!time_step_files_.empty())
+    {
+        tokenize_volume_name(time_step_files_.front(), volume_descriptor_tokens_);
+    }
 
-            per_resource_file_streams_[uuid_].push_back(std::ifstream(vol_path.c_str(), std::ios::in | std::ios::binary));
-        }
-        are_cpu_time_steps_loaded_[uuid_] = true;
+    std::size_t const num_bytes_per_time_step(volume_descriptor_tokens_["total_num_bytes"]);
+
+    if(stream_time_steps || time_step_files_.size() * num_bytes_per_time_step > cpu_budget_in_bytes)
+    {
+        streamer_ = std::make_shared<TimeStepStreamer>(time_step_files_, num_bytes_per_time_step, cpu_budget_in_bytes, shared_loaders());
+        num_time_steps_ = int32_t(time_step_files_.size());
+        Logger::LOG_MESSAGE << "Streaming " << time_step_files_.size() << " time steps of \"" << resource_file_name_ << "\" with a window of " << streamer_->get_window_size() << " steps."
+                            << std::endl;
     }
-    cpu_volume_loading_mutex_.unlock();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -176,89 +173,158 @@ TV_3Resource::~TV_3Resource() {}
 
 ////////////////////////////////////////////////////////////////////////////////
 
+std::shared_ptr<TimeStepLoaderPool> TV_3Resource::shared_loaders()
+{
+    static std::mutex mutex;
+    static std::weak_ptr<TimeStepLoaderPool> shared;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // released with the last streamer
+    auto loaders(shared.lock());
+    if(!loaders)
+    {
+        loaders = std::make_shared<TimeStepLoaderPool>(std::max(1u, std::thread::hardware_concurrency()));
+        shared = loaders;
+    }
+
+    return loaders;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void TV_3Resource::draw(RenderContext const& ctx, scm::gl::vertex_array_ptr const& vertex_array) const
 {
     // dummy
 }
 
-void TV_3Resource::apply_resource_dependent_uniforms(RenderContext const& ctx, std::shared_ptr<ShaderProgram> const& current_program) const {
+void TV_3Resource::apply_resource_dependent_uniforms(RenderContext const& ctx, std::shared_ptr<ShaderProgram> const& current_program) const
+{
+    bool skip_empty_space = false;
+    {
+        std::lock_guard<std::mutex> lock(skip_textures_mutex_);
+        skip_empty_space = skip_textures_.count(ctx.id) > 0;
+    }
 
-};
+    if(skip_empty_space)
+    {
+        auto const& volume_dimensions(brick_grid_.get_volume_dimensions());
+        float const brick_size(brick_grid_.get_brick_size());
+        current_program->apply_uniform(ctx, "brick_grid_scale", math::vec3f(volume_dimensions[0] / brick_size, volume_dimensions[1] / brick_size, volume_dimensions[2] / brick_size));
+    }
+    current_program->apply_uniform(ctx, "empty_space_skipping", int32_t(skip_empty_space));
+}
 
-void TV_3Resource::upload_to(RenderContext const& ctx) const
+void TV_3Resource::get_volume_format(scm::math::vec3ui& vol_dims, scm::gl::data_format& read_format) const
 {
-    if(are_cpu_time_steps_loaded_[uuid_])
-    {
-        int32_t loaded_volumes_count = 0;
+    auto& current_tokens = volume_descriptor_tokens_;
 
-        auto& current_tokens = volume_descriptor_tokens_[uuid_];
+    vol_dims = scm::math::vec3ui(current_tokens["w"], current_tokens["h"], current_tokens["d"]);
+    read_format = scm::gl::data_format::FORMAT_NULL;
 
-        for(auto& vol_path : per_resource_file_streams_[uuid_])
+    int64_t num_bytes_per_voxel = current_tokens["num_bytes_per_voxel"];
+
+    if(CompressionMode::UNCOMPRESSED != compression_mode_)
+    {
+        int64_t const num_index_bytes = current_tokens["i"] / 8;
+        int64_t const block_size = current_tokens["bs"];
+        for(int dim_idx = 0; dim_idx < 3; ++dim_idx)
         {
-            scm::math::vec3ui vol_dims = scm::math::vec3ui(current_tokens["w"], current_tokens["h"], current_tokens["d"]);
+            vol_dims[dim_idx] /= block_size;
+        }
 
-            int64_t num_bytes_per_voxel = current_tokens["num_bytes_per_voxel"];
+        if(1 == num_index_bytes)
+        {
+            read_format = scm::gl::data_format::FORMAT_R_8UI;
+        }
+        else if(2 == num_index_bytes)
+        {
+            read_format = scm::gl::data_format::FORMAT_R_16UI;
+        }
+        else if(3 == num_index_bytes)
+        {
+            read_format = scm::gl::data_format::FORMAT_RGB_8UI;
+        }
+        else if(4 == num_index_bytes)
+        {
+            read_format = scm::gl::data_format::FORMAT_R_32UI;
+        }
+    }
+    else
+    {
+        if(1 == num_bytes_per_voxel)
+        {
+            read_format = scm::gl::data_format::FORMAT_R_8;
+        }
+        else if(2 == num_bytes_per_voxel)
+        {
+            read_format = scm::gl::data_format::FORMAT_R_16;
+        }
+        else if(4 == num_bytes_per_voxel)
+        {
+            read_format = scm::gl::data_format::FORMAT_R_32F;
+        }
+    }
+}
 
-            int64_t num_voxels = current_tokens["total_num_bytes"];
+void TV_3Resource::upload_to(RenderContext const& ctx) const
+{
+    if(streamer_)
+    {
+        upload_streamed_to(ctx);
+        return;
+    }
 
-            // std::vector<unsigned char> read_buffer(num_voxels);
+    // read once, the cpu copies are shared by all contexts
+    std::call_once(cpu_time_steps_loaded_, [this]() {
+        std::size_t const num_bytes_per_time_step(volume_descriptor_tokens_["total_num_bytes"]);
 
-            per_resource_cpu_cache_[uuid_].push_back(std::vector<uint8_t>(num_voxels, 0));
-            vol_path.read((char*)&per_resource_cpu_cache_[uuid_][loaded_volumes_count][0], num_voxels);
+        for(auto const& vol_path : time_step_files_)
+        {
+            cpu_cache_.push_back(std::vector<uint8_t>(num_bytes_per_time_step, 0));
+            std::ifstream(vol_path.c_str(), std::ios::in | std::ios::binary).read((char*)&cpu_cache_.back()[0], num_bytes_per_time_step);
+        }
 
-            scm::gl::data_format read_format = scm::gl::data_format::FORMAT_NULL;
+        if(CompressionMode::UNCOMPRESSED == compression_mode_)
+        {
+            load_brick_grid();
+        }
+    });
 
-            if(CompressionMode::UNCOMPRESSED != compression_mode_)
-            {
-                int64_t const num_index_bytes = current_tokens["i"] / 8;
-                int64_t const block_size = current_tokens["bs"];
-                for(int dim_idx = 0; dim_idx < 3; ++dim_idx)
-                {
-                    vol_dims[dim_idx] /= block_size;
-                }
+    {
+        int32_t loaded_volumes_count = 0;
+        std::size_t uploaded_bytes = 0;
 
-                if(1 == num_index_bytes)
-                {
-                    read_format = scm::gl::data_format::FORMAT_R_8UI;
-                }
-                else if(2 == num_index_bytes)
-                {
-                    read_format = scm::gl::data_format::FORMAT_R_16UI;
-                }
-                else if(3 == num_index_bytes)
-                {
-                    read_format = scm::gl::data_format::FORMAT_RGB_8UI;
-                }
-                else if(4 == num_index_bytes)
-                {
-                    read_format = scm::gl::data_format::FORMAT_R_32UI;
-                }
-            }
-            else
-            {
-                if(1 == num_bytes_per_voxel)
-                {
-                    read_format = scm::gl::data_format::FORMAT_R_8;
-                }
-                else if(2 == num_bytes_per_voxel)
-                {
-                    read_format = scm::gl::data_format::FORMAT_R_16;
-                }
-                else if(4 == num_bytes_per_voxel)
-                {
-                    read_format = scm::gl::data_format::FORMAT_R_32F;
-                }
-            }
+        for(auto& time_step : cpu_cache_)
+        {
+            scm::math::vec3ui vol_dims;
+            scm::gl::data_format read_format;
+            get_volume_format(vol_dims, read_format);
 
             /*volume_textures_.push_back(ctx.render_device->create_texture_3d(scm::gl::texture_3d_desc(vol_dims, read_format), read_format,
-                                                                            {(void*) &per_resource_cpu_cache_[uuid_][loaded_volumes_count][0]} ) );
+                                                                            {(void*) &time_step[0]} ) );
             */
-            ctx.texture_3d_arrays[uuid()].push_back(
-                ctx.render_device->create_texture_3d(scm::gl::texture_3d_desc(vol_dims, read_format), read_format, {(void*)&per_resource_cpu_cache_[uuid_][loaded_volumes_count][0]}));
+            ctx.texture_3d_arrays[uuid()].push_back(ctx.render_device->create_texture_3d(scm::gl::texture_3d_desc(vol_dims, read_format), read_format, {(void*)&time_step[0]}));
+            uploaded_bytes += std::size_t(vol_dims[0]) * vol_dims[1] * vol_dims[2] * scm::gl::size_of_format(read_format);
             ++loaded_volumes_count;
         }
 
         num_time_steps_ = loaded_volumes_count;
+
+        if(!skip_grid_.empty())
+        {
+            auto const& grid_dimensions(brick_grid_.get_grid_dimensions());
+            scm::math::vec3ui const skip_dims(grid_dimensions[0], grid_dimensions[1], grid_dimensions[2]);
+            SkipTexture skip_texture;
+            skip_texture.texture = ctx.render_device->create_texture_3d(scm::gl::texture_3d_desc(skip_dims, scm::gl::FORMAT_R_8UI), scm::gl::FORMAT_R_8UI, {(void*)skip_grid_.data()});
+            skip_texture.sampler = ctx.render_device->create_sampler_state(scm::gl::FILTER_MIN_MAG_NEAREST, scm::gl::WRAP_CLAMP_TO_EDGE);
+            uploaded_bytes += skip_grid_.size();
+
+            std::lock_guard<std::mutex> lock(skip_textures_mutex_);
+            skip_textures_[ctx.id] = skip_texture;
+        }
+
+        memory_allocations_.track(ctx.memory, GpuMemoryRegistry::id_of(this), GpuMemoryRegistry::Category::PLUGIN, uploaded_bytes, "TV_3");
         /*
 
         std::make_shared<scm::gl::texture_3d>(
@@ -269,6 +335,83 @@ void TV_3Resource::upload_to(RenderContext const& ctx) const
     }
 }
 
+void TV_3Resource::load_brick_grid() const
+{
+    if(cpu_cache_.empty())
+    {
+        return;
+    }
+
+    VolumeBrickGrid::VoxelType type;
+    switch(volume_descriptor_tokens_["num_bytes_per_voxel"])
+    {
+    case 1:
+        type = VolumeBrickGrid::VoxelType::UINT8;
+        break;
+    case 2:
+        type = VolumeBrickGrid::VoxelType::UINT16;
+        break;
+    case 4:
+        type = VolumeBrickGrid::VoxelType::FLOAT32;
+        break;
+    default:
+        return;
+    }
+
+    // the sequence is in memory already, hashing it is cheaper than reading the files again
+    uint64_t key = VolumeBrickGrid::HASH_SEED;
+    for(auto const& time_step : cpu_cache_)
+    {
+        key = VolumeBrickGrid::hash_data(time_step.data(), time_step.size(), key);
+    }
+
+    std::string const cache_file = resource_file_name_ + ".bricks";
+    if(!brick_grid_.load(cache_file, key))
+    {
+        VolumeBrickGrid::Dimensions const dimensions = {
+            {unsigned(volume_descriptor_tokens_["w"]), unsigned(volume_descriptor_tokens_["h"]), unsigned(volume_descriptor_tokens_["d"])}};
+
+        brick_grid_.build(cpu_cache_.front().data(), dimensions, type);
+        for(std::size_t step = 1; step < cpu_cache_.size(); ++step)
+        {
+            brick_grid_.extend(cpu_cache_[step].data(), type);
+        }
+
+        if(!brick_grid_.save(cache_file, key))
+        {
+            Logger::LOG_DEBUG << "Unable to cache the brick grid of \"" << resource_file_name_ << "\"." << std::endl;
+        }
+    }
+
+    skip_grid_ = brick_grid_.compute_distances(brick_grid_.compute_occupancy(COMPOSITING_OPACITY_THRESHOLD, 1.f));
+}
+
+void TV_3Resource::upload_streamed_to(RenderContext const& ctx) const
+{
+    scm::math::vec3ui vol_dims;
+    scm::gl::data_format read_format;
+    get_volume_format(vol_dims, read_format);
+
+    int32_t const volume_id = std::max(0, int32_t(time_cursor_pos_)) % std::max(1, num_time_steps_);
+
+    // the first frame has to wait for its time step, later ones keep the last step until the next one arrived
+    streamer_->set_playback(time_cursor_pos_, 0.0f);
+    auto time_step(streamer_->get_step(volume_id));
+    if(!time_step)
+    {
+        return;
+    }
+
+    ctx.texture_3d_arrays[uuid()].push_back(ctx.render_device->create_texture_3d(scm::gl::texture_3d_desc(vol_dims, read_format), read_format, {(void*)time_step->data()}));
+
+    {
+        std::lock_guard<std::mutex> lock(streamed_time_steps_mutex_);
+        streamed_time_steps_[ctx.id] = volume_id;
+    }
+
+    memory_allocations_.track(ctx.memory, GpuMemoryRegistry::id_of(this), GpuMemoryRegistry::Category::PLUGIN, std::size_t(vol_dims[0]) * vol_dims[1] * vol_dims[2] * scm::gl::size_of_format(read_format), "TV_3");
+}
+
 void TV_3Resource::bind_volume_texture(RenderContext const& ctx, scm::gl::sampler_state_ptr const& sampler_state) const
 {
     auto iter = ctx.texture_3d_arrays.find(uuid());
@@ -304,9 +447,54 @@ void TV_3Resource::bind_volume_texture(RenderContext const& ctx, scm::gl::sample
 
     int32_t volume_id = int32_t(time_cursor_pos_) % num_time_steps_;
 
+    if(streamer_)
+    {
+        if(iter == ctx.texture_3d_arrays.end())
+        {
+            return;
+        }
+
+        streamer_->set_playback(time_cursor_pos_, PlaybackMode::NONE == playback_mode_ ? 0.0f : playback_fps_ * playback_multiplier);
+
+        bool needs_update = false;
+        {
+            std::lock_guard<std::mutex> lock(streamed_time_steps_mutex_);
+            needs_update = streamed_time_steps_[ctx.id] != volume_id;
+        }
+
+        if(needs_update)
+        {
+            // never stall the frame, the previous step stays visible until the prefetcher caught up
+            auto time_step(streamer_->try_get_step(volume_id));
+            if(time_step)
+            {
+                scm::math::vec3ui vol_dims;
+                scm::gl::data_format read_format;
+                get_volume_format(vol_dims, read_format);
+
+                ctx.render_context->update_sub_texture((iter->second)[0], scm::gl::texture_region(scm::math::vec3ui(0, 0, 0), vol_dims), 0, read_format, time_step->data());
+
+                std::lock_guard<std::mutex> lock(streamed_time_steps_mutex_);
+                streamed_time_steps_[ctx.id] = volume_id;
+            }
+        }
+
+        ctx.render_context->bind_texture((iter->second)[0], sampler_state, 0);
+        return;
+    }
+
     // ctx.render_context->bind_texture(volume_textures_[ ((frame_counter_++) / 10) % volume_textures_.size()], sampler_state, 0);
     ctx.render_context->bind_texture((iter->second)[volume_id], sampler_state, 0);
 
+    {
+        std::lock_guard<std::mutex> lock(skip_textures_mutex_);
+        auto skip_texture(skip_textures_.find(ctx.id));
+        if(skip_texture != skip_textures_.end())
+        {
+            ctx.render_context->bind_texture(skip_texture->second.texture, skip_texture->second.sampler, 4);
+        }
+    }
+
     /*
       std::cout << "In drawing branch\n";
       scm::gl::context_vertex_input_guard vig(ctx.render_context);
@@ -22,6 +22,8 @@
 // class header
 #include <gua/renderer/TV_3ResourceVQCompressed.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 /*
 #include <gua/utils/Singleton.hpp>
@@ -56,67 +58,81 @@
 */
 namespace gua
 {
-std::mutex TV_3ResourceVQCompressed::cpu_codebook_loading_mutex_;
-std::map<std::size_t, bool> TV_3ResourceVQCompressed::are_cpu_codebooks_loaded_;
-std::map<std::size_t, std::vector<std::ifstream>> TV_3ResourceVQCompressed::per_resource_codebook_file_streams_;
-std::map<std::size_t, std::vector<std::vector<uint8_t>>> TV_3ResourceVQCompressed::per_resource_codebook_cpu_cache_;
+namespace
+{
+scm::gl::data_format codebook_format(int64_t num_bytes_per_voxel)
+{
+    if(1 == num_bytes_per_voxel)
+    {
+        return scm::gl::data_format::FORMAT_R_8;
+    }
+    else if(2 == num_bytes_per_voxel)
+    {
+        return scm::gl::data_format::FORMAT_R_16;
+    }
+    else if(4 == num_bytes_per_voxel)
+    {
+        return scm::gl::data_format::FORMAT_R_32F;
+    }
+    return scm::gl::data_format::FORMAT_NULL;
+}
+} // namespace
 
 ////////////////////////////////////////////////////////////////////////////////
 
-TV_3ResourceVQCompressed::TV_3ResourceVQCompressed(std::string const& resource_file_string, bool is_pickable) : TV_3Resource(resource_file_string, is_pickable, CompressionMode::SW_VQ)
+TV_3ResourceVQCompressed::TV_3ResourceVQCompressed(std::string const& resource_file_string, bool is_pickable, bool stream_time_steps, std::size_t cpu_budget_in_bytes)
+    : TV_3Resource(resource_file_string, is_pickable, CompressionMode::SW_VQ, stream_time_steps, cpu_budget_in_bytes / 2)
 {
     std::cout << "Created Compressed Volume Resource\n";
 
-    bool is_multi_codebook_mode = false;
-
-    cpu_codebook_loading_mutex_.lock();
-
-    if(!are_cpu_codebooks_loaded_[uuid_])
+    std::vector<std::string> codebooks_to_load;
+    if(resource_file_name_.find(".v_rsc") != std::string::npos)
     {
-        std::vector<std::string> volumes_to_load;
-        if(resource_file_name_.find(".v_rsc") != std::string::npos)
+        bool const is_multi_codebook_mode = resource_file_name_.find("MCM") != std::string::npos;
+
+        for(auto const& time_step_file : time_step_files_)
         {
-            if(resource_file_name_.find("MCM") != std::string::npos)
-            {
-                is_multi_codebook_mode = true;
-            }
+            codebooks_to_load.push_back(time_step_file + ".cb");
 
-            std::string line_buffer;
-            std::ifstream volume_resource_file(resource_file_name_, std::ios::in);
-            while(std::getline(volume_resource_file, line_buffer))
+            if(!is_multi_codebook_mode)
             {
-                if(line_buffer.find(".raw") != std::string::npos)
-                {
-                    volumes_to_load.push_back(line_buffer + ".cb");
-                    std::cout << "Pushing back: " + line_buffer + ".cb\n\n";
-
-                    if(!is_multi_codebook_mode)
-                    {
-                        break;
-                    }
-                }
+                break;
             }
         }
-        else
-        {
-            volumes_to_load.push_back(resource_file_name_);
-        }
+    }
+    else
+    {
+        codebooks_to_load.push_back(resource_file_name_ + ".cb");
+    }
 
-        uint8_t num_parsed_volumes = 0;
-        for(auto const& vol_path : volumes_to_load)
-        {
-            if(0 == num_parsed_volumes++)
-            {
-                tokenize_volume_name(vol_path, volume_descriptor_tokens_[uuid_]);
-            }
+    auto& current_tokens = volume_descriptor_tokens_;
+    int64_t num_bytes_per_voxel = current_tokens["num_bytes_per_voxel"];
 
-            per_resource_codebook_file_streams_[uuid_].push_back(std::ifstream(vol_path.c_str(), std::ios::in | std::ios::binary | std::ios::ate));
-        }
+    int64_t total_block_size = std::pow(current_tokens["bs"], 3);
 
-        are_cpu_codebooks_loaded_[uuid_] = true;
-    }
+    int64_t const MAX_CODEBOOK_WIDTH = 16384;
+
+    current_tokens["num_codewords_per_row"] = std::floor(MAX_CODEBOOK_WIDTH / std::max(int64_t(1), total_block_size));
+    int64_t codebook_width = current_tokens["num_codewords_per_row"] * total_block_size;
+
+    int64_t actual_num_index_bit_power = current_tokens["a"];
+    int64_t num_codewords = std::pow(2, actual_num_index_bit_power);
+    int64_t codebook_height = int64_t(std::ceil(num_codewords / std::max(1.0f, (float)current_tokens["num_codewords_per_row"])));
+
+    current_tokens["codebook_width"] = codebook_width;
+    current_tokens["codebook_height"] = codebook_height;
+    codebook_dimensions_ = scm::math::vec2ui(codebook_width, codebook_height);
 
-    cpu_codebook_loading_mutex_.unlock();
+    // the index volumes got half of the budget, held in full if they fit
+    std::size_t const index_num_bytes = streamer_ ? cpu_budget_in_bytes / 2 : time_step_files_.size() * std::size_t(current_tokens["total_num_bytes"]);
+
+    // codebooks are decoded lazily around the time cursor by the loaders shared with other resources;
+    // the files hold the codewords only, the last texture row is padded
+    std::size_t const codebook_texture_num_bytes = std::size_t(codebook_height * codebook_width * num_bytes_per_voxel);
+    std::size_t const codebook_file_num_bytes = std::size_t(num_codewords * total_block_size * num_bytes_per_voxel);
+    codebook_streamer_ = std::make_shared<TimeStepStreamer>(
+        codebooks_to_load, codebook_texture_num_bytes, cpu_budget_in_bytes - std::min(cpu_budget_in_bytes, index_num_bytes), shared_loaders(), codebook_file_num_bytes);
+    num_codebooks_ = int32_t(codebooks_to_load.size());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -127,71 +143,24 @@ void TV_3ResourceVQCompressed::upload_to(RenderContext const& ctx) const
 {
     TV_3Resource::upload_to(ctx);
 
-    if(are_cpu_codebooks_loaded_[uuid_])
+    if(num_codebooks_ > 0)
     {
-        int64_t loaded_volumes_count = 0;
-
-        auto& current_tokens = volume_descriptor_tokens_[uuid_];
-        int64_t num_bytes_per_voxel = current_tokens["num_bytes_per_voxel"];
-
-        int64_t total_block_size = std::pow(current_tokens["bs"], 3);
-        int64_t size_per_codeword = (num_bytes_per_voxel)*total_block_size;
+        scm::gl::data_format read_format = codebook_format(volume_descriptor_tokens_["num_bytes_per_voxel"]);
 
-        int64_t const MAX_CODEBOOK_WIDTH = 16384;
+        int32_t const codebook_id = std::max(0, int32_t(time_cursor_pos_)) % num_codebooks_;
 
-        current_tokens["num_codewords_per_row"] = std::floor(MAX_CODEBOOK_WIDTH / total_block_size);
-        int64_t codebook_width = current_tokens["num_codewords_per_row"] * total_block_size;
-
-        size_t size_of_data_type = current_tokens["b"];
-
-        for(auto& codebook_stream : per_resource_codebook_file_streams_[uuid_])
+        // the first frame waits for its codebook, later ones are updated once the next one is decoded
+        codebook_streamer_->set_playback(time_cursor_pos_, 0.0f);
+        auto codebook(codebook_streamer_->get_step(codebook_id));
+        if(!codebook)
         {
-            int64_t actual_num_index_bit_power = current_tokens["a"];
-            int64_t num_codewords = std::pow(2, actual_num_index_bit_power);
-            int64_t codebook_height = int64_t(std::ceil(num_codewords / (float)current_tokens["num_codewords_per_row"]));
-
-            int64_t codebook_texture_num_bytes = codebook_height * codebook_width * num_bytes_per_voxel;
-            int64_t num_bytes_in_codebook_file = codebook_stream.tellg();
-            codebook_stream.seekg(0);
-            std::cout << "Reading num bytes: " << num_bytes_in_codebook_file << "\n";
-
-            per_resource_codebook_cpu_cache_[uuid_].push_back(std::vector<uint8_t>(codebook_texture_num_bytes, 0));
-            codebook_stream.read((char*)&(per_resource_codebook_cpu_cache_[uuid_][loaded_volumes_count][0]), num_bytes_in_codebook_file);
-
-            current_tokens["codebook_width"] = codebook_width;
-            current_tokens["codebook_height"] = codebook_height;
-
-            scm::math::vec2ui codebook_dims = scm::math::vec2ui(current_tokens["codebook_width"], current_tokens["codebook_height"]);
-
-            scm::gl::data_format read_format = scm::gl::data_format::FORMAT_NULL;
-
-            if(1 == num_bytes_per_voxel)
-            {
-                read_format = scm::gl::data_format::FORMAT_R_8;
-            }
-            else if(2 == num_bytes_per_voxel)
-            {
-                read_format = scm::gl::data_format::FORMAT_R_16;
-            }
-            else if(4 == num_bytes_per_voxel)
-            {
-                read_format = scm::gl::data_format::FORMAT_R_32F;
-                std::cout << "Reading 32 bit codewords\n";
-            }
-
-            std::cout << "CONTENT: \n";
-            /*
-                for( auto& element : per_resource_codebook_cpu_cache_[uuid_][loaded_volumes_count] ) {
-                  std::cout << element << "\n";
-                }*/
-
-            ctx.texture_2d_arrays[uuid()].push_back(
-                ctx.render_device->create_texture_2d(scm::gl::texture_2d_desc(codebook_dims, read_format), read_format, {(void*)&(per_resource_codebook_cpu_cache_[uuid_][loaded_volumes_count][0])}));
-
-            ++loaded_volumes_count;
+            return;
         }
 
-        num_codebooks_ = loaded_volumes_count;
+        ctx.texture_2d_arrays[uuid()].push_back(ctx.render_device->create_texture_2d(scm::gl::texture_2d_desc(codebook_dimensions_, read_format), read_format, {(void*)codebook->data()}));
+
+        std::lock_guard<std::mutex> lock(streamed_codebooks_mutex_);
+        streamed_codebooks_[ctx.id] = codebook_id;
     }
 }
 
@@ -199,7 +168,7 @@ void TV_3ResourceVQCompressed::apply_resource_dependent_uniforms(RenderContext c
 {
     TV_3Resource::apply_resource_dependent_uniforms(ctx, current_program);
 
-    auto& current_tokens = volume_descriptor_tokens_[uuid_];
+    auto& current_tokens = volume_descriptor_tokens_;
     current_program->apply_uniform(ctx, "num_codewords_per_row", int32_t(current_tokens["num_codewords_per_row"]));
     current_program->apply_uniform(ctx, "block_offset_vector", math::vec3i(1, current_tokens["bs"], current_tokens["bs"] * current_tokens["bs"]));
     current_program->apply_uniform(ctx, "total_block_size", int32_t(current_tokens["bs"] * current_tokens["bs"] * current_tokens["bs"]));
@@ -220,11 +189,41 @@ void TV_3ResourceVQCompressed::bind_volume_texture(RenderContext const& ctx, scm
         upload_to(ctx);
       }
     */
+    auto iter = ctx.texture_2d_arrays.find(uuid());
+    if(iter == ctx.texture_2d_arrays.end() || iter->second.empty())
+    {
+        return;
+    }
+
     auto nearest_sampler_state_ = ctx.render_device->create_sampler_state(scm::gl::FILTER_MIN_MAG_NEAREST, scm::gl::WRAP_CLAMP_TO_EDGE);
 
     int32_t codebook_id = int32_t(time_cursor_pos_) % num_codebooks_;
 
-    ctx.render_context->bind_texture(ctx.texture_2d_arrays[uuid()][codebook_id], nearest_sampler_state_, 1);
+    float const playback_speed = PlaybackMode::NONE == playback_mode_ ? 0.0f : (PlaybackMode::BACKWARD == playback_mode_ ? -playback_fps_ : playback_fps_);
+    codebook_streamer_->set_playback(time_cursor_pos_, playback_speed);
+
+    bool needs_update = false;
+    {
+        std::lock_guard<std::mutex> lock(streamed_codebooks_mutex_);
+        needs_update = streamed_codebooks_[ctx.id] != codebook_id;
+    }
+
+    if(needs_update)
+    {
+        // keep the previous codebook rather than stalling the frame
+        auto codebook(codebook_streamer_->try_get_step(codebook_id));
+        if(codebook)
+        {
+            scm::gl::data_format read_format = codebook_format(volume_descriptor_tokens_["num_bytes_per_voxel"]);
+            ctx.render_context->update_sub_texture(iter->second[0], scm::gl::texture_region(scm::math::vec3ui(0, 0, 0), scm::math::vec3ui(codebook_dimensions_.x, codebook_dimensions_.y, 1)),
+                                                   0, read_format, codebook->data());
+
+            std::lock_guard<std::mutex> lock(streamed_codebooks_mutex_);
+            streamed_codebooks_[ctx.id] = codebook_id;
+        }
+    }
+
+    ctx.render_context->bind_texture(iter->second[0], nearest_sampler_state_, 1);
 
     ctx.render_context->apply_texture_units();
     // the minus 1 hack currently only applies because the base class increments the counter. The hack is removed during on of the next iterations
@@ -54,6 +54,8 @@ class GUA_VIDEO3D_DLL Video3DNode : public GeometryNode
 
     void update_cache() override;
 
+    std::size_t get_geometry_revision() const override;
+
     /**
      * Accepts a visitor and calls concrete visit method.
      *
@@ -2,48 +2,86 @@
 #define MVT_DXTCOMPRESSOR_H
 
 
-#include <ctime>
 #include <gua/video3d/video3d_geometry/fastdxt/libdxt.h>
 
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 
-//#ifndef DXTCOMPRESSOR_NUMTHREADS
-//#define DXTCOMPRESSOR_NUMTHREADS 2
-//#endif
-
 class BackgroundDetector;
 
 namespace mvt{
 
+  /*
+   * Compresses RGB frames of a fixed size to DXT. Each frame is split into
+   * stripes of 4-pixel block rows which are expanded to RGBA and compressed
+   * by a persistent pool of worker threads (the calling thread takes the
+   * first stripe). Width and height have to be multiples of 4.
+   *
+   * With background masking enabled, every stripe keeps a BackgroundDetector
+   * which is reset from the frame passed with resetbg = true. Background
+   * pixels are written black and blocks consisting of background only are
+   * emitted without searching for endpoints (DXT1 only).
+   */
   class DXTCompressor{
 
   public:
     DXTCompressor();
     ~DXTCompressor();
 
-    unsigned init(unsigned width, unsigned height, unsigned type = FORMAT_DXT1);
+    // num_threads = 0 uses one thread per hardware core, at most one per block row
+    unsigned init(unsigned width, unsigned height, unsigned type = FORMAT_DXT1, unsigned num_threads = 0);
     unsigned getStorageSize();
     unsigned char* compress(unsigned char* buff, bool resetbg = false);
     unsigned getType();
+
+    void setBackgroundMasking(bool enable);
+    bool getBackgroundMasking() const;
+
+    // blocks skipped as background during the last call to compress
+    unsigned getNumSkippedBlocks() const;
+
+    unsigned getNumThreads() const;
+
   private:
 
-    void docompress(unsigned tid, unsigned char* buff, bool resetbg = false);
+    struct Stripe{
+      unsigned first_block_row;
+      unsigned num_block_rows;
+      std::unique_ptr<BackgroundDetector> bgd;
+      std::vector<unsigned char> background_blocks;
+      unsigned skipped_blocks;
+    };
 
+    void startWorkers();
+    void stopWorkers();
+    void workerLoop(unsigned tid, unsigned long generation);
+    void docompress(unsigned tid, unsigned char const* buff, bool resetbg);
 
-    unsigned _fc;
-    //sensor::Timer _timer;
     unsigned _width;
     unsigned _height;
-    unsigned _height_sub;
     unsigned _type;
     unsigned _storage;
-    unsigned _compressed_buff_sub_size;
-    byte* _rgba_buff;
-//    byte* _rgba_buff_sub[DXTCOMPRESSOR_NUMTHREADS];
-    byte* _compressed_buff;
-//    byte* _compressed_buff_sub[DXTCOMPRESSOR_NUMTHREADS];
-
-//    BackgroundDetector* _bgd[DXTCOMPRESSOR_NUMTHREADS];
+    unsigned _num_threads;
+    bool _masking;
+    bool _has_background;
+
+    std::vector<byte> _rgba_buff;
+    std::vector<byte> _compressed_buff;
+    std::vector<Stripe> _stripes;
+
+    std::vector<std::thread> _workers;
+    std::mutex _mutex;
+    std::condition_variable _work_available;
+    std::condition_variable _work_done;
+    unsigned long _generation;
+    unsigned _pending;
+    bool _shutdown;
+    unsigned char const* _input;
+    bool _resetbg;
 
   };
 
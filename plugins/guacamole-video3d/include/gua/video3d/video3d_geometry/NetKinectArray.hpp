@@ -2,13 +2,26 @@
 #define VIDEO3D_NETKINECTARRAY_HPP
 
 #include <gua/video3d/video3d_geometry/KinectCalibrationFile.hpp>
+#include <gua/utils/MessagePlayer.hpp>
+#include <gua/utils/MessageRecorder.hpp>
 
 #include <atomic>
+#include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <thread>
 
 namespace video3d
 {
+/**
+ * Receives the color and depth images of all sensors of a capture server.
+ *
+ * Frames are triple buffered: the receive thread writes into a back buffer,
+ * publishes it by swapping with the ready buffer and immediately continues
+ * with the buffer it got in return. update() swaps the ready buffer to the
+ * front. Neither side ever waits for the other; a ready frame which is
+ * replaced before update() picked it up is counted as dropped.
+ */
 class NetKinectArray
 {
   public:
@@ -18,18 +31,39 @@ class NetKinectArray
     bool update();
     inline unsigned char* getBuffer() { return m_buffer.data(); }
 
+    // see spoints::NetKinectArray, recordings are replayed with "file://<filename>[?speed=<factor>]"
+    bool start_recording(std::string const& filename);
+    void stop_recording();
+
+    // complete frames received from the server or the recording
+    std::size_t get_num_received_frames() const { return m_num_received.load(); }
+    // received frames which were replaced by newer ones before update() picked them up
+    std::size_t get_num_dropped_frames() const { return m_num_dropped.load(); }
+    // messages which did not match the size given by the calibration
+    std::size_t get_num_rejected_messages() const { return m_num_rejected.load(); }
+
   private:
     void readloop();
+    void replayloop();
+    // swaps the back buffer with the ready buffer
+    void publish();
 
     std::mutex m_mutex;
+    std::condition_variable m_frame_consumed;
     std::atomic<bool> m_running;
     const std::string m_server_endpoint;
     std::vector<std::shared_ptr<KinectCalibrationFile>> m_calib_files;
     unsigned m_colorsize_byte;
     unsigned m_depthsize_byte;
     std::vector<uint8_t> m_buffer;
+    std::vector<uint8_t> m_buffer_ready;
     std::vector<uint8_t> m_buffer_back;
-    std::atomic<bool> m_need_swap;
+    bool m_ready_is_new;
+    std::atomic<std::size_t> m_num_received;
+    std::atomic<std::size_t> m_num_dropped;
+    std::atomic<std::size_t> m_num_rejected;
+    std::shared_ptr<gua::MessagePlayer> m_player;
+    std::shared_ptr<gua::MessageRecorder> m_recorder;
     std::thread m_recv;
 };
 
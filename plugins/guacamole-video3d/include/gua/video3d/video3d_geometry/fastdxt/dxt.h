@@ -58,6 +58,9 @@ typedef unsigned int dword;
 // Compress to DXT1 format
 void CompressImageDXT1( const byte *inBuf, byte *outBuf, int width, int height, int &outputBytes );
 
+// Compress a single 4x4 block of an RGBA image with the given row width to DXT1
+void CompressBlockDXT1( const byte *inPtr, int width, byte *&outData );
+
 // Compress to DXT5 format
 void CompressImageDXT5( const byte *inBuf, byte *outBuf, int width, int height, int &outputBytes );
 
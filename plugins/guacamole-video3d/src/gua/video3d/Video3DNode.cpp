@@ -103,6 +103,10 @@ std::shared_ptr<Node> Video3DNode::copy() const { return std::make_shared<Video3
 
 /////////////////////////////////////////////////////////////////////////////
 
+std::size_t Video3DNode::get_geometry_revision() const { return video_ ? video_->get_revision() : 0; }
+
+/////////////////////////////////////////////////////////////////////////////
+
 /* virtual */ void Video3DNode::update_cache()
 {
     if(video_changed_)
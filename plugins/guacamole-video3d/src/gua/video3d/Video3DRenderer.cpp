@@ -230,6 +230,8 @@ void Video3DRenderer::update_buffers(RenderContext const& ctx, Video3DResource c
 
     if(video3d_data.nka_->update())
     {
+        video3d_ressource.increment_revision();
+
         unsigned char* buff = video3d_data.nka_->getBuffer();
         for(unsigned i = 0; i < video3d_ressource.number_of_cameras(); ++i)
         {
@@ -2,69 +2,118 @@
 
 #include <gua/video3d/video3d_geometry/BackgroundDetector.h>
 
-#include <boost/thread/thread.hpp>
-#include <boost/bind.hpp>
+#include <algorithm>
+#include <cstring>
 
-#include <iostream>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <tmmintrin.h>
+#define DXTCOMPRESSOR_SSSE3 1
+#endif
 
 namespace mvt
 {
-DXTCompressor::DXTCompressor()
-    : _fc(0),
-      //_timer(),
-      _width(0), _height(0), _type(0), _storage(0), _compressed_buff_sub_size(0), _rgba_buff(0),
-      //_rgba_buff_sub(),
-      _compressed_buff(0)
-//_compressed_buff_sub(),
-//_bgd()
+namespace
 {
+void expand_rgb_to_rgba_scalar(unsigned char const* rgb, byte* rgba, unsigned num_pixels)
+{
+    for(unsigned p = 0; p < num_pixels; ++p, rgb += 3, rgba += 4)
+    {
+        rgba[0] = rgb[0];
+        rgba[1] = rgb[1];
+        rgba[2] = rgb[2];
+        rgba[3] = 255;
+    }
 }
 
-DXTCompressor::~DXTCompressor()
+#if defined(DXTCOMPRESSOR_SSSE3)
+// 16 pixels per iteration: three 16 byte loads are shuffled into four RGBA vectors
+__attribute__((target("ssse3"))) void expand_rgb_to_rgba_ssse3(unsigned char const* rgb, byte* rgba, unsigned num_pixels)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32(int(0xff000000));
+
+    unsigned p = 0;
+    for(; p + 16 <= num_pixels; p += 16, rgb += 48, rgba += 64)
+    {
+        const __m128i a = _mm_loadu_si128((__m128i const*)(rgb));
+        const __m128i b = _mm_loadu_si128((__m128i const*)(rgb + 16));
+        const __m128i c = _mm_loadu_si128((__m128i const*)(rgb + 32));
+
+        _mm_storeu_si128((__m128i*)(rgba), _mm_or_si128(_mm_shuffle_epi8(a, shuffle), alpha));
+        _mm_storeu_si128((__m128i*)(rgba + 16), _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), shuffle), alpha));
+        _mm_storeu_si128((__m128i*)(rgba + 32), _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), shuffle), alpha));
+        _mm_storeu_si128((__m128i*)(rgba + 48), _mm_or_si128(_mm_shuffle_epi8(_mm_srli_si128(c, 4), shuffle), alpha));
+    }
+
+    expand_rgb_to_rgba_scalar(rgb, rgba, num_pixels - p);
+}
+#endif
+
+typedef void (*ExpandFunction)(unsigned char const*, byte*, unsigned);
+
+ExpandFunction select_expand_function()
 {
-    // free(_rgba_buff);
-    // free(_compressed_buff);
+#if defined(DXTCOMPRESSOR_SSSE3)
+    if(__builtin_cpu_supports("ssse3"))
+    {
+        return &expand_rgb_to_rgba_ssse3;
+    }
+#endif
+    return &expand_rgb_to_rgba_scalar;
+}
 
-    /*for(unsigned tid = 0; tid != DXTCOMPRESSOR_NUMTHREADS; ++tid){
-      free(_rgba_buff_sub[tid]);
-      free(_compressed_buff_sub[tid]);
+void expand_rgb_to_rgba(unsigned char const* rgb, byte* rgba, unsigned num_pixels)
+{
+    static const ExpandFunction expand = select_expand_function();
+    expand(rgb, rgba, num_pixels);
+}
 
-      delete _bgd[tid];
+unsigned block_bytes(unsigned type) { return type == FORMAT_DXT1 ? 8 : 16; }
+} // namespace
 
-    }*/
+DXTCompressor::DXTCompressor()
+    : _width(0), _height(0), _type(0), _storage(0), _num_threads(1), _masking(false), _has_background(false), _rgba_buff(), _compressed_buff(), _stripes(), _workers(), _mutex(),
+      _work_available(), _work_done(), _generation(0), _pending(0), _shutdown(false), _input(0), _resetbg(false)
+{
 }
 
-unsigned DXTCompressor::init(unsigned width, unsigned height, unsigned type)
+DXTCompressor::~DXTCompressor() { stopWorkers(); }
+
+unsigned DXTCompressor::init(unsigned width, unsigned height, unsigned type, unsigned num_threads)
 {
-    // type is not used until now
+    stopWorkers();
+
     _width = width;
     _height = height;
     _type = type;
+    _has_background = false;
 
-    const unsigned rgba_size = _width * _height * 4;
-    const unsigned compressed_size = _width * _height * 4 / 8;
-    _rgba_buff = (byte*)memalign(16, rgba_size);
-    _compressed_buff = (byte*)memalign(16, compressed_size);
-    _storage = CompressDXT(_rgba_buff, _compressed_buff, _width, _height, _type, /*numthreads*/ 1);
-#if 0
-    std::cerr << "DXTCompressor::init _storage size: "  <<  _storage << std::endl;
-#endif
+    const unsigned blocks_x = _width / 4;
+    const unsigned blocks_y = _height / 4;
+    _storage = blocks_x * blocks_y * block_bytes(_type);
 
-    //
-    //    _height_sub = _height / DXTCOMPRESSOR_NUMTHREADS;
-    //    _compressed_buff_sub_size = _width*_height_sub*4/8;
-    //    for(unsigned tid = 0; tid != DXTCOMPRESSOR_NUMTHREADS; ++tid){
-    //      _rgba_buff_sub[tid]       = (byte*) memalign(16, _width*_height_sub*4);
-    //      _compressed_buff_sub[tid] = (byte*) memalign(16, _width*_height_sub*4/8);
-    //
-    //      std::cerr << "DXTCompressor::init _rgba_buff_sub[tid]: " << _rgba_buff_sub[tid] << " : " << _width*_height_sub*4 << std::endl;
-    //      std::cerr << "DXTCompressor::init _compressed_buff_sub[tid]: " << _compressed_buff_sub[tid] << " : " << 1.0 * _width*_height_sub*4/8 << std::endl;
-    //      std::cerr << "DXTCompressor::init testsize: " << CompressDXT(_rgba_buff_sub[tid], _compressed_buff_sub[tid], _width, _height_sub, _type, /*numthreads*/1) << std::endl;
-    //
-    //
-    //      _bgd[tid] = new BackgroundDetector(_width , _height_sub);
-
-    //    }
+    _rgba_buff.resize(std::size_t(_width) * _height * 4);
+    _compressed_buff.resize(_storage);
+
+    if(num_threads == 0)
+    {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    _num_threads = std::max(1u, std::min(num_threads, blocks_y));
+
+    // distribute block rows evenly, the first stripes take the remainder
+    _stripes.clear();
+    _stripes.resize(_num_threads);
+    unsigned block_row = 0;
+    for(unsigned tid = 0; tid != _num_threads; ++tid)
+    {
+        Stripe& stripe = _stripes[tid];
+        stripe.first_block_row = block_row;
+        stripe.num_block_rows = blocks_y / _num_threads + (tid < blocks_y % _num_threads ? 1 : 0);
+        stripe.background_blocks.resize(blocks_x);
+        stripe.skipped_blocks = 0;
+        block_row += stripe.num_block_rows;
+    }
 
     return _storage;
 }
@@ -73,143 +122,225 @@ unsigned DXTCompressor::getStorageSize() { return _storage; }
 
 unsigned char* DXTCompressor::compress(unsigned char* buff, bool resetbg)
 {
-#if 0
-//    _timer.start();
-#endif
-
-#if 1
-    //    boost::thread_group threadGroup;
-    //    for (unsigned tid = 0; tid != DXTCOMPRESSOR_NUMTHREADS; ++tid){
-    //
-    //      unsigned char* buff_tmp = &buff[(tid * (_width*_height*3/DXTCOMPRESSOR_NUMTHREADS))];
-    //      threadGroup.create_thread(boost::bind(&DXTCompressor::docompress,this,tid, buff_tmp, resetbg));
-    //    }
-    //    threadGroup.join_all();
-
-#else
+    if(_stripes.empty())
+    {
+        return _compressed_buff.data();
+    }
 
-    unsigned i = 0;
-    unsigned o = 0;
-    for(unsigned y = 0; y < _height; ++y)
+    if(_masking)
     {
-        for(unsigned x = 0; x < _width; ++x)
+        for(auto& stripe : _stripes)
         {
-            _rgba_buff[o] = buff[i];
-            ++o;
-            ++i;
-            _rgba_buff[o] = buff[i];
-            ++o;
-            ++i;
-            _rgba_buff[o] = buff[i];
-            ++o;
-            ++i;
-            _rgba_buff[o] = 255;
-            ++o;
+            if(!stripe.bgd)
+            {
+                stripe.bgd.reset(new BackgroundDetector(_width, stripe.num_block_rows * 4));
+            }
         }
     }
-    _storage = CompressDXT(_rgba_buff, _compressed_buff, _width, _height, _type, /*numthreads*/ 4);
-#endif
 
-#if 0
-//    _timer.stop();
+    // workers are started lazily, instances which only query the storage size don't need them
+    if(_workers.empty() && _num_threads > 1)
+    {
+        startWorkers();
+    }
 
-//    if(_fc++ % 100 == 0)
-//    std::cerr << "compression took " << _timer.get().msec() << " msec" << " compressed " << _width * _height * 3 << " bytes to " << (100.0 * _storage) / (_width * _height * 3) << "%" << std::endl;
-#endif
+    if(!_workers.empty())
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _input = buff;
+        _resetbg = resetbg;
+        _pending = unsigned(_workers.size());
+        ++_generation;
+        _work_available.notify_all();
+    }
+
+    docompress(0, buff, resetbg);
+
+    if(!_workers.empty())
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _work_done.wait(lock, [this] { return _pending == 0; });
+    }
+
+    if(_masking && resetbg)
+    {
+        _has_background = true;
+    }
 
-    return _compressed_buff;
+    return _compressed_buff.data();
 }
 
 unsigned DXTCompressor::getType() { return _type; }
 
-void DXTCompressor::docompress(unsigned tid, unsigned char* buff, bool resetbg)
+void DXTCompressor::setBackgroundMasking(bool enable)
 {
-#if 0
-/*
-    if(resetbg){
-
-      std::cerr << this << " DXTCompressor::docompress resetting background from thread " << (unsigned) tid << std::endl;
-
-      unsigned i = 0;
-      unsigned o = 0;
-      for(unsigned y = 0; y < _height_sub; ++y){
-	for(unsigned x = 0; x < _width; ++x){
-
-	  unsigned char r = buff[i];++i;
-	  unsigned char g = buff[i];++i;
-	  unsigned char b = buff[i];++i;
-	  const unsigned index = y * _width + x;
-	  _bgd[tid]->setBackground(index, r, g, b);
-
-	  _rgba_buff_sub[tid][o] = r; ++o;
-	  _rgba_buff_sub[tid][o] = g; ++o;
-	  _rgba_buff_sub[tid][o] = b; ++o;
-	  _rgba_buff_sub[tid][o] = 255; ++o;
-
-	}
-      }
-    }
-    else{
-      unsigned i = 0;
-      unsigned o = 0;
-      for(unsigned y = 0; y < _height_sub; ++y){
-	for(unsigned x = 0; x < _width; ++x){
-
-	  unsigned char r = buff[i];
-	  ++i;
-	  unsigned char g = buff[i];
-	  ++i;
-	  unsigned char b = buff[i];
-	  ++i;
-	  const unsigned index = y * _width + x;
-	  const bool bg = _bgd[tid]->detectBackground(index, r, g, b);
-	  if(bg){
-	    _rgba_buff_sub[tid][o] = 0;
-	    ++o;
-	    _rgba_buff_sub[tid][o] = 0;
-	    ++o;
-	    _rgba_buff_sub[tid][o] = 0;
-	    ++o;
-	    _rgba_buff_sub[tid][o] = 255;
-	    ++o;
-	  }
-	  else{
-	    _rgba_buff_sub[tid][o] = r;
-	    ++o;
-	    _rgba_buff_sub[tid][o] = g;
-	    ++o;
-	    _rgba_buff_sub[tid][o] = b;
-	    ++o;
-	    _rgba_buff_sub[tid][o] = 255;
-	    ++o;
-	  }
-
-	}
-      }
-    }
-*/
-#else
-    // original
-    /*
-    unsigned i = 0;
-    unsigned o = 0;
-    for(unsigned y = 0; y < _height_sub; ++y){
-      for(unsigned x = 0; x < _width; ++x){
-        _rgba_buff_sub[tid][o] = buff[i];
-        ++o;++i;
-        _rgba_buff_sub[tid][o] = buff[i];
-        ++o;++i;
-        _rgba_buff_sub[tid][o] = buff[i];
-        ++o;++i;
-        _rgba_buff_sub[tid][o] = 255;
-        ++o;
-      }
-    }
-    */
-#endif
+    _masking = enable;
+    _has_background = false;
+}
 
-    // unsigned s = CompressDXT(_rgba_buff_sub[tid], _compressed_buff_sub[tid], _width, _height_sub, _type, /*numthreads*/1);
+bool DXTCompressor::getBackgroundMasking() const { return _masking; }
 
-    // memcpy( (_compressed_buff + (tid * _compressed_buff_sub_size)), _compressed_buff_sub[tid], s/*_compressed_buff_sub_size*/);
+unsigned DXTCompressor::getNumSkippedBlocks() const
+{
+    unsigned skipped = 0;
+    for(auto const& stripe : _stripes)
+    {
+        skipped += stripe.skipped_blocks;
+    }
+    return skipped;
+}
+
+unsigned DXTCompressor::getNumThreads() const { return _num_threads; }
+
+void DXTCompressor::startWorkers()
+{
+    _shutdown = false;
+    for(unsigned tid = 1; tid < _num_threads; ++tid)
+    {
+        _workers.emplace_back(&DXTCompressor::workerLoop, this, tid, _generation);
+    }
+}
+
+void DXTCompressor::stopWorkers()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _shutdown = true;
+        _work_available.notify_all();
+    }
+
+    for(auto& worker : _workers)
+    {
+        worker.join();
+    }
+    _workers.clear();
+}
+
+void DXTCompressor::workerLoop(unsigned tid, unsigned long generation)
+{
+    while(true)
+    {
+        unsigned char const* input = 0;
+        bool resetbg = false;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _work_available.wait(lock, [&] { return _shutdown || _generation != generation; });
+            if(_shutdown)
+            {
+                return;
+            }
+            generation = _generation;
+            input = _input;
+            resetbg = _resetbg;
+        }
+
+        docompress(tid, input, resetbg);
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        if(--_pending == 0)
+        {
+            _work_done.notify_one();
+        }
+    }
+}
+
+void DXTCompressor::docompress(unsigned tid, unsigned char const* buff, bool resetbg)
+{
+    Stripe& stripe = _stripes[tid];
+    stripe.skipped_blocks = 0;
+
+    const unsigned blocks_x = _width / 4;
+    const unsigned first_row = stripe.first_block_row * 4;
+    const bool set_background = _masking && resetbg;
+    const bool detect_background = _masking && !resetbg && _has_background;
+
+    unsigned char const* rgb = buff + std::size_t(first_row) * _width * 3;
+    byte* rgba = _rgba_buff.data() + std::size_t(first_row) * _width * 4;
+    byte* out = _compressed_buff.data() + std::size_t(stripe.first_block_row) * blocks_x * block_bytes(_type);
+
+    for(unsigned block_row = 0; block_row != stripe.num_block_rows; ++block_row)
+    {
+        const unsigned row_pixels = 4 * _width;
+        unsigned char const* rgb_row = rgb + std::size_t(block_row) * row_pixels * 3;
+        byte* rgba_row = rgba + std::size_t(block_row) * row_pixels * 4;
+
+        if(set_background || detect_background)
+        {
+            std::fill(stripe.background_blocks.begin(), stripe.background_blocks.end(), 1);
+
+            unsigned i = 0;
+            unsigned o = 0;
+            for(unsigned y = 0; y != 4; ++y)
+            {
+                for(unsigned x = 0; x != _width; ++x, i += 3, o += 4)
+                {
+                    const unsigned index = (block_row * 4 + y) * _width + x;
+                    bool bg = false;
+                    if(set_background)
+                    {
+                        stripe.bgd->setBackground(index, rgb_row[i], rgb_row[i + 1], rgb_row[i + 2]);
+                    }
+                    else
+                    {
+                        bg = stripe.bgd->detectBackground(index, rgb_row[i], rgb_row[i + 1], rgb_row[i + 2]);
+                    }
+
+                    if(bg)
+                    {
+                        rgba_row[o] = rgba_row[o + 1] = rgba_row[o + 2] = 0;
+                    }
+                    else
+                    {
+                        rgba_row[o] = rgb_row[i];
+                        rgba_row[o + 1] = rgb_row[i + 1];
+                        rgba_row[o + 2] = rgb_row[i + 2];
+                        stripe.background_blocks[x / 4] = 0;
+                    }
+                    rgba_row[o + 3] = 255;
+                }
+            }
+
+            if(set_background)
+            {
+                std::fill(stripe.background_blocks.begin(), stripe.background_blocks.end(), 0);
+            }
+        }
+        else
+        {
+            expand_rgb_to_rgba(rgb_row, rgba_row, row_pixels);
+            std::fill(stripe.background_blocks.begin(), stripe.background_blocks.end(), 0);
+        }
+
+        if(_type == FORMAT_DXT1)
+        {
+            for(unsigned bx = 0; bx != blocks_x; ++bx)
+            {
+                if(stripe.background_blocks[bx])
+                {
+                    // black endpoints and zero indices, what the endpoint search yields for a black block
+                    std::memset(out, 0, 8);
+                    out += 8;
+                    ++stripe.skipped_blocks;
+                }
+                else
+                {
+                    CompressBlockDXT1(rgba_row + bx * 16, int(_width), out);
+                }
+            }
+        }
+    }
+
+    if(_type != FORMAT_DXT1)
+    {
+        int bytes = 0;
+        if(_type == FORMAT_DXT5YCOCG)
+        {
+            CompressImageDXT5YCoCg(rgba, out, int(_width), int(stripe.num_block_rows * 4), bytes);
+        }
+        else
+        {
+            CompressImageDXT5(rgba, out, int(_width), int(stripe.num_block_rows * 4), bytes);
+        }
+    }
 }
 } // namespace mvt
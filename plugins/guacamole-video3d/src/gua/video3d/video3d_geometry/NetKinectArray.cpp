@@ -1,39 +1,87 @@
 #include <gua/video3d/video3d_geometry/NetKinectArray.hpp>
 
+#include <gua/utils/Logger.hpp>
+
 #include <zmq.hpp>
 
+#include <cstring>
 #include <iostream>
 #include <mutex>
 
 namespace video3d
 {
 NetKinectArray::NetKinectArray(const std::vector<std::shared_ptr<KinectCalibrationFile>>& calib_files, const std::string& server_endpoint, unsigned colorsize_byte, unsigned depthsize_byte)
-    : m_mutex(), m_running(true), m_server_endpoint(server_endpoint), m_calib_files(calib_files), m_colorsize_byte(colorsize_byte), m_depthsize_byte(depthsize_byte),
-      m_buffer((m_colorsize_byte + m_depthsize_byte) * m_calib_files.size()), m_buffer_back((m_colorsize_byte + m_depthsize_byte) * m_calib_files.size()), m_need_swap(false), m_recv()
+    : m_mutex(), m_frame_consumed(), m_running(true), m_server_endpoint(server_endpoint), m_calib_files(calib_files), m_colorsize_byte(colorsize_byte), m_depthsize_byte(depthsize_byte),
+      m_buffer((m_colorsize_byte + m_depthsize_byte) * m_calib_files.size()), m_buffer_ready(m_buffer.size()), m_buffer_back(m_buffer.size()), m_ready_is_new(false), m_num_received(0),
+      m_num_dropped(0), m_num_rejected(0), m_recv()
 {
-    m_recv = std::thread([this]() { readloop(); });
+    std::string recording_filename;
+    float replay_speed = 1.f;
+
+    if(gua::MessagePlayer::parse_endpoint(m_server_endpoint, recording_filename, replay_speed))
+    {
+        auto recording(std::make_shared<gua::MessageRecording const>(recording_filename));
+
+        if(recording->is_valid())
+        {
+            m_player = std::make_shared<gua::MessagePlayer>(recording, replay_speed);
+            m_recv = std::thread([this]() { replayloop(); });
+        }
+    }
+    else
+    {
+        m_recv = std::thread([this]() { readloop(); });
+    }
 }
 
 NetKinectArray::~NetKinectArray()
 {
-    m_running.store(false);
-    m_recv.join();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running.store(false);
+    }
+    m_frame_consumed.notify_all();
+
+    if(m_player)
+    {
+        m_player->stop();
+    }
+    if(m_recv.joinable())
+    {
+        m_recv.join();
+    }
 }
 
 bool NetKinectArray::update()
 {
     {
         std::lock_guard<std::mutex> lock(m_mutex);
-        if(m_need_swap.load())
+        if(!m_ready_is_new)
         {
-            m_buffer.swap(m_buffer_back);
-            m_need_swap.store(false);
-            return true;
+            return false;
         }
+        m_buffer.swap(m_buffer_ready);
+        m_ready_is_new = false;
+    }
+    m_frame_consumed.notify_one();
+    return true;
+}
+
+bool NetKinectArray::start_recording(std::string const& filename)
+{
+    auto recorder(std::make_shared<gua::MessageRecorder>());
+
+    if(!recorder->open(filename))
+    {
+        return false;
     }
-    return false;
+
+    std::atomic_store(&m_recorder, recorder);
+    return true;
 }
 
+void NetKinectArray::stop_recording() { std::atomic_store(&m_recorder, std::shared_ptr<gua::MessageRecorder>()); }
+
 void NetKinectArray::readloop()
 {
     // open multicast listening connection to server and port
@@ -48,31 +96,71 @@ void NetKinectArray::readloop()
     int hwm = 1;
     socket.setsockopt(ZMQ_RCVHWM, &hwm, sizeof(hwm));
 #endif
+    // wake up regularly to notice shutdown
+    int receive_timeout_ms = 100;
+    socket.setsockopt(ZMQ_RCVTIMEO, &receive_timeout_ms, sizeof(receive_timeout_ms));
+
     std::string endpoint("tcp://" + m_server_endpoint);
     socket.connect(endpoint.c_str());
 
-    const unsigned message_size = (m_colorsize_byte + m_depthsize_byte) * m_calib_files.size();
-
     while(m_running)
     {
-        zmq::message_t zmqm(message_size);
-        socket.recv(&zmqm); // blocking
+        // the payload goes straight into the back buffer, which is recycled from frame to frame
+        const std::size_t received = socket.recv(m_buffer_back.data(), m_buffer_back.size()); // blocking until timeout
+        if(received == 0)
+        {
+            continue;
+        }
+        if(received != m_buffer_back.size())
+        {
+            ++m_num_rejected;
+            continue;
+        }
 
-        while(true)
+        auto recorder(std::atomic_load(&m_recorder));
+        if(recorder)
         {
-            std::lock_guard<std::mutex> lock(m_mutex);
+            recorder->write(m_buffer_back.data(), m_buffer_back.size());
+        }
+
+        publish();
+    }
+}
 
-            if(!m_need_swap.load() || !m_running.load())
-            {
-                break;
-            }
+void NetKinectArray::replayloop()
+{
+    gua::MessageRecording::Message recorded;
+
+    while(m_running && m_player->next(recorded))
+    {
+        if(recorded.size != m_buffer_back.size())
+        {
+            ++m_num_rejected;
+            gua::Logger::LOG_WARNING << "Recorded frame of " << recorded.size << " bytes does not match the calibration (" << m_buffer_back.size() << " bytes), skipping it." << std::endl;
+            continue;
         }
 
-        memcpy((unsigned char*)m_buffer_back.data(), (unsigned char*)zmqm.data(), message_size);
-        { // swap
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_need_swap.store(true);
+        memcpy(m_buffer_back.data(), recorded.data, m_buffer_back.size());
+
+        // frames are handed over one by one, so even unpaced replays don't skip any
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_frame_consumed.wait(lock, [this]() { return !m_ready_is_new || !m_running.load(); });
         }
+
+        publish();
+    }
+}
+
+void NetKinectArray::publish()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_ready_is_new)
+    {
+        ++m_num_dropped;
     }
+    m_buffer_ready.swap(m_buffer_back);
+    m_ready_is_new = true;
+    ++m_num_received;
 }
 } // namespace video3d
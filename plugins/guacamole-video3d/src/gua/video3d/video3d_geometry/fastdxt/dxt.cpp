@@ -8,6 +8,11 @@
 
 #include <iostream>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define DXT_SSE2 1
+#endif
+
 //#define DXT_INTR 1
 
 void ExtractBlock(const byte* inPtr, int width, byte* colorBlock);
@@ -21,6 +26,17 @@ void GetMinMaxColors_Intrinsics(const byte* colorBlock, byte* minColor, byte* ma
 // for DXT5
 void GetMinMaxColorsAlpha(byte* colorBlock, byte* minColor, byte* maxColor);
 
+#if defined(DXT_SSE2)
+void ExtractBlock_Intrinsics(const byte* inPtr, int width, byte* colorBlock)
+{
+    for(int j = 0; j < 4; j++)
+    {
+        _mm_store_si128((__m128i*)&colorBlock[j * 4 * 4], _mm_loadu_si128((const __m128i*)inPtr));
+        inPtr += width * 4;
+    }
+}
+#endif
+
 word ColorTo565(const byte* color);
 
 void EmitByte(byte b, byte*&);
@@ -39,9 +55,6 @@ void EmitAlphaIndices_Intrinsics(const byte* colorBlock, const byte minAlpha, co
 void CompressImageDXT1(const byte* inBuf, byte* outBuf, int width, int height, int& outputBytes)
 {
     ALIGN16(byte * outData);
-    ALIGN16(byte block[64]);
-    ALIGN16(byte minColor[4]);
-    ALIGN16(byte maxColor[4]);
 
     outData = outBuf;
 
@@ -49,30 +62,34 @@ void CompressImageDXT1(const byte* inBuf, byte* outBuf, int width, int height, i
     {
         for(int i = 0; i < width; i += 4)
         {
-            // std::cerr << "i " << i << " j " << j << std::endl;
-#if defined(DXT_INTR)
-            ExtractBlock_Intrinsics(inBuf + i * 4, width, block);
-#else
-            ExtractBlock(inBuf + i * 4, width, block);
-#endif
+            CompressBlockDXT1(inBuf + i * 4, width, outData);
+        }
+    }
+    outputBytes = (int)(outData - outBuf);
+}
 
-#if defined(DXT_INTR)
-            GetMinMaxColors_Intrinsics(block, minColor, maxColor);
+void CompressBlockDXT1(const byte* inPtr, int width, byte*& outData)
+{
+    ALIGN16(byte block[64]);
+    ALIGN16(byte minColor[4]);
+    ALIGN16(byte maxColor[4]);
+
+#if defined(DXT_SSE2)
+    ExtractBlock_Intrinsics(inPtr, width, block);
+    GetMinMaxColors_Intrinsics(block, minColor, maxColor);
 #else
-            GetMinMaxColorsByBBox(block, minColor, maxColor);
+    ExtractBlock(inPtr, width, block);
+    GetMinMaxColorsByBBox(block, minColor, maxColor);
 #endif
 
-            EmitWord(ColorTo565(maxColor), outData);
-            EmitWord(ColorTo565(minColor), outData);
+    EmitWord(ColorTo565(maxColor), outData);
+    EmitWord(ColorTo565(minColor), outData);
 
 #if defined(DXT_INTR)
-            EmitColorIndices_Intrinsics(block, minColor, maxColor, outData);
+    EmitColorIndices_Intrinsics(block, minColor, maxColor, outData);
 #else
-            EmitColorIndicesFast(block, minColor, maxColor, outData);
+    EmitColorIndicesFast(block, minColor, maxColor, outData);
 #endif
-        }
-    }
-    outputBytes = (int)(outData - outBuf);
 }
 
 void RGBAtoYCoCg(const byte* inBuf, byte* outBuf, int width, int height)
@@ -308,6 +325,30 @@ void GetMinMaxColorsByBBox(const byte* colorBlock, byte* minColor, byte* maxColo
     maxColor[2] = (maxColor[2] >= inset[2]) ? maxColor[2] - inset[2] : 0;
 }
 
+#if defined(DXT_SSE2)
+// same bounding box as GetMinMaxColorsByBBox, computed for all four channels at once
+void GetMinMaxColors_Intrinsics(const byte* colorBlock, byte* minColor, byte* maxColor)
+{
+    const __m128i* block = (const __m128i*)colorBlock;
+
+    __m128i min = _mm_min_epu8(_mm_min_epu8(block[0], block[1]), _mm_min_epu8(block[2], block[3]));
+    __m128i max = _mm_max_epu8(_mm_max_epu8(block[0], block[1]), _mm_max_epu8(block[2], block[3]));
+    min = _mm_min_epu8(min, _mm_shuffle_epi32(min, _MM_SHUFFLE(2, 3, 0, 1)));
+    max = _mm_max_epu8(max, _mm_shuffle_epi32(max, _MM_SHUFFLE(2, 3, 0, 1)));
+    min = _mm_min_epu8(min, _mm_shuffle_epi32(min, _MM_SHUFFLE(1, 0, 3, 2)));
+    max = _mm_max_epu8(max, _mm_shuffle_epi32(max, _MM_SHUFFLE(1, 0, 3, 2)));
+
+    const __m128i zero = _mm_setzero_si128();
+    __m128i inset = _mm_srli_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(max, zero), _mm_unpacklo_epi8(min, zero)), INSET_SHIFT);
+    inset = _mm_packus_epi16(inset, inset);
+
+    const int min_color = _mm_cvtsi128_si32(_mm_adds_epu8(min, inset));
+    const int max_color = _mm_cvtsi128_si32(_mm_subs_epu8(max, inset));
+    memcpy(minColor, &min_color, 4);
+    memcpy(maxColor, &max_color, 4);
+}
+#endif
+
 //
 // GetMinMaxColorsAlpha for DXT5
 //
@@ -28,6 +28,7 @@
 #include <gua/renderer/Texture2D.hpp>
 #include <gua/renderer/Texture3D.hpp>
 #include <gua/renderer/ShaderProgram.hpp>
+#include <gua/utils/VolumeBrickGrid.hpp>
 
 // external headers
 #include <scm/gl_core.h>
@@ -119,6 +120,11 @@ class GUA_VOLUME_DLL Volume : public GeometryResource
                           const scm::data::piecewise_function_1d<float, float>& in_alpha,
                           const scm::data::piecewise_function_1d<float, scm::math::vec3f>& in_color) const;
 
+    // reads the brick grid from "<volume file>.bricks" or builds it from the uploaded texture
+    void load_brick_grid(RenderContext const& context) const;
+    // recomputes the skip grid for the current alpha transfer function
+    void update_skip_grid() const;
+
     mutable bool _update_transfer_function;
 
     ////Volume files
@@ -137,6 +143,13 @@ class GUA_VOLUME_DLL Volume : public GeometryResource
 
     mutable std::vector<scm::gl::sampler_state_ptr> _sstate;
 
+    // empty space skipping: distances to the next visible brick, one texel per brick
+    mutable VolumeBrickGrid _brick_grid;
+    mutable std::vector<uint8_t> _skip_grid;
+    mutable unsigned _skip_grid_version;
+    mutable std::vector<std::shared_ptr<Texture3D>> _skip_texture_ptr;
+    mutable std::vector<unsigned> _skip_texture_version;
+
     mutable std::mutex upload_mutex_;
 
     scm::data::piecewise_function_1d<float, float> _alpha_transfer;
@@ -40,11 +40,11 @@ namespace gua
 {
 ////////////////////////////////////////////////////////////////////////////////
 
-Volume::Volume() : _volume_boxes_ptr(), upload_mutex_() {}
+Volume::Volume() : _volume_boxes_ptr(), _skip_grid_version(0), upload_mutex_() {}
 
 ////////////////////////////////////////////////////////////////////////////////
 
-Volume::Volume(std::string const& file_name) : _volume_file_path(file_name), _volume_boxes_ptr(), upload_mutex_()
+Volume::Volume(std::string const& file_name) : _volume_file_path(file_name), _volume_boxes_ptr(), _skip_grid_version(0), upload_mutex_()
 {
     scm::gl::volume_loader scm_volume_loader;
     _volume_dimensions = scm_volume_loader.read_dimensions(file_name);
@@ -111,6 +111,8 @@ void Volume::upload_to(RenderContext const& ctx) const
         _transfer_texture_ptr.resize(ctx.id + 1);
         _volume_boxes_ptr.resize(ctx.id + 1);
         _sstate.resize(ctx.id + 1);
+        _skip_texture_ptr.resize(ctx.id + 1);
+        _skip_texture_version.resize(ctx.id + 1);
     }
 
     // scm::gl::volume_loader scm_volume_loader;
@@ -134,6 +136,100 @@ void Volume::upload_to(RenderContext const& ctx) const
     _volume_boxes_ptr[ctx.id] = scm::gl::box_volume_geometry_ptr(new scm::gl::box_volume_geometry(ctx.render_device, math::vec3f(0.0), math::vec3f(_volume_dimensions_normalized)));
 
     _sstate[ctx.id] = ctx.render_device->create_sampler_state(scm::gl::FILTER_MIN_MAG_MIP_LINEAR, scm::gl::WRAP_CLAMP_TO_EDGE);
+
+    if(_brick_grid.empty())
+    {
+        load_brick_grid(ctx);
+        update_skip_grid();
+    }
+
+    if(!_skip_grid.empty())
+    {
+        auto const& grid_dimensions(_brick_grid.get_grid_dimensions());
+        _skip_texture_ptr[ctx.id] = std::make_shared<Texture3D>(grid_dimensions[0],
+                                                                 grid_dimensions[1],
+                                                                 grid_dimensions[2],
+                                                                 scm::gl::FORMAT_R_8UI,
+                                                                 scm::gl::FORMAT_R_8UI,
+                                                                 std::vector<void*>{_skip_grid.data()},
+                                                                 1,
+                                                                 scm::gl::sampler_state_desc(scm::gl::FILTER_MIN_MAG_NEAREST, scm::gl::WRAP_CLAMP_TO_EDGE, scm::gl::WRAP_CLAMP_TO_EDGE));
+        _skip_texture_ptr[ctx.id]->upload_to(ctx);
+        _skip_texture_version[ctx.id] = _skip_grid_version;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Volume::load_brick_grid(RenderContext const& ctx) const
+{
+    uint64_t const key = VolumeBrickGrid::hash_file(_volume_file_path);
+    std::string const cache_file = _volume_file_path + ".bricks";
+
+    if(_brick_grid.load(cache_file, key))
+    {
+        return;
+    }
+
+    auto const& texture(_volume_texture_ptr[ctx.id]->get_buffer(ctx));
+    if(!texture)
+    {
+        return;
+    }
+
+    VolumeBrickGrid::VoxelType type;
+    switch(texture->format())
+    {
+    case scm::gl::FORMAT_R_8:
+        type = VolumeBrickGrid::VoxelType::UINT8;
+        break;
+    case scm::gl::FORMAT_R_16:
+        type = VolumeBrickGrid::VoxelType::UINT16;
+        break;
+    case scm::gl::FORMAT_R_32F:
+        type = VolumeBrickGrid::VoxelType::FLOAT32;
+        break;
+    default:
+        Logger::LOG_WARNING << "Volume::load_brick_grid(): no empty space skipping for the voxel format of " << _volume_file_path << std::endl;
+        return;
+    }
+
+    // the loader keeps no copy of the voxels, read them back once
+    VolumeBrickGrid::Dimensions const dimensions = {{_volume_texture_ptr[ctx.id]->width(), _volume_texture_ptr[ctx.id]->height(), _volume_texture_ptr[ctx.id]->depth()}};
+    std::vector<uint8_t> voxels(std::size_t(dimensions[0]) * dimensions[1] * dimensions[2] * scm::gl::size_of_format(texture->format()));
+    if(!ctx.render_context->retrieve_texture_data(texture, 0, voxels.data()))
+    {
+        return;
+    }
+
+    _brick_grid.build(voxels.data(), dimensions, type);
+
+    if(key == 0 || !_brick_grid.save(cache_file, key))
+    {
+        Logger::LOG_DEBUG << "Volume::load_brick_grid(): unable to cache the brick grid of " << _volume_file_path << std::endl;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Volume::update_skip_grid() const
+{
+    if(_brick_grid.empty())
+    {
+        return;
+    }
+
+    // same resolution as the color map
+    unsigned const lookup_table_size = 255;
+    scm::scoped_array<float> alpha_lut(new float[lookup_table_size]);
+    if(!scm::data::build_lookup_table(alpha_lut, _alpha_transfer, lookup_table_size))
+    {
+        return;
+    }
+
+    std::vector<float> opacity(alpha_lut.get(), alpha_lut.get() + lookup_table_size);
+    _skip_grid = _brick_grid.compute_distances(_brick_grid.compute_occupancy(opacity));
+    ++_skip_grid_version;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -267,6 +363,7 @@ void Volume::set_uniforms(RenderContext const& ctx, ShaderProgram* cs) const
         {
             update_color_map(ctx, *color_map_texture, _alpha_transfer, _color_transfer);
         }
+        update_skip_grid();
         _update_transfer_function = false;
     }
 
@@ -280,6 +377,24 @@ void Volume::set_uniforms(RenderContext const& ctx, ShaderProgram* cs) const
     cs->set_uniform(ctx, _transfer_texture_ptr[ctx.id]->get_handle(ctx), "transfer_texture");
     cs->set_uniform(ctx, _step_size, "sampling_distance");
     cs->set_uniform(ctx, math::vec3f(_volume_dimensions_normalized), "volume_bounds");
+
+    bool const skip_empty_space = _skip_texture_ptr.size() > ctx.id && _skip_texture_ptr[ctx.id];
+    if(skip_empty_space)
+    {
+        auto const& grid_dimensions(_brick_grid.get_grid_dimensions());
+        if(_skip_texture_version[ctx.id] != _skip_grid_version)
+        {
+            scm::gl::texture_region region(math::vec3ui(0u), math::vec3ui(grid_dimensions[0], grid_dimensions[1], grid_dimensions[2]));
+            ctx.render_context->update_sub_texture(_skip_texture_ptr[ctx.id]->get_buffer(ctx), region, 0u, scm::gl::FORMAT_R_8UI, _skip_grid.data());
+            _skip_texture_version[ctx.id] = _skip_grid_version;
+        }
+
+        auto const& volume_dimensions(_brick_grid.get_volume_dimensions());
+        float const brick_size(_brick_grid.get_brick_size());
+        cs->set_uniform(ctx, _skip_texture_ptr[ctx.id]->get_handle(ctx), "skip_texture");
+        cs->set_uniform(ctx, math::vec3f(volume_dimensions[0] / brick_size, volume_dimensions[1] / brick_size, volume_dimensions[2] / brick_size), "brick_grid_scale");
+    }
+    cs->set_uniform(ctx, skip_empty_space, "empty_space_skipping");
 }
 
 ////////////////////////////////////////////////////////////////////////////////
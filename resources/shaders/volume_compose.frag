@@ -27,6 +27,11 @@ uniform uvec2 transfer_texture;
 uniform float sampling_distance;
 uniform vec3  volume_bounds;
 
+// empty space skipping, one texel per brick holding the distance to the next visible brick
+uniform uvec2 skip_texture;
+uniform vec3  brick_grid_scale;
+uniform bool  empty_space_skipping = false;
+
 uniform uvec2 gua_ray_entry_in;
 
 in vec2 gua_quad_coords;
@@ -59,6 +64,27 @@ bool inside_volume_bounds(const in vec3 sampling_position) {
             && all(lessThanEqual(sampling_position, volume_bounds)));
 }
 
+// number of ray increments which stay within empty bricks, 0 if the brick at the position is visible
+int get_empty_steps(vec3 tex_pos, vec3 tex_increment) {
+  vec3 brick_pos = tex_pos * brick_grid_scale;
+  uint distance  = texelFetch(usampler3D(skip_texture), ivec3(brick_pos), 0).r;
+
+  if (distance == 0u) {
+    return 0;
+  }
+
+  // all bricks closer than distance are empty, find where the ray leaves them
+  vec3 brick_increment = tex_increment * brick_grid_scale;
+  vec3 brick           = floor(brick_pos);
+  bvec3 forward        = greaterThan(brick_increment, vec3(0.0));
+  vec3 exit_plane      = mix(brick - vec3(float(distance) - 1.0), brick + vec3(float(distance)), forward);
+
+  bvec3 moving     = greaterThan(abs(brick_increment), vec3(1e-7));
+  vec3 exit_steps  = mix(vec3(1e20), (exit_plane - brick_pos) / brick_increment, moving);
+
+  return int(floor(min(min(exit_steps.x, exit_steps.y), exit_steps.z)));
+}
+
 vec4 get_raycast_color(vec3 gua_object_volume_position,
           float d_gbuffer, float d_volume) {
 
@@ -80,6 +106,17 @@ vec4 get_raycast_color(vec3 gua_object_volume_position,
   while (inside_volume && (d_step_cur < d_steps)) {
     ++d_step_cur;
 
+    // jump over samples which are transparent for sure
+    if (empty_space_skipping) {
+      int empty_steps = get_empty_steps(sampling_pos * obj_to_tex, ray_increment * obj_to_tex);
+      if (empty_steps > 0) {
+        sampling_pos += float(empty_steps) * ray_increment;
+        d_step_cur   += empty_steps - 1;
+        inside_volume = inside_volume_bounds(sampling_pos);
+        continue;
+      }
+    }
+
     // get sample
     float s   = texture(sampler3D(volume_texture), sampling_pos * obj_to_tex).x;
     vec4  src = texture(sampler2D(transfer_texture), vec2(s, 0.5));
@@ -238,6 +238,9 @@ void LineStripNode::update_cache()
     GeometryNode::update_cache();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+std::size_t LineStripNode::get_geometry_revision() const { return geometry_ ? geometry_->get_revision() : 0; }
+
 ////////////////////////////////////////////////////////////////////////////////
 std::shared_ptr<LineStripResource> const& LineStripNode::get_geometry() const { return geometry_; }
 
@@ -329,6 +332,15 @@ void LineStripNode::pop_back_vertex()
     }
 };
 
+////////////////////////////////////////////////////////////////////////////////
+void LineStripNode::set_ring_buffer_mode(bool enable)
+{
+    if(nullptr != geometry_)
+    {
+        geometry_->set_ring_buffer_mode(enable);
+    }
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 void LineStripNode::clear_vertices()
 {
@@ -0,0 +1,404 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+// class header
+#include <gua/physics/CollisionMeshCache.hpp>
+
+// guacamole headers
+#include <gua/utils/BinaryCacheFile.hpp>
+#include <gua/utils/Logger.hpp>
+
+// external headers
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include <btBulletCollisionCommon.h>
+#include <HACD/hacdHACD.h>
+
+namespace gua
+{
+namespace physics
+{
+namespace
+{
+// BVHs are stored in Bullet's in-place format, which changes between Bullet versions
+uint32_t static_mesh_format() { return CollisionMeshCache::CACHE_VERSION * 100000u + uint32_t(BT_BULLET_VERSION); }
+
+unsigned const BVH_ALIGNMENT = 16;
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+const uint32_t CollisionMeshCache::CACHE_VERSION;
+
+////////////////////////////////////////////////////////////////////////////////
+
+CollisionMeshCache::StaticMesh::~StaticMesh()
+{
+    delete shape_;
+    delete mesh_interface_;
+    if(bvh_buffer_)
+        btAlignedFree(bvh_buffer_);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CollisionMeshCache::StaticMesh::create_mesh_interface()
+{
+    btIndexedMesh indexed_mesh;
+    indexed_mesh.m_numTriangles = int(indices_.size() / 3);
+    indexed_mesh.m_triangleIndexBase = reinterpret_cast<unsigned char const*>(indices_.data());
+    indexed_mesh.m_triangleIndexStride = 3 * sizeof(int);
+    indexed_mesh.m_numVertices = int(positions_.size() / 3);
+    indexed_mesh.m_vertexBase = reinterpret_cast<unsigned char const*>(positions_.data());
+    indexed_mesh.m_vertexStride = 3 * sizeof(float);
+    indexed_mesh.m_vertexType = PHY_FLOAT;
+
+    mesh_interface_ = new btTriangleIndexVertexArray();
+    mesh_interface_->addIndexedMesh(indexed_mesh, PHY_INTEGER);
+
+    // the bounds of the vertices, which spares the shape a pass over all triangles
+    if(!positions_.empty())
+    {
+        btVector3 aabb_min(positions_[0], positions_[1], positions_[2]);
+        btVector3 aabb_max(aabb_min);
+        for(std::size_t i = 3; i < positions_.size(); i += 3)
+        {
+            btVector3 const position(positions_[i], positions_[i + 1], positions_[i + 2]);
+            aabb_min.setMin(position);
+            aabb_max.setMax(position);
+        }
+        mesh_interface_->setPremadeAabb(aabb_min, aabb_max);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CollisionMeshCache::set_directory(std::string const& directory)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    directory_ = directory;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::string CollisionMeshCache::get_directory() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return directory_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<CollisionMeshCache::StaticMesh const> CollisionMeshCache::get_static_mesh(std::string const& name, std::function<void(Mesh&)> const& collect)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto entry(static_meshes_.find(name));
+        if(entry != static_meshes_.end())
+        {
+            auto static_mesh(entry->second.lock());
+            if(static_mesh)
+                return static_mesh;
+        }
+    }
+
+    // built without holding the lock, meshes of other names are not blocked
+    Mesh mesh;
+    collect(mesh);
+
+    uint64_t const key(hash(mesh));
+    std::string const file_name(cache_file_name(key, ".gua_bvh"));
+
+    std::shared_ptr<StaticMesh const> static_mesh;
+    if(!file_name.empty())
+        static_mesh = load_static_mesh(file_name, key);
+
+    if(!static_mesh)
+    {
+        auto built(build_static_mesh(mesh));
+        if(!file_name.empty() && !save_static_mesh(file_name, key, *built))
+            Logger::LOG_DEBUG << "Unable to write collision mesh cache " << file_name << std::endl;
+        static_mesh = built;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& entry(static_meshes_[name]);
+    auto concurrently_built(entry.lock());
+    if(concurrently_built)
+        return concurrently_built;
+
+    entry = static_mesh;
+    return static_mesh;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<CollisionMeshCache::ConvexDecomposition const> CollisionMeshCache::get_convex_decomposition(std::string const& name, HACDParameters const& parameters, std::function<void(Mesh&)> const& collect)
+{
+    std::ostringstream name_and_parameters;
+    name_and_parameters << name << '\n'
+                        << parameters.min_clusters << ' ' << parameters.max_ch_vertices << ' ' << std::setprecision(17) << parameters.concavity << ' ' << parameters.add_extra_dist_points << ' '
+                        << parameters.add_neighbours_dist_points << ' ' << parameters.add_faces_points;
+    std::string const entry_name(name_and_parameters.str());
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto entry(convex_decompositions_.find(entry_name));
+        if(entry != convex_decompositions_.end())
+        {
+            auto decomposition(entry->second.lock());
+            if(decomposition)
+                return decomposition;
+        }
+    }
+
+    Mesh mesh;
+    collect(mesh);
+
+    uint64_t const key(hash(mesh, parameters));
+    std::string const file_name(cache_file_name(key, ".gua_hacd"));
+
+    std::shared_ptr<ConvexDecomposition const> decomposition;
+    if(!file_name.empty())
+        decomposition = load_convex_decomposition(file_name, key);
+
+    if(!decomposition)
+    {
+        auto computed(decompose(mesh, parameters));
+        if(!file_name.empty() && !save_convex_decomposition(file_name, key, *computed))
+            Logger::LOG_DEBUG << "Unable to write collision mesh cache " << file_name << std::endl;
+        decomposition = computed;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& entry(convex_decompositions_[entry_name]);
+    auto concurrently_computed(entry.lock());
+    if(concurrently_computed)
+        return concurrently_computed;
+
+    entry = decomposition;
+    return decomposition;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/* static */ std::shared_ptr<CollisionMeshCache::StaticMesh> CollisionMeshCache::build_static_mesh(Mesh const& mesh)
+{
+    std::shared_ptr<StaticMesh> static_mesh(new StaticMesh());
+    static_mesh->positions_.assign(mesh.positions.begin(), mesh.positions.end());
+    static_mesh->indices_ = mesh.indices;
+    static_mesh->create_mesh_interface();
+    static_mesh->shape_ = new btBvhTriangleMeshShape(static_mesh->mesh_interface_, true);
+    return static_mesh;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/* static */ bool CollisionMeshCache::save_static_mesh(std::string const& file_name, uint64_t key, StaticMesh const& static_mesh)
+{
+    btOptimizedBvh const* bvh(static_mesh.shape()->getOptimizedBvh());
+    if(!bvh)
+        return false;
+
+    unsigned const bvh_size(bvh->calculateSerializeBufferSize());
+    void* bvh_buffer(btAlignedAlloc(bvh_size, BVH_ALIGNMENT));
+    bool const serialized(bvh->serializeInPlace(bvh_buffer, bvh_size, false));
+    std::vector<char> bvh_bytes(static_cast<char*>(bvh_buffer), static_cast<char*>(bvh_buffer) + bvh_size);
+    btAlignedFree(bvh_buffer);
+
+    if(!serialized)
+        return false;
+
+    BinaryCacheFile cache(static_mesh_format(), key);
+    cache.set("positions", static_mesh.positions_);
+    cache.set("indices", static_mesh.indices_);
+    cache.set("bvh", bvh_bytes);
+    return cache.save(file_name);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/* static */ std::shared_ptr<CollisionMeshCache::StaticMesh> CollisionMeshCache::load_static_mesh(std::string const& file_name, uint64_t key)
+{
+    BinaryCacheFile cache(static_mesh_format(), key);
+    std::shared_ptr<StaticMesh> static_mesh(new StaticMesh());
+    std::vector<char> bvh_bytes;
+
+    if(!cache.load(file_name) || !cache.get("positions", static_mesh->positions_) || !cache.get("indices", static_mesh->indices_) || !cache.get("bvh", bvh_bytes) || bvh_bytes.empty())
+    {
+        return nullptr;
+    }
+
+    int const num_vertices(int(static_mesh->positions_.size() / 3));
+    if(static_mesh->indices_.size() % 3 != 0 || std::any_of(static_mesh->indices_.begin(), static_mesh->indices_.end(), [&](int index) { return index < 0 || index >= num_vertices; }))
+    {
+        return nullptr;
+    }
+
+    static_mesh->bvh_buffer_ = btAlignedAlloc(unsigned(bvh_bytes.size()), BVH_ALIGNMENT);
+    std::memcpy(static_mesh->bvh_buffer_, bvh_bytes.data(), bvh_bytes.size());
+    btQuantizedBvh* bvh(btQuantizedBvh::deSerializeInPlace(static_mesh->bvh_buffer_, unsigned(bvh_bytes.size()), false));
+    if(!bvh)
+        return nullptr;
+
+    static_mesh->create_mesh_interface();
+
+    // the quantization bounds are part of the serialized BVH, the ones passed here are not used
+    btVector3 aabb_min(0, 0, 0), aabb_max(0, 0, 0);
+    if(static_mesh->mesh_interface_->hasPremadeAabb())
+        static_mesh->mesh_interface_->getPremadeAabb(&aabb_min, &aabb_max);
+    static_mesh->shape_ = new btBvhTriangleMeshShape(static_mesh->mesh_interface_, true, aabb_min, aabb_max, false);
+    static_mesh->shape_->setOptimizedBvh(static_cast<btOptimizedBvh*>(bvh));
+    return static_mesh;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/* static */ std::shared_ptr<CollisionMeshCache::ConvexDecomposition> CollisionMeshCache::decompose(Mesh const& mesh, HACDParameters const& parameters)
+{
+    std::vector<HACD::Vec3<HACD::Real>> points;
+    points.reserve(mesh.positions.size() / 3);
+    for(std::size_t i = 0; i + 2 < mesh.positions.size(); i += 3)
+        points.push_back(HACD::Vec3<HACD::Real>(mesh.positions[i], mesh.positions[i + 1], mesh.positions[i + 2]));
+
+    std::vector<HACD::Vec3<long>> triangles;
+    triangles.reserve(mesh.indices.size() / 3);
+    for(std::size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+        triangles.push_back(HACD::Vec3<long>(mesh.indices[i], mesh.indices[i + 1], mesh.indices[i + 2]));
+
+    HACD::HACD hacd;
+    hacd.SetPoints(points.data());
+    hacd.SetNPoints(points.size());
+    hacd.SetTriangles(triangles.data());
+    hacd.SetNTriangles(triangles.size());
+    hacd.SetCompacityWeight(0.1);
+    hacd.SetVolumeWeight(0.0);
+
+    hacd.SetNClusters(parameters.min_clusters);
+    hacd.SetNVerticesPerCH(parameters.max_ch_vertices);
+    hacd.SetConcavity(parameters.concavity);
+    hacd.SetAddExtraDistPoints(parameters.add_extra_dist_points);
+    hacd.SetAddNeighboursDistPoints(parameters.add_neighbours_dist_points);
+    hacd.SetAddFacesPoints(parameters.add_faces_points);
+
+    hacd.Compute();
+    size_t cluster_num = hacd.GetNClusters();
+    std::cout << "HACD: Decomposed in " << cluster_num << " convex hulls." << std::endl;
+
+    std::shared_ptr<ConvexDecomposition> decomposition(new ConvexDecomposition());
+    for(size_t c(0); c < cluster_num; ++c)
+    {
+        size_t points_num = hacd.GetNPointsCH(c);
+
+        std::vector<HACD::Vec3<HACD::Real>> points_ch(points_num);
+        std::vector<HACD::Vec3<long>> triangles_ch(hacd.GetNTrianglesCH(c));
+        hacd.GetCH(c, points_ch.data(), triangles_ch.data());
+
+        for(auto const& point : points_ch)
+        {
+            decomposition->points.push_back(point.X());
+            decomposition->points.push_back(point.Y());
+            decomposition->points.push_back(point.Z());
+        }
+        decomposition->hull_sizes.push_back(unsigned(points_num));
+    }
+
+    return decomposition;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/* static */ bool CollisionMeshCache::save_convex_decomposition(std::string const& file_name, uint64_t key, ConvexDecomposition const& decomposition)
+{
+    BinaryCacheFile cache(CACHE_VERSION, key);
+    cache.set("points", decomposition.points);
+    cache.set("hull_sizes", decomposition.hull_sizes);
+    return cache.save(file_name);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/* static */ std::shared_ptr<CollisionMeshCache::ConvexDecomposition> CollisionMeshCache::load_convex_decomposition(std::string const& file_name, uint64_t key)
+{
+    BinaryCacheFile cache(CACHE_VERSION, key);
+    std::shared_ptr<ConvexDecomposition> decomposition(new ConvexDecomposition());
+
+    if(!cache.load(file_name) || !cache.get("points", decomposition->points) || !cache.get("hull_sizes", decomposition->hull_sizes))
+    {
+        return nullptr;
+    }
+
+    std::size_t num_points(0);
+    for(unsigned hull_size : decomposition->hull_sizes)
+        num_points += hull_size;
+
+    if(3 * num_points != decomposition->points.size())
+        return nullptr;
+
+    return decomposition;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/* static */ uint64_t CollisionMeshCache::hash(Mesh const& mesh)
+{
+    uint64_t const counts[2] = {mesh.positions.size(), mesh.indices.size()};
+    uint64_t key(BinaryCacheFile::hash_data(counts, sizeof(counts)));
+    key = BinaryCacheFile::hash_data(mesh.positions.data(), mesh.positions.size() * sizeof(double), key);
+    return BinaryCacheFile::hash_data(mesh.indices.data(), mesh.indices.size() * sizeof(int), key);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/* static */ uint64_t CollisionMeshCache::hash(Mesh const& mesh, HACDParameters const& parameters)
+{
+    double const values[6] = {double(parameters.min_clusters),
+                              double(parameters.max_ch_vertices),
+                              parameters.concavity,
+                              parameters.add_extra_dist_points ? 1.0 : 0.0,
+                              parameters.add_neighbours_dist_points ? 1.0 : 0.0,
+                              parameters.add_faces_points ? 1.0 : 0.0};
+    return BinaryCacheFile::hash_data(values, sizeof(values), hash(mesh));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::string CollisionMeshCache::cache_file_name(uint64_t key, std::string const& extension) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(directory_.empty())
+        return "";
+
+    std::ostringstream file_name;
+    file_name << directory_ << '/' << std::hex << std::setw(16) << std::setfill('0') << key << extension;
+    return file_name.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace physics
+} // namespace gua
@@ -28,9 +28,9 @@ namespace physics
 {
 ////////////////////////////////////////////////////////////////////////////////
 
-GuaMotionState::GuaMotionState(const btTransform& start_trans) : dirty(false)
+GuaMotionState::GuaMotionState(const btTransform& start_trans)
 {
-    for(int i(0); i < 3; ++i)
+    for(int i(0); i < 2; ++i)
         transforms_[i] = new btTransform(start_trans);
 }
 
@@ -38,7 +38,7 @@ GuaMotionState::GuaMotionState(const btTransform& start_trans) : dirty(false)
 
 GuaMotionState::~GuaMotionState()
 {
-    for(int i(0); i < 3; ++i)
+    for(int i(0); i < 2; ++i)
         delete transforms_[i];
 }
 
@@ -52,7 +52,7 @@ GuaMotionState::~GuaMotionState()
 
 ////////////////////////////////////////////////////////////////////////////////
 
-/* virtual */ void GuaMotionState::latest_transform(btTransform& centerOfMassWorldTrans) const { centerOfMassWorldTrans = *transforms_[2]; }
+/* virtual */ void GuaMotionState::latest_transform(btTransform& centerOfMassWorldTrans) const { centerOfMassWorldTrans = *transforms_[1]; }
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -0,0 +1,312 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+// class header
+#include <gua/physics/IslandParallelDynamicsWorld.hpp>
+
+// guacamole headers
+#include <gua/utils/Logger.hpp>
+
+// external headers
+#include <algorithm>
+
+// older versions of Bullet profile every solver call in one global tree
+#if BT_BULLET_VERSION >= 287 || defined(BT_NO_PROFILE)
+#define GUA_PHYSICS_PARALLEL_ISLANDS
+#endif
+
+namespace gua
+{
+namespace physics
+{
+namespace
+{
+// same as Bullet's island id of a constraint
+int island_id(btTypedConstraint const* constraint)
+{
+    int const id(constraint->getRigidBodyA().getIslandTag());
+    return id >= 0 ? id : constraint->getRigidBodyB().getIslandTag();
+}
+
+bool by_island(btTypedConstraint const* lhs, btTypedConstraint const* rhs) { return island_id(lhs) < island_id(rhs); }
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+// records the awake islands instead of solving them right away
+class IslandParallelDynamicsWorld::IslandCollector : public btSimulationIslandManager::IslandCallback
+{
+  public:
+    IslandCollector(std::vector<Island>& islands, std::vector<btTypedConstraint*>& sorted_constraints) : islands_(islands), sorted_constraints_(sorted_constraints) {}
+
+    virtual void processIsland(btCollisionObject** bodies, int num_bodies, btPersistentManifold** manifolds, int num_manifolds, int island)
+    {
+        Island result;
+        result.bodies.assign(bodies, bodies + num_bodies);
+        result.manifolds = manifolds;
+        result.num_manifolds = num_manifolds;
+
+        // a negative id is passed if islands are not split, then all constraints belong to it
+        auto first(sorted_constraints_.begin());
+        auto last(sorted_constraints_.end());
+        if(island >= 0)
+        {
+            for(; first != last && island_id(*first) < island; ++first)
+            {
+            }
+            last = first;
+            for(; last != sorted_constraints_.end() && island_id(*last) == island; ++last)
+            {
+            }
+        }
+        result.constraints = first != last ? &*first : nullptr;
+        result.num_constraints = int(last - first);
+
+        // kinematic bodies are not part of any island and may be shared
+        result.kinematic = false;
+        for(int i(0); i < num_manifolds && !result.kinematic; ++i)
+        {
+            result.kinematic = manifolds[i]->getBody0()->isKinematicObject() || manifolds[i]->getBody1()->isKinematicObject();
+        }
+        for(int i(0); i < result.num_constraints && !result.kinematic; ++i)
+        {
+            result.kinematic = result.constraints[i]->getRigidBodyA().isKinematicObject() || result.constraints[i]->getRigidBodyB().isKinematicObject();
+        }
+
+        islands_.push_back(std::move(result));
+    }
+
+  private:
+    std::vector<Island>& islands_;
+    std::vector<btTypedConstraint*>& sorted_constraints_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+IslandParallelDynamicsWorld::IslandParallelDynamicsWorld(btDispatcher* dispatcher, btBroadphaseInterface* broadphase, btConstraintSolver* solver, btCollisionConfiguration* collision_configuration)
+    : btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collision_configuration), islands_(), sorted_constraints_(), batches_(), solvers_(), workers_(), mutex_(), batches_ready_(),
+      batches_done_(), solver_info_(nullptr), generation_(0), pending_(0), running_(false)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+IslandParallelDynamicsWorld::~IslandParallelDynamicsWorld() { stop_workers(); }
+
+////////////////////////////////////////////////////////////////////////////////
+
+void IslandParallelDynamicsWorld::set_num_threads(unsigned num_threads)
+{
+    num_threads = std::max(1u, num_threads);
+
+    if(num_threads > 1 && !parallel_solving_supported())
+    {
+        Logger::LOG_WARNING << "Solving physics islands in parallel requires Bullet 2.87 or a build with BT_NO_PROFILE." << std::endl;
+        num_threads = 1;
+    }
+
+    if(num_threads == get_num_threads())
+        return;
+
+    stop_workers();
+
+    solvers_.clear();
+    batches_.clear();
+
+    if(num_threads > 1)
+    {
+        batches_.resize(num_threads);
+        for(unsigned i(0); i < num_threads; ++i)
+        {
+            solvers_.emplace_back(new btSequentialImpulseConstraintSolver());
+        }
+
+        // workers wait for the next generation of batches
+        generation_ = 0;
+        running_ = true;
+        for(unsigned i(1); i < num_threads; ++i)
+        {
+            workers_.emplace_back(&IslandParallelDynamicsWorld::work, this, i);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/* static */ bool IslandParallelDynamicsWorld::parallel_solving_supported()
+{
+#ifdef GUA_PHYSICS_PARALLEL_ISLANDS
+    return true;
+#else
+    return false;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/* virtual */ void IslandParallelDynamicsWorld::solveConstraints(btContactSolverInfo& solver_info)
+{
+    if(workers_.empty())
+    {
+        btDiscreteDynamicsWorld::solveConstraints(solver_info);
+        return;
+    }
+
+    sorted_constraints_.resize(getNumConstraints());
+    for(int i(0); i < getNumConstraints(); ++i)
+    {
+        sorted_constraints_[i] = getConstraint(i);
+    }
+    std::sort(sorted_constraints_.begin(), sorted_constraints_.end(), by_island);
+
+    islands_.clear();
+    IslandCollector collector(islands_, sorted_constraints_);
+    getSimulationIslandManager()->buildAndProcessIslands(getDispatcher(), getCollisionWorld(), &collector);
+
+    distribute_islands();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        solver_info_ = &solver_info;
+        pending_ = unsigned(workers_.size());
+        ++generation_;
+    }
+    batches_ready_.notify_all();
+
+    solve_batch(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    batches_done_.wait(lock, [this]() { return pending_ == 0; });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void IslandParallelDynamicsWorld::distribute_islands()
+{
+    for(auto& batch : batches_)
+    {
+        batch.bodies.clear();
+        batch.manifolds.clear();
+        batch.constraints.clear();
+        batch.cost = 0;
+    }
+
+    auto cost = [](Island const& island) { return island.bodies.size() + std::size_t(island.num_manifolds + island.num_constraints); };
+
+    auto append = [&cost](Batch& batch, Island const& island) {
+        batch.bodies.insert(batch.bodies.end(), island.bodies.begin(), island.bodies.end());
+        batch.manifolds.insert(batch.manifolds.end(), island.manifolds, island.manifolds + island.num_manifolds);
+        batch.constraints.insert(batch.constraints.end(), island.constraints, island.constraints + island.num_constraints);
+        batch.cost += cost(island);
+    };
+
+    // islands sharing kinematic bodies have to be solved by the same solver
+    std::vector<Island const*> independent;
+    for(auto const& island : islands_)
+    {
+        if(island.kinematic)
+        {
+            append(batches_.front(), island);
+        }
+        else
+        {
+            independent.push_back(&island);
+        }
+    }
+
+    // largest islands first, each to the batch with the least work so far
+    std::sort(independent.begin(), independent.end(), [&cost](Island const* lhs, Island const* rhs) { return cost(*lhs) > cost(*rhs); });
+    for(auto island : independent)
+    {
+        append(*std::min_element(batches_.begin(), batches_.end(), [](Batch const& lhs, Batch const& rhs) { return lhs.cost < rhs.cost; }), *island);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void IslandParallelDynamicsWorld::solve_batch(unsigned index)
+{
+    Batch& batch(batches_[index]);
+    if(batch.bodies.empty())
+        return;
+
+    // debug drawing is only done by the simulation thread
+    solvers_[index]->solveGroup(batch.bodies.data(),
+                                int(batch.bodies.size()),
+                                batch.manifolds.empty() ? nullptr : batch.manifolds.data(),
+                                int(batch.manifolds.size()),
+                                batch.constraints.empty() ? nullptr : batch.constraints.data(),
+                                int(batch.constraints.size()),
+                                *solver_info_,
+                                index == 0 ? getDebugDrawer() : nullptr,
+                                getDispatcher());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void IslandParallelDynamicsWorld::work(unsigned index)
+{
+    unsigned generation(0);
+
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            batches_ready_.wait(lock, [&]() { return !running_ || generation_ != generation; });
+
+            if(!running_)
+                return;
+
+            generation = generation_;
+        }
+
+        solve_batch(index);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --pending_;
+        }
+        batches_done_.notify_one();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void IslandParallelDynamicsWorld::stop_workers()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    batches_ready_.notify_all();
+
+    for(auto& worker : workers_)
+    {
+        worker.join();
+    }
+    workers_.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace physics
+} // namespace gua
@@ -33,6 +33,7 @@
 #include <gua/renderer/DisplayData.hpp>
 
 // external headers
+#include <algorithm>
 #include <iostream>
 #include <stack>
 
@@ -46,11 +47,18 @@ namespace gua
 {
 namespace physics
 {
+namespace
+{
+btTransform interpolate_transform(btTransform const& from, btTransform const& to, btScalar blend) { return btTransform(from.getRotation().slerp(to.getRotation(), blend), from.getOrigin().lerp(to.getOrigin(), blend)); }
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
 Physics::Physics()
-    : simulation_mutex_(), start_stop_mutex_(), motion_state_update_mutex_(), pause_mutex_(), thread_(nullptr), is_stopped_(true), fixed_timestep_(physics_default_fixed_timestep),
-      reduce_sim_rate_(physics_default_reduce_sim_rate), max_sim_time_(chrono::microseconds(physics_default_max_sim_time)), shape_visitor_(), call_once_queue_(), call_once_queue_mutex_(),
+    : simulation_mutex_(), start_stop_mutex_(), pause_mutex_(), thread_(nullptr), is_stopped_(true), is_paused_(false), group_(nullptr), last_step_time_(), num_steps_(0), fixed_timestep_(physics_default_fixed_timestep),
+      reduce_sim_rate_(physics_default_reduce_sim_rate), max_sim_time_(chrono::microseconds(physics_default_max_sim_time)), shape_visitor_(), interpolation_(true), call_once_queue_(), commands_(),
       broadphase_(new btDbvtBroadphase()), collision_configuration_(new btDefaultCollisionConfiguration()), dispatcher_(new btCollisionDispatcher(collision_configuration_)),
-      solver_(new btSequentialImpulseConstraintSolver()), dw_(new btDiscreteDynamicsWorld(dispatcher_, broadphase_, solver_, collision_configuration_)), rigid_bodies_(), constraints_(),
+      solver_(new btSequentialImpulseConstraintSolver()), dw_(new IslandParallelDynamicsWorld(dispatcher_, broadphase_, solver_, collision_configuration_)), constraints_(), bodies_mutex_(), rigid_bodies_(),
       physics_fps_(0.0f)
 {
     if(dw_)
@@ -60,10 +68,10 @@ Physics::Physics()
 ////////////////////////////////////////////////////////////////////////////////
 
 Physics::Physics(float gravity, float fixed_timestep)
-    : simulation_mutex_(), start_stop_mutex_(), motion_state_update_mutex_(), pause_mutex_(), thread_(nullptr), is_stopped_(true), fixed_timestep_(fixed_timestep),
-      reduce_sim_rate_(physics_default_reduce_sim_rate), max_sim_time_(chrono::microseconds(physics_default_max_sim_time)), shape_visitor_(), call_once_queue_(), call_once_queue_mutex_(),
+    : simulation_mutex_(), start_stop_mutex_(), pause_mutex_(), thread_(nullptr), is_stopped_(true), is_paused_(false), group_(nullptr), last_step_time_(), num_steps_(0), fixed_timestep_(fixed_timestep),
+      reduce_sim_rate_(physics_default_reduce_sim_rate), max_sim_time_(chrono::microseconds(physics_default_max_sim_time)), shape_visitor_(), interpolation_(true), call_once_queue_(), commands_(),
       broadphase_(new btDbvtBroadphase()), collision_configuration_(new btDefaultCollisionConfiguration()), dispatcher_(new btCollisionDispatcher(collision_configuration_)),
-      solver_(new btSequentialImpulseConstraintSolver()), dw_(new btDiscreteDynamicsWorld(dispatcher_, broadphase_, solver_, collision_configuration_)), rigid_bodies_(), constraints_(),
+      solver_(new btSequentialImpulseConstraintSolver()), dw_(new IslandParallelDynamicsWorld(dispatcher_, broadphase_, solver_, collision_configuration_)), constraints_(), bodies_mutex_(), rigid_bodies_(),
       physics_fps_(0.0f)
 {
     if(dw_)
@@ -113,7 +121,11 @@ Physics::~Physics()
     while(constraints_.size())
         remove_constraint(constraints_[0]);
     while(rigid_bodies_.size())
-        remove_rigid_body(rigid_bodies_[0]);
+    {
+        // remove_rigid_body() locks bodies_mutex_ itself
+        std::shared_ptr<RigidBodyNode> body(rigid_bodies_[0]);
+        remove_rigid_body(body);
+    }
     delete dw_;
     delete solver_;
     delete collision_configuration_;
@@ -126,7 +138,7 @@ Physics::~Physics()
 void Physics::start_simulation()
 {
     lock_guard<mutex> lk(start_stop_mutex_);
-    if(is_stopped_.load())
+    if(is_stopped_.load() && !group_.load())
     {
         is_stopped_.store(false);
         thread_ = new thread([&] { simulate(); });
@@ -143,6 +155,10 @@ void Physics::stop_simulation()
         is_stopped_.store(true);
         thread_->join();
         delete thread_;
+
+        // commands posted while the simulation was stopping
+        lock_guard<mutex> l(simulation_mutex_);
+        process_commands();
     }
 }
 
@@ -150,13 +166,18 @@ void Physics::stop_simulation()
 
 void Physics::pause(bool pause)
 {
-    if(is_stopped_.load())
-        return;
-
+    // the flag keeps repeated calls from locking or unlocking twice; lock()
+    // only waits while a step in progress checks the pause
     if(pause)
-        pause_mutex_.try_lock();
+    {
+        if(is_running() && !is_paused_.exchange(true))
+            pause_mutex_.lock();
+    }
     else
-        pause_mutex_.unlock();
+    {
+        if(is_paused_.exchange(false))
+            pause_mutex_.unlock();
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -185,22 +206,45 @@ void Physics::simulation_rate_reduction(bool enabled, int max_sim_time)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void Physics::set_solver_threads(unsigned num_threads)
+{
+    lock_guard<mutex> lk(simulation_mutex_);
+    dw_->set_num_threads(num_threads);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void Physics::synchronize(bool auto_start)
 {
-    // swap motion state transforms^
+    // take the latest transforms without waiting for the simulation thread
+    snapshots_.acquire();
+    TransformSnapshot const& snapshot(snapshots_.read_buffer());
+
+    // how far the rendered state has advanced from the step before towards the latest one
+    btScalar blend(1);
+    if(interpolation_ && snapshot.time > snapshot.previous_time)
     {
-        lock_guard<SpinLock> lk(motion_state_update_mutex_);
+        double const since_step(chrono::duration<double>(chrono::steady_clock::now() - snapshot.time).count());
+        double const step(chrono::duration<double>(snapshot.time - snapshot.previous_time).count());
+        blend = btScalar(std::min(std::max(since_step / step, 0.0), 1.0));
+    }
 
-        for(auto rb : rigid_bodies_)
+    {
+        lock_guard<mutex> lk(bodies_mutex_);
+        for(auto const& rb : rigid_bodies_)
         {
-            rb->motion_state_->flip_reader();
+            unsigned const slot(rb->snapshot_slot_);
+            if(slot < snapshot.body_ids.size() && snapshot.body_ids[slot] == rb->snapshot_id_)
+            {
+                rb->motion_state_->set_latest_transform(blend < 1 ? interpolate_transform(snapshot.previous_transforms[slot], snapshot.transforms[slot], blend) : snapshot.transforms[slot]);
+            }
         }
-    }
 
-    // traverse rigid body subgraphs in order to apply collision shapes
-    for(auto& rb : rigid_bodies_)
-    {
-        shape_visitor_.check(&*rb);
+        // traverse rigid body subgraphs in order to apply collision shapes
+        for(auto& rb : rigid_bodies_)
+        {
+            shape_visitor_.check(&*rb);
+        }
     }
 
     if(auto_start && is_stopped_.load())
@@ -211,12 +255,14 @@ void Physics::synchronize(bool auto_start)
 
 void Physics::add_rigid_body(std::shared_ptr<RigidBodyNode> const& body)
 {
-    if(body && std::find(rigid_bodies_.begin(), rigid_bodies_.end(), body) == rigid_bodies_.end())
+    // commands are posted in the order the bodies are registered
+    lock_guard<mutex> lk(bodies_mutex_);
+    if(register_rigid_body(body))
     {
-        lock_guard<mutex> lk(simulation_mutex_);
-        dw_->addRigidBody(body->body_);
-        rigid_bodies_.push_back(body);
-        body->ph_ = this;
+        post_command([this, body]() {
+            dw_->addRigidBody(body->body_);
+            add_simulated_body(body);
+        });
     }
 }
 
@@ -224,12 +270,15 @@ void Physics::add_rigid_body(std::shared_ptr<RigidBodyNode> const& body)
 
 void Physics::add_rigid_body(std::shared_ptr<RigidBodyNode> const& body, RigidBodyNode::CollisionFilterGroups const& group, RigidBodyNode::CollisionFilterGroups const& mask)
 {
-    if(body && std::find(rigid_bodies_.begin(), rigid_bodies_.end(), body) == rigid_bodies_.end())
+    lock_guard<mutex> lk(bodies_mutex_);
+    if(register_rigid_body(body))
     {
-        lock_guard<mutex> lk(simulation_mutex_);
-        dw_->addRigidBody(body->body_, static_cast<btBroadphaseProxy::CollisionFilterGroups>(group), static_cast<btBroadphaseProxy::CollisionFilterGroups>(mask));
-        rigid_bodies_.push_back(body);
-        body->ph_ = this;
+        auto const bullet_group(static_cast<btBroadphaseProxy::CollisionFilterGroups>(group));
+        auto const bullet_mask(static_cast<btBroadphaseProxy::CollisionFilterGroups>(mask));
+        post_command([this, body, bullet_group, bullet_mask]() {
+            dw_->addRigidBody(body->body_, bullet_group, bullet_mask);
+            add_simulated_body(body);
+        });
     }
 }
 
@@ -237,13 +286,21 @@ void Physics::add_rigid_body(std::shared_ptr<RigidBodyNode> const& body, RigidBo
 
 void Physics::remove_rigid_body(std::shared_ptr<RigidBodyNode> const& body)
 {
+    lock_guard<mutex> lk(bodies_mutex_);
     auto i = std::find(rigid_bodies_.begin(), rigid_bodies_.end(), body);
     if(i != rigid_bodies_.end())
     {
-        lock_guard<mutex> lk(simulation_mutex_);
-        dw_->removeRigidBody(body->body_);
-        (*i)->ph_ = nullptr;
+        // body may refer to the element which is erased
+        std::shared_ptr<RigidBodyNode> removed(*i);
         rigid_bodies_.erase(i);
+
+        free_snapshot_slots_.push_back(removed->snapshot_slot_);
+        removed->ph_ = nullptr;
+
+        post_command([this, removed]() {
+            dw_->removeRigidBody(removed->body_);
+            remove_simulated_body(*removed);
+        });
     }
 }
 
@@ -284,51 +341,23 @@ float Physics::get_physics_fps() const
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void Physics::call_once(std::function<void()> fun)
-{
-    lock_guard<mutex> lk(call_once_queue_mutex_);
-    call_once_queue_.push(fun);
-}
+void Physics::call_once(std::function<void()> fun) { call_once_queue_.push(std::move(fun)); }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 void Physics::simulate()
 {
-    auto current_time = chrono::high_resolution_clock::now();
-    auto last_time = chrono::high_resolution_clock::now();
+    last_step_time_ = chrono::steady_clock::now();
 
     while(!is_stopped_.load())
     {
-        current_time = chrono::high_resolution_clock::now();
-
-        // Process call-once queue
-        std::function<void()> fun;
-        while(pop_call_once(fun))
-            fun();
+        auto const step_start(simulate_step());
 
-        {
-            lock_guard<mutex> l(simulation_mutex_);
-            // Validate constraints before simulation
-            std::for_each(constraints_.begin(), constraints_.end(), std::mem_fn(&Constraint::validate));
-            // for (auto ct: constraints_) ct->validate();
-
-            const btScalar current_timestep = chrono::duration_cast<chrono::microseconds>(current_time - last_time).count() * 1.e-6f;
-
-            dw_->stepSimulation(current_timestep, physics_default_max_sub_steps, fixed_timestep_);
-            // Swap motion state transforms
-            {
-                lock_guard<SpinLock> lk(motion_state_update_mutex_);
-                for(auto rb : rigid_bodies_)
-                {
-                    rb->motion_state_->flip_writer();
-                }
-            }
-        }
         if(reduce_sim_rate_)
         {
-            auto sim_t = chrono::high_resolution_clock::now() - current_time;
-            if(sim_t < max_sim_time_)
-                this_thread::sleep_for(max_sim_time_ - sim_t);
+            auto const next_step(next_step_due(step_start));
+            if(next_step > chrono::steady_clock::now())
+                this_thread::sleep_until(next_step);
         }
 
         // Pause
@@ -336,30 +365,198 @@ void Physics::simulate()
             lock_guard<SpinLock> lk(pause_mutex_);
         }
 
-        // physics_fps_.store(1.e6f/(std::chrono::duration_cast<std::chrono::microseconds>(
-        //      std::chrono::high_resolution_clock::now()-current_time).count()));
-        physics_fps_ = 1.e6f / (chrono::duration_cast<chrono::microseconds>(chrono::high_resolution_clock::now() - current_time).count());
-
         DisplayData dd;
         dd.set_physics_fps(physics_fps_);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+chrono::steady_clock::time_point Physics::simulate_group_step()
+{
+    // a paused world is checked again one fixed timestep later instead of
+    // blocking the worker of the group
+    if(!pause_mutex_.try_lock())
+        return chrono::steady_clock::now() + chrono::microseconds(static_cast<std::int64_t>(fixed_timestep_ * 1.e6f));
+    pause_mutex_.unlock();
+
+    auto const due(next_step_due(simulate_step()));
+
+    DisplayData dd;
+    dd.set_physics_fps(physics_fps_);
+
+    return due;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+chrono::steady_clock::time_point Physics::simulate_step()
+{
+    auto const current_time = chrono::steady_clock::now();
+
+    // Process call-once queue
+    std::function<void()> fun;
+    while(call_once_queue_.pop(fun))
+        fun();
+
+    {
+        lock_guard<mutex> l(simulation_mutex_);
+        process_commands();
+
+        // Validate constraints before simulation
+        std::for_each(constraints_.begin(), constraints_.end(), std::mem_fn(&Constraint::validate));
+        // for (auto ct: constraints_) ct->validate();
+
+        const btScalar current_timestep = chrono::duration_cast<chrono::microseconds>(current_time - last_step_time_).count() * 1.e-6f;
+
+        num_steps_ += dw_->stepSimulation(current_timestep, physics_default_max_sub_steps, fixed_timestep_);
+        publish_snapshot(last_step_time_, current_time);
+    }
+
+    // rate of the steps, including the time in between
+    if(current_time > last_step_time_)
+        physics_fps_ = 1.f / chrono::duration<float>(current_time - last_step_time_).count();
+
+    last_step_time_ = current_time;
+    return current_time;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+chrono::steady_clock::time_point Physics::next_step_due(chrono::steady_clock::time_point step_start) const
+{
+    return reduce_sim_rate_ ? step_start + max_sim_time_ : step_start;
+}
 
-        last_time = current_time;
+////////////////////////////////////////////////////////////////////////////////
+
+void Physics::set_group(PhysicsWorldGroup* group)
+{
+    group_.store(group);
+
+    if(group)
+    {
+        last_step_time_ = chrono::steady_clock::now();
+    }
+    else
+    {
+        // commands posted while the group stepped the world
+        lock_guard<mutex> l(simulation_mutex_);
+        process_commands();
     }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-bool Physics::pop_call_once(std::function<void()>& value)
+void Physics::post_command(std::function<void()> command)
 {
-    lock_guard<mutex> lk(call_once_queue_mutex_);
-    if(call_once_queue_.empty())
+    commands_.push(std::move(command));
+
+    // only a world which is neither simulated nor in a group is executed by
+    // the caller, a stopped group runs the command with its next step
+    if(is_stopped_.load() && !group_.load())
+    {
+        lock_guard<mutex> l(simulation_mutex_);
+        process_commands();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Physics::process_commands()
+{
+    std::function<void()> command;
+    while(commands_.pop(command))
+        command();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool Physics::register_rigid_body(std::shared_ptr<RigidBodyNode> const& body)
+{
+    if(!body || std::find(rigid_bodies_.begin(), rigid_bodies_.end(), body) != rigid_bodies_.end())
         return false;
-    value = call_once_queue_.front();
-    call_once_queue_.pop();
+
+    if(free_snapshot_slots_.empty())
+    {
+        body->snapshot_slot_ = num_snapshot_slots_++;
+    }
+    else
+    {
+        body->snapshot_slot_ = free_snapshot_slots_.back();
+        free_snapshot_slots_.pop_back();
+    }
+
+    // a reused slot must not show the transforms of its previous body
+    if(++last_snapshot_id_ == 0)
+        ++last_snapshot_id_;
+    body->snapshot_id_ = last_snapshot_id_;
+
+    rigid_bodies_.push_back(body);
+    body->ph_ = this;
     return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void Physics::add_simulated_body(std::shared_ptr<RigidBodyNode> const& body)
+{
+    body->simulated_index_ = simulated_bodies_.size();
+    simulated_bodies_.push_back(body);
+
+    unsigned const slot(body->snapshot_slot_);
+    if(slot >= simulated_body_ids_.size())
+    {
+        simulated_body_ids_.resize(slot + 1, 0);
+        simulated_transforms_.resize(int(slot + 1));
+    }
+
+    // no step before this one, the body starts at its current transform
+    body->motion_state_->getWorldTransform(simulated_transforms_[int(slot)]);
+    simulated_body_ids_[slot] = body->snapshot_id_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Physics::remove_simulated_body(RigidBodyNode& body)
+{
+    std::size_t const index(body.simulated_index_);
+    if(index >= simulated_bodies_.size() || simulated_bodies_[index].get() != &body)
+        return;
+
+    if(simulated_body_ids_[body.snapshot_slot_] == body.snapshot_id_)
+        simulated_body_ids_[body.snapshot_slot_] = 0;
+
+    simulated_bodies_[index] = simulated_bodies_.back();
+    simulated_bodies_[index]->simulated_index_ = index;
+    simulated_bodies_.pop_back();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Physics::publish_snapshot(chrono::steady_clock::time_point previous_time, chrono::steady_clock::time_point time)
+{
+    TransformSnapshot& snapshot(snapshots_.write_buffer());
+    snapshot.previous_time = previous_time;
+    snapshot.time = time;
+
+    int const num_slots(int(simulated_body_ids_.size()));
+    snapshot.body_ids = simulated_body_ids_;
+    snapshot.previous_transforms.resize(num_slots);
+    snapshot.transforms.resize(num_slots);
+
+    for(auto const& body : simulated_bodies_)
+    {
+        int const slot(int(body->snapshot_slot_));
+        snapshot.previous_transforms[slot] = simulated_transforms_[slot];
+        body->motion_state_->getWorldTransform(snapshot.transforms[slot]);
+        simulated_transforms_[slot] = snapshot.transforms[slot];
+    }
+
+    snapshots_.publish();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // namespace physics
 } // namespace gua
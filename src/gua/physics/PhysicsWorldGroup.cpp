@@ -0,0 +1,199 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+// class header
+#include <gua/physics/PhysicsWorldGroup.hpp>
+
+// guacamole headers
+#include <gua/physics/Physics.hpp>
+
+// external headers
+#include <algorithm>
+
+namespace gua
+{
+namespace physics
+{
+////////////////////////////////////////////////////////////////////////////////
+
+PhysicsWorldGroup::PhysicsWorldGroup() : worlds_(), workers_(), mutex_(), world_available_(), running_(false) {}
+
+////////////////////////////////////////////////////////////////////////////////
+
+PhysicsWorldGroup::~PhysicsWorldGroup()
+{
+    stop();
+    while(!worlds_.empty())
+        remove_world(worlds_.front().physics);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool PhysicsWorldGroup::add_world(std::shared_ptr<Physics> const& world)
+{
+    if(!world || world->is_running())
+        return false;
+
+    world->set_group(this);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        World entry;
+        entry.physics = world;
+        entry.due = std::chrono::steady_clock::now();
+        entry.stepping = false;
+        worlds_.push_back(entry);
+    }
+    world_available_.notify_one();
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void PhysicsWorldGroup::remove_world(std::shared_ptr<Physics> const& world)
+{
+    // world may refer to the element which is erased
+    std::shared_ptr<Physics> removed(world);
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto is_world = [&removed](World const& entry) { return entry.physics == removed; };
+
+        auto i(std::find_if(worlds_.begin(), worlds_.end(), is_world));
+        if(i == worlds_.end())
+            return;
+
+        while(i->stepping)
+        {
+            world_available_.wait(lock);
+            i = std::find_if(worlds_.begin(), worlds_.end(), is_world);
+        }
+
+        worlds_.erase(i);
+    }
+
+    removed->set_group(nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void PhysicsWorldGroup::start(unsigned num_threads)
+{
+    if(num_threads == 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(running_)
+        return;
+
+    running_ = true;
+    for(unsigned i(0); i < num_threads; ++i)
+    {
+        workers_.emplace_back(&PhysicsWorldGroup::work, this);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void PhysicsWorldGroup::stop()
+{
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+        workers.swap(workers_);
+    }
+    world_available_.notify_all();
+
+    for(auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool PhysicsWorldGroup::is_running() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+unsigned PhysicsWorldGroup::get_num_threads() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return unsigned(workers_.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void PhysicsWorldGroup::work()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while(running_)
+    {
+        // the world which is due first and not stepped by another thread
+        auto next(worlds_.end());
+        for(auto i(worlds_.begin()); i != worlds_.end(); ++i)
+        {
+            if(!i->stepping && (next == worlds_.end() || i->due < next->due))
+                next = i;
+        }
+
+        if(next == worlds_.end())
+        {
+            world_available_.wait(lock);
+            continue;
+        }
+
+        if(next->due > std::chrono::steady_clock::now())
+        {
+            world_available_.wait_until(lock, next->due);
+            continue;
+        }
+
+        next->stepping = true;
+        std::shared_ptr<Physics> world(next->physics);
+        lock.unlock();
+
+        auto const due(world->simulate_group_step());
+
+        lock.lock();
+        for(auto& entry : worlds_)
+        {
+            if(entry.physics == world)
+            {
+                entry.due = due;
+                entry.stepping = false;
+            }
+        }
+        world_available_.notify_all();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace physics
+} // namespace gua
@@ -260,48 +260,42 @@ void RigidBodyNode::set_damping(float lin_damping, float ang_damping)
 
 void RigidBodyNode::apply_force(const math::vec3& force, const math::vec3& rel_pos)
 {
-    CONDITION_LOCK(ph_, ph_->lock());
-    body_->applyForce(math::vec3_to_btVector3(force), math::vec3_to_btVector3(rel_pos));
+    post_to_simulation([force, rel_pos](btRigidBody& body) { body.applyForce(math::vec3_to_btVector3(force), math::vec3_to_btVector3(rel_pos)); });
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 void RigidBodyNode::apply_central_force(const math::vec3& force)
 {
-    CONDITION_LOCK(ph_, ph_->lock());
-    body_->applyCentralForce(math::vec3_to_btVector3(force));
+    post_to_simulation([force](btRigidBody& body) { body.applyCentralForce(math::vec3_to_btVector3(force)); });
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 void RigidBodyNode::apply_torque(const math::vec3& torque)
 {
-    CONDITION_LOCK(ph_, ph_->lock());
-    body_->applyTorque(math::vec3_to_btVector3(torque));
+    post_to_simulation([torque](btRigidBody& body) { body.applyTorque(math::vec3_to_btVector3(torque)); });
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 void RigidBodyNode::apply_torque_impulse(const math::vec3& torque)
 {
-    CONDITION_LOCK(ph_, ph_->lock());
-    body_->applyTorqueImpulse(math::vec3_to_btVector3(torque));
+    post_to_simulation([torque](btRigidBody& body) { body.applyTorqueImpulse(math::vec3_to_btVector3(torque)); });
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 void RigidBodyNode::apply_impulse(const math::vec3& impulse, const math::vec3& rel_pos)
 {
-    CONDITION_LOCK(ph_, ph_->lock());
-    body_->applyImpulse(math::vec3_to_btVector3(impulse), math::vec3_to_btVector3(rel_pos));
+    post_to_simulation([impulse, rel_pos](btRigidBody& body) { body.applyImpulse(math::vec3_to_btVector3(impulse), math::vec3_to_btVector3(rel_pos)); });
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 void RigidBodyNode::apply_central_impulse(const math::vec3& impulse)
 {
-    CONDITION_LOCK(ph_, ph_->lock());
-    body_->applyCentralImpulse(math::vec3_to_btVector3(impulse));
+    post_to_simulation([impulse](btRigidBody& body) { body.applyCentralImpulse(math::vec3_to_btVector3(impulse)); });
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -338,6 +332,22 @@ math::vec3 RigidBodyNode::linear_velocity() const { return math::btVector3_to_ve
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void RigidBodyNode::post_to_simulation(std::function<void(btRigidBody&)> const& action)
+{
+    if(ph_)
+    {
+        // queued before a removal of the body, which keeps the node alive until then
+        btRigidBody* body(body_);
+        ph_->post_command([body, action]() { action(*body); });
+    }
+    else
+    {
+        action(*body_);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void RigidBodyNode::sync_shapes(bool do_not_lock)
 {
     has_static_shapes_ = false;
@@ -32,8 +32,6 @@
 // external headers
 #include <stdexcept>
 
-#include <HACD/hacdHACD.h>
-
 namespace gua
 {
 namespace physics
@@ -44,8 +42,6 @@ TriangleMeshShape::~TriangleMeshShape()
 {
     if(concave_shape_)
         delete concave_shape_;
-    if(concave_tri_mesh_)
-        delete concave_tri_mesh_;
     for(int i(0); i < convex_shapes_.size(); ++i)
     {
         delete convex_shapes_[i];
@@ -58,28 +54,24 @@ void TriangleMeshShape::build_from_geometry_static(const std::vector<std::string
 {
     if(concave_shape_)
         delete concave_shape_;
-    if(concave_tri_mesh_)
-        delete concave_tri_mesh_;
-
-    // TODO: Ideally, btBvhTriangleMeshShape construction should be done
-    //      using btStridingMeshInterface. Example from Ogre3D:
-    //      http://www.ogre3d.org/tikiwiki/BulletMeshStrider
-    concave_tri_mesh_ = new btTriangleMesh();
 
+    std::string name;
     for(auto const& geom_name : geometry_list)
-    {
-        std::shared_ptr<TriMeshRessource> m = std::dynamic_pointer_cast<TriMeshRessource>(gua::GeometryDatabase::instance()->lookup(geom_name));
-        if(m)
-            for(unsigned i(0); i < m->num_faces(); ++i)
-            {
-                auto face = m->get_face(i);
-                // no polygon triangulation
-                assert(face.size() == 3);
-                concave_tri_mesh_->addTriangle(math::vec3_to_btVector3(m->get_vertex(face[0])), math::vec3_to_btVector3(m->get_vertex(face[1])), math::vec3_to_btVector3(m->get_vertex(face[2])));
-            }
-    }
-    concave_shape_ = new btBvhTriangleMeshShape(concave_tri_mesh_, true);
-    concave_shape_->setLocalScaling(math::vec3_to_btVector3(scaling_));
+        name += geom_name + '\n';
+
+    static_mesh_ = CollisionMeshCache::instance()->get_static_mesh(name, [&](CollisionMeshCache::Mesh& mesh) {
+        VertexWelder welder;
+        for(auto const& geom_name : geometry_list)
+        {
+            std::shared_ptr<TriMeshRessource> m = std::dynamic_pointer_cast<TriMeshRessource>(gua::GeometryDatabase::instance()->lookup(geom_name));
+            if(m)
+                add_triangles(*m, welder, mesh.indices);
+        }
+        mesh.positions = welder.positions();
+    });
+
+    // the BVH is shared, the scaling of this shape is applied on top of it
+    concave_shape_ = new btScaledBvhTriangleMeshShape(static_mesh_->shape(), math::vec3_to_btVector3(scaling_));
     is_static_shape_ = true;
 }
 
@@ -91,8 +83,30 @@ void TriangleMeshShape::build_from_geometry_dynamic(const std::vector<std::strin
     {
         std::shared_ptr<TriMeshRessource> m = std::dynamic_pointer_cast<TriMeshRessource>(gua::GeometryDatabase::instance()->lookup(geom_name));
 
-        if(m)
-            decompose_to_convex(m /*, "HACD_"+geom_name+".wrl"*/);
+        if(!m)
+            continue;
+
+        auto decomposition = CollisionMeshCache::instance()->get_convex_decomposition(geom_name, hacd_parameters(), [&](CollisionMeshCache::Mesh& mesh) {
+            VertexWelder welder(m->num_vertices());
+            add_triangles(*m, welder, mesh.indices);
+            mesh.positions = welder.positions();
+        });
+
+        // create a convex hull
+        std::size_t first_point(0);
+        for(unsigned hull_size : decomposition->hull_sizes)
+        {
+            btConvexHullShape* shape = new btConvexHullShape();
+            for(std::size_t v(first_point); v < first_point + hull_size; ++v)
+                shape->addPoint(btVector3(decomposition->points[3 * v], decomposition->points[3 * v + 1], decomposition->points[3 * v + 2]));
+            first_point += hull_size;
+
+            // reduce collision margin. It may slow down the simulation.
+            // Normally, plane equation should be used instead this.
+            shape->setMargin(0.012f);
+            shape->setLocalScaling(math::vec3_to_btVector3(scaling_));
+            convex_shapes_.push_back(shape);
+        }
     }
 
     is_dynamic_shape_ = true;
@@ -191,83 +205,36 @@ void TriangleMeshShape::set_scaling(const math::vec3& scaling)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-/* static */ long TriangleMeshShape::get_point_or_add(std::vector<HACD::Vec3<double>>& points, const math::vec3& v)
+/* static */ void TriangleMeshShape::add_triangles(TriMeshRessource const& mesh, VertexWelder& welder, std::vector<int>& indices)
 {
-    HACD::Vec3<HACD::Real> vertex(v.x, v.y, v.z);
-    auto it = std::find_if(points.begin(), points.end(), [&vertex](const HACD::Vec3<HACD::Real>& n) -> bool { return n.X() == vertex.X() && n.Y() == vertex.Y() && n.Z() == vertex.Z(); });
+    indices.reserve(indices.size() + 3 * mesh.num_faces());
 
-    if(it != points.end())
-    {
-        return std::distance(points.begin(), it);
-    }
-    else
+    for(unsigned int i(0); i < mesh.num_faces(); ++i)
     {
-        points.push_back(vertex);
-        return points.size() - 1;
+        auto face = mesh.get_face(i);
+        // No polygon triangulation
+        assert(face.size() == 3);
+
+        for(unsigned int vertex : face)
+        {
+            math::vec3 const v(mesh.get_vertex(vertex));
+            indices.push_back(int(welder.add(v.x, v.y, v.z)));
+        }
     }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void TriangleMeshShape::decompose_to_convex(std::shared_ptr<TriMeshRessource> const& mesh, std::string const& file_name)
+CollisionMeshCache::HACDParameters TriangleMeshShape::hacd_parameters() const
 {
-    std::vector<HACD::Vec3<HACD::Real>> points;
-    std::vector<HACD::Vec3<long>> triangles;
-
-    // Fill vertex and triangle arrays with merging duplicate vertices
-    for(unsigned int i(0); i < mesh->num_faces(); ++i)
-    {
-        auto face = mesh->get_face(i);
-        // No polygon triangulation
-        assert(face.size() == 3);
-
-        HACD::Vec3<long> triangle(get_point_or_add(points, mesh->get_vertex(face[0])), get_point_or_add(points, mesh->get_vertex(face[1])), get_point_or_add(points, mesh->get_vertex(face[2])));
-        triangles.push_back(triangle);
-    }
-
-    HACD::HACD hacd;
-    hacd.SetPoints(points.data());
-    hacd.SetNPoints(points.size());
-    hacd.SetTriangles(triangles.data());
-    hacd.SetNTriangles(triangles.size());
-    hacd.SetCompacityWeight(0.1);
-    hacd.SetVolumeWeight(0.0);
-
-    hacd.SetNClusters(hacd_min_clusters);
-    hacd.SetNVerticesPerCH(hacd_max_ch_vertices);
-    hacd.SetConcavity(hacd_concavity);
-    hacd.SetAddExtraDistPoints(hacd_add_extra_dist_points);
-    hacd.SetAddNeighboursDistPoints(hacd_add_neighbours_dist_points);
-    hacd.SetAddFacesPoints(hacd_add_faces_points);
-
-    hacd.Compute();
-    size_t cluster_num = hacd.GetNClusters();
-
-    if(file_name.size())
-        hacd.Save(file_name.c_str(), false);
-    std::cout << "HACD: Decomposed in " << cluster_num << " convex hulls." << std::endl;
-
-    // create a convex hull
-    for(size_t c(0); c < cluster_num; ++c)
-    {
-        size_t points_num = hacd.GetNPointsCH(c);
-
-        HACD::Vec3<HACD::Real>* points_ch = new HACD::Vec3<HACD::Real>[points_num];
-        HACD::Vec3<long>* triangles_ch = new HACD::Vec3<long>[hacd.GetNTrianglesCH(c)];
-        hacd.GetCH(c, points_ch, triangles_ch);
-
-        btConvexHullShape* shape = new btConvexHullShape();
-        for(size_t v(0); v < points_num; ++v)
-            shape->addPoint(btVector3(points_ch[v].X(), points_ch[v].Y(), points_ch[v].Z()));
-        delete[] points_ch;
-        delete[] triangles_ch;
-
-        // reduce collision margin. It may slow down the simulation.
-        // Normally, plane equation should be used instead this.
-        shape->setMargin(0.012f);
-        shape->setLocalScaling(math::vec3_to_btVector3(scaling_));
-        convex_shapes_.push_back(shape);
-    }
+    CollisionMeshCache::HACDParameters parameters;
+    parameters.min_clusters = unsigned(hacd_min_clusters);
+    parameters.max_ch_vertices = unsigned(hacd_max_ch_vertices);
+    parameters.concavity = hacd_concavity;
+    parameters.add_extra_dist_points = hacd_add_extra_dist_points;
+    parameters.add_neighbours_dist_points = hacd_add_neighbours_dist_points;
+    parameters.add_faces_points = hacd_add_faces_points;
+    return parameters;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -46,6 +46,8 @@ void ABuffer::allocate(RenderContext& ctx, size_t buffer_size)
         resource->counter = ctx.render_device->create_buffer(scm::gl::BIND_ATOMIC_COUNTER_BUFFER, scm::gl::USAGE_DYNAMIC_COPY, sizeof(unsigned));
         resource->frag_list = ctx.render_device->create_buffer(scm::gl::BIND_STORAGE_BUFFER, scm::gl::USAGE_DYNAMIC_COPY, frag_count * FRAG_LIST_WORD_SIZE);
         resource->frag_data = ctx.render_device->create_buffer(scm::gl::BIND_STORAGE_BUFFER, scm::gl::USAGE_DYNAMIC_COPY, frag_count * FRAG_DATA_WORD_SIZE);
+
+        resource->memory_allocations.track(ctx.memory, GpuMemoryRegistry::id_of(resource.get()), GpuMemoryRegistry::Category::ABUFFER, sizeof(unsigned) + frag_count * (FRAG_LIST_WORD_SIZE + FRAG_DATA_WORD_SIZE), "ABuffer");
     }
     res_ = resource;
 }
@@ -78,6 +78,10 @@ GBuffer::GBuffer(RenderContext const& ctx, math::vec2ui const& resolution)
     fbo_write_only_color_ = ctx.render_device->create_frame_buffer();
     fbo_write_only_color_->attach_color_buffer(0, color_buffer_write_, 0, 0);
     fbo_write_only_color_->attach_depth_stencil_buffer(depth_buffer_, 0, 0);
+
+    // color (ping pong) + pbr: RGB_8, normal: RGB_16, flags: R_8UI, depth: D24_S8
+    std::size_t pixel_count(std::size_t(resolution.x) * resolution.y);
+    ctx.memory->track(GpuMemoryRegistry::id_of(this), GpuMemoryRegistry::Category::RENDER_TARGET, pixel_count * (3 * 3 + 6 + 1 + 4), "GBuffer");
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -177,6 +181,7 @@ void GBuffer::remove_buffers(RenderContext const& ctx)
         ctx.render_context->make_non_resident(depth_buffer_);
     }
 
+    ctx.memory->untrack(GpuMemoryRegistry::id_of(this));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,404 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+// class header
+#include <gua/renderer/GpuMemoryRegistry.hpp>
+
+// guacamole headers
+#include <gua/utils/Logger.hpp>
+
+// external headers
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+namespace gua
+{
+namespace
+{
+std::string escape_json(std::string const& in)
+{
+    std::string out;
+    out.reserve(in.size());
+    for(char c : in)
+    {
+        switch(c)
+        {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        default:
+            if(static_cast<unsigned char>(c) >= 0x20)
+            {
+                out += c;
+            }
+        }
+    }
+    return out;
+}
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+void GpuMemoryRegistry::track(std::size_t id, Category category, std::size_t bytes, std::string const& label, Evictor const& evictor)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it(entries_.find(id));
+    if(it != entries_.end())
+    {
+        // a different kind of allocation at the same address, its owner did not untrack it
+        if(it->second.category != category || it->second.label != label)
+        {
+            Logger::LOG_DEBUG << "GpuMemoryRegistry: \"" << label << "\" replaces the allocation \"" << it->second.label << "\" which was never untracked." << std::endl;
+        }
+        remove(it, false);
+    }
+
+    Entry entry;
+    entry.category = category;
+    entry.bytes = bytes;
+    entry.label = label;
+    entry.evictor = evictor;
+    entry.last_used = frame_;
+    entries_.emplace(id, std::move(entry));
+
+    auto& usage(usage_[static_cast<std::size_t>(category)]);
+    usage.bytes += bytes;
+    usage.high_water_mark = std::max(usage.high_water_mark, usage.bytes);
+    ++usage.allocations;
+
+    total_bytes_ += bytes;
+    high_water_mark_ = std::max(high_water_mark_, total_bytes_);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void GpuMemoryRegistry::untrack(std::size_t id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it(entries_.find(id));
+    if(it != entries_.end())
+    {
+        remove(it, false);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void GpuMemoryRegistry::touch(std::size_t id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it(entries_.find(id));
+    if(it != entries_.end())
+    {
+        it->second.last_used = frame_;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool GpuMemoryRegistry::is_tracked(std::size_t id) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.find(id) != entries_.end();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void GpuMemoryRegistry::begin_frame(unsigned frame)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    frame_ = frame;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::size_t GpuMemoryRegistry::evict_unused(unsigned max_idle_frames)
+{
+    return evict_if([&](Entry const& entry) { return frame_ - entry.last_used > max_idle_frames; }, std::numeric_limits<std::size_t>::max());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::size_t GpuMemoryRegistry::enforce_budget()
+{
+    std::size_t excess(0);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(budget_ == 0 || total_bytes_ <= budget_)
+        {
+            return 0;
+        }
+        excess = total_bytes_ - budget_;
+    }
+
+    return evict_if([](Entry const&) { return true; }, excess);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::size_t GpuMemoryRegistry::collect(unsigned frame)
+{
+    begin_frame(frame);
+
+    std::size_t freed(0);
+    unsigned max_idle_frames(get_max_idle_frames());
+
+    if(max_idle_frames > 0)
+    {
+        freed += evict_unused(max_idle_frames);
+    }
+
+    freed += enforce_budget();
+    return freed;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void GpuMemoryRegistry::set_budget(std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ = bytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::size_t GpuMemoryRegistry::get_budget() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return budget_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void GpuMemoryRegistry::set_max_idle_frames(unsigned frames)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_idle_frames_ = frames;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+unsigned GpuMemoryRegistry::get_max_idle_frames() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return max_idle_frames_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::size_t GpuMemoryRegistry::get_total_bytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_bytes_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::size_t GpuMemoryRegistry::get_high_water_mark() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return high_water_mark_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+GpuMemoryRegistry::Usage GpuMemoryRegistry::get_usage(Category category) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return usage_[static_cast<std::size_t>(category)];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::string GpuMemoryRegistry::to_json(bool include_allocations) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::stringstream json;
+    json << "{\"frame\": " << frame_ << ", \"budget\": " << budget_ << ", \"bytes\": " << total_bytes_ << ", \"high_water_mark\": " << high_water_mark_ << ", \"categories\": {";
+
+    for(std::size_t c(0); c < usage_.size(); ++c)
+    {
+        auto const& usage(usage_[c]);
+        json << (c > 0 ? ", " : "") << "\"" << category_name(static_cast<Category>(c)) << "\": {\"bytes\": " << usage.bytes << ", \"high_water_mark\": " << usage.high_water_mark
+             << ", \"allocations\": " << usage.allocations << ", \"evictions\": " << usage.evictions << "}";
+    }
+    json << "}";
+
+    if(include_allocations)
+    {
+        json << ", \"allocations\": [";
+        bool first(true);
+        for(auto const& entry : entries_)
+        {
+            json << (first ? "" : ", ") << "{\"id\": " << entry.first << ", \"category\": \"" << category_name(entry.second.category) << "\", \"label\": \"" << escape_json(entry.second.label)
+                 << "\", \"bytes\": " << entry.second.bytes << ", \"last_used\": " << entry.second.last_used << ", \"evictable\": " << (entry.second.evictor ? "true" : "false") << "}";
+            first = false;
+        }
+        json << "]";
+    }
+
+    json << "}";
+    return json.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::string const& GpuMemoryRegistry::category_name(Category category)
+{
+    static const std::array<std::string, static_cast<std::size_t>(Category::COUNT)> names{
+        {"mesh", "line_strip", "texture", "render_target", "shadow_map", "abuffer", "uniform_buffer", "plugin", "other"}};
+    static const std::string unknown("unknown");
+
+    auto index(static_cast<std::size_t>(category));
+    return index < names.size() ? names[index] : unknown;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void GpuMemoryRegistry::remove(std::unordered_map<std::size_t, Entry>::iterator const& it, bool evicted)
+{
+    auto& usage(usage_[static_cast<std::size_t>(it->second.category)]);
+    usage.bytes -= it->second.bytes;
+    if(evicted)
+    {
+        ++usage.evictions;
+    }
+
+    total_bytes_ -= it->second.bytes;
+    entries_.erase(it);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::size_t GpuMemoryRegistry::evict_if(std::function<bool(Entry const&)> const& predicate, std::size_t bytes_to_free)
+{
+    std::vector<Evictor> evictors;
+    std::size_t freed(0);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // least recently used first
+        std::vector<std::pair<unsigned, std::size_t>> candidates;
+        for(auto const& entry : entries_)
+        {
+            if(entry.second.evictor && entry.second.last_used != frame_ && predicate(entry.second))
+            {
+                candidates.emplace_back(entry.second.last_used, entry.first);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        for(auto const& candidate : candidates)
+        {
+            if(freed >= bytes_to_free)
+            {
+                break;
+            }
+
+            auto it(entries_.find(candidate.second));
+            freed += it->second.bytes;
+            evictors.push_back(std::move(it->second.evictor));
+            remove(it, true);
+        }
+    }
+
+    // the entries are gone already, so evictors may safely call untrack()
+    for(auto const& evictor : evictors)
+    {
+        evictor();
+    }
+
+    return freed;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void GpuMemoryAllocations::track(
+    std::shared_ptr<GpuMemoryRegistry> const& registry, std::size_t id, GpuMemoryRegistry::Category category, std::size_t bytes, std::string const& label, GpuMemoryRegistry::Evictor const& evictor)
+{
+    registry->track(id, category, bytes, label, evictor);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for(auto const& allocation : allocations_)
+    {
+        if(allocation.second == id && allocation.first.lock() == registry)
+        {
+            return;
+        }
+    }
+    allocations_.emplace_back(registry, id);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void GpuMemoryAllocations::untrack(std::shared_ptr<GpuMemoryRegistry> const& registry, std::size_t id)
+{
+    registry->untrack(id);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    allocations_.erase(std::remove_if(allocations_.begin(),
+                                      allocations_.end(),
+                                      [&](std::pair<std::weak_ptr<GpuMemoryRegistry>, std::size_t> const& allocation) {
+                                          // drops the allocations of destroyed registries as well
+                                          auto tracked(allocation.first.lock());
+                                          return !tracked || (allocation.second == id && tracked == registry);
+                                      }),
+                       allocations_.end());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void GpuMemoryAllocations::untrack_all()
+{
+    std::vector<std::pair<std::weak_ptr<GpuMemoryRegistry>, std::size_t>> allocations;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        allocations.swap(allocations_);
+    }
+
+    for(auto const& allocation : allocations)
+    {
+        if(auto registry = allocation.first.lock())
+        {
+            registry->untrack(allocation.second);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace gua
@@ -24,6 +24,7 @@
 
 // guacamole headers
 #include <gua/utils/TextFile.hpp>
+#include <gua/utils/BinaryCacheFile.hpp>
 #include <gua/utils/LineStripImporter.hpp>
 #include <gua/utils/Logger.hpp>
 #include <gua/utils/string_utils.hpp>
@@ -197,7 +198,19 @@ std::shared_ptr<node::Node> LineStripLoader::load(std::string const& file_name,
 
         if(!create_empty)
         {
-            importer->read_file(file_name);
+            // parsed files are cached in binary form next to the file, keyed by its content
+            uint64_t const source_key = flags & LineStripLoader::NO_BINARY_CACHE ? 0 : BinaryCacheFile::hash_file(file_name);
+            std::string const cache_file_name(file_name + ".gua_lines");
+
+            if(source_key == 0 || !importer->load_cache(cache_file_name, source_key))
+            {
+                importer->read_file(file_name);
+
+                if(source_key != 0 && importer->parsing_successful() && !importer->save_cache(cache_file_name, source_key))
+                {
+                    Logger::LOG_DEBUG << "Unable to write line strip cache " << cache_file_name << std::endl;
+                }
+            }
         }
         else
         {
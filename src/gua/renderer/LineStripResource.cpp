@@ -35,7 +35,7 @@ namespace gua
 {
 ////////////////////////////////////////////////////////////////////////////////
 
-LineStripResource::LineStripResource() : kd_tree_(), line_strip_(), clean_flags_per_context_() { compute_bounding_box(); }
+LineStripResource::LineStripResource() : kd_tree_(), line_strip_(), dirty_ranges_per_context_() { compute_bounding_box(); }
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -46,29 +46,31 @@ void LineStripResource::compute_bounding_box()
     // if (line_strip_.num_occupied_vertex_slots > 0) {
     bounding_box_ = math::BoundingBox<math::vec3>();
 
+    scm::math::vec3f min, max;
+
     if(0 == line_strip_.num_occupied_vertex_slots)
     {
         bounding_box_.expandBy(math::vec3{-0.5, -0.5, -0.5});
         bounding_box_.expandBy(math::vec3{0.5, 0.5, 0.5});
     }
-    if(1 == line_strip_.num_occupied_vertex_slots)
+    else if(1 == line_strip_.num_occupied_vertex_slots)
     {
-        bounding_box_.expandBy(math::vec3{line_strip_.positions[0] - 0.0001f});
-        bounding_box_.expandBy(math::vec3{line_strip_.positions[0] + 0.0001f});
+        scm::math::vec3f const& position(line_strip_.positions[line_strip_.vertex_slot(0)]);
+        bounding_box_.expandBy(math::vec3{position - 0.0001f});
+        bounding_box_.expandBy(math::vec3{position + 0.0001f});
     }
-    else
+    else if(line_strip_.compute_bounds(min, max))
     {
-        for(int v(0); v < line_strip_.num_occupied_vertex_slots; ++v)
-        {
-            bounding_box_.expandBy(math::vec3{line_strip_.positions[v]});
-        }
+        // only the blocks of vertices which changed since the last call are visited
+        bounding_box_.expandBy(math::vec3{min});
+        bounding_box_.expandBy(math::vec3{max});
     }
     //}
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-LineStripResource::LineStripResource(LineStrip const& line_strip, bool build_kd_tree) : kd_tree_(), line_strip_(line_strip), clean_flags_per_context_()
+LineStripResource::LineStripResource(LineStrip const& line_strip, bool build_kd_tree) : kd_tree_(), line_strip_(line_strip), dirty_ranges_per_context_()
 {
     compute_bounding_box();
 
@@ -84,54 +86,60 @@ void LineStripResource::upload_to(RenderContext& ctx) const
 {
     std::lock_guard<std::mutex> lock(line_strip_update_mutex_);
 
-    /*
-      if (line_strip_.vertex_reservoir_size == 0) {
-        Logger::LOG_WARNING << "Unable to load LineStrip! Has no vertex data." << std::endl;
-        return;
-      }
-    */
+    line_strip_.compute_consistent_normals();
+    make_clean_flags_dirty();
+
+    // value initialized on the first upload to this context
+    RenderContext::LineStrip& line_strip_to_update = ctx.line_strips[uuid()];
 
-    auto line_strip_iterator = ctx.line_strips.find(uuid());
+    line_strip_to_update.vertex_topology = scm::gl::PRIMITIVE_LINE_STRIP_ADJACENCY;
+    line_strip_to_update.vertex_reservoir_size = line_strip_.vertex_reservoir_size;
+    line_strip_to_update.num_occupied_vertex_slots = line_strip_.num_occupied_vertex_slots;
+    line_strip_to_update.first_buffer_slot = line_strip_.image_first();
 
-    bool update_cached_linestrip{false};
+    int const image_size(line_strip_.image_size());
+    auto pending_ranges(dirty_ranges_per_context_.find(ctx.id));
 
-    if((ctx.line_strips.end() == line_strip_iterator))
+    if(dirty_ranges_per_context_.end() == pending_ranges || line_strip_to_update.current_buffer_size_in_vertices < image_size)
     {
-        ctx.line_strips[uuid()] = RenderContext::LineStrip();
-    }
+        if(line_strip_to_update.current_buffer_size_in_vertices < image_size)
+        {
+            line_strip_to_update.vertices =
+                ctx.render_device->create_buffer(scm::gl::BIND_VERTEX_BUFFER, scm::gl::USAGE_DYNAMIC_DRAW, image_size * sizeof(LineStrip::Vertex), 0);
+            line_strip_to_update.vertex_array = ctx.render_device->create_vertex_array(line_strip_.get_vertex_format(), {line_strip_to_update.vertices});
 
-    RenderContext::LineStrip* line_strip_to_update_ptr = &ctx.line_strips[uuid()];
+            line_strip_to_update.current_buffer_size_in_vertices = image_size;
+        }
 
-    if(update_cached_linestrip)
-    {
-        line_strip_to_update_ptr = &(line_strip_iterator->second);
-    }
+        dirty_ranges_per_context_[ctx.id].clear();
 
-    line_strip_to_update_ptr->vertex_topology = scm::gl::PRIMITIVE_LINE_STRIP_ADJACENCY;
-    line_strip_to_update_ptr->vertex_reservoir_size = line_strip_.vertex_reservoir_size;
-    line_strip_to_update_ptr->num_occupied_vertex_slots = line_strip_.num_occupied_vertex_slots;
+        if(line_strip_.vertex_reservoir_size != 0)
+        {
+            LineStrip::Vertex* data(static_cast<LineStrip::Vertex*>(ctx.render_context->map_buffer(line_strip_to_update.vertices, scm::gl::ACCESS_WRITE_INVALIDATE_BUFFER)));
 
-    if(line_strip_to_update_ptr->current_buffer_size_in_vertices < line_strip_.vertex_reservoir_size + 3)
-    {
-        line_strip_to_update_ptr->vertices =
-            ctx.render_device->create_buffer(scm::gl::BIND_VERTEX_BUFFER, scm::gl::USAGE_DYNAMIC_DRAW, (line_strip_.vertex_reservoir_size + 3) * sizeof(LineStrip::Vertex), 0);
+            line_strip_.copy_to_buffer(data);
+            ctx.render_context->unmap_buffer(line_strip_to_update.vertices);
+        }
 
-        line_strip_to_update_ptr->current_buffer_size_in_vertices = line_strip_.vertex_reservoir_size + 3;
+        ctx.render_context->apply();
+        return;
     }
-    else
+
+    if(pending_ranges->second.empty())
     {
-        update_cached_linestrip = true;
+        return;
     }
 
-    if(line_strip_.vertex_reservoir_size != 0)
+    // only the vertices which changed since the last upload to this context
+    for(auto const& range : pending_ranges->second)
     {
-        LineStrip::Vertex* data(static_cast<LineStrip::Vertex*>(ctx.render_context->map_buffer(line_strip_to_update_ptr->vertices, scm::gl::ACCESS_WRITE_INVALIDATE_BUFFER)));
+        LineStrip::Vertex* data(static_cast<LineStrip::Vertex*>(ctx.render_context->map_buffer_range(
+            line_strip_to_update.vertices, range.begin * sizeof(LineStrip::Vertex), (range.end - range.begin) * sizeof(LineStrip::Vertex), scm::gl::ACCESS_WRITE_ONLY)));
 
-        line_strip_.copy_to_buffer(data);
-        ctx.render_context->unmap_buffer(line_strip_to_update_ptr->vertices);
-
-        line_strip_to_update_ptr->vertex_array = ctx.render_device->create_vertex_array(line_strip_.get_vertex_format(), {line_strip_to_update_ptr->vertices});
+        line_strip_.copy_to_buffer(data, range.begin, range.end);
+        ctx.render_context->unmap_buffer(line_strip_to_update.vertices);
     }
+    pending_ranges->second.clear();
 
     ctx.render_context->apply();
 }
@@ -147,22 +155,10 @@ void LineStripResource::draw(RenderContext& ctx) const
 
 void LineStripResource::draw(RenderContext& ctx, bool render_vertices_as_points, bool render_lines_as_strip) const
 {
+    // upload to GPU if neccessary
+    upload_to(ctx);
     auto iter = ctx.line_strips.find(uuid());
 
-    bool& clean_flag_for_context = clean_flags_per_context_[uuid()];
-
-    if(iter == ctx.line_strips.end() || (!clean_flag_for_context) /*|| ctx_dirty_flag*/)
-    {
-        // upload to GPU if neccessary
-
-        compute_consistent_normals();
-        upload_to(ctx);
-        iter = ctx.line_strips.find(uuid());
-
-        clean_flag_for_context = true;
-        // dirty_flags_per_context_[uuid()] = false;;
-    }
-
     ctx.render_context->bind_vertex_array(iter->second.vertex_array);
     // ctx.render_context->bind_index_buffer(iter->second.indices, iter->second.indices_topology, iter->second.indices_type);
     ctx.render_context->apply_vertex_input();
@@ -172,16 +168,16 @@ void LineStripResource::draw(RenderContext& ctx, bool render_vertices_as_points,
         // ctx.render_context->draw_arrays(scm::gl::PRIMITIVE_LINE_LOOP, 0, iter->second.num_occupied_vertex_slots+2);
         if(render_lines_as_strip)
         {
-            ctx.render_context->draw_arrays(iter->second.vertex_topology, 0, iter->second.num_occupied_vertex_slots + 3);
+            ctx.render_context->draw_arrays(iter->second.vertex_topology, iter->second.first_buffer_slot, iter->second.num_occupied_vertex_slots + 2);
         }
         else
         {
-            ctx.render_context->draw_arrays(scm::gl::PRIMITIVE_LINE_LIST, 1, iter->second.num_occupied_vertex_slots);
+            ctx.render_context->draw_arrays(scm::gl::PRIMITIVE_LINE_LIST, iter->second.first_buffer_slot + 1, iter->second.num_occupied_vertex_slots);
         }
     }
     else
     {
-        ctx.render_context->draw_arrays(scm::gl::PRIMITIVE_POINT_LIST, 1, iter->second.num_occupied_vertex_slots);
+        ctx.render_context->draw_arrays(scm::gl::PRIMITIVE_POINT_LIST, iter->second.first_buffer_slot + 1, iter->second.num_occupied_vertex_slots);
     }
 }
 
@@ -213,11 +209,21 @@ void LineStripResource::resolve_vertex_updates(RenderContext& ctx) {
 */
 ////////////////////////////////////////////////////////////////////////////////
 
-void LineStripResource::make_clean_flags_dirty()
+void LineStripResource::make_clean_flags_dirty() const
 {
-    for(auto& known_clean_flag : clean_flags_per_context_)
+    auto const dirty_ranges(line_strip_.take_dirty_ranges());
+    if(dirty_ranges.empty())
     {
-        known_clean_flag.second = false;
+        return;
+    }
+
+    increment_revision();
+
+    // contexts without pending ranges have never seen the strip and upload it completely
+    for(auto& pending_ranges : dirty_ranges_per_context_)
+    {
+        pending_ranges.second.insert(pending_ranges.second.end(), dirty_ranges.begin(), dirty_ranges.end());
+        LineStripRing::merge_ranges(pending_ranges.second);
     }
 }
 
@@ -256,7 +262,7 @@ void LineStripResource::push_vertex(LineStrip::Vertex const& in_vertex)
     {
         if(line_strip_.num_occupied_vertex_slots > 0)
         {
-            bounding_box_.expandBy(math::vec3{line_strip_.positions[line_strip_.num_occupied_vertex_slots - 1]});
+            bounding_box_.expandBy(math::vec3{line_strip_.positions[line_strip_.vertex_slot(line_strip_.num_occupied_vertex_slots - 1)]});
         }
         make_clean_flags_dirty();
     }
@@ -300,6 +306,18 @@ void LineStripResource::clear_vertices()
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void LineStripResource::set_ring_buffer_mode(bool enable)
+{
+    std::lock_guard<std::mutex> lock(line_strip_update_mutex_);
+    if(enable != line_strip_.get_ring_buffer_mode())
+    {
+        line_strip_.set_ring_buffer_mode(enable);
+        make_clean_flags_dirty();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void LineStripResource::forward_queued_vertices(std::vector<scm::math::vec3f> const& queued_positions,
                                                 std::vector<scm::math::vec4f> const& queued_colors,
                                                 std::vector<float> const& queued_thicknesses,
@@ -313,7 +331,11 @@ void LineStripResource::forward_queued_vertices(std::vector<scm::math::vec3f> co
 
 ////////////////////////////////////////////////////////////////////////////////
 
-math::vec3 LineStripResource::get_vertex(unsigned int i) const { return math::vec3(line_strip_.positions[i].x, line_strip_.positions[i].y, line_strip_.positions[i].z); }
+math::vec3 LineStripResource::get_vertex(unsigned int i) const
+{
+    scm::math::vec3f const& position(line_strip_.positions[line_strip_.vertex_slot(i)]);
+    return math::vec3(position.x, position.y, position.z);
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 
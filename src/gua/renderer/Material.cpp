@@ -22,6 +22,7 @@
 #include <gua/renderer/Material.hpp>
 
 #include <gua/databases/MaterialShaderDatabase.hpp>
+#include <gua/renderer/MaterialUniformStorage.hpp>
 #include <gua/renderer/ShaderProgram.hpp>
 
 namespace gua
@@ -41,7 +42,11 @@ Material::Material(std::string const& shader_name)
 ////////////////////////////////////////////////////////////////////////////////
 
 Material::Material(Material const& copy)
-    : shader_name_(copy.shader_name_), shader_cache_(copy.shader_cache_), uniforms_(copy.uniforms_), show_back_faces_(copy.show_back_faces_), render_wireframe_(copy.render_wireframe_)
+    : shader_name_(copy.shader_name_), shader_cache_(copy.shader_cache_), uniforms_(copy.uniforms_), show_back_faces_(copy.show_back_faces_), render_wireframe_(copy.render_wireframe_),
+#ifdef GUACAMOLE_ENABLE_VIRTUAL_TEXTURING
+      enable_virtual_texturing_(copy.enable_virtual_texturing_),
+#endif
+      view_dependent_(copy.view_dependent_)
 {
 }
 
@@ -74,6 +79,8 @@ void Material::set_shader_name(std::string const& name)
 
         uniforms_ = new_uniforms;
     }
+
+    ++uniform_generation_;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -111,13 +118,66 @@ std::map<std::string, ViewDependentUniform> const& Material::get_uniforms() cons
 ////////////////////////////////////////////////////////////////////////////////
 
 void Material::apply_uniforms(RenderContext const& ctx, ShaderProgram* shader, int view) const
+{
+    auto material_shader(get_shader());
+
+    if(!material_shader)
+    {
+        return;
+    }
+
+    if(!ctx.material_uniforms)
+    {
+        ctx.material_uniforms = std::make_shared<MaterialUniformStorage>();
+    }
+
+    // materials without per-view overrides share one block for all views
+    ctx.material_uniforms->bind(ctx, *this, *material_shader, view_dependent_ ? view : -1);
+
+#ifdef GUACAMOLE_ENABLE_VIRTUAL_TEXTURING
+    // as before the uniform block, every known texture sets the index
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        for(auto const& uniform : uniforms_)
+        {
+            auto tex_name(boost::get<std::string>(&uniform.second.get(view).data));
+            if(tex_name && *tex_name != "0" && TextureDatabase::instance()->lookup(*tex_name))
+            {
+                shader->get_program()->uniform("gua_current_vt_idx", 0, TextureDatabase::instance()->get_global_texture_id_by_path(*tex_name));
+            }
+        }
+    }
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool Material::write_uniform_block(RenderContext const& ctx, MaterialShader const& shader, int view, char* target) const
 {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    for(auto const& uniform : uniforms_)
+    bool resolved(true);
+    auto const& defaults(shader.get_default_uniforms());
+
+    for(auto const& entry : shader.get_uniform_block_layout())
     {
-        uniform.second.apply(ctx, uniform.first, view, shader->get_program());
+        auto uniform(uniforms_.find(entry.name));
+        auto const& value(uniform != uniforms_.end() ? uniform->second.get(view) : defaults.at(entry.name).get());
+
+        // a value of another type than declared by the shader would corrupt
+        // the neighbouring members, so the default is written instead
+        if(value.data.which() == defaults.at(entry.name).get().data.which())
+        {
+            resolved = value.write_std140(ctx, target + entry.offset) && resolved;
+        }
+        else
+        {
+            resolved = defaults.at(entry.name).get().write_std140(ctx, target + entry.offset) && resolved;
+        }
     }
+
+    return resolved;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -171,6 +231,8 @@ Material& Material::set_uniform<std::string>(std::string const& name, std::strin
         tmp.set(view_id, UniformValue(tex_name));
         uniforms_[name] = tmp;
     }
+    view_dependent_ = true;
+    ++uniform_generation_;
     return *this;
 }
 
@@ -32,6 +32,9 @@
 // external headers
 #include <assimp/scene.h>
 #include <fstream>
+#include <future>
+#include <sstream>
+#include <thread>
 #include <jsoncpp/json/json.h>
 
 // Windows includes
@@ -60,7 +63,67 @@ bool replace(std::string& str, const std::string& from, const std::string& to)
     return true;
 }
 
+MaterialLoader::MaterialLoader(bool share_materials) : share_materials_(share_materials) {}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<std::shared_ptr<Material>> MaterialLoader::load_materials(aiScene const* ai_scene, std::string const& assets_directory, bool optimize_material, bool nrp) const
+{
+    PathParser path;
+    path.parse(assets_directory);
+    std::string assets(path.get_path(true));
+
+    unsigned material_count(ai_scene->mNumMaterials);
+    std::vector<MaterialParameters> parameters(material_count);
+
+    // reading the assimp materials and checking texture paths is independent
+    // per material; only the creation of Materials and shaders is serial
+    unsigned thread_count(std::max(1u, std::min(std::thread::hardware_concurrency(), material_count)));
+    std::vector<std::future<void>> tasks;
+
+    for(unsigned t(0); t < thread_count; ++t)
+    {
+        tasks.push_back(std::async(std::launch::async, [&, t]() {
+            for(unsigned i(t); i < material_count; i += thread_count)
+            {
+                parameters[i] = extract_parameters(ai_scene->mMaterials[i], assets, optimize_material, nrp);
+            }
+        }));
+    }
+
+    for(auto& task : tasks)
+    {
+        task.get();
+    }
+
+    std::vector<std::shared_ptr<Material>> materials;
+    materials.reserve(material_count);
+
+    for(auto const& p : parameters)
+    {
+        materials.push_back(create_material(p));
+    }
+
+    Logger::LOG_MESSAGE << "MaterialLoader: " << report_.imported_materials << " materials imported, " << report_.unique_materials << " unique materials, " << report_.unique_shaders
+                        << " unique shaders." << std::endl;
+
+    return materials;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 std::shared_ptr<Material> MaterialLoader::load_material(aiMaterial const* ai_material, std::string const& assets_directory, bool optimize_material, bool nrp) const
+{
+    PathParser path;
+    path.parse(assets_directory);
+    std::string assets(path.get_path(true));
+
+    return create_material(extract_parameters(ai_material, assets, optimize_material, nrp));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+MaterialLoader::MaterialParameters MaterialLoader::extract_parameters(aiMaterial const* ai_material, std::string const& assets, bool optimize_material, bool nrp)
 {
     // helper lambdas ------------------------------------------------------------
     auto get_color = [&](const char* pKey, unsigned int type, unsigned int idx) -> std::string {
@@ -87,9 +150,7 @@ std::shared_ptr<Material> MaterialLoader::load_material(aiMaterial const* ai_mat
         return string_utils::to_string(value);
     };
 
-    PathParser path;
-    path.parse(assets_directory);
-    std::string assets(path.get_path(true));
+    MaterialParameters result;
 
     std::string uniform_color_map(get_sampler(AI_MATKEY_TEXTURE(aiTextureType_DIFFUSE, 0)));
     std::string uniform_color(get_color(AI_MATKEY_COLOR_DIFFUSE));
@@ -105,7 +166,7 @@ std::shared_ptr<Material> MaterialLoader::load_material(aiMaterial const* ai_mat
     std::string uniform_opacity_map(get_sampler(AI_MATKEY_TEXTURE(aiTextureType_OPACITY, 0)));
     std::string uniform_opacity(get_float(AI_MATKEY_OPACITY));
 
-    std::string material_name(get_string(AI_MATKEY_NAME));
+    result.material_name = get_string(AI_MATKEY_NAME);
 
     // obj bump and map_bump textures are imported as aiTextureType_HEIGHT
     std::string uniform_normal_map(get_sampler(AI_MATKEY_TEXTURE(aiTextureType_NORMALS, 0)));
@@ -214,22 +275,22 @@ std::shared_ptr<Material> MaterialLoader::load_material(aiMaterial const* ai_mat
     }
 #endif
 
+        // this may run on a worker thread -- warnings are logged on creation
         if(!ambient_map.empty())
         {
-            Logger::LOG_WARNING << "Material not fully supported: guacamole does not support ambient maps." << std::endl;
+            result.warnings.push_back("Material not fully supported: guacamole does not support ambient maps.");
         }
         else if(!ambient_color.empty())
         {
-            Logger::LOG_WARNING << "Material not fully supported: guacamole does not support ambient colors." << std::endl;
+            result.warnings.push_back("Material not fully supported: guacamole does not support ambient colors.");
         }
     }
 
-    auto new_mat(PBSMaterialFactory::create_material(static_cast<PBSMaterialFactory::Capabilities>(capabilities)));
+    result.capabilities = capabilities;
 
     if(!uniform_color_map.empty())
     {
-        new_mat->set_uniform("ColorMap", assets + uniform_color_map);
-        TextureDatabase::instance()->load(assets + uniform_color_map);
+        result.uniforms.emplace_back("ColorMap", UniformValue(assets + uniform_color_map));
     }
 
     if(!uniform_color.empty())
@@ -242,50 +303,120 @@ std::shared_ptr<Material> MaterialLoader::load_material(aiMaterial const* ai_mat
             opacity_to_set = std::max(0.0f, std::min(1.0f, string_utils::from_string<float>(uniform_opacity)));
         }
 
-        new_mat->set_uniform("Color", scm::math::vec4f(gua::math::float_t(c.x), gua::math::float_t(c.y), gua::math::float_t(c.z), opacity_to_set));
+        result.uniforms.emplace_back("Color", UniformValue(scm::math::vec4f(gua::math::float_t(c.x), gua::math::float_t(c.y), gua::math::float_t(c.z), opacity_to_set)));
     }
 
 #if 1
     if(!uniform_roughness_map.empty())
     {
-        new_mat->set_uniform("RoughnessMap", assets + uniform_roughness_map);
+        result.uniforms.emplace_back("RoughnessMap", UniformValue(assets + uniform_roughness_map));
     }
     else if(!uniform_roughness.empty() && uniform_roughness != "0")
     {
         // specular exponent is taken to the power of 0.02 in order to move it to the desired range
-        new_mat->set_uniform("Roughness", float(std::min(1.f, std::pow(string_utils::from_string<float>(uniform_roughness), 0.02f) - 1.f)));
+        result.uniforms.emplace_back("Roughness", UniformValue(float(std::min(1.f, std::pow(string_utils::from_string<float>(uniform_roughness), 0.02f) - 1.f))));
     }
 #endif
 
 #if 1
     if(!uniform_metalness_map.empty())
     {
-        new_mat->set_uniform("MetalnessMap", assets + uniform_metalness_map);
+        result.uniforms.emplace_back("MetalnessMap", UniformValue(assets + uniform_metalness_map));
     }
     else if(!uniform_metalness.empty())
     {
         // multiplying with 0.5, since metalness of 1.0 is seldomly wanted but specularity of 1.0 often given
-        new_mat->set_uniform("Metalness", scm::math::vec3f(string_utils::from_string<math::vec3>(uniform_metalness)[0] * 0.5f));
+        result.uniforms.emplace_back("Metalness", UniformValue(scm::math::vec3f(string_utils::from_string<math::vec3>(uniform_metalness)[0] * 0.5f)));
     }
 #endif
 
     if(!uniform_emit_map.empty())
     {
-        new_mat->set_uniform("EmissivityMap", assets + uniform_emit_map);
+        result.uniforms.emplace_back("EmissivityMap", UniformValue(assets + uniform_emit_map));
     }
     else if(!uniform_emit.empty())
     {
-        new_mat->set_uniform("Emissivity", string_utils::from_string<scm::math::vec3f>(uniform_emit)[0]);
+        result.uniforms.emplace_back("Emissivity", UniformValue(string_utils::from_string<scm::math::vec3f>(uniform_emit)[0]));
     }
 
     if(!uniform_normal_map.empty())
     {
-        new_mat->set_uniform("NormalMap", assets + uniform_normal_map);
+        result.uniforms.emplace_back("NormalMap", UniformValue(assets + uniform_normal_map));
     }
 
-    new_mat->rename_existing_shader(material_name);
+    // the key identifies materials which would end up with identical uniforms
+    std::stringstream key;
+    key << capabilities << ";";
+    for(auto const& uniform : result.uniforms)
+    {
+        key << uniform.first << "#" << uniform.second << ";";
 
-    return new_mat;
+        if(auto texture = boost::get<std::string>(&uniform.second.data))
+        {
+            result.textures.push_back(*texture);
+        }
+    }
+    result.key = key.str();
+
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<Material> MaterialLoader::create_material(MaterialParameters const& parameters) const
+{
+    for(auto const& warning : parameters.warnings)
+    {
+        Logger::LOG_WARNING << warning << std::endl;
+    }
+
+    if(share_materials_)
+    {
+        auto cached(material_cache_.find(parameters.key));
+        if(cached != material_cache_.end())
+        {
+            ++report_.imported_materials;
+            return cached->second;
+        }
+    }
+
+    auto new_mat(PBSMaterialFactory::create_material(static_cast<PBSMaterialFactory::Capabilities>(parameters.capabilities)));
+
+    for(auto const& uniform : parameters.uniforms)
+    {
+        new_mat->set_uniform(uniform.first, uniform.second);
+    }
+
+    // texture loading is asynchronous, so all requests are issued up front
+    for(auto const& texture : parameters.textures)
+    {
+        TextureDatabase::instance()->load(texture);
+    }
+
+    if(!share_materials_)
+    {
+        new_mat->rename_existing_shader(parameters.material_name);
+    }
+
+    return register_material(parameters.key, new_mat);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<Material> MaterialLoader::register_material(std::string const& key, std::shared_ptr<Material> const& material) const
+{
+    ++report_.imported_materials;
+    ++report_.unique_materials;
+
+    shader_names_.insert(material->get_shader_name());
+    report_.unique_shaders = shader_names_.size();
+
+    if(share_materials_)
+    {
+        material_cache_[key] = material;
+    }
+
+    return material;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -300,14 +431,26 @@ std::shared_ptr<Material> MaterialLoader::load_material(FbxSurfaceMaterial const
     std::string mat_name = assets + fbx_material.GetName() + ".COPY";
     if(file_exists(mat_name))
     {
-        return load_unreal(mat_name, assets_directory);
+        auto cached(material_cache_.find(mat_name));
+        if(share_materials_ && cached != material_cache_.end())
+        {
+            ++report_.imported_materials;
+            return cached->second;
+        }
+        return register_material(mat_name, load_unreal(mat_name, assets_directory));
     }
 
     // see if there is a json material file avaible
     mat_name = assets + fbx_material.GetName() + ".json";
     if(file_exists(mat_name))
     {
-        return load_material(mat_name, assets_directory);
+        auto cached(material_cache_.find(mat_name));
+        if(share_materials_ && cached != material_cache_.end())
+        {
+            ++report_.imported_materials;
+            return cached->second;
+        }
+        return register_material(mat_name, load_material(mat_name, assets_directory));
     }
 
     // method to check if texture is set for an attribute
@@ -404,33 +547,60 @@ std::shared_ptr<Material> MaterialLoader::load_material(FbxSurfaceMaterial const
         // }
     }
 
-    auto new_mat(PBSMaterialFactory::create_material(static_cast<PBSMaterialFactory::Capabilities>(capabilities)));
+    MaterialParameters parameters;
+    parameters.capabilities = capabilities;
+    parameters.material_name = fbx_material.GetName();
 
     if(capabilities & PBSMaterialFactory::COLOR_MAP || capabilities & PBSMaterialFactory::COLOR_VALUE_AND_MAP)
     {
-        new_mat->set_uniform("ColorMap", assets + uniform_color_map);
-        TextureDatabase::instance()->load(assets + uniform_color_map);
+        parameters.uniforms.emplace_back("ColorMap", UniformValue(assets + uniform_color_map));
+        parameters.textures.push_back(assets + uniform_color_map);
     }
     // fbx shader always contains a color value
     FbxDouble3 color = lambert->Diffuse.Get();
-    new_mat->set_uniform("Color", math::vec4f(color[0], color[1], color[2], 1.f));
+    parameters.uniforms.emplace_back("Color", UniformValue(math::vec4f(color[0], color[1], color[2], 1.f)));
 
     if(capabilities & PBSMaterialFactory::NORMAL_MAP)
     {
-        new_mat->set_uniform("NormalMap", assets + uniform_normal_map);
+        parameters.uniforms.emplace_back("NormalMap", UniformValue(assets + uniform_normal_map));
+        parameters.textures.push_back(assets + uniform_normal_map);
     }
 
     if(capabilities & PBSMaterialFactory::EMISSIVITY_MAP)
     {
-        new_mat->set_uniform("EmissivityMap", assets + uniform_emit_map);
+        parameters.uniforms.emplace_back("EmissivityMap", UniformValue(assets + uniform_emit_map));
+        parameters.textures.push_back(assets + uniform_emit_map);
     }
     else
     {
         FbxDouble3 emit = lambert->Emissive.Get();
-        new_mat->set_uniform("Emissivity", float((emit[0] + emit[1] + emit[2]) / 3.0f));
+        parameters.uniforms.emplace_back("Emissivity", UniformValue(float((emit[0] + emit[1] + emit[2]) / 3.0f)));
     }
 
-    return new_mat;
+    std::stringstream key;
+    key << capabilities << ";";
+    for(auto const& uniform : parameters.uniforms)
+    {
+        key << uniform.first << "#" << uniform.second << ";";
+    }
+    parameters.key = key.str();
+
+    // fbx materials never had their shader renamed
+    if(!share_materials_)
+    {
+        auto new_mat(PBSMaterialFactory::create_material(static_cast<PBSMaterialFactory::Capabilities>(capabilities)));
+        for(auto const& uniform : parameters.uniforms)
+        {
+            new_mat->set_uniform(uniform.first, uniform.second);
+        }
+        for(auto const& texture : parameters.textures)
+        {
+            TextureDatabase::instance()->load(texture);
+        }
+        return register_material(parameters.key, new_mat);
+    }
+
+    return create_material(parameters);
 }
 
 std::shared_ptr<Material> MaterialLoader::load_unreal(std::string const& file_name, std::string const& assets_directory, bool optimize_material, bool nrp) const
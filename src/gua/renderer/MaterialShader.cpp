@@ -28,7 +28,7 @@
 namespace gua
 {
 ////////////////////////////////////////////////////////////////////////////////
-MaterialShader::MaterialShader(std::string const& name, std::shared_ptr<MaterialShaderDescription> const& desc) : desc_(desc), name_(name)
+MaterialShader::MaterialShader(std::string const& name, std::shared_ptr<MaterialShaderDescription> const& desc) : desc_(desc), uniform_block_size_(0), name_(name)
 {
     auto v_methods = desc_->get_vertex_methods();
     auto f_methods = desc_->get_fragment_methods();
@@ -48,6 +48,19 @@ MaterialShader::MaterialShader(std::string const& name, std::shared_ptr<Material
             default_uniforms_[uniform.first] = ViewDependentUniform(uniform.second);
         }
     }
+
+    // std140: every member is aligned to its base alignment, the whole block
+    // is padded to a multiple of a vec4
+    unsigned offset(0);
+    for(auto const& uniform : default_uniforms_)
+    {
+        auto const& value(uniform.second.get());
+        unsigned alignment(value.get_std140_alignment());
+        offset = (offset + alignment - 1) / alignment * alignment;
+        uniform_block_layout_.push_back({uniform.first, offset});
+        offset += value.get_std140_size();
+    }
+    uniform_block_size_ = (offset + 15) / 16 * 16;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -62,6 +75,12 @@ std::shared_ptr<Material> MaterialShader::make_new_material() const { return std
 ////////////////////////////////////////////////////////////////////////////////
 std::map<std::string, ViewDependentUniform> const& MaterialShader::get_default_uniforms() const { return default_uniforms_; }
 
+////////////////////////////////////////////////////////////////////////////////
+std::vector<MaterialShader::UniformBlockEntry> const& MaterialShader::get_uniform_block_layout() const { return uniform_block_layout_; }
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned MaterialShader::get_uniform_block_size() const { return uniform_block_size_; }
+
 ////////////////////////////////////////////////////////////////////////////////
 std::list<std::shared_ptr<MaterialShaderMethod>> const& MaterialShader::get_vertex_methods() const { return desc_->get_vertex_methods(); }
 
@@ -76,10 +95,17 @@ SubstitutionMap MaterialShader::generate_substitution_map() const
     const auto& v_methods = get_vertex_methods();
     const auto& f_methods = get_fragment_methods();
 
-    // uniform substitutions
-    for(auto const& uniform : default_uniforms_)
+    // uniform substitutions -- all material uniforms live in one std140 block
+    // which is bound per draw as a range of the context's material buffer.
+    // The members are declared in the same order as uniform_block_layout_.
+    if(!default_uniforms_.empty())
     {
-        sstr << "uniform " << uniform.second.get().get_glsl_type() << " " << uniform.first << ";" << std::endl;
+        sstr << "layout (std140, binding=" << GUA_MATERIAL_BLOCK_BINDING << ") uniform gua_material_block {" << std::endl;
+        for(auto const& uniform : default_uniforms_)
+        {
+            sstr << "  " << uniform.second.get().get_glsl_type() << " " << uniform.first << ";" << std::endl;
+        }
+        sstr << "};" << std::endl;
     }
     sstr << std::endl;
     smap["material_uniforms"] = sstr.str();
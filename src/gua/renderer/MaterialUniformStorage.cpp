@@ -0,0 +1,206 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+// class header
+#include <gua/renderer/MaterialUniformStorage.hpp>
+
+#include <gua/renderer/Material.hpp>
+#include <gua/renderer/MaterialShader.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace gua
+{
+const unsigned MaterialUniformStorage::SLOT_UNIT_SIZE;
+const unsigned MaterialUniformStorage::INITIAL_UNIT_COUNT;
+const unsigned MaterialUniformStorage::MAX_RESOLVE_INTERVAL;
+
+////////////////////////////////////////////////////////////////////////////////
+
+unsigned MaterialUniformStorage::bind(RenderContext const& ctx, Material const& material, MaterialShader const& shader, int view)
+{
+    unsigned block_size(shader.get_uniform_block_size());
+
+    if(block_size == 0)
+    {
+        return 0;
+    }
+
+    unsigned unit_count((block_size + SLOT_UNIT_SIZE - 1) / SLOT_UNIT_SIZE);
+
+    auto key(std::make_pair(material.uuid(), view));
+    auto slot_it(slots_.find(key));
+
+    if(slot_it == slots_.end())
+    {
+        slot_it = slots_.emplace(key, Slot()).first;
+        slot_it->second.owner = material.lifetime_token();
+    }
+
+    auto& slot(slot_it->second);
+
+    // the material switched to a shader with a differently sized block
+    if(slot.unit_count != unit_count)
+    {
+        if(slot.unit_count != 0)
+        {
+            release(slot);
+        }
+        slot.first_unit = allocate(ctx, unit_count);
+        slot.unit_count = unit_count;
+        slot.up_to_date = false;
+        slot.resolve_frame = ctx.framecount;
+    }
+
+    unsigned generation(material.get_uniform_generation());
+
+    // framecount >= resolve_frame, robust against wrap-around
+    bool const retry_resolve(!slot.up_to_date && ctx.framecount - slot.resolve_frame < 0x80000000u);
+
+    if(retry_resolve || slot.generation != generation)
+    {
+        auto target(&cpu_block_[slot.first_unit * SLOT_UNIT_SIZE]);
+        std::memset(target, 0, slot.unit_count * SLOT_UNIT_SIZE);
+
+        // unresolved textures are written as null handles and looked up
+        // again after a growing number of frames, not on every draw
+        slot.up_to_date = material.write_uniform_block(ctx, shader, view, target);
+        slot.generation = generation;
+
+        if(slot.up_to_date)
+        {
+            slot.resolve_interval = 0;
+        }
+        else
+        {
+            slot.resolve_interval = std::min(MAX_RESOLVE_INTERVAL, std::max(1u, slot.resolve_interval * 2));
+            slot.resolve_frame = ctx.framecount + slot.resolve_interval;
+        }
+
+        upload(ctx, slot);
+    }
+
+    ctx.render_context->bind_uniform_buffer(buffer_, GUA_MATERIAL_BLOCK_BINDING, slot.first_unit * SLOT_UNIT_SIZE, slot.unit_count * SLOT_UNIT_SIZE);
+
+    return slot.first_unit;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+unsigned MaterialUniformStorage::allocate(RenderContext const& ctx, unsigned unit_count)
+{
+    auto take_free_range = [this](unsigned count, unsigned& first) {
+        auto free_it(free_units_.find(count));
+        if(free_it == free_units_.end() || free_it->second.empty())
+        {
+            return false;
+        }
+        first = free_it->second.back();
+        free_it->second.pop_back();
+        return true;
+    };
+
+    unsigned first(0);
+
+    if(take_free_range(unit_count, first))
+    {
+        return first;
+    }
+
+    unsigned capacity(cpu_block_.size() / SLOT_UNIT_SIZE);
+
+    if(used_units_ + unit_count > capacity)
+    {
+        // try to reuse the slots of destroyed materials before growing
+        collect_expired_slots();
+
+        if(take_free_range(unit_count, first))
+        {
+            return first;
+        }
+
+        grow(ctx, used_units_ + unit_count);
+    }
+
+    first = used_units_;
+    used_units_ += unit_count;
+    return first;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MaterialUniformStorage::release(Slot const& slot) { free_units_[slot.unit_count].push_back(slot.first_unit); }
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MaterialUniformStorage::collect_expired_slots()
+{
+    for(auto it(slots_.begin()); it != slots_.end();)
+    {
+        if(it->second.owner.expired())
+        {
+            release(it->second);
+            it = slots_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MaterialUniformStorage::grow(RenderContext const& ctx, unsigned min_unit_count)
+{
+    unsigned unit_count(std::max(INITIAL_UNIT_COUNT, static_cast<unsigned>(cpu_block_.size() / SLOT_UNIT_SIZE)));
+
+    while(unit_count < min_unit_count)
+    {
+        unit_count *= 2;
+    }
+
+    cpu_block_.resize(unit_count * SLOT_UNIT_SIZE, 0);
+
+    // the cpu copy is complete, so the new buffer is initialized from it
+    buffer_ = ctx.render_device->create_buffer(scm::gl::BIND_UNIFORM_BUFFER, scm::gl::USAGE_DYNAMIC_DRAW, cpu_block_.size(), &cpu_block_[0]);
+    memory_allocations_.track(ctx.memory, GpuMemoryRegistry::id_of(this), GpuMemoryRegistry::Category::UNIFORM_BUFFER, cpu_block_.size(), "MaterialUniformStorage");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MaterialUniformStorage::upload(RenderContext const& ctx, Slot const& slot)
+{
+    std::size_t offset(slot.first_unit * SLOT_UNIT_SIZE);
+    std::size_t size(slot.unit_count * SLOT_UNIT_SIZE);
+
+    auto mapped(reinterpret_cast<char*>(ctx.render_context->map_buffer_range(buffer_, offset, size, scm::gl::ACCESS_WRITE_ONLY)));
+    if(mapped)
+    {
+        std::memcpy(mapped, &cpu_block_[offset], size);
+    }
+    ctx.render_context->unmap_buffer(buffer_);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace gua
@@ -39,6 +39,8 @@
 #include <gua/renderer/LightTable.hpp>
 
 // external headers
+#include <boost/functional/hash.hpp>
+#include <bitset>
 #include <iostream>
 
 namespace
@@ -317,6 +319,16 @@ void Pipeline::generate_shadow_map(node::LightNode& light, LightTable::LightBloc
         shadow_map_res_ = context_.resources.get<SharedShadowMapResource>();
     }
 
+    // spot lights share the shadow atlas if enabled; fall back to a separate
+    // shadow map if the atlas is full
+    if(light.data.get_type() == node::LightNode::Type::SPOT && last_description_.get_shadow_atlas_size() > 0)
+    {
+        if(generate_shadow_map_atlas(light, light_block))
+        {
+            return;
+        }
+    }
+
     auto& current_mask(current_viewstate_.camera.config.mask());
 
     std::shared_ptr<ShadowMap> shadow_map(nullptr);
@@ -421,19 +433,7 @@ void Pipeline::generate_shadow_map(node::LightNode& light, LightTable::LightBloc
     }
 
     // restore previous configuration
-    current_viewstate_.target = gbuffer_.get();
-    current_viewstate_.scene = orig_scene;
-    current_viewstate_.frustum = current_viewstate_.scene->rendering_frustum;
-    current_viewstate_.camera.config.set_resolution(original_camera_resolution);
-
-    camera_block_.update(context_,
-                         current_viewstate_.scene->rendering_frustum,
-                         math::get_translation(current_viewstate_.camera.transform),
-                         current_viewstate_.scene->clipping_planes,
-                         current_viewstate_.camera.config.get_view_id(),
-                         current_viewstate_.camera.config.get_resolution());
-
-    bind_camera_uniform_block(0);
+    restore_camera_view(orig_scene, original_camera_resolution);
 
     light_block.shadow_offset = light.data.get_shadow_offset();
     light_block.shadow_map = ::get_handle(shadow_map->get_depth_buffer());
@@ -622,6 +622,158 @@ void Pipeline::generate_shadow_map_spotlight(node::LightNode& light, LightTable:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+bool Pipeline::generate_shadow_map_atlas(node::LightNode& light, LightTable::LightBlock& light_block)
+{
+    auto& atlas(shadow_map_res_->atlas);
+    unsigned atlas_size(last_description_.get_shadow_atlas_size());
+
+    if(!atlas || atlas->get_width() < atlas_size || atlas->get_width() >= 2 * atlas_size)
+    {
+        if(atlas)
+        {
+            atlas->remove_buffers(context_);
+        }
+        atlas = std::make_shared<ShadowAtlas>(context_, atlas_size);
+    }
+
+    auto const& light_transform(light.get_cached_world_transform());
+    math::vec3 light_position(math::get_translation(light_transform));
+    math::vec3 beam_direction(math::vec3(light_transform * math::vec4(0.0, 0.0, -1.0, 1.0)) - light_position);
+
+    // the tile size follows the screen coverage of the light cone, the
+    // light's shadow map size is the upper limit
+    unsigned tile_size(light.data.shadow_map_size());
+    double radius(scm::math::length(beam_direction));
+    double distance(scm::math::length(light_position + 0.5 * beam_direction - math::get_translation(current_viewstate_.camera.transform)));
+
+    if(distance > radius)
+    {
+        double projected_size(radius / distance * current_viewstate_.frustum.get_projection()[5] * current_viewstate_.camera.config.get_resolution().y);
+        tile_size = std::min(tile_size, static_cast<unsigned>(std::max(projected_size, double(atlas->get_min_tile_size()))));
+    }
+
+    // same frustum as in generate_shadow_map_spotlight()
+    math::mat4 screen_transform(scm::math::make_translation(0., 0., -1.));
+    screen_transform = light_transform * screen_transform;
+
+    auto frustum(Frustum::perspective(light_transform, screen_transform, light.data.get_shadow_near_clipping_in_sun_direction(), light.data.get_shadow_far_clipping_in_sun_direction()));
+
+    auto shadow_scene(current_viewstate_.graph->serialize(frustum,
+                                                          frustum,
+                                                          math::get_translation(current_viewstate_.camera.transform),
+                                                          current_viewstate_.camera.config.enable_frustum_culling(),
+                                                          current_viewstate_.camera.config.mask(),
+                                                          current_viewstate_.camera.config.view_id()));
+
+    // the shadow map only has to be redrawn if the light or one of the
+    // casters in its frustum moved or changed its geometry, or if casters
+    // were added or removed
+    std::size_t content_hash(0);
+    for(unsigned i(0); i < 16; ++i)
+    {
+        boost::hash_combine(content_hash, light_transform[i]);
+    }
+    boost::hash_combine(content_hash, light.data.get_shadow_near_clipping_in_sun_direction());
+    boost::hash_combine(content_hash, light.data.get_shadow_far_clipping_in_sun_direction());
+
+    std::size_t casters_hash(0);
+    for(auto const& type : shadow_scene->nodes)
+    {
+        for(auto const* node : type.second)
+        {
+            std::size_t node_hash(node->uuid());
+            boost::hash_combine(node_hash, node->get_geometry_revision());
+            auto const& node_transform(node->get_cached_world_transform());
+            for(unsigned i(0); i < 16; ++i)
+            {
+                boost::hash_combine(node_hash, node_transform[i]);
+            }
+            // order independent, the serialization order may change
+            casters_hash += node_hash;
+        }
+    }
+    boost::hash_combine(content_hash, casters_hash);
+
+    // the atlas is shared by all pipelines of the context, the casters
+    // depend on the mask and view of the camera
+    std::size_t tile_key(light.uuid());
+    boost::hash_combine(tile_key, this);
+    auto const& mask(current_viewstate_.camera.config.mask());
+    boost::hash_combine(tile_key, std::hash<std::bitset<GUA_MAX_TAG_COUNT>>()(mask.whitelist.get_bits()));
+    boost::hash_combine(tile_key, std::hash<std::bitset<GUA_MAX_TAG_COUNT>>()(mask.blacklist.get_bits()));
+    boost::hash_combine(tile_key, current_viewstate_.camera.config.view_id());
+
+    ShadowAtlas::Tile tile;
+    bool needs_redraw(false);
+
+    if(!atlas->acquire(tile_key, tile_size, content_hash, context_.framecount, tile, needs_redraw))
+    {
+        return false;
+    }
+
+    light_block.cascade_count = 1;
+    light_block.projection_view_mats[0] = atlas->get_tile_transform(tile) * math::mat4f(frustum.get_projection() * frustum.get_view());
+    light_block.shadow_offset = light.data.get_shadow_offset();
+    light_block.shadow_map = ::get_handle(atlas->get_depth_buffer());
+
+    if(!needs_redraw)
+    {
+        return true;
+    }
+
+    unsigned viewport_size(tile.size - 2 * ShadowAtlas::TILE_BORDER);
+
+    atlas->clear_tile(context_, tile);
+    atlas->set_tile(tile);
+
+    auto orig_scene(current_viewstate_.scene);
+    auto original_camera_resolution(current_viewstate_.camera.config.get_resolution());
+
+    current_viewstate_.target = atlas.get();
+    current_viewstate_.viewpoint_uuid = light.uuid();
+    current_viewstate_.view_direction = PipelineViewState::front;
+    current_viewstate_.shadow_mode = true;
+    current_viewstate_.camera.config.set_resolution(math::vec2ui(viewport_size));
+    current_viewstate_.scene = shadow_scene;
+    current_viewstate_.frustum = frustum;
+
+    camera_block_.update(context_, frustum, frustum.get_camera_position(), shadow_scene->clipping_planes, current_viewstate_.camera.config.get_view_id(), math::vec2ui(viewport_size));
+    bind_camera_uniform_block(0);
+
+    for(std::size_t pass_idx = 0; pass_idx < passes_.size(); ++pass_idx)
+    {
+        if(passes_[pass_idx].enable_for_shadows())
+        {
+            passes_[pass_idx].process(*last_description_.get_passes()[pass_idx], *this);
+        }
+    }
+
+    restore_camera_view(orig_scene, original_camera_resolution);
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Pipeline::restore_camera_view(std::shared_ptr<SerializedScene> const& scene, math::vec2ui const& resolution)
+{
+    current_viewstate_.target = gbuffer_.get();
+    current_viewstate_.scene = scene;
+    current_viewstate_.frustum = current_viewstate_.scene->rendering_frustum;
+    current_viewstate_.camera.config.set_resolution(resolution);
+
+    camera_block_.update(context_,
+                         current_viewstate_.scene->rendering_frustum,
+                         math::get_translation(current_viewstate_.camera.transform),
+                         current_viewstate_.scene->clipping_planes,
+                         current_viewstate_.camera.config.get_view_id(),
+                         current_viewstate_.camera.config.get_resolution());
+
+    bind_camera_uniform_block(0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 PipelineViewState const& Pipeline::current_viewstate() const { return current_viewstate_; }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -818,6 +970,11 @@ void Pipeline::clear_frame_cache()
     }
 
     shadow_map_res_->used_shadow_maps.clear();
+
+    if(shadow_map_res_->atlas)
+    {
+        shadow_map_res_->atlas->release_unused(context_.framecount, ShadowAtlas::MAX_IDLE_FRAMES);
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -68,6 +68,7 @@ PipelineDescription::PipelineDescription(PipelineDescription const& other)
     abuffer_size_ = other.abuffer_size_;
     blending_termination_threshold_ = other.blending_termination_threshold_;
     max_lights_count_ = other.max_lights_count_;
+    shadow_atlas_size_ = other.shadow_atlas_size_;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -130,7 +131,7 @@ std::shared_ptr<SSAAPassDescription> const PipelineDescription::get_ssaa_pass()
 bool PipelineDescription::operator==(PipelineDescription const& other) const
 {
     if(enable_abuffer_ != other.enable_abuffer_ || abuffer_size_ != other.abuffer_size_ || blending_termination_threshold_ != other.blending_termination_threshold_ ||
-       max_lights_count_ != other.max_lights_count_ || passes_.size() != other.passes_.size())
+       max_lights_count_ != other.max_lights_count_ || shadow_atlas_size_ != other.shadow_atlas_size_ || passes_.size() != other.passes_.size())
     {
         return false;
     }
@@ -169,6 +170,7 @@ PipelineDescription& PipelineDescription::operator=(PipelineDescription const& o
     abuffer_size_ = other.abuffer_size_;
     blending_termination_threshold_ = other.blending_termination_threshold_;
     max_lights_count_ = other.max_lights_count_;
+    shadow_atlas_size_ = other.shadow_atlas_size_;
 
     return *this;
 }
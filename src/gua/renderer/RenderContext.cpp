@@ -28,5 +28,5 @@ namespace gua
 {
 ////////////////////////////////////////////////////////////////////////////////
 
-RenderContext::RenderContext() : context(), display(), render_context(), render_device(), render_window(nullptr), id(0), framecount(0) {}
+RenderContext::RenderContext() : context(), display(), render_context(), render_device(), render_window(nullptr), id(0), framecount(0), memory(std::make_shared<GpuMemoryRegistry>()) {}
 } // namespace gua
@@ -199,6 +199,7 @@ void Renderer::renderclient(Mailbox in, std::string window_name)
                 window->finish_frame();
 
                 ++(window->get_context()->framecount);
+                window->get_context()->memory->collect(window->get_context()->framecount);
 
                 fpsc.step();
             }
@@ -351,6 +352,7 @@ void Renderer::draw_single_threaded(std::vector<SceneGraph const*> const& scene_
                     // swap buffers
                     window->finish_frame();
                     ++(window->get_context()->framecount);
+                    window->get_context()->memory->collect(window->get_context()->framecount);
                 }
             }
         }
@@ -22,9 +22,142 @@
 // class header
 #include <gua/renderer/ScreenGrabPass.hpp>
 
+#include <gua/renderer/GBuffer.hpp>
+#include <gua/renderer/TextureReadback.hpp>
+#include <gua/utils/Logger.hpp>
+
+#include <scm/gl_core/render_device/opengl/gl_core.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+
+#ifdef GUACAMOLE_ENABLE_TURBOJPEG
+#include <jpeglib.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GUA_SCREEN_GRAB_SSE2
+#endif
+
 namespace gua
 {
-ScreenGrabPassDescription::ScreenGrabPassDescription() : PipelinePassDescription(), output_prefix_(""), grab_next_(false)
+namespace
+{
+std::uint64_t make_timestamp_millis() { return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count(); }
+
+std::string make_timestamp() { return std::to_string(make_timestamp_millis()); }
+
+// the tag of a download holds its timestamp and the buffer it belongs to
+enum ReadbackKind : std::uint64_t
+{
+    COLOR_8 = 0,
+    COLOR_32F = 1,
+    DEPTH = 2
+};
+
+std::uint64_t make_tag(std::uint64_t millis, ReadbackKind kind) { return millis << 2 | kind; }
+ReadbackKind tag_kind(std::uint64_t tag) { return ReadbackKind(tag & 3); }
+std::string tag_timestamp(std::uint64_t tag) { return std::to_string(tag >> 2); }
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct ScreenGrabPassDescription::GrabState
+{
+    std::string get_output_prefix() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return output_prefix;
+    }
+
+    // every pipeline takes each grab request once
+    bool take_grab(Pipeline const& pipe, std::uint64_t request)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& taken(taken_requests[&pipe]);
+        if(taken == request)
+        {
+            return false;
+        }
+        taken = request;
+        return request != cancelled_request;
+    }
+
+    mutable std::mutex mutex;
+    std::string output_prefix;
+    std::map<Pipeline const*, std::uint64_t> taken_requests;
+    std::uint64_t cancelled_request = 0;
+    // incremented by set_grab_next(true)
+    std::atomic<std::uint64_t> grab_request{0};
+    std::atomic<bool> record{false};
+    std::atomic<bool> export_depth{false};
+};
+
+namespace
+{
+// downloads of one pass, finished ones are handed to the saver
+struct ScreenGrabReadbacks
+{
+    template <typename State>
+    ScreenGrabReadbacks(RenderContext const& context, unsigned latency, std::shared_ptr<State> const& state)
+        : ctx(context), color(latency), depth(latency), output_prefix([state]() { return state->get_output_prefix(); })
+    {
+    }
+
+    // pending grabs are still written when the pass is rebuilt or destroyed
+    ~ScreenGrabReadbacks()
+    {
+        poll(true);
+        color.remove_buffers(ctx);
+        depth.remove_buffers(ctx);
+    }
+
+    void poll(bool wait)
+    {
+        auto saver(ScreenGrabJPEGSaver::get_instance());
+
+        color.poll(ctx,
+                   [&](math::vec2ui const& dims, void const* data, std::size_t size, std::uint64_t tag) {
+                       auto rgb_8(saver->acquire_buffer(std::size_t(dims.x) * dims.y * 3));
+                       if(tag_kind(tag) == COLOR_32F)
+                       {
+                           ScreenGrabJPEGSaver::convert_rgb32f_to_rgb8(reinterpret_cast<float const*>(data), rgb_8.data(), dims);
+                       }
+                       else
+                       {
+                           ScreenGrabJPEGSaver::flip_rows(reinterpret_cast<unsigned char const*>(data), rgb_8.data(), dims, 3);
+                       }
+                       saver->save_jpeg(output_prefix() + tag_timestamp(tag) + ".jpg", dims, std::move(rgb_8));
+                   },
+                   wait);
+
+        depth.poll(ctx,
+                   [&](math::vec2ui const& dims, void const* data, std::size_t size, std::uint64_t tag) {
+                       auto depth_data(saver->acquire_buffer(size));
+                       ScreenGrabJPEGSaver::flip_rows(reinterpret_cast<unsigned char const*>(data), depth_data.data(), dims, sizeof(float));
+                       saver->save_raw(output_prefix() + tag_timestamp(tag) + ".depth", std::move(depth_data));
+                   },
+                   wait);
+    }
+
+    RenderContext const& ctx;
+    TextureReadback color;
+    TextureReadback depth;
+    std::function<std::string()> output_prefix;
+    // the last grab request this pass checked
+    std::uint64_t seen_request = 0;
+};
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+ScreenGrabPassDescription::ScreenGrabPassDescription() : PipelinePassDescription(), state_(std::make_shared<GrabState>()), readback_latency_(3)
 {
     vertex_shader_ = "";
     geometry_shader_ = "";
@@ -46,32 +179,61 @@ ScreenGrabPassDescription::ScreenGrabPassDescription() : PipelinePassDescription
 
 std::shared_ptr<PipelinePassDescription> ScreenGrabPassDescription::make_copy() const { return std::make_shared<ScreenGrabPassDescription>(*this); }
 
+////////////////////////////////////////////////////////////////////////////////
+
 PipelinePass ScreenGrabPassDescription::make_pass(RenderContext const& ctx, SubstitutionMap& substitution_map)
 {
-    private_.process_ = [&](PipelinePass&, PipelinePassDescription const&, Pipeline& pipe) {
-        RenderContext const& ctx(pipe.get_context());
+    auto state(state_);
+    auto readbacks(std::make_shared<ScreenGrabReadbacks>(ctx, readback_latency_, state));
 
-#ifdef GUACAMOLE_ENABLE_TURBOJPEG
-        if(grab_next_)
+    private_.process_ = [state, readbacks](PipelinePass&, PipelinePassDescription const&, Pipeline& pipe) {
+        // hand all downloads which finished since the last frame to the saver
+        readbacks->poll(false);
+
+        bool grab(state->record);
+        auto const request(state->grab_request.load());
+        if(request != readbacks->seen_request)
         {
-            grab_next_ = false;
-            scm::gl::texture_2d_ptr color_buffer = pipe.get_gbuffer()->get_color_buffer();
-            scm::math::vec2ui dims = color_buffer->dimensions();
+            readbacks->seen_request = request;
+            grab = state->take_grab(pipe, request) || grab;
+        }
 
-            auto format = color_buffer->format();
+        if(!grab)
+        {
+            return;
+        }
 
-            if(format != scm::gl::data_format::FORMAT_RGB_32F)
-            {
-                std::cerr << "Invalid use of ScreenGrabPass with non-standard color buffer" << std::endl;
-                return;
-            }
+#ifdef GUACAMOLE_ENABLE_TURBOJPEG
+        RenderContext const& ctx(pipe.get_context());
+        auto millis(make_timestamp_millis());
+        scm::gl::texture_2d_ptr color_buffer = pipe.get_gbuffer()->get_color_buffer();
+        auto format = color_buffer->format();
 
-            std::vector<float> host_color_buffer(dims.x * dims.y * 3);
+        bool requested(false);
+        if(format == scm::gl::FORMAT_RGB_32F)
+        {
+            requested = readbacks->color.request(ctx, color_buffer, GL_RGB, GL_FLOAT, 3 * sizeof(float), make_tag(millis, COLOR_32F));
+        }
+        else if(format == scm::gl::FORMAT_RGB_8)
+        {
+            requested = readbacks->color.request(ctx, color_buffer, GL_RGB, GL_UNSIGNED_BYTE, 3, make_tag(millis, COLOR_8));
+        }
+        else
+        {
+            Logger::LOG_WARNING << "Invalid use of ScreenGrabPass with non-standard color buffer" << std::endl;
+            return;
+        }
 
-            ctx.render_context->retrieve_texture_data(color_buffer, 0, &host_color_buffer[0]);
-            ctx.render_context->sync();
+        if(!requested)
+        {
+            Logger::LOG_DEBUG << "ScreenGrabPass: all readback buffers in flight, dropping frame" << std::endl;
+            return;
+        }
 
-            ScreenGrabJPEGSaver::get_instance()->save(output_prefix_, dims, host_color_buffer);
+        // only along with a color image
+        if(state->export_depth)
+        {
+            readbacks->depth.request(ctx, pipe.get_gbuffer()->get_depth_buffer(), GL_DEPTH_COMPONENT, GL_FLOAT, sizeof(float), make_tag(millis, DEPTH));
         }
 #endif
     };
@@ -79,15 +241,327 @@ PipelinePass ScreenGrabPassDescription::make_pass(RenderContext const& ctx, Subs
     PipelinePass pass{*this, ctx, substitution_map};
     return pass;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+
 void ScreenGrabPassDescription::set_output_prefix(const std::string& output_prefix)
 {
-    output_prefix_ = output_prefix;
-    touch();
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->output_prefix = output_prefix;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+
 void ScreenGrabPassDescription::set_grab_next(bool grab_next)
 {
-    grab_next_ = grab_next;
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if(grab_next)
+    {
+        ++state_->grab_request;
+    }
+    else
+    {
+        state_->cancelled_request = state_->grab_request;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ScreenGrabPassDescription::set_record(bool record) { state_->record = record; }
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ScreenGrabPassDescription::get_record() const { return state_->record; }
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ScreenGrabPassDescription::set_export_depth(bool export_depth) { state_->export_depth = export_depth; }
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ScreenGrabPassDescription::get_export_depth() const { return state_->export_depth; }
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ScreenGrabPassDescription::set_readback_latency(unsigned frames)
+{
+    readback_latency_ = std::max(1u, frames);
     touch();
 }
 
-} // namespace gua
\ No newline at end of file
+////////////////////////////////////////////////////////////////////////////////
+
+ScreenGrabJPEGSaver::ScreenGrabJPEGSaver() : should_quit_(false), capacity_(8), policy_(OverflowPolicy::DROP_OLDEST), saved_count_(0), dropped_count_(0)
+{
+    unsigned worker_count(std::max(1u, std::thread::hardware_concurrency() / 2));
+
+    for(unsigned i(0); i < worker_count; ++i)
+    {
+        workers_.emplace_back([this]() { work(); });
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ScreenGrabJPEGSaver::~ScreenGrabJPEGSaver()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        should_quit_ = true;
+    }
+    job_cv_.notify_all();
+    space_cv_.notify_all();
+
+    for(auto& worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ScreenGrabJPEGSaver::save(std::string& output_prefix, scm::math::vec2ui& dims, std::vector<float>& rgb_32f)
+{
+    auto rgb_8(acquire_buffer(std::size_t(dims.x) * dims.y * 3));
+    convert_rgb32f_to_rgb8(rgb_32f.data(), rgb_8.data(), dims);
+    save_jpeg(output_prefix + make_timestamp() + ".jpg", dims, std::move(rgb_8));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ScreenGrabJPEGSaver::save_jpeg(std::string const& filename, scm::math::vec2ui const& dims, std::vector<unsigned char>&& rgb_8) { enqueue(Job{filename, dims, std::move(rgb_8), false}); }
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ScreenGrabJPEGSaver::save_raw(std::string const& filename, std::vector<unsigned char>&& data) { enqueue(Job{filename, scm::math::vec2ui(0, 0), std::move(data), true}); }
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<unsigned char> ScreenGrabJPEGSaver::acquire_buffer(std::size_t size)
+{
+    std::vector<unsigned char> buffer;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(!free_buffers_.empty())
+        {
+            buffer.swap(free_buffers_.back());
+            free_buffers_.pop_back();
+        }
+    }
+    buffer.resize(size);
+    return buffer;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ScreenGrabJPEGSaver::set_queue_capacity(unsigned capacity)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = std::max(1u, capacity);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ScreenGrabJPEGSaver::set_overflow_policy(OverflowPolicy policy)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    policy_ = policy;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ScreenGrabJPEGSaver::enqueue(Job&& job)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        if(jobs_.size() >= capacity_)
+        {
+            switch(policy_)
+            {
+            case OverflowPolicy::DROP_NEWEST:
+                ++dropped_count_;
+                free_buffers_.push_back(std::move(job.data));
+                return;
+            case OverflowPolicy::DROP_OLDEST:
+                ++dropped_count_;
+                free_buffers_.push_back(std::move(jobs_.front().data));
+                jobs_.pop_front();
+                break;
+            case OverflowPolicy::BLOCK:
+                space_cv_.wait(lock, [this]() { return jobs_.size() < capacity_ || should_quit_; });
+                break;
+            }
+        }
+
+        if(should_quit_)
+        {
+            return;
+        }
+
+        jobs_.push_back(std::move(job));
+    }
+    job_cv_.notify_one();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ScreenGrabJPEGSaver::work()
+{
+    while(true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            job_cv_.wait(lock, [this]() { return !jobs_.empty() || should_quit_; });
+
+            // pending frames are still written on shutdown
+            if(jobs_.empty())
+            {
+                return;
+            }
+
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+        space_cv_.notify_one();
+
+        bool success(false);
+        if(job.raw)
+        {
+            std::ofstream file(job.filename, std::ios::out | std::ios::binary);
+            success = file.write(reinterpret_cast<char const*>(job.data.data()), job.data.size()).good();
+        }
+        else
+        {
+            success = write_JPEG_file(job, 100);
+        }
+
+        if(success)
+        {
+            ++saved_count_;
+        }
+        else
+        {
+            Logger::LOG_WARNING << "ScreenGrabJPEGSaver: could not write " << job.filename << std::endl;
+        }
+
+        release_buffer(std::move(job.data));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ScreenGrabJPEGSaver::release_buffer(std::vector<unsigned char>&& buffer)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    // keep enough buffers for a full queue and the ones being encoded
+    if(free_buffers_.size() < capacity_ + workers_.size())
+    {
+        free_buffers_.push_back(std::move(buffer));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ScreenGrabJPEGSaver::write_JPEG_file(Job const& job, int quality)
+{
+#ifdef GUACAMOLE_ENABLE_TURBOJPEG
+    struct jpeg_compress_struct cinfo;
+    struct jpeg_error_mgr jerr;
+    FILE* outfile;           /* target file */
+    JSAMPROW row_pointer[1]; /* pointer to JSAMPLE row[s] */
+    int row_stride;          /* physical row width in image buffer */
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_compress(&cinfo);
+    if((outfile = fopen(job.filename.c_str(), "wb")) == NULL)
+    {
+        jpeg_destroy_compress(&cinfo);
+        return false;
+    }
+    jpeg_stdio_dest(&cinfo, outfile);
+
+    cinfo.image_width = job.dims.x; /* image width and height, in pixels */
+    cinfo.image_height = job.dims.y;
+    cinfo.input_components = 3;     /* # of color components per pixel */
+    cinfo.in_color_space = JCS_RGB; /* colorspace of input image */
+
+    jpeg_set_defaults(&cinfo);
+
+    jpeg_set_quality(&cinfo, quality, TRUE /* limit to baseline-JPEG values */);
+
+    jpeg_start_compress(&cinfo, TRUE);
+
+    row_stride = job.dims.x * 3; /* JSAMPLEs per row in image_buffer */
+
+    while(cinfo.next_scanline < cinfo.image_height)
+    {
+        row_pointer[0] = const_cast<JSAMPROW>(&job.data[cinfo.next_scanline * row_stride]);
+        (void)jpeg_write_scanlines(&cinfo, row_pointer, 1);
+    }
+
+    jpeg_finish_compress(&cinfo);
+    fclose(outfile);
+
+    jpeg_destroy_compress(&cinfo);
+
+    return true;
+#else
+    Logger::LOG_WARNING << "ScreenGrabJPEGSaver: JPEG support not available. Compile with option GUACAMOLE_ENABLE_TURBOJPEG" << std::endl;
+    return false;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ScreenGrabJPEGSaver::convert_rgb32f_to_rgb8(float const* src, unsigned char* dst, scm::math::vec2ui const& dims)
+{
+    std::size_t row_length(dims.x * 3);
+
+    for(unsigned y(0); y < dims.y; ++y)
+    {
+        float const* src_row(src + (dims.y - 1 - y) * row_length);
+        unsigned char* dst_row(dst + y * row_length);
+        std::size_t i(0);
+
+#ifdef GUA_SCREEN_GRAB_SSE2
+        // 16 channels per iteration: scale, clamp to [0, 255], truncate, pack
+        __m128 const scale(_mm_set1_ps(256.f));
+        __m128 const lower(_mm_setzero_ps());
+        __m128 const upper(_mm_set1_ps(255.f));
+
+        for(; i + 16 <= row_length; i += 16)
+        {
+            __m128i a(_mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src_row + i), scale), lower), upper)));
+            __m128i b(_mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src_row + i + 4), scale), lower), upper)));
+            __m128i c(_mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src_row + i + 8), scale), lower), upper)));
+            __m128i d(_mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src_row + i + 12), scale), lower), upper)));
+
+            __m128i packed(_mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_row + i), packed);
+        }
+#endif
+
+        for(; i < row_length; ++i)
+        {
+            float f(src_row[i]);
+            dst_row[i] = f >= 1.f ? 255 : (f <= 0.f ? 0 : static_cast<unsigned char>(f * 256.f));
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ScreenGrabJPEGSaver::flip_rows(unsigned char const* src, unsigned char* dst, scm::math::vec2ui const& dims, unsigned bytes_per_pixel)
+{
+    std::size_t row_size(std::size_t(dims.x) * bytes_per_pixel);
+
+    for(unsigned y(0); y < dims.y; ++y)
+    {
+        std::memcpy(dst + y * row_size, src + (dims.y - 1 - y) * row_size, row_size);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace gua
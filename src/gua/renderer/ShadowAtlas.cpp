@@ -0,0 +1,313 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+// class header
+#include <gua/renderer/ShadowAtlas.hpp>
+
+// external headers
+#include <algorithm>
+
+namespace gua
+{
+namespace
+{
+unsigned next_power_of_two(unsigned value)
+{
+    unsigned result(1);
+    while(result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+ShadowAtlas::ShadowAtlas(RenderContext const& ctx, unsigned size, unsigned min_tile_size)
+    : RenderTarget(math::vec2ui(next_power_of_two(size))), min_tile_size_(std::min(next_power_of_two(std::max(min_tile_size, 4 * TILE_BORDER)), resolution_.x)), fbo_(nullptr),
+      depth_buffer_(nullptr)
+{
+    scm::gl::sampler_state_desc sampler_state_desc(scm::gl::FILTER_MIN_MAG_LINEAR, scm::gl::WRAP_CLAMP_TO_EDGE, scm::gl::WRAP_CLAMP_TO_EDGE);
+    sampler_state_desc._compare_mode = scm::gl::TEXCOMPARE_COMPARE_REF_TO_TEXTURE;
+    sampler_state_desc._max_anisotropy = 16;
+
+    sampler_state_ = ctx.render_device->create_sampler_state(sampler_state_desc);
+
+    depth_buffer_ = ctx.render_device->create_texture_2d(resolution_, scm::gl::FORMAT_D16, 1);
+    ctx.render_context->make_resident(depth_buffer_, sampler_state_);
+
+    fbo_ = ctx.render_device->create_frame_buffer();
+    fbo_->attach_depth_stencil_buffer(depth_buffer_, 0, 0);
+
+    free_tiles_.resize(level_of(min_tile_size_) + 1);
+    free_tiles_[0].insert(std::make_pair(0u, 0u));
+
+    ctx.memory->track(GpuMemoryRegistry::id_of(this), GpuMemoryRegistry::Category::SHADOW_MAP, std::size_t(resolution_.x) * resolution_.y * 2, "ShadowAtlas");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ShadowAtlas::acquire(std::size_t key, unsigned size, std::size_t content_hash, unsigned frame, Tile& tile, bool& needs_redraw)
+{
+    size = std::max(min_tile_size_, std::min(next_power_of_two(size), resolution_.x));
+
+    auto cached(tiles_.find(key));
+    if(cached != tiles_.end())
+    {
+        // a tile drawn for another view of this frame is reused regardless of
+        // its size; a tile one level larger than needed is kept as well, so
+        // lights whose size flickers at a power of two don't reallocate
+        unsigned cached_size(cached->second.tile.size);
+        if(cached_size == size || cached_size == 2 * size || cached->second.last_used == frame)
+        {
+            needs_redraw = cached->second.content_hash != content_hash;
+            cached->second.content_hash = content_hash;
+            cached->second.last_used = frame;
+            tile = cached->second.tile;
+            return true;
+        }
+
+        free(cached->second.tile);
+        tiles_.erase(cached);
+    }
+
+    needs_redraw = true;
+
+    while(size >= min_tile_size_)
+    {
+        if(allocate(size, tile))
+        {
+            CachedTile entry;
+            entry.tile = tile;
+            entry.content_hash = content_hash;
+            entry.last_used = frame;
+            tiles_[key] = entry;
+            return true;
+        }
+
+        // make room by dropping the least recently used tile of a previous frame
+        auto victim(tiles_.end());
+        for(auto it(tiles_.begin()); it != tiles_.end(); ++it)
+        {
+            if(it->second.last_used != frame && (victim == tiles_.end() || it->second.last_used < victim->second.last_used))
+            {
+                victim = it;
+            }
+        }
+
+        if(victim != tiles_.end())
+        {
+            free(victim->second.tile);
+            tiles_.erase(victim);
+        }
+        else
+        {
+            // the atlas is full with tiles of this frame, try a smaller one
+            size /= 2;
+        }
+    }
+
+    return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ShadowAtlas::release_unused(unsigned frame, unsigned max_idle_frames)
+{
+    for(auto it(tiles_.begin()); it != tiles_.end();)
+    {
+        if(frame - it->second.last_used > max_idle_frames)
+        {
+            free(it->second.tile);
+            it = tiles_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ShadowAtlas::clear_tile(RenderContext const& ctx, Tile const& tile, float depth) const
+{
+    auto const& glapi = ctx.render_context->opengl_api();
+    glapi.glClearTexSubImage(depth_buffer_->object_id(), 0, tile.x, tile.y, 0, tile.size, tile.size, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &depth);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ShadowAtlas::set_tile(Tile const& tile) { current_tile_ = tile; }
+
+////////////////////////////////////////////////////////////////////////////////
+
+math::mat4f ShadowAtlas::get_tile_transform(Tile const& tile) const
+{
+    float atlas_size(static_cast<float>(resolution_.x));
+    float inner_size(static_cast<float>(tile.size - 2 * TILE_BORDER));
+
+    math::mat4f transform(math::mat4f::identity());
+    transform[0] = inner_size / atlas_size;
+    transform[5] = inner_size / atlas_size;
+    transform[12] = (2.f * (tile.x + TILE_BORDER) + inner_size) / atlas_size - 1.f;
+    transform[13] = (2.f * (tile.y + TILE_BORDER) + inner_size) / atlas_size - 1.f;
+    return transform;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ShadowAtlas::clear(RenderContext const& ctx, float depth, unsigned stencil) { ctx.render_context->clear_depth_stencil_buffer(fbo_, depth, stencil); }
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ShadowAtlas::bind(RenderContext const& ctx, bool write_depth) { ctx.render_context->set_frame_buffer(fbo_); }
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ShadowAtlas::set_viewport(RenderContext const& ctx)
+{
+    if(ctx.render_context)
+    {
+        float inner_size(static_cast<float>(current_tile_.size - 2 * TILE_BORDER));
+        ctx.render_context->set_viewport(
+            scm::gl::viewport(scm::math::vec2f(float(current_tile_.x + TILE_BORDER), float(current_tile_.y + TILE_BORDER)), scm::math::vec2f(inner_size, inner_size)));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ShadowAtlas::remove_buffers(RenderContext const& ctx)
+{
+    unbind(ctx);
+
+    fbo_->clear_attachments();
+
+    if(depth_buffer_)
+    {
+        ctx.render_context->make_non_resident(depth_buffer_);
+    }
+
+    ctx.memory->untrack(GpuMemoryRegistry::id_of(this));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+scm::gl::texture_2d_ptr const& ShadowAtlas::get_depth_buffer() const { return depth_buffer_; }
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ShadowAtlas::allocate(unsigned size, Tile& tile)
+{
+    unsigned level(level_of(size));
+
+    // find the smallest free tile which is large enough
+    int source(static_cast<int>(level));
+    while(source >= 0 && free_tiles_[source].empty())
+    {
+        --source;
+    }
+
+    if(source < 0)
+    {
+        return false;
+    }
+
+    auto position(*free_tiles_[source].begin());
+    free_tiles_[source].erase(free_tiles_[source].begin());
+
+    // split it until it has the requested size, keeping the lower left quarter
+    unsigned current_size(resolution_.x >> source);
+    for(unsigned l(source + 1); l <= level; ++l)
+    {
+        current_size /= 2;
+        free_tiles_[l].insert(std::make_pair(position.first + current_size, position.second));
+        free_tiles_[l].insert(std::make_pair(position.first, position.second + current_size));
+        free_tiles_[l].insert(std::make_pair(position.first + current_size, position.second + current_size));
+    }
+
+    tile.x = position.first;
+    tile.y = position.second;
+    tile.size = size;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ShadowAtlas::free(Tile const& tile)
+{
+    unsigned level(level_of(tile.size));
+    unsigned size(tile.size);
+    auto position(std::make_pair(tile.x, tile.y));
+
+    // merge with free buddies as long as possible
+    while(level > 0)
+    {
+        unsigned parent_size(size * 2);
+        unsigned px(position.first - position.first % parent_size);
+        unsigned py(position.second - position.second % parent_size);
+
+        std::pair<unsigned, unsigned> quarters[4] = {{px, py}, {px + size, py}, {px, py + size}, {px + size, py + size}};
+
+        bool all_free(true);
+        for(auto const& quarter : quarters)
+        {
+            if(quarter != position && free_tiles_[level].find(quarter) == free_tiles_[level].end())
+            {
+                all_free = false;
+                break;
+            }
+        }
+
+        if(!all_free)
+        {
+            break;
+        }
+
+        for(auto const& quarter : quarters)
+        {
+            free_tiles_[level].erase(quarter);
+        }
+
+        position = std::make_pair(px, py);
+        size = parent_size;
+        --level;
+    }
+
+    free_tiles_[level].insert(position);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+unsigned ShadowAtlas::level_of(unsigned size) const
+{
+    unsigned level(0);
+    while((resolution_.x >> level) > size)
+    {
+        ++level;
+    }
+    return level;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace gua
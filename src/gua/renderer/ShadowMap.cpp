@@ -52,6 +52,8 @@ ShadowMap::ShadowMap(RenderContext const& ctx, math::vec2ui const& resolution)
 
     fbo_ = ctx.render_device->create_frame_buffer();
     fbo_->attach_depth_stencil_buffer(depth_buffer_, 0, 0);
+
+    ctx.memory->track(GpuMemoryRegistry::id_of(this), GpuMemoryRegistry::Category::SHADOW_MAP, std::size_t(resolution.x) * resolution.y * 2, "ShadowMap");
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -96,6 +98,8 @@ void ShadowMap::remove_buffers(RenderContext const& ctx)
     {
         ctx.render_context->make_non_resident(depth_buffer_);
     }
+
+    ctx.memory->untrack(GpuMemoryRegistry::id_of(this));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -29,6 +29,7 @@
 
 // external headers
 #include <scm/gl_util/data/imaging/texture_loader.h>
+#include <algorithm>
 #include <iostream>
 
 namespace gua
@@ -110,6 +111,16 @@ scm::gl::texture_image_ptr const& Texture::get_buffer(RenderContext const& conte
     return nullptr;
 }
 
+std::size_t Texture::estimate_memory_size(math::vec3ui const& size, scm::gl::data_format format, unsigned mip_levels)
+{
+    std::size_t bytes(0);
+    for(unsigned level(0); level < std::max(1u, mip_levels); ++level)
+    {
+        bytes += std::size_t(std::max(1u, size.x >> level)) * std::max(1u, size.y >> level) * std::max(1u, size.z >> level) * scm::gl::size_of_format(format);
+    }
+    return bytes;
+}
+
 void Texture::make_non_resident(RenderContext const& context) const
 {
     auto iter = context.textures.find(uuid_);
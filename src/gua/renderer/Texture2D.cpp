@@ -81,6 +81,16 @@ void Texture2D::upload_to(RenderContext const& context) const
 
         context.textures[uuid_] = ctex;
         context.render_context->make_resident(ctex.texture, ctex.sampler_state);
+
+        // not evictable: bindless handles are baked into material uniform blocks
+        if(image_)
+        {
+            memory_allocations_.track(context.memory, GpuMemoryRegistry::id_of(this), GpuMemoryRegistry::Category::TEXTURE, estimate_memory_size(math::vec3ui(width_, height_, 1), image_->format(), image_->mip_level_count()), file_name_);
+        }
+        else
+        {
+            memory_allocations_.track(context.memory, GpuMemoryRegistry::id_of(this), GpuMemoryRegistry::Category::TEXTURE, estimate_memory_size(math::vec3ui(width_, height_, 1), color_format_, mipmap_layers_), file_name_);
+        }
     }
 }
 
@@ -89,6 +89,7 @@ void Texture3D::upload_to(RenderContext const& context) const
 
     context.textures[uuid_] = ctex;
     context.render_context->make_resident(ctex.texture, ctex.sampler_state);
+    memory_allocations_.track(context.memory, GpuMemoryRegistry::id_of(this), GpuMemoryRegistry::Category::TEXTURE, estimate_memory_size(math::vec3ui(width_, height_, depth_), color_format_, mipmap_layers_), file_name_);
 }
 
 } // namespace gua
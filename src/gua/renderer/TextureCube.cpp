@@ -90,6 +90,7 @@ void TextureCube::upload_to(RenderContext const& context) const
 
         context.textures[uuid_] = ctex;
         context.render_context->make_resident(ctex.texture, ctex.sampler_state);
+        memory_allocations_.track(context.memory, GpuMemoryRegistry::id_of(this), GpuMemoryRegistry::Category::TEXTURE, 6 * estimate_memory_size(math::vec3ui(width_, height_, 1), color_format_, mipmap_layers_), file_name_);
     }
 }
 
@@ -0,0 +1,144 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+// class header
+#include <gua/renderer/TextureReadback.hpp>
+
+#include <scm/gl_core/render_device/opengl/gl_core.h>
+
+namespace gua
+{
+////////////////////////////////////////////////////////////////////////////////
+
+TextureReadback::TextureReadback(unsigned ring_size) : ring_(std::max(1u, ring_size)) {}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool TextureReadback::request(RenderContext const& ctx, scm::gl::texture_2d_ptr const& texture, unsigned gl_format, unsigned gl_type, unsigned bytes_per_pixel, std::uint64_t tag)
+{
+    if(pending_count_ == ring_.size())
+    {
+        return false;
+    }
+
+    auto const& glapi = ctx.render_context->opengl_api();
+    auto& slot(ring_[next_]);
+
+    math::vec2ui dims(texture->dimensions());
+    std::size_t size(std::size_t(dims.x) * dims.y * bytes_per_pixel);
+
+    if(slot.buffer == 0)
+    {
+        glapi.glGenBuffers(1, &slot.buffer);
+    }
+
+    glapi.glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+
+    if(slot.capacity < size)
+    {
+        glapi.glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        slot.capacity = size;
+    }
+
+    // rows of RGB data are not necessarily 4 byte aligned
+    glapi.glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glapi.glGetTextureImageEXT(texture->object_id(), GL_TEXTURE_2D, 0, gl_format, gl_type, nullptr);
+    glapi.glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glapi.glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glapi.glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.size = size;
+    slot.dims = dims;
+    slot.tag = tag;
+
+    next_ = (next_ + 1) % ring_.size();
+    ++pending_count_;
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void TextureReadback::poll(RenderContext const& ctx, Consumer const& consumer, bool wait)
+{
+    auto const& glapi = ctx.render_context->opengl_api();
+
+    while(pending_count_ > 0)
+    {
+        auto& slot(ring_[(next_ + ring_.size() - pending_count_) % ring_.size()]);
+        auto fence(reinterpret_cast<GLsync>(slot.fence));
+
+        // the first wait flushes, so the fence is guaranteed to be signaled eventually
+        GLuint64 timeout(wait ? GL_TIMEOUT_IGNORED : 0);
+        GLenum status(glapi.glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout));
+
+        if(status == GL_TIMEOUT_EXPIRED)
+        {
+            return;
+        }
+
+        glapi.glDeleteSync(fence);
+        slot.fence = nullptr;
+        --pending_count_;
+
+        if(status == GL_WAIT_FAILED)
+        {
+            continue;
+        }
+
+        glapi.glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        auto data(glapi.glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.size, GL_MAP_READ_BIT));
+        if(data)
+        {
+            consumer(slot.dims, data, slot.size, slot.tag);
+        }
+        glapi.glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glapi.glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void TextureReadback::remove_buffers(RenderContext const& ctx)
+{
+    auto const& glapi = ctx.render_context->opengl_api();
+
+    for(auto& slot : ring_)
+    {
+        if(slot.fence)
+        {
+            glapi.glDeleteSync(reinterpret_cast<GLsync>(slot.fence));
+            slot.fence = nullptr;
+        }
+        if(slot.buffer)
+        {
+            glapi.glDeleteBuffers(1, &slot.buffer);
+            slot.buffer = 0;
+            slot.capacity = 0;
+        }
+    }
+
+    pending_count_ = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace gua
@@ -195,7 +195,8 @@ std::shared_ptr<node::Node> TriMeshLoader::load(std::string const& file_name, un
             FbxScene* scene = load_fbx_file(sdk_manager, file_name);
 
             unsigned count(0);
-            std::shared_ptr<node::Node> tree{get_tree(*scene->GetRootNode(), file_name, flags, count)};
+            MaterialLoader material_loader;
+            std::shared_ptr<node::Node> tree{get_tree(*scene->GetRootNode(), file_name, flags, count, material_loader)};
             sdk_manager->Destroy();
 
             return tree;
@@ -236,9 +237,18 @@ std::shared_ptr<node::Node> TriMeshLoader::load(std::string const& file_name, un
 
             if(scene->mRootNode)
             {
+                // all materials of the scene are imported at once, each mesh
+                // gets its own copy
+                std::vector<std::shared_ptr<Material>> materials;
+                if(flags & TriMeshLoader::LOAD_MATERIALS)
+                {
+                    MaterialLoader material_loader;
+                    materials = material_loader.load_materials(scene, file_name, flags & TriMeshLoader::OPTIMIZE_MATERIALS, flags & TriMeshLoader::PARSE_HIERARCHY);
+                }
+
                 unsigned count = 0;
                 bool enforce_hierarchy = flags & TriMeshLoader::PARSE_HIERARCHY;
-                new_node = get_tree(importer, scene, scene->mRootNode, file_name, flags, count, enforce_hierarchy);
+                new_node = get_tree(importer, scene, scene->mRootNode, file_name, flags, count, enforce_hierarchy, materials);
             }
             else
             {
@@ -294,7 +304,7 @@ bool TriMeshLoader::is_supported(std::string const& file_name) const
 
 ////////////////////////////////////////////////////////////////////////////////
 #ifdef GUACAMOLE_FBX
-std::shared_ptr<node::Node> TriMeshLoader::get_tree(FbxNode& fbx_node, std::string const& file_name, unsigned flags, unsigned& mesh_count)
+std::shared_ptr<node::Node> TriMeshLoader::get_tree(FbxNode& fbx_node, std::string const& file_name, unsigned flags, unsigned& mesh_count, MaterialLoader const& material_loader)
 {
     // creates a geometry node and returns it
     auto load_geometry = [&](FbxNode& fbx_node) {
@@ -308,7 +318,6 @@ std::shared_ptr<node::Node> TriMeshLoader::get_tree(FbxNode& fbx_node, std::stri
 
         if(fbx_node.GetMaterialCount() > 0 && flags & TriMeshLoader::LOAD_MATERIALS)
         {
-            MaterialLoader material_loader;
             if(fbx_node.GetMaterialCount() > 1)
             {
                 Logger::LOG_WARNING << "Trimesh has more than one material, using only first one" << std::endl;
@@ -344,22 +353,28 @@ std::shared_ptr<node::Node> TriMeshLoader::get_tree(FbxNode& fbx_node, std::stri
     {
         if(fbx_node.GetChild(0)->GetGeometry()->GetAttributeType() == FbxNodeAttribute::eMesh)
         {
-            return get_tree(*fbx_node.GetChild(0), file_name, flags, mesh_count);
+            return get_tree(*fbx_node.GetChild(0), file_name, flags, mesh_count, material_loader);
         }
     }
 
     // else: there are multiple children and meshes
     for(int i = 0; i < fbx_node.GetChildCount(); ++i)
     {
-        group->add_child(get_tree(*fbx_node.GetChild(i), file_name, flags, mesh_count));
+        group->add_child(get_tree(*fbx_node.GetChild(i), file_name, flags, mesh_count, material_loader));
     }
 
     return group;
 }
 #endif
 ////////////////////////////////////////////////////////////////////////////////
-std::shared_ptr<node::Node> TriMeshLoader::get_tree(
-    std::shared_ptr<Assimp::Importer> const& importer, aiScene const* ai_scene, aiNode* ai_root, std::string const& file_name, unsigned flags, unsigned& mesh_count, bool enforce_hierarchy)
+std::shared_ptr<node::Node> TriMeshLoader::get_tree(std::shared_ptr<Assimp::Importer> const& importer,
+                                                    aiScene const* ai_scene,
+                                                    aiNode* ai_root,
+                                                    std::string const& file_name,
+                                                    unsigned flags,
+                                                    unsigned& mesh_count,
+                                                    bool enforce_hierarchy,
+                                                    std::vector<std::shared_ptr<Material>> const& materials)
 {
     // std::cout << "get_tree, " << file_name.c_str() << std::endl;
 
@@ -372,11 +387,9 @@ std::shared_ptr<node::Node> TriMeshLoader::get_tree(
         std::shared_ptr<Material> material = nullptr;
         unsigned material_index(ai_scene->mMeshes[ai_current->mMeshes[i]]->mMaterialIndex);
 
-        if(flags & TriMeshLoader::LOAD_MATERIALS)
+        if(flags & TriMeshLoader::LOAD_MATERIALS && material_index < materials.size())
         {
-            MaterialLoader material_loader;
-            aiMaterial const* ai_material(ai_scene->mMaterials[material_index]);
-            material = material_loader.load_material(ai_material, file_name, flags & TriMeshLoader::OPTIMIZE_MATERIALS, flags & TriMeshLoader::PARSE_HIERARCHY);
+            material = std::make_shared<Material>(*materials[material_index]);
         }
 
         // return std::make_shared<node::TriMeshNode>("", desc.unique_key(),
@@ -391,7 +404,7 @@ std::shared_ptr<node::Node> TriMeshLoader::get_tree(
         {
             // std::cout << "one child: " << ai_root->mChildren[0]->mName.data << ", no meshes" << std::endl;
 
-            auto node = get_tree(importer, ai_scene, ai_root->mChildren[0], file_name, flags, mesh_count, enforce_hierarchy);
+            auto node = get_tree(importer, ai_scene, ai_root->mChildren[0], file_name, flags, mesh_count, enforce_hierarchy, materials);
             node->set_transform(convert_transformation(ai_root->mTransformation) * convert_transformation(ai_root->mChildren[0]->mTransformation));
             return node;
         }
@@ -422,7 +435,7 @@ std::shared_ptr<node::Node> TriMeshLoader::get_tree(
         {
             // std::cout << ai_root->mChildren[i]->mName.data << std::endl;
 
-            auto child = get_tree(importer, ai_scene, ai_root->mChildren[i], file_name, flags, mesh_count, enforce_hierarchy);
+            auto child = get_tree(importer, ai_scene, ai_root->mChildren[i], file_name, flags, mesh_count, enforce_hierarchy, materials);
             auto child_transform_ai = ai_root->mChildren[i]->mTransformation;
             apply_transformation(child, child_transform_ai);
 
@@ -83,6 +83,16 @@ void TriMeshRessource::upload_to(RenderContext& ctx) const
     cmesh.vertex_array = ctx.render_device->create_vertex_array(mesh_.get_vertex_format(), {cmesh.vertices});
     ctx.meshes[uuid()] = cmesh;
 
+    // the mesh is uploaded again by draw() once it has been evicted
+    auto key(uuid());
+    auto* context(&ctx);
+    memory_allocations_.track(ctx.memory,
+                              GpuMemoryRegistry::id_of(this),
+                              GpuMemoryRegistry::Category::MESH,
+                              mesh_.num_vertices * sizeof(Mesh::Vertex) + mesh_.num_triangles * 3 * sizeof(unsigned),
+                              "TriMesh",
+                              [context, key]() { context->meshes.erase(key); });
+
     ctx.render_context->apply();
 }
 
@@ -97,6 +107,7 @@ void TriMeshRessource::draw(RenderContext& ctx) const
         upload_to(ctx);
         iter = ctx.meshes.find(uuid());
     }
+    ctx.memory->touch(GpuMemoryRegistry::id_of(this));
     ctx.render_context->bind_vertex_array(iter->second.vertex_array);
     ctx.render_context->bind_index_buffer(iter->second.indices, iter->second.indices_topology, iter->second.indices_type);
     ctx.render_context->apply_vertex_input();
@@ -81,6 +81,88 @@ void UniformValue::apply(RenderContext const& ctx, std::string const& name, scm:
         boost::apply_visitor(ApplyUniform(ctx, name, prog, location), data);
 }
 
+struct GUA_DLL GetStd140Layout : public boost::static_visitor<math::vec2ui>
+{
+    // returns (size, base alignment) in bytes
+    math::vec2ui operator()(int) const { return math::vec2ui(4, 4); }
+    math::vec2ui operator()(bool) const { return math::vec2ui(4, 4); }
+    math::vec2ui operator()(float) const { return math::vec2ui(4, 4); }
+    math::vec2ui operator()(math::mat3f const&) const { return math::vec2ui(48, 16); }
+    math::vec2ui operator()(math::mat4f const&) const { return math::vec2ui(64, 16); }
+    math::vec2ui operator()(math::vec2f const&) const { return math::vec2ui(8, 8); }
+    math::vec2ui operator()(math::vec3f const&) const { return math::vec2ui(12, 16); }
+    math::vec2ui operator()(math::vec4f const&) const { return math::vec2ui(16, 16); }
+    math::vec2ui operator()(math::vec2i const&) const { return math::vec2ui(8, 8); }
+    math::vec2ui operator()(math::vec3i const&) const { return math::vec2ui(12, 16); }
+    math::vec2ui operator()(math::vec4i const&) const { return math::vec2ui(16, 16); }
+    math::vec2ui operator()(math::vec2ui const&) const { return math::vec2ui(8, 8); }
+    math::vec2ui operator()(math::vec3ui const&) const { return math::vec2ui(12, 16); }
+    math::vec2ui operator()(math::vec4ui const&) const { return math::vec2ui(16, 16); }
+    math::vec2ui operator()(std::string const&) const { return math::vec2ui(8, 8); }
+};
+
+struct GUA_DLL WriteStd140 : public boost::static_visitor<bool>
+{
+    WriteStd140(RenderContext const& context, char* t) : ctx(context), target(t) {}
+
+    RenderContext const& ctx;
+    char* target;
+
+    template <typename T>
+    bool operator()(T const& value) const
+    {
+        memcpy(target, &value, sizeof(T));
+        return true;
+    }
+
+    bool operator()(bool value) const
+    {
+        int as_int(value ? 1 : 0);
+        memcpy(target, &as_int, sizeof(int));
+        return true;
+    }
+
+    // std140 stores each matrix column with the stride of a vec4
+    bool operator()(math::mat3f const& value) const
+    {
+        for(unsigned c(0); c < 3; ++c)
+        {
+            memcpy(target + c * 4 * sizeof(float), value.data_array + c * 3, 3 * sizeof(float));
+        }
+        return true;
+    }
+
+    bool operator()(std::string const& tex_name) const
+    {
+        math::vec2ui handle(0, 0);
+        bool resolved(true);
+
+        if(tex_name != "0")
+        {
+            auto texture(TextureDatabase::instance()->lookup(tex_name));
+            if(!texture)
+            {
+                TextureDatabase::instance()->load(tex_name);
+                texture = TextureDatabase::instance()->lookup(tex_name);
+            }
+            if(texture)
+            {
+                handle = texture->get_handle(ctx);
+            }
+            resolved = handle != math::vec2ui(0, 0);
+        }
+
+        memcpy(target, &handle, sizeof(math::vec2ui));
+        return resolved;
+    }
+};
+
+unsigned UniformValue::get_std140_size() const { return boost::apply_visitor(GetStd140Layout(), data).x; }
+
+unsigned UniformValue::get_std140_alignment() const { return boost::apply_visitor(GetStd140Layout(), data).y; }
+
+bool UniformValue::write_std140(RenderContext const& ctx, char* target) const { return boost::apply_visitor(WriteStd140(ctx, target), data); }
+
 template <>
 void UniformValue::write_bytes_impl<bool>(UniformValue const* self, RenderContext const& ctx, char* target)
 {
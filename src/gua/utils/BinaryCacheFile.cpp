@@ -0,0 +1,193 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+// class header
+#include <gua/utils/BinaryCacheFile.hpp>
+
+// external headers
+#include <cstdio>
+#include <fstream>
+
+namespace gua
+{
+namespace
+{
+char const MAGIC[8] = {'G', 'U', 'A', 'C', 'A', 'C', 'H', 'E'};
+
+template <typename T>
+void write_value(std::ofstream& file, T const& value)
+{
+    file.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool read_value(std::ifstream& file, T& value)
+{
+    return bool(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+BinaryCacheFile::BinaryCacheFile(uint32_t format_version, uint64_t source_key) : format_version_(format_version), source_key_(source_key), arrays_() {}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool BinaryCacheFile::save(std::string const& file_name) const
+{
+    std::string const temporary_file_name(file_name + ".tmp");
+
+    {
+        std::ofstream file(temporary_file_name, std::ios::binary);
+        if(!file)
+        {
+            return false;
+        }
+
+        file.write(MAGIC, sizeof(MAGIC));
+        write_value(file, format_version_);
+        write_value(file, source_key_);
+        write_value(file, uint32_t(arrays_.size()));
+
+        for(auto const& array : arrays_)
+        {
+            write_value(file, uint32_t(array.first.size()));
+            file.write(array.first.data(), array.first.size());
+            write_value(file, array.second.element_size);
+            write_value(file, uint64_t(array.second.bytes.size()));
+            file.write(array.second.bytes.data(), array.second.bytes.size());
+        }
+
+        if(!file)
+        {
+            file.close();
+            std::remove(temporary_file_name.c_str());
+            return false;
+        }
+    }
+
+    std::remove(file_name.c_str());
+    return std::rename(temporary_file_name.c_str(), file_name.c_str()) == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool BinaryCacheFile::load(std::string const& file_name)
+{
+    std::ifstream file(file_name, std::ios::binary | std::ios::ate);
+    uint64_t const file_size(file ? uint64_t(file.tellg()) : 0);
+    file.seekg(0);
+
+    char magic[sizeof(MAGIC)];
+    uint32_t format_version(0);
+    uint64_t source_key(0);
+    uint32_t num_arrays(0);
+
+    if(!file.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || !read_value(file, format_version) || format_version != format_version_ ||
+       !read_value(file, source_key) || source_key != source_key_ || !read_value(file, num_arrays))
+    {
+        return false;
+    }
+
+    std::map<std::string, Array> arrays;
+    for(uint32_t i = 0; i < num_arrays; ++i)
+    {
+        uint32_t name_size(0);
+        uint64_t num_bytes(0);
+        Array array;
+
+        if(!read_value(file, name_size))
+        {
+            return false;
+        }
+
+        std::string name(name_size, '\0');
+        if(!file.read(&name[0], name_size) || !read_value(file, array.element_size) || !read_value(file, num_bytes))
+        {
+            return false;
+        }
+
+        // a broken size must not make us allocate more than the file holds
+        if(num_bytes > file_size - uint64_t(file.tellg()))
+        {
+            return false;
+        }
+
+        array.bytes.resize(num_bytes);
+        if(!file.read(array.bytes.data(), num_bytes))
+        {
+            return false;
+        }
+
+        arrays[name] = std::move(array);
+    }
+
+    arrays_.swap(arrays);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t BinaryCacheFile::hash_data(void const* data, std::size_t num_bytes, uint64_t hash)
+{
+    uint64_t const prime = 1099511628211ull;
+    char const* bytes = static_cast<char const*>(data);
+
+    std::size_t i = 0;
+    for(; i + sizeof(uint64_t) <= num_bytes; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * prime;
+    }
+    for(; i < num_bytes; ++i)
+    {
+        hash = (hash ^ uint8_t(bytes[i])) * prime;
+    }
+
+    return hash;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t BinaryCacheFile::hash_file(std::string const& file_name)
+{
+    std::ifstream file(file_name, std::ios::binary);
+    if(!file)
+    {
+        return 0;
+    }
+
+    // chunks are a multiple of the word size, only the last one can have a tail
+    uint64_t hash = HASH_SEED;
+    std::vector<char> buffer(std::size_t(1) << 20);
+    while(file)
+    {
+        file.read(buffer.data(), buffer.size());
+        hash = hash_data(buffer.data(), std::size_t(file.gcount()), hash);
+    }
+
+    return hash;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace gua
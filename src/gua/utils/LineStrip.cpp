@@ -7,21 +7,25 @@
 // #include <gua/utils/Timer.hpp>
 
 // external headers
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 #include <mutex>
 
 namespace gua
 {
-LineStrip::LineStrip(unsigned int intitial_line_buffer_size) : vertex_reservoir_size(intitial_line_buffer_size), num_occupied_vertex_slots()
+LineStrip::LineStrip(unsigned int intitial_line_buffer_size)
+    : vertex_reservoir_size(intitial_line_buffer_size), num_occupied_vertex_slots(), ring_(intitial_line_buffer_size), plane_normals_(), normals_dirty_from_(0), first_normal_dirty_(false)
 {
     positions.resize(vertex_reservoir_size);
     colors.resize(vertex_reservoir_size);
     thicknesses.resize(vertex_reservoir_size);
     normals.resize(vertex_reservoir_size);
+    plane_normals_.resize(vertex_reservoir_size);
 }
 
-LineStrip::LineStrip(LineObject const& line_object)
+LineStrip::LineStrip(LineObject const& line_object) : vertex_reservoir_size(0), num_occupied_vertex_slots(0), ring_(), plane_normals_(), normals_dirty_from_(0), first_normal_dirty_(false)
 {
     // create line strip vbos from parsed line object
 
@@ -35,7 +39,7 @@ LineStrip::LineStrip(LineObject const& line_object)
             Logger::LOG_WARNING << line_object.vertex_position_database.size() << ", " << line_object.vertex_color_database.size() << ", " << line_object.vertex_thickness_database.size() << ", "
                                 << line_object.vertex_normal_database.size() << "\n";
         }
-        else
+        else if(line_object.line_indices.empty())
         {
             vertex_reservoir_size = num_occupied_vertex_slots = line_object.vertex_position_database.size();
             positions = line_object.vertex_position_database;
@@ -43,112 +47,175 @@ LineStrip::LineStrip(LineObject const& line_object)
             thicknesses = line_object.vertex_thickness_database;
             normals = line_object.vertex_normal_database;
         }
+        else
+        {
+            // expand the shared vertices of the segments to a line list
+            vertex_reservoir_size = num_occupied_vertex_slots = line_object.line_indices.size();
+            positions.reserve(line_object.line_indices.size());
+            colors.reserve(line_object.line_indices.size());
+            thicknesses.reserve(line_object.line_indices.size());
+            normals.reserve(line_object.line_indices.size());
+
+            for(unsigned vertex_idx : line_object.line_indices)
+            {
+                positions.push_back(line_object.vertex_position_database[vertex_idx]);
+                colors.push_back(line_object.vertex_color_database[vertex_idx]);
+                thicknesses.push_back(line_object.vertex_thickness_database[vertex_idx]);
+                normals.push_back(line_object.vertex_normal_database[vertex_idx]);
+            }
+        }
     }
     else
     {
         // indexed construction not implemented yet
     }
+
+    plane_normals_.resize(vertex_reservoir_size);
+    ring_.reset(vertex_reservoir_size, num_occupied_vertex_slots, false);
+}
+
+void LineStrip::set_ring_buffer_mode(bool enable)
+{
+    if(enable != ring_.mirrored())
+    {
+        resize_reservoirs(ring_.capacity(), enable);
+    }
 }
 
 void LineStrip::enlarge_reservoirs()
 {
-    if(vertex_reservoir_size > 0)
+    unsigned capacity = ring_.capacity();
+
+    // an unmirrored ring runs full at the end of its slots, moving the vertices to the front is enough while at most half of them are in use
+    if(ring_.mirrored() || 2 * ring_.size() >= capacity)
     {
-        vertex_reservoir_size *= 2;
+        capacity = capacity > 0 ? 2 * capacity : 2;
     }
-    else
+
+    resize_reservoirs(capacity, ring_.mirrored());
+}
+
+void LineStrip::resize_reservoirs(unsigned capacity, bool mirrored)
+{
+    unsigned const size = ring_.size();
+
+    std::vector<scm::math::vec3f> new_positions(capacity);
+    std::vector<scm::math::vec4f> new_colors(capacity);
+    std::vector<float> new_thicknesses(capacity);
+    std::vector<scm::math::vec3f> new_normals(capacity);
+    std::vector<scm::math::vec3f> new_plane_normals(capacity);
+
+    for(unsigned vertex_id(0); vertex_id < size; ++vertex_id)
     {
-        vertex_reservoir_size = 2;
+        unsigned const slot = ring_.slot(vertex_id);
+        new_positions[vertex_id] = positions[slot];
+        new_colors[vertex_id] = colors[slot];
+        new_thicknesses[vertex_id] = thicknesses[slot];
+        new_normals[vertex_id] = normals[slot];
+        new_plane_normals[vertex_id] = plane_normals_[slot];
     }
-    unsigned int padded_reservoir_size = vertex_reservoir_size + 2;
-    positions.resize(padded_reservoir_size);
-    colors.resize(padded_reservoir_size);
-    thicknesses.resize(padded_reservoir_size);
-    normals.resize(padded_reservoir_size);
+
+    positions.swap(new_positions);
+    colors.swap(new_colors);
+    thicknesses.swap(new_thicknesses);
+    normals.swap(new_normals);
+    plane_normals_.swap(new_plane_normals);
+
+    ring_.reset(capacity, size, mirrored);
+    vertex_reservoir_size = capacity;
 }
 
 void LineStrip::compute_consistent_normals() const
 {
-    bool last_plane_normal_exists = false;
-    scm::math::vec3f last_plane_normal = scm::math::vec3f(0.0f, 0.0f, 0.0f);
+    unsigned const size = ring_.size();
+
+    if(first_normal_dirty_ && size > 0)
+    {
+        compute_normal(0);
+    }
+    first_normal_dirty_ = false;
 
-    int32_t positions_size_minus_one = int32_t(positions.size()) - 1;
+    // the orientation of each normal depends on its predecessor, so everything after the first changed vertex is recomputed
+    for(unsigned normal_idx = normals_dirty_from_; normal_idx < size; ++normal_idx)
+    {
+        compute_normal(normal_idx);
+    }
+    normals_dirty_from_ = size;
+}
+
+void LineStrip::compute_normal(unsigned normal_idx) const
+{
+    unsigned const size = ring_.size();
+    unsigned const slot = ring_.slot(normal_idx);
 
-    for(int32_t normal_idx = 0; normal_idx < num_occupied_vertex_slots; ++normal_idx)
+    if(0 == normal_idx)
     {
-        if(0 == normal_idx)
+        if(1 == size)
         {
-            if(positions_size_minus_one == normal_idx)
-            {
-                normals[0] = scm::math::vec3f(0.0, 1.0, 0.0);
-            }
-            else
-            {
-                scm::math::vec3 to_normalize = positions[1] - positions[0];
-                if(scm::math::length(to_normalize) > 1e-6f)
-                {
-                    normals[0] = scm::math::normalize(to_normalize);
-                }
-                else
-                {
-                    normals[0] = scm::math::vec3f(1.0f, 0.0f, 0.0);
-                }
-            }
+            normals[slot] = scm::math::vec3f(0.0, 1.0, 0.0);
         }
-        else if(positions_size_minus_one == normal_idx)
+        else
         {
-            if(0 == normal_idx)
+            scm::math::vec3 to_normalize = positions[ring_.slot(1)] - positions[slot];
+            if(scm::math::length(to_normalize) > 1e-6f)
             {
-                normals[positions_size_minus_one] = scm::math::vec3f(0.0, 1.0, 0.0);
+                normals[slot] = scm::math::normalize(to_normalize);
             }
             else
             {
-                scm::math::vec3 to_normalize = positions[positions_size_minus_one] - positions[positions_size_minus_one - 1];
-                if(scm::math::length(to_normalize) > 1e-6f)
-                {
-                    normals[positions_size_minus_one] = scm::math::normalize(to_normalize);
-                }
-                else
-                {
-                    normals[positions_size_minus_one] = scm::math::vec3f(0.0, 1.0, 0.0);
-                }
+                normals[slot] = scm::math::vec3f(1.0f, 0.0f, 0.0);
             }
         }
+    }
+    else if(size - 1 == normal_idx)
+    {
+        scm::math::vec3 to_normalize = positions[slot] - positions[ring_.slot(normal_idx - 1)];
+        if(scm::math::length(to_normalize) > 1e-6f)
+        {
+            normals[slot] = scm::math::normalize(to_normalize);
+        }
         else
-        { // actual computation with consistency check
+        {
+            normals[slot] = scm::math::vec3f(0.0, 1.0, 0.0);
+        }
+    }
+    else
+    { // actual computation with consistency check
 
-            scm::math::vec3 p0_to_pC = positions[normal_idx] - positions[normal_idx - 1];
-            scm::math::vec3 pC_to_p1 = positions[normal_idx + 1] - positions[normal_idx];
+        scm::math::vec3 p0_to_pC = positions[slot] - positions[ring_.slot(normal_idx - 1)];
+        scm::math::vec3 pC_to_p1 = positions[ring_.slot(normal_idx + 1)] - positions[slot];
 
-            scm::math::vec3 plane_normal = scm::math::cross(p0_to_pC, pC_to_p1);
+        scm::math::vec3 plane_normal = scm::math::cross(p0_to_pC, pC_to_p1);
 
-            if(last_plane_normal_exists)
+        // the plane normal of the predecessor is kept when vertices are trimmed at the front,
+        // so the orientation may differ from a recomputation of the whole strip by its sign
+        if(normal_idx > 1)
+        {
+            if(scm::math::dot(plane_normals_[ring_.slot(normal_idx - 1)], plane_normal) < 0.0f)
             {
-                if(scm::math::dot(last_plane_normal, plane_normal) < 0.0f)
-                {
-                    plane_normal *= -1.0f;
-                }
+                plane_normal *= -1.0f;
             }
+        }
 
-            last_plane_normal_exists = true;
-            last_plane_normal = plane_normal;
+        plane_normals_[slot] = plane_normal;
 
-            scm::math::mat4f rot_mat = scm::math::make_rotation(90.0f, plane_normal);
+        scm::math::mat4f rot_mat = scm::math::make_rotation(90.0f, plane_normal);
 
-            scm::math::vec4 p0_to_p1 = scm::math::vec3(p0_to_pC + pC_to_p1, 0.0f);
+        scm::math::vec4 p0_to_p1 = scm::math::vec3(p0_to_pC + pC_to_p1, 0.0f);
 
-            scm::math::vec3 to_normalize = scm::math::vec3f(rot_mat * p0_to_p1);
-            if(scm::math::length(to_normalize) > 1e-6f)
-            {
-                scm::math::vec3f final_normal = scm::math::normalize(to_normalize);
-                normals[normal_idx] = final_normal;
-            }
-            else
-            {
-                normals[positions_size_minus_one] = scm::math::vec3f(0.0, 0.0, 1.0);
-            }
+        scm::math::vec3 to_normalize = scm::math::vec3f(rot_mat * p0_to_p1);
+        if(scm::math::length(to_normalize) > 1e-6f)
+        {
+            scm::math::vec3f final_normal = scm::math::normalize(to_normalize);
+            normals[slot] = final_normal;
+        }
+        else
+        {
+            normals[slot] = scm::math::vec3f(0.0, 0.0, 1.0);
         }
     }
+
+    ring_.touch(slot);
 }
 
 void LineStrip::compile_buffer_string(std::string& buffer_string)
@@ -168,13 +235,16 @@ void LineStrip::compile_buffer_string(std::string& buffer_string)
     uint64_t write_offset = 0;
     memcpy(&tmp_string[write_offset], &num_vertices_to_write, size_of_byte_count);
     write_offset += size_of_byte_count;
-    memcpy(&tmp_string[write_offset], &positions[0], size_of_positions);
-    write_offset += size_of_positions;
-    memcpy(&tmp_string[write_offset], &colors[0], size_of_colors);
-    write_offset += size_of_colors;
-    memcpy(&tmp_string[write_offset], &thicknesses[0], size_of_thicknesses);
-    write_offset += size_of_thicknesses;
-    memcpy(&tmp_string[write_offset], &normals[0], size_of_normals);
+
+    // the vertices may wrap around the end of the ring, they are written in order
+    for(unsigned vertex_id(0); vertex_id < num_vertices_to_write; ++vertex_id)
+    {
+        unsigned const slot = ring_.slot(vertex_id);
+        memcpy(&tmp_string[write_offset + vertex_id * sizeof(Vertex::pos)], &positions[slot], sizeof(Vertex::pos));
+        memcpy(&tmp_string[write_offset + size_of_positions + vertex_id * sizeof(Vertex::col)], &colors[slot], sizeof(Vertex::col));
+        memcpy(&tmp_string[write_offset + size_of_positions + size_of_colors + vertex_id * sizeof(Vertex::thick)], &thicknesses[slot], sizeof(Vertex::thick));
+        memcpy(&tmp_string[write_offset + size_of_positions + size_of_colors + size_of_thicknesses + vertex_id * sizeof(Vertex::nor)], &normals[slot], sizeof(Vertex::nor));
+    }
 
     buffer_string = tmp_string;
 }
@@ -195,43 +265,48 @@ void LineStrip::uncompile_buffer_string(std::string const& buffer_string)
         return;
     }
 
-    uint64_t currently_occupied_vertex_slots = 0;
-    int64_t newly_occupied_vertex_slots = currently_occupied_vertex_slots + num_vertices_written;
-
-    if(newly_occupied_vertex_slots > vertex_reservoir_size)
+    if(num_vertices_written > uint64_t(vertex_reservoir_size))
     {
-        positions.resize(newly_occupied_vertex_slots);
-        colors.resize(newly_occupied_vertex_slots);
-        thicknesses.resize(newly_occupied_vertex_slots);
-        normals.resize(newly_occupied_vertex_slots);
+        positions.resize(num_vertices_written);
+        colors.resize(num_vertices_written);
+        thicknesses.resize(num_vertices_written);
+        normals.resize(num_vertices_written);
+        plane_normals_.resize(num_vertices_written);
 
-        vertex_reservoir_size = newly_occupied_vertex_slots;
+        vertex_reservoir_size = num_vertices_written;
     }
 
     read_offset += sizeof(num_vertices_written);
-    memcpy(&positions[currently_occupied_vertex_slots], &buffer_string[read_offset], num_vertices_written * sizeof(Vertex::pos));
+    memcpy(&positions[0], &buffer_string[read_offset], num_vertices_written * sizeof(Vertex::pos));
     read_offset += num_vertices_written * sizeof(Vertex::pos);
-    memcpy(&colors[currently_occupied_vertex_slots], &buffer_string[read_offset], num_vertices_written * sizeof(Vertex::col));
+    memcpy(&colors[0], &buffer_string[read_offset], num_vertices_written * sizeof(Vertex::col));
     read_offset += num_vertices_written * sizeof(Vertex::col);
-    memcpy(&thicknesses[currently_occupied_vertex_slots], &buffer_string[read_offset], num_vertices_written * sizeof(Vertex::thick));
-    read_offset += num_vertices_written * sizeof(Vertex::nor);
-    memcpy(&normals[currently_occupied_vertex_slots], &buffer_string[read_offset], num_vertices_written * sizeof(Vertex::nor));
+    memcpy(&thicknesses[0], &buffer_string[read_offset], num_vertices_written * sizeof(Vertex::thick));
+    read_offset += num_vertices_written * sizeof(Vertex::thick);
+    memcpy(&normals[0], &buffer_string[read_offset], num_vertices_written * sizeof(Vertex::nor));
 
     num_occupied_vertex_slots = num_vertices_written;
+
+    ring_.reset(vertex_reservoir_size, num_occupied_vertex_slots, ring_.mirrored());
+    normals_dirty_from_ = 0;
 }
 
 bool LineStrip::push_vertex(Vertex const& v_to_push)
 {
-    if(num_occupied_vertex_slots >= vertex_reservoir_size)
+    if(ring_.full())
     {
         enlarge_reservoirs();
     }
 
-    positions[num_occupied_vertex_slots] = v_to_push.pos;
-    colors[num_occupied_vertex_slots] = v_to_push.col;
-    thicknesses[num_occupied_vertex_slots] = v_to_push.thick;
-    normals[num_occupied_vertex_slots] = v_to_push.nor;
-    ++num_occupied_vertex_slots;
+    unsigned const slot = ring_.push_back();
+    positions[slot] = v_to_push.pos;
+    colors[slot] = v_to_push.col;
+    thicknesses[slot] = v_to_push.thick;
+    normals[slot] = v_to_push.nor;
+    num_occupied_vertex_slots = ring_.size();
+
+    // the former last vertex gained a neighbour
+    normals_dirty_from_ = std::min(normals_dirty_from_, ring_.size() >= 2 ? ring_.size() - 2 : 0u);
     return true;
 }
 
@@ -242,12 +317,11 @@ bool LineStrip::pop_front_vertex()
         Logger::LOG_WARNING << "No LineStrip Vertex left to pop!" << std::endl;
         return false;
     }
-    positions.erase(positions.begin());
-    colors.erase(colors.begin());
-    thicknesses.erase(thicknesses.begin());
-    normals.erase(normals.begin());
+    ring_.pop_front();
+    num_occupied_vertex_slots = ring_.size();
 
-    --num_occupied_vertex_slots;
+    normals_dirty_from_ = normals_dirty_from_ > 0 ? normals_dirty_from_ - 1 : 0;
+    first_normal_dirty_ = true;
     return true;
 }
 
@@ -259,26 +333,23 @@ bool LineStrip::pop_back_vertex()
 
         return false;
     }
-    positions.pop_back();
-    colors.pop_back();
-    thicknesses.pop_back();
-    normals.pop_back();
+    ring_.pop_back();
+    num_occupied_vertex_slots = ring_.size();
 
-    --num_occupied_vertex_slots;
+    normals_dirty_from_ = std::min(normals_dirty_from_, ring_.size() - 1);
 
     return true;
 }
 
 bool LineStrip::clear_vertices()
 {
-    if(!num_occupied_vertex_slots == 0)
+    if(num_occupied_vertex_slots != 0)
     {
-        positions.clear();
-        colors.clear();
-        thicknesses.clear();
-        normals.clear();
-
+        // the slots are kept for the next vertices
+        ring_.reset(ring_.capacity(), 0, ring_.mirrored());
         num_occupied_vertex_slots = 0;
+        normals_dirty_from_ = 0;
+        first_normal_dirty_ = false;
 
         return true;
     }
@@ -294,34 +365,49 @@ void LineStrip::forward_queued_vertices(std::vector<scm::math::vec3f> const& que
     colors = queued_colors;
     thicknesses = queued_thicknesses;
     normals = queued_normals;
+    plane_normals_.resize(positions.size());
+
+    vertex_reservoir_size = num_occupied_vertex_slots = positions.size();
 
-    num_occupied_vertex_slots = positions.size();
+    ring_.reset(vertex_reservoir_size, num_occupied_vertex_slots, ring_.mirrored());
+    normals_dirty_from_ = 0;
+    first_normal_dirty_ = false;
+}
+
+bool LineStrip::compute_bounds(scm::math::vec3f& min, scm::math::vec3f& max) const
+{
+    float min_values[3];
+    float max_values[3];
 
-    if(num_occupied_vertex_slots > vertex_reservoir_size)
+    if(positions.empty() || !ring_.bounds(positions[0].data_array, min_values, max_values))
     {
-        vertex_reservoir_size = num_occupied_vertex_slots;
+        return false;
     }
+
+    min = scm::math::vec3f(min_values[0], min_values[1], min_values[2]);
+    max = scm::math::vec3f(max_values[0], max_values[1], max_values[2]);
+    return true;
 }
 
-void LineStrip::copy_to_buffer(Vertex* vertex_buffer) const
-{
-    vertex_buffer[0].pos = positions[0];
-    vertex_buffer[0].col = colors[0];
-    vertex_buffer[0].thick = thicknesses[0];
-    vertex_buffer[0].nor = normals[0];
+void LineStrip::copy_to_buffer(Vertex* vertex_buffer) const { copy_to_buffer(vertex_buffer, 0, ring_.image_size()); }
 
-    for(int vertex_id(0); vertex_id < num_occupied_vertex_slots; ++vertex_id)
+void LineStrip::copy_to_buffer(Vertex* vertex_buffer, unsigned image_begin, unsigned image_end) const
+{
+    if(positions.empty())
     {
-        vertex_buffer[vertex_id + 1].pos = positions[vertex_id];
-        vertex_buffer[vertex_id + 1].col = colors[vertex_id];
-        vertex_buffer[vertex_id + 1].thick = thicknesses[vertex_id];
-        vertex_buffer[vertex_id + 1].nor = normals[vertex_id];
+        return;
     }
 
-    vertex_buffer[num_occupied_vertex_slots + 1].pos = positions[num_occupied_vertex_slots - 1];
-    vertex_buffer[num_occupied_vertex_slots + 1].col = colors[num_occupied_vertex_slots - 1];
-    vertex_buffer[num_occupied_vertex_slots + 1].thick = thicknesses[num_occupied_vertex_slots - 1];
-    vertex_buffer[num_occupied_vertex_slots + 1].nor = normals[num_occupied_vertex_slots - 1];
+    for(unsigned image_slot(image_begin); image_slot < image_end; ++image_slot)
+    {
+        unsigned const slot = ring_.image_source(image_slot);
+        Vertex& vertex = vertex_buffer[image_slot - image_begin];
+
+        vertex.pos = positions[slot];
+        vertex.col = colors[slot];
+        vertex.thick = thicknesses[slot];
+        vertex.nor = normals[slot];
+    }
 }
 
 scm::gl::vertex_format LineStrip::get_vertex_format() const
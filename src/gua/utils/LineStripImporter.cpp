@@ -1,17 +1,46 @@
 // class header
 #include <gua/utils/LineStripImporter.hpp>
 // guacamole headers
+#include <gua/utils/BinaryCacheFile.hpp>
 #include <gua/utils/Logger.hpp>
+#include <gua/utils/MappedFile.hpp>
+#include <gua/utils/string_utils.hpp>
 #include <gua/utils/ToGua.hpp>
 // #include <gua/utils/Timer.hpp>
 
 // external headers
+#include <cstring>
 #include <iostream>
-#include <fstream>
-#include <sstream>
+#include <set>
 
 namespace gua
 {
+namespace
+{
+bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+char const* skip_blanks(char const* c, char const* line_end)
+{
+    while(c != line_end && is_blank(*c))
+    {
+        ++c;
+    }
+    return c;
+}
+
+// reads up to num_values floats, missing values are zero
+char const* parse_floats(char const* c, char const* line_end, float* values, int num_values)
+{
+    for(int i = 0; i < num_values; ++i)
+    {
+        values[i] = 0.0f;
+        c = skip_blanks(c, line_end);
+        c = string_utils::parse_float(c, line_end, values[i]);
+    }
+    return c;
+}
+} // namespace
+
 void LineStripImporter::create_empty_line(std::string const& empty_line_name)
 {
     parsing_successful_ = true;
@@ -23,162 +52,265 @@ void LineStripImporter::create_empty_line(std::string const& empty_line_name)
 void LineStripImporter::read_file(std::string const& file_name)
 {
     parsing_successful_ = false;
-    std::ifstream in_lob_file(file_name, std::ios::in);
+    MappedFile in_lob_file(file_name);
 
     if(!in_lob_file.is_open())
     {
         Logger::LOG_WARNING << "Could not open *.lob file for reading!" << std::endl;
+        return;
     }
 
-    std::string line_buffer("");
+    read_buffer(in_lob_file.data(), in_lob_file.size());
+}
+
+void LineStripImporter::read_buffer(char const* data, std::size_t size)
+{
+    parsing_successful_ = false;
+
+    // index instead of pointer, parsed_line_objects_ grows while parsing
+    std::size_t const first_object = parsed_line_objects_.size();
+    std::size_t current_object = first_object;
 
-    auto ltrim = [](std::string& string_to_trim) {
-        string_to_trim.erase(string_to_trim.begin(), std::find_if(string_to_trim.begin(), string_to_trim.end(), [](int ch) { return !std::isspace(ch); }));
+    auto current_line_object = [&]() -> LineObject& {
+        if(current_object == parsed_line_objects_.size())
+        {
+            // vertices before the first 'o' statement belong to an unnamed object
+            parsed_line_objects_.push_back(std::make_pair(std::string(""), LineObject()));
+            ++num_parsed_line_strips_;
+        }
+        return parsed_line_objects_[current_object].second;
     };
 
-    NamedLineObject* current_line_object = nullptr;
+    std::set<std::string> reported_prefixes;
+    bool reported_invalid_index = false;
 
-    std::vector<scm::math::vec3f> line_strip_positions;
+    char const* end = data + size;
+    char const* line_begin = data;
 
-    while(std::getline(in_lob_file, line_buffer))
+    while(line_begin < end)
     {
-        // trim whitespace to the left of the string
-        ltrim(line_buffer);
+        char const* line_end = static_cast<char const*>(std::memchr(line_begin, '\n', std::size_t(end - line_begin)));
+        if(!line_end)
+        {
+            line_end = end;
+        }
+
+        // trim whitespace to the left of the line
+        char const* c = skip_blanks(line_begin, line_end);
+        line_begin = line_end == end ? end : line_end + 1;
 
-        if(line_buffer.empty())
+        if(c == line_end || '#' == *c)
         {
             continue;
         }
 
-        std::istringstream in_sstream(line_buffer);
-        char line_prefix;
+        char const* prefix_begin = c;
+        char const* prefix_end = c;
+        while(prefix_end != line_end && !is_blank(*prefix_end))
+        {
+            ++prefix_end;
+        }
+
+        char const line_prefix = prefix_end - prefix_begin == 1 ? *prefix_begin : '\0';
+        c = prefix_end;
 
-        in_sstream >> line_prefix;
+        float float_attributes_to_parse[4];
 
+        switch(line_prefix)
+        {
         // create new object
-        if('o' == line_prefix)
+        case 'o':
         {
-            std::string new_object_name = "";
-
-            in_sstream >> new_object_name;
-            parsed_line_objects_.push_back(std::make_pair(new_object_name, LineObject()));
+            c = skip_blanks(c, line_end);
+            char const* name_end = c;
+            while(name_end != line_end && !is_blank(*name_end))
+            {
+                ++name_end;
+            }
 
-            current_line_object = &(parsed_line_objects_).back();
+            parsed_line_objects_.push_back(std::make_pair(std::string(c, name_end), LineObject()));
+            current_object = parsed_line_objects_.size() - 1;
 
             ++num_parsed_line_strips_;
+            break;
         }
-        else
-        {
-            float* float_attributes_to_parse = nullptr;
-            switch(line_prefix)
-            {
-            case 'v':
-                float_attributes_to_parse = new float[3];
-                for(int position_idx = 0; position_idx < 3; ++position_idx)
-                {
-                    in_sstream >> float_attributes_to_parse[position_idx];
-                }
-                current_line_object->second.vertex_position_database.emplace_back(float_attributes_to_parse[0], float_attributes_to_parse[1], float_attributes_to_parse[2]);
-                delete[] float_attributes_to_parse;
-                break;
 
-            case 'c':
-                float_attributes_to_parse = new float[4];
-                for(int color_idx = 0; color_idx < 4; ++color_idx)
-                {
-                    in_sstream >> float_attributes_to_parse[color_idx];
-                }
-                current_line_object->second.vertex_color_database.emplace_back(float_attributes_to_parse[0], float_attributes_to_parse[1], float_attributes_to_parse[2], float_attributes_to_parse[3]);
-                delete[] float_attributes_to_parse;
-                break;
+        case 'v':
+            parse_floats(c, line_end, float_attributes_to_parse, 3);
+            current_line_object().vertex_position_database.emplace_back(float_attributes_to_parse[0], float_attributes_to_parse[1], float_attributes_to_parse[2]);
+            break;
 
-            case 't':
-                float_attributes_to_parse = new float;
-                in_sstream >> float_attributes_to_parse[0];
+        case 'c':
+            parse_floats(c, line_end, float_attributes_to_parse, 4);
+            current_line_object().vertex_color_database.emplace_back(float_attributes_to_parse[0], float_attributes_to_parse[1], float_attributes_to_parse[2], float_attributes_to_parse[3]);
+            break;
 
-                current_line_object->second.vertex_thickness_database.emplace_back(float_attributes_to_parse[0]);
-                delete float_attributes_to_parse;
-                break;
+        case 't':
+            parse_floats(c, line_end, float_attributes_to_parse, 1);
+            current_line_object().vertex_thickness_database.emplace_back(float_attributes_to_parse[0]);
+            break;
 
-            case 'n':
-                float_attributes_to_parse = new float[3];
-                for(int normal_idx = 0; normal_idx < 3; ++normal_idx)
-                {
-                    in_sstream >> float_attributes_to_parse[normal_idx];
-                }
-                current_line_object->second.vertex_normal_database.emplace_back(float_attributes_to_parse[0], float_attributes_to_parse[1], float_attributes_to_parse[2]);
-                delete[] float_attributes_to_parse;
-                break;
+        case 'n':
+            parse_floats(c, line_end, float_attributes_to_parse, 3);
+            current_line_object().vertex_normal_database.emplace_back(float_attributes_to_parse[0], float_attributes_to_parse[1], float_attributes_to_parse[2]);
+            break;
 
-            case 's':
+        case 's':
+            if(reported_prefixes.insert("s").second)
+            {
                 Logger::LOG_WARNING << "*.lob-parser option 's' is not implemented yet" << std::endl;
-                break;
+            }
+            break;
+
+        case 'g':
+            // Ignore g-tag for now
+            break;
 
-            case 'g':
-                // Ignore g-tag for now
-                break;
-            // lines to be interpreted as GL_LINES and need to duplicate_vertices
-            case 'l':
+        // lines to be interpreted as GL_LINES, consecutive indices form segments sharing their vertices
+        case 'l':
+        {
+            LineObject& line_object = current_line_object();
+            int const num_vertices = int(line_object.vertex_position_database.size());
+            int previous_index = -1;
+
+            while(true)
             {
+                c = skip_blanks(c, line_end);
+
                 int currently_read_idx = 0;
+                char const* index_end = string_utils::parse_int(c, line_end, currently_read_idx);
+                if(index_end == c)
+                {
+                    break;
+                }
 
-                std::vector<int> parsed_indices;
-                while(!in_sstream.eof())
+                // skip texture coordinate and normal indices of v/vt/vn references
+                c = index_end;
+                while(c != line_end && !is_blank(*c))
                 {
-                    in_sstream >> currently_read_idx;
-                    parsed_indices.push_back(currently_read_idx - 1);
+                    ++c;
                 }
 
-                for(unsigned int vertex_idx = 0; vertex_idx < parsed_indices.size() - 2; ++vertex_idx)
+                int const vertex_idx = currently_read_idx < 0 ? num_vertices + currently_read_idx : currently_read_idx - 1;
+                if(vertex_idx < 0 || vertex_idx >= num_vertices)
                 {
-                    int read_index_start = parsed_indices[vertex_idx];
-                    int read_index_end = parsed_indices[vertex_idx + 1];
-                    auto read_vertex_pos_start = current_line_object->second.vertex_position_database[read_index_start];
-                    line_strip_positions.push_back(read_vertex_pos_start);
-                    auto read_vertex_pos_end = current_line_object->second.vertex_position_database[read_index_end];
-                    line_strip_positions.push_back(read_vertex_pos_end);
+                    if(!reported_invalid_index)
+                    {
+                        Logger::LOG_WARNING << "*.lob-parser: ignoring segments with invalid vertex index " << currently_read_idx << std::endl;
+                        reported_invalid_index = true;
+                    }
+                    previous_index = -1;
+                    continue;
                 }
-                break;
 
-                break;
+                if(previous_index >= 0)
+                {
+                    line_object.line_indices.push_back(unsigned(previous_index));
+                    line_object.line_indices.push_back(unsigned(vertex_idx));
+                }
+                previous_index = vertex_idx;
             }
-            default:
-                Logger::LOG_WARNING << "Unknown *.line-parser option " << line_prefix << std::endl;
+            break;
+        }
+
+        default:
+            if(reported_prefixes.insert(std::string(prefix_begin, prefix_end)).second)
+            {
+                Logger::LOG_WARNING << "Unknown *.line-parser option " << std::string(prefix_begin, prefix_end) << std::endl;
             }
+            break;
         }
     }
 
-    if(!line_strip_positions.empty())
+    for(std::size_t object_idx = first_object; object_idx < parsed_line_objects_.size(); ++object_idx)
     {
-        std::swap(line_strip_positions, current_line_object->second.vertex_position_database);
-        line_strip_positions.clear();
-    }
+        LineObject& current_line_object = parsed_line_objects_[object_idx].second;
 
-    for(auto& current_line_object : parsed_line_objects_)
-    {
-        if(current_line_object.second.vertex_position_database.size() > current_line_object.second.vertex_color_database.size())
+        if(current_line_object.vertex_position_database.size() > current_line_object.vertex_color_database.size())
+        {
+            current_line_object.vertex_color_database.resize(current_line_object.vertex_position_database.size(), scm::math::vec4(1.0f, 0.0f, 0.0f, 1.0f));
+        }
+
+        if(current_line_object.vertex_position_database.size() > current_line_object.vertex_thickness_database.size())
         {
-            current_line_object.second.vertex_color_database.resize(current_line_object.second.vertex_position_database.size(), scm::math::vec4(1.0f, 0.0f, 0.0f, 1.0f));
+            current_line_object.vertex_thickness_database.resize(current_line_object.vertex_position_database.size(), 1.0f);
         }
 
-        if(current_line_object.second.vertex_position_database.size() > current_line_object.second.vertex_thickness_database.size())
+        if(current_line_object.vertex_position_database.size() > current_line_object.vertex_normal_database.size())
         {
-            current_line_object.second.vertex_thickness_database.resize(current_line_object.second.vertex_position_database.size(), 1.0f);
+            current_line_object.vertex_normal_database.resize(current_line_object.vertex_position_database.size(), scm::math::vec3(0.0f, 1.0f, 0.0f));
         }
+    }
+
+    parsing_successful_ = true;
+}
+
+bool LineStripImporter::save_cache(std::string const& cache_file_name, uint64_t source_key) const
+{
+    BinaryCacheFile cache(CACHE_VERSION, source_key);
+
+    // object names, each one terminated by '\0'
+    std::vector<char> names;
+    for(std::size_t object_idx = 0; object_idx < parsed_line_objects_.size(); ++object_idx)
+    {
+        auto const& named_object = parsed_line_objects_[object_idx];
+        names.insert(names.end(), named_object.first.begin(), named_object.first.end());
+        names.push_back('\0');
+
+        std::string const prefix(std::to_string(object_idx) + ".");
+        cache.set(prefix + "positions", named_object.second.vertex_position_database);
+        cache.set(prefix + "colors", named_object.second.vertex_color_database);
+        cache.set(prefix + "thicknesses", named_object.second.vertex_thickness_database);
+        cache.set(prefix + "normals", named_object.second.vertex_normal_database);
+        cache.set(prefix + "line_indices", named_object.second.line_indices);
+    }
+    cache.set("names", names);
+
+    return cache.save(cache_file_name);
+}
+
+bool LineStripImporter::load_cache(std::string const& cache_file_name, uint64_t source_key)
+{
+    BinaryCacheFile cache(CACHE_VERSION, source_key);
+    std::vector<char> names;
+
+    if(!cache.load(cache_file_name) || !cache.get("names", names))
+    {
+        return false;
+    }
+
+    std::vector<NamedLineObject> line_objects;
+    std::size_t name_begin = 0;
+    for(std::size_t i = 0; i < names.size(); ++i)
+    {
+        if(names[i] != '\0')
+        {
+            continue;
+        }
+
+        line_objects.push_back(std::make_pair(std::string(names.data() + name_begin, names.data() + i), LineObject(0)));
+        name_begin = i + 1;
 
-        if(current_line_object.second.vertex_position_database.size() > current_line_object.second.vertex_normal_database.size())
+        LineObject& line_object = line_objects.back().second;
+        std::string const prefix(std::to_string(line_objects.size() - 1) + ".");
+        if(!cache.get(prefix + "positions", line_object.vertex_position_database) || !cache.get(prefix + "colors", line_object.vertex_color_database) ||
+           !cache.get(prefix + "thicknesses", line_object.vertex_thickness_database) || !cache.get(prefix + "normals", line_object.vertex_normal_database) ||
+           !cache.get(prefix + "line_indices", line_object.line_indices))
         {
-            current_line_object.second.vertex_normal_database.resize(current_line_object.second.vertex_position_database.size(), scm::math::vec3(0.0f, 1.0f, 0.0f));
+            return false;
         }
     }
 
+    parsed_line_objects_.swap(line_objects);
+    num_parsed_line_strips_ = int(parsed_line_objects_.size());
     parsing_successful_ = true;
+    return true;
 }
 
 bool LineStripImporter::parsing_successful() const { return parsing_successful_; }
 
 int LineStripImporter::num_parsed_line_strips() const { return num_parsed_line_strips_; }
 
-NamedLineObject LineStripImporter::parsed_line_object_at(int line_object_index) const { return parsed_line_objects_[line_object_index]; }
+NamedLineObject const& LineStripImporter::parsed_line_object_at(int line_object_index) const { return parsed_line_objects_[line_object_index]; }
 
-} // namespace gua
\ No newline at end of file
+} // namespace gua
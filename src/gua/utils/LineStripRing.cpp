@@ -0,0 +1,276 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+// class header
+#include <gua/utils/LineStripRing.hpp>
+
+// external headers
+#include <algorithm>
+
+namespace gua
+{
+////////////////////////////////////////////////////////////////////////////////
+
+LineStripRing::LineStripRing(unsigned capacity, bool mirrored) : capacity_(0), first_(0), size_(0), mirrored_(mirrored), dirty_ranges_(), block_bounds_() { reset(capacity, 0, mirrored); }
+
+////////////////////////////////////////////////////////////////////////////////
+
+void LineStripRing::reset(unsigned capacity, unsigned size, bool mirrored)
+{
+    capacity_ = capacity;
+    first_ = 0;
+    size_ = std::min(size, capacity);
+    mirrored_ = mirrored;
+
+    dirty_ranges_.assign(1, Range{0, image_size()});
+    block_bounds_.assign((capacity_ + BOUNDS_BLOCK_SIZE - 1) / BOUNDS_BLOCK_SIZE, BlockBounds());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool LineStripRing::full() const { return mirrored_ ? size_ == capacity_ : first_ + size_ == capacity_; }
+
+////////////////////////////////////////////////////////////////////////////////
+
+unsigned LineStripRing::image_source(unsigned image_slot) const
+{
+    if(size_ > 0 && image_slot == first_)
+    {
+        return slot(0);
+    }
+
+    if(size_ > 0 && image_slot == first_ + size_ + 1)
+    {
+        return slot(size_ - 1);
+    }
+
+    // slots outside of the drawn window keep the vertex of their ring slot as well
+    return image_slot == 0 || capacity_ == 0 ? 0 : (image_slot - 1) % capacity_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+unsigned LineStripRing::push_back()
+{
+    unsigned const ring_slot(slot(size_));
+    ++size_;
+
+    // the former end cap is covered by the slots of the new vertex
+    add_dirty_slot(ring_slot);
+    add_dirty_caps();
+    invalidate_block(ring_slot);
+
+    return ring_slot;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void LineStripRing::pop_front()
+{
+    if(size_ == 0)
+    {
+        return;
+    }
+
+    invalidate_block(slot(0));
+    add_dirty_caps();
+
+    --size_;
+    first_ = size_ == 0 || (mirrored_ && first_ + 1 == capacity_) ? 0 : first_ + 1;
+
+    add_dirty_caps();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void LineStripRing::pop_back()
+{
+    if(size_ == 0)
+    {
+        return;
+    }
+
+    invalidate_block(slot(size_ - 1));
+    add_dirty_caps();
+
+    --size_;
+    if(size_ == 0)
+    {
+        first_ = 0;
+    }
+
+    add_dirty_caps();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void LineStripRing::touch(unsigned ring_slot)
+{
+    add_dirty_slot(ring_slot);
+    add_dirty_caps();
+    invalidate_block(ring_slot);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<LineStripRing::Range> LineStripRing::take_dirty_ranges()
+{
+    merge_ranges(dirty_ranges_);
+
+    std::vector<Range> ranges;
+    ranges.swap(dirty_ranges_);
+    return ranges;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void LineStripRing::merge_ranges(std::vector<Range>& ranges)
+{
+    if(ranges.empty())
+    {
+        return;
+    }
+
+    std::sort(ranges.begin(), ranges.end(), [](Range const& a, Range const& b) { return a.begin < b.begin; });
+
+    std::size_t merged(0);
+    for(std::size_t i = 1; i < ranges.size(); ++i)
+    {
+        if(ranges[i].begin <= ranges[merged].end)
+        {
+            ranges[merged].end = std::max(ranges[merged].end, ranges[i].end);
+        }
+        else
+        {
+            ranges[++merged] = ranges[i];
+        }
+    }
+    ranges.resize(merged + 1);
+
+    // close the smallest gaps first
+    while(ranges.size() > MAX_DIRTY_RANGES)
+    {
+        std::size_t smallest_gap(0);
+        for(std::size_t i = 1; i + 1 < ranges.size(); ++i)
+        {
+            if(ranges[i + 1].begin - ranges[i].end < ranges[smallest_gap + 1].begin - ranges[smallest_gap].end)
+            {
+                smallest_gap = i;
+            }
+        }
+
+        ranges[smallest_gap].end = ranges[smallest_gap + 1].end;
+        ranges.erase(ranges.begin() + smallest_gap + 1);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool LineStripRing::bounds(float const* positions, float* min, float* max) const
+{
+    bool found(false);
+
+    for(std::size_t block = 0; block < block_bounds_.size(); ++block)
+    {
+        BlockBounds& bounds(block_bounds_[block]);
+
+        if(!bounds.valid)
+        {
+            bounds.valid = true;
+            bounds.empty = true;
+
+            unsigned const end(std::min(capacity_, unsigned(block + 1) * BOUNDS_BLOCK_SIZE));
+            for(unsigned ring_slot = unsigned(block) * BOUNDS_BLOCK_SIZE; ring_slot < end; ++ring_slot)
+            {
+                if(!occupied(ring_slot))
+                {
+                    continue;
+                }
+
+                float const* position(positions + 3 * std::size_t(ring_slot));
+                for(int axis = 0; axis < 3; ++axis)
+                {
+                    bounds.min[axis] = bounds.empty ? position[axis] : std::min(bounds.min[axis], position[axis]);
+                    bounds.max[axis] = bounds.empty ? position[axis] : std::max(bounds.max[axis], position[axis]);
+                }
+                bounds.empty = false;
+            }
+        }
+
+        if(!bounds.empty)
+        {
+            for(int axis = 0; axis < 3; ++axis)
+            {
+                min[axis] = found ? std::min(min[axis], bounds.min[axis]) : bounds.min[axis];
+                max[axis] = found ? std::max(max[axis], bounds.max[axis]) : bounds.max[axis];
+            }
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool LineStripRing::occupied(unsigned ring_slot) const { return size_ > 0 && (ring_slot + capacity_ - first_) % capacity_ < size_; }
+
+////////////////////////////////////////////////////////////////////////////////
+
+void LineStripRing::add_dirty(unsigned begin, unsigned end)
+{
+    end = std::min(end, image_size());
+    if(begin >= end)
+    {
+        return;
+    }
+
+    dirty_ranges_.push_back(Range{begin, end});
+
+    // many small changes between two uploads, e.g. a burst of pushed vertices
+    if(dirty_ranges_.size() > 16 * MAX_DIRTY_RANGES)
+    {
+        merge_ranges(dirty_ranges_);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void LineStripRing::add_dirty_slot(unsigned ring_slot)
+{
+    add_dirty(ring_slot + 1, ring_slot + 2);
+    if(mirrored_)
+    {
+        add_dirty(ring_slot + 1 + capacity_, ring_slot + 2 + capacity_);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void LineStripRing::add_dirty_caps()
+{
+    add_dirty(first_, first_ + 1);
+    add_dirty(first_ + size_ + 1, first_ + size_ + 2);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace gua
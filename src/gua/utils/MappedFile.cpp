@@ -0,0 +1,125 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+// class header
+#include <gua/utils/MappedFile.hpp>
+
+// external headers
+#include <fstream>
+
+#if GUA_PLATFORM != GUA_PLATFORM_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gua
+{
+////////////////////////////////////////////////////////////////////////////////
+
+MappedFile::MappedFile(std::string const& file_name) { open(file_name); }
+
+////////////////////////////////////////////////////////////////////////////////
+
+MappedFile::~MappedFile() { close(); }
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool MappedFile::open(std::string const& file_name)
+{
+    close();
+
+#if GUA_PLATFORM != GUA_PLATFORM_WINDOWS
+    int const descriptor(::open(file_name.c_str(), O_RDONLY));
+    if(descriptor < 0)
+    {
+        return false;
+    }
+
+    struct stat status;
+    if(::fstat(descriptor, &status) == 0 && S_ISREG(status.st_mode))
+    {
+        if(status.st_size == 0)
+        {
+            // mmap fails for empty files
+            ::close(descriptor);
+            is_open_ = true;
+            return true;
+        }
+
+        void* mapping(::mmap(nullptr, std::size_t(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0));
+        if(mapping != MAP_FAILED)
+        {
+            ::madvise(mapping, std::size_t(status.st_size), MADV_SEQUENTIAL);
+            ::close(descriptor);
+
+            mapping_ = mapping;
+            data_ = static_cast<char const*>(mapping);
+            size_ = std::size_t(status.st_size);
+            is_open_ = true;
+            return true;
+        }
+    }
+    ::close(descriptor);
+#endif
+
+    std::ifstream file(file_name, std::ios::binary | std::ios::ate);
+    if(!file)
+    {
+        return false;
+    }
+
+    buffer_.resize(std::size_t(file.tellg()));
+    file.seekg(0);
+    if(!buffer_.empty() && !file.read(buffer_.data(), buffer_.size()))
+    {
+        buffer_.clear();
+        return false;
+    }
+
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+    is_open_ = true;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MappedFile::close()
+{
+#if GUA_PLATFORM != GUA_PLATFORM_WINDOWS
+    if(mapping_)
+    {
+        ::munmap(mapping_, size_);
+    }
+#endif
+
+    mapping_ = nullptr;
+    std::vector<char>().swap(buffer_);
+    data_ = nullptr;
+    size_ = 0;
+    is_open_ = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace gua
@@ -0,0 +1,171 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+
+// class header
+#include <gua/utils/MessagePlayer.hpp>
+
+// external headers
+#include <cstdlib>
+
+namespace gua
+{
+////////////////////////////////////////////////////////////////////////////////
+
+MessagePlayer::MessagePlayer(std::shared_ptr<MessageRecording const> const& recording, float speed, bool loop) : recording_(recording), loop_(loop), speed_(speed) {}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool MessagePlayer::next(MessageRecording::Message& message)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if(stopped_ || !recording_ || recording_->get_num_messages() == 0)
+    {
+        return false;
+    }
+
+    if(position_ >= recording_->get_num_messages())
+    {
+        if(!loop_)
+        {
+            return false;
+        }
+
+        if(speed_ > 0.f)
+        {
+            uint64_t duration(recording_->get_duration());
+
+            // without recorded intervals there is nothing to pace, the loop
+            // would hand out the same messages as fast as they are requested
+            if(duration == 0)
+            {
+                stopped_condition_.wait(lock, [this]() { return stopped_; });
+                return false;
+            }
+
+            // the first message follows the last one after the mean interval
+            if(!needs_sync_)
+            {
+                uint64_t first_timestamp(recording_->get_message(0).timestamp);
+                uint64_t loop_end(first_timestamp + duration + duration / (recording_->get_num_messages() - 1));
+
+                sync_time_ += std::chrono::microseconds(static_cast<int64_t>((loop_end - sync_timestamp_) / speed_));
+                sync_timestamp_ = first_timestamp;
+            }
+        }
+        else
+        {
+            needs_sync_ = true;
+        }
+
+        position_ = 0;
+    }
+
+    message = recording_->get_message(position_);
+
+    if(needs_sync_)
+    {
+        sync_time_ = std::chrono::steady_clock::now();
+        sync_timestamp_ = message.timestamp;
+        needs_sync_ = false;
+    }
+    else if(speed_ > 0.f && message.timestamp >= sync_timestamp_)
+    {
+        auto delay(std::chrono::microseconds(static_cast<int64_t>((message.timestamp - sync_timestamp_) / speed_)));
+
+        if(stopped_condition_.wait_until(lock, sync_time_ + delay, [this]() { return stopped_; }))
+        {
+            return false;
+        }
+    }
+
+    ++position_;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MessagePlayer::seek(uint64_t timestamp)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(recording_)
+    {
+        position_ = recording_->find_message(timestamp);
+        needs_sync_ = true;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MessagePlayer::set_speed(float speed)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    speed_ = speed;
+    needs_sync_ = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+float MessagePlayer::get_speed() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return speed_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MessagePlayer::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+    }
+    stopped_condition_.notify_all();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool MessagePlayer::parse_endpoint(std::string const& endpoint, std::string& filename, float& speed)
+{
+    std::string const scheme("file://");
+
+    if(endpoint.compare(0, scheme.size(), scheme) != 0)
+    {
+        return false;
+    }
+
+    filename = endpoint.substr(scheme.size());
+    speed = 1.f;
+
+    auto query(filename.find("?speed="));
+    if(query != std::string::npos)
+    {
+        speed = static_cast<float>(std::atof(filename.c_str() + query + 7));
+        filename.erase(query);
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace gua
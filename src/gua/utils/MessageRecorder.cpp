@@ -0,0 +1,234 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+
+// class header
+#include <gua/utils/MessageRecorder.hpp>
+
+// guacamole headers
+#include <gua/utils/Logger.hpp>
+
+namespace gua
+{
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+// keeps the storage of a few messages around for the next ones
+std::size_t const MAX_SPARE_BUFFERS = 4;
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+MessageRecorder::~MessageRecorder() { close(); }
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool MessageRecorder::open(std::string const& filename)
+{
+    close();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    file_.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if(!file_.good())
+    {
+        Logger::LOG_WARNING << "Failed to open \"" << filename << "\" for recording." << std::endl;
+        file_.close();
+        return false;
+    }
+
+    MessageRecording::FileHeader header;
+    file_.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+    index_.clear();
+    offset_ = sizeof(header);
+    num_messages_ = 0;
+    started_ = false;
+    open_ = true;
+
+    writer_ = std::thread(&MessageRecorder::write_loop, this);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool MessageRecorder::is_open() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return open_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MessageRecorder::write(void const* data, std::size_t size)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    auto now(std::chrono::steady_clock::now());
+
+    if(!started_)
+    {
+        start_ = now;
+        started_ = true;
+    }
+
+    enqueue(data, size, std::chrono::duration_cast<std::chrono::microseconds>(now - start_).count(), lock);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MessageRecorder::write(void const* data, std::size_t size, uint64_t timestamp)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    enqueue(data, size, timestamp, lock);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MessageRecorder::close()
+{
+    std::thread writer;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if(!open_)
+        {
+            return;
+        }
+
+        open_ = false;
+        writer.swap(writer_);
+    }
+    message_available_.notify_all();
+
+    // the writer returns once the queue is empty
+    writer.join();
+
+    MessageRecording::FileFooter footer;
+    footer.index_offset = offset_;
+    footer.num_messages = index_.size();
+
+    file_.write(reinterpret_cast<char const*>(index_.data()), index_.size() * sizeof(MessageRecording::IndexEntry));
+    file_.write(reinterpret_cast<char const*>(&footer), sizeof(footer));
+    file_.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::size_t MessageRecorder::get_num_messages() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_messages_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MessageRecorder::enqueue(void const* data, std::size_t size, uint64_t timestamp, std::unique_lock<std::mutex>& lock)
+{
+    if(!open_)
+    {
+        return;
+    }
+
+    PendingMessage message;
+    message.timestamp = timestamp;
+
+    if(!spare_buffers_.empty())
+    {
+        message.data.swap(spare_buffers_.back());
+        spare_buffers_.pop_back();
+    }
+
+    // the copy does not need to block the writer
+    lock.unlock();
+    message.data.assign(static_cast<char const*>(data), static_cast<char const*>(data) + size);
+    lock.lock();
+
+    if(!open_)
+    {
+        return;
+    }
+
+    queue_.push_back(std::move(message));
+    ++num_messages_;
+
+    lock.unlock();
+    message_available_.notify_one();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MessageRecorder::write_loop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while(true)
+    {
+        message_available_.wait(lock, [this]() { return !open_ || !queue_.empty(); });
+
+        if(queue_.empty())
+        {
+            return;
+        }
+
+        PendingMessage message(std::move(queue_.front()));
+        queue_.pop_front();
+
+        lock.unlock();
+        write_to_file(message);
+        lock.lock();
+
+        if(spare_buffers_.size() < MAX_SPARE_BUFFERS)
+        {
+            spare_buffers_.push_back(std::move(message.data));
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MessageRecorder::write_to_file(PendingMessage const& message)
+{
+    MessageRecording::RecordHeader record;
+    record.timestamp = message.timestamp;
+    record.size = message.data.size();
+
+    static const char padding[8] = {0};
+    std::size_t padded_size(MessageRecording::padded_size(message.data.size()));
+
+    file_.write(reinterpret_cast<char const*>(&record), sizeof(record));
+    file_.write(message.data.data(), message.data.size());
+    file_.write(padding, padded_size - message.data.size());
+
+    MessageRecording::IndexEntry entry;
+    entry.timestamp = message.timestamp;
+    entry.offset = offset_ + sizeof(record);
+    entry.size = message.data.size();
+    index_.push_back(entry);
+
+    offset_ += sizeof(record) + padded_size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace gua
@@ -0,0 +1,173 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+
+// class header
+#include <gua/utils/MessageRecording.hpp>
+
+// guacamole headers
+#include <gua/utils/Logger.hpp>
+
+// external headers
+#include <algorithm>
+#include <cstring>
+
+namespace gua
+{
+////////////////////////////////////////////////////////////////////////////////
+
+MessageRecording::MessageRecording(std::string const& filename)
+{
+    try
+    {
+        file_ = boost::interprocess::file_mapping(filename.c_str(), boost::interprocess::read_only);
+        region_ = boost::interprocess::mapped_region(file_, boost::interprocess::read_only);
+    }
+    catch(boost::interprocess::interprocess_exception const& e)
+    {
+        Logger::LOG_WARNING << "Failed to map recording \"" << filename << "\": " << e.what() << std::endl;
+        return;
+    }
+
+    auto begin(static_cast<uint8_t const*>(region_.get_address()));
+    std::size_t size(region_.get_size());
+
+    FileHeader expected;
+    FileHeader header;
+
+    if(size < sizeof(FileHeader))
+    {
+        Logger::LOG_WARNING << "\"" << filename << "\" is no message recording." << std::endl;
+        return;
+    }
+
+    std::memcpy(&header, begin, sizeof(FileHeader));
+
+    if(std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.version != VERSION)
+    {
+        Logger::LOG_WARNING << "\"" << filename << "\" is no message recording of version " << VERSION << "." << std::endl;
+        return;
+    }
+
+    if(!read_index(begin, size))
+    {
+        Logger::LOG_WARNING << "Recording \"" << filename << "\" has no index, scanning it." << std::endl;
+        scan_records(begin, size);
+    }
+
+    valid_ = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+MessageRecording::Message MessageRecording::get_message(std::size_t index) const
+{
+    Message message;
+    if(index < index_.size())
+    {
+        message.timestamp = index_[index].timestamp;
+        message.data = static_cast<uint8_t const*>(region_.get_address()) + index_[index].offset;
+        message.size = index_[index].size;
+    }
+    return message;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::size_t MessageRecording::find_message(uint64_t timestamp) const
+{
+    auto it(std::lower_bound(index_.begin(), index_.end(), timestamp, [](IndexEntry const& entry, uint64_t t) { return entry.timestamp < t; }));
+    return it - index_.begin();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t MessageRecording::get_duration() const { return index_.empty() ? 0 : index_.back().timestamp - index_.front().timestamp; }
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool MessageRecording::read_index(uint8_t const* begin, std::size_t size)
+{
+    if(size < sizeof(FileHeader) + sizeof(FileFooter))
+    {
+        return false;
+    }
+
+    FileFooter expected;
+    FileFooter footer;
+    std::memcpy(&footer, begin + size - sizeof(FileFooter), sizeof(FileFooter));
+
+    if(std::memcmp(footer.magic, expected.magic, sizeof(footer.magic)) != 0 || footer.index_offset > size - sizeof(FileFooter) ||
+       footer.num_messages != (size - sizeof(FileFooter) - footer.index_offset) / sizeof(IndexEntry))
+    {
+        return false;
+    }
+
+    index_.resize(footer.num_messages);
+    std::memcpy(index_.data(), begin + footer.index_offset, index_.size() * sizeof(IndexEntry));
+
+    for(auto const& entry : index_)
+    {
+        if(entry.offset > footer.index_offset || entry.size > footer.index_offset - entry.offset)
+        {
+            index_.clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool MessageRecording::scan_records(uint8_t const* begin, std::size_t size)
+{
+    index_.clear();
+
+    std::size_t offset(sizeof(FileHeader));
+
+    while(offset + sizeof(RecordHeader) <= size)
+    {
+        RecordHeader record;
+        std::memcpy(&record, begin + offset, sizeof(RecordHeader));
+        offset += sizeof(RecordHeader);
+
+        // a truncated last message is dropped
+        if(record.size > size - offset)
+        {
+            break;
+        }
+
+        IndexEntry entry;
+        entry.timestamp = record.timestamp;
+        entry.offset = offset;
+        entry.size = record.size;
+        index_.push_back(entry);
+
+        offset += padded_size(record.size);
+    }
+
+    return !index_.empty();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace gua
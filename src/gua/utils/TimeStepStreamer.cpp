@@ -0,0 +1,464 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+// class header
+#include <gua/utils/TimeStepStreamer.hpp>
+
+// guacamole headers
+#include <gua/utils/Logger.hpp>
+
+// external headers
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace gua
+{
+////////////////////////////////////////////////////////////////////////////////
+
+TimeStepLoaderPool::TimeStepLoaderPool(unsigned num_threads)
+{
+    for(unsigned t(0); t < std::max(1u, num_threads); ++t)
+    {
+        threads_.push_back(std::thread([this]() { work(); }));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TimeStepLoaderPool::~TimeStepLoaderPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    changed_.notify_all();
+
+    for(auto& thread : threads_)
+    {
+        thread.join();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void TimeStepLoaderPool::attach(TimeStepStreamer* streamer)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        streamers_[streamer] = 0;
+    }
+    changed_.notify_all();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void TimeStepLoaderPool::detach(TimeStepStreamer* streamer)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    load_finished_.wait(lock, [this, streamer]() { return streamers_[streamer] == 0; });
+    streamers_.erase(streamer);
+
+    if(last_served_ == streamer)
+    {
+        last_served_ = nullptr;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void TimeStepLoaderPool::notify()
+{
+    // the threads check for work while holding the lock, so no change goes unnoticed
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    changed_.notify_all();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void TimeStepLoaderPool::work()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while(running_)
+    {
+        // round robin, starting after the streamer served last
+        auto it(streamers_.upper_bound(last_served_));
+        TimeStepStreamer* streamer(nullptr);
+        std::size_t step(0);
+
+        for(std::size_t i(0); i < streamers_.size(); ++i, ++it)
+        {
+            if(it == streamers_.end())
+            {
+                it = streamers_.begin();
+            }
+
+            if(it->first->begin_prefetch(step))
+            {
+                streamer = it->first;
+                break;
+            }
+        }
+
+        if(!streamer)
+        {
+            // no timeout: the windows only move in set_playback(), which notifies
+            changed_.wait(lock);
+            continue;
+        }
+
+        last_served_ = streamer;
+        ++it->second;
+        lock.unlock();
+        streamer->end_prefetch(step, streamer->load(step));
+        lock.lock();
+        --streamers_[streamer];
+        load_finished_.notify_all();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TimeStepStreamer::TimeStepStreamer(
+    std::vector<std::string> const& files, std::size_t step_size, std::size_t memory_budget, std::shared_ptr<TimeStepLoaderPool> const& loaders, std::size_t file_size)
+    : files_(files), step_size_(step_size), file_size_(file_size > 0 ? file_size : step_size),
+      window_size_(std::max(std::size_t(1), memory_budget / std::max(std::size_t(1), step_size))), loaders_(loaders)
+{
+    if(!loaders_)
+    {
+        loaders_ = std::make_shared<TimeStepLoaderPool>(1);
+    }
+
+    loaders_->attach(this);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TimeStepStreamer::~TimeStepStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    loaded_.notify_all();
+
+    loaders_->detach(this);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void TimeStepStreamer::set_playback(float cursor, float steps_per_second)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        bool window_moved(std::floor(cursor) != std::floor(cursor_) || (steps_per_second > 0.f) != (speed_ > 0.f) || (steps_per_second < 0.f) != (speed_ < 0.f));
+        cursor_ = cursor;
+        speed_ = steps_per_second;
+
+        if(!window_moved)
+        {
+            return;
+        }
+        idle_ = false;
+    }
+    loaders_->notify();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TimeStepStreamer::Step TimeStepStreamer::get_step(std::size_t step)
+{
+    if(step >= files_.size())
+    {
+        return nullptr;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    auto it(resident_.find(step));
+    if(it != resident_.end())
+    {
+        ++statistics_.hits;
+        return it->second;
+    }
+
+    ++statistics_.misses;
+
+    while(running_)
+    {
+        it = resident_.find(step);
+        if(it != resident_.end())
+        {
+            return it->second;
+        }
+
+        // loaded by the prefetcher or another thread right now, or no room left
+        if(loading_.count(step) > 0 || (resident_.size() + loading_.size() >= window_size_ && !evict_one(step, false)))
+        {
+            loaded_.wait(lock);
+            continue;
+        }
+
+        loading_.insert(step);
+        lock.unlock();
+        auto data(load(step));
+        lock.lock();
+        loading_.erase(step);
+        insert(step, data);
+
+        lock.unlock();
+        loaded_.notify_all();
+        loaders_->notify();
+        return data;
+    }
+
+    return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TimeStepStreamer::Step TimeStepStreamer::try_get_step(std::size_t step)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it(resident_.find(step));
+    if(it != resident_.end())
+    {
+        ++statistics_.hits;
+        last_missed_step_ = std::numeric_limits<std::size_t>::max();
+        return it->second;
+    }
+
+    // callers poll until the step arrives, count that as a single miss
+    if(step != last_missed_step_)
+    {
+        ++statistics_.misses;
+        last_missed_step_ = step;
+    }
+    return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void TimeStepStreamer::wait_for_prefetch()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    loaded_.wait(lock, [this]() { return idle_ || !running_; });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TimeStepStreamer::Statistics TimeStepStreamer::get_statistics() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return statistics_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<std::size_t> TimeStepStreamer::window() const
+{
+    std::vector<std::size_t> steps;
+
+    long long const num_steps(files_.size());
+    if(num_steps == 0)
+    {
+        return steps;
+    }
+
+    auto wrap = [num_steps](long long step) { return std::size_t(((step % num_steps) + num_steps) % num_steps); };
+
+    long long const current(static_cast<long long>(std::floor(cursor_)));
+    std::size_t const size(std::min(window_size_, files_.size()));
+    steps.reserve(size);
+
+    if(speed_ == 0.f)
+    {
+        steps.push_back(wrap(current));
+        for(long long offset(1); steps.size() < size; ++offset)
+        {
+            steps.push_back(wrap(current + offset));
+            if(steps.size() < size)
+            {
+                steps.push_back(wrap(current - offset));
+            }
+        }
+    }
+    else
+    {
+        // mostly ahead of the cursor, one step behind covers jitter around step boundaries
+        long long const direction(speed_ > 0.f ? 1 : -1);
+        long long const behind(size >= 4 ? 1 : 0);
+
+        for(long long offset(0); offset < static_cast<long long>(size) - behind; ++offset)
+        {
+            steps.push_back(wrap(current + direction * offset));
+        }
+        for(long long offset(1); offset <= behind; ++offset)
+        {
+            steps.push_back(wrap(current - direction * offset));
+        }
+    }
+
+    return steps;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool TimeStepStreamer::evict_one(std::size_t keep, bool outside_window_only)
+{
+    auto steps(window());
+
+    auto victim(resident_.end());
+    std::size_t victim_priority(0);
+
+    for(auto it(resident_.begin()); it != resident_.end(); ++it)
+    {
+        if(it->first == keep)
+        {
+            continue;
+        }
+
+        std::size_t priority(std::find(steps.begin(), steps.end(), it->first) - steps.begin());
+        if(priority == steps.size())
+        {
+            // not part of the window at all
+            victim = it;
+            break;
+        }
+
+        if(!outside_window_only && (victim == resident_.end() || priority > victim_priority))
+        {
+            victim = it;
+            victim_priority = priority;
+        }
+    }
+
+    if(victim == resident_.end())
+    {
+        return false;
+    }
+
+    resident_.erase(victim);
+    statistics_.resident_bytes -= step_size_;
+    ++statistics_.evicted;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TimeStepStreamer::Step TimeStepStreamer::load(std::size_t step) const
+{
+    auto data(std::make_shared<std::vector<uint8_t>>(step_size_, 0));
+
+    try
+    {
+        boost::interprocess::file_mapping file(files_[step].c_str(), boost::interprocess::read_only);
+        boost::interprocess::mapped_region region(file, boost::interprocess::read_only);
+        region.advise(boost::interprocess::mapped_region::advice_sequential);
+
+        std::size_t const size(std::min(region.get_size(), step_size_));
+        if(region.get_size() < file_size_)
+        {
+            Logger::LOG_WARNING << "\"" << files_[step] << "\" holds " << region.get_size() << " bytes, expected " << file_size_ << "." << std::endl;
+        }
+
+        std::memcpy(data->data(), region.get_address(), size);
+    }
+    catch(boost::interprocess::interprocess_exception const& e)
+    {
+        Logger::LOG_WARNING << "Failed to map time step \"" << files_[step] << "\": " << e.what() << std::endl;
+    }
+
+    return data;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void TimeStepStreamer::insert(std::size_t step, Step const& data)
+{
+    resident_[step] = data;
+    statistics_.resident_bytes += step_size_;
+    statistics_.peak_resident_bytes = std::max(statistics_.peak_resident_bytes, statistics_.resident_bytes);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool TimeStepStreamer::begin_prefetch(std::size_t& step)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if(!running_)
+    {
+        return false;
+    }
+
+    std::size_t next(std::numeric_limits<std::size_t>::max());
+    for(auto s : window())
+    {
+        if(resident_.count(s) == 0 && loading_.count(s) == 0)
+        {
+            next = s;
+            break;
+        }
+    }
+
+    // steps within the window are never evicted to prefetch others
+    bool const has_work(next != std::numeric_limits<std::size_t>::max());
+    if(!has_work || (resident_.size() + loading_.size() >= window_size_ && !evict_one(next, true)))
+    {
+        if(!has_work && loading_.empty())
+        {
+            idle_ = true;
+            loaded_.notify_all();
+        }
+        return false;
+    }
+
+    loading_.insert(next);
+    step = next;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void TimeStepStreamer::end_prefetch(std::size_t step, Step const& data)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        loading_.erase(step);
+        insert(step, data);
+        ++statistics_.prefetched;
+    }
+    loaded_.notify_all();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace gua
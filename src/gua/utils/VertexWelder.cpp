@@ -0,0 +1,137 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+// class header
+#include <gua/utils/VertexWelder.hpp>
+
+// external headers
+#include <cstdint>
+#include <cstring>
+
+namespace gua
+{
+namespace
+{
+uint64_t hash_coordinate(double value, uint64_t hash)
+{
+    // 0 and -0 compare equal and have to end up in the same slot
+    if(value == 0.0)
+    {
+        value = 0.0;
+    }
+
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    // FNV-1a over the whole word followed by a mix of the high bits into the low ones
+    hash = (hash ^ bits) * 1099511628211ull;
+    return hash ^ (hash >> 29);
+}
+} // namespace
+
+const unsigned VertexWelder::EMPTY_SLOT;
+
+////////////////////////////////////////////////////////////////////////////////
+
+VertexWelder::VertexWelder(std::size_t expected_vertices)
+{
+    positions_.reserve(3 * expected_vertices);
+    std::size_t num_slots = 16;
+    while(num_slots < 2 * expected_vertices)
+    {
+        num_slots *= 2;
+    }
+    slots_.assign(num_slots, EMPTY_SLOT);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+unsigned VertexWelder::add(double x, double y, double z)
+{
+    double const position[3] = {x, y, z};
+    std::size_t const mask = slots_.size() - 1;
+
+    for(std::size_t slot = slot_of(position);; slot = (slot + 1) & mask)
+    {
+        unsigned const index = slots_[slot];
+        if(index == EMPTY_SLOT)
+        {
+            unsigned const new_index = unsigned(size());
+            positions_.insert(positions_.end(), position, position + 3);
+            slots_[slot] = new_index;
+
+            // at most half of the slots are used, probe sequences stay short
+            if(2 * size() > slots_.size())
+            {
+                rehash(2 * slots_.size());
+            }
+            return new_index;
+        }
+
+        double const* other = positions_.data() + 3 * index;
+        if(other[0] == x && other[1] == y && other[2] == z)
+        {
+            return index;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void VertexWelder::clear()
+{
+    positions_.clear();
+    slots_.assign(slots_.size(), EMPTY_SLOT);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::size_t VertexWelder::slot_of(double const* position) const
+{
+    uint64_t hash = 14695981039346656037ull;
+    for(int i = 0; i < 3; ++i)
+    {
+        hash = hash_coordinate(position[i], hash);
+    }
+    return std::size_t(hash) & (slots_.size() - 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void VertexWelder::rehash(std::size_t num_slots)
+{
+    slots_.assign(num_slots, EMPTY_SLOT);
+    std::size_t const mask = num_slots - 1;
+
+    for(unsigned index = 0; index < unsigned(size()); ++index)
+    {
+        std::size_t slot = slot_of(positions_.data() + 3 * index);
+        while(slots_[slot] != EMPTY_SLOT)
+        {
+            slot = (slot + 1) & mask;
+        }
+        slots_[slot] = index;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace gua
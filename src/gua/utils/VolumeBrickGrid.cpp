@@ -0,0 +1,353 @@
+/******************************************************************************
+ * guacamole - delicious VR                                                   *
+ *                                                                            *
+ * Copyright: (c) 2011-2013 Bauhaus-Universität Weimar                        *
+ * Contact:   felix.lauer@uni-weimar.de / simon.schneegans@uni-weimar.de      *
+ *                                                                            *
+ * This program is free software: you can redistribute it and/or modify it    *
+ * under the terms of the GNU General Public License as published by the Free *
+ * Software Foundation, either version 3 of the License, or (at your option)  *
+ * any later version.                                                         *
+ *                                                                            *
+ * This program is distributed in the hope that it will be useful, but        *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY *
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License   *
+ * for more details.                                                          *
+ *                                                                            *
+ * You should have received a copy of the GNU General Public License along    *
+ * with this program. If not, see <http://www.gnu.org/licenses/>.             *
+ *                                                                            *
+ ******************************************************************************/
+
+// class header
+#include <gua/utils/VolumeBrickGrid.hpp>
+
+// external headers
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <thread>
+
+namespace gua
+{
+namespace
+{
+char const CACHE_MAGIC[8] = {'G', 'U', 'A', 'B', 'R', 'I', 'C', 'K'};
+uint32_t const CACHE_VERSION = 1;
+
+float normalize(uint8_t value) { return value / 255.f; }
+float normalize(uint16_t value) { return value / 65535.f; }
+float normalize(float value) { return value; }
+
+// the bricks of the z layers [first_layer, end_layer), each one including its one voxel border
+template <typename T>
+void update_ranges(T const* voxels,
+                   VolumeBrickGrid::Dimensions const& volume,
+                   VolumeBrickGrid::Dimensions const& grid,
+                   unsigned brick_size,
+                   bool merge,
+                   unsigned first_layer,
+                   unsigned end_layer,
+                   std::vector<VolumeBrickGrid::ValueRange>& ranges)
+{
+    auto first_voxel = [brick_size](unsigned brick) { return brick == 0 ? 0u : brick * brick_size - 1; };
+    auto last_voxel = [brick_size](unsigned brick, unsigned dimension) { return std::min(dimension - 1, (brick + 1) * brick_size); };
+
+    for(unsigned bz = first_layer; bz < end_layer; ++bz)
+    {
+        for(unsigned by = 0; by < grid[1]; ++by)
+        {
+            for(unsigned bx = 0; bx < grid[0]; ++bx)
+            {
+                T lowest = std::numeric_limits<T>::max();
+                T highest = std::numeric_limits<T>::lowest();
+
+                unsigned const x0 = first_voxel(bx), x1 = last_voxel(bx, volume[0]);
+                for(unsigned z = first_voxel(bz), z1 = last_voxel(bz, volume[2]); z <= z1; ++z)
+                {
+                    for(unsigned y = first_voxel(by), y1 = last_voxel(by, volume[1]); y <= y1; ++y)
+                    {
+                        T const* row = voxels + (std::size_t(z) * volume[1] + y) * volume[0];
+                        for(unsigned x = x0; x <= x1; ++x)
+                        {
+                            lowest = std::min(lowest, row[x]);
+                            highest = std::max(highest, row[x]);
+                        }
+                    }
+                }
+
+                auto& range = ranges[(std::size_t(bz) * grid[1] + by) * grid[0] + bx];
+                range.min = merge ? std::min(range.min, normalize(lowest)) : normalize(lowest);
+                range.max = merge ? std::max(range.max, normalize(highest)) : normalize(highest);
+            }
+        }
+    }
+}
+
+template <typename T>
+void update_ranges_parallel(T const* voxels,
+                            VolumeBrickGrid::Dimensions const& volume,
+                            VolumeBrickGrid::Dimensions const& grid,
+                            unsigned brick_size,
+                            bool merge,
+                            std::vector<VolumeBrickGrid::ValueRange>& ranges)
+{
+    unsigned const num_threads = std::max(1u, std::min(std::thread::hardware_concurrency(), grid[2]));
+
+    // every thread writes the bricks of its own z layers only
+    std::vector<std::thread> threads;
+    for(unsigned t = 1; t < num_threads; ++t)
+    {
+        threads.emplace_back(update_ranges<T>, voxels, std::cref(volume), std::cref(grid), brick_size, merge, grid[2] * t / num_threads, grid[2] * (t + 1) / num_threads, std::ref(ranges));
+    }
+    update_ranges<T>(voxels, volume, grid, brick_size, merge, 0, grid[2] / num_threads, ranges);
+
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+void VolumeBrickGrid::build(void const* voxels, Dimensions const& volume_dimensions, VoxelType type, unsigned brick_size)
+{
+    volume_dimensions_ = volume_dimensions;
+    brick_size_ = std::max(1u, brick_size);
+    for(int i = 0; i < 3; ++i)
+    {
+        grid_dimensions_[i] = (volume_dimensions_[i] + brick_size_ - 1) / brick_size_;
+    }
+
+    ranges_.assign(std::size_t(grid_dimensions_[0]) * grid_dimensions_[1] * grid_dimensions_[2], ValueRange());
+
+    if(!ranges_.empty())
+    {
+        switch(type)
+        {
+        case VoxelType::UINT8:
+            update_ranges_parallel(static_cast<uint8_t const*>(voxels), volume_dimensions_, grid_dimensions_, brick_size_, false, ranges_);
+            break;
+        case VoxelType::UINT16:
+            update_ranges_parallel(static_cast<uint16_t const*>(voxels), volume_dimensions_, grid_dimensions_, brick_size_, false, ranges_);
+            break;
+        case VoxelType::FLOAT32:
+            update_ranges_parallel(static_cast<float const*>(voxels), volume_dimensions_, grid_dimensions_, brick_size_, false, ranges_);
+            break;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void VolumeBrickGrid::extend(void const* voxels, VoxelType type)
+{
+    if(ranges_.empty())
+    {
+        return;
+    }
+
+    switch(type)
+    {
+    case VoxelType::UINT8:
+        update_ranges_parallel(static_cast<uint8_t const*>(voxels), volume_dimensions_, grid_dimensions_, brick_size_, true, ranges_);
+        break;
+    case VoxelType::UINT16:
+        update_ranges_parallel(static_cast<uint16_t const*>(voxels), volume_dimensions_, grid_dimensions_, brick_size_, true, ranges_);
+        break;
+    case VoxelType::FLOAT32:
+        update_ranges_parallel(static_cast<float const*>(voxels), volume_dimensions_, grid_dimensions_, brick_size_, true, ranges_);
+        break;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+VolumeBrickGrid::ValueRange const& VolumeBrickGrid::get_value_range(unsigned x, unsigned y, unsigned z) const { return ranges_[brick_index(x, y, z)]; }
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<uint8_t> VolumeBrickGrid::compute_occupancy(float min_visible, float max_visible) const
+{
+    std::vector<uint8_t> occupancy(ranges_.size());
+    for(std::size_t i = 0; i < ranges_.size(); ++i)
+    {
+        occupancy[i] = ranges_[i].max >= min_visible && ranges_[i].min <= max_visible;
+    }
+    return occupancy;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<uint8_t> VolumeBrickGrid::compute_occupancy(std::vector<float> const& opacity_lookup_table) const
+{
+    if(opacity_lookup_table.empty())
+    {
+        return std::vector<uint8_t>(ranges_.size(), 1);
+    }
+
+    // number of visible entries before each entry, a range is visible if the count grows within it
+    std::vector<unsigned> visible_before(opacity_lookup_table.size() + 1, 0);
+    for(std::size_t i = 0; i < opacity_lookup_table.size(); ++i)
+    {
+        visible_before[i + 1] = visible_before[i] + (opacity_lookup_table[i] > 0.f ? 1 : 0);
+    }
+
+    float const last_entry = float(opacity_lookup_table.size() - 1);
+    auto to_entry = [last_entry](float value) { return std::min(last_entry, std::max(0.f, value * last_entry)); };
+
+    std::vector<uint8_t> occupancy(ranges_.size());
+    for(std::size_t i = 0; i < ranges_.size(); ++i)
+    {
+        std::size_t const first = std::size_t(std::floor(to_entry(ranges_[i].min)));
+        std::size_t const last = std::size_t(std::ceil(to_entry(ranges_[i].max)));
+        occupancy[i] = visible_before[last + 1] > visible_before[first];
+    }
+    return occupancy;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<uint8_t> VolumeBrickGrid::compute_distances(std::vector<uint8_t> const& occupancy) const
+{
+    std::vector<uint8_t> distances(occupancy.size());
+    for(std::size_t i = 0; i < occupancy.size(); ++i)
+    {
+        distances[i] = occupancy[i] ? 0 : MAX_DISTANCE;
+    }
+
+    if(distances.size() != ranges_.size())
+    {
+        return distances;
+    }
+
+    int const size_x = int(grid_dimensions_[0]), size_y = int(grid_dimensions_[1]), size_z = int(grid_dimensions_[2]);
+
+    // two raster scans over the 26-neighbourhood yield the exact chessboard distance
+    auto relax = [&](int x, int y, int z, int direction) {
+        uint8_t& distance = distances[brick_index(x, y, z)];
+        for(int dz = -1; dz <= 1; ++dz)
+        {
+            for(int dy = -1; dy <= 1; ++dy)
+            {
+                for(int dx = -1; dx <= 1; ++dx)
+                {
+                    // neighbours already visited by this scan
+                    int const order = dz != 0 ? dz : (dy != 0 ? dy : dx);
+                    if(order != -direction)
+                    {
+                        continue;
+                    }
+
+                    int const nx = x + dx, ny = y + dy, nz = z + dz;
+                    if(nx < 0 || ny < 0 || nz < 0 || nx >= size_x || ny >= size_y || nz >= size_z)
+                    {
+                        continue;
+                    }
+
+                    uint8_t const neighbour = distances[brick_index(nx, ny, nz)];
+                    if(neighbour < MAX_DISTANCE && neighbour + 1 < distance)
+                    {
+                        distance = uint8_t(neighbour + 1);
+                    }
+                }
+            }
+        }
+    };
+
+    for(int z = 0; z < size_z; ++z)
+    {
+        for(int y = 0; y < size_y; ++y)
+        {
+            for(int x = 0; x < size_x; ++x)
+            {
+                relax(x, y, z, 1);
+            }
+        }
+    }
+
+    for(int z = size_z - 1; z >= 0; --z)
+    {
+        for(int y = size_y - 1; y >= 0; --y)
+        {
+            for(int x = size_x - 1; x >= 0; --x)
+            {
+                relax(x, y, z, -1);
+            }
+        }
+    }
+
+    return distances;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool VolumeBrickGrid::save(std::string const& file_name, uint64_t key) const
+{
+    std::ofstream file(file_name, std::ios::binary);
+    if(!file)
+    {
+        return false;
+    }
+
+    uint32_t const brick_size(brick_size_);
+    file.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    file.write(reinterpret_cast<char const*>(&CACHE_VERSION), sizeof(CACHE_VERSION));
+    file.write(reinterpret_cast<char const*>(&key), sizeof(key));
+    file.write(reinterpret_cast<char const*>(&brick_size), sizeof(brick_size));
+    file.write(reinterpret_cast<char const*>(volume_dimensions_.data()), sizeof(unsigned) * 3);
+    file.write(reinterpret_cast<char const*>(ranges_.data()), sizeof(ValueRange) * ranges_.size());
+
+    return bool(file);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool VolumeBrickGrid::load(std::string const& file_name, uint64_t key, unsigned brick_size)
+{
+    std::ifstream file(file_name, std::ios::binary);
+
+    char magic[sizeof(CACHE_MAGIC)];
+    uint32_t version(0);
+    uint64_t stored_key(0);
+    uint32_t stored_brick_size(0);
+    Dimensions volume_dimensions = {{0, 0, 0}};
+
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&stored_key), sizeof(stored_key));
+    file.read(reinterpret_cast<char*>(&stored_brick_size), sizeof(stored_brick_size));
+    file.read(reinterpret_cast<char*>(volume_dimensions.data()), sizeof(unsigned) * 3);
+
+    if(!file || std::memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0 || version != CACHE_VERSION || stored_key != key || stored_brick_size != brick_size || brick_size == 0)
+    {
+        return false;
+    }
+
+    Dimensions grid_dimensions;
+    for(int i = 0; i < 3; ++i)
+    {
+        grid_dimensions[i] = (volume_dimensions[i] + brick_size - 1) / brick_size;
+    }
+
+    std::vector<ValueRange> ranges(std::size_t(grid_dimensions[0]) * grid_dimensions[1] * grid_dimensions[2]);
+    file.read(reinterpret_cast<char*>(ranges.data()), sizeof(ValueRange) * ranges.size());
+    if(!file)
+    {
+        return false;
+    }
+
+    volume_dimensions_ = volume_dimensions;
+    grid_dimensions_ = grid_dimensions;
+    brick_size_ = brick_size;
+    ranges_.swap(ranges);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace gua
@@ -22,6 +22,11 @@
 #include <gua/utils/string_utils.hpp>
 
 #include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 
 #ifdef __GNUG__
 #include <memory>
@@ -126,5 +131,159 @@ std::string sanitize(std::string const& str)
 
 ////////////////////////////////////////////////////////////////////////////
 
+namespace
+{
+bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+// hands numbers which can't be converted exactly in double precision to the standard library
+char const* parse_float_fallback(char const* begin, char const* end, float& value)
+{
+    char token[128];
+    std::size_t length(0);
+    while(begin + length != end && length + 1 < sizeof(token) && begin[length] != ' ' && begin[length] != '\t' && begin[length] != '\r' && begin[length] != '\n')
+    {
+        token[length] = begin[length];
+        ++length;
+    }
+    token[length] = '\0';
+
+    char* token_end(nullptr);
+    value = std::strtof(token, &token_end);
+    return begin + (token_end - token);
+}
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////
+
+char const* parse_float(char const* begin, char const* end, float& value)
+{
+    // exact powers of ten in double precision
+    static const double powers_of_ten[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    char const* c(begin);
+    bool const negative(c != end && *c == '-');
+    if(c != end && (*c == '-' || *c == '+'))
+    {
+        ++c;
+    }
+
+    uint64_t mantissa(0);
+    int num_significant_digits(0);
+    int exponent(0);
+    bool has_digits(false);
+    bool truncated(false);
+
+    for(; c != end && is_digit(*c); ++c)
+    {
+        has_digits = true;
+        if(num_significant_digits < 19)
+        {
+            mantissa = mantissa * 10 + uint64_t(*c - '0');
+            num_significant_digits += mantissa != 0;
+        }
+        else
+        {
+            truncated |= *c != '0';
+            ++exponent;
+        }
+    }
+
+    if(c != end && *c == '.')
+    {
+        for(++c; c != end && is_digit(*c); ++c)
+        {
+            has_digits = true;
+            if(num_significant_digits < 19)
+            {
+                mantissa = mantissa * 10 + uint64_t(*c - '0');
+                num_significant_digits += mantissa != 0;
+                --exponent;
+            }
+            else
+            {
+                truncated |= *c != '0';
+            }
+        }
+    }
+
+    if(!has_digits)
+    {
+        // inf, nan or no number at all
+        return parse_float_fallback(begin, end, value);
+    }
+
+    if(c != end && (*c == 'e' || *c == 'E'))
+    {
+        char const* e(c + 1);
+        bool const negative_exponent(e != end && *e == '-');
+        if(e != end && (*e == '-' || *e == '+'))
+        {
+            ++e;
+        }
+
+        if(e != end && is_digit(*e))
+        {
+            int explicit_exponent(0);
+            for(; e != end && is_digit(*e); ++e)
+            {
+                explicit_exponent = std::min(explicit_exponent * 10 + (*e - '0'), 100000);
+            }
+            exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+            c = e;
+        }
+    }
+
+    // Clinger's fast path: both factors are exact doubles, so the quotient or product is correctly rounded
+    if(truncated || mantissa > (uint64_t(1) << 53) || exponent < -22 || exponent > 22)
+    {
+        return parse_float_fallback(begin, end, value);
+    }
+
+    double result = static_cast<double>(mantissa);
+    result = exponent < 0 ? result / powers_of_ten[-exponent] : result * powers_of_ten[exponent];
+
+    // rounding the double to float again is only ambiguous if it lies exactly between two floats
+    uint64_t bits;
+    std::memcpy(&bits, &result, sizeof(bits));
+    bool const float_midpoint((bits & ((uint64_t(1) << 29) - 1)) == (uint64_t(1) << 28));
+
+    if(float_midpoint || (result != 0.0 && result < double(FLT_MIN)) || result > double(FLT_MAX))
+    {
+        return parse_float_fallback(begin, end, value);
+    }
+
+    value = negative ? -float(result) : float(result);
+    return c;
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+char const* parse_int(char const* begin, char const* end, int& value)
+{
+    char const* c(begin);
+    bool const negative(c != end && *c == '-');
+    if(c != end && (*c == '-' || *c == '+'))
+    {
+        ++c;
+    }
+
+    if(c == end || !is_digit(*c))
+    {
+        return begin;
+    }
+
+    int64_t result(0);
+    for(; c != end && is_digit(*c); ++c)
+    {
+        result = std::min(result * 10 + (*c - '0'), int64_t(INT_MAX) + 1);
+    }
+
+    result = negative ? -result : std::min(result, int64_t(INT_MAX));
+    value = int(std::max(result, int64_t(INT_MIN)));
+    return c;
+}
+
+////////////////////////////////////////////////////////////////////////////
+
 } // namespace string_utils
 } // namespace gua
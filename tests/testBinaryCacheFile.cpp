@@ -0,0 +1,163 @@
+#include <unittest++/UnitTest++.h>
+#include <gua/utils/BinaryCacheFile.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+// laid out like the per patch attributes of NURBSData
+struct PatchAttributes
+{
+    unsigned surface_offset;
+    unsigned char order_u;
+    unsigned char order_v;
+    unsigned short trim_type;
+    unsigned trim_id;
+    unsigned obb_id;
+    float nurbs_domain[4];
+    float curvature;
+};
+
+struct Vec4
+{
+    float data[4];
+};
+
+float uint_to_float(unsigned i)
+{
+    float f;
+    std::memcpy(&f, &i, sizeof(f));
+    return f;
+}
+
+template <typename T>
+bool bit_equal(std::vector<T> const& a, std::vector<T> const& b)
+{
+    return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+struct Arrays
+{
+    Arrays()
+    {
+        for(unsigned i = 0; i < 1000; ++i)
+        {
+            // patch ids are stored as float bit patterns, some of them are NaNs
+            patches.push_back({{float(i) * 0.1f, -float(i), 1e-30f, uint_to_float(0x7fc00000u + i)}});
+            indices.push_back(i * 4 + i % 4);
+            attributes.push_back(PatchAttributes());
+            std::memset(&attributes.back(), 0, sizeof(PatchAttributes));
+            attributes.back().surface_offset = i * 16;
+            attributes.back().order_u = 4;
+            attributes.back().trim_id = 1000 - i;
+            attributes.back().curvature = 1.f / (i + 1);
+            preclassification.push_back((unsigned char)(i * 7));
+        }
+    }
+
+    void store(gua::BinaryCacheFile& cache) const
+    {
+        cache.set("patches", patches);
+        cache.set("indices", indices);
+        cache.set("attributes", attributes);
+        cache.set("preclassification", preclassification);
+        cache.set("empty", std::vector<float>());
+    }
+
+    std::vector<Vec4> patches;
+    std::vector<unsigned> indices;
+    std::vector<PatchAttributes> attributes;
+    std::vector<unsigned char> preclassification;
+};
+} // namespace
+
+SUITE(describe_binary_cache_file)
+{
+    TEST(cached_arrays_should_be_bit_exact)
+    {
+        Arrays uncached;
+        gua::BinaryCacheFile writer(3, 0xabcdef);
+        uncached.store(writer);
+        CHECK(writer.save("gua-test-cache.bin"));
+
+        gua::BinaryCacheFile reader(3, 0xabcdef);
+        CHECK(reader.load("gua-test-cache.bin"));
+
+        Arrays cached;
+        CHECK(reader.get("patches", cached.patches));
+        CHECK(reader.get("indices", cached.indices));
+        CHECK(reader.get("attributes", cached.attributes));
+        CHECK(reader.get("preclassification", cached.preclassification));
+
+        std::vector<float> empty(3, 1.f);
+        CHECK(reader.get("empty", empty));
+        CHECK(empty.empty());
+
+        CHECK(bit_equal(uncached.patches, cached.patches));
+        CHECK(bit_equal(uncached.indices, cached.indices));
+        CHECK(bit_equal(uncached.attributes, cached.attributes));
+        CHECK(bit_equal(uncached.preclassification, cached.preclassification));
+
+        std::remove("gua-test-cache.bin");
+    }
+
+    TEST(it_should_reject_outdated_caches)
+    {
+        Arrays uncached;
+        gua::BinaryCacheFile writer(3, 42);
+        uncached.store(writer);
+        CHECK(writer.save("gua-test-cache.bin"));
+
+        gua::BinaryCacheFile other_version(4, 42);
+        gua::BinaryCacheFile other_source(3, 43);
+        CHECK(!other_version.load("gua-test-cache.bin"));
+        CHECK(!other_source.load("gua-test-cache.bin"));
+        CHECK(!other_source.has("patches"));
+        CHECK(!other_source.load("gua-test-missing.bin"));
+
+        std::remove("gua-test-cache.bin");
+    }
+
+    TEST(it_should_reject_broken_caches_and_element_types)
+    {
+        Arrays uncached;
+        gua::BinaryCacheFile writer(1, 7);
+        uncached.store(writer);
+        CHECK(writer.save("gua-test-cache.bin"));
+
+        gua::BinaryCacheFile reader(1, 7);
+        CHECK(reader.load("gua-test-cache.bin"));
+        std::vector<double> wrong_type;
+        CHECK(!reader.get("indices", wrong_type));
+        CHECK(!reader.get("missing", wrong_type));
+
+        // cut off the end of the last array
+        std::vector<char> content;
+        {
+            std::ifstream file("gua-test-cache.bin", std::ios::binary);
+            content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+        std::ofstream("gua-test-cache.bin", std::ios::binary).write(content.data(), content.size() - 10);
+
+        gua::BinaryCacheFile truncated(1, 7);
+        CHECK(!truncated.load("gua-test-cache.bin"));
+
+        std::remove("gua-test-cache.bin");
+    }
+
+    TEST(file_hashes_should_match_the_hash_of_the_content)
+    {
+        std::vector<char> content(3 * (1 << 20) + 5, 'x');
+        content[12345] = 'y';
+        std::ofstream("gua-test-cache.raw", std::ios::binary).write(content.data(), content.size());
+
+        CHECK_EQUAL(gua::BinaryCacheFile::hash_data(content.data(), content.size()), gua::BinaryCacheFile::hash_file("gua-test-cache.raw"));
+        CHECK(gua::BinaryCacheFile::hash_data(content.data(), content.size() - 1) != gua::BinaryCacheFile::hash_file("gua-test-cache.raw"));
+
+        std::remove("gua-test-cache.raw");
+    }
+}
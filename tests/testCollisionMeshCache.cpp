@@ -0,0 +1,192 @@
+#include <unittest++/UnitTest++.h>
+#include <gua/physics/CollisionMeshCache.hpp>
+#include <gua/utils/VertexWelder.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include <btBulletCollisionCommon.h>
+#include <BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h>
+
+using gua::physics::CollisionMeshCache;
+
+namespace
+{
+// a bumpy height field, welded the way TriangleMeshShape welds meshes
+CollisionMeshCache::Mesh make_terrain(int resolution)
+{
+    CollisionMeshCache::Mesh mesh;
+    gua::VertexWelder welder;
+
+    auto vertex = [&](int x, int z) { return int(welder.add(x * 0.1, 0.2 * std::sin(x * 0.7) * std::cos(z * 0.3), z * 0.1)); };
+
+    for(int x = 0; x < resolution; ++x)
+    {
+        for(int z = 0; z < resolution; ++z)
+        {
+            int const quad[4] = {vertex(x, z), vertex(x + 1, z), vertex(x + 1, z + 1), vertex(x, z + 1)};
+            mesh.indices.insert(mesh.indices.end(), {quad[0], quad[1], quad[2], quad[0], quad[2], quad[3]});
+        }
+    }
+
+    mesh.positions = welder.positions();
+    return mesh;
+}
+
+struct Contact
+{
+    btScalar distance;
+    btVector3 position;
+    int triangle;
+};
+
+struct ContactCollector : public btCollisionWorld::ContactResultCallback
+{
+    btScalar addSingleResult(btManifoldPoint& point, btCollisionObjectWrapper const*, int, int, btCollisionObjectWrapper const*, int, int index) override
+    {
+        contacts.push_back({point.getDistance(), point.getPositionWorldOnB(), index});
+        return 0;
+    }
+
+    std::vector<Contact> contacts;
+};
+
+// runs the same ray and contact queries against two shapes, all results have to be identical
+void check_identical_queries(btCollisionShape* a, btCollisionShape* b)
+{
+    btDefaultCollisionConfiguration configuration;
+    btCollisionDispatcher dispatcher(&configuration);
+    btDbvtBroadphase broadphase;
+    btCollisionWorld world(&dispatcher, &broadphase, &configuration);
+
+    btCollisionObject object_a, object_b;
+    object_a.setCollisionShape(a);
+    object_b.setCollisionShape(b);
+
+    btSphereShape sphere(0.15f);
+    btCollisionObject probe;
+    probe.setCollisionShape(&sphere);
+
+    int num_hits = 0;
+    int num_contacts = 0;
+
+    for(int i = 0; i < 200; ++i)
+    {
+        btVector3 const from(0.05f * (i % 20), 1.f, 0.04f * (i / 20));
+        btVector3 const to(from + btVector3(0.3f, -2.f, 0.1f * (i % 3)));
+
+        btCollisionWorld::ClosestRayResultCallback hit_a(from, to), hit_b(from, to);
+        world.rayTestSingle(btTransform(btQuaternion::getIdentity(), from), btTransform(btQuaternion::getIdentity(), to), &object_a, a, object_a.getWorldTransform(), hit_a);
+        world.rayTestSingle(btTransform(btQuaternion::getIdentity(), from), btTransform(btQuaternion::getIdentity(), to), &object_b, b, object_b.getWorldTransform(), hit_b);
+
+        CHECK_EQUAL(hit_a.hasHit(), hit_b.hasHit());
+        CHECK_EQUAL(hit_a.m_closestHitFraction, hit_b.m_closestHitFraction);
+        CHECK(hit_a.m_hitNormalWorld == hit_b.m_hitNormalWorld);
+        num_hits += hit_a.hasHit() ? 1 : 0;
+
+        probe.getWorldTransform().setOrigin(btVector3(0.07f * (i % 20), 0.1f * std::sin(i * 0.37f), 0.06f * (i / 20)));
+
+        ContactCollector contacts_a, contacts_b;
+        world.contactPairTest(&probe, &object_a, contacts_a);
+        world.contactPairTest(&probe, &object_b, contacts_b);
+
+        CHECK_EQUAL(contacts_a.contacts.size(), contacts_b.contacts.size());
+        if(contacts_a.contacts.size() == contacts_b.contacts.size())
+        {
+            for(std::size_t c = 0; c < contacts_a.contacts.size(); ++c)
+            {
+                CHECK_EQUAL(contacts_a.contacts[c].distance, contacts_b.contacts[c].distance);
+                CHECK(contacts_a.contacts[c].position == contacts_b.contacts[c].position);
+                CHECK_EQUAL(contacts_a.contacts[c].triangle, contacts_b.contacts[c].triangle);
+            }
+        }
+        num_contacts += int(contacts_a.contacts.size());
+    }
+
+    // the queries have to actually touch the mesh
+    CHECK(num_hits > 100);
+    CHECK(num_contacts > 50);
+}
+} // namespace
+
+SUITE(describe_collision_mesh_cache)
+{
+    TEST(loaded_bvhs_should_answer_queries_like_built_ones)
+    {
+        auto const mesh(make_terrain(20));
+        uint64_t const key(CollisionMeshCache::hash(mesh));
+        std::string const file_name("testCollisionMeshCache.gua_bvh");
+
+        auto built(CollisionMeshCache::build_static_mesh(mesh));
+        CHECK(CollisionMeshCache::save_static_mesh(file_name, key, *built));
+
+        CHECK(!CollisionMeshCache::load_static_mesh(file_name, key + 1));
+        auto loaded(CollisionMeshCache::load_static_mesh(file_name, key));
+        std::remove(file_name.c_str());
+        CHECK(loaded);
+        if(!loaded)
+            return;
+
+        check_identical_queries(built->shape(), loaded->shape());
+
+        btScaledBvhTriangleMeshShape scaled_built(built->shape(), btVector3(2.f, 1.f, 0.5f));
+        btScaledBvhTriangleMeshShape scaled_loaded(loaded->shape(), btVector3(2.f, 1.f, 0.5f));
+        check_identical_queries(&scaled_built, &scaled_loaded);
+    }
+
+    TEST(it_should_share_meshes_by_name)
+    {
+        auto* cache(CollisionMeshCache::instance());
+        int num_collected = 0;
+        auto collect = [&](CollisionMeshCache::Mesh& mesh) {
+            ++num_collected;
+            mesh = make_terrain(4);
+        };
+
+        auto first(cache->get_static_mesh("terrain", collect));
+        auto second(cache->get_static_mesh("terrain", collect));
+        CHECK_EQUAL(1, num_collected);
+        CHECK(first == second);
+
+        // entries are released together with the last shape using them
+        first.reset();
+        second.reset();
+        auto third(cache->get_static_mesh("terrain", collect));
+        CHECK_EQUAL(2, num_collected);
+    }
+
+    TEST(keys_should_depend_on_mesh_and_parameters)
+    {
+        auto mesh(make_terrain(3));
+        CollisionMeshCache::HACDParameters parameters;
+        uint64_t const key(CollisionMeshCache::hash(mesh, parameters));
+
+        parameters.concavity = 40.0;
+        CHECK(key != CollisionMeshCache::hash(mesh, parameters));
+        parameters.concavity = 80.0;
+        CHECK_EQUAL(key, CollisionMeshCache::hash(mesh, parameters));
+
+        mesh.positions[4] += 0.001;
+        CHECK(key != CollisionMeshCache::hash(mesh, parameters));
+    }
+
+    TEST(convex_decompositions_should_be_bit_exact)
+    {
+        CollisionMeshCache::ConvexDecomposition decomposition;
+        decomposition.points = {0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 2, 2, 2, 3, 2, 2, 2, 3, 2, 2, 2, 3.5};
+        decomposition.hull_sizes = {4, 4};
+        std::string const file_name("testCollisionMeshCache.gua_hacd");
+
+        CHECK(CollisionMeshCache::save_convex_decomposition(file_name, 42, decomposition));
+        auto loaded(CollisionMeshCache::load_convex_decomposition(file_name, 42));
+        std::remove(file_name.c_str());
+
+        CHECK(loaded);
+        if(loaded)
+        {
+            CHECK(decomposition.points == loaded->points);
+            CHECK(decomposition.hull_sizes == loaded->hull_sizes);
+        }
+    }
+}
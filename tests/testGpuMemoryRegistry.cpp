@@ -0,0 +1,230 @@
+#include <unittest++/UnitTest++.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <gua/renderer/GpuMemoryRegistry.hpp>
+
+namespace
+{
+using Category = gua::GpuMemoryRegistry::Category;
+
+// stands in for a render device: owns "buffers" and reports them to the registry
+struct MockDevice
+{
+    explicit MockDevice(gua::GpuMemoryRegistry& r) : registry(r) {}
+
+    void upload(std::size_t id, std::size_t bytes, bool evictable = true)
+    {
+        buffers[id] = bytes;
+        ++uploads;
+        if(evictable)
+        {
+            registry.track(id, Category::MESH, bytes, "mesh", [this, id]() { buffers.erase(id); });
+        }
+        else
+        {
+            registry.track(id, Category::RENDER_TARGET, bytes, "target");
+        }
+    }
+
+    // uploads again if the buffer has been evicted
+    void draw(std::size_t id, std::size_t bytes)
+    {
+        if(buffers.find(id) == buffers.end())
+        {
+            upload(id, bytes);
+        }
+        registry.touch(id);
+    }
+
+    void release(std::size_t id)
+    {
+        buffers.erase(id);
+        registry.untrack(id);
+    }
+
+    gua::GpuMemoryRegistry& registry;
+    std::map<std::size_t, std::size_t> buffers;
+    unsigned uploads = 0;
+};
+
+// a resource uploaded to any number of contexts, like a texture
+struct MockResource
+{
+    void upload_to(std::shared_ptr<gua::GpuMemoryRegistry> const& registry, std::size_t bytes)
+    {
+        memory_allocations.track(registry, gua::GpuMemoryRegistry::id_of(this), Category::TEXTURE, bytes, "texture", []() {});
+    }
+
+    gua::GpuMemoryAllocations memory_allocations;
+};
+} // namespace
+
+SUITE(describe_gpu_memory_registry)
+{
+    TEST(it_should_sum_allocations_per_category)
+    {
+        gua::GpuMemoryRegistry registry;
+        MockDevice device(registry);
+        device.upload(1, 100);
+        device.upload(2, 50);
+        device.upload(3, 1000, false);
+
+        CHECK_EQUAL(1150u, registry.get_total_bytes());
+        CHECK_EQUAL(150u, registry.get_usage(Category::MESH).bytes);
+        CHECK_EQUAL(1000u, registry.get_usage(Category::RENDER_TARGET).bytes);
+        CHECK_EQUAL(0u, registry.get_usage(Category::TEXTURE).bytes);
+    }
+
+    TEST(it_should_keep_high_water_marks)
+    {
+        gua::GpuMemoryRegistry registry;
+        MockDevice device(registry);
+        device.upload(1, 100);
+        device.upload(2, 200);
+        device.release(2);
+
+        CHECK_EQUAL(100u, registry.get_total_bytes());
+        CHECK_EQUAL(300u, registry.get_high_water_mark());
+        CHECK_EQUAL(300u, registry.get_usage(Category::MESH).high_water_mark);
+    }
+
+    TEST(retracking_should_replace_the_previous_size)
+    {
+        gua::GpuMemoryRegistry registry;
+        registry.track(7, Category::ABUFFER, 64);
+        registry.track(7, Category::ABUFFER, 128);
+
+        CHECK_EQUAL(128u, registry.get_total_bytes());
+        CHECK_EQUAL(128u, registry.get_usage(Category::ABUFFER).high_water_mark);
+    }
+
+    TEST(it_should_evict_idle_allocations_only)
+    {
+        gua::GpuMemoryRegistry registry;
+        MockDevice device(registry);
+        registry.set_max_idle_frames(2);
+
+        device.upload(1, 100);
+        device.upload(2, 100);
+        device.upload(3, 100, false);
+
+        for(unsigned frame(1); frame < 5; ++frame)
+        {
+            registry.collect(frame);
+            device.draw(1, 100);
+        }
+
+        CHECK(registry.is_tracked(1));
+        CHECK(!registry.is_tracked(2));
+        CHECK(registry.is_tracked(3));
+        CHECK(device.buffers.find(2) == device.buffers.end());
+        CHECK_EQUAL(200u, registry.get_total_bytes());
+        CHECK_EQUAL(1u, registry.get_usage(Category::MESH).evictions);
+    }
+
+    TEST(evicted_allocations_should_be_reuploaded_on_demand)
+    {
+        gua::GpuMemoryRegistry registry;
+        MockDevice device(registry);
+        registry.set_max_idle_frames(1);
+
+        device.upload(1, 100);
+        registry.collect(5);
+        CHECK(!registry.is_tracked(1));
+
+        device.draw(1, 100);
+        CHECK(registry.is_tracked(1));
+        CHECK_EQUAL(2u, device.uploads);
+        CHECK_EQUAL(100u, registry.get_total_bytes());
+    }
+
+    TEST(it_should_evict_least_recently_used_allocations_above_budget)
+    {
+        gua::GpuMemoryRegistry registry;
+        MockDevice device(registry);
+        registry.set_budget(250);
+
+        registry.collect(1);
+        device.upload(1, 100);
+        registry.collect(2);
+        device.upload(2, 100);
+        registry.collect(3);
+        device.upload(3, 100);
+
+        CHECK_EQUAL(300u, registry.get_total_bytes());
+        registry.collect(4);
+
+        CHECK(!registry.is_tracked(1));
+        CHECK(registry.is_tracked(2));
+        CHECK(registry.is_tracked(3));
+        CHECK_EQUAL(200u, registry.get_total_bytes());
+    }
+
+    TEST(allocations_used_in_the_current_frame_should_not_be_evicted)
+    {
+        gua::GpuMemoryRegistry registry;
+        MockDevice device(registry);
+        registry.set_budget(50);
+
+        registry.begin_frame(1);
+        device.upload(1, 100);
+
+        CHECK_EQUAL(0u, registry.enforce_budget());
+        CHECK(registry.is_tracked(1));
+    }
+
+    TEST(destroyed_resources_should_be_untracked_in_all_contexts)
+    {
+        auto first(std::make_shared<gua::GpuMemoryRegistry>());
+        auto second(std::make_shared<gua::GpuMemoryRegistry>());
+        first->track(1, Category::RENDER_TARGET, 1000, "target");
+
+        {
+            MockResource resource;
+            resource.upload_to(first, 100);
+            resource.upload_to(second, 100);
+            // uploaded again after an eviction
+            resource.upload_to(first, 100);
+
+            MockResource copy(resource);
+            copy.upload_to(first, 50);
+
+            CHECK_EQUAL(1150u, first->get_total_bytes());
+            CHECK_EQUAL(100u, second->get_total_bytes());
+        }
+
+        CHECK_EQUAL(1000u, first->get_total_bytes());
+        CHECK_EQUAL(0u, second->get_total_bytes());
+        CHECK_EQUAL(0u, first->get_usage(Category::TEXTURE).bytes);
+        CHECK(first->is_tracked(1));
+    }
+
+    TEST(resources_should_outlive_their_registries)
+    {
+        MockResource resource;
+        {
+            auto registry(std::make_shared<gua::GpuMemoryRegistry>());
+            resource.upload_to(registry, 100);
+        }
+
+        auto registry(std::make_shared<gua::GpuMemoryRegistry>());
+        resource.upload_to(registry, 200);
+        resource.memory_allocations.untrack(registry, gua::GpuMemoryRegistry::id_of(&resource));
+        CHECK_EQUAL(0u, registry->get_total_bytes());
+    }
+
+    TEST(it_should_dump_json)
+    {
+        gua::GpuMemoryRegistry registry;
+        registry.track(1, Category::TEXTURE, 42, "a \"quoted\" label");
+
+        std::string summary(registry.to_json());
+        CHECK(summary.find("\"texture\": {\"bytes\": 42") != std::string::npos);
+        CHECK(summary.find("allocations\": [") == std::string::npos);
+
+        std::string full(registry.to_json(true));
+        CHECK(full.find("a \\\"quoted\\\" label") != std::string::npos);
+        CHECK(full.find("\"evictable\": false") != std::string::npos);
+    }
+}
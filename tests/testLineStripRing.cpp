@@ -0,0 +1,197 @@
+#include <unittest++/UnitTest++.h>
+#include <gua/utils/LineStripRing.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <vector>
+
+namespace
+{
+// a line strip of vertex ids whose positions are derived from the id
+struct RingModel
+{
+    explicit RingModel(bool mirrored) : ring(4, mirrored), ids(4), positions(3 * 4), image(ring.image_size(), -1) {}
+
+    void push(int id)
+    {
+        if(ring.full())
+        {
+            // what LineStrip does: copy the vertices in order into new slots
+            unsigned const capacity(ring.mirrored() || 2 * ring.size() >= ring.capacity() ? 2 * ring.capacity() : ring.capacity());
+            std::vector<int> ordered;
+            for(unsigned i = 0; i < ring.size(); ++i)
+            {
+                ordered.push_back(ids[ring.slot(i)]);
+            }
+            ordered.resize(capacity);
+            ids = ordered;
+            positions.resize(3 * capacity);
+            for(unsigned i = 0; i < capacity; ++i)
+            {
+                set_position(i);
+            }
+            ring.reset(capacity, ring.size(), ring.mirrored());
+            image.assign(ring.image_size(), -1);
+        }
+
+        unsigned const slot(ring.push_back());
+        ids[slot] = id;
+        set_position(slot);
+        reference.push_back(id);
+    }
+
+    void set_position(unsigned slot)
+    {
+        positions[3 * slot] = float(ids[slot] % 97);
+        positions[3 * slot + 1] = -float(ids[slot] % 13);
+        positions[3 * slot + 2] = float(ids[slot]) * 0.5f;
+    }
+
+    // returns the number of uploaded image slots
+    unsigned upload()
+    {
+        unsigned uploaded(0);
+        for(auto const& range : ring.take_dirty_ranges())
+        {
+            for(unsigned image_slot = range.begin; image_slot < range.end; ++image_slot)
+            {
+                image[image_slot] = ids[ring.image_source(image_slot)];
+            }
+            uploaded += range.end - range.begin;
+        }
+        return uploaded;
+    }
+
+    // the drawn window equals a strip built from scratch
+    bool matches_rebuild() const
+    {
+        if(reference.empty())
+        {
+            return ring.size() == 0;
+        }
+
+        std::vector<int> rebuilt;
+        rebuilt.push_back(reference.front());
+        rebuilt.insert(rebuilt.end(), reference.begin(), reference.end());
+        rebuilt.push_back(reference.back());
+
+        std::vector<int> drawn(image.begin() + ring.image_first(), image.begin() + ring.image_first() + ring.size() + 2);
+        return ring.size() == reference.size() && drawn == rebuilt;
+    }
+
+    bool bounds_match_rebuild() const
+    {
+        float min[3], max[3];
+        if(!ring.bounds(positions.data(), min, max))
+        {
+            return reference.empty();
+        }
+
+        for(int axis = 0; axis < 3; ++axis)
+        {
+            float expected_min(1e30f), expected_max(-1e30f);
+            for(int id : reference)
+            {
+                float const value(axis == 0 ? float(id % 97) : axis == 1 ? -float(id % 13) : float(id) * 0.5f);
+                expected_min = std::min(expected_min, value);
+                expected_max = std::max(expected_max, value);
+            }
+            if(min[axis] != expected_min || max[axis] != expected_max)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    gua::LineStripRing ring;
+    std::vector<int> ids;
+    std::vector<float> positions;
+    std::vector<int> image;
+    std::deque<int> reference;
+};
+
+void run_random_operations(bool mirrored)
+{
+    RingModel model(mirrored);
+    std::mt19937 generator(mirrored ? 7 : 11);
+    int next_id(0);
+
+    for(int step = 0; step < 20000; ++step)
+    {
+        unsigned const operation(generator() % 10);
+        if(operation < 6 || model.reference.empty())
+        {
+            model.push(next_id++);
+        }
+        else if(operation < 9)
+        {
+            model.ring.pop_front();
+            model.reference.pop_front();
+        }
+        else
+        {
+            model.ring.pop_back();
+            model.reference.pop_back();
+        }
+
+        if(generator() % 4 == 0)
+        {
+            model.upload();
+            CHECK(model.matches_rebuild());
+            CHECK(model.bounds_match_rebuild());
+        }
+    }
+}
+} // namespace
+
+SUITE(describe_line_strip_ring)
+{
+    TEST(it_should_match_a_rebuild_when_mirrored) { run_random_operations(true); }
+
+    TEST(it_should_match_a_rebuild_when_unmirrored) { run_random_operations(false); }
+
+    TEST(it_should_upload_only_changes)
+    {
+        RingModel model(true);
+        for(int id = 0; id < 1000; ++id)
+        {
+            model.push(id);
+        }
+        model.upload();
+
+        // a trail of constant length: append one vertex, trim one at the front
+        for(int id = 1000; id < 5000; ++id)
+        {
+            model.push(id);
+            model.ring.pop_front();
+            model.reference.pop_front();
+
+            CHECK(model.upload() <= 6u);
+            CHECK(model.matches_rebuild());
+        }
+
+        CHECK_EQUAL(1024u, model.ring.capacity());
+        CHECK(model.bounds_match_rebuild());
+    }
+
+    TEST(it_should_merge_dirty_ranges)
+    {
+        std::vector<gua::LineStripRing::Range> ranges;
+        for(unsigned i = 0; i < 100; ++i)
+        {
+            ranges.push_back(gua::LineStripRing::Range{(99 - i) * 10, (99 - i) * 10 + 2 + (i == 50 ? 8 : 0)});
+        }
+
+        gua::LineStripRing::merge_ranges(ranges);
+
+        CHECK(ranges.size() <= gua::LineStripRing::MAX_DIRTY_RANGES);
+        CHECK_EQUAL(0u, ranges.front().begin);
+        CHECK_EQUAL(992u, ranges.back().end);
+        for(std::size_t i = 1; i < ranges.size(); ++i)
+        {
+            CHECK(ranges[i - 1].end < ranges[i].begin);
+        }
+    }
+}
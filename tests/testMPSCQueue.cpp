@@ -0,0 +1,79 @@
+#include <unittest++/UnitTest++.h>
+#include <gua/utils/MPSCQueue.hpp>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+SUITE(describe_mpsc_queue)
+{
+    TEST(it_should_be_first_in_first_out)
+    {
+        gua::MPSCQueue<std::unique_ptr<int>> queue;
+        std::unique_ptr<int> value;
+        CHECK(!queue.pop(value));
+
+        for(int i = 0; i < 10; ++i)
+            queue.push(std::unique_ptr<int>(new int(i)));
+
+        for(int i = 0; i < 5; ++i)
+        {
+            CHECK(queue.pop(value));
+            CHECK_EQUAL(i, *value);
+        }
+
+        queue.push(std::unique_ptr<int>(new int(10)));
+        for(int i = 5; i <= 10; ++i)
+        {
+            CHECK(queue.pop(value));
+            CHECK_EQUAL(i, *value);
+        }
+        CHECK(!queue.pop(value));
+
+        // values left in the queue are destroyed with it
+        queue.push(std::unique_ptr<int>(new int(11)));
+    }
+
+    TEST(it_should_keep_the_order_of_each_producer)
+    {
+        unsigned const num_producers = 4;
+        unsigned const num_values = 50000;
+
+        // producer id in the high bits, sequence number in the low ones
+        gua::MPSCQueue<unsigned> queue;
+        std::vector<std::thread> producers;
+        for(unsigned p = 0; p < num_producers; ++p)
+        {
+            producers.push_back(std::thread([&queue, p]() {
+                for(unsigned i = 0; i < num_values; ++i)
+                    queue.push(p << 24 | i);
+            }));
+        }
+
+        std::vector<unsigned> next(num_producers, 0);
+        unsigned num_popped = 0;
+        bool in_order = true;
+        while(num_popped < num_producers * num_values)
+        {
+            unsigned value;
+            if(!queue.pop(value))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            unsigned const producer(value >> 24);
+            in_order = in_order && producer < num_producers && (value & 0xffffff) == next[producer];
+            if(producer < num_producers)
+                ++next[producer];
+            ++num_popped;
+        }
+
+        for(auto& producer : producers)
+            producer.join();
+
+        unsigned value;
+        CHECK(in_order);
+        CHECK(!queue.pop(value));
+    }
+}
@@ -0,0 +1,49 @@
+#include <unittest++/UnitTest++.h>
+#include <gua/utils/MappedFile.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+SUITE(describe_mapped_file)
+{
+    TEST(it_should_map_the_file_content)
+    {
+        std::string const file_name("testMappedFile.txt");
+        std::string content;
+        for(int i = 0; i != 10000; ++i)
+        {
+            content += "v 1.0 2.0 3.0\n";
+        }
+
+        {
+            std::ofstream file(file_name, std::ios::binary);
+            file << content;
+        }
+
+        gua::MappedFile mapped(file_name);
+        CHECK(mapped.is_open());
+        CHECK_EQUAL(content.size(), mapped.size());
+        CHECK(std::string(mapped.data(), mapped.size()) == content);
+
+        mapped.close();
+        CHECK(!mapped.is_open());
+        CHECK_EQUAL(0u, mapped.size());
+
+        std::remove(file_name.c_str());
+    }
+
+    TEST(it_should_handle_empty_and_missing_files)
+    {
+        std::string const file_name("testMappedFileEmpty.txt");
+        std::ofstream(file_name).close();
+
+        gua::MappedFile mapped;
+        CHECK(mapped.open(file_name));
+        CHECK_EQUAL(0u, mapped.size());
+
+        std::remove(file_name.c_str());
+        CHECK(!mapped.open(file_name));
+        CHECK(!mapped.is_open());
+    }
+}
@@ -0,0 +1,178 @@
+#include <unittest++/UnitTest++.h>
+#include <gua/utils/MessagePlayer.hpp>
+#include <gua/utils/MessageRecorder.hpp>
+#include <gua/utils/MessageRecording.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+namespace
+{
+std::string temp_filename()
+{
+    static unsigned counter(0);
+    return "gua-test-recording-" + std::to_string(counter++) + ".rec";
+}
+
+void truncate_file(std::string const& filename, std::size_t bytes_to_remove)
+{
+    std::string content;
+    {
+        std::ifstream file(filename, std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    std::ofstream(filename, std::ios::binary | std::ios::trunc).write(content.data(), content.size() - bytes_to_remove);
+}
+
+void record(std::string const& filename, unsigned num_messages)
+{
+    gua::MessageRecorder recorder;
+    recorder.open(filename);
+    for(unsigned i(0); i < num_messages; ++i)
+    {
+        std::string payload(std::string("message ") + std::to_string(i));
+        recorder.write(payload.data(), payload.size(), i * 1000);
+    }
+}
+
+std::string payload_of(gua::MessageRecording::Message const& message) { return std::string(reinterpret_cast<char const*>(message.data), message.size); }
+} // namespace
+
+SUITE(describe_message_recording)
+{
+    TEST(it_should_read_back_recorded_messages)
+    {
+        std::string filename(temp_filename());
+        record(filename, 10);
+
+        gua::MessageRecording recording(filename);
+        CHECK(recording.is_valid());
+        CHECK_EQUAL(10u, recording.get_num_messages());
+        CHECK_EQUAL(9000u, recording.get_duration());
+        CHECK_EQUAL("message 3", payload_of(recording.get_message(3)));
+        CHECK_EQUAL(3000u, recording.get_message(3).timestamp);
+
+        std::remove(filename.c_str());
+    }
+
+    TEST(it_should_find_messages_by_time)
+    {
+        std::string filename(temp_filename());
+        record(filename, 10);
+
+        gua::MessageRecording recording(filename);
+        CHECK_EQUAL(0u, recording.find_message(0));
+        CHECK_EQUAL(3u, recording.find_message(2500));
+        CHECK_EQUAL(10u, recording.find_message(100000));
+
+        std::remove(filename.c_str());
+    }
+
+    TEST(it_should_recover_recordings_without_index)
+    {
+        std::string filename(temp_filename());
+        record(filename, 5);
+
+        // cut off the index and half of the last message
+        truncate_file(filename, sizeof(gua::MessageRecording::FileFooter) + 5 * sizeof(gua::MessageRecording::IndexEntry) + 12);
+
+        gua::MessageRecording recording(filename);
+        CHECK(recording.is_valid());
+        CHECK_EQUAL(4u, recording.get_num_messages());
+        CHECK_EQUAL("message 3", payload_of(recording.get_message(3)));
+
+        std::remove(filename.c_str());
+    }
+
+    TEST(it_should_reject_other_files)
+    {
+        std::string filename(temp_filename());
+        std::ofstream(filename) << "no recording";
+
+        gua::MessageRecording recording(filename);
+        CHECK(!recording.is_valid());
+
+        std::remove(filename.c_str());
+    }
+
+    TEST(unpaced_playback_should_return_all_messages_in_order)
+    {
+        std::string filename(temp_filename());
+        record(filename, 4);
+
+        gua::MessagePlayer player(std::make_shared<gua::MessageRecording>(filename), 0.f, false);
+        gua::MessageRecording::Message message;
+
+        for(unsigned i(0); i < 4; ++i)
+        {
+            CHECK(player.next(message));
+            CHECK_EQUAL(std::string("message ") + std::to_string(i), payload_of(message));
+        }
+        CHECK(!player.next(message));
+
+        player.seek(2000);
+        CHECK(player.next(message));
+        CHECK_EQUAL("message 2", payload_of(message));
+
+        std::remove(filename.c_str());
+    }
+
+    TEST(looping_a_recording_without_duration_should_wait_for_stop)
+    {
+        std::string filename(temp_filename());
+        record(filename, 1);
+
+        gua::MessagePlayer player(std::make_shared<gua::MessageRecording>(filename), 1.f, true);
+        gua::MessageRecording::Message message;
+        CHECK(player.next(message));
+
+        std::thread stopper([&player]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            player.stop();
+        });
+
+        CHECK(!player.next(message));
+        stopper.join();
+
+        std::remove(filename.c_str());
+    }
+
+    TEST(looping_should_keep_the_recorded_pace)
+    {
+        std::string filename(temp_filename());
+        record(filename, 3);
+
+        gua::MessagePlayer player(std::make_shared<gua::MessageRecording>(filename), 1.f, true);
+        gua::MessageRecording::Message message;
+
+        auto start(std::chrono::steady_clock::now());
+        for(unsigned i(0); i < 7; ++i)
+        {
+            CHECK(player.next(message));
+        }
+        CHECK_EQUAL("message 0", payload_of(message));
+
+        // two loops of three messages 1 ms apart
+        CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(6));
+
+        std::remove(filename.c_str());
+    }
+
+    TEST(it_should_parse_file_endpoints)
+    {
+        std::string filename;
+        float speed(0.f);
+
+        CHECK(!gua::MessagePlayer::parse_endpoint("141.54.147.22:7000", filename, speed));
+        CHECK(gua::MessagePlayer::parse_endpoint("file:///tmp/a.rec", filename, speed));
+        CHECK_EQUAL("/tmp/a.rec", filename);
+        CHECK_EQUAL(1.f, speed);
+        CHECK(gua::MessagePlayer::parse_endpoint("file://a.rec?speed=4", filename, speed));
+        CHECK_EQUAL("a.rec", filename);
+        CHECK_EQUAL(4.f, speed);
+    }
+}
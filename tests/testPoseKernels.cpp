@@ -0,0 +1,186 @@
+#include <unittest++/UnitTest++.h>
+#include <gua/skelanim/utils/PoseKernels.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+double const pi(3.14159265358979323846);
+
+struct Quat
+{
+    double x, y, z, w;
+};
+
+Quat axis_angle(double ax, double ay, double az, double angle)
+{
+    double const length(std::sqrt(ax * ax + ay * ay + az * az));
+    double const s(std::sin(angle * 0.5) / length);
+    return Quat{ax * s, ay * s, az * s, std::cos(angle * 0.5)};
+}
+
+Quat multiply(Quat const& a, Quat const& b)
+{
+    return Quat{a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+                a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+                a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+                a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z};
+}
+
+double dot(Quat const& a, Quat const& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+Quat slerp(Quat const& a, Quat b, double t)
+{
+    double d(dot(a, b));
+    if(d < 0.0)
+    {
+        b = Quat{-b.x, -b.y, -b.z, -b.w};
+        d = -d;
+    }
+    double const theta(std::acos(std::min(d, 1.0)));
+    if(theta < 1e-9)
+    {
+        return a;
+    }
+    double const s1(std::sin((1.0 - t) * theta) / std::sin(theta));
+    double const s2(std::sin(t * theta) / std::sin(theta));
+    return Quat{a.x * s1 + b.x * s2, a.y * s1 + b.y * s2, a.z * s1 + b.z * s2, a.w * s1 + b.w * s2};
+}
+
+// angle of the rotation between two unit quaternions in degrees
+double rotation_error(Quat const& a, Quat const& b)
+{
+    double const d(std::min(std::abs(dot(a, b)), 1.0));
+    return 2.0 * std::acos(d) * 180.0 / pi;
+}
+
+// a clip of many tracks, each key rotates by up to max_step degrees about a
+// random axis; the sign of every other key is flipped like exporters do
+struct Clip
+{
+    Clip(std::size_t tracks, std::size_t keys, double max_step)
+    {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<double> axis(-1.0, 1.0);
+        std::uniform_real_distribution<double> step(0.0, max_step * pi / 180.0);
+        for(std::size_t t = 0; t < tracks; ++t)
+        {
+            Quat q(axis_angle(axis(rng), axis(rng), axis(rng) + 2.0, step(rng) * 10.0));
+            std::vector<Quat> track;
+            for(std::size_t k = 0; k < keys; ++k)
+            {
+                track.push_back(k % 2 ? Quat{-q.x, -q.y, -q.z, -q.w} : q);
+                q = multiply(axis_angle(axis(rng), axis(rng), axis(rng) + 2.0, step(rng)), q);
+            }
+            key_frames.push_back(track);
+        }
+    }
+
+    std::vector<std::vector<Quat>> key_frames;
+};
+
+typedef void (*NlerpFunction)(float* const*, float const* const*, float const*, std::size_t);
+
+// largest error of nlerp against slerp over all tracks, segments and factors
+double max_nlerp_error(Clip const& clip, NlerpFunction nlerp)
+{
+    std::size_t const tracks(clip.key_frames.size());
+    double max_error(0.0);
+    for(std::size_t k = 0; k + 1 < clip.key_frames[0].size(); ++k)
+    {
+        for(double t : {0.0, 0.1, 0.25, 0.4, 0.5, 0.6, 0.75, 0.9, 1.0})
+        {
+            std::vector<float> a[4], b[4];
+            std::vector<float> weights(tracks, float(t));
+            for(std::size_t track = 0; track < tracks; ++track)
+            {
+                Quat const& qa(clip.key_frames[track][k]);
+                Quat const& qb(clip.key_frames[track][k + 1]);
+                a[0].push_back(float(qa.x)); a[1].push_back(float(qa.y)); a[2].push_back(float(qa.z)); a[3].push_back(float(qa.w));
+                b[0].push_back(float(qb.x)); b[1].push_back(float(qb.y)); b[2].push_back(float(qb.z)); b[3].push_back(float(qb.w));
+            }
+            float* const pa[4] = {a[0].data(), a[1].data(), a[2].data(), a[3].data()};
+            float const* const pb[4] = {b[0].data(), b[1].data(), b[2].data(), b[3].data()};
+            nlerp(pa, pb, weights.data(), tracks);
+
+            for(std::size_t track = 0; track < tracks; ++track)
+            {
+                Quat const expected(slerp(clip.key_frames[track][k], clip.key_frames[track][k + 1], t));
+                Quat const result{a[0][track], a[1][track], a[2][track], a[3][track]};
+                max_error = std::max(max_error, rotation_error(expected, result));
+            }
+        }
+    }
+    return max_error;
+}
+} // namespace
+
+SUITE(describe_pose_kernels)
+{
+    TEST(it_should_stay_close_to_slerp_for_neighbouring_keys)
+    {
+        // 7 tracks so the vector path and the scalar tail are both used
+        Clip const clip(7, 30, 60.0);
+        CHECK(max_nlerp_error(clip, &gua::pose_kernels::nlerp) < 0.3);
+        CHECK(max_nlerp_error(clip, &gua::pose_kernels::nlerp_scalar) < 0.3);
+    }
+
+    TEST(it_should_keep_the_error_bounded_for_distant_keys)
+    {
+        Clip const clip(7, 30, 90.0);
+        CHECK(max_nlerp_error(clip, &gua::pose_kernels::nlerp) < 1.0);
+    }
+
+    TEST(it_should_match_the_scalar_fallback)
+    {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> weight(0.0f, 1.0f);
+        std::size_t const count(13);
+
+        std::vector<float> a[4], b[4], weights(count);
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            for(unsigned c = 0; c < 4; ++c)
+            {
+                a[c].push_back(value(rng));
+                b[c].push_back(value(rng));
+            }
+            weights[i] = weight(rng);
+        }
+        // degenerate case: zero length input must not produce NaNs
+        for(unsigned c = 0; c < 4; ++c)
+        {
+            a[c][5] = b[c][5] = 0.0f;
+        }
+
+        std::vector<float> vector_a[4] = {a[0], a[1], a[2], a[3]};
+        std::vector<float> scalar_a[4] = {a[0], a[1], a[2], a[3]};
+        float* const pv[4] = {vector_a[0].data(), vector_a[1].data(), vector_a[2].data(), vector_a[3].data()};
+        float* const ps[4] = {scalar_a[0].data(), scalar_a[1].data(), scalar_a[2].data(), scalar_a[3].data()};
+        float const* const pb[4] = {b[0].data(), b[1].data(), b[2].data(), b[3].data()};
+        gua::pose_kernels::nlerp(pv, pb, weights.data(), count);
+        gua::pose_kernels::nlerp_scalar(ps, pb, weights.data(), count);
+
+        for(unsigned c = 0; c < 4; ++c)
+        {
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                CHECK_CLOSE(scalar_a[c][i], vector_a[c][i], 1e-6f);
+            }
+            CHECK_EQUAL(0.0f, vector_a[c][5]);
+        }
+
+        std::vector<float> vector_l(a[0]), scalar_l(a[0]);
+        gua::pose_kernels::lerp(vector_l.data(), b[0].data(), weights.data(), count);
+        gua::pose_kernels::lerp_scalar(scalar_l.data(), b[0].data(), weights.data(), count);
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            CHECK_CLOSE(scalar_l[i], vector_l[i], 1e-6f);
+            CHECK_CLOSE(a[0][i] + (b[0][i] - a[0][i]) * weights[i], vector_l[i], 1e-6f);
+        }
+    }
+}
@@ -0,0 +1,89 @@
+#include <unittest++/UnitTest++.h>
+#include <gua/utils/string_utils.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+namespace
+{
+bool same_bits(float a, float b) { return std::memcmp(&a, &b, sizeof(float)) == 0; }
+
+bool parses_like_strtof(std::string const& text)
+{
+    float value(0.f);
+    char const* end(gua::string_utils::parse_float(text.data(), text.data() + text.size(), value));
+
+    char* expected_end(nullptr);
+    float const expected(std::strtof(text.c_str(), &expected_end));
+
+    return same_bits(value, expected) && end - text.data() == expected_end - text.c_str();
+}
+} // namespace
+
+SUITE(describe_string_utils)
+{
+    TEST(it_should_parse_floats_in_all_formats)
+    {
+        char const* texts[] = {"0", "-0", "1", "+1.5", "-2.25", "0.1", ".5", "5.", "1e3", "1E-3", "-1.175494e-38", "3.4028234e38", "1e-45", "1e39", "123456789012345678901234", "0.000000000000000000000000001",
+                               "1.00000005960464477539", "16777217", "inf", "-nan", "1e", "1e+", "2.5x", "x", ""};
+
+        for(auto text : texts)
+        {
+            CHECK(parses_like_strtof(text));
+        }
+    }
+
+    TEST(it_should_parse_printed_floats_like_strtof)
+    {
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<float> distribution(-1000.f, 1000.f);
+        char const* formats[] = {"%g", "%f", "%.9g", "%.7e", "%.17g"};
+
+        char text[64];
+        for(int i = 0; i != 100000; ++i)
+        {
+            std::snprintf(text, sizeof(text), formats[i % 5], double(distribution(generator)));
+            CHECK(parses_like_strtof(text));
+        }
+    }
+
+    TEST(it_should_stop_parsing_floats_at_separators)
+    {
+        std::string const text("1.5 -2\n");
+        float value(0.f);
+
+        char const* c(gua::string_utils::parse_float(text.data(), text.data() + text.size(), value));
+        CHECK_EQUAL(1.5f, value);
+        CHECK_EQUAL(' ', *c);
+
+        c = gua::string_utils::parse_float(c + 1, text.data() + text.size(), value);
+        CHECK_EQUAL(-2.f, value);
+        CHECK_EQUAL('\n', *c);
+    }
+
+    TEST(it_should_parse_ints)
+    {
+        std::string const text("12 -7/3 +4 abc 99999999999");
+        char const* end(text.data() + text.size());
+        int value(0);
+
+        char const* c(gua::string_utils::parse_int(text.data(), end, value));
+        CHECK_EQUAL(12, value);
+
+        c = gua::string_utils::parse_int(c + 1, end, value);
+        CHECK_EQUAL(-7, value);
+        CHECK_EQUAL('/', *c);
+
+        c = gua::string_utils::parse_int(c + 3, end, value);
+        CHECK_EQUAL(4, value);
+
+        char const* no_number(c + 1);
+        CHECK(gua::string_utils::parse_int(no_number, end, value) == no_number);
+
+        gua::string_utils::parse_int(no_number + 4, end, value);
+        CHECK_EQUAL(2147483647, value);
+    }
+}
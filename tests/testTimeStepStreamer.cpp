@@ -0,0 +1,167 @@
+#include <unittest++/UnitTest++.h>
+#include <gua/utils/TimeStepStreamer.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+const std::size_t STEP_SIZE = 4096;
+
+// a synthetic sequence, every byte of a step holds its index
+struct Sequence
+{
+    explicit Sequence(unsigned num_steps)
+    {
+        for(unsigned s(0); s < num_steps; ++s)
+        {
+            files.push_back("gua-test-time-step-" + std::to_string(s) + ".raw");
+            std::vector<char> data(STEP_SIZE, char(s % 256));
+            std::ofstream(files.back(), std::ios::binary).write(data.data(), data.size());
+        }
+    }
+
+    ~Sequence()
+    {
+        for(auto const& file : files)
+        {
+            std::remove(file.c_str());
+        }
+    }
+
+    std::vector<std::string> files;
+};
+
+bool holds_step(gua::TimeStepStreamer::Step const& data, unsigned step) { return data && data->size() == STEP_SIZE && (*data)[0] == uint8_t(step % 256) && data->back() == uint8_t(step % 256); }
+} // namespace
+
+SUITE(describe_time_step_streamer)
+{
+    TEST(it_should_play_a_long_sequence_within_the_budget)
+    {
+        Sequence sequence(500);
+        gua::TimeStepStreamer streamer(sequence.files, STEP_SIZE, 16 * STEP_SIZE);
+        CHECK_EQUAL(16u, streamer.get_window_size());
+
+        bool all_valid(true);
+        for(unsigned frame(0); frame < 500; ++frame)
+        {
+            streamer.set_playback(float(frame), 60.f);
+            all_valid = all_valid && holds_step(streamer.get_step(frame), frame);
+        }
+
+        auto statistics(streamer.get_statistics());
+        CHECK(all_valid);
+        CHECK_EQUAL(500u, statistics.hits + statistics.misses);
+        CHECK(statistics.peak_resident_bytes <= 16 * STEP_SIZE);
+    }
+
+    TEST(prefetching_should_turn_misses_into_hits)
+    {
+        Sequence sequence(500);
+        gua::TimeStepStreamer streamer(sequence.files, STEP_SIZE, 8 * STEP_SIZE);
+
+        bool all_valid(true);
+        for(unsigned frame(0); frame < 500; ++frame)
+        {
+            streamer.set_playback(float(frame), 60.f);
+            // the renderer would draw here, give the prefetcher time to catch up
+            streamer.wait_for_prefetch();
+            all_valid = all_valid && holds_step(streamer.get_step(frame), frame);
+        }
+
+        auto statistics(streamer.get_statistics());
+        CHECK(all_valid);
+        CHECK_EQUAL(500u, statistics.hits);
+        CHECK_EQUAL(0u, statistics.misses);
+        CHECK(statistics.prefetched >= 500u);
+        CHECK(statistics.peak_resident_bytes <= 8 * STEP_SIZE);
+    }
+
+    TEST(several_loader_threads_should_share_the_window)
+    {
+        Sequence sequence(100);
+        gua::TimeStepStreamer streamer(sequence.files, STEP_SIZE, 12 * STEP_SIZE, std::make_shared<gua::TimeStepLoaderPool>(4));
+
+        bool all_valid(true);
+        for(unsigned frame(0); frame < 100; frame += 3)
+        {
+            streamer.set_playback(float(frame), 90.f);
+            streamer.wait_for_prefetch();
+            for(unsigned step(frame); step < frame + 11 && step < 100; ++step)
+            {
+                all_valid = all_valid && holds_step(streamer.try_get_step(step), step);
+            }
+        }
+
+        auto statistics(streamer.get_statistics());
+        CHECK(all_valid);
+        CHECK_EQUAL(0u, statistics.misses);
+        CHECK(statistics.peak_resident_bytes <= 12 * STEP_SIZE);
+    }
+
+    TEST(streamers_should_share_a_loader_pool)
+    {
+        Sequence sequence(50);
+        auto loaders(std::make_shared<gua::TimeStepLoaderPool>(2));
+
+        std::vector<std::unique_ptr<gua::TimeStepStreamer>> streamers;
+        for(unsigned s(0); s < 5; ++s)
+        {
+            streamers.emplace_back(new gua::TimeStepStreamer(sequence.files, STEP_SIZE, 6 * STEP_SIZE, loaders));
+        }
+
+        bool all_valid(true);
+        for(unsigned frame(0); frame < 50; frame += 5)
+        {
+            for(unsigned s(0); s < streamers.size(); ++s)
+            {
+                streamers[s]->set_playback(float(frame + s), 30.f);
+            }
+
+            for(unsigned s(0); s < streamers.size(); ++s)
+            {
+                streamers[s]->wait_for_prefetch();
+                all_valid = all_valid && holds_step(streamers[s]->try_get_step((frame + s) % 50), (frame + s) % 50);
+            }
+        }
+
+        CHECK(all_valid);
+        CHECK_EQUAL(2u, loaders->get_num_threads());
+
+        // streamers may go away while the pool keeps loading for the others
+        streamers.erase(streamers.begin() + 1, streamers.begin() + 3);
+        streamers[0]->set_playback(10.f, 30.f);
+        streamers[0]->wait_for_prefetch();
+        CHECK(holds_step(streamers[0]->try_get_step(10), 10));
+    }
+
+    TEST(it_should_follow_backward_playback_and_wrap_around)
+    {
+        Sequence sequence(20);
+        gua::TimeStepStreamer streamer(sequence.files, STEP_SIZE, 4 * STEP_SIZE);
+
+        streamer.set_playback(1.5f, -10.f);
+        streamer.wait_for_prefetch();
+
+        // one step behind, the rest ahead in playback direction
+        CHECK(holds_step(streamer.try_get_step(1), 1));
+        CHECK(holds_step(streamer.try_get_step(0), 0));
+        CHECK(holds_step(streamer.try_get_step(19), 19));
+        CHECK(holds_step(streamer.try_get_step(2), 2));
+        CHECK(!streamer.try_get_step(3));
+        CHECK_EQUAL(1u, streamer.get_statistics().misses);
+    }
+
+    TEST(missing_steps_should_be_zeros)
+    {
+        gua::TimeStepStreamer streamer({"gua-test-time-step-missing.raw"}, STEP_SIZE, STEP_SIZE);
+        auto data(streamer.get_step(0));
+
+        CHECK(data && data->size() == STEP_SIZE && (*data)[0] == 0);
+        CHECK(!streamer.get_step(1));
+    }
+}
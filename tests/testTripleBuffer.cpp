@@ -0,0 +1,68 @@
+#include <unittest++/UnitTest++.h>
+#include <gua/utils/TripleBuffer.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+SUITE(describe_triple_buffer)
+{
+    TEST(the_reader_should_see_the_latest_published_value)
+    {
+        gua::TripleBuffer<int> buffer;
+        CHECK(!buffer.acquire());
+
+        buffer.write_buffer() = 1;
+        buffer.publish();
+        buffer.write_buffer() = 2;
+        buffer.publish();
+
+        CHECK(buffer.acquire());
+        CHECK_EQUAL(2, buffer.read_buffer());
+        CHECK(!buffer.acquire());
+        CHECK_EQUAL(2, buffer.read_buffer());
+
+        buffer.write_buffer() = 3;
+        CHECK(!buffer.acquire());
+        buffer.publish();
+        CHECK(buffer.acquire());
+        CHECK_EQUAL(3, buffer.read_buffer());
+    }
+
+    TEST(the_reader_should_never_see_a_half_written_buffer)
+    {
+        gua::TripleBuffer<std::vector<unsigned>> buffer;
+        unsigned const num_versions = 20000;
+
+        std::thread writer([&]() {
+            for(unsigned version = 1; version <= num_versions; ++version)
+            {
+                std::vector<unsigned>& values(buffer.write_buffer());
+                values.assign(64 + version % 7, version);
+                buffer.publish();
+            }
+        });
+
+        unsigned last_version = 0;
+        bool consistent = true;
+        while(last_version < num_versions)
+        {
+            if(!buffer.acquire())
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::vector<unsigned> const& values(buffer.read_buffer());
+            unsigned const version(values.empty() ? 0 : values[0]);
+            consistent = consistent && version > last_version && values.size() == 64 + version % 7;
+            for(unsigned value : values)
+                consistent = consistent && value == version;
+            last_version = version;
+        }
+
+        writer.join();
+        CHECK(consistent);
+        CHECK_EQUAL(num_versions, last_version);
+    }
+}
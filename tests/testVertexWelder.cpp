@@ -0,0 +1,80 @@
+#include <unittest++/UnitTest++.h>
+#include <gua/utils/VertexWelder.hpp>
+
+#include <limits>
+#include <random>
+#include <vector>
+
+SUITE(describe_vertex_welder)
+{
+    TEST(it_should_weld_identical_positions)
+    {
+        gua::VertexWelder welder;
+        CHECK_EQUAL(0u, welder.add(1.0, 2.0, 3.0));
+        CHECK_EQUAL(1u, welder.add(1.0, 2.0, 3.5));
+        CHECK_EQUAL(0u, welder.add(1.0, 2.0, 3.0));
+        CHECK_EQUAL(2u, welder.add(3.0, 2.0, 1.0));
+        CHECK_EQUAL(1u, welder.add(1.0, 2.0, 3.5));
+        CHECK_EQUAL(3u, welder.size());
+
+        std::vector<double> const expected = {1.0, 2.0, 3.0, 1.0, 2.0, 3.5, 3.0, 2.0, 1.0};
+        CHECK(expected == welder.positions());
+    }
+
+    TEST(it_should_compare_like_operator_equal)
+    {
+        gua::VertexWelder welder;
+        CHECK_EQUAL(0u, welder.add(0.0, 1.0, -0.0));
+        CHECK_EQUAL(0u, welder.add(-0.0, 1.0, 0.0));
+
+        // NaNs are never equal, a vertex with a NaN coordinate is always added
+        double const nan = std::numeric_limits<double>::quiet_NaN();
+        CHECK_EQUAL(1u, welder.add(nan, 0.0, 0.0));
+        CHECK_EQUAL(2u, welder.add(nan, 0.0, 0.0));
+    }
+
+    TEST(it_should_match_a_linear_search)
+    {
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> coordinate(-20, 20);
+
+        // a grid of few distinct values, most positions are seen many times
+        gua::VertexWelder welder;
+        std::vector<double> reference;
+        for(int i = 0; i < 20000; ++i)
+        {
+            double const position[3] = {coordinate(rng) * 0.25, coordinate(rng) * 0.25, double(coordinate(rng) % 3)};
+
+            unsigned expected = unsigned(reference.size() / 3);
+            for(unsigned v = 0; v < reference.size() / 3; ++v)
+            {
+                if(reference[3 * v] == position[0] && reference[3 * v + 1] == position[1] && reference[3 * v + 2] == position[2])
+                {
+                    expected = v;
+                    break;
+                }
+            }
+            if(expected == reference.size() / 3)
+            {
+                reference.insert(reference.end(), position, position + 3);
+            }
+
+            CHECK_EQUAL(expected, welder.add(position[0], position[1], position[2]));
+        }
+
+        CHECK(reference == welder.positions());
+    }
+
+    TEST(it_should_be_empty_after_clear)
+    {
+        gua::VertexWelder welder(100);
+        for(int i = 0; i < 100; ++i)
+        {
+            welder.add(i, i, i);
+        }
+        welder.clear();
+        CHECK_EQUAL(0u, welder.size());
+        CHECK_EQUAL(0u, welder.add(5.0, 5.0, 5.0));
+        CHECK_EQUAL(1u, welder.add(0.0, 0.0, 0.0));
+    }
+}
@@ -0,0 +1,193 @@
+#include <unittest++/UnitTest++.h>
+#include <gua/utils/VolumeBrickGrid.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+using Grid = gua::VolumeBrickGrid;
+
+std::vector<uint8_t> empty_volume(unsigned size) { return std::vector<uint8_t>(std::size_t(size) * size * size, 0); }
+
+void set_voxel(std::vector<uint8_t>& volume, unsigned size, unsigned x, unsigned y, unsigned z, uint8_t value) { volume[(std::size_t(z) * size + y) * size + x] = value; }
+} // namespace
+
+SUITE(describe_volume_brick_grid)
+{
+    TEST(it_should_record_the_value_range_of_each_brick)
+    {
+        auto volume(empty_volume(64));
+        set_voxel(volume, 64, 40, 40, 40, 255);
+        set_voxel(volume, 64, 5, 6, 7, 51);
+
+        Grid grid;
+        grid.build(volume.data(), {{64, 64, 64}}, Grid::VoxelType::UINT8, 16);
+
+        CHECK_EQUAL(4u, grid.get_grid_dimensions()[0]);
+        CHECK_EQUAL(64u, grid.get_value_ranges().size());
+        CHECK_CLOSE(1.f, grid.get_value_range(2, 2, 2).max, 1e-6f);
+        CHECK_CLOSE(0.2f, grid.get_value_range(0, 0, 0).max, 1e-6f);
+        CHECK_CLOSE(0.f, grid.get_value_range(0, 0, 0).min, 1e-6f);
+        CHECK_CLOSE(0.f, grid.get_value_range(3, 3, 3).max, 1e-6f);
+    }
+
+    TEST(bricks_should_include_the_voxels_bordering_them)
+    {
+        auto volume(empty_volume(64));
+        set_voxel(volume, 64, 32, 20, 20, 255);
+
+        Grid grid;
+        grid.build(volume.data(), {{64, 64, 64}}, Grid::VoxelType::UINT8, 16);
+
+        // trilinear samples at the upper border of brick 1 reach into voxel 32
+        CHECK_CLOSE(1.f, grid.get_value_range(2, 1, 1).max, 1e-6f);
+        CHECK_CLOSE(1.f, grid.get_value_range(1, 1, 1).max, 1e-6f);
+        CHECK_CLOSE(0.f, grid.get_value_range(3, 1, 1).max, 1e-6f);
+        CHECK_CLOSE(0.f, grid.get_value_range(0, 1, 1).max, 1e-6f);
+    }
+
+    TEST(it_should_handle_partial_bricks_and_wide_voxels)
+    {
+        std::vector<uint16_t> volume(20 * 10 * 5, 0);
+        volume.back() = 65535;
+
+        Grid grid;
+        grid.build(volume.data(), {{20, 10, 5}}, Grid::VoxelType::UINT16, 8);
+
+        CHECK_EQUAL(3u, grid.get_grid_dimensions()[0]);
+        CHECK_EQUAL(2u, grid.get_grid_dimensions()[1]);
+        CHECK_EQUAL(1u, grid.get_grid_dimensions()[2]);
+        CHECK_CLOSE(1.f, grid.get_value_range(2, 1, 0).max, 1e-6f);
+        CHECK_CLOSE(0.f, grid.get_value_range(1, 1, 0).max, 1e-6f);
+
+        std::vector<float> values(20 * 10 * 5, 0.25f);
+        grid.build(values.data(), {{20, 10, 5}}, Grid::VoxelType::FLOAT32, 8);
+        CHECK_CLOSE(0.25f, grid.get_value_range(0, 0, 0).min, 1e-6f);
+    }
+
+    TEST(extending_should_merge_the_ranges_of_several_time_steps)
+    {
+        auto first(empty_volume(32));
+        auto second(empty_volume(32));
+        set_voxel(first, 32, 2, 2, 2, 255);
+        set_voxel(second, 32, 30, 30, 30, 255);
+
+        Grid grid;
+        grid.build(first.data(), {{32, 32, 32}}, Grid::VoxelType::UINT8, 16);
+        grid.extend(second.data(), Grid::VoxelType::UINT8);
+
+        CHECK_CLOSE(1.f, grid.get_value_range(0, 0, 0).max, 1e-6f);
+        CHECK_CLOSE(1.f, grid.get_value_range(1, 1, 1).max, 1e-6f);
+        CHECK_CLOSE(0.f, grid.get_value_range(1, 0, 0).max, 1e-6f);
+    }
+
+    TEST(occupancy_should_follow_the_transfer_function)
+    {
+        auto volume(empty_volume(32));
+        set_voxel(volume, 32, 2, 2, 2, 100);
+        set_voxel(volume, 32, 30, 30, 30, 250);
+
+        Grid grid;
+        grid.build(volume.data(), {{32, 32, 32}}, Grid::VoxelType::UINT8, 16);
+
+        // transparent below 0.5
+        std::vector<float> opacity(256, 0.f);
+        std::fill(opacity.begin() + 128, opacity.end(), 1.f);
+
+        auto occupancy(grid.compute_occupancy(opacity));
+        CHECK_EQUAL(0, occupancy[0]);
+        CHECK_EQUAL(1, occupancy[7]);
+        CHECK(occupancy == grid.compute_occupancy(0.5f, 1.f));
+
+        // everything but the empty air
+        std::fill(opacity.begin() + 1, opacity.end(), 1.f);
+        occupancy = grid.compute_occupancy(opacity);
+        CHECK_EQUAL(1, occupancy[0]);
+        CHECK_EQUAL(0, occupancy[1]);
+    }
+
+    TEST(distances_should_be_the_chessboard_distance_to_occupied_bricks)
+    {
+        auto volume(empty_volume(128));
+        set_voxel(volume, 128, 20, 36, 100, 255);
+
+        Grid grid;
+        grid.build(volume.data(), {{128, 128, 128}}, Grid::VoxelType::UINT8, 16);
+        auto distances(grid.compute_distances(grid.compute_occupancy(0.5f, 1.f)));
+
+        bool all_exact(true);
+        for(int z = 0; z < 8; ++z)
+        {
+            for(int y = 0; y < 8; ++y)
+            {
+                for(int x = 0; x < 8; ++x)
+                {
+                    int const expected = std::max(std::abs(x - 1), std::max(std::abs(y - 2), std::abs(z - 6)));
+                    all_exact = all_exact && distances[(z * 8 + y) * 8 + x] == expected;
+                }
+            }
+        }
+        CHECK(all_exact);
+    }
+
+    TEST(empty_volumes_should_have_the_maximum_distance_everywhere)
+    {
+        auto volume(empty_volume(32));
+
+        Grid grid;
+        grid.build(volume.data(), {{32, 32, 32}}, Grid::VoxelType::UINT8, 8);
+        auto distances(grid.compute_distances(grid.compute_occupancy(0.1f, 1.f)));
+
+        CHECK_EQUAL(64u, distances.size());
+        CHECK(std::all_of(distances.begin(), distances.end(), [](uint8_t d) { return d == Grid::MAX_DISTANCE; }));
+    }
+
+    TEST(it_should_only_load_grids_stored_for_the_same_key)
+    {
+        auto volume(empty_volume(48));
+        set_voxel(volume, 48, 47, 0, 13, 77);
+
+        Grid grid;
+        grid.build(volume.data(), {{48, 48, 48}}, Grid::VoxelType::UINT8, 16);
+        CHECK(grid.save("gua-test-volume.bricks", 42));
+
+        Grid loaded;
+        CHECK(!loaded.load("gua-test-volume.bricks", 43, 16));
+        CHECK(!loaded.load("gua-test-volume.bricks", 42, 8));
+        CHECK(loaded.empty());
+        CHECK(loaded.load("gua-test-volume.bricks", 42, 16));
+
+        CHECK_EQUAL(grid.get_value_ranges().size(), loaded.get_value_ranges().size());
+        CHECK_CLOSE(77.f / 255.f, loaded.get_value_range(2, 0, 0).max, 1e-6f);
+        CHECK(!loaded.load("gua-test-missing.bricks", 42, 16));
+
+        std::remove("gua-test-volume.bricks");
+    }
+
+    TEST(file_hashes_should_change_with_the_content)
+    {
+        std::vector<uint8_t> volume(1000, 3);
+        FILE* file = std::fopen("gua-test-volume.raw", "wb");
+        std::fwrite(volume.data(), 1, volume.size(), file);
+        std::fclose(file);
+        uint64_t const first = Grid::hash_file("gua-test-volume.raw");
+
+        volume[999] = 4;
+        file = std::fopen("gua-test-volume.raw", "wb");
+        std::fwrite(volume.data(), 1, volume.size(), file);
+        std::fclose(file);
+
+        CHECK(first != 0);
+        volume[999] = 3;
+        CHECK_EQUAL(first, Grid::hash_data(volume.data(), volume.size()));
+        CHECK_EQUAL(first, Grid::hash_data(volume.data() + 512, 488, Grid::hash_data(volume.data(), 512)));
+        volume[999] = 4;
+        CHECK(first != Grid::hash_file("gua-test-volume.raw"));
+        CHECK_EQUAL(0u, Grid::hash_file("gua-test-missing.raw"));
+
+        std::remove("gua-test-volume.raw");
+    }
+}